@@ -72,6 +72,8 @@ namespace Algorithms {
       data_[name] = upcast_range<Datatypes::Datatype>(list);
     }
 
+    const Map& items() const { return data_; }
+
     /// @todo: lame
     void setTransient(boost::any t) { transient_ = t; }
     boost::any getTransient() const { return transient_; }
@@ -0,0 +1,107 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Core/Algorithms/Describe/DatatypeMemorySize.h>
+#include <Core/Datatypes/String.h>
+#include <Core/Datatypes/DenseMatrix.h>
+#include <Core/Datatypes/DenseColumnMatrix.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
+#include <Core/Datatypes/Legacy/Field/Field.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/GeometryPrimitives/Tensor.h>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Algorithms::General;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Geometry;
+
+namespace
+{
+  size_t matrixSize(const MatrixHandle& mat)
+  {
+    auto sparse = boost::dynamic_pointer_cast<SparseRowMatrix>(mat);
+    if (sparse)
+    {
+      return sparse->nonZeros() * (sizeof(double) + sizeof(index_type)) +
+        (sparse->nrows() + 1) * sizeof(index_type);
+    }
+    return mat->get_dense_size() * sizeof(double);
+  }
+
+  size_t fieldValueSize(VField* vfield)
+  {
+    if (vfield->is_vector())
+      return sizeof(Vector);
+    if (vfield->is_tensor())
+      return sizeof(Tensor);
+    if (vfield->is_char() || vfield->is_unsigned_char())
+      return sizeof(char);
+    if (vfield->is_short() || vfield->is_unsigned_short())
+      return sizeof(short);
+    if (vfield->is_int() || vfield->is_unsigned_int() || vfield->is_float())
+      return sizeof(int);
+    return sizeof(double);
+  }
+
+  size_t fieldSize(const FieldHandle& field)
+  {
+    size_t bytes = 0;
+    VMesh* vmesh = field->vmesh();
+    if (vmesh && !vmesh->is_regularmesh())
+    {
+      bytes += vmesh->num_nodes() * sizeof(Point);
+      if (vmesh->is_unstructuredmesh())
+        bytes += vmesh->num_elems() * vmesh->num_nodes_per_elem() * sizeof(index_type);
+    }
+    VField* vfield = field->vfield();
+    if (vfield && !vfield->is_nodata())
+      bytes += (vfield->num_values() + vfield->num_evalues()) * fieldValueSize(vfield);
+    return bytes;
+  }
+}
+
+size_t DatatypeMemorySize::estimate(const DatatypeHandle data) const
+{
+  if (!data)
+    return 0;
+
+  auto str = boost::dynamic_pointer_cast<String>(data);
+  if (str)
+    return str->value().size();
+
+  auto mat = boost::dynamic_pointer_cast<Matrix>(data);
+  if (mat)
+    return matrixSize(mat);
+
+  auto field = boost::dynamic_pointer_cast<Field>(data);
+  if (field)
+    return fieldSize(field);
+
+  return 0;
+}
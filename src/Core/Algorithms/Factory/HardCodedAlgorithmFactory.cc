@@ -92,6 +92,8 @@
 #include <Core/Algorithms/Legacy/Converter/ConvertMatrixToString.h>
 #include <Core/Algorithms/Legacy/Fields/MeshDerivatives/ExtractSimpleIsosurfaceAlgo.h>
 #include <Core/Algorithms/Legacy/Fields/ClipMesh/ClipMeshByIsovalue.h>
+#include <Core/Algorithms/Worker/WorkerAlgorithm.h>
+#include <boost/make_shared.hpp>
 #include <boost/functional/factory.hpp>
 #include <boost/assign.hpp>
 #include <Core/Algorithms/Math/ComputePCA.h>
@@ -206,5 +208,8 @@ AlgorithmHandle HardCodedAlgorithmFactory::create(const std::string& moduleName,
     h->setUpdaterFunc(algoCollaborator->getUpdaterFunc());
   }
 
+  if (h && Remote::WorkerPool::Instance().offloads(moduleName))
+    h = boost::make_shared<Remote::WorkerAlgorithm>(moduleName, h);
+
   return h;
 }
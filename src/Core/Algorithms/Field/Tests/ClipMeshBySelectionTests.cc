@@ -0,0 +1,109 @@
+/*
+ For more information, please see: http://software.sci.utah.edu
+ 
+ The MIT License
+ 
+ Copyright (c) 2015 Scientific Computing and Imaging Institute,
+ University of Utah.
+ 
+ License for the specific language governing rights and limitations under
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included
+ in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/Matrix.h>
+#include <Core/Algorithms/Legacy/Fields/ClipMesh/ClipMeshBySelection.h>
+#include <Testing/Utils/SCIRunFieldSamples.h>
+#include <Testing/Utils/FieldTestUtilities.h>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Algorithms::Fields;
+using namespace SCIRun::TestUtils;
+
+namespace
+{
+  // Scatter the selection so every thread's element range keeps some
+  // elements and drops others
+  FieldHandle scatteredSelection(FieldHandle field)
+  {
+    std::mt19937 rng(4711);
+    VField* vfield = field->vfield();
+    for (VMesh::index_type i = 0; i < vfield->num_values(); ++i)
+      vfield->set_value(rng() % 2 ? 1.0 : 0.0, i);
+    return field;
+  }
+
+  void expectThreadedClipMatchesSerial(FieldHandle input, FieldHandle selection, const std::string& method)
+  {
+    ClipMeshBySelectionAlgo algo;
+    algo.set_option(Parameters::ClipMethod, method);
+
+    FieldHandle serial, serialUnmapped;
+    MatrixHandle serialMapping;
+    {
+      ScopedNumCores cores(1);
+      ASSERT_TRUE(algo.runImpl(input, selection, serial, serialMapping));
+      ASSERT_TRUE(algo.runImpl(input, selection, serialUnmapped));
+    }
+    EXPECT_GT(serial->vmesh()->num_elems(), 0) << method;
+    EXPECT_LT(serial->vmesh()->num_elems(), input->vmesh()->num_elems()) << method;
+    EXPECT_TRUE(same_field(serial, serialUnmapped)) << method;
+
+    for (unsigned int numCores : { 2u, 4u, 7u })
+    {
+      ScopedNumCores cores(numCores);
+      FieldHandle threaded, threadedUnmapped;
+      MatrixHandle threadedMapping;
+      ASSERT_TRUE(algo.runImpl(input, selection, threaded, threadedMapping));
+      ASSERT_TRUE(algo.runImpl(input, selection, threadedUnmapped));
+      EXPECT_TRUE(same_field(serial, threaded)) << method << ", " << numCores << " cores";
+      EXPECT_TRUE(same_field(serial, threadedUnmapped)) << method << ", " << numCores << " cores";
+      EXPECT_TRUE(same_mapping(serialMapping, threadedMapping)) << method << ", " << numCores << " cores";
+    }
+  }
+}
+
+TEST(ClipMeshBySelectionTests, ThreadedClipMatchesSerialOnTetrahedrals)
+{
+  FieldHandle input = TetVolGrid(12, LINEARDATA_E);
+  ASSERT_GE(input->vmesh()->num_elems(), 10000);
+
+  expectThreadedClipMatchesSerial(input, scatteredSelection(TetVolGrid(12, CONSTANTDATA_E)), "Element Center");
+  FieldHandle nodeSelection = scatteredSelection(TetVolGrid(12, LINEARDATA_E));
+  for (const std::string method : { "One Node", "Most Nodes", "All Nodes" })
+    expectThreadedClipMatchesSerial(input, nodeSelection, method);
+}
+
+TEST(ClipMeshBySelectionTests, ThreadedClipMatchesSerialOnTriangles)
+{
+  FieldHandle input = TriSurfGrid(72, CONSTANTDATA_E);
+  ASSERT_GE(input->vmesh()->num_elems(), 10000);
+
+  expectThreadedClipMatchesSerial(input, scatteredSelection(TriSurfGrid(72, CONSTANTDATA_E)), "Element Center");
+  FieldHandle nodeSelection = scatteredSelection(TriSurfGrid(72, LINEARDATA_E));
+  for (const std::string method : { "One Node", "Most Nodes", "All Nodes" })
+    expectThreadedClipMatchesSerial(input, nodeSelection, method);
+}
@@ -31,14 +31,20 @@ last change: 04/21/2015
 
 #include <gtest/gtest.h>
 
+#include <cmath>
+
 #include <Core/Datatypes/Legacy/Field/VField.h>
 #include <Core/Datatypes/Legacy/Field/FieldInformation.h>
 #include <Core/Datatypes/Matrix.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
+#include <Core/Datatypes/MatrixTypeConversions.h>
 #include <Core/Algorithms/Legacy/Fields/ClipMesh/ClipMeshByIsovalue.h>
 #include <Testing/Utils/SCIRunUnitTests.h>
 #include <Core/Datatypes/DenseMatrix.h>
 #include <Core/Algorithms/Base/AlgorithmPreconditions.h>
 #include <Testing/Utils/MatrixTestUtilities.h>
+#include <Testing/Utils/SCIRunFieldSamples.h>
+#include <Testing/Utils/FieldTestUtilities.h>
 #include <Core/Datatypes/DenseMatrix.h>
 
 using namespace SCIRun;
@@ -118,3 +124,101 @@ TEST(ClipVolumeByIsovalueAlgoTest, ClipVolumeByIsovalue_LatVol_DataOnNodes)
   EXPECT_EQ(output->vfield()->num_values(),8); 
 }
 
+
+TEST(ClipVolumeByIsovalueAlgoTest, ClipVolumeByIsovalue_Tetrahedrals_Mapping)
+{
+  ClipMeshByIsovalueAlgo algo;
+  FieldHandle input_tets, output;
+  MatrixHandle mapping;
+  input_tets=LoadTetrahedrals();
+  algo.set(ClipMeshByIsovalueAlgo::ScalarIsoValue, 0.0);
+  algo.set(ClipMeshByIsovalueAlgo::LessThanIsoValue, true);
+  algo.run(input_tets,output,mapping);
+  ASSERT_TRUE(mapping != nullptr);
+  EXPECT_EQ(mapping->nrows(),236);
+  EXPECT_EQ(mapping->ncols(),input_tets->vmesh()->num_nodes());
+
+  // The mapping interpolates the input data onto the clipped mesh
+  auto sparse = matrix_cast::as_sparse(mapping);
+  ASSERT_TRUE(sparse != nullptr);
+  VField* ifield = input_tets->vfield();
+  VField* ofield = output->vfield();
+  for (size_t r = 0; r < sparse->nrows(); r++)
+  {
+    double value = 0.0, total = 0.0;
+    for (SparseRowMatrix::InnerIterator it(*sparse, r); it; ++it)
+    {
+      double ivalue;
+      ifield->get_value(ivalue, it.index());
+      value += it.value()*ivalue;
+      total += it.value();
+    }
+    double ovalue;
+    ofield->get_value(ovalue, r);
+    EXPECT_NEAR(1.0, total, 1e-12);
+    EXPECT_NEAR(ovalue, value, 1e-10);
+  }
+}
+
+namespace
+{
+  // A wavy scalar so the isosurface cuts through elements all over the grid
+  FieldHandle wavyGrid(FieldHandle field)
+  {
+    VMesh* vmesh = field->vmesh();
+    VField* vfield = field->vfield();
+    Point p;
+    for (VMesh::Node::index_type i = 0; i < vmesh->num_nodes(); ++i)
+    {
+      vmesh->get_center(p, i);
+      vfield->set_value(std::sin(0.9*p.x()) + std::cos(0.7*p.y()) + 0.3*p.z(), i);
+    }
+    return field;
+  }
+
+  void expectThreadedClipMatchesSerial(FieldHandle input, double isovalue)
+  {
+    ClipMeshByIsovalueAlgo algo;
+    algo.set(ClipMeshByIsovalueAlgo::ScalarIsoValue, isovalue);
+    for (bool lessThan : { true, false })
+    {
+      algo.set(ClipMeshByIsovalueAlgo::LessThanIsoValue, lessThan);
+
+      FieldHandle serial, serialUnmapped;
+      MatrixHandle serialMapping;
+      {
+        ScopedNumCores cores(1);
+        ASSERT_TRUE(algo.run(input, serial, serialMapping));
+        ASSERT_TRUE(algo.run(input, serialUnmapped));
+      }
+      EXPECT_GT(serial->vmesh()->num_elems(), 0);
+      EXPECT_TRUE(same_field(serial, serialUnmapped));
+
+      for (unsigned int numCores : { 2u, 4u, 7u })
+      {
+        ScopedNumCores cores(numCores);
+        FieldHandle threaded, threadedUnmapped;
+        MatrixHandle threadedMapping;
+        ASSERT_TRUE(algo.run(input, threaded, threadedMapping));
+        ASSERT_TRUE(algo.run(input, threadedUnmapped));
+        EXPECT_TRUE(same_field(serial, threaded)) << numCores << " cores";
+        EXPECT_TRUE(same_field(serial, threadedUnmapped)) << numCores << " cores";
+        EXPECT_TRUE(same_mapping(serialMapping, threadedMapping)) << numCores << " cores";
+      }
+    }
+  }
+}
+
+TEST(ClipVolumeByIsovalueAlgoTest, ThreadedClipMatchesSerialOnTetrahedrals)
+{
+  FieldHandle input = wavyGrid(TetVolGrid(12, LINEARDATA_E));
+  ASSERT_GE(input->vmesh()->num_elems(), 10000);
+  expectThreadedClipMatchesSerial(input, 2.0);
+}
+
+TEST(ClipVolumeByIsovalueAlgoTest, ThreadedClipMatchesSerialOnTriangles)
+{
+  FieldHandle input = wavyGrid(TriSurfGrid(72, LINEARDATA_E));
+  ASSERT_GE(input->vmesh()->num_elems(), 10000);
+  expectThreadedClipMatchesSerial(input, 0.5);
+}
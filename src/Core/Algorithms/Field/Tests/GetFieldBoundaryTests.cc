@@ -29,8 +29,10 @@
 #include <gtest/gtest.h>
 
 #include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
 #include <Core/Datatypes/Legacy/Field/FieldInformation.h>
 #include <Core/Datatypes/Matrix.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
 #include <Core/Datatypes/MatrixIO.h>
 #include <Core/Algorithms/Base/AlgorithmPreconditions.h>
 #include <Core/Algorithms/Legacy/Fields/MeshDerivatives/GetFieldBoundaryAlgo.h>
@@ -155,4 +157,39 @@ TEST(GetFieldBoundaryTest, CanLogErrorMessage)
   EXPECT_FALSE(algo.run(input, output, mapping));
 
   EXPECT_FALSE(algo.run(input, output));
-}
\ No newline at end of file
+}
+TEST(GetFieldBoundaryTest, LargeLatVolBoundaryMapsNodes)
+{
+  // Large enough to split the element walk over several threads
+  FieldInformation lfi("LatVolMesh", 1, "double");
+  size_type size = 25;
+  MeshHandle mesh = CreateMesh(lfi, size, size, size, Point(0,0,0), Point(1,1,1));
+  FieldHandle ofh = CreateField(lfi, mesh);
+  ofh->vfield()->clear_all_values();
+
+  GetFieldBoundaryAlgo algo;
+  FieldHandle boundary;
+  MatrixHandle mapping;
+  ASSERT_TRUE(algo.run(ofh, boundary, mapping));
+
+  VMesh* imesh = ofh->vmesh();
+  VMesh* omesh = boundary->vmesh();
+  EXPECT_EQ(6*24*24, omesh->num_elems());
+  EXPECT_EQ(25*25*25 - 23*23*23, omesh->num_nodes());
+
+  auto sparse = matrix_cast::as_sparse(mapping);
+  ASSERT_TRUE(sparse != nullptr);
+  EXPECT_EQ(omesh->num_nodes(), sparse->nrows());
+  EXPECT_EQ(imesh->num_nodes(), sparse->ncols());
+  EXPECT_EQ(omesh->num_nodes(), sparse->nonZeros());
+
+  for (size_t row = 0; row < sparse->nrows(); ++row)
+  {
+    SparseRowMatrix::InnerIterator it(*sparse, row);
+    ASSERT_TRUE(it);
+    Point p, q;
+    omesh->get_center(p, VMesh::Node::index_type(row));
+    imesh->get_center(q, VMesh::Node::index_type(it.col()));
+    EXPECT_EQ(p, q);
+  }
+}
@@ -0,0 +1,194 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+#include <gtest/gtest.h>
+
+#include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/Legacy/Field/FieldInformation.h>
+#include <Core/Algorithms/Legacy/Fields/MeshData/GetMeshQualityField.h>
+
+#include <cmath>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Algorithms::Fields;
+
+namespace
+{
+  // Tetrahedral grid of n^3 unit cubes, each split into six tetrahedra
+  FieldHandle tetGrid(int n)
+  {
+    FieldInformation fi("TetVolMesh", 1, "double");
+    FieldHandle field = CreateField(fi);
+    VMesh* mesh = field->vmesh();
+
+    const int np = n + 1;
+    for (int k = 0; k < np; k++)
+      for (int j = 0; j < np; j++)
+        for (int i = 0; i < np; i++)
+          mesh->add_point(Point(i, j, k + 0.1*i));
+
+    const int tets[6][4] = { {0,1,3,7}, {0,1,5,7}, {0,2,3,7}, {0,2,6,7}, {0,4,5,7}, {0,4,6,7} };
+    VMesh::Node::array_type nodes(4);
+    for (int k = 0; k < n; k++)
+      for (int j = 0; j < n; j++)
+        for (int i = 0; i < n; i++)
+          for (int t = 0; t < 6; t++)
+          {
+            for (int c = 0; c < 4; c++)
+            {
+              const int corner = tets[t][c];
+              nodes[c] = (i + (corner & 1)) + np*((j + ((corner >> 1) & 1)) + np*(k + ((corner >> 2) & 1)));
+            }
+            mesh->add_elem(nodes);
+          }
+    field->vfield()->resize_values();
+    return field;
+  }
+
+  double meshMetric(VMesh* mesh, VMesh::Elem::index_type idx, const std::string& metric)
+  {
+    if (metric == "scaled_jacobian") return mesh->scaled_jacobian_metric(idx);
+    if (metric == "jacobian") return mesh->jacobian_metric(idx);
+    if (metric == "volume") return mesh->volume_metric(idx);
+    return mesh->inscribed_circumscribed_radius_metric(idx);
+  }
+}
+
+TEST(GetMeshQualityFieldAlgoTests, MatchesMeshMetrics)
+{
+  FieldHandle input = tetGrid(20);
+  VMesh* mesh = input->vmesh();
+
+  const char* metrics[] = { "scaled_jacobian", "jacobian", "volume", "insc_circ_ratio" };
+  for (int m = 0; m < 4; m++)
+  {
+    GetMeshQualityFieldAlgo algo;
+    algo.set_option(Parameters::QualityMetric, metrics[m]);
+    FieldHandle output;
+    GetMeshQualityFieldAlgo::QualitySummary summary;
+    ASSERT_TRUE(algo.runImpl(input, output, summary));
+
+    VField* ofield = output->vfield();
+    ASSERT_TRUE(ofield->is_constantdata());
+    ASSERT_EQ(mesh->num_elems(), ofield->num_values());
+
+    size_type num_inverted = 0;
+    for (VMesh::Elem::index_type idx = 0; idx < mesh->num_elems(); idx++)
+    {
+      double value;
+      ofield->get_value(value, idx);
+      EXPECT_NEAR(meshMetric(mesh, idx, metrics[m]), value, 1e-10);
+      if (mesh->jacobian_metric(idx) <= 0.0) num_inverted++;
+    }
+
+    EXPECT_EQ(mesh->num_elems(), summary.num_elems);
+    EXPECT_EQ(num_inverted, summary.num_inverted);
+    ASSERT_EQ(4, summary.metrics.size());
+    EXPECT_EQ(metrics[m], summary.metrics[m].name);
+
+    size_type total = 0;
+    for (size_t b = 0; b < summary.histogram.size(); b++) total += summary.histogram[b];
+    EXPECT_EQ(20, summary.histogram.size());
+    EXPECT_EQ(mesh->num_elems(), total);
+  }
+}
+
+TEST(GetMeshQualityFieldAlgoTests, SummarizesCubeGrid)
+{
+  FieldHandle input = tetGrid(4);
+
+  GetMeshQualityFieldAlgo algo;
+  algo.set_option(Parameters::QualityMetric, "volume");
+  algo.set(Parameters::NumHistogramBins, 5);
+  FieldHandle output;
+  GetMeshQualityFieldAlgo::QualitySummary summary;
+  ASSERT_TRUE(algo.runImpl(input, output, summary));
+
+  const GetMeshQualityFieldAlgo::MetricSummary& volume = summary.metrics[2];
+  // Half of the tetrahedra in each cube have a negative orientation
+  EXPECT_EQ(384, summary.num_elems);
+  EXPECT_EQ(192, summary.num_inverted);
+  EXPECT_NEAR(-1.0/6.0, volume.min, 1e-12);
+  EXPECT_NEAR(1.0/6.0, volume.max, 1e-12);
+  EXPECT_NEAR(0.0, volume.mean, 1e-12);
+  EXPECT_EQ(summary.num_elems, summary.histogram.front() + summary.histogram.back());
+  EXPECT_EQ(5, summary.histogram.size());
+  EXPECT_FALSE(summary.report().empty());
+}
+
+TEST(GetMeshQualityFieldAlgoTests, CountsDegenerateElementsSeparately)
+{
+  FieldHandle input = tetGrid(2);
+  VMesh* mesh = input->vmesh();
+  const size_type num_valid = mesh->num_elems();
+
+  // A tetrahedron collapsed to a point has zero determinant and zero edge
+  // lengths, so its scaled jacobian is 0/0
+  VMesh::Node::array_type nodes(4);
+  for (int c = 0; c < 4; c++) nodes[c] = mesh->add_point(Point(0.5, 0.5, 0.5));
+  mesh->add_elem(nodes);
+  input->vfield()->resize_values();
+
+  GetMeshQualityFieldAlgo algo;
+  algo.set_option(Parameters::QualityMetric, "scaled_jacobian");
+  FieldHandle output;
+  GetMeshQualityFieldAlgo::QualitySummary summary;
+  ASSERT_TRUE(algo.runImpl(input, output, summary));
+
+  double value;
+  output->vfield()->get_value(value, VMesh::index_type(num_valid));
+  EXPECT_TRUE(std::isnan(value));
+
+  const GetMeshQualityFieldAlgo::MetricSummary& scaled = summary.metrics[0];
+  EXPECT_EQ(num_valid + 1, summary.num_elems);
+  EXPECT_EQ(1, scaled.num_nonfinite);
+  EXPECT_TRUE(std::isfinite(scaled.min));
+  EXPECT_TRUE(std::isfinite(scaled.max));
+  EXPECT_TRUE(std::isfinite(scaled.mean));
+  EXPECT_LE(scaled.min, scaled.mean);
+  EXPECT_LE(scaled.mean, scaled.max);
+
+  // The jacobian and volume of the collapsed element are zero
+  EXPECT_EQ(0, summary.metrics[1].num_nonfinite);
+  EXPECT_EQ(0, summary.metrics[2].num_nonfinite);
+
+  size_type total = 0;
+  for (size_t b = 0; b < summary.histogram.size(); b++) total += summary.histogram[b];
+  EXPECT_EQ(num_valid, total);
+  EXPECT_NE(std::string::npos, summary.report().find("non-finite 1"));
+}
+
+TEST(GetMeshQualityFieldAlgoTests, ReturnsFalseForNullInput)
+{
+  GetMeshQualityFieldAlgo algo;
+  FieldHandle output;
+  EXPECT_FALSE(algo.runImpl(FieldHandle(), output));
+}
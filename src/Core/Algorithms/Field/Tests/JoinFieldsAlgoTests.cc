@@ -38,6 +38,7 @@
 #include <Testing/Utils/SCIRunUnitTests.h>
 #include <Testing/Utils/MatrixTestUtilities.h>
 #include <Testing/Utils/SCIRunFieldSamples.h>
+#include <Testing/Utils/FieldTestUtilities.h>
 
 #include <Core/Logging/Log.h>
 
@@ -124,6 +125,102 @@ TEST_F(JoinFieldsAlgoTests, CanJoinMultipleLatVolsGeneric)
   EXPECT_EQ(914, output->vmesh()->num_nodes());
 }
 
+TEST_F(JoinFieldsAlgoTests, JoiningFieldWithItselfMergesNodesAndElements)
+{
+  JoinFieldsAlgo algo;
+  algo.set(JoinFieldsAlgo::MergeElems, true);
+
+  FieldHandle cube = CubeTetVolConstantBasis(INT_E);
+  FieldList input;
+  input.push_back(cube);
+  input.push_back(cube);
+
+  FieldHandle output;
+  EXPECT_TRUE(algo.runImpl(input, output));
+  EXPECT_EQ(cube->vmesh()->num_nodes(), output->vmesh()->num_nodes());
+  EXPECT_EQ(cube->vmesh()->num_elems(), output->vmesh()->num_elems());
+}
+
+namespace
+{
+  FieldHandle TranslatedTetrahedron(double dx)
+  {
+    FieldHandle field = TetrahedronTetVolLinearBasis(DOUBLE_E);
+    VMesh* mesh = field->vmesh();
+    Point p;
+    for (VMesh::Node::index_type i = 0; i < mesh->num_nodes(); ++i)
+    {
+      mesh->get_center(p, i);
+      mesh->set_point(p + Vector(dx, 0.0, 0.0), i);
+    }
+    return field;
+  }
+}
+
+TEST_F(JoinFieldsAlgoTests, NodesWithinToleranceOfAChainAreMerged)
+{
+  JoinFieldsAlgo algo;
+  algo.set(JoinFieldsAlgo::Tolerance, 0.1);
+
+  // Each copy is within the tolerance of the previous one, but not of the
+  // one before that: merging is transitive, so all copies weld together.
+  FieldList input;
+  for (int k = 0; k < 4; ++k)
+    input.push_back(TranslatedTetrahedron(0.06*k));
+
+  FieldHandle output;
+  ASSERT_TRUE(algo.runImpl(input, output));
+  EXPECT_EQ(4, output->vmesh()->num_nodes());
+  EXPECT_EQ(4, output->vmesh()->num_elems());
+
+  // The weld keeps the position of the first node of a class
+  Point expected, actual;
+  for (VMesh::Node::index_type i = 0; i < 4; ++i)
+  {
+    input[0]->vmesh()->get_center(expected, i);
+    output->vmesh()->get_center(actual, i);
+    EXPECT_EQ(expected, actual);
+  }
+
+  // A gap larger than the tolerance splits the chain
+  input.push_back(TranslatedTetrahedron(0.06*3 + 0.15));
+  ASSERT_TRUE(algo.runImpl(input, output));
+  EXPECT_EQ(8, output->vmesh()->num_nodes());
+  EXPECT_EQ(5, output->vmesh()->num_elems());
+}
+
+TEST_F(JoinFieldsAlgoTests, NumberingDoesNotDependOnThreadCount)
+{
+  JoinFieldsAlgo algo;
+  algo.set(JoinFieldsAlgo::MergeElems, true);
+
+  // Two grids above the threading threshold that overlap in half their
+  // cubes, offset by less than the tolerance
+  FieldList input;
+  input.push_back(TetVolGrid(12, LINEARDATA_E));
+  input.push_back(TetVolGrid(12, LINEARDATA_E, Point(6.0 + 1e-8, 0.0, 0.0)));
+  input.push_back(TetVolGrid(12, LINEARDATA_E, Point(0.0, 6.0 - 1e-8, 0.0)));
+
+  FieldHandle serial;
+  {
+    ScopedNumCores cores(1);
+    ASSERT_TRUE(algo.runImpl(input, serial));
+  }
+  // The overlap of the last two grids lies inside the first one
+  const size_type gridNodes = 13*13*13, sharedNodes = 7*13*13;
+  EXPECT_EQ(3*gridNodes - 2*sharedNodes, serial->vmesh()->num_nodes());
+  const size_type gridElems = 6*12*12*12, sharedElems = 6*6*12*12;
+  EXPECT_EQ(3*gridElems - 2*sharedElems, serial->vmesh()->num_elems());
+
+  for (unsigned int nproc : { 2u, 3u, 4u })
+  {
+    ScopedNumCores cores(nproc);
+    FieldHandle threaded;
+    ASSERT_TRUE(algo.runImpl(input, threaded));
+    EXPECT_TRUE(same_field(serial, threaded)) << nproc << " threads";
+  }
+}
+
 #if GTEST_HAS_COMBINE
 
 // Get Parameterized Tests
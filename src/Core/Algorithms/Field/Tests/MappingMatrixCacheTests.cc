@@ -0,0 +1,169 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+#include <gtest/gtest.h>
+
+#include <Core/Datatypes/SparseRowMatrix.h>
+#include <Core/Algorithms/Legacy/Fields/Mapping/MappingMatrixCache.h>
+#include <Core/Algorithms/Legacy/Fields/Mapping/BuildMappingMatrixAlgo.h>
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Algorithms::Fields;
+using namespace SCIRun::Core::Algorithms;
+
+namespace
+{
+  SparseRowMatrixHandle mappingMatrix()
+  {
+    std::vector<SparseRowMatrix::Triplet> triplets;
+    for (int i = 0; i < 100; i++)
+    {
+      triplets.push_back(SparseRowMatrix::Triplet(i, (7*i) % 30, 0.25));
+      triplets.push_back(SparseRowMatrix::Triplet(i, (7*i + 1) % 30, 0.75));
+    }
+    SparseRowMatrixHandle matrix(new SparseRowMatrix(100, 30));
+    matrix->setFromTriplets(triplets.begin(), triplets.end());
+    return matrix;
+  }
+
+  // Header of a cache file: magic, three 64 bit sizes and two 32 bit ones
+  const std::streamoff HEADER_SIZE = 8 + 3*8 + 2*4;
+
+  void overwriteIndex(const boost::filesystem::path& file, std::streamoff offset, index_type value)
+  {
+    std::fstream stream(file.string().c_str(), std::ios::in | std::ios::out | std::ios::binary);
+    stream.seekp(offset);
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+}
+
+class MappingMatrixCacheTests : public ::testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    directory_ = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("scirun_mapping_cache_test_%%%%-%%%%-%%%%");
+  }
+
+  virtual void TearDown()
+  {
+    boost::system::error_code ec;
+    boost::filesystem::remove_all(directory_, ec);
+  }
+
+  boost::filesystem::path directory_;
+};
+
+TEST(BuildMappingMatrixAlgoTests, CacheIsOffByDefault)
+{
+  BuildMappingMatrixAlgo algo;
+  EXPECT_FALSE(algo.get(Parameters::UseMappingCache).toBool());
+}
+
+TEST_F(MappingMatrixCacheTests, StoredMatrixIsLoadedBack)
+{
+  MappingMatrixCache cache(directory_);
+  auto matrix = mappingMatrix();
+
+  EXPECT_FALSE(cache.load("key"));
+  ASSERT_TRUE(cache.store("key", *matrix));
+
+  auto loaded = cache.load("key");
+  ASSERT_TRUE(loaded != nullptr);
+  EXPECT_EQ(matrix->nrows(), loaded->nrows());
+  EXPECT_EQ(matrix->ncols(), loaded->ncols());
+  EXPECT_EQ(matrix->nonZeros(), loaded->nonZeros());
+  EXPECT_TRUE(matrix->isApprox(*loaded));
+
+  EXPECT_FALSE(cache.load("other"));
+}
+
+TEST_F(MappingMatrixCacheTests, TruncatedEntryIsIgnored)
+{
+  MappingMatrixCache cache(directory_);
+  ASSERT_TRUE(cache.store("key", *mappingMatrix()));
+
+  boost::filesystem::resize_file(cache.directory() / "key.map", 64);
+  EXPECT_FALSE(cache.load("key"));
+}
+
+TEST_F(MappingMatrixCacheTests, ColumnOutOfRangeIsIgnored)
+{
+  MappingMatrixCache cache(directory_);
+  ASSERT_TRUE(cache.store("key", *mappingMatrix()));
+
+  // First column index, right after the 101 row offsets
+  const std::streamoff columns = HEADER_SIZE + 101*sizeof(index_type);
+  overwriteIndex(cache.directory() / "key.map", columns, 30);
+  EXPECT_FALSE(cache.load("key"));
+  overwriteIndex(cache.directory() / "key.map", columns, -1);
+  EXPECT_FALSE(cache.load("key"));
+  overwriteIndex(cache.directory() / "key.map", columns, 29);
+  EXPECT_TRUE(cache.load("key") != nullptr);
+}
+
+TEST_F(MappingMatrixCacheTests, DecreasingRowOffsetsAreIgnored)
+{
+  MappingMatrixCache cache(directory_);
+  ASSERT_TRUE(cache.store("key", *mappingMatrix()));
+
+  // Rows hold two entries each, so offset 1 is 2 and offset 2 is 4
+  overwriteIndex(cache.directory() / "key.map", HEADER_SIZE + sizeof(index_type), 5);
+  EXPECT_FALSE(cache.load("key"));
+}
+
+#ifndef _WIN32
+TEST_F(MappingMatrixCacheTests, DirectoryIsOwnerOnly)
+{
+  MappingMatrixCache cache(directory_);
+  ASSERT_TRUE(cache.store("key", *mappingMatrix()));
+  EXPECT_EQ(boost::filesystem::owner_all, boost::filesystem::status(directory_).permissions());
+}
+
+TEST_F(MappingMatrixCacheTests, SharedDirectoryIsNotUsed)
+{
+  MappingMatrixCache cache(directory_);
+  ASSERT_TRUE(cache.store("key", *mappingMatrix()));
+
+  boost::filesystem::permissions(directory_, boost::filesystem::owner_all | boost::filesystem::others_write);
+  EXPECT_FALSE(cache.load("key"));
+  EXPECT_FALSE(cache.store("other", *mappingMatrix()));
+}
+
+TEST_F(MappingMatrixCacheTests, SymlinkedEntryIsNotFollowed)
+{
+  MappingMatrixCache cache(directory_);
+  ASSERT_TRUE(cache.store("key", *mappingMatrix()));
+
+  boost::filesystem::create_symlink(directory_ / "key.map", directory_ / "link.map");
+  EXPECT_FALSE(cache.load("link"));
+}
+#endif
@@ -0,0 +1,247 @@
+/*
+ For more information, please see: http://software.sci.utah.edu
+ 
+ The MIT License
+ 
+ Copyright (c) 2015 Scientific Computing and Imaging Institute,
+ University of Utah.
+ 
+ License for the specific language governing rights and limitations under
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included
+ in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+#include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/Legacy/Field/FieldInformation.h>
+#include <Core/Algorithms/Legacy/Fields/FilterFieldData/DilateFieldData.h>
+#include <Core/Algorithms/Legacy/Fields/FilterFieldData/ErodeFieldData.h>
+#include <Testing/Utils/SCIRunFieldSamples.h>
+#include <Testing/Utils/FieldTestUtilities.h>
+
+#include <algorithm>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Algorithms::Fields;
+using namespace SCIRun::TestUtils;
+
+namespace
+{
+  // Few distinct values, so there are plateaus and ties.
+  void fillValues(FieldHandle field)
+  {
+    VField* vfield = field->vfield();
+    for (VField::index_type i = 0; i < vfield->num_values(); ++i)
+      vfield->set_value(static_cast<double>((i*7919) % 23 + 3*((i*104729) % 5)), i);
+  }
+
+  FieldHandle makeGrid(const std::string& meshType, int basis, const std::string& dataType,
+    const std::vector<size_type>& dims)
+  {
+    FieldInformation fi(meshType, basis, dataType);
+    const size_type extra = (basis == 0) ? 1 : 0;
+    MeshHandle mesh;
+    if (dims.size() == 3)
+      mesh = CreateMesh(fi, dims[0] + extra, dims[1] + extra, dims[2] + extra, Point(0.0,0.0,0.0), Point(1.0,1.0,1.0));
+    else
+      mesh = CreateMesh(fi, dims[0] + extra, dims[1] + extra, Point(0.0,0.0,0.0), Point(1.0,1.0,0.0));
+    FieldHandle field = CreateField(fi, mesh);
+    fillValues(field);
+    return field;
+  }
+
+  std::vector<double> values(FieldHandle field)
+  {
+    VField* vfield = field->vfield();
+    std::vector<double> result(vfield->num_values());
+    for (VField::index_type i = 0; i < vfield->num_values(); ++i)
+      vfield->get_value(result[i], i);
+    return result;
+  }
+
+  bool better(bool dilate, double a, double b)
+  {
+    return dilate ? (a > b) : (a < b);
+  }
+
+  // The per value loop of the SCIRun 4 filters: every iteration replaces a
+  // value by the best of itself and its mesh neighbors.
+  std::vector<double> neighborsReference(FieldHandle input, bool dilate, int iterations)
+  {
+    VMesh* mesh = input->vmesh();
+    const bool elems = (input->vfield()->basis_order() == 0);
+    mesh->synchronize(elems ? Mesh::ELEM_NEIGHBORS_E : Mesh::NODE_NEIGHBORS_E);
+
+    auto data = values(input);
+    std::vector<double> next(data.size());
+    std::vector<index_type> neighbors;
+    for (int it = 0; it < iterations; ++it)
+    {
+      for (index_type idx = 0; idx < static_cast<index_type>(data.size()); ++idx)
+      {
+        if (elems)
+        {
+          VMesh::Elem::array_type array;
+          mesh->get_neighbors(array, VMesh::Elem::index_type(idx));
+          neighbors.assign(array.begin(), array.end());
+        }
+        else
+        {
+          VMesh::Node::array_type array;
+          mesh->get_neighbors(array, VMesh::Node::index_type(idx));
+          neighbors.assign(array.begin(), array.end());
+        }
+        double val = data[idx];
+        for (auto n : neighbors)
+          if (better(dilate, data[n], val)) val = data[n];
+        next[idx] = val;
+      }
+      data.swap(next);
+    }
+    return data;
+  }
+
+  // Best value within a box of 2*radius+1 values per axis, clipped at the
+  // boundary of the grid.
+  std::vector<double> boxReference(FieldHandle input, bool dilate, int radius)
+  {
+    VMesh::dimension_type dim;
+    input->vfield()->get_values_dimension(dim);
+    size_type dims[3] = { 1, 1, 1 };
+    for (size_t k = 0; k < dim.size(); ++k) dims[k] = dim[k];
+
+    auto data = values(input);
+    std::vector<double> result(data.size());
+    for (size_type k = 0; k < dims[2]; ++k)
+      for (size_type j = 0; j < dims[1]; ++j)
+        for (size_type i = 0; i < dims[0]; ++i)
+        {
+          double val = data[i + dims[0]*(j + dims[1]*k)];
+          for (size_type c = std::max<size_type>(0, k - radius); c <= std::min<size_type>(dims[2]-1, k + radius); ++c)
+            for (size_type b = std::max<size_type>(0, j - radius); b <= std::min<size_type>(dims[1]-1, j + radius); ++b)
+              for (size_type a = std::max<size_type>(0, i - radius); a <= std::min<size_type>(dims[0]-1, i + radius); ++a)
+              {
+                const double nval = data[a + dims[0]*(b + dims[1]*c)];
+                if (better(dilate, nval, val)) val = nval;
+              }
+          result[i + dims[0]*(j + dims[1]*k)] = val;
+        }
+    return result;
+  }
+
+  std::vector<double> filter(FieldHandle input, bool dilate, int iterations, const std::string& neighborhood)
+  {
+    DilateFieldDataAlgo dilateAlgo;
+    ErodeFieldDataAlgo erodeAlgo;
+    MorphologicalFilterAlgo& algo = dilate ? static_cast<MorphologicalFilterAlgo&>(dilateAlgo) : erodeAlgo;
+    algo.set(Parameters::MorphologyIterations, iterations);
+    algo.set_option(Parameters::MorphologyNeighborhood, neighborhood);
+
+    FieldHandle output;
+    EXPECT_TRUE(algo.runImpl(input, output));
+    if (!output)
+      return std::vector<double>();
+    EXPECT_NE(input, output);
+    return values(output);
+  }
+
+  void expectNeighborsMatch(FieldHandle input, const std::vector<int>& iterations)
+  {
+    const auto before = values(input);
+    for (bool dilate : { true, false })
+    {
+      for (int it : iterations)
+        EXPECT_EQ(neighborsReference(input, dilate, it), filter(input, dilate, it, "neighbors"))
+          << (dilate ? "dilate " : "erode ") << it << " iterations";
+    }
+    EXPECT_EQ(before, values(input));
+  }
+
+  void expectBoxMatches(FieldHandle input, const std::vector<int>& radii)
+  {
+    for (bool dilate : { true, false })
+    {
+      for (int radius : radii)
+        EXPECT_EQ(boxReference(input, dilate, radius), filter(input, dilate, radius, "box"))
+          << (dilate ? "dilate " : "erode ") << "radius " << radius;
+    }
+  }
+}
+
+TEST(MorphologicalFilterTests, LatVolNeighborsMatchPerValueLoop)
+{
+  expectNeighborsMatch(makeGrid("LatVolMesh", 1, "double", { 9, 7, 5 }), { 0, 1, 3 });
+  expectNeighborsMatch(makeGrid("LatVolMesh", 0, "int", { 6, 1, 8 }), { 1, 2, 9 });
+}
+
+TEST(MorphologicalFilterTests, ImageMeshNeighborsMatchPerValueLoop)
+{
+  expectNeighborsMatch(makeGrid("ImageMesh", 1, "unsigned_char", { 11, 8 }), { 1, 4 });
+  expectNeighborsMatch(makeGrid("ImageMesh", 0, "float", { 13, 6 }), { 1, 2, 3 });
+}
+
+TEST(MorphologicalFilterTests, LatVolBoxMatchesNaiveBox)
+{
+  expectBoxMatches(makeGrid("LatVolMesh", 1, "short", { 9, 7, 5 }), { 0, 1, 2, 6 });
+  expectBoxMatches(makeGrid("LatVolMesh", 0, "double", { 10, 4, 7 }), { 1, 3 });
+}
+
+TEST(MorphologicalFilterTests, ImageMeshBoxMatchesNaiveBox)
+{
+  expectBoxMatches(makeGrid("ImageMesh", 1, "double", { 12, 9 }), { 1, 2, 5 });
+  expectBoxMatches(makeGrid("ImageMesh", 0, "int", { 7, 15 }), { 1, 4 });
+}
+
+TEST(MorphologicalFilterTests, TetVolFrontierMatchesPerValueLoop)
+{
+  auto nodes = TetVolGrid(4, LINEARDATA_E);
+  fillValues(nodes);
+  expectNeighborsMatch(nodes, { 1, 2, 3, 7 });
+
+  auto elems = TetVolGrid(3, CONSTANTDATA_E);
+  fillValues(elems);
+  expectNeighborsMatch(elems, { 1, 2, 5, 12 });
+}
+
+TEST(MorphologicalFilterTests, BoxFallsBackToNeighborsOnTetVol)
+{
+  auto nodes = TetVolGrid(3, LINEARDATA_E);
+  fillValues(nodes);
+  EXPECT_EQ(neighborsReference(nodes, true, 2), filter(nodes, true, 2, "box"));
+}
+
+TEST(MorphologicalFilterTests, ThreadedPathsMatchOnLargeGrids)
+{
+  // Above 10000 values the passes are split over the threads.
+  ScopedNumCores cores(4);
+
+  auto latvol = makeGrid("LatVolMesh", 1, "float", { 30, 25, 20 });
+  expectNeighborsMatch(latvol, { 1, 3 });
+  expectBoxMatches(latvol, { 2 });
+
+  auto image = makeGrid("ImageMesh", 0, "double", { 120, 90 });
+  expectNeighborsMatch(image, { 2 });
+  expectBoxMatches(image, { 3 });
+
+  auto elems = TetVolGrid(12, CONSTANTDATA_E);
+  fillValues(elems);
+  expectNeighborsMatch(elems, { 1, 4 });
+}
@@ -0,0 +1,184 @@
+/*
+ For more information, please see: http://software.sci.utah.edu
+ 
+ The MIT License
+ 
+ Copyright (c) 2015 Scientific Computing and Imaging Institute,
+ University of Utah.
+ 
+ License for the specific language governing rights and limitations under
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included
+ in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+#include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Algorithms/Legacy/Fields/RefineMesh/RefineMeshTetVolAlgoV.h>
+#include <Core/Algorithms/Legacy/Fields/RefineMesh/RefineMeshTriSurfAlgoV.h>
+#include <Testing/Utils/SCIRunFieldSamples.h>
+#include <Testing/Utils/FieldTestUtilities.h>
+
+#include <cmath>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Algorithms::Fields;
+using namespace SCIRun::TestUtils;
+
+namespace
+{
+  // Order dependent checksum of node positions, element connectivity and
+  // values. The expected sums below were recorded with the serial
+  // RefineMesh loops that the edge table version replaced.
+  unsigned long long checksum(FieldHandle field)
+  {
+    unsigned long long sum = 1469598103934665603ULL;
+    auto mix = [&sum](long long v) { sum = (sum ^ static_cast<unsigned long long>(v)) * 1099511628211ULL; };
+
+    VMesh* mesh = field->vmesh();
+    Point p;
+    for (VMesh::Node::index_type i = 0; i < mesh->num_nodes(); ++i)
+    {
+      mesh->get_center(p, i);
+      mix(llround(p.x()*1024)); mix(llround(p.y()*1024)); mix(llround(p.z()*1024));
+    }
+    VMesh::Node::array_type nodes;
+    for (VMesh::Elem::index_type i = 0; i < mesh->num_elems(); ++i)
+    {
+      mesh->get_nodes(nodes, i);
+      for (auto n : nodes) mix(n);
+    }
+    VField* vfield = field->vfield();
+    for (VMesh::index_type i = 0; i < vfield->num_values(); ++i)
+    {
+      double v;
+      vfield->get_value(v, i);
+      mix(llround(v*1024));
+    }
+    return sum;
+  }
+
+  template <class Algo>
+  FieldHandle refine(FieldHandle input, const std::string& select, double isoval, unsigned int numCores)
+  {
+    ScopedNumCores cores(numCores);
+    Algo algo;
+    FieldHandle output;
+    EXPECT_TRUE(algo.runImpl(input, output, select, isoval));
+    return output;
+  }
+}
+
+TEST(RefineMeshTests, SingleTetIsSplitIntoEight)
+{
+  FieldHandle input = TetrahedronTetVolLinearBasis(DOUBLE_E);
+  FieldHandle output = refine<RefineMeshTetVolAlgoV>(input, "all", 0, 1);
+  ASSERT_TRUE(output != nullptr);
+
+  VMesh* mesh = output->vmesh();
+  EXPECT_EQ(10, mesh->num_nodes());
+  EXPECT_EQ(8, mesh->num_elems());
+
+  // The original nodes keep their numbers, the midpoints follow in edge order.
+  VMesh* imesh = input->vmesh();
+  Point p, q;
+  for (VMesh::Node::index_type i = 0; i < 4; ++i)
+  {
+    imesh->get_center(p, i);
+    mesh->get_center(q, i);
+    EXPECT_EQ(p, q);
+  }
+  imesh->synchronize(Mesh::EDGES_E);
+  VMesh::Node::array_type enodes;
+  for (VMesh::Edge::index_type e = 0; e < imesh->num_edges(); ++e)
+  {
+    imesh->get_nodes(enodes, e);
+    Point a, b;
+    imesh->get_center(a, enodes[0]);
+    imesh->get_center(b, enodes[1]);
+    mesh->get_center(q, VMesh::Node::index_type(4 + e));
+    EXPECT_EQ(Point(0.5*(a + b)), q);
+  }
+}
+
+TEST(RefineMeshTests, SmallTetVolUsesOneThread)
+{
+  FieldHandle input = TetVolGrid(3, LINEARDATA_E);
+  ASSERT_LT(input->vmesh()->num_elems(), 10000);
+  FieldHandle serial = refine<RefineMeshTetVolAlgoV>(input, "all", 0, 1);
+  EXPECT_EQ(8*input->vmesh()->num_elems(), serial->vmesh()->num_elems());
+  EXPECT_TRUE(same_field(serial, refine<RefineMeshTetVolAlgoV>(input, "all", 0, 4)));
+}
+
+TEST(RefineMeshTests, ThreadedTetVolMatchesSerialNumbering)
+{
+  FieldHandle input = TetVolGrid(12, LINEARDATA_E);
+  const VMesh::size_type num_elems = input->vmesh()->num_elems();
+  ASSERT_GE(num_elems, 10000);
+
+  FieldHandle all = refine<RefineMeshTetVolAlgoV>(input, "all", 0, 1);
+  input->vmesh()->synchronize(Mesh::EDGES_E);
+  EXPECT_EQ(input->vmesh()->num_nodes() + input->vmesh()->num_edges(), all->vmesh()->num_nodes());
+  EXPECT_EQ(8*num_elems, all->vmesh()->num_elems());
+  EXPECT_EQ(14977143840390016387ULL, checksum(all));
+
+  // Selecting half of the nodes exercises the partial split templates.
+  const double isoval = 0.5*input->vmesh()->num_nodes();
+  FieldHandle partial = refine<RefineMeshTetVolAlgoV>(input, "greaterthan", isoval, 1);
+  EXPECT_EQ(200451550633041859ULL, checksum(partial));
+
+  for (unsigned int n : {2u, 3u, 4u})
+  {
+    EXPECT_TRUE(same_field(all, refine<RefineMeshTetVolAlgoV>(input, "all", 0, n))) << n << " threads";
+    EXPECT_TRUE(same_field(partial, refine<RefineMeshTetVolAlgoV>(input, "greaterthan", isoval, n))) << n << " threads";
+  }
+}
+
+TEST(RefineMeshTests, ThreadedTetVolWithElementDataMatchesSerialNumbering)
+{
+  FieldHandle input = TetVolGrid(12, CONSTANTDATA_E);
+  const double isoval = 0.5*input->vmesh()->num_elems();
+  FieldHandle serial = refine<RefineMeshTetVolAlgoV>(input, "lessthan", isoval, 1);
+  EXPECT_EQ(456628600196760331ULL, checksum(serial));
+  for (unsigned int n : {2u, 4u})
+    EXPECT_TRUE(same_field(serial, refine<RefineMeshTetVolAlgoV>(input, "lessthan", isoval, n))) << n << " threads";
+}
+
+TEST(RefineMeshTests, ThreadedTriSurfMatchesSerialNumbering)
+{
+  FieldHandle input = TriSurfGrid(72, LINEARDATA_E);
+  const VMesh::size_type num_elems = input->vmesh()->num_elems();
+  ASSERT_GE(num_elems, 10000);
+
+  FieldHandle all = refine<RefineMeshTriSurfAlgoV>(input, "all", 0, 1);
+  input->vmesh()->synchronize(Mesh::EDGES_E);
+  EXPECT_EQ(input->vmesh()->num_nodes() + input->vmesh()->num_edges(), all->vmesh()->num_nodes());
+  EXPECT_EQ(4*num_elems, all->vmesh()->num_elems());
+  EXPECT_EQ(3419839580277966846ULL, checksum(all));
+
+  const double isoval = 0.5*input->vmesh()->num_nodes();
+  FieldHandle partial = refine<RefineMeshTriSurfAlgoV>(input, "greaterthan", isoval, 1);
+  EXPECT_EQ(16900925073140206864ULL, checksum(partial));
+
+  for (unsigned int n : {2u, 3u, 4u})
+  {
+    EXPECT_TRUE(same_field(all, refine<RefineMeshTriSurfAlgoV>(input, "all", 0, n))) << n << " threads";
+    EXPECT_TRUE(same_field(partial, refine<RefineMeshTriSurfAlgoV>(input, "greaterthan", isoval, n))) << n << " threads";
+  }
+}
@@ -0,0 +1,327 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+
+#include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/Legacy/Field/FieldInformation.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
+#include <Core/Datatypes/MatrixTypeConversions.h>
+#include <Core/Algorithms/Legacy/Fields/MeshData/ReorderMesh.h>
+#include <Testing/Utils/MatrixTestUtilities.h>
+
+#include <algorithm>
+#include <random>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Algorithms::Fields;
+using namespace SCIRun::TestUtils;
+
+namespace
+{
+  double valueAt(const Point& p)
+  {
+    return p.x() + 10.0*p.y() + 100.0*p.z();
+  }
+
+  // Tetrahedral grid of n^3 cubes with randomly numbered nodes and elements,
+  // as they come out of an external mesher.
+  FieldHandle shuffledTetGrid(int n, int basis)
+  {
+    FieldInformation fi("TetVolMesh", basis, "double");
+    FieldHandle field = CreateField(fi);
+    VMesh* mesh = field->vmesh();
+
+    std::mt19937 rng(1234);
+    const int np = n + 1;
+    std::vector<index_type> node_ids(np*np*np);
+    for (size_t i = 0; i < node_ids.size(); i++) node_ids[i] = i;
+    std::shuffle(node_ids.begin(), node_ids.end(), rng);
+
+    std::vector<Point> points(node_ids.size());
+    for (int k = 0; k < np; k++)
+      for (int j = 0; j < np; j++)
+        for (int i = 0; i < np; i++)
+          points[node_ids[i + np*(j + np*k)]] = Point(i, j, k);
+    for (size_t i = 0; i < points.size(); i++) mesh->add_point(points[i]);
+
+    const int tets[6][4] = { {0,1,3,7}, {0,1,5,7}, {0,2,3,7}, {0,2,6,7}, {0,4,5,7}, {0,4,6,7} };
+    std::vector<VMesh::Node::array_type> elems;
+    for (int k = 0; k < n; k++)
+      for (int j = 0; j < n; j++)
+        for (int i = 0; i < n; i++)
+          for (int t = 0; t < 6; t++)
+          {
+            VMesh::Node::array_type nodes(4);
+            for (int c = 0; c < 4; c++)
+            {
+              const int corner = tets[t][c];
+              nodes[c] = node_ids[(i + (corner & 1)) + np*((j + ((corner >> 1) & 1)) + np*(k + ((corner >> 2) & 1)))];
+            }
+            elems.push_back(nodes);
+          }
+    std::shuffle(elems.begin(), elems.end(), rng);
+    for (size_t e = 0; e < elems.size(); e++) mesh->add_elem(elems[e]);
+
+    VField* vfield = field->vfield();
+    vfield->resize_values();
+    if (basis == 1)
+    {
+      for (VMesh::Node::index_type idx = 0; idx < mesh->num_nodes(); idx++)
+      {
+        Point p;
+        mesh->get_center(p, idx);
+        vfield->set_value(valueAt(p), idx);
+      }
+    }
+    else if (basis == 0)
+    {
+      for (VMesh::Elem::index_type idx = 0; idx < mesh->num_elems(); idx++)
+      {
+        Point p;
+        mesh->get_center(p, idx);
+        vfield->set_value(valueAt(p), idx);
+      }
+    }
+    return field;
+  }
+
+  index_type bandwidth(FieldHandle field)
+  {
+    VMesh* mesh = field->vmesh();
+    VMesh::Node::array_type nodes;
+    index_type bw = 0;
+    for (VMesh::Elem::index_type idx = 0; idx < mesh->num_elems(); idx++)
+    {
+      mesh->get_nodes(nodes, idx);
+      for (size_t a = 0; a < nodes.size(); a++)
+        for (size_t b = 0; b < nodes.size(); b++)
+          bw = std::max(bw, static_cast<index_type>(std::abs(nodes[a] - nodes[b])));
+    }
+    return bw;
+  }
+
+  // Sparsity of the finite element matrix of a mesh
+  SparseRowMatrixHandle nodeGraphMatrix(FieldHandle field)
+  {
+    VMesh* mesh = field->vmesh();
+    VMesh::Node::array_type nodes;
+    std::vector<SparseRowMatrix::Triplet> triplets;
+    for (VMesh::Elem::index_type idx = 0; idx < mesh->num_elems(); idx++)
+    {
+      mesh->get_nodes(nodes, idx);
+      for (size_t a = 0; a < nodes.size(); a++)
+        for (size_t b = 0; b < nodes.size(); b++)
+          triplets.push_back(SparseRowMatrix::Triplet(nodes[a], nodes[b], a == b ? 3.0 : -1.0));
+    }
+    SparseRowMatrixHandle mat(new SparseRowMatrix(mesh->num_nodes(), mesh->num_nodes()));
+    mat->setFromTriplets(triplets.begin(), triplets.end());
+    return mat;
+  }
+
+  // Average distance between the centers of consecutive elements
+  double meanStep(FieldHandle field)
+  {
+    VMesh* mesh = field->vmesh();
+    Point p, q;
+    double sum = 0.0;
+    mesh->get_center(p, VMesh::Elem::index_type(0));
+    for (VMesh::Elem::index_type idx = 1; idx < mesh->num_elems(); idx++)
+    {
+      mesh->get_center(q, idx);
+      sum += (q - p).length();
+      p = q;
+    }
+    return sum / (mesh->num_elems() - 1);
+  }
+
+  void expectValuesFollowMesh(FieldHandle field)
+  {
+    VMesh* mesh = field->vmesh();
+    VField* vfield = field->vfield();
+    Point p;
+    double value;
+    if (vfield->basis_order() == 1)
+    {
+      for (VMesh::Node::index_type idx = 0; idx < mesh->num_nodes(); idx++)
+      {
+        mesh->get_center(p, idx);
+        vfield->get_value(value, idx);
+        ASSERT_DOUBLE_EQ(valueAt(p), value);
+      }
+    }
+    else
+    {
+      for (VMesh::Elem::index_type idx = 0; idx < mesh->num_elems(); idx++)
+      {
+        mesh->get_center(p, idx);
+        vfield->get_value(value, idx);
+        ASSERT_DOUBLE_EQ(valueAt(p), value);
+      }
+    }
+  }
+}
+
+TEST(ReorderMeshAlgoTests, ReverseCuthillMcKeeReducesBandwidth)
+{
+  FieldHandle input = shuffledTetGrid(8, 1);
+
+  ReorderMeshAlgo algo;
+  algo.set_option(Parameters::NodeOrdering, "ReverseCuthillMcKee");
+  FieldHandle output;
+  ASSERT_TRUE(algo.runImpl(input, output));
+
+  EXPECT_EQ(input->vmesh()->num_nodes(), output->vmesh()->num_nodes());
+  EXPECT_EQ(input->vmesh()->num_elems(), output->vmesh()->num_elems());
+  EXPECT_LT(4*bandwidth(output), bandwidth(input));
+  expectValuesFollowMesh(output);
+}
+
+TEST(ReorderMeshAlgoTests, NodeMappingPermutesNodeData)
+{
+  FieldHandle input = shuffledTetGrid(5, 1);
+
+  ReorderMeshAlgo algo;
+  algo.set_option(Parameters::NodeOrdering, "Hilbert");
+  FieldHandle output;
+  MatrixHandle nodeMapping, elemMapping;
+  ASSERT_TRUE(algo.runImpl(input, output, nodeMapping, elemMapping));
+  expectValuesFollowMesh(output);
+
+  auto mapping = matrix_cast::as_sparse(nodeMapping);
+  ASSERT_TRUE(mapping != nullptr);
+  const size_type num_nodes = input->vmesh()->num_nodes();
+  EXPECT_EQ(num_nodes, mapping->nrows());
+  EXPECT_EQ(num_nodes, mapping->ncols());
+  EXPECT_EQ(num_nodes, mapping->nonZeros());
+
+  Eigen::VectorXd in(num_nodes);
+  for (VMesh::Node::index_type idx = 0; idx < num_nodes; idx++) input->vfield()->get_value(in[idx], idx);
+  Eigen::VectorXd out = *mapping * in;
+  for (VMesh::Node::index_type idx = 0; idx < num_nodes; idx++)
+  {
+    double value;
+    output->vfield()->get_value(value, idx);
+    EXPECT_EQ(value, out[idx]);
+  }
+}
+
+TEST(ReorderMeshAlgoTests, ElementsFollowCurveOrder)
+{
+  FieldHandle input = shuffledTetGrid(5, 0);
+
+  ReorderMeshAlgo algo;
+  algo.set_option(Parameters::NodeOrdering, "Morton");
+  algo.set_option(Parameters::ElemOrdering, "Hilbert");
+  FieldHandle output;
+  MatrixHandle nodeMapping, elemMapping;
+  ASSERT_TRUE(algo.runImpl(input, output, nodeMapping, elemMapping));
+  expectValuesFollowMesh(output);
+
+  auto mapping = matrix_cast::as_sparse(elemMapping);
+  ASSERT_TRUE(mapping != nullptr);
+  EXPECT_EQ(input->vmesh()->num_elems(), mapping->nrows());
+
+  // Consecutive elements of a Hilbert order are close to each other
+  EXPECT_LT(4.0*meanStep(output), meanStep(input));
+}
+
+TEST(ReorderMeshAlgoTests, PointCloudIsOrderedAlongCurve)
+{
+  FieldInformation fi("PointCloudMesh", 1, "double");
+  FieldHandle input = CreateField(fi);
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<double> coord(0.0, 1.0);
+  for (int i = 0; i < 200; i++)
+    input->vmesh()->add_point(Point(coord(rng), coord(rng), coord(rng)));
+  input->vfield()->resize_values();
+  for (VMesh::Node::index_type idx = 0; idx < 200; idx++)
+  {
+    Point p;
+    input->vmesh()->get_center(p, idx);
+    input->vfield()->set_value(valueAt(p), idx);
+  }
+
+  ReorderMeshAlgo algo;
+  FieldHandle output;
+  ASSERT_TRUE(algo.runImpl(input, output));
+  EXPECT_EQ(200, output->vmesh()->num_nodes());
+  expectValuesFollowMesh(output);
+}
+
+TEST(ReorderMeshAlgoTests, RejectsRegularMesh)
+{
+  FieldInformation fi("LatVolMesh", 1, "double");
+  MeshHandle mesh = CreateMesh(fi, 2, 3, 4, Point(0,0,0), Point(1,1,1));
+  FieldHandle input = CreateField(fi, mesh);
+
+  ReorderMeshAlgo algo;
+  FieldHandle output;
+  EXPECT_FALSE(algo.runImpl(input, output));
+}
+
+// Downstream effect of the renumbering on the sparse matrix vector product
+// that dominates the iterative solvers.
+TEST(ReorderMeshAlgoTests, DISABLED_BenchmarkSpMVAfterReordering)
+{
+  FieldHandle input = shuffledTetGrid(50, 1);
+
+  ReorderMeshAlgo algo;
+  FieldHandle output;
+  {
+    ScopedTimer t("reordering mesh");
+    ASSERT_TRUE(algo.runImpl(input, output));
+  }
+
+  std::cout << "bandwidth " << bandwidth(input) << " -> " << bandwidth(output) << std::endl;
+
+  SparseRowMatrixHandle original, reordered;
+  {
+    ScopedTimer t("assembling shuffled matrix");
+    original = nodeGraphMatrix(input);
+  }
+  {
+    ScopedTimer t("assembling reordered matrix");
+    reordered = nodeGraphMatrix(output);
+  }
+
+  Eigen::VectorXd x = Eigen::VectorXd::Ones(original->ncols());
+  Eigen::VectorXd y;
+  {
+    ScopedTimer t("100 SpMV shuffled");
+    for (int i = 0; i < 100; i++) y = *original * x;
+  }
+  {
+    ScopedTimer t("100 SpMV reordered");
+    for (int i = 0; i < 100; i++) y = *reordered * x;
+  }
+}
@@ -0,0 +1,327 @@
+/*
+ For more information, please see: http://software.sci.utah.edu
+ 
+ The MIT License
+ 
+ Copyright (c) 2015 Scientific Computing and Imaging Institute,
+ University of Utah.
+ 
+ License for the specific language governing rights and limitations under
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included
+ in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+#include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/Legacy/Field/FieldInformation.h>
+#include <Core/Algorithms/Legacy/Fields/ResampleMesh/ResampleRegularMesh.h>
+#include <Core/GeometryPrimitives/Tensor.h>
+#include <Testing/Utils/FieldTestUtilities.h>
+
+#include <teem/nrrd.h>
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Algorithms::Fields;
+using namespace SCIRun::TestUtils;
+
+namespace
+{
+  struct KernelCase
+  {
+    const char* method;
+    const NrrdKernel* kernel;
+    double parm[3];
+  };
+
+  const KernelCase kernels[] =
+  {
+    { "Box", nrrdKernelBox, { 1.0, 0.0, 0.0 } },
+    { "Tent", nrrdKernelTent, { 1.0, 0.0, 0.0 } },
+    { "Cubic (Catmull-Rom)", nrrdKernelBCCubic, { 1.0, 0.0, 0.5 } },
+    { "Cubic (B-Spline)", nrrdKernelBCCubic, { 1.0, 1.0, 0.0 } },
+    { "Gaussian", nrrdKernelGaussian, { 1.3, 2.5, 0.0 } }
+  };
+
+  // Grid with values that jump between the limits of the integer types, so
+  // the overshoot of the cubic kernels is rounded and clamped at both ends.
+  FieldHandle makeGrid(const std::string& meshType, int basis, const std::string& dataType,
+    const std::vector<size_type>& dims)
+  {
+    FieldInformation fi(meshType, basis, dataType);
+    const size_type extra = (basis == 0) ? 1 : 0;
+    MeshHandle mesh;
+    if (dims.size() == 3)
+      mesh = CreateMesh(fi, dims[0] + extra, dims[1] + extra, dims[2] + extra, Point(0.0,0.0,0.0), Point(2.7,1.1,5.3));
+    else
+      mesh = CreateMesh(fi, dims[0] + extra, dims[1] + extra, Point(0.0,0.0,0.0), Point(2.7,1.1,0.0));
+    FieldHandle field = CreateField(fi, mesh);
+
+    VField* vfield = field->vfield();
+    const bool integer = vfield->is_unsigned_char() || vfield->is_short();
+    double low = -3.25, high = 7.5;
+    if (vfield->is_unsigned_char()) { low = 0.0; high = 255.0; }
+    else if (vfield->is_short()) { low = -32768.0; high = 32767.0; }
+
+    for (VField::index_type i = 0; i < vfield->num_values(); ++i)
+    {
+      const double u = ((i*7919) % 13)/12.0, w = ((i*104729) % 29)/28.0;
+      const double v = integer ? ((i*104729) % 7 < 3 ? low : high) : low + (high - low)*u;
+      if (vfield->is_vector())
+        vfield->set_value(Vector(v, -w, v*w), i);
+      else if (vfield->is_tensor())
+        vfield->set_value(Tensor(v, w, -v, 2*w, v*w, 1.0 - v), i);
+      else
+        vfield->set_value(v, i);
+    }
+    return field;
+  }
+
+  // Values as the interleaved components Teem resamples
+  std::vector<double> components(FieldHandle field)
+  {
+    VField* vfield = field->vfield();
+    std::vector<double> values;
+    for (VField::index_type i = 0; i < vfield->num_values(); ++i)
+    {
+      if (vfield->is_vector())
+      {
+        Vector v;
+        vfield->get_value(v, i);
+        values.insert(values.end(), { v.x(), v.y(), v.z() });
+      }
+      else if (vfield->is_tensor())
+      {
+        Tensor t;
+        vfield->get_value(t, i);
+        values.insert(values.end(), { t.xx(), t.xy(), t.xz(), t.yy(), t.yz(), t.zz() });
+      }
+      else
+      {
+        double v;
+        vfield->get_value(v, i);
+        values.push_back(v);
+      }
+    }
+    return values;
+  }
+
+  template <class T>
+  void copyValues(VField* vfield, Nrrd* nin)
+  {
+    vfield->get_values(reinterpret_cast<T*>(nin->data), vfield->num_values());
+  }
+
+  // The nrrdSpatialResample call ResampleRegularMeshAlgo made before it
+  // resampled the field values itself.
+  std::vector<double> teemResample(FieldHandle input, const KernelCase& kernel, const std::vector<size_t>& samples)
+  {
+    FieldInformation fi(input);
+    VMesh* vmesh = input->vmesh();
+    VField* vfield = input->vfield();
+
+    VMesh::dimension_type dims;
+    if (fi.is_lineardata()) vmesh->get_dimensions(dims);
+    else vmesh->get_elem_dimensions(dims);
+
+    size_t sizes[NRRD_DIM_MAX];
+    int dim = 0, offset = 0;
+    if (vfield->is_vector() || vfield->is_tensor())
+    {
+      sizes[0] = vfield->is_vector() ? 3 : 6;
+      dim = offset = 1;
+    }
+    for (size_t k = 0; k < dims.size(); ++k)
+      sizes[dim++] = dims[k];
+
+    int type = nrrdTypeDouble;
+    if (vfield->is_unsigned_char()) type = nrrdTypeUChar;
+    else if (vfield->is_short()) type = nrrdTypeShort;
+    else if (vfield->is_float()) type = nrrdTypeFloat;
+
+    Nrrd* nin = nrrdNew();
+    Nrrd* nout = nrrdNew();
+    nrrdAlloc_nva(nin, type, dim, sizes);
+    if (type == nrrdTypeUChar) copyValues<unsigned char>(vfield, nin);
+    else if (type == nrrdTypeShort) copyValues<short>(vfield, nin);
+    else if (type == nrrdTypeFloat) copyValues<float>(vfield, nin);
+    else if (offset == 0) copyValues<double>(vfield, nin);
+    else
+    {
+      auto values = components(input);
+      std::memcpy(nin->data, &values[0], values.size()*sizeof(double));
+    }
+
+    NrrdResampleInfo* info = nrrdResampleInfoNew();
+    if (offset)
+    {
+      info->kernel[0] = 0;
+      nin->axis[0].min = 0.0;
+      nin->axis[0].max = 1.0;
+      info->min[0] = 0.0;
+      info->max[0] = 1.0;
+    }
+
+    Transform trans;
+    vmesh->get_canonical_transform(trans);
+    const Vector axes[] = { Vector(1.0,0.0,0.0), Vector(0.0,1.0,0.0), Vector(0.0,0.0,1.0) };
+    for (int a = offset; a < dim; ++a)
+    {
+      info->min[a] = nin->axis[a].min = 0.0;
+      info->max[a] = nin->axis[a].max = trans.project(axes[a - offset]).length();
+      info->kernel[a] = kernel.kernel;
+      for (int b = 0; b < NRRD_KERNEL_PARMS_NUM; ++b)
+        info->parm[a][b] = (b < 3) ? kernel.parm[b] : 0.0;
+      info->samples[a] = samples[a - offset];
+    }
+
+    std::vector<double> values;
+    if (nrrdSpatialResample(nout, nin, info))
+    {
+      char* err = biffGetDone(NRRD);
+      ADD_FAILURE() << "Teem: " << err;
+      free(err);
+    }
+    else
+    {
+      values.resize(nrrdElementNumber(nout));
+      for (size_t i = 0; i < values.size(); ++i)
+        values[i] = nrrdDLookup[nout->type](nout->data, i);
+    }
+    nrrdNuke(nin);
+    nrrdNuke(nout);
+    nrrdResampleInfoNix(info);
+    return values;
+  }
+
+  FieldHandle resample(FieldHandle input, const KernelCase& kernel, const std::vector<size_t>& samples)
+  {
+    ResampleRegularMeshAlgo algo;
+    algo.set_option(Parameters::ResampleMethod, kernel.method);
+    algo.set(Parameters::ResampleGaussianSigma, kernel.parm[0]);
+    algo.set(Parameters::ResampleGaussianExtend, kernel.parm[1]);
+    const AlgorithmParameterName dims[] = { Parameters::ResampleXDim, Parameters::ResampleYDim, Parameters::ResampleZDim };
+    const AlgorithmParameterName useScaling[] = { Parameters::ResampleXDimUseScalingFactor,
+      Parameters::ResampleYDimUseScalingFactor, Parameters::ResampleZDimUseScalingFactor };
+    for (size_t k = 0; k < samples.size(); ++k)
+    {
+      algo.set(useScaling[k], false);
+      algo.set(dims[k], static_cast<double>(samples[k]));
+    }
+
+    FieldHandle output;
+    EXPECT_TRUE(algo.runImpl(input, output)) << kernel.method;
+    return output;
+  }
+
+  ::testing::AssertionResult matchesTeem(FieldHandle input, const KernelCase& kernel, const std::vector<size_t>& samples)
+  {
+    auto output = resample(input, kernel, samples);
+    if (!output)
+      return ::testing::AssertionFailure() << kernel.method << ": no output";
+    auto expected = teemResample(input, kernel, samples);
+    auto actual = components(output);
+    if (expected.size() != actual.size())
+      return ::testing::AssertionFailure() << kernel.method << ": " << actual.size() << " values, Teem has " << expected.size();
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+      if (expected[i] != actual[i])
+        return ::testing::AssertionFailure() << kernel.method << ": value " << i << " is " << actual[i] << ", Teem has " << expected[i];
+    }
+    return ::testing::AssertionSuccess();
+  }
+
+  struct GridCase
+  {
+    const char* meshType;
+    int basis;
+    const char* dataType;
+    std::vector<size_type> dims;
+    std::vector<size_t> samples;
+  };
+}
+
+TEST(ResampleRegularMeshTests, MatchesTeemForEveryKernelAndType)
+{
+  // Axes are upsampled and downsampled in the same run; the samples are
+  // counted along the data locations, nodes or cells.
+  const GridCase grids[] =
+  {
+    { "LatVolMesh", 1, "double", { 17, 13, 11 }, { 8, 26, 11 } },
+    { "LatVolMesh", 0, "double", { 9, 12, 7 }, { 20, 5, 7 } },
+    { "LatVolMesh", 1, "float", { 17, 13, 11 }, { 34, 6, 5 } },
+    { "LatVolMesh", 1, "unsigned_char", { 17, 13, 11 }, { 9, 13, 23 } },
+    { "LatVolMesh", 0, "short", { 10, 6, 5 }, { 4, 13, 9 } },
+    { "ImageMesh", 1, "short", { 40, 3 }, { 13, 7 } },
+    { "LatVolMesh", 1, "unsigned_char", { 6, 5, 4 }, { 13, 11, 9 } },
+    { "ImageMesh", 0, "unsigned_char", { 12, 9 }, { 25, 4 } },
+    { "ImageMesh", 1, "short", { 7, 6 }, { 15, 13 } },
+    { "LatVolMesh", 1, "Vector", { 9, 8, 7 }, { 4, 16, 7 } },
+    { "LatVolMesh", 0, "Vector", { 6, 5, 4 }, { 13, 2, 8 } },
+    { "LatVolMesh", 1, "Tensor", { 9, 8, 7 }, { 18, 4, 3 } },
+    { "ImageMesh", 0, "Tensor", { 7, 11 }, { 3, 22 } }
+  };
+
+  for (const auto& grid : grids)
+  {
+    auto input = makeGrid(grid.meshType, grid.basis, grid.dataType, grid.dims);
+    for (const auto& kernel : kernels)
+    {
+      EXPECT_TRUE(matchesTeem(input, kernel, grid.samples))
+        << grid.meshType << " " << grid.dataType << (grid.basis == 0 ? " cells" : " nodes");
+    }
+  }
+}
+
+TEST(ResampleRegularMeshTests, ThreadedPassesMatchTeem)
+{
+  // Each pass produces well over 100000 weighted samples, so the work is
+  // split over the threads.
+  ScopedNumCores cores(4);
+  auto input = makeGrid("LatVolMesh", 1, "float", { 48, 40, 36 });
+  for (const auto& kernel : kernels)
+    EXPECT_TRUE(matchesTeem(input, kernel, { 24, 80, 30 }));
+
+  auto vectors = makeGrid("LatVolMesh", 0, "Vector", { 30, 30, 30 });
+  EXPECT_TRUE(matchesTeem(vectors, kernels[2], { 15, 45, 30 }));
+}
+
+TEST(ResampleRegularMeshTests, ScalingFactorsGiveTheSampleCounts)
+{
+  auto input = makeGrid("LatVolMesh", 1, "double", { 10, 8, 6 });
+  ResampleRegularMeshAlgo algo;
+  algo.set_option(Parameters::ResampleMethod, "Tent");
+  algo.set(Parameters::ResampleXDim, 0.5);
+  algo.set(Parameters::ResampleYDim, 1.5);
+  algo.set(Parameters::ResampleZDim, 1.0);
+
+  FieldHandle output;
+  ASSERT_TRUE(algo.runImpl(input, output));
+  VMesh::dimension_type dims;
+  output->vmesh()->get_dimensions(dims);
+  ASSERT_EQ(3u, dims.size());
+  EXPECT_EQ(5u, dims[0]);
+  EXPECT_EQ(12u, dims[1]);
+  EXPECT_EQ(6u, dims[2]);
+  EXPECT_TRUE(matchesTeem(input, kernels[1], { 5, 12, 6 }));
+}
@@ -35,9 +35,15 @@ last change: 09/01/2014
 #include <Core/Datatypes/Legacy/Field/VField.h>
 #include <Core/Datatypes/Legacy/Field/FieldInformation.h>
 #include <Core/Algorithms/Legacy/Fields/MeshDerivatives/SplitByConnectedRegion.h>
+#include <Testing/Utils/SCIRunFieldSamples.h>
+#include <Testing/Utils/FieldTestUtilities.h>
+
+#include <algorithm>
+#include <random>
 
 using namespace SCIRun::Core::Geometry;
 using namespace SCIRun::Core::Algorithms::Fields;
+using namespace SCIRun::TestUtils;
  
 TEST(SplitByConnectedRegionTest, SplitFieldByConnectedRegionAlgoTetTests)
 {
@@ -422,3 +428,106 @@ TEST(SplitByConnectedRegionTest, SplitFieldByConnectedRegionAlgoTriTests4)
   EXPECT_EQ(result8->vmesh()->num_nodes(), 895); 
      
 }
+
+namespace
+{
+  const size_type gridSizes[3] = { 6, 12, 9 };
+
+  /// Three separate cube grids plus an isolated node, with the elements
+  /// shuffled so the regions are numbered by their first element rather
+  /// than by grid. Together they are above the threading threshold.
+  FieldHandle DisconnectedGrids(std::vector<int>& regionOrder)
+  {
+    FieldInformation fi(TETVOLMESH_E, LINEARDATA_E, DOUBLE_E);
+    FieldHandle field = CreateField(fi);
+    VMesh* omesh = field->vmesh();
+
+    std::vector<std::pair<int, VMesh::Node::array_type> > elems;
+    for (int g = 0; g < 3; ++g)
+    {
+      if (g == 1) omesh->add_point(Point(-5.0, -5.0, -5.0));
+
+      FieldHandle grid = TetVolGrid(gridSizes[g], LINEARDATA_E, Point(20.0*g, 0.0, 0.0));
+      VMesh* imesh = grid->vmesh();
+      const VMesh::size_type offset = omesh->num_nodes();
+      Point p;
+      for (VMesh::Node::index_type i = 0; i < imesh->num_nodes(); ++i)
+      {
+        imesh->get_center(p, i);
+        omesh->add_point(p);
+      }
+      VMesh::Node::array_type nodes;
+      for (VMesh::Elem::index_type e = 0; e < imesh->num_elems(); ++e)
+      {
+        imesh->get_nodes(nodes, e);
+        for (size_t k = 0; k < nodes.size(); ++k) nodes[k] += offset;
+        elems.push_back(std::make_pair(g, nodes));
+      }
+    }
+
+    std::shuffle(elems.begin(), elems.end(), std::mt19937(7));
+    for (size_t e = 0; e < elems.size(); ++e)
+    {
+      omesh->add_elem(elems[e].second);
+      if (std::find(regionOrder.begin(), regionOrder.end(), elems[e].first) == regionOrder.end())
+        regionOrder.push_back(elems[e].first);
+    }
+
+    VField* ofield = field->vfield();
+    ofield->resize_values();
+    for (VMesh::index_type i = 0; i < ofield->num_values(); ++i)
+      ofield->set_value(static_cast<double>(i), i);
+    return field;
+  }
+}
+
+TEST(SplitByConnectedRegionTest, ThreadedSplitMatchesSerialSplit)
+{
+  std::vector<int> regionOrder;
+  FieldHandle input = DisconnectedGrids(regionOrder);
+  ASSERT_EQ(3u, regionOrder.size());
+
+  SplitFieldByConnectedRegionAlgo algo;
+  std::vector<FieldHandle> serial, threaded;
+  {
+    ScopedNumCores cores(1);
+    serial = algo.run(input);
+  }
+  {
+    ScopedNumCores cores(4);
+    threaded = algo.run(input);
+  }
+
+  ASSERT_EQ(3u, serial.size());
+  ASSERT_EQ(3u, threaded.size());
+  for (size_t r = 0; r < serial.size(); ++r)
+  {
+    const size_type n = gridSizes[regionOrder[r]];
+    EXPECT_EQ(6*n*n*n, serial[r]->vmesh()->num_elems());
+    EXPECT_EQ((n+1)*(n+1)*(n+1), serial[r]->vmesh()->num_nodes());
+    EXPECT_TRUE(same_field(serial[r], threaded[r]));
+  }
+}
+
+TEST(SplitByConnectedRegionTest, ThreadedSplitSortsRegionsBySize)
+{
+  std::vector<int> regionOrder;
+  FieldHandle input = DisconnectedGrids(regionOrder);
+
+  SplitFieldByConnectedRegionAlgo algo;
+  algo.set(SplitFieldByConnectedRegionAlgo::SortDomainBySize(), true);
+  ScopedNumCores cores(4);
+
+  algo.set(SplitFieldByConnectedRegionAlgo::SortAscending(), false);
+  std::vector<FieldHandle> descending = algo.run(input);
+  ASSERT_EQ(3u, descending.size());
+  EXPECT_EQ(6*12*12*12, descending[0]->vmesh()->num_elems());
+  EXPECT_EQ(6*9*9*9, descending[1]->vmesh()->num_elems());
+  EXPECT_EQ(6*6*6*6, descending[2]->vmesh()->num_elems());
+
+  algo.set(SplitFieldByConnectedRegionAlgo::SortAscending(), true);
+  std::vector<FieldHandle> ascending = algo.run(input);
+  ASSERT_EQ(3u, ascending.size());
+  for (size_t r = 0; r < ascending.size(); ++r)
+    EXPECT_TRUE(same_field(descending[2 - r], ascending[r]));
+}
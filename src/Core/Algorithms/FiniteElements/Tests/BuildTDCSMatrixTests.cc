@@ -32,6 +32,8 @@
 #include <Core/Algorithms/Base/AlgorithmPreconditions.h>
 #include <Core/Algorithms/Legacy/FiniteElements/BuildMatrix/BuildTDCSMatrix.h>
 #include <Testing/Utils/MatrixTestUtilities.h>
+#include <Testing/Utils/FieldTestUtilities.h>
+#include <Testing/Utils/SCIRunFieldSamples.h>
 //////////////////////////////////////////////////////////////////////////
 /// @todo MORITZ
 //////////////////////////////////////////////////////////////////////////
@@ -143,5 +145,186 @@ TEST(BuildTDCSMatrixAlgorithmTests, ThrowsForNullElectrodeElements)
 // etc for checks lines 567-575
 // cover as many error cases with tests as you can, there are a lot in TDCSMatrixBuilder::singlethread() but there may be reasonable conceptual groupings to simplify the test code (may also lead to simplifying/refactoring the algorithm code
 
-/// @todo next:
-//TEST(BuildTDCSMatrixAlgorithmTests, SuccessfulRunTest)  //here's where you pass in the real matrices/fields above and compare the output to an expected matrix.
+namespace TDCSSharedNodesData
+{
+  DenseMatrixHandle column(const DenseMatrix& row)
+  {
+    return boost::make_shared<DenseMatrix>(row.transpose());
+  }
+
+  // One unit tet (nodes 0-3) and a fifth node that only the stiffness
+  // matrix refers to
+  FieldHandle mesh()
+  {
+    FieldInformation fi(TETVOLMESH_E, LINEARDATA_E, DOUBLE_E);
+    FieldHandle field = CreateField(fi);
+    VMesh* vmesh = field->vmesh();
+    vmesh->add_point(Point(0,0,0));
+    vmesh->add_point(Point(1,0,0));
+    vmesh->add_point(Point(0,1,0));
+    vmesh->add_point(Point(0,0,1));
+    vmesh->add_point(Point(1,1,1));
+    VMesh::Node::array_type nodes(4);
+    for (int i = 0; i < 4; ++i)
+      nodes[i] = i;
+    vmesh->add_elem(nodes);
+    return field;
+  }
+
+  SparseRowMatrixHandle stiff()
+  {
+    return MAKE_SPARSE_MATRIX_HANDLE(
+      (4,-1,0,0,0)
+      (-1,5,0,0,0)
+      (0,0,6,-2,0)
+      (0,0,-2,7,-1)
+      (0,0,0,-1,8));
+  }
+
+  // Electrode 0 is a point at node 0 and the triangle 0-1-2, electrode 1
+  // is the tet 0-1-2-3 and a point at node 3
+  DenseMatrixHandle ElectrodeElements()
+  {
+    return column(MAKE_DENSE_MATRIX((0,0,1,1)));
+  }
+
+  DenseMatrixHandle ElectrodeElementType()
+  {
+    return column(MAKE_DENSE_MATRIX((1,2,3,1)));
+  }
+
+  DenseMatrixHandle ElectrodeElementDefinition()
+  {
+    return MAKE_DENSE_MATRIX_HANDLE(
+      (0,0,0,0)
+      (0,1,2,0)
+      (0,1,2,3)
+      (3,0,0,0));
+  }
+
+  DenseMatrixHandle contactimpedance()
+  {
+    return column(MAKE_DENSE_MATRIX((2.0,1.0,0.5,1.0)));
+  }
+
+  // Written out per element: point at node 0 (1/z = 1/2), triangle of area
+  // 1/2 (2*area/z = 1), tet of volume 1/6 (volume/z = 1/3) and point at
+  // node 3 (1/z = 1). Rows and columns 5 and 6 are the two electrodes.
+  DenseMatrix expectedOutput()
+  {
+    const double pt0 = 1.0/4, pt3 = 1.0/2;
+    const double triDiag = 1.0/12, triOff = 1.0/24, triB = -1.0/6, triC = 1.0/2;
+    const double tetDiag = 1.0/30, tetOff = 1.0/60, tetB = -1.0/12, tetC = 1.0/3;
+
+    DenseMatrix expected(DenseMatrix::Zero(7,7));
+    expected(0,0) = 4 + pt0 + triDiag + tetDiag;
+    expected(1,1) = 5 + triDiag + tetDiag;
+    expected(2,2) = 6 + triDiag + tetDiag;
+    expected(3,3) = 7 + tetDiag + pt3;
+    expected(4,4) = 8;
+
+    expected(0,1) = expected(1,0) = -1 + triOff + tetOff;
+    expected(0,2) = expected(2,0) = triOff + tetOff;
+    expected(1,2) = expected(2,1) = triOff + tetOff;
+    expected(0,3) = expected(3,0) = tetOff;
+    expected(1,3) = expected(3,1) = tetOff;
+    expected(2,3) = expected(3,2) = -2 + tetOff;
+    expected(3,4) = expected(4,3) = -1;
+
+    expected(0,5) = expected(5,0) = -pt0 + triB;
+    expected(1,5) = expected(5,1) = triB;
+    expected(2,5) = expected(5,2) = triB;
+    expected(5,5) = pt0 + triC;
+
+    expected(0,6) = expected(6,0) = tetB;
+    expected(1,6) = expected(6,1) = tetB;
+    expected(2,6) = expected(6,2) = tetB;
+    expected(3,6) = expected(6,3) = tetB - pt3;
+    expected(6,6) = tetC + pt3;
+    return expected;
+  }
+}
+
+TEST(BuildTDCSMatrixAlgorithmTests, SumsElectrodeElementsSharingNodes)
+{
+  using namespace TDCSSharedNodesData;
+  BuildTDCSMatrixAlgo algo;
+  SparseRowMatrixHandle output;
+
+  ASSERT_TRUE(algo.run(stiff(), mesh(), ElectrodeElements(), ElectrodeElementType(), ElectrodeElementDefinition(), contactimpedance(), output));
+  ASSERT_TRUE(output != nullptr);
+  EXPECT_MATRIX_EQ_TOLERANCE(*makeDense(*output), expectedOutput(), 1e-12);
+}
+
+namespace
+{
+  // Point, triangle and tet electrodes on the tets of a grid, spread over
+  // four electrodes so that many elements share nodes
+  struct GridElectrodes
+  {
+    explicit GridElectrodes(size_type numElements) :
+      mesh(TetVolGrid(6, LINEARDATA_E)),
+      electrodes(new DenseMatrix(numElements, 1)),
+      types(new DenseMatrix(numElements, 1)),
+      definition(new DenseMatrix(DenseMatrix::Zero(numElements, 4))),
+      impedance(new DenseMatrix(numElements, 1))
+    {
+      VMesh* vmesh = mesh->vmesh();
+      const size_type numNodes = vmesh->num_nodes();
+      const size_type numTets = vmesh->num_elems();
+
+      SparseRowMatrix* sparse = new SparseRowMatrix(numNodes, numNodes);
+      for (index_type i = 0; i < numNodes; ++i)
+      {
+        sparse->insert(i, i) = 6.0 + i % 5;
+        if (i + 1 < numNodes)
+          sparse->insert(i, i + 1) = -1.0;
+      }
+      sparse->makeCompressed();
+      stiff.reset(sparse);
+
+      VMesh::Node::array_type nodes;
+      for (index_type i = 0; i < numElements; ++i)
+      {
+        vmesh->get_nodes(nodes, VMesh::Elem::index_type((7*i) % numTets));
+        (*electrodes)(i,0) = i % 4;
+        (*types)(i,0) = 1 + i % 3;
+        for (int j = 0; j < 4; ++j)
+          (*definition)(i,j) = static_cast<double>(nodes[j]);
+        (*impedance)(i,0) = 0.5 + 0.25*(i % 5);
+      }
+    }
+
+    SparseRowMatrixHandle run() const
+    {
+      BuildTDCSMatrixAlgo algo;
+      SparseRowMatrixHandle output;
+      EXPECT_TRUE(algo.run(stiff, mesh, electrodes, types, definition, impedance, output));
+      return output;
+    }
+
+    FieldHandle mesh;
+    SparseRowMatrixHandle stiff;
+    DenseMatrixHandle electrodes, types, definition, impedance;
+  };
+}
+
+TEST(BuildTDCSMatrixAlgorithmTests, ThreadedMatrixMatchesSerial)
+{
+  GridElectrodes inputs(300);
+
+  SparseRowMatrixHandle serial;
+  {
+    ScopedNumCores cores(1);
+    serial = inputs.run();
+  }
+  ASSERT_TRUE(serial != nullptr);
+  EXPECT_EQ(inputs.stiff->nrows() + 4, serial->nrows());
+
+  for (unsigned int numCores : { 4u, 7u })
+  {
+    ScopedNumCores cores(numCores);
+    SparseRowMatrixHandle threaded = inputs.run();
+    EXPECT_TRUE(same_mapping(serial, threaded)) << numCores << " cores";
+  }
+}
@@ -322,12 +322,13 @@ bool NrrdToFieldAlgoT::nrrdToField(LoggerHandle pr,NrrdDataHandle input, FieldHa
   }
 
 
+  // The nrrd data is in the same order as the field values. Lattice volumes
+  // use the nrrd buffer as their storage without copying it, the other
+  // meshes get a single block copy.
   T* dataptr = static_cast<T*>(nrrd->data);
 
   if (rdim == 1)
   {
-    int k = 0;
-
     if (datalocation == "Node")
     {
       FieldInformation fi(SCANLINEMESH_E,LINEARDATA_E,DOUBLE_E);
@@ -339,16 +340,8 @@ bool NrrdToFieldAlgoT::nrrdToField(LoggerHandle pr,NrrdDataHandle input, FieldHa
       VMesh*  vmesh = output->vmesh();
       VField* vfield = output->vfield();
 
-      VMesh::Node::iterator it, it_end;
-      vmesh->begin(it);
-      vmesh->end(it_end);
-
-      while (it != it_end)
-      {
-        vfield->set_value(dataptr[k],*it);
-        ++it;
-        k++;
-      }
+      if (!vfield->share_values_pointer(dataptr,input))
+        vfield->set_values(dataptr,vfield->num_values());
 
       if (use_tf)
       {
@@ -368,15 +361,8 @@ bool NrrdToFieldAlgoT::nrrdToField(LoggerHandle pr,NrrdDataHandle input, FieldHa
       VMesh*  vmesh = output->vmesh();
       VField* vfield = output->vfield();
 
-      VMesh::Elem::iterator it, it_end;
-      vmesh->begin(it);
-      vmesh->end(it_end);
-      while (it != it_end)
-      {
-        vfield->set_value(dataptr[k],*it);
-        ++it;
-        k++;
-      }
+      if (!vfield->share_values_pointer(dataptr,input))
+        vfield->set_values(dataptr,vfield->num_values());
       if (use_tf)
       {
         Transform trans = vmesh->get_transform();
@@ -392,8 +378,6 @@ bool NrrdToFieldAlgoT::nrrdToField(LoggerHandle pr,NrrdDataHandle input, FieldHa
   }
   else if (rdim == 2)
   {
-    int k = 0;
-
     if (datalocation == "Node")
     {
       FieldInformation fi(IMAGEMESH_E,LINEARDATA_E,DOUBLE_E);
@@ -405,16 +389,8 @@ bool NrrdToFieldAlgoT::nrrdToField(LoggerHandle pr,NrrdDataHandle input, FieldHa
       VMesh*  vmesh = output->vmesh();
       VField* vfield = output->vfield();
 
-      VMesh::Node::iterator it, it_end;
-      vmesh->begin(it);
-      vmesh->end(it_end);
-
-      while (it != it_end)
-      {
-        vfield->set_value(dataptr[k],*it);
-        ++it;
-        k++;
-      }
+      if (!vfield->share_values_pointer(dataptr,input))
+        vfield->set_values(dataptr,vfield->num_values());
 
       if (use_tf)
       {
@@ -434,15 +410,8 @@ bool NrrdToFieldAlgoT::nrrdToField(LoggerHandle pr,NrrdDataHandle input, FieldHa
       VMesh*  vmesh = output->vmesh();
       VField* vfield = output->vfield();
 
-      VMesh::Elem::iterator it, it_end;
-      vmesh->begin(it);
-      vmesh->end(it_end);
-      while (it != it_end)
-      {
-        vfield->set_value(dataptr[k],*it);
-        ++it;
-        k++;
-      }
+      if (!vfield->share_values_pointer(dataptr,input))
+        vfield->set_values(dataptr,vfield->num_values());
       if (use_tf)
       {
         Transform trans = vmesh->get_transform();
@@ -458,8 +427,6 @@ bool NrrdToFieldAlgoT::nrrdToField(LoggerHandle pr,NrrdDataHandle input, FieldHa
   }
   else if (rdim == 3)
   {
-    int k = 0;
-
     if (datalocation == "Node")
     {
       FieldInformation fi(LATVOLMESH_E,LINEARDATA_E,DOUBLE_E);
@@ -471,16 +438,8 @@ bool NrrdToFieldAlgoT::nrrdToField(LoggerHandle pr,NrrdDataHandle input, FieldHa
       VMesh*  vmesh = output->vmesh();
       VField* vfield = output->vfield();
 
-      VMesh::Node::iterator it, it_end;
-      vmesh->begin(it);
-      vmesh->end(it_end);
-
-      while (it != it_end)
-      {
-        vfield->set_value(dataptr[k],*it);
-        ++it;
-        k++;
-      }
+      if (!vfield->share_values_pointer(dataptr,input))
+        vfield->set_values(dataptr,vfield->num_values());
 
       if (use_tf)
       {
@@ -500,15 +459,8 @@ bool NrrdToFieldAlgoT::nrrdToField(LoggerHandle pr,NrrdDataHandle input, FieldHa
       VMesh*  vmesh = output->vmesh();
       VField* vfield = output->vfield();
 
-      VMesh::Elem::iterator it, it_end;
-      vmesh->begin(it);
-      vmesh->end(it_end);
-      while (it != it_end)
-      {
-        vfield->set_value(dataptr[k],*it);
-        ++it;
-        k++;
-      }
+      if (!vfield->share_values_pointer(dataptr,input))
+        vfield->set_values(dataptr,vfield->num_values());
 
       if (use_tf)
       {
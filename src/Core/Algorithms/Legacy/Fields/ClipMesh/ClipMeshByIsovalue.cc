@@ -33,17 +33,26 @@
 #include <Core/Datatypes/Legacy/Field/VField.h>
 #include <Core/Datatypes/Legacy/Field/VMesh.h>
 #include <Core/Datatypes/Matrix.h>
-#include <Core/Datatypes/SparseRowMatrixFromMap.h>
+#include <Core/Datatypes/DenseMatrix.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
 #include <Core/Datatypes/Legacy/Field/FieldInformation.h>
+#include <Core/Algorithms/Legacy/Fields/ClipMesh/ClippedMeshWriter.h>
+#include <Core/Thread/Parallel.h>
+#include <boost/functional/hash.hpp>
+#include <boost/make_shared.hpp>
 #include <boost/unordered_map.hpp>
 
 #include <algorithm>
+#include <atomic>
+#include <memory>
 #include <set>
+#include <vector>
 
 
 using namespace SCIRun;
 using namespace SCIRun::Core::Datatypes;
 using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Thread;
 using namespace SCIRun::Core::Algorithms;
 using namespace SCIRun::Core::Algorithms::Fields;
 
@@ -76,862 +85,719 @@ int tri_permute_table[7][3] = {
   { 2, 0, 1 }, // 0x6
 };
 
-namespace detail
-{
-  struct edgepair_t
-  {
-    VField::index_type first;
-    VField::index_type second;
-    double dfirst;
-  };
-
-  struct edgepairhash
-  {
-    size_t operator()(const edgepair_t &a) const
-    {
-      std::hash<size_t> h;
-      return h(a.first ^ a.second);
-    }
-  };
-
-  typedef boost::unordered_map<VField::index_type, VMesh::Node::index_type> node_hash_type;
-  typedef boost::unordered_map<edgepair_t, VMesh::Node::index_type, edgepairhash> edge_hash_type;
-
-  bool operator==(const edgepair_t &a, const edgepair_t &b)
-  {
-    return a.first == b.first && a.second == b.second;
-  }
-
-  bool operator!=(const edgepair_t &a, const edgepair_t &b)
-  {
-    return !(a == b);
-  }
-
-  struct facetriple_t
-  {
-    VField::index_type first, second, third;
-    double dsecond, dthird;
-  };
-
-  bool operator==(const facetriple_t &a, const facetriple_t &b) 
-  {
-    return a.first == b.first && a.second == b.second && a.third == b.third;
-  }
-
-  bool operator!=(const facetriple_t &a, const facetriple_t &b) 
-  {
-    return !(a == b);
-  }
-
-  struct facetriplehash
-  {
-    size_t operator()(const facetriple_t &a) const
-    {
-      std::hash<size_t> h;
-      return h(a.first ^ a.second ^ a.third);
-    }
-  };
-
-  typedef boost::unordered_map<facetriple_t, VMesh::Node::index_type, facetriplehash> face_hash_type;
-
-}
-
 ClipMeshByIsovalueAlgo::ClipMeshByIsovalueAlgo()
 {
  addParameter(LessThanIsoValue, 1);
  addParameter(ScalarIsoValue, 0.0);
 }
 
-class ClipMeshByIsovalueAlgoTet {
-
-  public:
-    bool run(const AlgorithmBase* algo,FieldHandle input, FieldHandle& output, MatrixHandle& mapping) const;
-
-  private:
-    VMesh::Node::index_type
-    edge_lookup(VField::index_type u0, VField::index_type u1, double d0,
-          const Point &p, detail::edge_hash_type &edgemap,
-          VMesh *clipped) const;
-
-    VMesh::Node::index_type
-    face_lookup(VField::index_type u0, VField::index_type u1, VField::index_type u2,
-          double d1, double d2,
-          const Point &p, detail::face_hash_type &facemap,
-          VMesh *clipped) const;
+namespace {
 
- };
+/// Node of the clipped mesh, identified by the input nodes it lies on: one
+/// for a copied input node, two for a cut on an edge and three for a cut on
+/// a face. Used entries are sorted, unused entries are -1.
+struct ClipNodeKey
+{
+  VField::index_type n[3];
+};
 
-VMesh::Node::index_type ClipMeshByIsovalueAlgoTet::edge_lookup(VField::index_type u0, VField::index_type u1, double d0, const Point &p, detail::edge_hash_type &edgemap, VMesh *clipped) const
+bool operator==(const ClipNodeKey& a, const ClipNodeKey& b)
 {
-  using namespace detail;
-  edgepair_t np;
-  if (u0 < u1)  { np.first = u0; np.second = u1; np.dfirst = d0; }
-  else { np.first = u1; np.second = u0; np.dfirst = 1.0 - d0; }
+  return a.n[0] == b.n[0] && a.n[1] == b.n[1] && a.n[2] == b.n[2];
+}
 
-  auto loc = edgemap.find(np);
-      
-  if (loc == edgemap.end())
-  {
-    const VMesh::Node::index_type nodeindex = clipped->add_point(p);
-    edgemap[np] = nodeindex; 
-    return nodeindex;
-  }
-  else
-  {
-   return loc->second;
-  }
+bool operator<(const ClipNodeKey& a, const ClipNodeKey& b)
+{
+  if (a.n[0] != b.n[0]) return a.n[0] < b.n[0];
+  if (a.n[1] != b.n[1]) return a.n[1] < b.n[1];
+  return a.n[2] < b.n[2];
 }
 
-VMesh::Node::index_type ClipMeshByIsovalueAlgoTet::face_lookup(VField::index_type u0, VField::index_type u1, VField::index_type u2, double d1, double d2, const Point &p, detail::face_hash_type &facemap, VMesh *clipped) const
+struct ClipNodeKeyHash
 {
-  using namespace detail;
-  facetriple_t nt;
-  if (u0 < u1)
+  size_t operator()(const ClipNodeKey& a) const
   {
-    if (u2 < u0)
-    {
-      nt.first = u2; nt.second = u0; nt.third = u1;
-      nt.dsecond = 1.0 - d1 - d2; nt.dthird = d1;
-    }
-    else if (u2 < u1)
-    {
-      nt.first = u0; nt.second = u2; nt.third = u1;
-      nt.dsecond = d2; nt.dthird = d1;
-    }
-    else
-    {
-      nt.first = u0; nt.second = u1; nt.third = u2;
-      nt.dsecond = d1; nt.dthird = d2;
-    }
-  }
-  else
-  {
-    if (u2 > u0)
-    {
-      nt.first = u1; nt.second = u0; nt.third = u2;
-      nt.dsecond = 1.0 - d1 - d2; nt.dthird = d2;
-    }
-    else if (u2 > u1)
-    {
-      nt.first = u1; nt.second = u2; nt.third = u0;
-      nt.dsecond = d2; nt.dthird = 1.0 - d1 - d2;
-    }
-    else
-    {
-      nt.first = u2; nt.second = u1; nt.third = u0;
-      nt.dsecond = d1; nt.dthird = 1.0 - d1 - d2;
-    }
-  }
-  const face_hash_type::iterator loc = facemap.find(nt);
-  if (loc == facemap.end())
-  {
-    const VMesh::Node::index_type nodeindex = clipped->add_point(p);
-    facemap[nt] = nodeindex;
-    return nodeindex;
-  }
-  else
-  {
-    return (*loc).second;
+    size_t seed = 0;
+    boost::hash_combine(seed, a.n[0]);
+    boost::hash_combine(seed, a.n[1]);
+    boost::hash_combine(seed, a.n[2]);
+    return seed;
   }
-}
+};
 
-bool ClipMeshByIsovalueAlgoTet::run(const AlgorithmBase* algo, FieldHandle input, FieldHandle& output, MatrixHandle &mapping) const
+/// A node used by a clipped element, with the weights of the input nodes in
+/// its key and its location.
+struct ClipNode
 {
-  VField* field = input->vfield();
-  VMesh*  mesh  = input->vmesh();
-  VMesh*  clipped = output->vmesh();
- 
-  using namespace detail;
-  node_hash_type nodemap;
-  edge_hash_type edgemap;
-  face_hash_type facemap;
-  
-  VMesh::Node::array_type onodes(4);
-  std::vector<double> v(4);
-  std::vector<Point> p(4);
-  
-  double isoval = algo->get(ClipMeshByIsovalueAlgo::ScalarIsoValue).toDouble();
-  
-  bool lte = !algo->get(ClipMeshByIsovalueAlgo::LessThanIsoValue).toBool();
-  
-  VMesh::size_type num_elems = mesh->num_elems();
-  
-  for (VMesh::Elem::index_type idx=0; idx<num_elems; idx++)
-  {
-    mesh->get_nodes(onodes, idx);
-    
-      // Get the values and compute an inside/outside mask.
-    VField::index_type inside = 0;
-    mesh->get_centers(p, onodes);
-    field->get_values(v,onodes);  
-    for (size_t i = 0; i < onodes.size(); i++)
-    {
-      inside = inside << 1;
-      if (v[i] > isoval)
-      {
-        inside |= 1;
-      }
+  ClipNodeKey key;
+  double weight[3];
+  Point point;
 
-    }
+  bool is_cut() const { return key.n[1] >= 0; }
+  int num_weights() const { return key.n[1] < 0 ? 1 : (key.n[2] < 0 ? 2 : 3); }
+};
 
-      // Invert the mask if we are doing less than.
-    if (lte) { inside = ~inside & 0xf; }
+/// The pieces of one clipped input element: the nodes in the order in which
+/// they are looked up and the new elements as indices into that list.
+class ClippedElement
+{
+  public:
+    void clear() { num_nodes_ = 0; num_elems_ = 0; }
 
-    if (inside == 0)
+    int input_node(VField::index_type u, const Point& p)
     {
-        // Discard outside elements.
+      ClipNode& node = nodes_[num_nodes_];
+      node.key.n[0] = u; node.key.n[1] = -1; node.key.n[2] = -1;
+      node.weight[0] = 1.0; node.weight[1] = 0.0; node.weight[2] = 0.0;
+      node.point = p;
+      return (num_nodes_++);
     }
-    else if (inside == 0xf)
+
+    int edge_node(VField::index_type u0, VField::index_type u1, double d0, const Point& p)
     {
-        // Add this element to the new mesh.
-      VMesh::Node::array_type nnodes(onodes.size());
-      for (size_t i = 0; i<onodes.size(); i++)
+      ClipNode& node = nodes_[num_nodes_];
+      double dfirst;
+      if (u0 < u1)  { node.key.n[0] = u0; node.key.n[1] = u1; dfirst = d0; }
+      else { node.key.n[0] = u1; node.key.n[1] = u0; dfirst = 1.0 - d0; }
+      node.key.n[2] = -1;
+      node.weight[0] = 1.0 - dfirst; node.weight[1] = dfirst; node.weight[2] = 0.0;
+      node.point = p;
+      return (num_nodes_++);
+    }
+
+    int face_node(VField::index_type u0, VField::index_type u1, VField::index_type u2,
+                  double d1, double d2, const Point& p)
+    {
+      ClipNode& node = nodes_[num_nodes_];
+      VField::index_type* n = node.key.n;
+      double dsecond, dthird;
+      if (u0 < u1)
       {
-        if (nodemap.find((VField::index_type)onodes[i]) == nodemap.end())
+        if (u2 < u0)
         {
-          const VMesh::Node::index_type nodeindex = clipped->add_point(p[i]);
-          nodemap[(VField::index_type)onodes[i]] = nodeindex;
-          nnodes[i] = nodeindex;
+          n[0] = u2; n[1] = u0; n[2] = u1;
+          dsecond = 1.0 - d1 - d2; dthird = d1;
+        }
+        else if (u2 < u1)
+        {
+          n[0] = u0; n[1] = u2; n[2] = u1;
+          dsecond = d2; dthird = d1;
         }
         else
         {
-          nnodes[i] = nodemap[(VField::index_type)onodes[i]];
+          n[0] = u0; n[1] = u1; n[2] = u2;
+          dsecond = d1; dthird = d2;
         }
       }
-      
-      clipped->add_elem(nnodes);
-    }
-    else if (inside == 0x8 || inside == 0x4 || inside == 0x2 || inside == 0x1)
-    {
-        // Lop off 3 points and add resulting tet to the new mesh.
-      const int *perm = tet_permute_table[inside];
-      VMesh::Node::array_type nnodes(4);
-      
-      if (nodemap.find((VField::index_type)onodes[perm[0]]) == nodemap.end())
-      {
-        const VMesh::Node::index_type nodeindex = clipped->add_point(p[perm[0]]);
-        nodemap[(VField::index_type)onodes[perm[0]]] = nodeindex;
-        nnodes[0] = nodeindex;
-      }
       else
       {
-        nnodes[0] = nodemap[(VField::index_type)onodes[perm[0]]];
-      }
-      
-      const double imv = isoval - v[perm[0]];
-      const double dl1 = imv / (v[perm[1]] - v[perm[0]]);
-      const Point l1 = Interpolate(p[perm[0]], p[perm[1]], dl1);
-      const double dl2 = imv / (v[perm[2]] - v[perm[0]]);
-      const Point l2 = Interpolate(p[perm[0]], p[perm[2]], dl2);
-      const double dl3 = imv / (v[perm[3]] - v[perm[0]]);
-      const Point l3 = Interpolate(p[perm[0]], p[perm[3]], dl3);
-      
-      
-      nnodes[1] = edge_lookup((VField::index_type)onodes[perm[0]],
-                              (VField::index_type)onodes[perm[1]],
-                              dl1, l1, edgemap, clipped);
-      
-      nnodes[2] = edge_lookup((VField::index_type)onodes[perm[0]],
-                              (VField::index_type)onodes[perm[2]],
-                              dl2, l2, edgemap, clipped);
-      
-      nnodes[3] = edge_lookup((VField::index_type)onodes[perm[0]],
-                              (VField::index_type)onodes[perm[3]],
-                              dl3, l3, edgemap, clipped);
-      
-      clipped->add_elem(nnodes);
-    }
-    else if (inside == 0x7 || inside == 0xb || inside == 0xd || inside == 0xe)
-    {
-        // Lop off 1 point, break up the resulting quads and add the
-        // resulting tets to the mesh.
-      const int *perm = tet_permute_table[inside];
-      VMesh::Node::array_type nnodes(4);
-      
-      VMesh::Node::index_type inodes[9];
-      for (size_t i = 1; i < 4; i++)
-      {
-        if (nodemap.find((VField::index_type)onodes[perm[i]]) == nodemap.end())
+        if (u2 > u0)
         {
-          const VMesh::Node::index_type nodeindex = clipped->add_point(p[perm[i]]);
-          nodemap[(VField::index_type)onodes[perm[i]]] = nodeindex;
-          inodes[i-1] = nodeindex;
+          n[0] = u1; n[1] = u0; n[2] = u2;
+          dsecond = 1.0 - d1 - d2; dthird = d2;
         }
-        else
+        else if (u2 > u1)
         {
-          inodes[i-1] = nodemap[(VField::index_type)onodes[perm[i]]];
-        }
-      }
-      
-      const double imv = isoval - v[perm[0]];
-      const double dl1 = imv / (v[perm[1]] - v[perm[0]]);
-      const Point l1 = Interpolate(p[perm[0]], p[perm[1]], dl1);
-      const double dl2 = imv / (v[perm[2]] - v[perm[0]]);
-      const Point l2 = Interpolate(p[perm[0]], p[perm[2]], dl2);
-      const double dl3 = imv / (v[perm[3]] - v[perm[0]]);
-      const Point l3 = Interpolate(p[perm[0]], p[perm[3]], dl3);
-      
-      
-      inodes[3] = edge_lookup((index_type)onodes[perm[0]],
-                              (index_type)onodes[perm[1]],
-                              dl1, l1, edgemap, clipped);
-      
-      inodes[4] = edge_lookup((index_type)onodes[perm[0]],
-                              (index_type)onodes[perm[2]],
-                              dl2, l2, edgemap, clipped);
-      
-      inodes[5] = edge_lookup((index_type)onodes[perm[0]],
-                              (index_type)onodes[perm[3]],
-                              dl3, l3, edgemap, clipped);
-      
-      const Point c1 = Interpolate(l1, l2, 0.5);
-      const Point c2 = Interpolate(l2, l3, 0.5);
-      const Point c3 = Interpolate(l3, l1, 0.5);
-      
-      inodes[6] = face_lookup((index_type)onodes[perm[0]],
-                              (index_type)onodes[perm[1]],
-                              (index_type)onodes[perm[2]],
-                              dl1*0.5, dl2*0.5,
-                              c1, facemap, clipped);
-      inodes[7] = face_lookup((index_type)onodes[perm[0]],
-                              (index_type)onodes[perm[2]],
-                              (index_type)onodes[perm[3]],
-                              dl2*0.5, dl3*0.5,
-                              c2, facemap, clipped);
-      inodes[8] = face_lookup((index_type)onodes[perm[0]],
-                              (index_type)onodes[perm[3]],
-                              (index_type)onodes[perm[1]],
-                              dl3*0.5, dl1*0.5,
-                              c3, facemap, clipped);
-      
-      nnodes[0] = inodes[0];
-      nnodes[1] = inodes[3];
-      nnodes[2] = inodes[8];
-      nnodes[3] = inodes[6];
-      clipped->add_elem(nnodes);
-      
-      nnodes[0] = inodes[1];
-      nnodes[1] = inodes[4];
-      nnodes[2] = inodes[6];
-      nnodes[3] = inodes[7];
-      clipped->add_elem(nnodes);
-      
-      nnodes[0] = inodes[2];
-      nnodes[1] = inodes[5];
-      nnodes[2] = inodes[7];
-      nnodes[3] = inodes[8];
-      clipped->add_elem(nnodes);
-      
-      nnodes[0] = inodes[0];
-      nnodes[1] = inodes[6];
-      nnodes[2] = inodes[8];
-      nnodes[3] = inodes[7];
-      clipped->add_elem(nnodes);
-      
-      nnodes[0] = inodes[0];
-      nnodes[1] = inodes[8];
-      nnodes[2] = inodes[2];
-      nnodes[3] = inodes[7];
-      clipped->add_elem(nnodes);
-      
-      nnodes[0] = inodes[0];
-      nnodes[1] = inodes[6];
-      nnodes[2] = inodes[7];
-      nnodes[3] = inodes[1];
-      clipped->add_elem(nnodes);
-      
-      nnodes[0] = inodes[0];
-      nnodes[1] = inodes[1];
-      nnodes[2] = inodes[7];
-      nnodes[3] = inodes[2];
-      clipped->add_elem(nnodes);
-    }
-    else// if (inside == 0x3 || inside == 0x5 || inside == 0x6 ||
-          //     inside == 0x9 || inside == 0xa || inside == 0xc)
-    {
-        // Lop off two points, break the resulting quads, then add the
-        // new tets to the mesh.
-      const int *perm = tet_permute_table[inside];
-      VMesh::Node::array_type nnodes(4);
-      
-      VMesh::Node::index_type inodes[8];
-      for (size_t i = 2; i < 4; i++)
-      {
-        if (nodemap.find((VField::index_type)onodes[perm[i]]) == nodemap.end())
-        {
-          const VMesh::Node::index_type nodeindex = clipped->add_point(p[perm[i]]);
-          nodemap[(VField::index_type)onodes[perm[i]]] = nodeindex;
-          inodes[i-2] = nodeindex;
+          n[0] = u1; n[1] = u2; n[2] = u0;
+          dsecond = d2; dthird = 1.0 - d1 - d2;
         }
         else
         {
-          inodes[i-2] = nodemap[(VField::index_type)onodes[perm[i]]];
+          n[0] = u2; n[1] = u1; n[2] = u0;
+          dsecond = d1; dthird = 1.0 - d1 - d2;
         }
       }
-      const double imv0 = isoval - v[perm[0]];
-      const double dl02 = imv0 / (v[perm[2]] - v[perm[0]]);
-      const Point l02 = Interpolate(p[perm[0]], p[perm[2]], dl02);
-      const double dl03 = imv0 / (v[perm[3]] - v[perm[0]]);
-      const Point l03 = Interpolate(p[perm[0]], p[perm[3]], dl03);
-      
-      const double imv1 = isoval - v[perm[1]];
-      const double dl12 = imv1 / (v[perm[2]] - v[perm[1]]);
-      const Point l12 = Interpolate(p[perm[1]], p[perm[2]], dl12);
-      const double dl13 = imv1 / (v[perm[3]] - v[perm[1]]);
-      const Point l13 = Interpolate(p[perm[1]], p[perm[3]], dl13);
-      
-      
-      inodes[2] = edge_lookup((index_type)onodes[perm[0]],
-                              (index_type)onodes[perm[2]],
-                              dl02, l02, edgemap, clipped);
-      inodes[3] = edge_lookup((index_type)onodes[perm[0]],
-                              (index_type)onodes[perm[3]],
-                              dl03, l03, edgemap, clipped);
-      inodes[4] = edge_lookup((index_type)onodes[perm[1]],
-                              (index_type)onodes[perm[2]],
-                              dl12, l12, edgemap, clipped);
-      inodes[5] = edge_lookup((index_type)onodes[perm[1]],
-                              (index_type)onodes[perm[3]],
-                              dl13, l13, edgemap, clipped);
-      
-      const Point c1 = Interpolate(l02, l03, 0.5);
-      const Point c2 = Interpolate(l12, l13, 0.5);
-      
-      inodes[6] = face_lookup((index_type)onodes[perm[0]],
-                              (index_type)onodes[perm[2]],
-                              (index_type)onodes[perm[3]],
-                              dl02*0.5,
-                              dl03*0.5,
-                              c1, facemap, clipped);
-      inodes[7] = face_lookup((index_type)onodes[perm[1]],
-                              (index_type)onodes[perm[2]],
-                              (index_type)onodes[perm[3]],
-                              dl12*0.5,
-                              dl13*0.5,
-                              c2, facemap, clipped);
-      
-      nnodes[0] = inodes[7];
-      nnodes[1] = inodes[2];
-      nnodes[2] = inodes[0];
-      nnodes[3] = inodes[4];
-      clipped->add_elem(nnodes);
-      
-      nnodes[0] = inodes[1];
-      nnodes[1] = inodes[5];
-      nnodes[2] = inodes[3];
-      nnodes[3] = inodes[7];
-      clipped->add_elem(nnodes);
-      
-      nnodes[0] = inodes[1];
-      nnodes[1] = inodes[3];
-      nnodes[2] = inodes[6];
-      nnodes[3] = inodes[7];
-      clipped->add_elem(nnodes);
-      
-      nnodes[0] = inodes[0];
-      nnodes[1] = inodes[7];
-      nnodes[2] = inodes[6];
-      nnodes[3] = inodes[2];
-      clipped->add_elem(nnodes);
-      
-      nnodes[0] = inodes[0];
-      nnodes[1] = inodes[1];
-      nnodes[2] = inodes[6];
-      nnodes[3] = inodes[7];
-      clipped->add_elem(nnodes);
-    }
-  }
-  
-  VField* ofield = output->vfield();
-  ofield->resize_values();
-  CopyProperties(*input, *output);
-  
-    // Add the data values from the old field to the new field.
-  node_hash_type::iterator nmitr = nodemap.begin();
-  while (nmitr != nodemap.end())
-  {
-    ofield->copy_value(field,((*nmitr).first),((*nmitr).second));
-    ++nmitr;
-  }
-  
-    // Put the isovalue at the edge break points.
-  edge_hash_type::iterator emitr = edgemap.begin();
-  while (emitr != edgemap.end())
-  {
-    ofield->set_value(isoval,((*emitr).second));    
-    ++emitr;
-  }
-  
-    // Put the isovalue at the face break points.  Assumes linear
-    // interpolation across the faces (which seems safe, this is what we
-    // used to cut with.)
-  face_hash_type::iterator fmitr = facemap.begin();
-  while (fmitr != facemap.end())
-  {
-    ofield->set_value(isoval,((*fmitr).second));
-    ++fmitr;
-  }
-  
-  #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
-  if (algo->get_bool("build_mapping"))
-  {
-      // Create the interpolant matrix.
-    const size_type nrows = clipped->num_nodes();
-    const size_type ncols = mesh->num_nodes();
-
-    std::vector<index_type> cctmp(nrows*3);
-    std::vector<double> dtmp(nrows*3);
-    SparseRowMatrix::Builder sparseBuilder;
-    const SparseRowMatrix::Rows& rr = sparseBuilder.allocate_rows(nrows + 1);
-    
-    for (index_type i = 0; i < nrows * 3; i++)
-    {
-      cctmp[i] = -1;
-    }
-    
-    size_type nnz = 0;
-    
-      // Add the data values from the old field to the new field.
-    nmitr = nodemap.begin();
-    while (nmitr != nodemap.end())
-    {
-      cctmp[(*nmitr).second * 3] = (*nmitr).first;
-      dtmp[(*nmitr).second * 3 + 0] = 1.0;
-      nnz++;
-      ++nmitr;
+      node.weight[0] = 1.0 - dsecond - dthird;
+      node.weight[1] = dsecond;
+      node.weight[2] = dthird;
+      node.point = p;
+      return (num_nodes_++);
     }
-    
-      // Insert the double hits into cc.
-      // Put the isovalue at the edge break points.
-    emitr = edgemap.begin();
-    while (emitr != edgemap.end())
-    {
-      cctmp[(*emitr).second * 3 + 0] = (*emitr).first.first;
-      cctmp[(*emitr).second * 3 + 1] = (*emitr).first.second;
-      dtmp[(*emitr).second * 3 + 0] = 1.0 - (*emitr).first.dfirst;
-      dtmp[(*emitr).second * 3 + 1] = (*emitr).first.dfirst;
-      nnz+=2;
-      ++emitr;
-    }
-    
-      // Insert the double hits into cc.
-      // Put the isovalue at the edge break points.
-    fmitr = facemap.begin();
-    while (fmitr != facemap.end())
+
+    void add_elem(int n0, int n1, int n2, int n3 = -1)
     {
-      cctmp[(*fmitr).second * 3 + 0] = (*fmitr).first.first;
-      cctmp[(*fmitr).second * 3 + 1] = (*fmitr).first.second;
-      cctmp[(*fmitr).second * 3 + 2] = (*fmitr).first.third;
-      dtmp[(*fmitr).second * 3 + 0] =
-          1.0 - (*fmitr).first.dsecond - (*fmitr).first.dthird;;
-      dtmp[(*fmitr).second * 3 + 1] = (*fmitr).first.dsecond;
-      dtmp[(*fmitr).second * 3 + 2] = (*fmitr).first.dthird;
-      nnz+=3;
-      
-      ++fmitr;
+      int* elem = elems_[num_elems_++];
+      elem[0] = n0; elem[1] = n1; elem[2] = n2; elem[3] = n3;
     }
-    
-    const SparseRowMatrix::Columns& cc = sparseBuilder.allocate_columns(nnz);
-    const SparseRowMatrix::Storage& d = sparseBuilder.allocate_data(nnz);
-    
-    index_type j;
-    index_type counter = 0;
-    rr[0] = 0;
-    for (j = 0; j < nrows*3; j++)
+
+    int num_nodes() const { return (num_nodes_); }
+    const ClipNode& node(int j) const { return (nodes_[j]); }
+    int num_elems() const { return (num_elems_); }
+    const int* elem(int k) const { return (elems_[k]); }
+
+  private:
+    ClipNode nodes_[9];
+    int elems_[7][4];
+    int num_nodes_;
+    int num_elems_;
+};
+
+/// Clips single elements of a tet or tri mesh, SHAPE supplies the cases.
+template <class SHAPE>
+class ElementClipper
+{
+  public:
+    ElementClipper(VMesh* mesh, VField* field, double isoval, bool lte) :
+      mesh_(mesh), field_(field), isoval_(isoval), lte_(lte),
+      onodes_(SHAPE::num_corners), v_(SHAPE::num_corners), p_(SHAPE::num_corners) {}
+
+    /// Clip one element, returns false when it is discarded.
+    bool clip(VMesh::Elem::index_type idx)
     {
-      if (j%3 == 0) { rr[j/3 + 1] = rr[j/3]; }
-      if (cctmp[j] != -1)
+      mesh_->get_nodes(onodes_, idx);
+
+      // Get the values and compute an inside/outside mask.
+      VField::index_type inside = 0;
+      mesh_->get_centers(p_, onodes_);
+      field_->get_values(v_, onodes_);
+      for (size_t i = 0; i < onodes_.size(); i++)
       {
-        cc[counter] = cctmp[j];
-        d[counter] = dtmp[j];
-        rr[j/3 + 1]++;
-        counter++;
+        inside = inside << 1;
+        if (v_[i] > isoval_)
+        {
+          inside |= 1;
+        }
       }
+
+      // Invert the mask if we are doing less than.
+      if (lte_) { inside = ~inside & SHAPE::all_inside; }
+
+      // Discard outside elements.
+      if (inside == 0) return (false);
+
+      element_.clear();
+      SHAPE::clip(inside, onodes_, v_, p_, isoval_, element_);
+      return (true);
     }
-    mapping = new SparseRowMatrix(nrows, ncols, sparseBuilder.build(), nnz);
-  }
-  #endif
-  
-  return (true);
-}
 
-// Algorithm for tri meshes 
+    const ClippedElement& element() const { return (element_); }
 
-class ClipMeshByIsovalueAlgoTri
+  private:
+    VMesh* mesh_;
+    VField* field_;
+    double isoval_;
+    bool lte_;
+    VMesh::Node::array_type onodes_;
+    std::vector<double> v_;
+    std::vector<Point> p_;
+    ClippedElement element_;
+};
+
+/// Kept elements of one range of the input mesh, the cut nodes they create
+/// and the output nodes the range numbers. Owned entries are input nodes
+/// when positive and -(cut+1) for cut nodes.
+struct IsovalueClipRange
 {
-  public:
-    bool run(const AlgorithmBase* algo,FieldHandle input, FieldHandle& output, MatrixHandle& mapping) const;
-  
-private:
-    VMesh::Node::index_type
-    edge_lookup(VField::index_type u0, VField::index_type u1, double d0,
-          const Point &p, detail::edge_hash_type &edgemap,
-          VMesh *clipped) const;
+  IsovalueClipRange() : num_elems(0), num_weights(0) {}
+
+  std::vector<VMesh::Elem::index_type> elems;
+  VMesh::size_type num_elems;
+  std::vector<ClipNode> cuts;
+  boost::unordered_map<ClipNodeKey, index_type, ClipNodeKeyHash> cut_index;
+  std::vector<char> cut_owned;
+  std::vector<index_type> cut_number;
+  std::vector<index_type> owned;
+  size_type num_weights;
 };
 
-VMesh::Node::index_type ClipMeshByIsovalueAlgoTri::edge_lookup(VField::index_type u0, VField::index_type u1, double d0, const Point &p, detail::edge_hash_type &edgemap, VMesh *clipped) const
+/// Cut node created by several ranges, used to find the range that numbers it.
+struct SharedCut
 {
-  using namespace detail;
-  edgepair_t np;
-  if (u0 < u1)  { np.first = u0; np.second = u1; np.dfirst = d0; }
-  else { np.first = u1; np.second = u0; np.dfirst = 1.0 - d0; }
-  const auto loc = edgemap.find(np);
-  if (loc == edgemap.end())
-  {
-    const VMesh::Node::index_type nodeindex = clipped->add_point(p);
-    edgemap[np] = nodeindex;
-    return nodeindex;
-  }
-  else
+  ClipNodeKey key;
+  int proc;
+  index_type cut;
+
+  bool operator<(const SharedCut& b) const
   {
-    return loc->second;
+    if (key == b.key) return proc < b.proc;
+    return key < b.key;
   }
-}
+};
 
-bool ClipMeshByIsovalueAlgoTri::run(const AlgorithmBase* algo, FieldHandle input, FieldHandle& output, MatrixHandle &mapping) const
+/// Clip a simplex mesh in parallel. Nodes get the numbers the serial walk
+/// over the elements would give them: each input node and cut node is
+/// numbered by the first range that uses it, in order of appearance, and
+/// the ranges follow each other.
+template <class SHAPE>
+bool clip_simplex_mesh(const AlgorithmBase* algo, FieldHandle input, FieldHandle& output, MatrixHandle* mapping)
 {
   VField* field = input->vfield();
   VMesh*  mesh  = input->vmesh();
+  VField* ofield = output->vfield();
   VMesh*  clipped = output->vmesh();
-  
-  using namespace detail;
 
-  node_hash_type nodemap;
-  edge_hash_type edgemap;
+  const double isoval = algo->get(ClipMeshByIsovalueAlgo::ScalarIsoValue).toDouble();
+  const bool lte = !algo->get(ClipMeshByIsovalueAlgo::LessThanIsoValue).toBool();
 
-  VMesh::Node::array_type onodes(3);
-  std::vector<double> v(3);
-  std::vector<Point>  p(3);
+  const VMesh::size_type num_elems = mesh->num_elems();
+  const VMesh::size_type num_nodes = mesh->num_nodes();
 
-  double isoval = algo->get(ClipMeshByIsovalueAlgo::ScalarIsoValue).toDouble();
-    
-  bool lte = !algo->get(ClipMeshByIsovalueAlgo::LessThanIsoValue).toBool();
+  const int nproc = (num_elems < 10000) ? 1 : static_cast<int>(Parallel::NumCores());
+  std::vector<IsovalueClipRange> ranges(nproc);
 
-  VMesh::size_type num_elems = mesh->num_elems();
-  for (VMesh::Elem::index_type idx=0; idx<num_elems; idx++)
-  {
-    mesh->get_nodes(onodes, idx);
+  std::unique_ptr<std::atomic<int>[]> owner(new std::atomic<int>[num_nodes]);
+  std::vector<index_type> node_map(num_nodes, -1);
 
-    // Get the values and compute an inside/outside mask.
-    VField::index_type inside = 0;
-    mesh->get_centers(p, onodes);
-    field->get_values(v, onodes);
+  Parallel::RunTasks([&](int proc)
+  {
+    const index_type start = (num_nodes*proc)/nproc;
+    const index_type end = (num_nodes*(proc+1))/nproc;
+    for (index_type idx = start; idx < end; idx++)
+      owner[idx].store(nproc, std::memory_order_relaxed);
+  }, nproc);
+
+  // Step 1: clip the elements, claim the input nodes and collect the cut
+  // nodes of every range
+  Parallel::RunTasks([&](int proc)
+  {
+    IsovalueClipRange& range = ranges[proc];
+    ElementClipper<SHAPE> clipper(mesh, field, isoval, lte);
 
-    for (size_t i = 0; i < onodes.size(); i++)
+    const VMesh::Elem::index_type start = (num_elems*proc)/nproc;
+    const VMesh::Elem::index_type end = (num_elems*(proc+1))/nproc;
+    for (VMesh::Elem::index_type idx = start; idx < end; idx++)
     {
-      inside = inside << 1;
-      if (v[i] > isoval)
+      if (!clipper.clip(idx)) continue;
+
+      const ClippedElement& element = clipper.element();
+      range.elems.push_back(idx);
+      range.num_elems += element.num_elems();
+      for (int j = 0; j < element.num_nodes(); j++)
       {
-        inside |= 1;
+        const ClipNode& node = element.node(j);
+        if (node.is_cut())
+        {
+          if (range.cut_index.insert(std::make_pair(node.key, static_cast<index_type>(range.cuts.size()))).second)
+            range.cuts.push_back(node);
+        }
+        else
+        {
+          std::atomic<int>& o = owner[node.key.n[0]];
+          int current = o.load(std::memory_order_relaxed);
+          while (proc < current && !o.compare_exchange_weak(current, proc)) {}
+        }
       }
+      if (proc == 0 && (idx & 0xff) == 0) algo->update_progress_max(idx-start, 4*(end-start));
     }
+    range.cut_owned.assign(range.cuts.size(), 1);
+    range.cut_number.assign(range.cuts.size(), -1);
+  }, nproc);
 
-    // Invert the mask if we are doing less than.
-    if (lte) { inside = ~inside & 0x7; }
-
-    if (inside == 0)
+  // Cut nodes shared between ranges belong to the first of them
+  std::vector<SharedCut> shared;
+  if (nproc > 1)
+  {
+    for (int proc = 0; proc < nproc; proc++)
     {
-      // Discard outside elements.
+      const std::vector<ClipNode>& cuts = ranges[proc].cuts;
+      for (size_t c = 0; c < cuts.size(); c++)
+      {
+        SharedCut s = { cuts[c].key, proc, static_cast<index_type>(c) };
+        shared.push_back(s);
+      }
     }
-    else if (inside == 0x7)
-    {
-      // Add this element to the new mesh.
-      VMesh::Node::array_type nnodes(onodes.size());
+    std::sort(shared.begin(), shared.end());
+    for (size_t q = 1; q < shared.size(); q++)
+      if (shared[q].key == shared[q-1].key) ranges[shared[q].proc].cut_owned[shared[q].cut] = 0;
+  }
 
-      for (size_t i = 0; i<onodes.size(); i++)
+  // Step 2: number the nodes per range in order of appearance
+  Parallel::RunTasks([&](int proc)
+  {
+    IsovalueClipRange& range = ranges[proc];
+    ElementClipper<SHAPE> clipper(mesh, field, isoval, lte);
+
+    for (size_t k = 0; k < range.elems.size(); k++)
+    {
+      clipper.clip(range.elems[k]);
+      const ClippedElement& element = clipper.element();
+      for (int j = 0; j < element.num_nodes(); j++)
       {
-        if (nodemap.find((VField::index_type)onodes[i]) == nodemap.end())
+        const ClipNode& node = element.node(j);
+        if (node.is_cut())
         {
-          const VMesh::Node::index_type nodeindex = clipped->add_point(p[i]);
-          nodemap[(VField::index_type)onodes[i]] = nodeindex;
-          nnodes[i] = nodeindex;
+          const index_type c = range.cut_index.find(node.key)->second;
+          if (range.cut_owned[c] && range.cut_number[c] < 0)
+          {
+            range.cut_number[c] = static_cast<index_type>(range.owned.size());
+            range.owned.push_back(-(c+1));
+            range.num_weights += node.num_weights();
+          }
         }
         else
         {
-          nnodes[i] = nodemap[(VField::index_type)onodes[i]];
+          const index_type n = node.key.n[0];
+          if (owner[n].load(std::memory_order_relaxed) == proc && node_map[n] < 0)
+          {
+            node_map[n] = static_cast<index_type>(range.owned.size());
+            range.owned.push_back(n);
+            range.num_weights++;
+          }
         }
       }
-
-      clipped->add_elem(nnodes);
     }
-    else if (inside == 0x1 || inside == 0x2 || inside == 0x4)
+  }, nproc);
+  owner.reset();
+
+  std::vector<index_type> node_base(nproc+1, 0);
+  std::vector<index_type> elem_base(nproc+1, 0);
+  std::vector<index_type> weight_base(nproc+1, 0);
+  for (int proc = 0; proc < nproc; proc++)
+  {
+    node_base[proc+1] = node_base[proc] + static_cast<index_type>(ranges[proc].owned.size());
+    elem_base[proc+1] = elem_base[proc] + ranges[proc].num_elems;
+    weight_base[proc+1] = weight_base[proc] + ranges[proc].num_weights;
+  }
+
+  const size_type num_onodes = node_base[nproc];
+  const size_type num_oelems = elem_base[nproc];
+  algo->update_progress_max(1, 4);
+
+  // Step 3: place the output nodes
+  ClippedMeshWriter writer(clipped, num_onodes, num_oelems);
+  Point* opoints = writer.points();
+
+  Parallel::RunTasks([&](int proc)
+  {
+    IsovalueClipRange& range = ranges[proc];
+    for (size_t q = 0; q < range.owned.size(); q++)
     {
-      // Add the corner containing the inside point to the mesh.
-      const int *perm = tri_permute_table[inside];
-      VMesh::Node::array_type nnodes(onodes.size());
-      if (nodemap.find((VField::index_type)onodes[perm[0]]) == nodemap.end())
+      const index_type idx = node_base[proc] + static_cast<index_type>(q);
+      const index_type n = range.owned[q];
+      if (n >= 0)
       {
-        const VMesh::Node::index_type nodeindex =
-            clipped->add_point(p[perm[0]]);
-        nodemap[(VField::index_type)onodes[perm[0]]] = nodeindex;
-        nnodes[0] = nodeindex;
+        node_map[n] = idx;
+        mesh->get_center(opoints[idx], VMesh::Node::index_type(n));
       }
       else
       {
-        nnodes[0] = nodemap[(VField::index_type)onodes[perm[0]]];
+        range.cut_number[-n-1] = idx;
+        opoints[idx] = range.cuts[-n-1].point;
       }
+    }
+  }, nproc);
 
-      const double imv = isoval - v[perm[0]];
-      
-      const double dl1 = imv / (v[perm[1]] - v[perm[0]]);
-      const Point l1 = Interpolate(p[perm[0]], p[perm[1]], dl1);
-      const double dl2 = imv / (v[perm[2]] - v[perm[0]]);
-      const Point l2 = Interpolate(p[perm[0]], p[perm[2]], dl2);
-
+  for (size_t q = 0, first = 0; q < shared.size(); q++)
+  {
+    if (!(shared[q].key == shared[first].key)) first = q;
+    else if (q != first)
+      ranges[shared[q].proc].cut_number[shared[q].cut] =
+        ranges[shared[first].proc].cut_number[shared[first].cut];
+  }
+  std::vector<SharedCut>().swap(shared);
+  algo->update_progress_max(2, 4);
 
-      nnodes[1] = edge_lookup((VField::index_type)onodes[perm[0]],
-			      (index_type)onodes[perm[1]],
-			      dl1, l1, edgemap, clipped);
+  // Step 4: connect the output elements
+  index_type* oelems = writer.elems();
+  const size_type num_elem_nodes = writer.num_elem_nodes();
 
-      nnodes[2] = edge_lookup((VField::index_type)onodes[perm[0]],
-			      (index_type)onodes[perm[2]],
-			      dl2, l2, edgemap, clipped);
+  Parallel::RunTasks([&](int proc)
+  {
+    const IsovalueClipRange& range = ranges[proc];
+    ElementClipper<SHAPE> clipper(mesh, field, isoval, lte);
+    index_type idx = elem_base[proc];
+    index_type nodes[9];
 
-      clipped->add_elem(nnodes);
-    }
-    else
+    for (size_t k = 0; k < range.elems.size(); k++)
     {
-      // Lop off the one point that is outside of the mesh, then add
-      // the remaining quad to the mesh by dicing it into two
-      // triangles.
-      const int *perm = tri_permute_table[inside];
-      VMesh::Node::array_type inodes(4);
-      if (nodemap.find((index_type)onodes[perm[1]]) == nodemap.end())
-      {
-        const VMesh::Node::index_type nodeindex = clipped->add_point(p[perm[1]]);
-        nodemap[(VField::index_type)onodes[perm[1]]] = nodeindex;
-        inodes[0] = nodeindex;
-      }
-      else
+      clipper.clip(range.elems[k]);
+      const ClippedElement& element = clipper.element();
+      for (int j = 0; j < element.num_nodes(); j++)
       {
-        inodes[0] = nodemap[(VField::index_type)onodes[perm[1]]];
+        const ClipNode& node = element.node(j);
+        if (node.is_cut()) nodes[j] = range.cut_number[range.cut_index.find(node.key)->second];
+        else nodes[j] = node_map[node.key.n[0]];
       }
 
-      if (nodemap.find((VField::index_type)onodes[perm[2]]) == nodemap.end())
+      for (int e = 0; e < element.num_elems(); e++, idx++)
       {
-        const VMesh::Node::index_type nodeindex = clipped->add_point(p[perm[2]]);
-        nodemap[(VField::index_type)onodes[perm[2]]] = nodeindex;
-        inodes[1] = nodeindex;
+        const int* elem = element.elem(e);
+        for (size_type j = 0; j < num_elem_nodes; j++)
+          oelems[idx*num_elem_nodes+j] = nodes[elem[j]];
       }
-      else
+    }
+  }, nproc);
+
+  writer.commit();
+  algo->update_progress_max(3, 4);
+
+  // Step 5: data values, the input values at the original nodes and the
+  // isovalue at the cut nodes; linear interpolation across the faces is
+  // what they were cut with.
+  ofield->resize_values();
+
+  index_type* rows = 0;
+  index_type* cols = 0;
+  double* values = 0;
+  SparseRowMatrixHandle mat;
+  if (mapping && num_onodes > 0 && num_nodes > 0)
+  {
+    mat = boost::make_shared<SparseRowMatrix>(num_onodes, num_nodes);
+    mat->resizeNonZeros(weight_base[nproc]);
+    rows = mat->outerIndexPtr();
+    cols = mat->innerIndexPtr();
+    values = mat->valuePtr();
+    rows[0] = 0;
+  }
+
+  Parallel::RunTasks([&](int proc)
+  {
+    const IsovalueClipRange& range = ranges[proc];
+    index_type w = weight_base[proc];
+    for (size_t q = 0; q < range.owned.size(); q++)
+    {
+      const index_type idx = node_base[proc] + static_cast<index_type>(q);
+      const index_type n = range.owned[q];
+      if (n >= 0) ofield->copy_value(field, n, idx);
+      else ofield->set_value(isoval, idx);
+
+      if (rows)
       {
-        inodes[1] = nodemap[(VField::index_type)onodes[perm[2]]];
+        if (n >= 0)
+        {
+          cols[w] = n;
+          values[w++] = 1.0;
+        }
+        else
+        {
+          const ClipNode& cut = range.cuts[-n-1];
+          for (int j = 0; j < cut.num_weights(); j++)
+          {
+            cols[w] = cut.key.n[j];
+            values[w++] = cut.weight[j];
+          }
+        }
+        rows[idx+1] = w;
       }
+    }
+  }, nproc);
 
-      const double imv = isoval - v[perm[0]];
-      const double dl1 = imv / (v[perm[1]] - v[perm[0]]);
-      const Point l1 = Interpolate(p[perm[0]], p[perm[1]], dl1);
-      const double dl2 = imv / (v[perm[2]] - v[perm[0]]);
-      const Point l2 = Interpolate(p[perm[0]], p[perm[2]], dl2);
+  if (mapping)
+  {
+    if (mat) *mapping = mat;
+    else mapping->reset(new DenseMatrix(0,0));
+  }
 
-      inodes[2] = edge_lookup((VField::index_type)onodes[perm[0]],
-			      (VField::index_type)onodes[perm[1]],
-			      dl1, l1, edgemap, clipped);
+  CopyProperties(*input, *output);
 
-      inodes[3] = edge_lookup((VField::index_type)onodes[perm[0]],
-			      (VField::index_type)onodes[perm[2]],
-			      dl2, l2, edgemap, clipped);
+  return (true);
+}
 
-      VMesh::Node::array_type nnodes(onodes.size());
+}
 
-      nnodes[0] = inodes[0];
-      nnodes[1] = inodes[1];
-      nnodes[2] = inodes[3];
-      clipped->add_elem(nnodes);
+// Algorithm for tet meshes
 
-      nnodes[0] = inodes[0];
-      nnodes[1] = inodes[3];
-      nnodes[2] = inodes[2];
-      clipped->add_elem(nnodes);
+class ClipMeshByIsovalueAlgoTet
+{
+  public:
+    static const int num_corners = 4;
+    static const VField::index_type all_inside = 0xf;
+
+    bool run(const AlgorithmBase* algo, FieldHandle input, FieldHandle& output, MatrixHandle* mapping) const
+    {
+      return (clip_simplex_mesh<ClipMeshByIsovalueAlgoTet>(algo, input, output, mapping));
     }
-  }
 
-  VField* ofield = output->vfield();
-  ofield->resize_values(); 
-  #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
-   ofield->copy_properties(field);
-  #endif
+    static void clip(VField::index_type inside, const VMesh::Node::array_type& onodes,
+                     const std::vector<double>& v, const std::vector<Point>& p,
+                     double isoval, ClippedElement& clipped);
+};
 
-  // Add the data values from the old field to the new field.
-  node_hash_type::iterator nmitr = nodemap.begin();
-  while (nmitr != nodemap.end())
+void ClipMeshByIsovalueAlgoTet::clip(VField::index_type inside, const VMesh::Node::array_type& onodes, const std::vector<double>& v, const std::vector<Point>& p, double isoval, ClippedElement& clipped)
+{
+  if (inside == 0xf)
   {
-    ofield->copy_value(field,((*nmitr).first),((*nmitr).second));
-    ++nmitr;
-  }
+      // Add this element to the new mesh.
+    int nnodes[4];
+    for (size_t i = 0; i<onodes.size(); i++)
+    {
+      nnodes[i] = clipped.input_node(onodes[i], p[i]);
+    }
 
-  // Put the isovalue at the edge break points.
-  edge_hash_type::iterator emitr = edgemap.begin();
-  while (emitr != edgemap.end())
+    clipped.add_elem(nnodes[0], nnodes[1], nnodes[2], nnodes[3]);
+  }
+  else if (inside == 0x8 || inside == 0x4 || inside == 0x2 || inside == 0x1)
   {
-    ofield->set_value(isoval, ((*emitr).second));
-    ++emitr;
+      // Lop off 3 points and add resulting tet to the new mesh.
+    const int *perm = tet_permute_table[inside];
+    int nnodes[4];
+
+    nnodes[0] = clipped.input_node(onodes[perm[0]], p[perm[0]]);
+
+    const double imv = isoval - v[perm[0]];
+    const double dl1 = imv / (v[perm[1]] - v[perm[0]]);
+    const Point l1 = Interpolate(p[perm[0]], p[perm[1]], dl1);
+    const double dl2 = imv / (v[perm[2]] - v[perm[0]]);
+    const Point l2 = Interpolate(p[perm[0]], p[perm[2]], dl2);
+    const double dl3 = imv / (v[perm[3]] - v[perm[0]]);
+    const Point l3 = Interpolate(p[perm[0]], p[perm[3]], dl3);
+
+    nnodes[1] = clipped.edge_node(onodes[perm[0]], onodes[perm[1]], dl1, l1);
+    nnodes[2] = clipped.edge_node(onodes[perm[0]], onodes[perm[2]], dl2, l2);
+    nnodes[3] = clipped.edge_node(onodes[perm[0]], onodes[perm[3]], dl3, l3);
+
+    clipped.add_elem(nnodes[0], nnodes[1], nnodes[2], nnodes[3]);
   }
-  
-  #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
-  if(algo->get_bool("build_mapping"))
+  else if (inside == 0x7 || inside == 0xb || inside == 0xd || inside == 0xe)
   {
-    // Create the interpolant matrix.
-    
-    const size_type nrows = clipped->num_nodes();
-    const size_type ncols = mesh->num_nodes();
-    std::vector<index_type> cctmp(nrows*2);
-    std::vector<double> dtmp(nrows*2);
-    SparseRowMatrix::Builder sparseBuilder;
-    const SparseRowMatrix::Rows& rr = sparseBuilder.allocate_rows(nrows + 1);
-
-    for (index_type i = 0; i < nrows * 2; i++)
+      // Lop off 1 point, break up the resulting quads and add the
+      // resulting tets to the mesh.
+    const int *perm = tet_permute_table[inside];
+
+    int inodes[9];
+    for (size_t i = 1; i < 4; i++)
     {
-      cctmp[i] = -1;
+      inodes[i-1] = clipped.input_node(onodes[perm[i]], p[perm[i]]);
     }
 
-    size_type nnz = 0;
+    const double imv = isoval - v[perm[0]];
+    const double dl1 = imv / (v[perm[1]] - v[perm[0]]);
+    const Point l1 = Interpolate(p[perm[0]], p[perm[1]], dl1);
+    const double dl2 = imv / (v[perm[2]] - v[perm[0]]);
+    const Point l2 = Interpolate(p[perm[0]], p[perm[2]], dl2);
+    const double dl3 = imv / (v[perm[3]] - v[perm[0]]);
+    const Point l3 = Interpolate(p[perm[0]], p[perm[3]], dl3);
+
+    inodes[3] = clipped.edge_node(onodes[perm[0]], onodes[perm[1]], dl1, l1);
+    inodes[4] = clipped.edge_node(onodes[perm[0]], onodes[perm[2]], dl2, l2);
+    inodes[5] = clipped.edge_node(onodes[perm[0]], onodes[perm[3]], dl3, l3);
+
+    const Point c1 = Interpolate(l1, l2, 0.5);
+    const Point c2 = Interpolate(l2, l3, 0.5);
+    const Point c3 = Interpolate(l3, l1, 0.5);
+
+    inodes[6] = clipped.face_node(onodes[perm[0]], onodes[perm[1]], onodes[perm[2]],
+                                  dl1*0.5, dl2*0.5, c1);
+    inodes[7] = clipped.face_node(onodes[perm[0]], onodes[perm[2]], onodes[perm[3]],
+                                  dl2*0.5, dl3*0.5, c2);
+    inodes[8] = clipped.face_node(onodes[perm[0]], onodes[perm[3]], onodes[perm[1]],
+                                  dl3*0.5, dl1*0.5, c3);
+
+    clipped.add_elem(inodes[0], inodes[3], inodes[8], inodes[6]);
+    clipped.add_elem(inodes[1], inodes[4], inodes[6], inodes[7]);
+    clipped.add_elem(inodes[2], inodes[5], inodes[7], inodes[8]);
+    clipped.add_elem(inodes[0], inodes[6], inodes[8], inodes[7]);
+    clipped.add_elem(inodes[0], inodes[8], inodes[2], inodes[7]);
+    clipped.add_elem(inodes[0], inodes[6], inodes[7], inodes[1]);
+    clipped.add_elem(inodes[0], inodes[1], inodes[7], inodes[2]);
+  }
+  else// if (inside == 0x3 || inside == 0x5 || inside == 0x6 ||
+        //     inside == 0x9 || inside == 0xa || inside == 0xc)
+  {
+      // Lop off two points, break the resulting quads, then add the
+      // new tets to the mesh.
+    const int *perm = tet_permute_table[inside];
 
-    // Add the data values from the old field to the new field.
-    nmitr = nodemap.begin();
-    while (nmitr != nodemap.end())
+    int inodes[8];
+    for (size_t i = 2; i < 4; i++)
     {
-      cctmp[(*nmitr).second * 2] = (*nmitr).first;
-      dtmp[(*nmitr).second * 2 + 0] = 1.0;
-      nnz++;
-      ++nmitr;
+      inodes[i-2] = clipped.input_node(onodes[perm[i]], p[perm[i]]);
     }
+    const double imv0 = isoval - v[perm[0]];
+    const double dl02 = imv0 / (v[perm[2]] - v[perm[0]]);
+    const Point l02 = Interpolate(p[perm[0]], p[perm[2]], dl02);
+    const double dl03 = imv0 / (v[perm[3]] - v[perm[0]]);
+    const Point l03 = Interpolate(p[perm[0]], p[perm[3]], dl03);
+
+    const double imv1 = isoval - v[perm[1]];
+    const double dl12 = imv1 / (v[perm[2]] - v[perm[1]]);
+    const Point l12 = Interpolate(p[perm[1]], p[perm[2]], dl12);
+    const double dl13 = imv1 / (v[perm[3]] - v[perm[1]]);
+    const Point l13 = Interpolate(p[perm[1]], p[perm[3]], dl13);
+
+    inodes[2] = clipped.edge_node(onodes[perm[0]], onodes[perm[2]], dl02, l02);
+    inodes[3] = clipped.edge_node(onodes[perm[0]], onodes[perm[3]], dl03, l03);
+    inodes[4] = clipped.edge_node(onodes[perm[1]], onodes[perm[2]], dl12, l12);
+    inodes[5] = clipped.edge_node(onodes[perm[1]], onodes[perm[3]], dl13, l13);
+
+    const Point c1 = Interpolate(l02, l03, 0.5);
+    const Point c2 = Interpolate(l12, l13, 0.5);
+
+    inodes[6] = clipped.face_node(onodes[perm[0]], onodes[perm[2]], onodes[perm[3]],
+                                  dl02*0.5, dl03*0.5, c1);
+    inodes[7] = clipped.face_node(onodes[perm[1]], onodes[perm[2]], onodes[perm[3]],
+                                  dl12*0.5, dl13*0.5, c2);
+
+    clipped.add_elem(inodes[7], inodes[2], inodes[0], inodes[4]);
+    clipped.add_elem(inodes[1], inodes[5], inodes[3], inodes[7]);
+    clipped.add_elem(inodes[1], inodes[3], inodes[6], inodes[7]);
+    clipped.add_elem(inodes[0], inodes[7], inodes[6], inodes[2]);
+    clipped.add_elem(inodes[0], inodes[1], inodes[6], inodes[7]);
+  }
+}
+
+// Algorithm for tri meshes
+
+class ClipMeshByIsovalueAlgoTri
+{
+  public:
+    static const int num_corners = 3;
+    static const VField::index_type all_inside = 0x7;
 
-    // Insert the double hits into cc.
-    // Put the isovalue at the edge break points.
-    emitr = edgemap.begin();
-    while (emitr != edgemap.end())
+    bool run(const AlgorithmBase* algo, FieldHandle input, FieldHandle& output, MatrixHandle* mapping) const
     {
-      cctmp[(*emitr).second * 2 + 0] = (*emitr).first.first;
-      cctmp[(*emitr).second * 2 + 1] = (*emitr).first.second;
-      dtmp[(*emitr).second * 2 + 0] = 1.0 - (*emitr).first.dfirst;
-      dtmp[(*emitr).second * 2 + 1] = (*emitr).first.dfirst;
-      nnz+=2;
-      ++emitr;
+      return (clip_simplex_mesh<ClipMeshByIsovalueAlgoTri>(algo, input, output, mapping));
     }
 
-    const SparseRowMatrix::Columns& cc = sparseBuilder.allocate_columns(nnz);
-    const SparseRowMatrix::Storage& d = sparseBuilder.allocate_data(nnz);
-    
-    index_type j;
-    index_type counter = 0;
-    rr[0] = 0;
-    for (j = 0; j < nrows*2; j++)
+    static void clip(VField::index_type inside, const VMesh::Node::array_type& onodes,
+                     const std::vector<double>& v, const std::vector<Point>& p,
+                     double isoval, ClippedElement& clipped);
+};
+
+void ClipMeshByIsovalueAlgoTri::clip(VField::index_type inside, const VMesh::Node::array_type& onodes, const std::vector<double>& v, const std::vector<Point>& p, double isoval, ClippedElement& clipped)
+{
+  if (inside == 0x7)
+  {
+    // Add this element to the new mesh.
+    int nnodes[3];
+    for (size_t i = 0; i<onodes.size(); i++)
     {
-      if (j%2 == 0) { rr[j/2 + 1] = rr[j/2]; }
-      if (cctmp[j] != -1)
-      {
-        cc[counter] = cctmp[j];
-        d[counter] = dtmp[j];
-        rr[j/2 + 1]++;
-        counter++;
-      }
+      nnodes[i] = clipped.input_node(onodes[i], p[i]);
     }
-    mapping = new SparseRowMatrix(nrows, ncols, sparseBuilder.build(), nnz);
+
+    clipped.add_elem(nnodes[0], nnodes[1], nnodes[2]);
+  }
+  else if (inside == 0x1 || inside == 0x2 || inside == 0x4)
+  {
+    // Add the corner containing the inside point to the mesh.
+    const int *perm = tri_permute_table[inside];
+    int nnodes[3];
+    nnodes[0] = clipped.input_node(onodes[perm[0]], p[perm[0]]);
+
+    const double imv = isoval - v[perm[0]];
+
+    const double dl1 = imv / (v[perm[1]] - v[perm[0]]);
+    const Point l1 = Interpolate(p[perm[0]], p[perm[1]], dl1);
+    const double dl2 = imv / (v[perm[2]] - v[perm[0]]);
+    const Point l2 = Interpolate(p[perm[0]], p[perm[2]], dl2);
+
+    nnodes[1] = clipped.edge_node(onodes[perm[0]], onodes[perm[1]], dl1, l1);
+    nnodes[2] = clipped.edge_node(onodes[perm[0]], onodes[perm[2]], dl2, l2);
+
+    clipped.add_elem(nnodes[0], nnodes[1], nnodes[2]);
+  }
+  else
+  {
+    // Lop off the one point that is outside of the mesh, then add
+    // the remaining quad to the mesh by dicing it into two
+    // triangles.
+    const int *perm = tri_permute_table[inside];
+    int inodes[4];
+    inodes[0] = clipped.input_node(onodes[perm[1]], p[perm[1]]);
+    inodes[1] = clipped.input_node(onodes[perm[2]], p[perm[2]]);
+
+    const double imv = isoval - v[perm[0]];
+    const double dl1 = imv / (v[perm[1]] - v[perm[0]]);
+    const Point l1 = Interpolate(p[perm[0]], p[perm[1]], dl1);
+    const double dl2 = imv / (v[perm[2]] - v[perm[0]]);
+    const Point l2 = Interpolate(p[perm[0]], p[perm[2]], dl2);
+
+    inodes[2] = clipped.edge_node(onodes[perm[0]], onodes[perm[1]], dl1, l1);
+    inodes[3] = clipped.edge_node(onodes[perm[0]], onodes[perm[2]], dl2, l2);
+
+    clipped.add_elem(inodes[0], inodes[1], inodes[3]);
+    clipped.add_elem(inodes[0], inodes[3], inodes[2]);
   }
-  #endif
-  
-  return (true);
 }
 
 class ClipMeshByIsovalueAlgoHex 
@@ -1322,27 +1188,17 @@ bool ClipMeshByIsovalueAlgoHex::run(const AlgorithmBase* algo, FieldHandle input
 
 // Version without building mapping matrix
 bool ClipMeshByIsovalueAlgo::run(FieldHandle input, FieldHandle& output) const
-{ 
-   // Store old setting
-   #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
-   bool temp = get_bool("build_mapping");
-   set_bool("build_mapping",false);
-   #endif
-   MatrixHandle dummy;
-   // Run full algorithm
-   
-   bool ret = run(input,output,dummy);
-   // Reset old setting
-   #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
-   set_bool("build_mapping",temp);
-   #endif
-   // Return result
-   return (ret);
-
+{
+  return (run_clip(input, output, 0));
 }
 
 // Version with building mapping matrix
 bool ClipMeshByIsovalueAlgo::run(FieldHandle input, FieldHandle& output, MatrixHandle& mapping) const
+{
+  return (run_clip(input, output, &mapping));
+}
+
+bool ClipMeshByIsovalueAlgo::run_clip(FieldHandle input, FieldHandle& output, MatrixHandle* mapping) const
 {
   // Mark that we are starting the algorithm, but do not report progress
   #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
@@ -1428,7 +1284,8 @@ bool ClipMeshByIsovalueAlgo::run(FieldHandle input, FieldHandle& output, MatrixH
   else if (fi.is_hex_element())
   {
     ClipMeshByIsovalueAlgoHex algo;
-    if(!( algo.run(this,input,output,mapping)))
+    MatrixHandle dummy;
+    if(!( algo.run(this,input,output,mapping ? *mapping : dummy)))
     {
       return (false);
     }
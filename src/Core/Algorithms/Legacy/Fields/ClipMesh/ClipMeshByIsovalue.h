@@ -65,6 +65,10 @@ class SCISHARE ClipMeshByIsovalueAlgo : public AlgorithmBase
     static AlgorithmOutputName OutputField;
     static AlgorithmParameterName LessThanIsoValue;
     static AlgorithmParameterName ScalarIsoValue;
+
+  private:
+    /// Builds the mapping matrix only when mapping is given.
+    bool run_clip(FieldHandle input, FieldHandle& output, Datatypes::MatrixHandle* mapping) const;
 };
 
 }}}} // end namespace SCIRunAlgo
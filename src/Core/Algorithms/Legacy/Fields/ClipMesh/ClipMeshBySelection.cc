@@ -27,6 +27,7 @@
 */
 
 #include <Core/Algorithms/Legacy/Fields/ClipMesh/ClipMeshBySelection.h>
+#include <Core/Algorithms/Legacy/Fields/ClipMesh/ClippedMeshWriter.h>
 
 #include <Core/Algorithms/Base/AlgorithmVariableNames.h>
 #include <Core/Algorithms/Base/AlgorithmPreconditions.h>
@@ -36,12 +37,17 @@
 #include <Core/Datatypes/Legacy/Field/VMesh.h>
 #include <Core/Datatypes/Matrix.h>
 #include <Core/Datatypes/DenseMatrix.h>
-#include <Core/Datatypes/SparseRowMatrixFromMap.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
 #include <Core/Datatypes/Legacy/Field/FieldInformation.h>
 #include <Core/Logging/Log.h>
+#include <Core/Thread/Parallel.h>
+
+#include <boost/make_shared.hpp>
 
 #include <algorithm>
-#include <set>
+#include <atomic>
+#include <memory>
+#include <vector>
 
 using namespace SCIRun;
 using namespace SCIRun::Core::Datatypes;
@@ -78,6 +84,45 @@ ClipMeshBySelectionAlgo::runImpl(FieldHandle input,
   return ret;
 }
 
+namespace {
+
+/// Elements of one range of the input mesh that are kept, with their nodes
+/// in input numbering, and the nodes this range numbers in the output.
+struct ClipRange
+{
+  std::vector<index_type> elems;
+  std::vector<index_type> nodes;
+  std::vector<index_type> owned;
+};
+
+/// Mapping matrix with a single unit entry per row.
+SparseRowMatrixHandle build_selection_mapping(const std::vector<index_type>& columns, size_type num_columns, int nproc)
+{
+  const size_type num_rows = static_cast<size_type>(columns.size());
+  SparseRowMatrixHandle mat(boost::make_shared<SparseRowMatrix>(num_rows, num_columns));
+  mat->resizeNonZeros(num_rows);
+  index_type* rows = mat->outerIndexPtr();
+  index_type* cols = mat->innerIndexPtr();
+  double* values = mat->valuePtr();
+  rows[0] = 0;
+
+  Parallel::RunTasks([&](int proc)
+  {
+    const index_type start = (num_rows*proc)/nproc;
+    const index_type end = (num_rows*(proc+1))/nproc;
+    for (index_type idx = start; idx < end; idx++)
+    {
+      rows[idx+1] = idx+1;
+      cols[idx] = columns[idx];
+      values[idx] = 1.0;
+    }
+  }, nproc);
+
+  return mat;
+}
+
+}
+
 // Version with building mapping matrix
 
 bool
@@ -139,13 +184,11 @@ ClipMeshBySelectionAlgo::runImpl(FieldHandle input,
   // 0, so force it to run through the element method.
   if (imesh->is_pointcloudmesh()) method = "Element Center";
 
-  if (method == "Element Center")
-  {
-    std::vector<index_type> node_mapping(imesh->num_nodes(),-1);
-    std::vector<index_type> elem_mapping(imesh->num_elems(),-1);
-    std::vector<index_type> node_mapping2(imesh->num_nodes(),-1);
-    std::vector<index_type> elem_mapping2(imesh->num_elems(),-1);
+  const bool elem_selection = (method == "Element Center");
+  int target = 1;
 
+  if (elem_selection)
+  {
     LOG_DEBUG("Num Elems " << imesh->num_elems() << "; Num Tets " << sfield->num_values() << std::endl);
 
     if (imesh->num_elems() != sfield->num_values())
@@ -153,216 +196,190 @@ ClipMeshBySelectionAlgo::runImpl(FieldHandle input,
       error("Number of elements in input mesh does not match number of values in selection mesh.");
       return (false);
     }
+  }
+  else
+  {
+    if (method == "One Node") target = 1;
+    else if (method == "Most Nodes") target = omesh->num_nodes_per_elem()/2;
+    else if (method == "All Nodes") target = omesh->num_nodes_per_elem();
 
-    VMesh::Node::array_type nodes;
-    VMesh::points_type points;
-
-    int cnt = 0;
+    LOG_DEBUG("Num Nodes " << imesh->num_nodes() << "; Num Tets " << sfield->num_values() << std::endl);
 
-    for (VMesh::Elem::index_type idx=0; idx<num_elems; idx++)
+    if (imesh->num_nodes() != sfield->num_values())
     {
-      char val;
-      sfield->get_value(val,idx);
-      if (val)
-      {
-        imesh->get_nodes(nodes,idx);
-        imesh->get_centers(points,nodes);
+      error("Number of nodes in input mesh does not match number of values in selection mesh.");
+      return (false);
+    }
+  }
 
-        for (size_t j=0; j<nodes.size();j++)
-        {
-          if (node_mapping[nodes[j]] < 0)
-          {
-            node_mapping[nodes[j]] = omesh->add_node(points[j]);
-            node_mapping2[node_mapping[nodes[j]]] = nodes[j];
-          }
-          nodes[j] = node_mapping[nodes[j]];
-        }
+  const int nproc = (num_elems < 10000) ? 1 : static_cast<int>(Parallel::NumCores());
+  std::vector<ClipRange> ranges(nproc);
 
-        elem_mapping[idx] = omesh->add_elem(nodes);
-        elem_mapping2[elem_mapping[idx]] = idx;
-      }
-      cnt++; if (cnt == 100) { cnt=0; update_progress_max(idx,num_elems);}
-    }
+  // Every node is numbered by the first range that keeps an element using
+  // it, which is decided with an atomic minimum over the ranges
+  std::unique_ptr<std::atomic<int>[]> owner(new std::atomic<int>[num_nodes]);
+  std::vector<index_type> node_mapping(num_nodes, -1);
 
-    ofield->resize_values();
-    VMesh::size_type num_oelems = omesh->num_elems();
-    VMesh::size_type num_onodes = omesh->num_nodes();
+  Parallel::RunTasks([&](int proc)
+  {
+    const index_type start = (num_nodes*proc)/nproc;
+    const index_type end = (num_nodes*(proc+1))/nproc;
+    for (index_type idx = start; idx < end; idx++)
+      owner[idx].store(nproc, std::memory_order_relaxed);
+  }, nproc);
+
+  // Step 2: select the elements
+  Parallel::RunTasks([&](int proc)
+  {
+    ClipRange& range = ranges[proc];
+    VMesh::Node::array_type nodes;
+    std::vector<char> values;
 
-    if (ofield->basis_order() == 0)
+    const VMesh::Elem::index_type start = (num_elems*proc)/nproc;
+    const VMesh::Elem::index_type end = (num_elems*(proc+1))/nproc;
+    for (VMesh::Elem::index_type idx = start; idx < end; idx++)
     {
-      for(VMesh::Elem::index_type idx=0; idx<num_oelems; idx++)
+      bool keep = false;
+      if (elem_selection)
       {
-        ofield->copy_value(ifield,elem_mapping2[idx],idx);
+        char val;
+        sfield->get_value(val,idx);
+        keep = (val != 0);
+        if (keep) imesh->get_nodes(nodes,idx);
       }
-    }
-    else if (ofield->basis_order() == 1)
-    {
-      for(VMesh::Node::index_type idx=0; idx<num_onodes; idx++)
+      else
       {
-        ofield->copy_value(ifield,node_mapping2[idx],idx);
+        imesh->get_nodes(nodes,idx);
+        sfield->get_values(values,nodes);
+        int ctarget = 0;
+        for (size_t j=0; j<values.size(); j++) if (values[j]) ctarget++;
+        keep = (ctarget >= target);
       }
-    }
 
-    bool build_mapping = get(Parameters::BuildMapping).toBool();
-    if (build_mapping)
-    {
-      size_type m,n;
-
-      if (ofield->basis_order() == 0)
+      if (keep)
       {
-        if (num_elems > 0 && num_oelems > 0)
+        range.elems.push_back(idx);
+        for (size_t j=0; j<nodes.size(); j++)
         {
-          SparseRowMatrixFromMap::Values map;
-
-          n =   num_elems;
-          m =   num_oelems;
-
-          for (index_type idx=0;idx<m;idx++)
-          {
-            map[idx][elem_mapping2[idx]] = 1.0;
-          }
-
-          mapping = SparseRowMatrixFromMap::make(m, n, map);
+          range.nodes.push_back(nodes[j]);
+          std::atomic<int>& o = owner[nodes[j]];
+          int current = o.load(std::memory_order_relaxed);
+          while (proc < current && !o.compare_exchange_weak(current, proc)) {}
         }
       }
-      else if (ofield->basis_order() == 1)
-      {
-        if (num_nodes > 0 && num_onodes >0)
-        {
-          SparseRowMatrixFromMap::Values map;
-
-          n =   num_nodes;
-          m =   num_onodes;
-
-          for (index_type idx=0;idx<m;idx++)
-          {
-            map[idx][node_mapping2[idx]] = 1.0;
-          }
+      if (proc == 0 && (idx & 0xff) == 0) update_progress_max(idx-start, 3*(end-start));
+    }
+  }, nproc);
 
-          mapping = SparseRowMatrixFromMap::make(m, n, map);
-        }
+  // Step 3: number the nodes per range in order of appearance, which is the
+  // order in which a serial walk over the elements adds them
+  Parallel::RunTasks([&](int proc)
+  {
+    ClipRange& range = ranges[proc];
+    for (size_t q = 0; q < range.nodes.size(); q++)
+    {
+      const index_type n = range.nodes[q];
+      if (owner[n].load(std::memory_order_relaxed) == proc && node_mapping[n] < 0)
+      {
+        node_mapping[n] = static_cast<index_type>(range.owned.size());
+        range.owned.push_back(n);
       }
-      // provide an empty matrix
-      if (!mapping)
-        mapping.reset(new DenseMatrix(0,0));
     }
-  }
-  else
-  {
-    int target = 1;
-    if (method == "One Node") target = 1;
-    else if (method == "Most Nodes") target = omesh->num_nodes_per_elem()/2;
-    else if (method == "All Nodes") target = omesh->num_nodes_per_elem();
+  }, nproc);
+  owner.reset();
 
-    std::vector<index_type> node_mapping(imesh->num_nodes(),-1);
-    std::vector<index_type> elem_mapping(imesh->num_elems(),-1);
-    std::vector<index_type> node_mapping2(imesh->num_nodes(),-1);
-    std::vector<index_type> elem_mapping2(imesh->num_elems(),-1);
+  std::vector<index_type> node_base(nproc+1, 0);
+  std::vector<index_type> elem_base(nproc+1, 0);
+  for (int proc = 0; proc < nproc; proc++)
+  {
+    node_base[proc+1] = node_base[proc] + static_cast<index_type>(ranges[proc].owned.size());
+    elem_base[proc+1] = elem_base[proc] + static_cast<index_type>(ranges[proc].elems.size());
+  }
 
-    LOG_DEBUG("Num Nodes " << imesh->num_nodes() << "; Num Tets " << sfield->num_values() << std::endl);
+  const size_type num_onodes = node_base[nproc];
+  const size_type num_oelems = elem_base[nproc];
+  std::vector<index_type> node_mapping2(num_onodes);
+  std::vector<index_type> elem_mapping2(num_oelems);
+  update_progress_max(1, 3);
 
+  // Step 4: fill the output mesh
+  ClippedMeshWriter writer(omesh, num_onodes, num_oelems);
+  Point* opoints = writer.points();
 
-    if (imesh->num_nodes() != sfield->num_values())
+  Parallel::RunTasks([&](int proc)
+  {
+    const std::vector<index_type>& owned = ranges[proc].owned;
+    for (size_t q = 0; q < owned.size(); q++)
     {
-      error("Number of nodes in input mesh does not match number of values in selection mesh.");
-      return (false);
+      const index_type idx = node_base[proc] + static_cast<index_type>(q);
+      node_mapping[owned[q]] = idx;
+      node_mapping2[idx] = owned[q];
+      imesh->get_center(opoints[idx], VMesh::Node::index_type(owned[q]));
     }
+  }, nproc);
 
-    VMesh::Node::array_type nodes;
-    VMesh::points_type points;
-    std::vector<char> values;
-
-    int cnt = 0;
+  index_type* oelems = writer.elems();
+  const size_type num_elem_nodes = writer.num_elem_nodes();
 
-    for(VMesh::Elem::index_type idx=0; idx<num_elems; idx++)
+  Parallel::RunTasks([&](int proc)
+  {
+    const ClipRange& range = ranges[proc];
+    for (size_t k = 0; k < range.elems.size(); k++)
     {
-      imesh->get_nodes(nodes,idx);
-      sfield->get_values(values,nodes);
-      int ctarget = 0;
-      for (size_t j=0; j<values.size(); j++) if (values[j]) ctarget++;
-
-      if (ctarget >= target)
+      const index_type idx = elem_base[proc] + static_cast<index_type>(k);
+      elem_mapping2[idx] = range.elems[k];
+      if (oelems)
       {
-        imesh->get_centers(points,nodes);
-        for (size_t j=0; j<nodes.size();j++)
-        {
-          if (node_mapping[nodes[j]] < 0)
-          {
-            node_mapping[nodes[j]] = omesh->add_node(points[j]);
-            // reverse mapping
-            node_mapping2[node_mapping[nodes[j]]] = nodes[j];
-          }
-          nodes[j] = node_mapping[nodes[j]];
-        }
-
-        elem_mapping[idx] = omesh->add_elem(nodes);
-        elem_mapping2[elem_mapping[idx]] = idx;
+        for (size_type j = 0; j < num_elem_nodes; j++)
+          oelems[idx*num_elem_nodes+j] = node_mapping[range.nodes[k*num_elem_nodes+j]];
       }
-
-      cnt++; if (cnt == 100) { cnt=0; update_progress_max(idx,num_elems);}
     }
+  }, nproc);
 
-    ofield->resize_values();
-    VMesh::size_type num_oelems = omesh->num_elems();
-    VMesh::size_type num_onodes = omesh->num_nodes();
+  ranges.clear();
+  writer.commit();
+  update_progress_max(2, 3);
 
-    if (ofield->basis_order() == 0)
+  ofield->resize_values();
+
+  if (ofield->basis_order() == 0)
+  {
+    const int nprocv = (num_oelems < 10000) ? 1 : nproc;
+    Parallel::RunTasks([&](int proc)
     {
-      for(VMesh::Elem::index_type idx=0; idx<num_oelems; idx++)
-      {
+      const VMesh::Elem::index_type start = (num_oelems*proc)/nprocv;
+      const VMesh::Elem::index_type end = (num_oelems*(proc+1))/nprocv;
+      for (VMesh::Elem::index_type idx = start; idx < end; idx++)
         ofield->copy_value(ifield,elem_mapping2[idx],idx);
-      }
-    }
-    else if (ofield->basis_order() == 1)
+    }, nprocv);
+  }
+  else if (ofield->basis_order() == 1)
+  {
+    const int nprocv = (num_onodes < 10000) ? 1 : nproc;
+    Parallel::RunTasks([&](int proc)
     {
-      for(VMesh::Node::index_type idx=0; idx<num_onodes; idx++)
-      {
+      const VMesh::Node::index_type start = (num_onodes*proc)/nprocv;
+      const VMesh::Node::index_type end = (num_onodes*(proc+1))/nprocv;
+      for (VMesh::Node::index_type idx = start; idx < end; idx++)
         ofield->copy_value(ifield,node_mapping2[idx],idx);
-      }
-    }
+    }, nprocv);
+  }
 
-    bool build_mapping = get(Parameters::BuildMapping).toBool();
-    if (build_mapping)
+  bool build_mapping = get(Parameters::BuildMapping).toBool();
+  if (build_mapping)
+  {
+    if (ofield->basis_order() == 0)
     {
-      size_type m,n;
-
-      if (ofield->basis_order() == 0)
-      {
-        if (num_elems > 0 && num_oelems > 0)
-        {
-          SparseRowMatrixFromMap::Values map;
-
-          n =   num_elems;
-          m =   num_oelems;
-
-          for (index_type idx=0;idx<m;idx++)
-          {
-            map[idx][elem_mapping2[idx]] = 1.0;
-          }
-
-          mapping = SparseRowMatrixFromMap::make(m, n, map);
-        }
-      }
-      else if (ofield->basis_order() == 1)
-      {
-        if (num_nodes > 0 && num_onodes > 0)
-        {
-          SparseRowMatrixFromMap::Values map;
-
-          n =   num_nodes;
-          m =   num_onodes;
-
-          for (index_type idx=0;idx<m;idx++)
-          {
-            map[idx][node_mapping2[idx]] = 1.0;
-          }
-
-          mapping = SparseRowMatrixFromMap::make(m, n, map);
-        }
-      }
-      // provide an empty matrix
-      if (!mapping) mapping.reset(new DenseMatrix(0,0));
+      if (num_elems > 0 && num_oelems > 0)
+        mapping = build_selection_mapping(elem_mapping2, num_elems, nproc);
+    }
+    else if (ofield->basis_order() == 1)
+    {
+      if (num_nodes > 0 && num_onodes > 0)
+        mapping = build_selection_mapping(node_mapping2, num_nodes, nproc);
     }
+    // provide an empty matrix
+    if (!mapping) mapping.reset(new DenseMatrix(0,0));
   }
 
   /// Copy properties of the property manager
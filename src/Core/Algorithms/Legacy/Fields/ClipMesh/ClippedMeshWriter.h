@@ -0,0 +1,134 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef CORE_ALGORITHMS_FIELDS_CLIPMESH_CLIPPEDMESHWRITER_H
+#define CORE_ALGORITHMS_FIELDS_CLIPMESH_CLIPPEDMESHWRITER_H 1
+
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/GeometryPrimitives/Point.h>
+
+#include <vector>
+
+namespace SCIRun {
+  namespace Core {
+    namespace Algorithms {
+      namespace Fields {
+
+/// Writes the nodes and elements of a clipped mesh whose sizes are known up
+/// front. The mesh is resized once and its point and connectivity arrays
+/// are filled in place, so disjoint ranges can be written from different
+/// threads. Quad meshes reorder the nodes of every face they add and some
+/// meshes do not expose their arrays; for those the data is buffered and
+/// added through the VMesh interface in commit().
+class ClippedMeshWriter
+{
+  public:
+    ClippedMeshWriter(VMesh* mesh, VMesh::size_type num_nodes, VMesh::size_type num_elems) :
+      mesh_(mesh),
+      num_nodes_(num_nodes),
+      num_elems_(num_elems),
+      num_elem_nodes_(mesh->num_nodes_per_elem()),
+      points_(0),
+      elems_(0)
+    {
+      // Point clouds have no connectivity, their elements are the nodes
+      const bool has_elems = !mesh->is_pointcloudmesh();
+
+      if (!mesh->is_quadsurfmesh())
+      {
+        mesh->resize_nodes(num_nodes);
+        if (has_elems) mesh->resize_elems(num_elems);
+        if (num_nodes > 0) points_ = mesh->get_points_pointer();
+        if (num_elems > 0 && has_elems) elems_ = mesh->get_elems_pointer();
+        if ((num_nodes > 0 && !points_) || (num_elems > 0 && has_elems && !elems_))
+        {
+          mesh->resize_nodes(0);
+          if (has_elems) mesh->resize_elems(0);
+          points_ = 0;
+          elems_ = 0;
+        }
+      }
+
+      if (num_nodes > 0 && !points_)
+      {
+        point_buffer_.resize(num_nodes);
+        points_ = &point_buffer_[0];
+      }
+      if (num_elems > 0 && has_elems && !elems_)
+      {
+        elem_buffer_.resize(num_elems*num_elem_nodes_);
+        elems_ = &elem_buffer_[0];
+      }
+    }
+
+    /// Node coordinates, one per output node.
+    Core::Geometry::Point* points() const { return (points_); }
+    /// Element nodes, num_elem_nodes() per output element. Zero for point
+    /// clouds.
+    VMesh::index_type* elems() const { return (elems_); }
+    VMesh::size_type num_elem_nodes() const { return (num_elem_nodes_); }
+
+    /// Add buffered data to the mesh.
+    void commit()
+    {
+      if (!point_buffer_.empty())
+      {
+        mesh_->node_reserve(num_nodes_);
+        for (size_t j = 0; j < point_buffer_.size(); j++) mesh_->add_node(point_buffer_[j]);
+        std::vector<Core::Geometry::Point>().swap(point_buffer_);
+      }
+
+      if (!elem_buffer_.empty())
+      {
+        mesh_->elem_reserve(num_elems_);
+        VMesh::Node::array_type nodes(num_elem_nodes_);
+        for (VMesh::index_type idx = 0; idx < num_elems_; idx++)
+        {
+          for (VMesh::size_type j = 0; j < num_elem_nodes_; j++)
+            nodes[j] = elem_buffer_[idx*num_elem_nodes_+j];
+          mesh_->add_elem(nodes);
+        }
+        std::vector<VMesh::index_type>().swap(elem_buffer_);
+      }
+    }
+
+  private:
+    VMesh* mesh_;
+    VMesh::size_type num_nodes_;
+    VMesh::size_type num_elems_;
+    VMesh::size_type num_elem_nodes_;
+    Core::Geometry::Point* points_;
+    VMesh::index_type* elems_;
+    std::vector<Core::Geometry::Point> point_buffer_;
+    std::vector<VMesh::index_type> elem_buffer_;
+};
+
+      }}}}
+
+#endif
@@ -27,39 +27,23 @@
 */
 
 
-#ifndef CORE_ALGORITHMS_FIELDS_FILTERFIELDDATA_ERODEFILTER_H
-#define CORE_ALGORITHMS_FIELDS_FILTERFIELDDATA_ERODEFILTER_H 1
+#ifndef CORE_ALGORITHMS_FIELDS_FILTERFIELDDATA_ERODEFIELDDATA_H
+#define CORE_ALGORITHMS_FIELDS_FILTERFIELDDATA_ERODEFIELDDATA_H 1
 
-// Datatypes that the algorithm uses
-#include <Core/Datatypes/Mesh.h>
-#include <Core/Datatypes/Field.h>
+#include <Core/Algorithms/Legacy/Fields/FilterFieldData/MorphologicalFilter.h>
+#include <Core/Algorithms/Legacy/Fields/share.h>
 
-// Base class for algorithm
-#include <Core/Algorithms/Util/AlgoBase.h>
+namespace SCIRun {
+  namespace Core {
+    namespace Algorithms {
+      namespace Fields {
 
-// for Windows support
-#include <Core/Algorithms/Fields/share.h>
-
-namespace SCIRunAlgo {
-
-using namespace SCIRun;
-
-class SCISHARE ErodeFieldDataAlgo : public AlgoBase
-{
-  public:
-    /// Set defaults
-    ErodeFieldDataAlgo()
-    {
-      /// Number of iterations to perform
-      add_int("num_iterations",2);
-    }
-  
-    /// run the algorithm
-    bool run(FieldHandle input, FieldHandle& output);
-};
-
-} // end namespace SCIRunAlgo
-
-#endif 
+        class SCISHARE ErodeFieldDataAlgo : public MorphologicalFilterAlgo
+        {
+        public:
+          ErodeFieldDataAlgo();
+        };
 
+      }}}}
 
+#endif
@@ -0,0 +1,492 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Core/Algorithms/Legacy/Fields/FilterFieldData/MorphologicalFilter.h>
+#include <Core/Algorithms/Base/AlgorithmVariableNames.h>
+#include <Core/Algorithms/Base/AlgorithmPreconditions.h>
+#include <Core/Containers/CompressedAdjacency.h>
+#include <Core/Datatypes/Legacy/Field/Field.h>
+#include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/Legacy/Field/FieldInformation.h>
+#include <Core/Thread/Parallel.h>
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Algorithms::Fields;
+using namespace SCIRun::Core::Thread;
+
+ALGORITHM_PARAMETER_DEF(Fields, MorphologyIterations);
+ALGORITHM_PARAMETER_DEF(Fields, MorphologyNeighborhood);
+
+namespace {
+
+typedef VMesh::index_type index_type;
+typedef VMesh::size_type size_type;
+
+/// Dilation keeps the larger value, erosion the smaller one. A value is
+/// only replaced by a strictly better one, which gives the same result as
+/// the original loop over the neighbors, NaN and signed zeros included.
+template <class T>
+struct Larger
+{
+  static bool better(T a, T b) { return (a > b); }
+  static T identity()
+  {
+    return (std::numeric_limits<T>::has_infinity ?
+      -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::lowest());
+  }
+};
+
+template <class T>
+struct Smaller
+{
+  static bool better(T a, T b) { return (a < b); }
+  static T identity()
+  {
+    return (std::numeric_limits<T>::has_infinity ?
+      std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max());
+  }
+};
+
+template <class OP, class T>
+inline T pick(T val, T nval)
+{
+  return (OP::better(nval, val) ? nval : val);
+}
+
+template <class OP, class T>
+inline void pick_row(T* out, const T* in, size_type n)
+{
+  for (size_type i = 0; i < n; i++) out[i] = pick<OP>(out[i], in[i]);
+}
+
+/// One iteration over a lattice with the face neighbors of every value,
+/// which are the neighbors the structured meshes report. Every row along x
+/// is combined with the rows next to it, so all inner loops run over
+/// contiguous memory.
+template <class OP, class T>
+void cross_pass(const T* in, T* out, const size_type dims[3], int nproc)
+{
+  const size_type nx = dims[0];
+  const size_type ny = dims[1];
+  const size_type nz = dims[2];
+  const size_type rows = ny*nz;
+  const size_type slab = nx*ny;
+
+  Parallel::RunTasks([&](int proc)
+  {
+    const size_type start = (rows*proc)/nproc;
+    const size_type end = (rows*(proc+1))/nproc;
+    for (size_type r = start; r < end; r++)
+    {
+      const size_type j = r % ny;
+      const size_type k = r / ny;
+      const T* c = in + r*nx;
+      T* o = out + r*nx;
+
+      if (nx == 1)
+      {
+        o[0] = c[0];
+      }
+      else
+      {
+        o[0] = pick<OP>(c[0], c[1]);
+        for (size_type i = 1; i < nx-1; i++)
+          o[i] = pick<OP>(pick<OP>(c[i], c[i-1]), c[i+1]);
+        o[nx-1] = pick<OP>(c[nx-1], c[nx-2]);
+      }
+
+      if (j > 0) pick_row<OP>(o, c-nx, nx);
+      if (j < ny-1) pick_row<OP>(o, c+nx, nx);
+      if (k > 0) pick_row<OP>(o, c-slab, nx);
+      if (k < nz-1) pick_row<OP>(o, c+slab, nx);
+    }
+  }, nproc);
+}
+
+/// Running maximum (minimum) over 2*radius+1 values along one axis, using
+/// the van Herk/Gil-Werman algorithm: the axis is cut in blocks of the
+/// window size and a forward and a backward scan within every block give
+/// each window from two lookups, whatever the radius. The data is viewed
+/// as [outer][n][inner] and a work unit filters a block of adjacent inner
+/// columns together. Values beyond the ends of the axis are left out.
+template <class OP, class T>
+void box_axis(const T* in, T* out, size_type outer, size_type n, size_type inner, size_type radius)
+{
+  const size_type window = 2*radius+1;
+  const size_type len = ((n + 2*radius + window - 1)/window)*window;
+  const size_type width = std::max<size_type>(1, std::min<size_type>(inner, 65536/len));
+  const size_type blocks = (inner + width - 1)/width;
+  const size_type units = outer*blocks;
+  const int nproc = (outer*n*inner < 10000) ? 1 :
+    static_cast<int>(std::min<size_type>(units, Parallel::NumCores()));
+  const T identity = OP::identity();
+
+  Parallel::RunTasks([&](int proc)
+  {
+    std::vector<T> g(len*width), h(len*width);
+
+    const size_type start = (units*proc)/nproc;
+    const size_type end = (units*(proc+1))/nproc;
+    for (size_type u = start; u < end; u++)
+    {
+      const size_type c0 = (u % blocks)*width;
+      const size_type m = std::min(width, inner - c0);
+      const T* src = in + (u / blocks)*n*inner + c0;
+      T* dst = out + (u / blocks)*n*inner + c0;
+
+      // Position p of the scans holds value p-radius of the axis
+      for (size_type p = 0; p < len; p++)
+      {
+        T* gp = &g[p*width];
+        const bool inside = (p >= radius && p < n + radius);
+        const T* s = inside ? src + (p-radius)*inner : 0;
+        if (p % window == 0)
+        {
+          if (inside) std::copy(s, s+m, gp);
+          else std::fill(gp, gp+m, identity);
+        }
+        else
+        {
+          const T* gq = gp - width;
+          if (inside) for (size_type c = 0; c < m; c++) gp[c] = pick<OP>(gq[c], s[c]);
+          else std::copy(gq, gq+m, gp);
+        }
+      }
+
+      for (size_type p = len; p-- > 0; )
+      {
+        T* hp = &h[p*width];
+        const bool inside = (p >= radius && p < n + radius);
+        const T* s = inside ? src + (p-radius)*inner : 0;
+        if (p % window == window-1)
+        {
+          if (inside) std::copy(s, s+m, hp);
+          else std::fill(hp, hp+m, identity);
+        }
+        else
+        {
+          const T* hq = hp + width;
+          if (inside) for (size_type c = 0; c < m; c++) hp[c] = pick<OP>(hq[c], s[c]);
+          else std::copy(hq, hq+m, hp);
+        }
+      }
+
+      for (size_type i = 0; i < n; i++)
+      {
+        const T* hi = &h[i*width];
+        const T* gi = &g[(i+2*radius)*width];
+        T* d = dst + i*inner;
+        for (size_type c = 0; c < m; c++) d[c] = pick<OP>(hi[c], gi[c]);
+      }
+    }
+  }, nproc);
+}
+
+template <class OP, class T, class PROGRESS>
+void filter_structured(T* data, const size_type dims[3], int iterations, bool box, PROGRESS progress)
+{
+  const size_type n = dims[0]*dims[1]*dims[2];
+  std::vector<T> buffer(n);
+  T* src = data;
+  T* dst = &buffer[0];
+
+  if (box)
+  {
+    size_type inner = 1;
+    size_type outer = n;
+    for (int axis = 0; axis < 3; axis++)
+    {
+      outer /= dims[axis];
+      if (dims[axis] > 1)
+      {
+        box_axis<OP>(src, dst, outer, dims[axis], inner, iterations);
+        std::swap(src, dst);
+      }
+      inner *= dims[axis];
+      progress(axis+1, 3);
+    }
+  }
+  else
+  {
+    const int nproc = (n < 10000) ? 1 : static_cast<int>(Parallel::NumCores());
+    for (int it = 0; it < iterations; it++)
+    {
+      cross_pass<OP>(src, dst, dims, nproc);
+      std::swap(src, dst);
+      progress(it+1, iterations);
+    }
+  }
+
+  if (src != data) std::copy(src, src+n, data);
+}
+
+/// Iterations on any other mesh. The neighbors are gathered from the mesh
+/// once. The first iteration visits every value; after that only the
+/// neighbors of values that changed in the previous iteration can change,
+/// as mesh neighbors are symmetric, so only those are revisited. Updates
+/// are applied after each pass, so every pass sees the values of the
+/// previous one.
+template <class OP, class T, class PROGRESS>
+void filter_unstructured(T* data, const CompressedAdjacency<index_type>& neighbors,
+                         int iterations, PROGRESS progress)
+{
+  const size_type n = static_cast<size_type>(neighbors.size());
+  std::vector<index_type> active(n);
+  for (index_type idx = 0; idx < n; idx++) active[idx] = idx;
+
+  // Iteration in which a value was last queued, to queue it only once
+  std::unique_ptr<std::atomic<int>[]> queued(new std::atomic<int>[n]);
+  for (index_type idx = 0; idx < n; idx++) queued[idx].store(-1, std::memory_order_relaxed);
+
+  for (int it = 0; it < iterations && !active.empty(); it++)
+  {
+    const size_type num_active = static_cast<size_type>(active.size());
+    const int nproc = (num_active < 10000) ? 1 : static_cast<int>(Parallel::NumCores());
+
+    std::vector<std::vector<std::pair<index_type, T> > > changed(nproc);
+    Parallel::RunTasks([&](int proc)
+    {
+      const size_type start = (num_active*proc)/nproc;
+      const size_type end = (num_active*(proc+1))/nproc;
+      std::vector<std::pair<index_type, T> >& local = changed[proc];
+      for (size_type a = start; a < end; a++)
+      {
+        const index_type idx = active[a];
+        const CompressedAdjacency<index_type>::Row row = neighbors[idx];
+        T val = data[idx];
+        bool update = false;
+        for (size_t j = 0; j < row.size(); j++)
+        {
+          const T nval = data[row[j]];
+          if (OP::better(nval, val)) { val = nval; update = true; }
+        }
+        if (update) local.push_back(std::make_pair(idx, val));
+      }
+    }, nproc);
+
+    std::vector<std::vector<index_type> > next(nproc);
+    Parallel::RunTasks([&](int proc)
+    {
+      const std::vector<std::pair<index_type, T> >& local = changed[proc];
+      for (size_t q = 0; q < local.size(); q++)
+      {
+        data[local[q].first] = local[q].second;
+        const CompressedAdjacency<index_type>::Row row = neighbors[local[q].first];
+        for (size_t j = 0; j < row.size(); j++)
+        {
+          if (queued[row[j]].exchange(it, std::memory_order_relaxed) != it)
+            next[proc].push_back(row[j]);
+        }
+      }
+    }, nproc);
+
+    active.clear();
+    for (int proc = 0; proc < nproc; proc++)
+      active.insert(active.end(), next[proc].begin(), next[proc].end());
+    progress(it+1, iterations);
+  }
+}
+
+struct FilterSetup
+{
+  VMesh* mesh;
+  VField* field;
+  bool dilate;
+  bool structured;
+  bool box;
+  int iterations;
+};
+
+template <class OP, class T, class PROGRESS>
+void filter_values(const FilterSetup& setup, PROGRESS progress)
+{
+  T* data = reinterpret_cast<T*>(setup.field->fdata_pointer());
+  const size_type num_values = setup.field->num_values();
+  if (num_values == 0 || setup.iterations == 0) return;
+
+  if (setup.structured)
+  {
+    VMesh::dimension_type dim;
+    setup.field->get_values_dimension(dim);
+    size_type dims[3] = { 1, 1, 1 };
+    for (size_t k = 0; k < dim.size() && k < 3; k++) dims[k] = dim[k];
+    if (dims[0]*dims[1]*dims[2] == num_values)
+    {
+      filter_structured<OP>(data, dims, setup.iterations, setup.box, progress);
+      return;
+    }
+  }
+
+  std::vector<size_t> offsets(num_values+1, 0);
+  std::vector<index_type> values;
+  if (setup.field->basis_order() == 0)
+  {
+    setup.mesh->synchronize(Mesh::ELEM_NEIGHBORS_E);
+    VMesh::Elem::array_type elems;
+    for (VMesh::Elem::index_type idx = 0; idx < num_values; idx++)
+    {
+      setup.mesh->get_neighbors(elems, idx);
+      values.insert(values.end(), elems.begin(), elems.end());
+      offsets[idx+1] = values.size();
+    }
+  }
+  else
+  {
+    setup.mesh->synchronize(Mesh::NODE_NEIGHBORS_E);
+    VMesh::Node::array_type nodes;
+    for (VMesh::Node::index_type idx = 0; idx < num_values; idx++)
+    {
+      setup.mesh->get_neighbors(nodes, idx);
+      values.insert(values.end(), nodes.begin(), nodes.end());
+      offsets[idx+1] = values.size();
+    }
+  }
+
+  CompressedAdjacency<index_type> neighbors;
+  neighbors.assign(offsets, values);
+  filter_unstructured<OP>(data, neighbors, setup.iterations, progress);
+}
+
+template <class T, class PROGRESS>
+void filter_data(const FilterSetup& setup, PROGRESS progress)
+{
+  if (setup.dilate) filter_values<Larger<T> , T>(setup, progress);
+  else filter_values<Smaller<T>, T>(setup, progress);
+}
+
+}
+
+MorphologicalFilterAlgo::MorphologicalFilterAlgo(Operation op) :
+  op_(op)
+{
+  /// Number of iterations to perform, or the box radius
+  addParameter(Parameters::MorphologyIterations, 2);
+  add_option(Parameters::MorphologyNeighborhood, "neighbors", "neighbors|box");
+}
+
+bool MorphologicalFilterAlgo::runImpl(FieldHandle input, FieldHandle& output) const
+{
+  ScopedAlgorithmStatusReporter asr(this, (op_ == DILATE) ? "DilateFieldData" : "ErodeFieldData");
+
+  if (!input)
+  {
+    error("No input field");
+    return (false);
+  }
+
+  FieldInformation fi(input);
+
+  if (fi.is_nonlinear())
+  {
+    error("This function has not yet been defined for non-linear elements");
+    return (false);
+  }
+
+  if (fi.is_nodata())
+  {
+    error("There is no data defined in the input field");
+    return (false);
+  }
+
+  if (!fi.is_scalar())
+  {
+    error("The field data is not scalar data");
+    return (false);
+  }
+
+  FilterSetup setup;
+  setup.dilate = (op_ == DILATE);
+  setup.structured = fi.is_structuredmesh();
+  setup.box = (get_option(Parameters::MorphologyNeighborhood) == "box");
+  setup.iterations = get(Parameters::MorphologyIterations).toInt();
+
+  if (setup.iterations < 0)
+  {
+    error("The number of iterations needs to be zero or larger");
+    return (false);
+  }
+
+  if (setup.box && !setup.structured)
+  {
+    warning("A box neighborhood needs a structured mesh, using the mesh neighbors instead");
+    setup.box = false;
+  }
+
+  output.reset(input->deep_clone());
+  if (!output)
+  {
+    error("Could not allocate output field");
+    return (false);
+  }
+
+  setup.mesh = output->vmesh();
+  setup.field = output->vfield();
+
+  auto progress = [this](int step, int steps) { update_progress_max(step, steps); };
+
+  if (fi.is_char()) filter_data<char>(setup, progress);
+  else if (fi.is_unsigned_char()) filter_data<unsigned char>(setup, progress);
+  else if (fi.is_short()) filter_data<short>(setup, progress);
+  else if (fi.is_unsigned_short()) filter_data<unsigned short>(setup, progress);
+  else if (fi.is_int()) filter_data<int>(setup, progress);
+  else if (fi.is_unsigned_int()) filter_data<unsigned int>(setup, progress);
+  else if (fi.is_longlong()) filter_data<long long>(setup, progress);
+  else if (fi.is_unsigned_longlong()) filter_data<unsigned long long>(setup, progress);
+  else if (fi.is_float()) filter_data<float>(setup, progress);
+  else if (fi.is_double()) filter_data<double>(setup, progress);
+  else
+  {
+    error("Unsupported data type");
+    return (false);
+  }
+
+  return (true);
+}
+
+AlgorithmOutput MorphologicalFilterAlgo::run_generic(const AlgorithmInput& input) const
+{
+  auto field = input.get<Field>(Variables::InputField);
+
+  FieldHandle outputField;
+  if (!runImpl(field, outputField))
+    THROW_ALGORITHM_PROCESSING_ERROR("False returned on legacy run call.");
+
+  AlgorithmOutput output;
+  output[Variables::OutputField] = outputField;
+  return output;
+}
@@ -0,0 +1,66 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef CORE_ALGORITHMS_FIELDS_FILTERFIELDDATA_MORPHOLOGICALFILTER_H
+#define CORE_ALGORITHMS_FIELDS_FILTERFIELDDATA_MORPHOLOGICALFILTER_H 1
+
+#include <Core/Algorithms/Base/AlgorithmBase.h>
+#include <Core/Algorithms/Legacy/Fields/share.h>
+
+namespace SCIRun {
+  namespace Core {
+    namespace Algorithms {
+      namespace Fields {
+
+        ALGORITHM_PARAMETER_DECL(MorphologyIterations);
+        ALGORITHM_PARAMETER_DECL(MorphologyNeighborhood);
+
+        /// Shared implementation of grayscale dilation and erosion of scalar
+        /// field data. With the "neighbors" neighborhood every iteration
+        /// replaces a value by the maximum (minimum) of itself and its mesh
+        /// neighbors. The "box" neighborhood is only available on structured
+        /// meshes: it filters with a box of 2*iterations+1 values per axis.
+        class SCISHARE MorphologicalFilterAlgo : public AlgorithmBase
+        {
+        public:
+          bool runImpl(FieldHandle input, FieldHandle& output) const;
+
+          virtual AlgorithmOutput run_generic(const AlgorithmInput& input) const override;
+
+        protected:
+          enum Operation { DILATE, ERODE };
+          explicit MorphologicalFilterAlgo(Operation op);
+
+        private:
+          Operation op_;
+        };
+
+      }}}}
+
+#endif
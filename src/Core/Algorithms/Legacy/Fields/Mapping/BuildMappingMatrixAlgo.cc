@@ -27,6 +27,7 @@
 */
 
 #include <Core/Algorithms/Legacy/Fields/Mapping/BuildMappingMatrixAlgo.h>
+#include <Core/Algorithms/Legacy/Fields/Mapping/MappingMatrixCache.h>
 #include <Core/Algorithms/Base/AlgorithmVariableNames.h>
 #include <Core/Algorithms/Base/AlgorithmPreconditions.h>
 #include <Core/Thread/Parallel.h>
@@ -36,9 +37,10 @@
 #include <Core/Datatypes/Legacy/Field/VMesh.h>
 #include <Core/Datatypes/Legacy/Field/FieldInformation.h>
 #include <Core/Datatypes/Matrix.h>
-#include <Core/Datatypes/SparseRowMatrixFromMap.h>
 #include <Core/Datatypes/SparseRowMatrix.h>
 
+#include <sstream>
+
 using namespace SCIRun;
 using namespace SCIRun::Core::Datatypes;
 using namespace SCIRun::Core::Algorithms;
@@ -46,12 +48,17 @@ using namespace SCIRun::Core::Algorithms::Fields;
 using namespace SCIRun::Core::Thread;
 using namespace SCIRun::Core::Geometry;
 
+ALGORITHM_PARAMETER_DEF(Fields, UseMappingCache);
+ALGORITHM_PARAMETER_DEF(Fields, MappingCacheDirectory);
+
 const AlgorithmOutputName BuildMappingMatrixAlgo::Mapping("Mapping");
 
 BuildMappingMatrixAlgo::BuildMappingMatrixAlgo()
 {
   addParameter(Parameters::MaxDistance, -1.0);
   add_option(Parameters::MappingMethod, "interpolateddata","interpolateddata|closestdata|singledestination");
+  addParameter(Parameters::UseMappingCache, false);
+  addParameter(Parameters::MappingCacheDirectory, std::string());
 }
 
 namespace detail
@@ -64,26 +71,103 @@ namespace detail
   {
   public:
     BuildMappingMatrixPAlgoBase(const std::string& barrierName, int nproc) : 
-      sfield_(0), dfield_(0), smesh_(0), dmesh_(0), rr_(0), cc_(0), vv_(0),
-      maxdist_(0), algo_(0), nproc_(nproc),
+      sfield_(0), dfield_(0), smesh_(0), dmesh_(0), e_(1), matrix_(0),
+      maxdist_(0), algo_(0), nproc_(nproc), fragments_(nproc),
       barrier_(barrierName, nproc) {}
     VField* sfield_;
     VField* dfield_;
     VMesh*  smesh_;
     VMesh*  dmesh_;
 
-    index_type* rr_;
-    index_type* cc_;
-    double* vv_;
+    // Column and weight for each of the e_ slots of a row, unused slots
+    // have column -1
+    std::vector<index_type> cc_;
+    std::vector<double> vv_;
+    size_type e_;
+
+    SparseRowMatrix* matrix_;
 
     double  maxdist_;
     const AlgorithmBase* algo_;
 
   protected:
+    // Rows of the matrix filled in by one thread
+    struct Fragment
+    {
+      Fragment() : offset(0) {}
+      std::vector<index_type> row_end;
+      std::vector<index_type> columns;
+      std::vector<double> values;
+      index_type offset;
+    };
+
+    void assemble(int proc);
+
     int nproc_;
+    std::vector<Fragment> fragments_;
     Barrier  barrier_;
   };
 
+  void BuildMappingMatrixPAlgoBase::assemble(int proc)
+  {
+    // Compact the slots of the rows of this thread, sorting the columns of
+    // each row and adding up weights for the same column
+    const index_type num_rows = matrix_->nrows();
+    const index_type start = (num_rows/nproc_)*proc;
+    const index_type end = (proc == nproc_-1) ? num_rows : (num_rows/nproc_)*(proc+1);
+
+    Fragment& frag = fragments_[proc];
+    frag.row_end.resize(end-start);
+    frag.columns.reserve((end-start)*e_);
+    frag.values.reserve((end-start)*e_);
+
+    for (index_type row=start; row<end; row++)
+    {
+      const size_t first = frag.columns.size();
+      for (index_type j=row*e_; j<(row+1)*e_; j++)
+      {
+        const index_type col = cc_[j];
+        if (col < 0) continue;
+
+        size_t k = frag.columns.size();
+        while (k > first && frag.columns[k-1] > col) k--;
+        if (k > first && frag.columns[k-1] == col)
+        {
+          frag.values[k-1] += vv_[j];
+          continue;
+        }
+        frag.columns.insert(frag.columns.begin()+k, col);
+        frag.values.insert(frag.values.begin()+k, vv_[j]);
+      }
+      frag.row_end[row-start] = frag.columns.size();
+    }
+
+    barrier_.wait();
+
+    if (proc == 0)
+    {
+      index_type nnz = 0;
+      for (int p=0; p<nproc_; p++)
+      {
+        fragments_[p].offset = nnz;
+        nnz += fragments_[p].columns.size();
+      }
+      matrix_->resizeNonZeros(nnz);
+      matrix_->outerIndexPtr()[0] = 0;
+    }
+
+    barrier_.wait();
+
+    // Fragments go straight into the arrays of the matrix
+    std::copy(frag.columns.begin(), frag.columns.end(), matrix_->innerIndexPtr() + frag.offset);
+    std::copy(frag.values.begin(), frag.values.end(), matrix_->valuePtr() + frag.offset);
+    index_type* rows = matrix_->outerIndexPtr();
+    for (index_type row=start; row<end; row++)
+    {
+      rows[row+1] = frag.offset + frag.row_end[row-start];
+    }
+  }
+
   class BuildMappingMatrixClosestDataPAlgo : public BuildMappingMatrixPAlgoBase
   {
   public:
@@ -188,23 +272,7 @@ namespace detail
 
     barrier_.wait();
 
-    if (proc == 0)
-    {
-      VField::size_type num_dvalues = dfield_->num_values();
-
-      rr_[0] = 0;
-      VMesh::index_type k = 0;
-      for (VMesh::index_type idx=0; idx<num_dvalues;idx++)
-      {
-        if (cc_[idx] >= 0)
-        {
-          cc_[k] = cc_[idx];
-          vv_[k] = 1.0;
-          k++;
-        }
-        rr_[idx+1] = k;
-      }
-    }
+    assemble(proc);
   }
 
 
@@ -219,8 +287,6 @@ namespace detail
         BuildMappingMatrixPAlgoBase("BuildMappingMatrixSingleDestinationPAlgo Barrier", nproc) {}
 
         void parallel(int proc);
-
-        std::vector<index_type> tcc_;
   };
 
   void
@@ -233,11 +299,6 @@ namespace detail
     VField::index_type end = localsize*(proc+1);
     if (proc == nproc_-1) end = num_values;
 
-    if (proc == 0)
-    {
-      tcc_.resize(dfield_->num_values());
-    }
-
     barrier_.wait();
 
     int cnt = 0;
@@ -325,30 +386,21 @@ namespace detail
 
     if (proc == 0)
     {
+      // Slots were filled per source, turn them into one slot per
+      // destination
       VField::size_type num_dvalues = dfield_->num_values();
-      for (VMesh::index_type idx=0; idx<num_dvalues;idx++)
-      {
-        tcc_[idx] = -1;
-      }
+      std::vector<index_type> tcc(num_dvalues, -1);
       for (VMesh::index_type idx=0; idx<num_values;idx++)
       {
-        tcc_[cc_[idx]] = idx;
-      }
-
-      rr_[0] = 0;
-      VMesh::index_type k = 0;
-      for (VMesh::index_type idx=0; idx<num_dvalues;idx++)
-      {
-        if (tcc_[idx] >= 0)
-        {
-          cc_[k] = tcc_[idx];
-          vv_[k] = 1.0;
-          k++;
-        }
-        rr_[idx+1] = k;
+        if (cc_[idx] >= 0) tcc[cc_[idx]] = idx;
       }
+      cc_.swap(tcc);
+      vv_.assign(num_dvalues, 1.0);
     }
 
+    barrier_.wait();
+
+    assemble(proc);
   }
 
 
@@ -360,11 +412,9 @@ namespace detail
   {
   public:
     explicit BuildMappingMatrixInterpolatedDataPAlgo(int nproc) :
-        BuildMappingMatrixPAlgoBase("BuildMappingMatrixInterpolatedDataPAlgo Barrier", nproc), e_(0) {}
+        BuildMappingMatrixPAlgoBase("BuildMappingMatrixInterpolatedDataPAlgo Barrier", nproc) {}
 
         void parallel(int proc);
-
-        size_type e_;
   };
 
   void BuildMappingMatrixInterpolatedDataPAlgo::parallel(int proc)
@@ -499,28 +549,7 @@ namespace detail
 
     barrier_.wait();
 
-    if (proc == 0)
-    {
-      VField::size_type num_dvalues = dfield_->num_values();
-
-      rr_[0] = 0;
-      VMesh::index_type k = 0;
-      VMesh::index_type kk = 0;
-      for (VMesh::index_type idx=0; idx<num_dvalues;idx++)
-      {
-        for (VMesh::index_type j=0;j<e_;j++)
-        {
-          if (cc_[kk] >= 0)
-          {
-            cc_[k] = cc_[kk];
-            vv_[k] = vv_[kk];
-            k++;
-          }
-          kk++;
-        }
-        rr_[idx+1] = k;
-      }
-    }
+    assemble(proc);
   }
   
 }
@@ -564,43 +593,56 @@ bool BuildMappingMatrixAlgo::runImpl(FieldHandle source, FieldHandle destination
     return (false);  
   }
 
-  size_type n = 0,m = 0,nnz = 0,e; 
+  const size_type m = dfield->num_values();
+  const size_type n = sfield->num_values();
+  const double maxdist = get(Parameters::MaxDistance).toDouble();
+
+  // The cache is keyed on both meshes and on every option that changes
+  // the matrix, a hit skips building the search structures as well
+  const bool use_cache = get(Parameters::UseMappingCache).toBool();
+  const std::string cache_dir = get(Parameters::MappingCacheDirectory).toString();
+  const MappingMatrixCache cache(cache_dir.empty() ? MappingMatrixCache::defaultDirectory() : boost::filesystem::path(cache_dir));
+  std::string cache_key;
+  if (use_cache)
+  {
+    std::ostringstream options;
+    options.precision(17);
+    options << "BuildMappingMatrix|" << method << "|" << maxdist;
+    cache_key = MappingMatrixCache::key(source, destination, options.str());
+
+    SparseRowMatrixHandle cached = cache.load(cache_key);
+    if (cached && cached->nrows() == static_cast<size_t>(m) && cached->ncols() == static_cast<size_t>(n))
+    {
+      remark("Loaded mapping matrix from cache");
+      output = cached;
+      return (true);
+    }
+  }
+
+  size_type e = 1;
 
   if (method == "closestdata")
   {
-    m = dfield->num_values();
-    n = sfield->num_values();
-    nnz = m;
-
     if (sbasis_order == 0) smesh->synchronize(Mesh::FIND_CLOSEST_ELEM_E);
     else smesh->synchronize(Mesh::FIND_CLOSEST_NODE_E);
   } 
   else if(method == "singledestination")
   {
-    m = dfield->num_values();
-    n = sfield->num_values();
-    nnz = n;
-
     if (dbasis_order == 0) dmesh->synchronize(Mesh::FIND_CLOSEST_ELEM_E);
     else dmesh->synchronize(Mesh::FIND_CLOSEST_NODE_E);
   }
   else if (method == "interpolateddata")
   {
-    m = dfield->num_values();
-    n = sfield->num_values();
     if (smesh->num_elems() > 0)
     {
       smesh->synchronize(Mesh::FIND_CLOSEST_ELEM_E);
       VMesh::coords_type cs; cs[0] =0.0; cs[1] = 0.0; cs[2] = 0.0;
       VMesh::ElemInterpolate ei;
       smesh->get_interpolate_weights(cs,0,ei,sbasis_order);
-      if (sbasis_order == 0) 
-      { nnz = m; e = 1; }
-      else if (sbasis_order == 1) 
-      { nnz = m*ei.node_index.size(); e = ei.node_index.size(); }
+      if (sbasis_order == 1) 
+      { e = ei.node_index.size(); }
       else if (sbasis_order == 2) 
-      { nnz = m*(ei.node_index.size() + ei.edge_index.size());
-      e = (ei.node_index.size() + ei.edge_index.size()); }
+      { e = (ei.node_index.size() + ei.edge_index.size()); }
     }
     else
     {
@@ -610,13 +652,8 @@ bool BuildMappingMatrixAlgo::runImpl(FieldHandle source, FieldHandle destination
     }
   }
 
-  LegacySparseDataContainer<double> legacySparseData(m+1, nnz);
-
-  const SparseRowMatrix::RowsPtr& rr = legacySparseData.rows().get();
-  const SparseRowMatrix::ColumnsPtr& cc = legacySparseData.columns().get();
-  const SparseRowMatrix::Storage& vv = legacySparseData.data().get();
-
-  double maxdist = get(Parameters::MaxDistance).toDouble();
+  // Threads fill the arrays of this matrix directly
+  SparseRowMatrixHandle matrix(new SparseRowMatrix(m,n));
 
   const int np = Parallel::NumCores();
   if (method == "closestdata")
@@ -626,14 +663,14 @@ bool BuildMappingMatrixAlgo::runImpl(FieldHandle source, FieldHandle destination
     algo.dfield_ = dfield;
     algo.smesh_ = smesh;
     algo.dmesh_ = dmesh;
-    algo.rr_ = rr;
-    algo.cc_ = cc;
-    algo.vv_ = vv;
+    algo.cc_.assign(m,-1);
+    algo.vv_.assign(m,1.0);
+    algo.matrix_ = matrix.get();
     algo.maxdist_ = maxdist;
     algo.algo_ = this;
 
     auto task_i = [&algo,this](int i) { algo.parallel(i); };
-    Parallel::RunTasks(task_i, Parallel::NumCores());
+    Parallel::RunTasks(task_i, np);
   }
   else if(method == "singledestination")
   {
@@ -642,14 +679,14 @@ bool BuildMappingMatrixAlgo::runImpl(FieldHandle source, FieldHandle destination
     algo.dfield_ = dfield;
     algo.smesh_ = smesh;
     algo.dmesh_ = dmesh;
-    algo.rr_ = rr;
-    algo.cc_ = cc;
-    algo.vv_ = vv;
+    algo.cc_.assign(n,-1);
+    algo.vv_.assign(n,1.0);
+    algo.matrix_ = matrix.get();
     algo.maxdist_ = maxdist;
     algo.algo_ = this;
 
     auto task_i = [&algo,this](int i) { algo.parallel(i); };
-    Parallel::RunTasks(task_i, Parallel::NumCores());
+    Parallel::RunTasks(task_i, np);
   }
   else if (method == "interpolateddata")
   { 
@@ -658,24 +695,23 @@ bool BuildMappingMatrixAlgo::runImpl(FieldHandle source, FieldHandle destination
     algo.dfield_ = dfield;
     algo.smesh_ = smesh;
     algo.dmesh_ = dmesh;
-    algo.rr_ = rr;
-    algo.cc_ = cc;
-    algo.vv_ = vv;
+    algo.cc_.assign(m*e,-1);
+    algo.vv_.assign(m*e,1.0);
     algo.e_ = e;
+    algo.matrix_ = matrix.get();
     algo.maxdist_ = maxdist;
     algo.algo_ = this;
 
     auto task_i = [&algo,this](int i) { algo.parallel(i); };
-    Parallel::RunTasks(task_i, Parallel::NumCores());
+    Parallel::RunTasks(task_i, np);
   }
 
-  output.reset(new SparseRowMatrix(m,n,rr,cc,vv,nnz));
-  if (!output)
+  if (use_cache && !cache.store(cache_key, *matrix))
   {
-    error("Could not create output matrix");
-    return (false);
+    warning("Could not write mapping matrix to cache directory " + cache.directory().string());
   }
 
+  output = matrix;
   return (true);
 }
 
@@ -39,6 +39,12 @@ namespace SCIRun {
     namespace Algorithms {
       namespace Fields {
 
+  ALGORITHM_PARAMETER_DECL(UseMappingCache);
+  ALGORITHM_PARAMETER_DECL(MappingCacheDirectory);
+
+/// Matrices are stored in a MappingMatrixCache when UseMappingCache is on,
+/// which it is not by default; an empty MappingCacheDirectory selects the
+/// per user default location.
 class SCISHARE BuildMappingMatrixAlgo : public AlgorithmBase
 {
   public:
@@ -0,0 +1,339 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Core/Algorithms/Legacy/Fields/Mapping/MappingMatrixCache.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
+#include <Core/Datatypes/Legacy/Field/Field.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/Legacy/Field/FieldInformation.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Algorithms::Fields;
+using namespace SCIRun::Core::Geometry;
+
+namespace
+{
+  /// 128 bit digest built from two independently seeded 64 bit lanes
+  class Digest
+  {
+  public:
+    Digest() : h1_(0x9e3779b97f4a7c15ULL), h2_(0xc2b2ae3d27d4eb4fULL) {}
+
+    void add(std::uint64_t w)
+    {
+      h1_ = (h1_ ^ mix(w)) * 0x100000001b3ULL;
+      h2_ = rotate(h2_ ^ mix(w + 0x632be59bd9b4e019ULL), 29) * 0x9e3779b97f4a7c15ULL;
+    }
+
+    void add(double d)
+    {
+      std::uint64_t w;
+      std::memcpy(&w, &d, sizeof(w));
+      add(w);
+    }
+
+    void add(const Point& p) { add(p.x()); add(p.y()); add(p.z()); }
+
+    void add(const std::string& s)
+    {
+      add(static_cast<std::uint64_t>(s.size()));
+      for (size_t j = 0; j < s.size(); j++) add(static_cast<std::uint64_t>(s[j]));
+    }
+
+    std::string hex() const
+    {
+      static const char digits[] = "0123456789abcdef";
+      std::string result(32, '0');
+      for (int j = 0; j < 16; j++)
+      {
+        result[15-j] = digits[(h1_ >> (4*j)) & 0xf];
+        result[31-j] = digits[(h2_ >> (4*j)) & 0xf];
+      }
+      return result;
+    }
+
+  private:
+    static std::uint64_t rotate(std::uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+    static std::uint64_t mix(std::uint64_t x)
+    {
+      x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+      return x ^ (x >> 31);
+    }
+
+    std::uint64_t h1_, h2_;
+  };
+
+  /// Layout of a cache file: this header followed by the row offsets,
+  /// the column indices and the values of the matrix
+  struct FileHeader
+  {
+    char magic[8];
+    std::uint64_t rows, cols, nnz;
+    std::uint32_t index_size, value_size;
+  };
+
+  const char FILE_MAGIC[8] = { 'S','C','I','M','A','P','0','1' };
+
+  /// Checks the sizes before multiplying them, so a corrupt header cannot
+  /// wrap around to the size of the file
+  bool hasFileSize(const FileHeader& h, size_t size)
+  {
+    const std::uint64_t entry = sizeof(index_type) + sizeof(double);
+    if (size < sizeof(FileHeader) || h.rows >= size || h.nnz >= size)
+      return false;
+    return size - sizeof(FileHeader) == (h.rows + 1)*sizeof(index_type) + h.nnz*entry;
+  }
+
+  /// Entries are only read from and written to directories that no other
+  /// user can write to, otherwise anyone could plant a matrix under a
+  /// predictable key
+  bool isPrivateDirectory(const boost::filesystem::path& directory)
+  {
+#ifndef _WIN32
+    struct stat info;
+    if (::lstat(directory.string().c_str(), &info) != 0)
+      return false;
+    return S_ISDIR(info.st_mode) && info.st_uid == ::getuid() && (info.st_mode & (S_IWGRP | S_IWOTH)) == 0;
+#else
+    boost::system::error_code ec;
+    return boost::filesystem::is_directory(directory, ec);
+#endif
+  }
+}
+
+MappingMatrixCache::MappingMatrixCache(const boost::filesystem::path& directory) :
+  directory_(directory)
+{
+}
+
+boost::filesystem::path MappingMatrixCache::defaultDirectory()
+{
+#ifndef _WIN32
+  return boost::filesystem::temp_directory_path() / ("scirun_mapping_cache-" + std::to_string(::getuid()));
+#else
+  return boost::filesystem::temp_directory_path() / "scirun_mapping_cache";
+#endif
+}
+
+std::string MappingMatrixCache::meshDigest(FieldHandle field)
+{
+  FieldInformation fi(field);
+  VMesh* mesh = field->vmesh();
+  Digest digest;
+  digest.add(fi.get_mesh_type());
+  digest.add(fi.get_mesh_basis_type());
+
+  // Structured meshes do not store their nodes and elements, use the
+  // virtual interface for those
+  const bool unstructured = fi.is_unstructuredmesh();
+
+  const VMesh::size_type num_nodes = mesh->num_nodes();
+  digest.add(static_cast<std::uint64_t>(num_nodes));
+  const Point* points = unstructured ? mesh->get_points_pointer() : 0;
+  if (points)
+  {
+    for (VMesh::index_type idx = 0; idx < num_nodes; idx++) digest.add(points[idx]);
+  }
+  else
+  {
+    Point p;
+    for (VMesh::Node::index_type idx = 0; idx < num_nodes; idx++)
+    {
+      mesh->get_center(p, idx);
+      digest.add(p);
+    }
+  }
+
+  const VMesh::size_type num_elems = mesh->num_elems();
+  digest.add(static_cast<std::uint64_t>(num_elems));
+  const VMesh::index_type* elems = unstructured ? mesh->get_elems_pointer() : 0;
+  if (elems)
+  {
+    const VMesh::size_type size = num_elems*mesh->num_nodes_per_elem();
+    for (VMesh::index_type idx = 0; idx < size; idx++)
+      digest.add(static_cast<std::uint64_t>(elems[idx]));
+  }
+  else
+  {
+    VMesh::Node::array_type nodes;
+    for (VMesh::Elem::index_type idx = 0; idx < num_elems; idx++)
+    {
+      mesh->get_nodes(nodes, idx);
+      for (size_t j = 0; j < nodes.size(); j++) digest.add(static_cast<std::uint64_t>(nodes[j]));
+    }
+  }
+
+  return digest.hex();
+}
+
+std::string MappingMatrixCache::key(FieldHandle source, FieldHandle destination, const std::string& options)
+{
+  FieldInformation sfi(source);
+  FieldInformation dfi(destination);
+
+  Digest digest;
+  digest.add(meshDigest(source));
+  digest.add(sfi.get_basis_type());
+  digest.add(meshDigest(destination));
+  digest.add(dfi.get_basis_type());
+  digest.add(options);
+  return digest.hex();
+}
+
+boost::filesystem::path MappingMatrixCache::file(const std::string& key) const
+{
+  return directory_ / (key + ".map");
+}
+
+SparseRowMatrixHandle MappingMatrixCache::load(const std::string& key) const
+{
+  using namespace boost::interprocess;
+
+  const boost::filesystem::path path = file(key);
+  boost::system::error_code ec;
+  if (!isPrivateDirectory(directory_) || !boost::filesystem::is_regular_file(boost::filesystem::symlink_status(path, ec)))
+    return SparseRowMatrixHandle();
+
+  try
+  {
+    file_mapping mapping(path.string().c_str(), read_only);
+    mapped_region region(mapping, read_only);
+
+    const char* data = static_cast<const char*>(region.get_address());
+    FileHeader header;
+    if (region.get_size() < sizeof(header))
+      return SparseRowMatrixHandle();
+    std::memcpy(&header, data, sizeof(header));
+
+    if (std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0 ||
+        header.index_size != sizeof(index_type) || header.value_size != sizeof(double) ||
+        !hasFileSize(header, region.get_size()) ||
+        header.cols > static_cast<std::uint64_t>(std::numeric_limits<index_type>::max()))
+      return SparseRowMatrixHandle();
+
+    // Eigen trusts the CSR arrays, so check that every row range and
+    // column index is in bounds before copying them into a matrix
+    const index_type* rows = reinterpret_cast<const index_type*>(data + sizeof(header));
+    const index_type* columns = rows + header.rows + 1;
+    const char* values = reinterpret_cast<const char*>(columns + header.nnz);
+    if (rows[0] != 0 || rows[header.rows] != static_cast<index_type>(header.nnz))
+      return SparseRowMatrixHandle();
+    for (std::uint64_t r = 0; r < header.rows; r++)
+    {
+      if (rows[r+1] < rows[r])
+        return SparseRowMatrixHandle();
+    }
+    const index_type ncols = static_cast<index_type>(header.cols);
+    for (std::uint64_t k = 0; k < header.nnz; k++)
+    {
+      if (columns[k] < 0 || columns[k] >= ncols)
+        return SparseRowMatrixHandle();
+    }
+
+    SparseRowMatrixHandle matrix(new SparseRowMatrix(header.rows, header.cols));
+    matrix->resizeNonZeros(header.nnz);
+    std::memcpy(matrix->outerIndexPtr(), rows, (header.rows + 1)*sizeof(index_type));
+    std::memcpy(matrix->innerIndexPtr(), columns, header.nnz*sizeof(index_type));
+    std::memcpy(matrix->valuePtr(), values, header.nnz*sizeof(double));
+    return matrix;
+  }
+  catch (interprocess_exception&)
+  {
+    return SparseRowMatrixHandle();
+  }
+}
+
+bool MappingMatrixCache::store(const std::string& key, const SparseRowMatrix& matrix) const
+{
+  if (!matrix.isCompressed())
+    return false;
+
+  boost::system::error_code ec;
+  if (!boost::filesystem::exists(directory_, ec))
+  {
+    boost::filesystem::create_directories(directory_, ec);
+    if (ec)
+      return false;
+    boost::filesystem::permissions(directory_, boost::filesystem::owner_all, ec);
+    if (ec)
+      return false;
+  }
+  if (!isPrivateDirectory(directory_))
+    return false;
+
+  FileHeader header;
+  std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+  header.rows = matrix.nrows();
+  header.cols = matrix.ncols();
+  header.nnz = matrix.nonZeros();
+  header.index_size = sizeof(index_type);
+  header.value_size = sizeof(double);
+
+  // Write under a unique name and rename, so other processes never map a
+  // partially written entry
+  const boost::filesystem::path path = file(key);
+  const boost::filesystem::path tmp = directory_ / boost::filesystem::unique_path(key + "-%%%%-%%%%.tmp");
+  {
+    std::ofstream out(tmp.string().c_str(), std::ios::binary);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(matrix.outerIndexPtr()), (header.rows + 1)*sizeof(index_type));
+    out.write(reinterpret_cast<const char*>(matrix.innerIndexPtr()), header.nnz*sizeof(index_type));
+    out.write(reinterpret_cast<const char*>(matrix.valuePtr()), header.nnz*sizeof(double));
+    if (!out)
+    {
+      out.close();
+      boost::filesystem::remove(tmp, ec);
+      return false;
+    }
+  }
+
+  boost::filesystem::rename(tmp, path, ec);
+  if (ec)
+  {
+    boost::filesystem::remove(tmp, ec);
+    return false;
+  }
+  return true;
+}
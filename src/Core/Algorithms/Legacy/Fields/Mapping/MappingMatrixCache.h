@@ -0,0 +1,81 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef CORE_ALGORTIHMS_FIELDS_MAPPING_MAPPINGMATRIXCACHE_H
+#define CORE_ALGORTIHMS_FIELDS_MAPPING_MAPPINGMATRIXCACHE_H 1
+
+#include <Core/Datatypes/MatrixFwd.h>
+#include <Core/Datatypes/Legacy/Field/FieldFwd.h>
+#include <boost/filesystem/path.hpp>
+#include <Core/Algorithms/Legacy/Fields/share.h>
+
+namespace SCIRun {
+  namespace Core {
+    namespace Algorithms {
+      namespace Fields {
+
+/// On-disk store of mapping matrices. Entries are keyed by a digest of the
+/// geometry and connectivity of both meshes and of the options used to
+/// build the matrix, so a changed mesh never returns a stale entry. Each
+/// entry is one file holding the raw CSR arrays, which is memory mapped
+/// when the matrix is loaded and fully validated before it is used.
+///
+/// The directory is created with owner only permissions. Entries are
+/// neither loaded from nor stored in a directory that is not owned by the
+/// current user or that group or others can write to.
+class SCISHARE MappingMatrixCache
+{
+  public:
+    explicit MappingMatrixCache(const boost::filesystem::path& directory);
+
+    /// Per user location under the system temporary directory
+    static boost::filesystem::path defaultDirectory();
+
+    /// Hex digest of the type, node positions and element connectivity of
+    /// the mesh of a field
+    static std::string meshDigest(FieldHandle field);
+
+    /// Cache key for the mapping between two fields; options should list
+    /// everything else that changes the matrix.
+    static std::string key(FieldHandle source, FieldHandle destination, const std::string& options);
+
+    /// Returns an empty handle when there is no valid entry for the key.
+    Datatypes::SparseRowMatrixHandle load(const std::string& key) const;
+    bool store(const std::string& key, const Datatypes::SparseRowMatrix& matrix) const;
+
+    const boost::filesystem::path& directory() const { return directory_; }
+
+  private:
+    boost::filesystem::path file(const std::string& key) const;
+
+    boost::filesystem::path directory_;
+};
+
+}}}}
+
+#endif
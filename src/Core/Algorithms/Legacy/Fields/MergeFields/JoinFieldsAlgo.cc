@@ -37,8 +37,12 @@
 #include <Core/Datatypes/DenseMatrix.h>
 #include <Core/Datatypes/PropertyManagerExtensions.h>
 #include <Core/Datatypes/Legacy/Field/FieldInformation.h>
-#include <Core/GeometryPrimitives/SearchGridT.h>
-#include <boost/scoped_ptr.hpp>
+#include <Core/Thread/ConcurrentUnionFind.h>
+#include <Core/Thread/Parallel.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
 
 using namespace SCIRun;
 using namespace SCIRun::Core::Datatypes;
@@ -46,6 +50,7 @@ using namespace SCIRun::Core::Algorithms::Fields;
 using namespace SCIRun::Core::Geometry;
 using namespace SCIRun::Core::Utility;
 using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Thread;
 
 AlgorithmParameterName JoinFieldsAlgo::MergeNodes("merge_nodes");
 AlgorithmParameterName JoinFieldsAlgo::MergeElems("merge_elems");
@@ -53,6 +58,53 @@ AlgorithmParameterName JoinFieldsAlgo::Tolerance("tolerance");
 AlgorithmParameterName JoinFieldsAlgo::MatchNodeValues("match_node_values");
 AlgorithmParameterName JoinFieldsAlgo::MakeNoData("make_no_data");
 
+namespace {
+
+/// Run body(proc,start,end) on nproc consecutive ranges of [0,n)
+template <class Body>
+void parallel_range(index_type n, int nproc, Body body)
+{
+  Parallel::RunTasks([&](int proc)
+  {
+    const index_type start = (n/nproc)*proc;
+    const index_type end = (proc == nproc-1) ? n : (n/nproc)*(proc+1);
+    body(proc, start, end);
+  }, nproc);
+}
+
+void atomic_min(std::atomic<index_type>& value, index_type v)
+{
+  index_type current = value.load(std::memory_order_relaxed);
+  while (v < current && !value.compare_exchange_weak(current, v, std::memory_order_relaxed)) {}
+}
+
+/// Sort the range of each thread, then merge neighboring ranges pairwise
+template <class Iterator, class Compare>
+void parallel_sort(Iterator begin, Iterator end, int nproc, Compare comp)
+{
+  const index_type n = end - begin;
+  std::vector<index_type> bounds(nproc+1, n);
+  for (int proc = 0; proc < nproc; proc++) bounds[proc] = (n/nproc)*proc;
+
+  Parallel::RunTasks([&](int proc)
+  {
+    std::sort(begin+bounds[proc], begin+bounds[proc+1], comp);
+  }, nproc);
+
+  for (int width = 1; width < nproc; width *= 2)
+  {
+    Parallel::RunTasks([&](int m)
+    {
+      const int lo = 2*width*m;
+      const int mid = std::min(lo+width, nproc);
+      const int hi = std::min(lo+2*width, nproc);
+      std::inplace_merge(begin+bounds[lo], begin+bounds[mid], begin+bounds[hi], comp);
+    }, (nproc+2*width-1)/(2*width));
+  }
+}
+
+}
+
 JoinFieldsAlgo::JoinFieldsAlgo()
 {
   /// Merge duplicate nodes?
@@ -168,31 +220,39 @@ JoinFieldsAlgo::runImpl(const FieldList& input, FieldHandle& output) const
     }
   }
   
-  BBox box;
-  boost::scoped_ptr<SearchGridT<index_type> > node_grid;
-  boost::scoped_ptr<SearchGridT<index_type> > elem_grid;
-
-  size_type ni = 0, nj = 0, nk = 0;    
-        
-  size_type tot_num_nodes = 0;
-  size_type tot_num_elems = 0;
-  
   if (merge_elems) merge_nodes = true;
-  
-  // Compute bounding box and number of nodes
-  // and elements
+
   for (size_t p = 0; p < inputs.size(); p++)
+  {
+    if (inputs[p]->vmesh()->is_pointcloudmesh())
+    {
+      merge_elems = false;
+    }
+  }
+
+  // Every node of every input is a candidate node of the output mesh, the
+  // element corners of all inputs form one list of slots pointing to them
+  const size_t num_inputs = inputs.size();
+  std::vector<size_type> node_offset(num_inputs+1, 0);
+  std::vector<size_type> elem_offset(num_inputs+1, 0);
+  std::vector<size_type> slot_offset(num_inputs+1, 0);
+
+  BBox box;
+  for (size_t p = 0; p < num_inputs; p++)
   {
     VMesh* imesh = inputs[p]->vmesh();
     if (merge_nodes)
     {
       box.extend(imesh->get_bounding_box());
     }
-    tot_num_nodes += imesh->num_nodes();
-    tot_num_elems += imesh->num_elems();
+    node_offset[p+1] = node_offset[p] + imesh->num_nodes();
+    elem_offset[p+1] = elem_offset[p] + imesh->num_elems();
+    slot_offset[p+1] = slot_offset[p] + imesh->num_elems()*imesh->num_nodes_per_elem();
   }
 
-//  if (merge_elems) merge_nodes = true;
+  const size_type tot_num_nodes = node_offset[num_inputs];
+  const size_type tot_num_elems = elem_offset[num_inputs];
+  const size_type tot_num_slots = slot_offset[num_inputs];
 
   // Add an epsilon so all nodes will be inside
   if (merge_nodes)
@@ -200,48 +260,236 @@ JoinFieldsAlgo::runImpl(const FieldList& input, FieldHandle& output) const
     if (!box.valid())
       THROW_ALGORITHM_PROCESSING_ERROR("Merging nodes will fail: BBox is empty or invalid, diagonal not provided.");
     box.extend(1e-5*box.diagonal().length()); 
+  }
+
+  const int nproc = (tot_num_slots < 10000) ? 1 : static_cast<int>(Parallel::NumCores());
+
+  // Gather the connectivity and record for each candidate the first slot
+  // that uses it. Nodes that are not used by any element are dropped.
+  std::vector<index_type> conn(tot_num_slots);
+  std::unique_ptr<std::atomic<index_type>[]> first_slot(new std::atomic<index_type>[tot_num_nodes]);
+  parallel_range(tot_num_nodes, nproc, [&](int, index_type start, index_type end)
+  {
+    for (index_type c = start; c < end; c++) first_slot[c].store(tot_num_slots, std::memory_order_relaxed);
+  });
 
-    const size_type s =  3*static_cast<size_type>
-      ((ceil(pow(static_cast<double>(tot_num_nodes) , (1.0/3.0))))/2.0 + 1.0);
-
-    Vector diag  = box.diagonal();
-    double trace = (diag.x()+diag.y()+diag.z());
-    size_type sx = static_cast<size_type>(ceil(diag.x()/trace*s));
-    size_type sy = static_cast<size_type>(ceil(diag.y()/trace*s));
-    size_type sz = static_cast<size_type>(ceil(diag.z()/trace*s));
-    
-    node_grid.reset(new SearchGridT<index_type>(sx, sy, sz, box.get_min(), box.get_max()));
-
-    if (sx == 0) sx = 1;
-    if (sy == 0) sy = 1;
-    if (sz == 0) sz = 1;
-    
-    ni = node_grid->get_ni()-1;
-    nj = node_grid->get_nj()-1;
-    nk = node_grid->get_nk()-1;    
+  for (size_t p = 0; p < num_inputs; p++)
+  {
+    VMesh* imesh = inputs[p]->vmesh();
+    const size_type npe = imesh->num_nodes_per_elem();
+    parallel_range(imesh->num_elems(), nproc, [&](int, index_type start, index_type end)
+    {
+      VMesh::Node::array_type nodes;
+      for (index_type idx = start; idx < end; idx++)
+      {
+        imesh->get_nodes(nodes,VMesh::Elem::index_type(idx));
+        index_type slot = slot_offset[p] + idx*npe;
+        for (size_t q = 0; q < nodes.size(); q++, slot++)
+        {
+          const index_type c = node_offset[p] + nodes[q];
+          conn[slot] = c;
+          atomic_min(first_slot[c], slot);
+        }
+      }
+    });
+  }
+
+  auto is_used = [&](index_type c) { return first_slot[c].load(std::memory_order_relaxed) < tot_num_slots; };
+
+  std::vector<Point> points(tot_num_nodes);
+  std::vector<int> values;
+  if (match_node_values) values.resize(tot_num_nodes);
+
+  for (size_t p = 0; p < num_inputs; p++)
+  {
+    VMesh* imesh = inputs[p]->vmesh();
+    VField* ifield = inputs[p]->vfield();
+    parallel_range(imesh->num_nodes(), nproc, [&](int, index_type start, index_type end)
+    {
+      for (index_type idx = start; idx < end; idx++)
+      {
+        const index_type c = node_offset[p] + idx;
+        if (!is_used(c)) continue;
+        imesh->get_center(points[c],VMesh::Node::index_type(idx));
+        if (match_node_values) ifield->get_value(values[c],VMesh::Node::index_type(idx));
+      }
+    });
+  }
+  update_progress_max(1, 4);
+
+  // Candidates closer than the tolerance fall in the same merge class.
+  // Points are hashed into cells as large as the tolerance, so only the 27
+  // cells around a point need to be searched. Each hash bucket is a list
+  // that the threads prepend to atomically.
+  ConcurrentUnionFind<index_type> classes(tot_num_nodes);
+  if (merge_nodes && tol > 0.0)
+  {
+    const Point origin = box.get_min();
+    const double cell = std::max(tol, 1e-12*box.diagonal().length());
+    size_t num_buckets = 1;
+    while (num_buckets < 2*static_cast<size_t>(tot_num_nodes)) num_buckets <<= 1;
+    const size_t mask = num_buckets - 1;
+
+    auto bucket = [&](const Point& point, index_type di, index_type dj, index_type dk) -> size_t
+    {
+      const size_t i = static_cast<size_t>(static_cast<index_type>(floor((point.x()-origin.x())/cell)) + di);
+      const size_t j = static_cast<size_t>(static_cast<index_type>(floor((point.y()-origin.y())/cell)) + dj);
+      const size_t k = static_cast<size_t>(static_cast<index_type>(floor((point.z()-origin.z())/cell)) + dk);
+      return ((i*73856093) ^ (j*19349663) ^ (k*83492791)) & mask;
+    };
+
+    std::unique_ptr<std::atomic<index_type>[]> heads(new std::atomic<index_type>[num_buckets]);
+    for (size_t b = 0; b < num_buckets; b++) heads[b].store(-1, std::memory_order_relaxed);
+    std::vector<index_type> next(tot_num_nodes, -1);
+
+    parallel_range(tot_num_nodes, nproc, [&](int, index_type start, index_type end)
+    {
+      for (index_type c = start; c < end; c++)
+      {
+        if (is_used(c)) next[c] = heads[bucket(points[c],0,0,0)].exchange(c);
+      }
+    });
+
+    parallel_range(tot_num_nodes, nproc, [&](int, index_type start, index_type end)
+    {
+      for (index_type c = start; c < end; c++)
+      {
+        if (!is_used(c)) continue;
+        for (index_type di = -1; di <= 1; di++)
+          for (index_type dj = -1; dj <= 1; dj++)
+            for (index_type dk = -1; dk <= 1; dk++)
+            {
+              index_type o = heads[bucket(points[c],di,dj,dk)].load(std::memory_order_relaxed);
+              for (; o >= 0; o = next[o])
+              {
+                if (o >= c) continue;
+                if (match_node_values && values[o] != values[c]) continue;
+                if ((points[c]-points[o]).length2() < tol2) classes.unite(c,o);
+              }
+            }
+      }
+    });
   }
+  update_progress_max(2, 4);
 
+  // The first slot using a class creates its output node, which keeps the
+  // nodes in the order in which the elements of the inputs use them
+  std::unique_ptr<std::atomic<index_type>[]> class_first(new std::atomic<index_type>[tot_num_nodes]);
+  parallel_range(tot_num_nodes, nproc, [&](int, index_type start, index_type end)
+  {
+    for (index_type c = start; c < end; c++) class_first[c].store(tot_num_slots, std::memory_order_relaxed);
+  });
+
+  parallel_range(tot_num_nodes, nproc, [&](int, index_type start, index_type end)
+  {
+    for (index_type c = start; c < end; c++)
+    {
+      if (is_used(c)) atomic_min(class_first[classes.find(c)], first_slot[c].load(std::memory_order_relaxed));
+    }
+  });
+
+  auto opens_node = [&](index_type s)
+  {
+    return class_first[classes.find(conn[s])].load(std::memory_order_relaxed) == s;
+  };
+
+  std::vector<size_type> count(nproc+1, 0);
+  parallel_range(tot_num_slots, nproc, [&](int proc, index_type start, index_type end)
+  {
+    for (index_type s = start; s < end; s++) if (opens_node(s)) count[proc+1]++;
+  });
+  for (int proc = 0; proc < nproc; proc++) count[proc+1] += count[proc];
+
+  std::vector<index_type> out_nodes(count[nproc]);
+  std::vector<index_type> class_node(tot_num_nodes, -1);
+  parallel_range(tot_num_slots, nproc, [&](int proc, index_type start, index_type end)
+  {
+    index_type n = count[proc];
+    for (index_type s = start; s < end; s++)
+    {
+      if (!opens_node(s)) continue;
+      class_node[classes.find(conn[s])] = n;
+      out_nodes[n++] = conn[s];
+    }
+  });
+  class_first.reset();
+
+  std::vector<index_type> node_index(tot_num_nodes, -1);
+  parallel_range(tot_num_nodes, nproc, [&](int, index_type start, index_type end)
+  {
+    for (index_type c = start; c < end; c++)
+    {
+      if (is_used(c)) node_index[c] = class_node[classes.find(c)];
+    }
+  });
+
+  parallel_range(tot_num_slots, nproc, [&](int, index_type start, index_type end)
+  {
+    for (index_type s = start; s < end; s++) conn[s] = node_index[conn[s]];
+  });
+
+  // Duplicate elements have the same sorted node tuple. Sorting the
+  // elements by tuple puts duplicates next to each other, the one that
+  // comes first in the inputs is kept.
+  std::vector<index_type> elem_index(tot_num_elems);
+  size_type num_out_elems = tot_num_elems;
   if (merge_elems)
   {
-    const size_type s =  3*static_cast<size_type>
-      ((ceil(pow(static_cast<double>(tot_num_nodes) , (1.0/3.0))))/2.0 + 1.0);
-
-    Vector diag  = box.diagonal();
-    double trace = (diag.x()+diag.y()+diag.z());
-    size_type sx = static_cast<size_type>(ceil(diag.x()/trace*s));
-    size_type sy = static_cast<size_type>(ceil(diag.y()/trace*s));
-    size_type sz = static_cast<size_type>(ceil(diag.z()/trace*s));
-    
-    if (sx == 0) sx = 1;
-    if (sy == 0) sy = 1;
-    if (sz == 0) sz = 1;
-    
-    elem_grid.reset(new SearchGridT<index_type>(sx, sy, sz, box.get_min(), box.get_max()));
-    
-    ni = node_grid->get_ni()-1;
-    nj = node_grid->get_nj()-1;
-    nk = node_grid->get_nk()-1;    
+    std::vector<index_type> canon(conn);
+    std::vector<index_type> order(tot_num_elems);
+    auto elem_slots = [&](index_type e, index_type& begin, index_type& end)
+    {
+      const size_t p = std::upper_bound(elem_offset.begin(), elem_offset.end(), e) - elem_offset.begin() - 1;
+      const size_type npe = (slot_offset[p+1]-slot_offset[p])/(elem_offset[p+1]-elem_offset[p]);
+      begin = slot_offset[p] + (e-elem_offset[p])*npe;
+      end = begin + npe;
+    };
+
+    parallel_range(tot_num_elems, nproc, [&](int, index_type start, index_type end)
+    {
+      index_type b, e;
+      for (index_type idx = start; idx < end; idx++)
+      {
+        order[idx] = idx;
+        elem_slots(idx, b, e);
+        std::sort(canon.begin()+b, canon.begin()+e);
+      }
+    });
+
+    auto compare_tuples = [&](index_type e1, index_type e2) -> int
+    {
+      index_type b1, x1, b2, x2;
+      elem_slots(e1, b1, x1);
+      elem_slots(e2, b2, x2);
+      for (; b1 < x1 && b2 < x2; b1++, b2++)
+      {
+        if (canon[b1] != canon[b2]) return (canon[b1] < canon[b2]) ? -1 : 1;
+      }
+      return (x1-b1) < (x2-b2) ? -1 : ((x1-b1) > (x2-b2) ? 1 : 0);
+    };
+
+    parallel_sort(order.begin(), order.end(), nproc, [&](index_type e1, index_type e2)
+    {
+      const int c = compare_tuples(e1, e2);
+      return (c < 0 || (c == 0 && e1 < e2));
+    });
+
+    std::vector<char> keep(tot_num_elems);
+    parallel_range(tot_num_elems, nproc, [&](int, index_type start, index_type end)
+    {
+      for (index_type r = start; r < end; r++)
+        keep[order[r]] = (r == 0 || compare_tuples(order[r-1], order[r]) != 0);
+    });
+
+    index_type n = 0;
+    for (index_type e = 0; e < tot_num_elems; e++) elem_index[e] = keep[e] ? n++ : -1;
+    num_out_elems = n;
+  }
+  else
+  {
+    for (index_type e = 0; e < tot_num_elems; e++) elem_index[e] = e;
   }
+  update_progress_max(3, 4);
 
   MeshHandle mesh = CreateMesh(first);
   if (!mesh)
@@ -260,249 +508,35 @@ JoinFieldsAlgo::runImpl(const FieldList& input, FieldHandle& output) const
   VMesh* omesh = output->vmesh();
   VField* ofield = output->vfield();
   
-  omesh->node_reserve(tot_num_nodes);
-  omesh->elem_reserve(tot_num_elems);
-
-  size_type nodes_offset = 0;      
-  size_type elems_offset = 0;  
-  size_type nodes_count = 0;      
-  size_type elems_count = 0;  
+  omesh->node_reserve(out_nodes.size());
+  omesh->elem_reserve(num_out_elems);
 
-  Point P;
-  std::vector<int> values;
-  int curval;
-  if (match_node_values) values.resize(tot_num_nodes);
+  for (size_t n = 0; n < out_nodes.size(); n++)
+  {
+    omesh->add_point(points[out_nodes[n]]);
+  }
 
-  for (size_t p = 0; p < inputs.size(); p++)
+  VMesh::Node::array_type newnodes;
+  for (size_t p = 0; p < num_inputs; p++)
   {
-    if (inputs[p]->vmesh()->is_pointcloudmesh())
+    const size_type num_elems = elem_offset[p+1] - elem_offset[p];
+    if (num_elems == 0) continue;
+    newnodes.resize((slot_offset[p+1] - slot_offset[p])/num_elems);
+    for (index_type idx = 0; idx < num_elems; idx++)
     {
-      merge_elems = false;
+      if (elem_index[elem_offset[p]+idx] < 0) continue;
+      const index_type slot = slot_offset[p] + idx*newnodes.size();
+      for (size_t q = 0; q < newnodes.size(); q++) newnodes[q] = conn[slot+q];
+      omesh->add_elem(newnodes);
     }
   }
 
-  for (size_t p = 0; p < inputs.size(); p++)
+  for (size_t p = 0; p < num_inputs; p++)
   {
-    elems_count = 0;
-    nodes_count = 0;
-    
-    VMesh* imesh = inputs[p]->vmesh();
     VField* ifield = inputs[p]->vfield();
-    
-    VMesh::Node::array_type nodes, newnodes, nodes2;
-    std::vector<index_type> newnodes_sorted;
-
-    size_type num_elems = imesh->num_elems();
-    size_type num_nodes = imesh->num_nodes();
-    std::vector<VMesh::Node::index_type> local_to_global(num_nodes,-1);
-    std::vector<VMesh::Elem::index_type> local_to_global_elem;
-    
-    if (merge_elems)
-    {
-      local_to_global_elem.resize(num_elems,-1);
-    }
-    
-    for (VMesh::Elem::index_type idx=0; idx<num_elems;idx++)
-    {
-      imesh->get_nodes(nodes,idx);
-      
-      newnodes.resize(nodes.size());
-      for(size_t q=0; q< nodes.size(); q++)
-      {
-        VMesh::Node::index_type nodeq = nodes[q];
-
-        ASSERT(nodeq<local_to_global.size())
-        ASSERT(q<newnodes.size())
-
-        if (local_to_global[nodeq] >= 0)
-        {
-          newnodes[q] = local_to_global[nodeq];
-        }
-        else
-        {
-          if (merge_nodes)
-          {
-            imesh->get_center(P,nodeq);
-
-            if (match_node_values) ifield->get_value(curval,nodeq);
-             
-            // Convert to grid coordinates.
-            index_type bi, bj, bk, ei, ej, ek;
-            node_grid->unsafe_locate(bi, bj, bk, P);
+    size_type num_elems = elem_offset[p+1] - elem_offset[p];
+    size_type num_nodes = node_offset[p+1] - node_offset[p];
 
-            // Clamp to closest point on the grid.
-            if (bi > ni) bi = ni;
-            if (bi < 0) bi = 0;
-
-            if (bj > nj) bj = nj;
-            if (bj < 0) bj = 0;
-
-            if (bk > nk) bk = nk;
-            if (bk < 0) bk = 0;
-
-            ei = bi; ej = bj; ek = bk;          
-
-            index_type cidx = -1;
-            double dmin = tol2;
-            bool found = true;
-            
-            do 
-            {
-              found = true; 
-              for (index_type i = bi; i <= ei; i++)
-              {
-                if (i < 0 || i > ni) continue;
-                for (index_type j = bj; j <= ej; j++)
-                {
-                if (j < 0 || j > nj) continue;
-                  for (index_type k = bk; k <= ek; k++)
-                  {
-                    if (k < 0 || k > nk) continue;
-                    if (i == bi || i == ei || j == bj || j == ej || k == bk || k == ek)
-                    {
-                      if (node_grid->min_distance_squared(P, i, j, k) < dmin)
-                      {
-                        found = false;
-                        SearchGridT<index_type>::iterator it, eit;
-                        node_grid->lookup_ijk(it, eit, i, j, k);
-
-                        if (match_node_values) 
-                        {
-                          while (it != eit)
-                          {
-                            if (values[*it] == curval)
-                            {
-                              Point point;
-                              omesh->get_center(point,VMesh::Node::index_type(*it));
-                              const double dist  = (P-point).length2();
-
-                              if (dist < dmin) 
-                              { 
-                                cidx = *it; 
-                                dmin = dist; 
-                              }
-                            }
-                            ++it;
-                          }                        
-                        }
-                        else
-                        {
-                          while (it != eit)
-                          {
-                            Point point;
-                            omesh->get_center(point,VMesh::Node::index_type(*it));
-                            const double dist  = (P-point).length2();
-
-                            if (dist < dmin) 
-                            { 
-                              cidx = *it; 
-                              dmin = dist; 
-                            }
-                            ++it;
-                          }
-                        }
-                      }
-                    }
-                  }
-                }
-              }
-              bi--;ei++;
-              bj--;ej++;
-              bk--;ek++;
-            } 
-            while (!found);
-
-            if (cidx >= 0)
-            {
-              newnodes[q] = cidx;
-              local_to_global[nodeq] = cidx;
-            }
-            else
-            {
-              index_type nidx = omesh->add_point(P);
-              nodes_count++;
-              newnodes[q] = nidx;
-              local_to_global[nodeq] = nidx;
-              node_grid->insert(nidx,P);
-              if (match_node_values)
-              {
-                values[nidx] = curval;
-              }
-            }
-          }
-          else
-          {
-            Point P;
-            imesh->get_center(P,nodeq);
-          
-            index_type nidx = omesh->add_point(P); 
-            nodes_count++;
-            newnodes[q] = nidx;
-            local_to_global[nodeq] = nidx;
-          }
-        }
-      }
-      
-      if (merge_elems)
-      {
-        newnodes_sorted.resize(newnodes.size());
-        for (size_t r=0; r<newnodes.size();r++)
-        {
-          newnodes_sorted[r] = newnodes[r];
-        }
-        std::sort(newnodes_sorted.begin(),newnodes_sorted.end());
-        
-        Point p(0.0,0.0,0.0);
-        for (size_t r=0; r< newnodes_sorted.size(); r++)
-        {
-          Point q;
-          omesh->get_center(q,VMesh::Node::index_type(newnodes_sorted[r]));
-          p = (p + q).asPoint();
-        }
-        p = p*(1.0/newnodes_sorted.size());
-        
-        // Convert to grid coordinates.
-        index_type i, j, k;
-        elem_grid->unsafe_locate(i, j, k, p);
-
-        SearchGridT<index_type>::iterator it, eit;
-        elem_grid->lookup_ijk(it, eit, i, j, k);
-
-        bool found = false;
-        VMesh::Elem::index_type oelem = -1;
-        while (it != eit)
-        {
-          omesh->get_nodes(nodes2,VMesh::Elem::index_type(*it));
-          std::sort(nodes2.begin(),nodes2.end());
-          
-          // compare
-          
-          bool similar = true;
-          for (size_t h=0;h<nodes2.size();h++)
-          {
-            if (nodes2[h] != newnodes_sorted[h]) { similar = false; break;}
-          }
-          
-          if (similar) { found = true; oelem = VMesh::Elem::index_type(*it); break; }
-          ++it;
-        }  
-      
-        if (!found)
-        {
-          oelem = omesh->add_elem(newnodes);          
-          elem_grid->insert(oelem,p);
-          elems_count++;
-          local_to_global_elem[idx] = oelem;
-        }
-        
-      }
-      else
-      {
-        omesh->add_elem(newnodes);          
-        elems_count++;
-      }
-    }
- 
     if (ifield->num_values() > 0)
     {
       if (ofield->basis_order() == 0 && ifield->basis_order() == 0)
@@ -512,15 +546,15 @@ JoinFieldsAlgo::runImpl(const FieldList& input, FieldHandle& output) const
         {
           for (VMesh::Elem::index_type j=0;j<num_elems;j++)
           {
-            if (local_to_global_elem[j] >= 0)
+            if (elem_index[elem_offset[p]+j] >= 0)
             {
-              ofield->copy_value(ifield,j,local_to_global_elem[j]);
+              ofield->copy_value(ifield,j,elem_index[elem_offset[p]+j]);
             }
           }      
         }
         else
         {
-          ofield->copy_values(ifield,0,elems_offset,num_elems);
+          ofield->copy_values(ifield,0,elem_offset[p],num_elems);
         }
       }
       else if (ofield->basis_order() == 1 && ifield->basis_order() == 1)
@@ -528,20 +562,15 @@ JoinFieldsAlgo::runImpl(const FieldList& input, FieldHandle& output) const
         ofield->resize_values();
         for (VMesh::Node::index_type j=0;j<num_nodes;j++)
         {
-          if (local_to_global[j] >= 0)
+          if (node_index[node_offset[p]+j] >= 0)
           {
-            ofield->copy_value(ifield,j,local_to_global[j]);
+            ofield->copy_value(ifield,j,node_index[node_offset[p]+j]);
           }
         }
       }
     }
-    
-    elems_offset += elems_count;
-    nodes_offset += nodes_count;
-    
-    update_progress_max(p+1, inputs.size());
   }
-  
+  update_progress_max(4, 4);
 
   return (true);
 }
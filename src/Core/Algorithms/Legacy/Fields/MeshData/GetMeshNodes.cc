@@ -65,7 +65,7 @@ bool GetMeshNodesAlgo::run(FieldHandle& input, DenseMatrixHandle& output) const
   FieldInformation fi(input);
 
   /// @todo: refactor duplication
-  if (fi.is_regularmesh())
+  if (fi.is_regularmesh() || vmesh->get_points_pointer() == 0)
   {
     Point p;
     int cnt = 0;
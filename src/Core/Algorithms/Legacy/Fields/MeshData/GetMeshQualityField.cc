@@ -26,75 +26,381 @@
    DEALINGS IN THE SOFTWARE.
 */
 
-#include <Core/Algorithms/Fields/MeshData/GetMeshQualityField.h>
-#include <Core/Datatypes/Field.h>
-#include <Core/Datatypes/FieldInformation.h>
+#include <Core/Algorithms/Legacy/Fields/MeshData/GetMeshQualityField.h>
+#include <Core/Algorithms/Base/AlgorithmVariableNames.h>
+#include <Core/Algorithms/Base/AlgorithmPreconditions.h>
+#include <Core/Datatypes/Legacy/Field/Field.h>
+#include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/Legacy/Field/FieldInformation.h>
+#include <Core/Datatypes/DenseMatrix.h>
+#include <Core/Datatypes/String.h>
+#include <Core/Thread/Parallel.h>
 
-namespace SCIRunAlgo {
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Algorithms::Fields;
+using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Thread;
+
+ALGORITHM_PARAMETER_DEF(Fields, QualityMetric);
+ALGORITHM_PARAMETER_DEF(Fields, NumHistogramBins);
+
+GetMeshQualityFieldAlgo::GetMeshQualityFieldAlgo()
+{
+  add_option(Parameters::QualityMetric,"scaled_jacobian","scaled_jacobian|jacobian|volume|insc_circ_ratio");
+  addParameter(Parameters::NumHistogramBins,20);
+}
+
+namespace {
+
+enum { SCALED_JACOBIAN = 0, JACOBIAN, VOLUME, INSC_CIRC_RATIO, NUM_METRICS };
+
+const char* metric_names[NUM_METRICS] =
+  { "scaled_jacobian", "jacobian", "volume", "insc_circ_ratio" };
+
+const int BLOCK_SIZE = 16;
+
+/// Corner coordinates of a block of tetrahedra, one array per corner and
+/// coordinate so the metric loop runs over contiguous memory
+struct TetBlock
+{
+  double x[4][BLOCK_SIZE];
+  double y[4][BLOCK_SIZE];
+  double z[4][BLOCK_SIZE];
+};
+
+/// Same metrics as TetVolMesh computes for linear elements, whose jacobian
+/// is constant over the element
+void tet_block_metrics(const TetBlock& b, int n, double m[NUM_METRICS][BLOCK_SIZE])
+{
+  const double sqrt2 = std::sqrt(2.0);
+  for (int k = 0; k < n; k++)
+  {
+    const double ax = b.x[1][k]-b.x[0][k], ay = b.y[1][k]-b.y[0][k], az = b.z[1][k]-b.z[0][k];
+    const double bx = b.x[2][k]-b.x[0][k], by = b.y[2][k]-b.y[0][k], bz = b.z[2][k]-b.z[0][k];
+    const double cx = b.x[3][k]-b.x[0][k], cy = b.y[3][k]-b.y[0][k], cz = b.z[3][k]-b.z[0][k];
+
+    const double det = ax*by*cz - az*by*cx + ay*bz*cx + az*bx*cy - ax*bz*cy - ay*bx*cz;
+
+    const double l0 = std::sqrt(ax*ax + ay*ay + az*az);
+    const double l1 = std::sqrt((bx-ax)*(bx-ax) + (by-ay)*(by-ay) + (bz-az)*(bz-az));
+    const double l2 = std::sqrt(bx*bx + by*by + bz*bz);
+    const double l3 = std::sqrt(cx*cx + cy*cy + cz*cz);
+    const double l4 = std::sqrt((cx-ax)*(cx-ax) + (cy-ay)*(cy-ay) + (cz-az)*(cz-az));
+    const double l5 = std::sqrt((cx-bx)*(cx-bx) + (cy-by)*(cy-by) + (cz-bz)*(cz-bz));
+
+    double scale = l0*l2*l3;
+    scale = std::max(scale, l0*l1*l4);
+    scale = std::max(scale, l1*l2*l5);
+    scale = std::max(scale, l3*l4*l5);
+    scale = std::max(scale, det);
+
+    const double vol = det*(1.0/6.0);
+
+    const double s_A = 0.5*(l0+l1+l2);
+    const double s_B = 0.5*(l1+l4+l5);
+    const double s_C = 0.5*(l2+l3+l5);
+    const double s_D = 0.5*(l0+l3+l4);
+    const double area = std::sqrt(s_A*(s_A - l0)*(s_A - l1)*(s_A - l2)) +
+                        std::sqrt(s_B*(s_B - l1)*(s_B - l4)*(s_B - l5)) +
+                        std::sqrt(s_C*(s_C - l2)*(s_C - l3)*(s_C - l5)) +
+                        std::sqrt(s_D*(s_D - l0)*(s_D - l3)*(s_D - l4));
+    const double t = (l0*l5 + l1*l3 + l2*l4) / 2.0;
+    const double r_in = 3.0 * vol / area;
+    const double r_cir = std::sqrt(t*(t - l0*l5)*(t - l1*l3)*(t - l2*l4)) / (6.0*vol);
+
+    m[SCALED_JACOBIAN][k] = sqrt2*det/scale;
+    m[JACOBIAN][k] = det;
+    m[VOLUME][k] = vol;
+    m[INSC_CIRC_RATIO][k] = (r_in / r_cir) / 0.333333;
+  }
+}
+
+/// Per thread accumulation of the metric ranges. Degenerate elements can
+/// give NaN or infinite metrics, these are counted but left out of the
+/// ranges and means.
+struct PartialSummary
+{
+  PartialSummary() : num_inverted(0)
+  {
+    for (int j = 0; j < NUM_METRICS; j++)
+    {
+      min[j] = std::numeric_limits<double>::max();
+      max[j] = -std::numeric_limits<double>::max();
+      sum[j] = 0.0;
+      num_nonfinite[j] = 0;
+    }
+  }
+
+  void add(const double* m)
+  {
+    for (int j = 0; j < NUM_METRICS; j++)
+    {
+      if (!std::isfinite(m[j]))
+      {
+        num_nonfinite[j]++;
+        continue;
+      }
+      if (m[j] < min[j]) min[j] = m[j];
+      if (m[j] > max[j]) max[j] = m[j];
+      sum[j] += m[j];
+    }
+    if (m[JACOBIAN] <= 0.0) num_inverted++;
+  }
+
+  double min[NUM_METRICS], max[NUM_METRICS], sum[NUM_METRICS];
+  size_type num_nonfinite[NUM_METRICS];
+  size_type num_inverted;
+};
+
+}
+
+bool
+GetMeshQualityFieldAlgo::runImpl(FieldHandle input, FieldHandle& output) const
+{
+  QualitySummary summary;
+  return (runImpl(input,output,summary));
+}
 
 bool
-GetMeshQualityFieldAlgo::run(FieldHandle input, FieldHandle& output)
+GetMeshQualityFieldAlgo::runImpl(FieldHandle input, FieldHandle& output, QualitySummary& summary) const
 {
-  algo_start("GetMeshQualityField");
-  std::string metric = get_option("metric");
-  
-  if (input.get_rep() == 0)
+  ScopedAlgorithmStatusReporter asr(this, "GetMeshQualityField");
+
+  if (!input)
   {
     error("No input field");
-    algo_end(); return (false);
+    return (false);
+  }
+
+  const std::string metric_name = get_option(Parameters::QualityMetric);
+  int metric = 0;
+  while (metric < NUM_METRICS && metric_name != metric_names[metric]) metric++;
+  if (metric == NUM_METRICS)
+  {
+    error("Unknown quality metric: " + metric_name);
+    return (false);
+  }
+
+  int num_bins = get(Parameters::NumHistogramBins).toInt();
+  if (num_bins < 1)
+  {
+    error("The number of histogram bins needs to be at least one");
+    return (false);
   }
 
   FieldInformation fi(input);
+  const bool linear_tets = fi.is_tetvolmesh() && fi.is_linearmesh();
   fi.make_double();
   fi.make_constantdata();
-  
+
   output = CreateField(fi,input->mesh());
-  
-  if (output.get_rep() == 0)
+
+  if (!output)
   {
     error("Could not create output field");
-    algo_end(); return (false);
+    return (false);
   }
-  
+
   VField* ofield = output->vfield();
   VMesh*  imesh  = input->vmesh();
-  
-  if (metric == "scaled_jacobian")
+
+  const VMesh::size_type num_elems = imesh->num_elems();
+  std::vector<double> values(num_elems);
+
+  const int nproc = (num_elems < 10000) ? 1 : static_cast<int>(Parallel::NumCores());
+  std::vector<PartialSummary> partial(nproc);
+
+  // Only unstructured meshes have raw coordinate and connectivity arrays
+  const Point* points = linear_tets ? imesh->get_points_pointer() : 0;
+  const VMesh::index_type* elems = linear_tets ? imesh->get_elems_pointer() : 0;
+
+  auto task = [&](int proc)
   {
-    VMesh::Elem::size_type num_values = imesh->num_elems();
-    for (VMesh::Elem::index_type j=0; j<num_values; j++)
+    const VMesh::index_type start = (num_elems/nproc)*proc;
+    const VMesh::index_type end = (proc < nproc-1) ? (num_elems/nproc)*(proc+1) : num_elems;
+    PartialSummary& sum = partial[proc];
+
+    if (linear_tets)
+    {
+      TetBlock block;
+      double m[NUM_METRICS][BLOCK_SIZE];
+      VMesh::Node::array_type nodes;
+      Point p[4];
+
+      for (VMesh::index_type idx = start; idx < end; idx += BLOCK_SIZE)
+      {
+        const int n = static_cast<int>(std::min<VMesh::index_type>(BLOCK_SIZE, end-idx));
+        for (int k = 0; k < n; k++)
+        {
+          if (points && elems)
+          {
+            const VMesh::index_type* e = elems + 4*(idx+k);
+            for (int c = 0; c < 4; c++) p[c] = points[e[c]];
+          }
+          else
+          {
+            imesh->get_nodes(nodes,VMesh::Elem::index_type(idx+k));
+            for (int c = 0; c < 4; c++) imesh->get_center(p[c],nodes[c]);
+          }
+          for (int c = 0; c < 4; c++)
+          {
+            block.x[c][k] = p[c].x();
+            block.y[c][k] = p[c].y();
+            block.z[c][k] = p[c].z();
+          }
+        }
+
+        tet_block_metrics(block,n,m);
+
+        for (int k = 0; k < n; k++)
+        {
+          double em[NUM_METRICS];
+          for (int j = 0; j < NUM_METRICS; j++) em[j] = m[j][k];
+          sum.add(em);
+          values[idx+k] = em[metric];
+        }
+      }
+    }
+    else
     {
-      ofield->set_value(imesh->scaled_jacobian_metric(j),j);
+      double em[NUM_METRICS];
+      for (VMesh::Elem::index_type idx = start; idx < end; idx++)
+      {
+        em[SCALED_JACOBIAN] = imesh->scaled_jacobian_metric(idx);
+        em[JACOBIAN] = imesh->jacobian_metric(idx);
+        em[VOLUME] = imesh->volume_metric(idx);
+        em[INSC_CIRC_RATIO] = imesh->inscribed_circumscribed_radius_metric(idx);
+        sum.add(em);
+        values[idx] = em[metric];
+      }
     }
-  }
-  else if (metric == "jacobian")
+  };
+  Parallel::RunTasks(task,nproc);
+
+  PartialSummary total;
+  for (int proc = 0; proc < nproc; proc++)
   {
-    VMesh::Elem::size_type num_values = imesh->num_elems();
-    for (VMesh::Elem::index_type j=0; j<num_values; j++)
+    for (int j = 0; j < NUM_METRICS; j++)
     {
-      ofield->set_value(imesh->jacobian_metric(j),j);
-    }  
+      total.min[j] = std::min(total.min[j],partial[proc].min[j]);
+      total.max[j] = std::max(total.max[j],partial[proc].max[j]);
+      total.sum[j] += partial[proc].sum[j];
+      total.num_nonfinite[j] += partial[proc].num_nonfinite[j];
+    }
+    total.num_inverted += partial[proc].num_inverted;
   }
-  else if (metric == "volume")
+
+  summary = QualitySummary();
+  summary.num_elems = num_elems;
+  summary.num_inverted = total.num_inverted;
+  for (int j = 0; j < NUM_METRICS; j++)
   {
-    VMesh::Elem::size_type num_values = imesh->num_elems();
-    for (VMesh::Elem::index_type j=0; j<num_values; j++)
+    MetricSummary ms;
+    ms.name = metric_names[j];
+    ms.num_nonfinite = total.num_nonfinite[j];
+    const size_type num_finite = num_elems - total.num_nonfinite[j];
+    if (num_finite > 0)
     {
-      ofield->set_value(imesh->volume_metric(j),j);
-    }  
+      ms.min = total.min[j];
+      ms.max = total.max[j];
+      ms.mean = total.sum[j]/num_finite;
+    }
+    summary.metrics.push_back(ms);
   }
-  else if (metric == "insc_circ_ratio")
+
+  // Histogram of the selected metric, values on the upper edge go in the
+  // last bin. Non-finite values are not binned, the summary counts them.
+  const MetricSummary& selected = summary.metrics[metric];
+  summary.bin_min = selected.min;
+  summary.bin_width = (selected.max - selected.min)/num_bins;
+  std::vector<std::vector<size_type> > counts(nproc, std::vector<size_type>(num_bins,0));
+
+  auto bin_task = [&](int proc)
   {
-    VMesh::Elem::size_type num_values = imesh->num_elems();
-    for (VMesh::Elem::index_type j=0; j<num_values; j++)
+    const VMesh::index_type start = (num_elems/nproc)*proc;
+    const VMesh::index_type end = (proc < nproc-1) ? (num_elems/nproc)*(proc+1) : num_elems;
+    std::vector<size_type>& count = counts[proc];
+    for (VMesh::index_type idx = start; idx < end; idx++)
     {
-      ofield->set_value(imesh->inscribed_circumscribed_radius_metric(j),j);
-    }  
-  }  
+      if (!std::isfinite(values[idx])) continue;
+      int bin = 0;
+      if (summary.bin_width > 0.0)
+      {
+        bin = static_cast<int>((values[idx]-summary.bin_min)/summary.bin_width);
+        bin = std::max(0,std::min(bin,num_bins-1));
+      }
+      count[bin]++;
+    }
+  };
+  Parallel::RunTasks(bin_task,nproc);
+
+  summary.histogram.assign(num_bins,0);
+  for (int proc = 0; proc < nproc; proc++)
+    for (int b = 0; b < num_bins; b++) summary.histogram[b] += counts[proc][b];
+
+  ofield->set_values(values);
 
-  algo_end();
   return (true);
 }
 
+std::string
+GetMeshQualityFieldAlgo::QualitySummary::report() const
+{
+  std::ostringstream oss;
+  oss << "Number of elements: " << num_elems << "\n";
+  oss << "Inverted elements: " << num_inverted << "\n";
+  for (size_t j = 0; j < metrics.size(); j++)
+  {
+    oss << std::left << std::setw(16) << metrics[j].name << std::right
+        << " min " << std::setw(12) << metrics[j].min
+        << " max " << std::setw(12) << metrics[j].max
+        << " mean " << std::setw(12) << metrics[j].mean;
+    if (metrics[j].num_nonfinite > 0)
+      oss << " non-finite " << metrics[j].num_nonfinite;
+    oss << "\n";
+  }
+  oss << "Histogram:\n";
+  for (size_t b = 0; b < histogram.size(); b++)
+  {
+    oss << "  [" << std::setw(12) << bin_min + b*bin_width << ", "
+        << std::setw(12) << bin_min + (b+1)*bin_width << ") " << histogram[b] << "\n";
+  }
+  return (oss.str());
+}
+
+const AlgorithmOutputName GetMeshQualityFieldAlgo::QualityReport("QualityReport");
+const AlgorithmOutputName GetMeshQualityFieldAlgo::QualityHistogram("QualityHistogram");
+
+AlgorithmOutput
+GetMeshQualityFieldAlgo::run_generic(const AlgorithmInput& input) const
+{
+  auto field = input.get<Field>(Variables::InputField);
+
+  FieldHandle outputField;
+  QualitySummary summary;
+  if (!runImpl(field, outputField, summary))
+    THROW_ALGORITHM_PROCESSING_ERROR("False returned on legacy run call.");
+
+  // One row per bin: lower edge and number of elements
+  DenseMatrixHandle histogram(new DenseMatrix(summary.histogram.size(), 2));
+  for (size_t b = 0; b < summary.histogram.size(); b++)
+  {
+    (*histogram)(b,0) = summary.bin_min + b*summary.bin_width;
+    (*histogram)(b,1) = static_cast<double>(summary.histogram[b]);
+  }
 
+  AlgorithmOutput output;
+  output[Variables::OutputField] = outputField;
+  output[QualityReport] = boost::make_shared<String>(summary.report());
+  output[QualityHistogram] = histogram;
+  return output;
 }
@@ -26,36 +26,71 @@
    DEALINGS IN THE SOFTWARE.
 */
 
+
 #ifndef CORE_ALGORITHMS_FIELDS_MESHDATA_GETMESHQUALITYFIELD_H
 #define CORE_ALGORITHMS_FIELDS_MESHDATA_GETMESHQUALITYFIELD_H 1
 
-// Datatypes that the algorithm uses
-#include <Core/Datatypes/Mesh.h>
-#include <Core/Datatypes/Field.h>
+#include <Core/Algorithms/Base/AlgorithmBase.h>
+#include <Core/Datatypes/Legacy/Base/Types.h>
+#include <Core/Datatypes/Legacy/Field/FieldFwd.h>
+#include <Core/Algorithms/Legacy/Fields/share.h>
+
+namespace SCIRun {
+  namespace Core {
+    namespace Algorithms {
+      namespace Fields {
 
-// Base class for algorithm
-#include <Core/Algorithms/Util/AlgoBase.h>
+        ALGORITHM_PARAMETER_DECL(QualityMetric);
+        ALGORITHM_PARAMETER_DECL(NumHistogramBins);
 
-// for Windows support
-#include <Core/Algorithms/Fields/share.h>
+/// Compute a quality metric for every element of a mesh. The output field
+/// has the mesh of the input and the metric of the selected type as
+/// constant data.
+///
+/// All metrics are evaluated in the same pass over the elements, which is
+/// split over the available cores. Linear tetrahedral meshes use a kernel
+/// working on blocks of elements whose coordinates are gathered into one
+/// array per coordinate. The summary reports the range and mean of every
+/// metric, and a histogram of the selected one.
+class SCISHARE GetMeshQualityFieldAlgo : public AlgorithmBase
+{
+public:
+  GetMeshQualityFieldAlgo();
 
-namespace SCIRunAlgo {
+  struct MetricSummary
+  {
+    MetricSummary() : min(0.0), max(0.0), mean(0.0), num_nonfinite(0) {}
+    std::string name;
+    /// Range and mean of the finite values
+    double min, max, mean;
+    /// Elements for which the metric is NaN or infinite, e.g. collapsed ones
+    size_type num_nonfinite;
+  };
 
-using namespace SCIRun;
+  struct QualitySummary
+  {
+    QualitySummary() : num_elems(0), num_inverted(0), bin_min(0.0), bin_width(0.0) {}
+    size_type num_elems;
+    /// Elements with a jacobian that is not positive
+    size_type num_inverted;
+    std::vector<MetricSummary> metrics;
+    /// Histogram of the finite values of the selected metric, starting at
+    /// bin_min
+    std::vector<size_type> histogram;
+    double bin_min, bin_width;
 
-class SCISHARE GetMeshQualityFieldAlgo : public AlgoBase
-{
-  public:
-    /// Set defaults
-    GetMeshQualityFieldAlgo()
-    {
-      add_option("metric","scaled_jacobian","scaled_jacobian|jacobian|volume|insc_circ_ratio");
-    }
-    
-    /// run the algorithm
-    bool run(FieldHandle input, FieldHandle& output);
+    std::string report() const;
+  };
+
+  bool runImpl(FieldHandle input, FieldHandle& output) const;
+  bool runImpl(FieldHandle input, FieldHandle& output, QualitySummary& summary) const;
+
+  static const AlgorithmOutputName QualityReport;
+  static const AlgorithmOutputName QualityHistogram;
+
+  virtual AlgorithmOutput run_generic(const AlgorithmInput& input) const;
 };
 
-}
+      }}}}
 
 #endif
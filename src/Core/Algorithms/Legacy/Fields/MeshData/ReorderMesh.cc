@@ -0,0 +1,495 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Core/Algorithms/Legacy/Fields/MeshData/ReorderMesh.h>
+
+#include <Core/Algorithms/Base/AlgorithmVariableNames.h>
+#include <Core/Algorithms/Base/AlgorithmPreconditions.h>
+
+#include <Core/Datatypes/Legacy/Field/Field.h>
+#include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/Legacy/Field/FieldInformation.h>
+#include <Core/Datatypes/DenseMatrix.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
+#include <Core/GeometryPrimitives/BBox.h>
+
+#include <algorithm>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Algorithms::Fields;
+
+ALGORITHM_PARAMETER_DEF(Fields, NodeOrdering);
+ALGORITHM_PARAMETER_DEF(Fields, ElemOrdering);
+
+ReorderMeshAlgo::ReorderMeshAlgo()
+{
+  add_option(Parameters::NodeOrdering, "ReverseCuthillMcKee", "ReverseCuthillMcKee|Hilbert|Morton|None");
+  add_option(Parameters::ElemOrdering, "Hilbert", "Hilbert|Morton|None");
+}
+
+namespace {
+
+// Bits per axis of the curve keys, three axes fit in 63 bits
+const int CURVE_BITS = 21;
+
+unsigned long long
+morton_key(unsigned int x, unsigned int y, unsigned int z)
+{
+  unsigned long long key = 0;
+  for (int b = CURVE_BITS-1; b >= 0; b--)
+  {
+    key = (key << 3) | (((x >> b) & 1) << 2) | (((y >> b) & 1) << 1) | ((z >> b) & 1);
+  }
+  return (key);
+}
+
+// Skilling's transpose algorithm: the coordinates are turned into the
+// transposed Hilbert index in place, which is then interleaved like a
+// Morton key.
+unsigned long long
+hilbert_key(unsigned int x, unsigned int y, unsigned int z)
+{
+  unsigned int X[3] = { x, y, z };
+  const unsigned int M = 1u << (CURVE_BITS-1);
+
+  for (unsigned int Q = M; Q > 1; Q >>= 1)
+  {
+    const unsigned int P = Q - 1;
+    for (int i = 0; i < 3; i++)
+    {
+      if (X[i] & Q)
+      {
+        X[0] ^= P;
+      }
+      else
+      {
+        const unsigned int t = (X[0] ^ X[i]) & P;
+        X[0] ^= t;
+        X[i] ^= t;
+      }
+    }
+  }
+
+  for (int i = 1; i < 3; i++) X[i] ^= X[i-1];
+  unsigned int t = 0;
+  for (unsigned int Q = M; Q > 1; Q >>= 1)
+  {
+    if (X[2] & Q) t ^= Q - 1;
+  }
+  for (int i = 0; i < 3; i++) X[i] ^= t;
+
+  return (morton_key(X[0], X[1], X[2]));
+}
+
+// Node graph of the mesh in compressed row format, two nodes are
+// neighbors if they share an element, as in the finite element matrix.
+void
+build_node_graph(VMesh* mesh,
+                 std::vector<index_type>& offsets,
+                 std::vector<index_type>& neighbors)
+{
+  VMesh::size_type num_nodes = mesh->num_nodes();
+  VMesh::size_type num_elems = mesh->num_elems();
+
+  VMesh::Node::array_type nodes;
+
+  // Elements per node
+  std::vector<index_type> elem_offsets(num_nodes+1, 0);
+  for (VMesh::Elem::index_type idx = 0; idx < num_elems; idx++)
+  {
+    mesh->get_nodes(nodes, idx);
+    for (size_t j = 0; j < nodes.size(); j++) elem_offsets[nodes[j]+1]++;
+  }
+  for (index_type i = 0; i < num_nodes; i++) elem_offsets[i+1] += elem_offsets[i];
+
+  std::vector<index_type> node_elems(elem_offsets[num_nodes]);
+  std::vector<index_type> fill(elem_offsets.begin(), elem_offsets.end()-1);
+  for (VMesh::Elem::index_type idx = 0; idx < num_elems; idx++)
+  {
+    mesh->get_nodes(nodes, idx);
+    for (size_t j = 0; j < nodes.size(); j++) node_elems[fill[nodes[j]]++] = idx;
+  }
+
+  // Neighbors through the elements, marking the ones already seen
+  std::vector<index_type> marker(num_nodes, -1);
+  offsets.assign(num_nodes+1, 0);
+  neighbors.clear();
+  neighbors.reserve(static_cast<size_t>(elem_offsets[num_nodes]) * 4);
+
+  for (index_type i = 0; i < num_nodes; i++)
+  {
+    marker[i] = i;
+    for (index_type k = elem_offsets[i]; k < elem_offsets[i+1]; k++)
+    {
+      mesh->get_nodes(nodes, VMesh::Elem::index_type(node_elems[k]));
+      for (size_t j = 0; j < nodes.size(); j++)
+      {
+        const index_type n = nodes[j];
+        if (marker[n] != i)
+        {
+          marker[n] = i;
+          neighbors.push_back(n);
+        }
+      }
+    }
+    offsets[i+1] = static_cast<index_type>(neighbors.size());
+  }
+}
+
+// Breadth first search from start, returns the nodes of the last level
+// and the number of levels.
+index_type
+last_level(index_type start,
+           const std::vector<index_type>& offsets,
+           const std::vector<index_type>& neighbors,
+           std::vector<index_type>& level,
+           std::vector<index_type>& last)
+{
+  std::vector<index_type> visited;
+  std::vector<index_type> current(1, start);
+  std::vector<index_type> next;
+  level[start] = 0;
+  visited.push_back(start);
+
+  index_type depth = 0;
+  while (true)
+  {
+    next.clear();
+    for (size_t q = 0; q < current.size(); q++)
+    {
+      const index_type n = current[q];
+      for (index_type k = offsets[n]; k < offsets[n+1]; k++)
+      {
+        const index_type m = neighbors[k];
+        if (level[m] < 0)
+        {
+          level[m] = depth + 1;
+          next.push_back(m);
+          visited.push_back(m);
+        }
+      }
+    }
+    if (next.empty()) break;
+    current.swap(next);
+    depth++;
+  }
+
+  last = current;
+  for (size_t q = 0; q < visited.size(); q++) level[visited[q]] = -1;
+  return (depth);
+}
+
+MatrixHandle
+build_permutation_matrix(const std::vector<index_type>& new_to_old)
+{
+  const size_type n = static_cast<size_type>(new_to_old.size());
+  if (n == 0) return (MatrixHandle(new DenseMatrix(0,0)));
+
+  typedef SparseRowMatrix::Triplet T;
+  std::vector<T> tripletList;
+  tripletList.reserve(n);
+  for (index_type i = 0; i < n; i++) tripletList.push_back(T(i, new_to_old[i], 1.0));
+
+  SparseRowMatrixHandle mat(new SparseRowMatrix(n, n));
+  mat->setFromTriplets(tripletList.begin(), tripletList.end());
+  return (mat);
+}
+
+}
+
+void
+ReorderMeshAlgo::reverse_cuthill_mckee(VMesh* mesh, std::vector<index_type>& new_to_old)
+{
+  std::vector<index_type> offsets;
+  std::vector<index_type> neighbors;
+  build_node_graph(mesh, offsets, neighbors);
+
+  const index_type num_nodes = static_cast<index_type>(offsets.size()) - 1;
+  // The graph includes the node itself
+  std::vector<index_type> degree(num_nodes);
+  for (index_type i = 0; i < num_nodes; i++) degree[i] = offsets[i+1] - offsets[i];
+
+  std::vector<char> numbered(num_nodes, 0);
+  std::vector<index_type> level(num_nodes, -1);
+  std::vector<index_type> last;
+  std::vector<index_type> order;
+  order.reserve(num_nodes);
+
+  std::vector<index_type> children;
+
+  for (index_type seed = 0; seed < num_nodes; seed++)
+  {
+    if (numbered[seed]) continue;
+
+    // Pseudo-peripheral start node (George and Liu): move to a node of
+    // minimum degree in the last level as long as the depth increases.
+    index_type start = seed;
+    index_type depth = last_level(start, offsets, neighbors, level, last);
+    while (true)
+    {
+      index_type candidate = last[0];
+      for (size_t q = 1; q < last.size(); q++)
+      {
+        if (degree[last[q]] < degree[candidate]) candidate = last[q];
+      }
+      if (candidate == start) break;
+      std::vector<index_type> candidate_last;
+      index_type candidate_depth = last_level(candidate, offsets, neighbors, level, candidate_last);
+      if (candidate_depth <= depth) break;
+      start = candidate;
+      depth = candidate_depth;
+      last.swap(candidate_last);
+    }
+
+    // Cuthill-McKee numbering of this component, neighbors by increasing degree
+    size_t head = order.size();
+    order.push_back(start);
+    numbered[start] = 1;
+    while (head < order.size())
+    {
+      const index_type n = order[head++];
+      children.clear();
+      for (index_type k = offsets[n]; k < offsets[n+1]; k++)
+      {
+        const index_type m = neighbors[k];
+        if (!numbered[m])
+        {
+          numbered[m] = 1;
+          children.push_back(m);
+        }
+      }
+      std::sort(children.begin(), children.end(),
+        [&degree](index_type a, index_type b)
+        { return (degree[a] < degree[b]) || (degree[a] == degree[b] && a < b); });
+      order.insert(order.end(), children.begin(), children.end());
+    }
+  }
+
+  new_to_old.assign(order.rbegin(), order.rend());
+}
+
+void
+ReorderMeshAlgo::space_filling_curve(const std::vector<Point>& points,
+                                     bool hilbert, std::vector<index_type>& new_to_old)
+{
+  BBox bbox;
+  for (size_t i = 0; i < points.size(); i++) bbox.extend(points[i]);
+
+  // Same scale on all axes so the curve follows the geometry
+  double scale = 0.0;
+  if (bbox.valid())
+  {
+    const double extent = bbox.longest_edge();
+    if (extent > 0.0) scale = static_cast<double>((1u << CURVE_BITS) - 1) / extent;
+  }
+
+  std::vector<std::pair<unsigned long long, index_type> > keys(points.size());
+  for (size_t i = 0; i < points.size(); i++)
+  {
+    const Vector d = points[i] - bbox.get_min();
+    const unsigned int x = static_cast<unsigned int>(d.x() * scale);
+    const unsigned int y = static_cast<unsigned int>(d.y() * scale);
+    const unsigned int z = static_cast<unsigned int>(d.z() * scale);
+    keys[i].first = hilbert ? hilbert_key(x, y, z) : morton_key(x, y, z);
+    keys[i].second = static_cast<index_type>(i);
+  }
+
+  std::sort(keys.begin(), keys.end());
+
+  new_to_old.resize(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) new_to_old[i] = keys[i].second;
+}
+
+bool
+ReorderMeshAlgo::runImpl(FieldHandle input, FieldHandle& output) const
+{
+  MatrixHandle node_mapping, elem_mapping;
+  return (runImpl(input, output, node_mapping, elem_mapping));
+}
+
+bool
+ReorderMeshAlgo::runImpl(FieldHandle input, FieldHandle& output,
+                         MatrixHandle& node_mapping, MatrixHandle& elem_mapping) const
+{
+  ScopedAlgorithmStatusReporter asr(this, "ReorderMesh");
+
+  if (!input)
+  {
+    error("No input field.");
+    return (false);
+  }
+
+  FieldInformation fi(input);
+  if (!fi.is_unstructuredmesh())
+  {
+    error("This algorithm only works on unstructured meshes, the node order of other meshes is implicit.");
+    return (false);
+  }
+
+  if (fi.is_nonlinear())
+  {
+    error("This algorithm has not yet been defined for non-linear elements yet.");
+    return (false);
+  }
+
+  std::string node_method = get_option(Parameters::NodeOrdering);
+  std::string elem_method = get_option(Parameters::ElemOrdering);
+
+  VMesh*  imesh  = input->vmesh();
+  VField* ifield = input->vfield();
+
+  VMesh::size_type num_nodes = imesh->num_nodes();
+  VMesh::size_type num_elems = imesh->num_elems();
+
+  const bool pointcloud = imesh->is_pointcloudmesh();
+  if (pointcloud && node_method == "ReverseCuthillMcKee")
+  {
+    remark("A point cloud has no connectivity, ordering its nodes along a Hilbert curve instead.");
+    node_method = "Hilbert";
+  }
+
+  // Step 1: node order
+
+  std::vector<index_type> node_new_to_old;
+  if (node_method == "ReverseCuthillMcKee")
+  {
+    reverse_cuthill_mckee(imesh, node_new_to_old);
+  }
+  else if (node_method == "Hilbert" || node_method == "Morton")
+  {
+    std::vector<Point> points(num_nodes);
+    for (VMesh::Node::index_type idx = 0; idx < num_nodes; idx++) imesh->get_center(points[idx], idx);
+    space_filling_curve(points, node_method == "Hilbert", node_new_to_old);
+  }
+  else
+  {
+    node_new_to_old.resize(num_nodes);
+    for (index_type i = 0; i < num_nodes; i++) node_new_to_old[i] = i;
+  }
+  update_progress_max(1, 3);
+
+  std::vector<index_type> node_old_to_new(num_nodes);
+  for (index_type i = 0; i < num_nodes; i++) node_old_to_new[node_new_to_old[i]] = i;
+
+  // Step 2: element order, the elements of a point cloud are its nodes
+
+  std::vector<index_type> elem_new_to_old;
+  if (pointcloud)
+  {
+    elem_new_to_old = node_new_to_old;
+  }
+  else if (elem_method == "Hilbert" || elem_method == "Morton")
+  {
+    std::vector<Point> centers(num_elems);
+    for (VMesh::Elem::index_type idx = 0; idx < num_elems; idx++) imesh->get_center(centers[idx], idx);
+    space_filling_curve(centers, elem_method == "Hilbert", elem_new_to_old);
+  }
+  else
+  {
+    elem_new_to_old.resize(num_elems);
+    for (index_type i = 0; i < num_elems; i++) elem_new_to_old[i] = i;
+  }
+  update_progress_max(2, 3);
+
+  // Step 3: build the renumbered field
+
+  output = CreateField(fi);
+  if (!output)
+  {
+    error("Could not create output field.");
+    return (false);
+  }
+
+  VMesh*  omesh  = output->vmesh();
+  VField* ofield = output->vfield();
+
+  omesh->node_reserve(num_nodes);
+  Point p;
+  for (index_type i = 0; i < num_nodes; i++)
+  {
+    imesh->get_center(p, VMesh::Node::index_type(node_new_to_old[i]));
+    omesh->add_node(p);
+  }
+
+  if (!pointcloud)
+  {
+    omesh->elem_reserve(num_elems);
+    VMesh::Node::array_type nodes;
+    for (index_type i = 0; i < num_elems; i++)
+    {
+      imesh->get_nodes(nodes, VMesh::Elem::index_type(elem_new_to_old[i]));
+      for (size_t j = 0; j < nodes.size(); j++)
+        nodes[j] = VMesh::Node::index_type(node_old_to_new[nodes[j]]);
+      omesh->add_elem(nodes);
+    }
+  }
+
+  ofield->resize_values();
+  if (ofield->basis_order() == 0)
+  {
+    for (index_type i = 0; i < num_elems; i++)
+      ofield->copy_value(ifield, elem_new_to_old[i], i);
+  }
+  else if (ofield->basis_order() == 1)
+  {
+    for (index_type i = 0; i < num_nodes; i++)
+      ofield->copy_value(ifield, node_new_to_old[i], i);
+  }
+
+  node_mapping = build_permutation_matrix(node_new_to_old);
+  elem_mapping = build_permutation_matrix(elem_new_to_old);
+
+  /// Copy properties of the property manager
+  CopyProperties(*input, *output);
+
+  return (true);
+}
+
+const AlgorithmOutputName ReorderMeshAlgo::NodeMapping("NodeMapping");
+const AlgorithmOutputName ReorderMeshAlgo::ElemMapping("ElemMapping");
+
+AlgorithmOutput ReorderMeshAlgo::run_generic(const AlgorithmInput& input) const
+{
+  auto inputField = input.get<Field>(Variables::InputField);
+
+  FieldHandle outputField;
+  MatrixHandle node_mapping, elem_mapping;
+
+  if (!runImpl(inputField, outputField, node_mapping, elem_mapping))
+    THROW_ALGORITHM_PROCESSING_ERROR("False returned on legacy run call.");
+
+  AlgorithmOutput output;
+  output[Variables::OutputField] = outputField;
+  output[NodeMapping] = node_mapping;
+  output[ElemMapping] = elem_mapping;
+  return output;
+}
@@ -0,0 +1,76 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef CORE_ALGORITHMS_FIELDS_MESHDATA_REORDERMESH_H
+#define CORE_ALGORITHMS_FIELDS_MESHDATA_REORDERMESH_H 1
+
+#include <Core/Algorithms/Base/AlgorithmBase.h>
+#include <Core/Datatypes/Legacy/Base/Types.h>
+#include <Core/Datatypes/Legacy/Field/FieldFwd.h>
+#include <Core/GeometryPrimitives/GeomFwd.h>
+#include <Core/Algorithms/Legacy/Fields/share.h>
+
+namespace SCIRun {
+  namespace Core {
+    namespace Algorithms {
+      namespace Fields {
+
+        ALGORITHM_PARAMETER_DECL(NodeOrdering);
+        ALGORITHM_PARAMETER_DECL(ElemOrdering);
+
+/// Renumber the nodes and elements of an unstructured mesh so that
+/// neighboring entities are stored close together in memory.
+///
+/// Nodes are ordered by reverse Cuthill-McKee on the node graph of the mesh
+/// or along a Hilbert or Morton curve, elements along a curve through their
+/// centers. Field data is permuted with the mesh, and the permutations are
+/// returned as mapping matrices that take input values to output values.
+class SCISHARE ReorderMeshAlgo : public AlgorithmBase
+{
+public:
+  ReorderMeshAlgo();
+
+  bool runImpl(FieldHandle input, FieldHandle& output) const;
+  bool runImpl(FieldHandle input, FieldHandle& output,
+               Datatypes::MatrixHandle& node_mapping,
+               Datatypes::MatrixHandle& elem_mapping) const;
+
+  /// Node orders of a mesh, as new_to_old[new index] = old index.
+  static void reverse_cuthill_mckee(VMesh* mesh, std::vector<index_type>& new_to_old);
+  static void space_filling_curve(const std::vector<Geometry::Point>& points,
+                                  bool hilbert, std::vector<index_type>& new_to_old);
+
+  static const AlgorithmOutputName NodeMapping;
+  static const AlgorithmOutputName ElemMapping;
+
+  virtual AlgorithmOutput run_generic(const AlgorithmInput& input) const;
+};
+
+      }}}}
+
+#endif
@@ -37,13 +37,17 @@
 #include <Core/Algorithms/Base/AlgorithmPreconditions.h>
 #include <Core/Datatypes/PropertyManagerExtensions.h>
 
-#include <boost/unordered_map.hpp>
+#include <Core/Thread/Parallel.h>
+
+#include <atomic>
+#include <memory>
 
 using namespace SCIRun;
 using namespace SCIRun::Core::Algorithms;
 using namespace SCIRun::Core::Algorithms::Fields;
 using namespace SCIRun::Core::Datatypes;
 using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Thread;
 
 AlgorithmOutputName GetFieldBoundaryAlgo::BoundaryField("BoundaryField");
 AlgorithmOutputName GetFieldBoundaryAlgo::MappingMatrix("Mapping");
@@ -53,271 +57,63 @@ GetFieldBoundaryAlgo::GetFieldBoundaryAlgo()
   add_option(AlgorithmParameterName("mapping"),"auto","auto|node|elem|none");
 }
 
-struct IndexHash {
-  static const size_t bucket_size = 4;
-  static const size_t min_buckets = 8;
-  
-  size_t operator()(const index_type &idx) const
-    { return (static_cast<size_t>(idx)); }
-  
-  bool operator()(const index_type &i1, const index_type &i2) const
-    { return (i1 < i2); }
-};
+namespace {
 
-bool 
-GetFieldBoundaryAlgo::run(FieldHandle input, FieldHandle& output, MatrixHandle& mapping) const
+/// Boundary faces found in a range of elements, in element order
+struct BoundaryFaces
 {
-  ScopedAlgorithmStatusReporter asr(this, "GetFieldBoundary");
-
-  /// Define types we need for mapping
-  typedef boost::unordered_map<index_type,index_type,IndexHash> hash_map_type;
-
-  hash_map_type node_map;
-  hash_map_type elem_map;
-  
-  /// Check whether we have an input field
-  if (!input)
-  {
-    error("No input field");
-    return (false);
-  }
-
-  /// Figure out what the input type and output type have to be
-  FieldInformation fi(input);
-  FieldInformation fo(input);
-  
-  /// We do not yet support Quadratic and Cubic Meshes here
-  if (fi.is_nonlinear())
-  {
-    error("This function has not yet been defined for non-linear elements");
-    return (false);
-  }
-  
-  /// Figure out which type of field the output is:
-  bool found_method = false;
-  if (fi.is_hex_element())    { fo.make_quadsurfmesh(); found_method = true; }
-  if (fi.is_prism_element())  { fo.make_quadsurfmesh(); found_method = true; }
-  if (fi.is_tet_element())    { fo.make_trisurfmesh(); found_method = true; }
-  if (fi.is_quad_element())   { fo.make_curvemesh(); found_method = true; }
-  if (fi.is_tri_element())    { fo.make_curvemesh(); found_method = true; }
-  if (fi.is_pnt_element())
-  {
-    remark("The field boundary of a point cloud is the same point cloud");
-    output = input;
-    return (true);
-  }
-  
-  /// Check whether we could make a conversion
-  if (!found_method)
-  {
-    error("No method available for mesh of type: " + fi.get_mesh_type());
-    return (false);
-  }
+  std::vector<index_type> elems;    // input element of each face
+  std::vector<index_type> offsets;  // start of each face in nodes
+  std::vector<index_type> nodes;    // input nodes of all faces
+  std::vector<index_type> owned;    // nodes that first appear in this range
+};
 
-  /// Create the output field
-  output = CreateField(fo);
-  if (!output)
-  {
-    error("Could not create output field");
-    return (false);
-  }
-  
-  /// Get the virtual interfaces:
-  VMesh* imesh = input->vmesh();
-  VMesh* omesh = output->vmesh();
-  VField* ifield = input->vfield();
-  VField* ofield = output->vfield();
-  
-  imesh->synchronize(Mesh::DELEMS_E|Mesh::ELEM_NEIGHBORS_E);
-  
-  /// These are all virtual iterators, virtual index_types and array_types
-  VMesh::Elem::iterator be, ee;
-  VMesh::Elem::index_type nci, ci;
+void
+find_boundary_faces(VMesh* imesh, index_type start, index_type end, BoundaryFaces& faces)
+{
+  VMesh::Elem::index_type nci;
   VMesh::DElem::array_type delems; 
   VMesh::Node::array_type inodes; 
-  VMesh::Node::array_type onodes; 
-  VMesh::Node::index_type a;
-
-  inodes.clear();
-  onodes.clear();  
-  Point point;
-
-  /// This algorithm was copy from the original dynamic compiled version
-  /// and was slightly adapted to work here:
-  
-  imesh->begin(be); 
-  imesh->end(ee);
 
-  while (be != ee) 
+  for (VMesh::Elem::index_type ci = start; ci < end; ci++)
   {
-    checkForInterruption();
-    ci = *be;
     imesh->get_delems(delems,ci);
-    for (size_t p =0; p < delems.size(); p++)
+    for (size_t p = 0; p < delems.size(); p++)
     {
-      bool includeface = false;
-      
-      if(!(imesh->get_neighbor(nci,ci,delems[p]))) includeface = true;
-
-      if (includeface)
+      if (!(imesh->get_neighbor(nci,ci,delems[p])))
       {
         imesh->get_nodes(inodes,delems[p]);
-        onodes.resize(inodes.size());
-
-        for (size_t q=0; q<inodes.size(); q++)
-        {
-          a = inodes[q];
-          hash_map_type::iterator it = node_map.find(a);
-          if (it == node_map.end())
-          {
-            imesh->get_center(point,a);
-            onodes[q] = omesh->add_node(point);
-            node_map[a] = onodes[q];            
-          }
-          else
-          {
-            onodes[q] = node_map[a];
-          }
-        }
-        elem_map[omesh->add_elem(onodes)] = ci;
+        faces.elems.push_back(ci);
+        faces.offsets.push_back(static_cast<index_type>(faces.nodes.size()));
+        for (size_t q = 0; q < inodes.size(); q++) faces.nodes.push_back(inodes[q]);
       }
     }
-    ++be;
-  }
-  
-  mapping.reset();
-  
-  ofield->resize_fdata();
-  
-  if (
-    (
-    (ifield->basis_order() == 0)
-#ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
-      && check_option("mapping","auto")
-      )
-      ||
-       check_option("mapping","elem")
-#else
-    )
-#endif
-      )
-  {
-    VMesh::Elem::size_type isize;
-    VMesh::Elem::size_type osize;
-    imesh->size(isize);
-    omesh->size(osize);
-
-    size_type nrows = osize;
-    size_type ncols = isize;
-
-    typedef SparseRowMatrix::Triplet T;
-    std::vector<T> tripletList;
-    tripletList.reserve(nrows);
-
-    hash_map_type::iterator it, it_end;
-    it = elem_map.begin();
-    it_end = elem_map.end();
-
-    while (it != it_end)
-    {
-      tripletList.push_back(T(it->first, it->second, 1));
-      ++it;
-    }
-    SparseRowMatrixHandle mat(new SparseRowMatrix(nrows, ncols));
-    mat->setFromTriplets(tripletList.begin(), tripletList.end());
-    mapping = mat;
   }
-  else if (
-    ((ifield->basis_order() == 1) 
-#ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
-    && check_option("mapping","auto"))
-    ||
-      check_option("mapping","node")
-#else
-    )
-#endif
-      )
-  {
-    VMesh::Node::size_type isize;
-    VMesh::Node::size_type osize;
-    imesh->size(isize);
-    omesh->size(osize);
-
-    size_type nrows = osize;
-    size_type ncols = isize;
-
-    typedef Eigen::Triplet<double> T;
-    std::vector<T> tripletList;
-    tripletList.reserve(nrows);
-
-    hash_map_type::iterator it, it_end;
-    it = node_map.begin();
-    it_end = node_map.end();
+}
 
-    while (it != it_end)
-    {
-      tripletList.push_back(T(it->second, it->first, 1));
-      ++it;
-    }
-    SparseRowMatrixHandle mat(new SparseRowMatrix(nrows, ncols));
-    mat->setFromTriplets(tripletList.begin(), tripletList.end());
-    mapping = mat;
-  }
-  
-  if (ifield->basis_order() == 0)
-  {
-    hash_map_type::iterator it, it_end;
-    it = elem_map.begin();
-    it_end = elem_map.end();
-
-    while (it != it_end)
-    {      
-      checkForInterruption();
-      VMesh::Elem::index_type idx1((*it).second);
-      VMesh::Elem::index_type idx2((*it).first);  
-      
-      /// Copying values
-      ofield->copy_value(ifield,idx1,idx2);
-      ++it;
-    }
-  }
-  else if (input->basis_order() == 1)
-  {
-    hash_map_type::iterator it, it_end;
-    it = node_map.begin();
-    it_end = node_map.end();
-    
-    while (it != it_end)
-    {
-      checkForInterruption();
-      VMesh::Node::index_type idx1((*it).first);
-      VMesh::Node::index_type idx2((*it).second);
-      ofield->copy_value(ifield,idx1,idx2);
-      ++it;
-    }
-  }
-  
-  CopyProperties(*input, *output);
-  
-  return (true);
 }
 
+bool 
+GetFieldBoundaryAlgo::run(FieldHandle input, FieldHandle& output, MatrixHandle& mapping) const
+{
+  return (runImpl(input, output, &mapping));
+}
 
-/// A copy of the algorithm without creating the mapping matrix. 
+/// A version of the algorithm without creating the mapping matrix. 
 /// Need this for the various algorithms that only use the boundary to
 /// project nodes on.
 
 bool 
 GetFieldBoundaryAlgo::run(FieldHandle input, FieldHandle& output)
+{
+  return (runImpl(input, output, 0));
+}
+
+bool 
+GetFieldBoundaryAlgo::runImpl(FieldHandle input, FieldHandle& output, MatrixHandle* mapping) const
 {
   ScopedAlgorithmStatusReporter asr(this, "GetFieldBoundary");
 
-  /// Define types we need for mapping
-  typedef boost::unordered_map<index_type,index_type,IndexHash> hash_map_type;
-  
-  hash_map_type node_map;
-  hash_map_type elem_map;
-  
   /// Check whether we have an input field
   if (!input)
   {
@@ -372,91 +168,180 @@ GetFieldBoundaryAlgo::run(FieldHandle input, FieldHandle& output)
   VField* ofield = output->vfield();
   
   imesh->synchronize(Mesh::DELEMS_E|Mesh::ELEM_NEIGHBORS_E);
-  
-  /// These are all virtual iterators, virtual index_types and array_types
-  VMesh::Elem::iterator be, ee;
-  VMesh::Elem::index_type nci, ci;
-  VMesh::DElem::array_type delems; 
-  VMesh::Node::array_type inodes; 
-  VMesh::Node::array_type onodes; 
-  VMesh::Node::index_type a;
 
-  inodes.clear();
-  onodes.clear();  
-  Point point;
+  const size_type num_nodes = imesh->num_nodes();
+  const size_type num_elems = imesh->num_elems();
 
-  /// This algorithm was copy from the original dynamic compiled version
-  /// and was slightly adapted to work here:
-  
-  imesh->begin(be); 
-  imesh->end(ee);
+  /// Each thread collects the boundary faces of a range of elements. The
+  /// ranges are kept in element order, so the output is numbered exactly as
+  /// a serial walk over the elements would number it.
+  int nproc = static_cast<int>(Parallel::NumCores());
+  if (num_elems < 10000) nproc = 1;
 
-  while (be != ee) 
+  std::vector<BoundaryFaces> parts(nproc);
+  Parallel::RunTasks([&](int proc)
   {
-    checkForInterruption();
-    ci = *be;
-    imesh->get_delems(delems,ci);
-    for (size_t p =0; p < delems.size(); p++)
+    const index_type start = (num_elems/nproc)*proc;
+    const index_type end = (proc == nproc-1) ? num_elems : (num_elems/nproc)*(proc+1);
+    find_boundary_faces(imesh, start, end, parts[proc]);
+  }, nproc);
+  checkForInterruption();
+  update_progress_max(1, 4);
+
+  /// Compact the node numbers: a node belongs to the first range it appears
+  /// in, where it is numbered in order of appearance. A prefix sum over the
+  /// number of nodes per range then gives the output numbers.
+  std::unique_ptr<std::atomic<int>[]> owner(new std::atomic<int>[num_nodes]);
+  std::vector<index_type> node_map(num_nodes, -1);
+
+  Parallel::RunTasks([&](int proc)
+  {
+    const index_type start = (num_nodes/nproc)*proc;
+    const index_type end = (proc == nproc-1) ? num_nodes : (num_nodes/nproc)*(proc+1);
+    for (index_type n = start; n < end; n++) owner[n].store(nproc, std::memory_order_relaxed);
+  }, nproc);
+
+  Parallel::RunTasks([&](int proc)
+  {
+    const std::vector<index_type>& nodes = parts[proc].nodes;
+    for (size_t q = 0; q < nodes.size(); q++)
     {
-      bool includeface = false;
-      
-      if(!(imesh->get_neighbor(nci,ci,delems[p]))) includeface = true;
+      std::atomic<int>& o = owner[nodes[q]];
+      int current = o.load(std::memory_order_relaxed);
+      while (proc < current && !o.compare_exchange_weak(current, proc)) {}
+    }
+  }, nproc);
 
-      if (includeface)
+  Parallel::RunTasks([&](int proc)
+  {
+    BoundaryFaces& faces = parts[proc];
+    for (size_t q = 0; q < faces.nodes.size(); q++)
+    {
+      const index_type n = faces.nodes[q];
+      if (owner[n].load(std::memory_order_relaxed) == proc && node_map[n] < 0)
       {
-        imesh->get_nodes(inodes,delems[p]);
-        if (onodes.size() == 0) onodes.resize(inodes.size());
-        for (size_t q=0; q<onodes.size(); q++)
-        {
-          a = inodes[q];
-          hash_map_type::iterator it = node_map.find(a);
-          if (it == node_map.end())
-          {
-            imesh->get_center(point,a);
-            onodes[q] = omesh->add_node(point);
-            node_map[a] = onodes[q];            
-          }
-          else
-          {
-            onodes[q] = node_map[a];
-          }
-        }
-        elem_map[omesh->add_elem(onodes)] = ci;
+        node_map[n] = static_cast<index_type>(faces.owned.size());
+        faces.owned.push_back(n);
       }
     }
-    ++be;
+  }, nproc);
+
+  std::vector<index_type> node_base(nproc+1, 0);
+  std::vector<index_type> elem_base(nproc+1, 0);
+  for (int proc = 0; proc < nproc; proc++)
+  {
+    node_base[proc+1] = node_base[proc] + static_cast<index_type>(parts[proc].owned.size());
+    elem_base[proc+1] = elem_base[proc] + static_cast<index_type>(parts[proc].elems.size());
   }
-  
+
+  const index_type num_onodes = node_base[nproc];
+  const index_type num_oelems = elem_base[nproc];
+
+  std::vector<index_type> node_map2(num_onodes);
+  std::vector<Point> points(num_onodes);
+  Parallel::RunTasks([&](int proc)
+  {
+    const std::vector<index_type>& owned = parts[proc].owned;
+    for (size_t q = 0; q < owned.size(); q++)
+    {
+      const index_type idx = node_base[proc] + static_cast<index_type>(q);
+      node_map[owned[q]] = idx;
+      node_map2[idx] = owned[q];
+      imesh->get_center(points[idx], VMesh::Node::index_type(owned[q]));
+    }
+  }, nproc);
+  checkForInterruption();
+  update_progress_max(2, 4);
+
+  /// Build the output mesh
+  omesh->node_reserve(num_onodes);
+  for (index_type idx = 0; idx < num_onodes; idx++) omesh->add_node(points[idx]);
+
+  omesh->elem_reserve(num_oelems);
+  std::vector<index_type> elem_map2(num_oelems);
+  VMesh::Node::array_type onodes;
+  for (int proc = 0; proc < nproc; proc++)
+  {
+    const BoundaryFaces& faces = parts[proc];
+    for (size_t k = 0; k < faces.elems.size(); k++)
+    {
+      const index_type first = faces.offsets[k];
+      const index_type last = (k+1 < faces.elems.size()) ? 
+        faces.offsets[k+1] : static_cast<index_type>(faces.nodes.size());
+      onodes.resize(last-first);
+      for (index_type q = first; q < last; q++) onodes[q-first] = node_map[faces.nodes[q]];
+      elem_map2[omesh->add_elem(onodes)] = faces.elems[k];
+    }
+  }
+  parts.clear();
+  checkForInterruption();
+  update_progress_max(3, 4);
+
   ofield->resize_fdata();
   
+  if (mapping)
+  {
+    mapping->reset();
+
+    if (
+      (
+      (ifield->basis_order() == 0)
+#ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
+        && check_option("mapping","auto")
+        )
+        ||
+         check_option("mapping","elem")
+#else
+      )
+#endif
+        )
+    {
+      typedef SparseRowMatrix::Triplet T;
+      std::vector<T> tripletList;
+      tripletList.reserve(num_oelems);
+      for (index_type idx = 0; idx < num_oelems; idx++)
+        tripletList.push_back(T(idx, elem_map2[idx], 1));
+
+      SparseRowMatrixHandle mat(new SparseRowMatrix(num_oelems, num_elems));
+      mat->setFromTriplets(tripletList.begin(), tripletList.end());
+      *mapping = mat;
+    }
+    else if (
+      ((ifield->basis_order() == 1) 
+#ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
+      && check_option("mapping","auto"))
+      ||
+        check_option("mapping","node")
+#else
+      )
+#endif
+        )
+    {
+      typedef SparseRowMatrix::Triplet T;
+      std::vector<T> tripletList;
+      tripletList.reserve(num_onodes);
+      for (index_type idx = 0; idx < num_onodes; idx++)
+        tripletList.push_back(T(idx, node_map2[idx], 1));
+
+      SparseRowMatrixHandle mat(new SparseRowMatrix(num_onodes, num_nodes));
+      mat->setFromTriplets(tripletList.begin(), tripletList.end());
+      *mapping = mat;
+    }
+  }
+  
   if (ifield->basis_order() == 0)
   {
-    hash_map_type::iterator it, it_end;
-    it = elem_map.begin();
-    it_end = elem_map.end();
-    
-    while (it != it_end)
-    {      
-      VMesh::Elem::index_type idx1((*it).second);
-      VMesh::Elem::index_type idx2((*it).first);  
-      
+    for (VMesh::Elem::index_type idx = 0; idx < num_oelems; idx++)
+    {
       /// Copying values
-      ofield->copy_value(ifield,idx1,idx2);
-      ++it;
+      ofield->copy_value(ifield,VMesh::Elem::index_type(elem_map2[idx]),idx);
     }
   }
   else if (input->basis_order() == 1)
   {
-    hash_map_type::iterator it, it_end;
-    it = node_map.begin();
-    it_end = node_map.end();
-    
-    while (it != it_end)
+    for (VMesh::Node::index_type idx = 0; idx < num_onodes; idx++)
     {
-      VMesh::Node::index_type idx1((*it).first);
-      VMesh::Node::index_type idx2((*it).second);
-      ofield->copy_value(ifield,idx1,idx2);
-      ++it;
+      ofield->copy_value(ifield,VMesh::Node::index_type(node_map2[idx]),idx);
     }
   }
   
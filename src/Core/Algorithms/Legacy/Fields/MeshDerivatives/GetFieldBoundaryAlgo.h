@@ -55,6 +55,9 @@ public:
   bool run(FieldHandle input, FieldHandle& output);
 
   AlgorithmOutput run_generic(const AlgorithmInput& input) const;
+
+private:
+  bool runImpl(FieldHandle input, FieldHandle& output, Datatypes::MatrixHandle* mapping) const;
 };
 
 }}}}
@@ -33,12 +33,17 @@
 #include <Core/Datatypes/Legacy/Field/Mesh.h>
 #include <Core/Datatypes/Legacy/Field/VMesh.h>
 #include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Thread/ConcurrentUnionFind.h>
+#include <Core/Thread/Parallel.h>
+
+#include <atomic>
 
 using namespace SCIRun;
 using namespace SCIRun::Core::Algorithms;
 using namespace SCIRun::Core::Algorithms::Fields;
 using namespace SCIRun::Core::Datatypes;
 using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Thread;
 
 AlgorithmInputName SplitFieldByConnectedRegionAlgo::InputField("InputField");
 AlgorithmOutputName SplitFieldByConnectedRegionAlgo::OutputField1("OutputField1");
@@ -123,173 +128,191 @@ std::vector<FieldHandle> SplitFieldByConnectedRegionAlgo::run(FieldHandle input)
   VField* ifield = input->vfield();
   VMesh*  imesh  = input->vmesh();
 
-  VField::index_type k = 0;
-
   VMesh::size_type num_nodes = imesh->num_nodes(); 
   VMesh::size_type num_elems = imesh->num_elems(); 
   
-  VField::size_type surfsize = static_cast<VField::size_type>(pow(num_elems, 2.0 / 3.0));
-  std::vector<VMesh::Elem::index_type> buffer;
-  buffer.reserve(surfsize);
-  
   imesh->synchronize(Mesh::NODE_NEIGHBORS_E|Mesh::ELEM_NEIGHBORS_E|Mesh::DELEMS_E); 
 
-  std::vector<index_type> elemmap(num_elems, 0);
-  std::vector<index_type> nodemap(num_nodes, 0);
-  std::vector<index_type> renumber(num_nodes,0);
-  std::vector<short> visited(num_elems, 0);
+  const int nproc = (num_elems < 10000) ? 1 : static_cast<int>(Parallel::NumCores());
 
-  VMesh::Node::array_type nnodes;
-  VMesh::Elem::array_type neighbors;
- 
-  for (VMesh::Elem::index_type idx=0; idx<num_elems; idx++)
+  /// Elements sharing a node are in the same region: join them in a
+  /// union-find forest, where roots are always the smallest element of
+  /// their tree. This makes the root of a region its first element, which
+  /// numbers the regions in the same order as a serial scan.
+  ConcurrentUnionFind<index_type> regions(num_elems);
+
+  Parallel::RunTasks([&](int proc)
   {
-    // if list of elements to process is empty ad the next one
-    if (buffer.size() == 0)
+    const index_type start = (num_nodes/nproc)*proc;
+    const index_type end = (proc == nproc-1) ? num_nodes : (num_nodes/nproc)*(proc+1);
+    VMesh::Elem::array_type neighbors;
+    for (index_type n = start; n < end; n++)
     {
-      if(visited[idx] == 0) { buffer.push_back(idx); k++; }
+      imesh->get_elems(neighbors,VMesh::Node::index_type(n));
+      for (size_t p=1; p<neighbors.size(); p++)
+        regions.unite(neighbors[0], neighbors[p]);
     }
-    
-    if (buffer.size() > 0)
+  }, nproc);
+
+  /// Number the roots with a prefix sum over the element ranges
+  std::vector<index_type> elemmap(num_elems, 0);
+  std::vector<index_type> root_count(nproc+1, 0);
+  Parallel::RunTasks([&](int proc)
+  {
+    const index_type start = (num_elems/nproc)*proc;
+    const index_type end = (proc == nproc-1) ? num_elems : (num_elems/nproc)*(proc+1);
+    for (index_type e = start; e < end; e++)
+      if (regions.is_root(e)) root_count[proc+1]++;
+  }, nproc);
+  for (int proc = 0; proc < nproc; proc++) root_count[proc+1] += root_count[proc];
+  const size_type k = root_count[nproc];
+
+  Parallel::RunTasks([&](int proc)
+  {
+    const index_type start = (num_elems/nproc)*proc;
+    const index_type end = (proc == nproc-1) ? num_elems : (num_elems/nproc)*(proc+1);
+    index_type next = root_count[proc];
+    for (index_type e = start; e < end; e++)
+      if (regions.is_root(e)) elemmap[e] = ++next;
+  }, nproc);
+
+  Parallel::RunTasks([&](int proc)
+  {
+    const index_type start = (num_elems/nproc)*proc;
+    const index_type end = (proc == nproc-1) ? num_elems : (num_elems/nproc)*(proc+1);
+    for (index_type e = start; e < end; e++)
+      elemmap[e] = elemmap[regions.find(e)];
+  }, nproc);
+
+  /// A node is in the region of its elements, nodes without elements are
+  /// not part of any region
+  std::vector<index_type> nodemap(num_nodes, 0);
+  Parallel::RunTasks([&](int proc)
+  {
+    const index_type start = (num_nodes/nproc)*proc;
+    const index_type end = (proc == nproc-1) ? num_nodes : (num_nodes/nproc)*(proc+1);
+    VMesh::Elem::array_type neighbors;
+    for (index_type n = start; n < end; n++)
     {
-      for (size_t i=0; i< buffer.size(); i++)
-      {
-        VField::index_type j = buffer[i];
-        if (visited[j] > 0) { continue; }
-        visited[j] = 1;
-        
-        imesh->get_nodes(nnodes,buffer[i]);
-        for (size_t q=0; q<nnodes.size(); q++)
-        {
-          imesh->get_elems(neighbors,nnodes[q]);
-          for (size_t p=0; p<neighbors.size(); p++)
-          {
-            if(visited[neighbors[p]] == 0)
-            {
-              buffer.push_back(neighbors[p]);
-              visited[neighbors[p]] = -1;            
-            }
-          }
-        }
-         
-        if (j >= static_cast<index_type>(elemmap.size())) elemmap.resize(j+1);
-        
-        elemmap[j] = k;
-        for (size_t p=0;p<nnodes.size();p++)
-        {
-          if (static_cast<size_t>(nnodes[p]) >= nodemap.size())
-            nodemap.resize(nnodes[p]+1);      
-          nodemap[nnodes[p]] = k;
-        }
-      }
-      buffer.clear();
+      imesh->get_elems(neighbors,VMesh::Node::index_type(n));
+      if (!neighbors.empty()) nodemap[n] = elemmap[neighbors[0]];
     }
-  }
- 
- output.resize(k);
+  }, nproc);
+
+  /// Bucket nodes and elements by region, in increasing order within a region
+  std::vector<index_type> node_offsets(k+1, 0), elem_offsets(k+1, 0);
+  for (index_type q=0; q<num_nodes; q++) if (nodemap[q] > 0) node_offsets[nodemap[q]]++;
+  for (index_type q=0; q<num_elems; q++) elem_offsets[elemmap[q]]++;
   for (size_type p=0; p<k; p++)
   {
-    VField* ofield;
-    VMesh* omesh;
-    MeshHandle mesh;
-    FieldHandle field;
+    node_offsets[p+1] += node_offsets[p];
+    elem_offsets[p+1] += elem_offsets[p];
+  }
+  std::vector<index_type> region_nodes(node_offsets[k]), region_elems(num_elems);
+  {
+    std::vector<index_type> nfill(node_offsets.begin(), node_offsets.end()-1);
+    std::vector<index_type> efill(elem_offsets.begin(), elem_offsets.end()-1);
+    for (index_type q=0; q<num_nodes; q++) if (nodemap[q] > 0) region_nodes[nfill[nodemap[q]-1]++] = q;
+    for (index_type q=0; q<num_elems; q++) region_elems[efill[elemmap[q]-1]++] = q;
+  }
 
-    VField::size_type nn = 0;
-    VField::size_type ne = 0;
-    
-    for (VField::index_type q=0;q<num_nodes;q++) if (nodemap[q] == p+1) nn++;
-    for (VField::index_type q=0;q<num_elems;q++) if (elemmap[q] == p+1) ne++;
-    
-    mesh = CreateMesh(fi);
+  /// Create the output fields up front, the mesh factory is shared
+  output.resize(k);
+  for (size_type p=0; p<k; p++)
+  {
+    MeshHandle mesh = CreateMesh(fi);
     if (!mesh)
     {
       THROW_ALGORITHM_INPUT_ERROR("Could not create output field.");
     }
-    omesh = mesh->vmesh();
-
-    omesh->node_reserve(nn);
-    omesh->elem_reserve(ne);
-
-    field = CreateField(fi,mesh);
+    FieldHandle field = CreateField(fi,mesh);
     if (field == nullptr)
     {
       THROW_ALGORITHM_INPUT_ERROR("Could not create output field");
     }      
-    
-    ofield = field->vfield();
     output[p] = field;
+  }
 
+  /// Extract the regions in parallel, largest first to balance the threads
+  std::vector<index_type> work(k);
+  for (size_type p=0; p<k; p++) work[p] = p;
+  std::sort(work.begin(), work.end(), [&elem_offsets](index_type a, index_type b)
+    { return (elem_offsets[a+1]-elem_offsets[a]) > (elem_offsets[b+1]-elem_offsets[b]); });
+
+  std::vector<index_type> renumber(num_nodes,0);
+  std::vector<double> sizes(k, 0.0);
+  std::atomic<size_type> next_region(0);
+
+  Parallel::RunTasks([&](int)
+  {
+    VMesh::Node::array_type elemnodes;
     Point point;
-    for (index_type q=0;q<num_nodes;q++) 
-    {  
-      if (nodemap[q] == p+1) 
-      {
+    for (size_type w = next_region++; w < k; w = next_region++)
+    {
+      const index_type p = work[w];
+      VMesh*  omesh  = output[p]->vmesh();
+      VField* ofield = output[p]->vfield();
+
+      omesh->node_reserve(node_offsets[p+1]-node_offsets[p]);
+      omesh->elem_reserve(elem_offsets[p+1]-elem_offsets[p]);
+
+      for (index_type r=node_offsets[p]; r<node_offsets[p+1]; r++) 
+      {  
+        const index_type q = region_nodes[r];
         imesh->get_center(point,VMesh::Node::index_type(q));
         renumber[q] = omesh->add_point(point);
       }
-    }
     
-    VMesh::Node::array_type elemnodes;
-    for (index_type q=0;q<num_elems;q++) 
-    {  
-      if (elemmap[q] == p+1) 
-      {   
-        imesh->get_nodes(elemnodes,VMesh::Elem::index_type(q));
-        for (size_t r=0; r< elemnodes.size(); r++)
+      for (index_type r=elem_offsets[p]; r<elem_offsets[p+1]; r++) 
+      {  
+        imesh->get_nodes(elemnodes,VMesh::Elem::index_type(region_elems[r]));
+        for (size_t t=0; t< elemnodes.size(); t++)
         {
-          elemnodes[r] = VMesh::Node::index_type(renumber[elemnodes[r]]);
+          elemnodes[t] = VMesh::Node::index_type(renumber[elemnodes[t]]);
         }
         omesh->add_elem(elemnodes);
       }
-    }
     
-    ofield->resize_fdata();
+      ofield->resize_fdata();
 
-    if (ifield->basis_order() == 1)
-    {
-      VField::index_type qq = 0;
-      for (VField::index_type q=0;q<num_nodes;q++) 
-      {  
-        if (nodemap[q] == p+1) 
-        {
-          ofield->copy_value(ifield,q,qq); qq++;
-        }
+      if (ifield->basis_order() == 1)
+      {
+        VField::index_type qq = 0;
+        for (index_type r=node_offsets[p]; r<node_offsets[p+1]; r++, qq++) 
+          ofield->copy_value(ifield,region_nodes[r],qq);
       }
-    }
     
-    if (ifield->basis_order() == 0)
-    {
-      VField::index_type qq = 0;
-      for (VField::index_type q=0;q<num_elems;q++) 
-      {  
-        if (elemmap[q] == p+1) 
-        {   
-          ofield->copy_value(ifield,q,qq); qq++;
+      if (ifield->basis_order() == 0)
+      {
+        VField::index_type qq = 0;
+        for (index_type r=elem_offsets[p]; r<elem_offsets[p+1]; r++, qq++) 
+          ofield->copy_value(ifield,region_elems[r],qq);
+      }
+
+      if (sortDomainBySize)
+      {
+        VMesh::Elem::size_type num_oelems = omesh->num_elems();
+        double size = 0.0;
+        for (VMesh::Elem::index_type idx=0; idx<num_oelems; idx++)
+        {
+          size += omesh->get_size(idx);
         }
-      }    
-    }
+        sizes[p] = size;
+      }
    
-   #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
-    ofield->copy_properties(ifield);
-   #endif
-  }
+     #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
+      ofield->copy_properties(ifield);
+     #endif
+    }
+  }, std::max(1, std::min(nproc, static_cast<int>(k))));
 
   if (sortDomainBySize)
   {
-    std::vector<double> sizes(output.size());
     std::vector<index_type> order(output.size());
     std::vector<FieldHandle> temp(output.size());
     
     for (size_t j=0; j<output.size(); j++)
     {
-      VMesh* mesh = output[j]->vmesh();
-      VMesh::Elem::size_type num_elems = mesh->num_elems();
-      double size = 0.0;
-      for (VMesh::Elem::index_type idx=0; idx<num_elems; idx++)
-      {
-        size += mesh->get_size(idx);
-      }
-      sizes[j] = size;
       order[j] = j;
       temp[j] = output[j];
     }
@@ -0,0 +1,191 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+   */
+
+
+#ifndef CORE_ALGORITHMS_FIELDS_REFINEMESH_EDGESPLITTABLE_H
+#define CORE_ALGORITHMS_FIELDS_REFINEMESH_EDGESPLITTABLE_H 1
+
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/Legacy/Field/Mesh.h>
+#include <Core/Thread/Parallel.h>
+#include <functional>
+#include <vector>
+
+namespace SCIRun{
+  namespace Core{
+    namespace Algorithms{
+      namespace Fields{
+
+        /// Midpoint nodes of the split edges of a mesh, stored flat by edge
+        /// index. An edge is split when one of its nodes is selected. The
+        /// new nodes are numbered after the nodes of the mesh, in edge order,
+        /// so the result is the same as adding them in a serial edge loop.
+        class EdgeSplitTable
+        {
+        public:
+          EdgeSplitTable(VMesh* mesh, const std::vector<bool>& selected, int nproc) :
+            nodes_(mesh->num_edges(), 0)
+          {
+            const VMesh::size_type num_nodes = mesh->num_nodes();
+            const VMesh::size_type num_edges = mesh->num_edges();
+            std::vector<VMesh::size_type> count(nproc+1, 0);
+
+            Thread::Parallel::RunTasks([&](int proc)
+            {
+              const index_type start = (num_edges/nproc)*proc;
+              const index_type end = (proc == nproc-1) ? num_edges : (num_edges/nproc)*(proc+1);
+              VMesh::Node::array_type nodes;
+              for (VMesh::Edge::index_type idx = start; idx < end; idx++)
+              {
+                mesh->get_nodes(nodes,idx);
+                if (selected[nodes[0]] || selected[nodes[1]])
+                {
+                  nodes_[idx] = 1;
+                  count[proc+1]++;
+                }
+              }
+            }, nproc);
+
+            for (int proc = 0; proc < nproc; proc++) count[proc+1] += count[proc];
+            first_.resize(count[nproc]);
+            second_.resize(count[nproc]);
+            points_.resize(count[nproc]);
+
+            Thread::Parallel::RunTasks([&](int proc)
+            {
+              const index_type start = (num_edges/nproc)*proc;
+              const index_type end = (proc == nproc-1) ? num_edges : (num_edges/nproc)*(proc+1);
+              VMesh::Node::array_type nodes;
+              Geometry::Point p0, p1;
+              index_type k = count[proc];
+              for (VMesh::Edge::index_type idx = start; idx < end; idx++)
+              {
+                if (nodes_[idx] == 0) continue;
+                mesh->get_nodes(nodes,idx);
+                mesh->get_center(p0,nodes[0]);
+                mesh->get_center(p1,nodes[1]);
+                first_[k] = nodes[0];
+                second_[k] = nodes[1];
+                points_[k] = Geometry::Point((p0 + p1)*0.5);
+                nodes_[idx] = num_nodes + k;
+                k++;
+              }
+            }, nproc);
+          }
+
+          /// New node on an edge, 0 if the edge is not split
+          VMesh::index_type operator[](VMesh::index_type edge) const { return nodes_[edge]; }
+
+          /// Points of the new nodes, in node order
+          const std::vector<Geometry::Point>& points() const { return points_; }
+
+          /// Append the interpolated values of the new nodes to node values
+          void interpolate(std::vector<double>& values) const
+          {
+            const size_t offset = values.size();
+            values.resize(offset + points_.size());
+            for (size_t k = 0; k < points_.size(); k++)
+              values[offset+k] = 0.5*(values[first_[k]] + values[second_[k]]);
+          }
+
+        private:
+          std::vector<VMesh::index_type> nodes_;
+          std::vector<VMesh::index_type> first_;
+          std::vector<VMesh::index_type> second_;
+          std::vector<Geometry::Point>   points_;
+        };
+
+        typedef std::function<void(const VMesh::Node::array_type&)> child_emitter_type;
+
+        /// Add the children of all elements to the refined mesh, in element
+        /// order. refine(elem, emit) is run twice for each element, once to
+        /// count the children and once to store them in a preallocated
+        /// array, so it must not change any state other than through emit.
+        /// parents receives the element each child was made from.
+        template <class Refine>
+        void refine_elements(VMesh* mesh, VMesh* refined, int nproc, Refine refine,
+          std::vector<VMesh::index_type>& parents)
+        {
+          const VMesh::size_type num_elems = mesh->num_elems();
+          const size_t npe = refined->num_nodes_per_elem();
+          std::vector<VMesh::index_type> offsets(num_elems+1, 0);
+
+          Thread::Parallel::RunTasks([&](int proc)
+          {
+            const index_type start = (num_elems/nproc)*proc;
+            const index_type end = (proc == nproc-1) ? num_elems : (num_elems/nproc)*(proc+1);
+            VMesh::index_type n = 0;
+            child_emitter_type count = [&n](const VMesh::Node::array_type&) { n++; };
+            for (VMesh::Elem::index_type idx = start; idx < end; idx++)
+            {
+              n = 0;
+              refine(idx, count);
+              offsets[idx+1] = n;
+            }
+          }, nproc);
+
+          for (VMesh::index_type idx = 0; idx < num_elems; idx++) offsets[idx+1] += offsets[idx];
+          const VMesh::size_type num_children = offsets[num_elems];
+
+          std::vector<VMesh::index_type> children(npe*num_children);
+          parents.resize(num_children);
+
+          Thread::Parallel::RunTasks([&](int proc)
+          {
+            const index_type start = (num_elems/nproc)*proc;
+            const index_type end = (proc == nproc-1) ? num_elems : (num_elems/nproc)*(proc+1);
+            VMesh::index_type child = 0;
+            VMesh::index_type parent = 0;
+            child_emitter_type store = [&](const VMesh::Node::array_type& nodes)
+            {
+              for (size_t j = 0; j < npe; j++) children[npe*child+j] = nodes[j];
+              parents[child++] = parent;
+            };
+            for (VMesh::Elem::index_type idx = start; idx < end; idx++)
+            {
+              child = offsets[idx];
+              parent = idx;
+              refine(idx, store);
+            }
+          }, nproc);
+
+          refined->elem_reserve(num_children);
+          VMesh::Node::array_type nodes(npe);
+          for (VMesh::index_type child = 0; child < num_children; child++)
+          {
+            for (size_t j = 0; j < npe; j++) nodes[j] = children[npe*child+j];
+            refined->add_elem(nodes);
+          }
+        }
+
+      }
+    }
+  }
+}
+
+#endif
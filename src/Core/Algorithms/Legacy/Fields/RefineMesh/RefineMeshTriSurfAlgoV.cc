@@ -37,6 +37,8 @@
 #include <Core/Datatypes/Legacy/Field/FieldInformation.h>
 #include <Core/Algorithms/Base/AlgorithmPreconditions.h>
 #include <Core/Algorithms/Base/AlgorithmVariableNames.h>
+#include <Core/Algorithms/Legacy/Fields/RefineMesh/EdgeSplitTable.h>
+#include <Core/Thread/Parallel.h>
 
 //STL classes needed
 #include <algorithm>
@@ -50,6 +52,7 @@ using namespace SCIRun::Core::Algorithms::Fields;
 using namespace SCIRun::Core::Datatypes;
 using namespace SCIRun::Core::Geometry;
 using namespace SCIRun::Core::Logging;
+using namespace SCIRun::Core::Thread;
 
 RefineMeshTriSurfAlgoV::RefineMeshTriSurfAlgoV()
 {
@@ -180,9 +183,14 @@ RefineMeshTriSurfAlgoV::runImpl(FieldHandle input, FieldHandle& output,
     for (size_t j=0;j<values.size();j++) values[j] = true;
   }
   
+  const int nproc = (num_elems < 10000) ? 1 : static_cast<int>(Parallel::NumCores());
+
   // Copy all of the nodes from mesh to refined.  They won't change,
-  // we only add nodes.
-  
+  // we only add nodes. The edges that need to be split get their new
+  // node from a flat table indexed by the edge number.
+  EdgeSplitTable edge_nodes(mesh, values, nproc);
+  refined->node_reserve(num_nodes + edge_nodes.points().size());
+
   VMesh::Node::iterator bni, eni;
   mesh->begin(bni); mesh->end(eni);
   while (bni != eni)
@@ -193,76 +201,45 @@ RefineMeshTriSurfAlgoV::runImpl(FieldHandle input, FieldHandle& output,
     ++bni;
   }
 
-  std::vector<VMesh::index_type> enodes(mesh->num_edges(),0);
-
-  VMesh::Node::array_type nodes(2);
-  Point p0, p1,p2, p3, p;
-  VMesh::Edge::iterator be, ee;
-  mesh->begin(be); mesh->end(ee);
-
-  // add all additional nodes we need
-  while (be != ee)
+  for (size_t k = 0; k < edge_nodes.points().size(); k++)
   {
-    mesh->get_nodes(nodes,*be);
-    if ((values[nodes[0]] == true) || (values[nodes[1]] == true))
-    {
-      mesh->get_center(p0,nodes[0]);
-      mesh->get_center(p1,nodes[1]);
-    
-      p = Point((p0 + p1)*0.5);
-    
-      enodes[*be] = refined->add_point(p);
-      if (field->basis_order() == 1) 
-        ivalues.push_back(0.5*(ivalues[nodes[0]]+ivalues[nodes[1]]));
-    }
-    ++be;
+    refined->add_point(edge_nodes.points()[k]);
   }
+  if (field->basis_order() == 1) edge_nodes.interpolate(ivalues);
 
-
-  VMesh::Edge::array_type oedges(3);
-  VMesh::Node::array_type nnodes(3);
-
-  VMesh::Elem::iterator bi, ei;
-  mesh->begin(bi); mesh->end(ei);
-
-  unsigned int cnt = 0;
-  unsigned int loopcnt = 0;
-
-  VMesh::Elem::size_type sz; mesh->size(sz);
-
-  while (bi != ei)
+  std::vector<VMesh::index_type> parents;
+  refine_elements(mesh, refined, nproc, [&](VMesh::Elem::index_type idx, const child_emitter_type& add_elem)
   {
-			cnt++; if (cnt == 100) { loopcnt +=cnt; cnt = 0; this->update_progress_max(loopcnt,sz); }
+    VMesh::Node::array_type elemnodes(3), nnodes(3);
+    VMesh::Edge::array_type oedges(3);
 
-    mesh->get_nodes(onodes, *bi);
-    mesh->get_edges(oedges, *bi);
+    mesh->get_nodes(elemnodes, idx);
+    mesh->get_edges(oedges, idx);
 
-    VMesh::index_type i0 = onodes[0];
-    VMesh::index_type i1 = onodes[1];
-    VMesh::index_type i2 = onodes[2];
-    VMesh::index_type i3 = enodes[oedges[0]];
-    VMesh::index_type i4 = enodes[oedges[1]];
-    VMesh::index_type i5 = enodes[oedges[2]];
+    VMesh::index_type i0 = elemnodes[0];
+    VMesh::index_type i1 = elemnodes[1];
+    VMesh::index_type i2 = elemnodes[2];
+    VMesh::index_type i3 = edge_nodes[oedges[0]];
+    VMesh::index_type i4 = edge_nodes[oedges[1]];
+    VMesh::index_type i5 = edge_nodes[oedges[2]];
 
     if (i3==0 && i4 == 0 && i5 == 0)
     {
-      refined->add_elem(onodes);
-      if (field->basis_order() == 0) evalues.push_back(ivalues[*bi]); 
+      add_elem(elemnodes);
     }
     else if (i3 > 0 && i4 > 0 && i5 > 0)
     {
       nnodes[0] =i0; nnodes[1] = i3; nnodes[2] = i5;
-      refined->add_elem(nnodes);
+      add_elem(nnodes);
 
       nnodes[0] = i3; nnodes[1] = i1; nnodes[2] = i4;
-      refined->add_elem(nnodes);
+      add_elem(nnodes);
 
       nnodes[0] = i4; nnodes[1] = i2; nnodes[2] = i5;
-      refined->add_elem(nnodes);
-    
+      add_elem(nnodes);
+  
       nnodes[0] = i3; nnodes[1] = i4; nnodes[2] = i5;
-      refined->add_elem(nnodes);
-      if (field->basis_order() == 0) evalues.insert(evalues.end(),4,ivalues[*bi]); 
+      add_elem(nnodes);
     }
     else if (i3 == 0)
     {
@@ -275,26 +252,25 @@ RefineMeshTriSurfAlgoV::runImpl(FieldHandle input, FieldHandle& output,
       if ((p0-p4).length2() < (p1-p5).length2())
       {
         nnodes[0] =i4; nnodes[1] = i2; nnodes[2] = i5;
-        refined->add_elem(nnodes);
+        add_elem(nnodes);
 
         nnodes[0] =i4; nnodes[1] = i5; nnodes[2] = i0;
-        refined->add_elem(nnodes);
-      
+        add_elem(nnodes);
+    
         nnodes[0] =i0; nnodes[1] = i1; nnodes[2] = i4;
-        refined->add_elem(nnodes);
+        add_elem(nnodes);
       }
       else
       {
         nnodes[0] =i4; nnodes[1] = i2; nnodes[2] = i5;
-        refined->add_elem(nnodes);
+        add_elem(nnodes);
 
         nnodes[0] =i4; nnodes[1] = i5; nnodes[2] = i1;
-        refined->add_elem(nnodes);
-      
+        add_elem(nnodes);
+    
         nnodes[0] =i0; nnodes[1] = i1; nnodes[2] = i5;
-        refined->add_elem(nnodes);      
+        add_elem(nnodes);      
       }
-      if (field->basis_order() == 0) evalues.insert(evalues.end(),3,ivalues[*bi]); 
     }
     else if (i4 == 0)
     {
@@ -307,26 +283,25 @@ RefineMeshTriSurfAlgoV::runImpl(FieldHandle input, FieldHandle& output,
       if ((p1-p5).length2() < (p2-p3).length2())
       {   
         nnodes[0] =i0; nnodes[1] = i3; nnodes[2] = i5;
-        refined->add_elem(nnodes);
+        add_elem(nnodes);
 
         nnodes[0] =i3; nnodes[1] = i1; nnodes[2] = i5;
-        refined->add_elem(nnodes);
-      
+        add_elem(nnodes);
+    
         nnodes[0] =i1; nnodes[1] = i2; nnodes[2] = i5;
-        refined->add_elem(nnodes);
+        add_elem(nnodes);
       }
       else
       {
         nnodes[0] =i0; nnodes[1] = i3; nnodes[2] = i5;
-        refined->add_elem(nnodes);
+        add_elem(nnodes);
 
         nnodes[0] =i3; nnodes[1] = i2; nnodes[2] = i5;
-        refined->add_elem(nnodes);
-      
+        add_elem(nnodes);
+    
         nnodes[0] =i1; nnodes[1] = i2; nnodes[2] = i3;
-        refined->add_elem(nnodes);      
+        add_elem(nnodes);      
       }
-      if (field->basis_order() == 0) evalues.insert(evalues.end(),3,ivalues[*bi]); 
     }
     else if (i5 == 0)
     {
@@ -339,29 +314,34 @@ RefineMeshTriSurfAlgoV::runImpl(FieldHandle input, FieldHandle& output,
       if ((p2-p3).length2() < (p0-p4).length2())
       {   
         nnodes[0] =i1; nnodes[1] = i4; nnodes[2] = i3;
-        refined->add_elem(nnodes);
+        add_elem(nnodes);
 
         nnodes[0] =i3; nnodes[1] = i2; nnodes[2] = i0;
-        refined->add_elem(nnodes);
-      
+        add_elem(nnodes);
+    
         nnodes[0] =i2; nnodes[1] = i3; nnodes[2] = i4;
-        refined->add_elem(nnodes);
+        add_elem(nnodes);
       }
       else
       {
         nnodes[0] =i1; nnodes[1] = i4; nnodes[2] = i3;
-        refined->add_elem(nnodes);
+        add_elem(nnodes);
 
         nnodes[0] =i4; nnodes[1] = i2; nnodes[2] = i0;
-        refined->add_elem(nnodes);
-      
+        add_elem(nnodes);
+    
         nnodes[0] =i0; nnodes[1] = i3; nnodes[2] = i4;
-        refined->add_elem(nnodes);      
+        add_elem(nnodes);      
       }
-      if (field->basis_order() == 0) evalues.insert(evalues.end(),3,ivalues[*bi]); 
     }
-    ++bi;
-		}
+  }, parents);
+
+  if (field->basis_order() == 0)
+  {
+    evalues.resize(parents.size());
+    for (size_t k = 0; k < parents.size(); k++) evalues[k] = ivalues[parents[k]];
+  }
+  this->update_progress_max(1,1);
 
   rfield->resize_values();
   if (rfield->basis_order() == 0) rfield->set_values(evalues);
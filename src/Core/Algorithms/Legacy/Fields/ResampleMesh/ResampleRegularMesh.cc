@@ -26,23 +26,29 @@
    DEALINGS IN THE SOFTWARE.
 */
 
-
 #include <Core/Algorithms/Legacy/Fields/ResampleMesh/ResampleRegularMesh.h>
 #include <Core/Algorithms/Base/AlgorithmVariableNames.h>
 #include <Core/Algorithms/Base/AlgorithmPreconditions.h>
 #include <Core/Logging/Log.h>
+#include <Core/Thread/Parallel.h>
 
 #include <Core/Datatypes/Legacy/Field/Field.h>
 #include <Core/Datatypes/Legacy/Field/VField.h>
 #include <Core/Datatypes/Legacy/Field/FieldInformation.h>
 
-#include <teem/nrrd.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
 
 using namespace SCIRun;
 using namespace SCIRun::Core::Algorithms;
 using namespace SCIRun::Core::Algorithms::Fields;
 using namespace SCIRun::Core::Datatypes;
 using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Logging;
+using namespace SCIRun::Core::Thread;
+
 using namespace SCIRun::Core::Logging;
 
 ALGORITHM_PARAMETER_DEF(Fields, ResampleMethod);
@@ -73,8 +79,272 @@ ResampleRegularMeshAlgo::ResampleRegularMeshAlgo()
   addParameter(Parameters::ResampleZDimUseScalingFactor, true);
 }
 
+
+namespace
+{
+  // Resampling kernels and sampling rules of Teem's nrrdSpatialResample, which
+  // this algorithm used before: cell centered samples, bleeding at the
+  // boundaries, kernel stretched when downsampling and weights renormalized.
+  class ResampleKernel
+  {
+  public:
+    enum Type { BOX, TENT, BCCUBIC, GAUSSIAN, AQUARTIC };
+
+    ResampleKernel(Type type, double p0, double p1 = 0.0, double p2 = 0.0) : type_(type)
+    {
+      parm_[0] = p0; parm_[1] = p1; parm_[2] = p2;
+    }
+
+    double support() const
+    {
+      switch (type_)
+      {
+        case BOX:      return parm_[0]/2 + 0.5;
+        case TENT:     return parm_[0];
+        case BCCUBIC:  return 2*parm_[0];
+        case GAUSSIAN: return parm_[0]*parm_[1];
+        default:       return 3*parm_[0];
+      }
+    }
+
+    bool integrates() const
+    {
+      return type_ != GAUSSIAN || parm_[1] != 0.0;
+    }
+
+    double eval(double x, double scale) const
+    {
+      x = std::abs(x);
+      switch (type_)
+      {
+        case BOX:
+          x /= scale;
+          return (x > 0.5 ? 0 : (x < 0.5 ? 1 : 0.5))/scale;
+        case TENT:
+          x /= scale;
+          return scale ? (x >= 1 ? 0 : 1 - x)/scale : x == 0;
+        case BCCUBIC:
+        {
+          const double B = parm_[1], C = parm_[2];
+          x /= scale;
+          return (x >= 2.0 ? 0 :
+            (x >= 1.0
+             ? (((-B/6 - C)*x + B + 5*C)*x -2*B - 8*C)*x + 4*B/3 + 4*C
+             : ((2 - 3*B/2 - C)*x - 3 + 2*B + C)*x*x + 1 - B/3))/scale;
+        }
+        case GAUSSIAN:
+        {
+          const double sig = scale, cut = parm_[1];
+          return x >= sig*cut ? 0 : std::exp(-x*x/(2.0*sig*sig))/(sig*2.50662827463100050241);
+        }
+        default:
+        {
+          const double A = parm_[1];
+          x /= scale;
+          return (x >= 3.0 ? 0 :
+            (x >= 2.0
+             ? A*(-54 + x*(81 + x*(-45 + x*(11 - x))))
+             : (x >= 1.0
+                ? 4 - 6*A + x*(-10 + 25*A + x*(9 - 33*A + x*(-3.5 + 17*A + x*(0.5 - 3*A))))
+                : 1 + x*x*(-3 + 6*A + x*((2.5 - 10*A) + x*(-0.5 + 4*A))))))/scale;
+        }
+      }
+    }
+
+    double scale() const { return parm_[0]; }
+
+  private:
+    Type type_;
+    double parm_[3];
+  };
+
+  // Input samples and weights for every output sample along one axis
+  struct AxisWeights
+  {
+    size_t dotLen;
+    std::vector<size_t> index;
+    std::vector<double> weight;
+  };
+
+  // Sample positions are computed in world space along an axis of the given
+  // length, as Teem does, so that samples falling on a kernel boundary get the
+  // same weights.
+  void make_axis_weights(AxisWeights& w, const ResampleKernel& kernel, size_t sizeIn, size_t sizeOut, double length)
+  {
+    if (!(length > 0.0)) length = 1.0;
+    const double ratio = (length/sizeIn)/(length/sizeOut);
+    const double support = kernel.support();
+    // Downsampling uses all the input samples covered by the stretched kernel
+    w.dotLen = static_cast<size_t>(2*std::ceil(ratio > 1 ? support : support/ratio));
+    const double scale = (ratio < 1) ? kernel.scale()/ratio : kernel.scale();
+    const long long halfLen = static_cast<long long>(w.dotLen/2);
+    const long long last = static_cast<long long>(sizeIn) - 1;
+
+    w.index.resize(sizeOut*w.dotLen);
+    w.weight.resize(sizeOut*w.dotLen);
+    for (size_t i = 0; i < sizeOut; i++)
+    {
+      const double pos = length*(i + 0.5)/sizeOut;
+      const double idxD = sizeIn*pos/length - 0.5;
+      const long long base = static_cast<long long>(std::floor(idxD)) - halfLen + 1;
+      size_t* index = &w.index[i*w.dotLen];
+      double* weight = &w.weight[i*w.dotLen];
+      double sum = 0.0;
+      for (size_t e = 0; e < w.dotLen; e++)
+      {
+        const long long idx = base + static_cast<long long>(e);
+        weight[e] = kernel.eval(idxD - idx, scale);
+        index[e] = static_cast<size_t>(std::min(std::max(idx, 0LL), last));
+        sum += weight[e];
+      }
+      if (kernel.integrates() && sum != 0.0)
+      {
+        const double norm = 1.0/sum;
+        for (size_t e = 0; e < w.dotLen; e++) weight[e] *= norm;
+      }
+    }
+  }
+
+  // Final values are rounded and clamped to the range of the field type
+  template <class T>
+  struct StoreValue
+  {
+    T operator()(double v) const
+    {
+      if (std::numeric_limits<T>::is_integer) v = std::floor(v + 0.5);
+      v = std::min(std::max(v, static_cast<double>(std::numeric_limits<T>::lowest())),
+        static_cast<double>(std::numeric_limits<T>::max()));
+      return static_cast<T>(v);
+    }
+  };
+
+  template <>
+  struct StoreValue<double>
+  {
+    double operator()(double v) const { return v; }
+  };
+
+  // Resample the middle axis of an [outer][sizeIn][stride] array. The sums over
+  // the kernel are taken for a block of the contiguous stride dimension at once,
+  // and the (outer, block) pairs are split over the threads.
+  template <class TIn, class TOut>
+  void resample_axis(const TIn* in, TOut* out, size_t outer, size_t sizeIn, size_t sizeOut,
+    size_t stride, const AxisWeights& w, int nproc)
+  {
+    const size_t blockSize = std::min<size_t>(stride, 1024);
+    const size_t numBlocks = (stride + blockSize - 1)/blockSize;
+    const size_t numUnits = outer*numBlocks;
+    const size_t dotLen = w.dotLen;
+    StoreValue<TOut> store;
+
+    Parallel::RunTasks([&](int proc)
+    {
+      std::vector<double> acc(blockSize);
+      const size_t start = numUnits*proc/nproc;
+      const size_t end = numUnits*(proc+1)/nproc;
+      for (size_t unit = start; unit < end; unit++)
+      {
+        const size_t o = unit/numBlocks;
+        const size_t s0 = (unit%numBlocks)*blockSize;
+        const size_t len = std::min(blockSize, stride - s0);
+        const TIn* src = in + o*sizeIn*stride + s0;
+        TOut* dst = out + o*sizeOut*stride + s0;
+
+        if (stride == 1)
+        {
+          // scanline along the contiguous axis
+          for (size_t i = 0; i < sizeOut; i++)
+          {
+            const size_t* index = &w.index[i*dotLen];
+            const double* weight = &w.weight[i*dotLen];
+            double v = 0.0;
+            for (size_t e = 0; e < dotLen; e++)
+              v += static_cast<double>(src[index[e]])*weight[e];
+            dst[i] = store(v);
+          }
+          continue;
+        }
+
+        for (size_t i = 0; i < sizeOut; i++)
+        {
+          const size_t* index = &w.index[i*dotLen];
+          const double* weight = &w.weight[i*dotLen];
+          double* a = &acc[0];
+          std::fill(a, a + len, 0.0);
+          for (size_t e = 0; e < dotLen; e++)
+          {
+            const TIn* line = src + index[e]*stride;
+            const double we = weight[e];
+            for (size_t s = 0; s < len; s++)
+              a[s] += static_cast<double>(line[s])*we;
+          }
+          TOut* d = dst + i*stride;
+          for (size_t s = 0; s < len; s++)
+            d[s] = store(a[s]);
+        }
+      }
+    }, nproc);
+  }
+
+  // Separable resampling of a regular grid with ncomp interleaved components per
+  // value, one axis at a time. Intermediate results are kept in double precision,
+  // the first pass reads the field values and the last one writes the output values.
+  template <class T, class Progress>
+  void resample_grid(const T* in, T* out, size_t ncomp, const std::vector<size_t>& sizesIn,
+    const std::vector<size_t>& sizesOut, const std::vector<double>& lengths, const ResampleKernel& kernel,
+    Progress progress)
+  {
+    const size_t naxes = sizesIn.size();
+    std::vector<size_t> sizes(sizesIn);
+    std::vector<double> src, dst;
+
+    for (size_t a = 0; a < naxes; a++)
+    {
+      size_t stride = ncomp, outer = 1;
+      for (size_t b = 0; b < a; b++) stride *= sizes[b];
+      for (size_t b = a+1; b < naxes; b++) outer *= sizes[b];
+
+      AxisWeights w;
+      make_axis_weights(w, kernel, sizes[a], sizesOut[a], lengths[a]);
+
+      const size_t numOut = outer*sizesOut[a]*stride;
+      const int nproc = (numOut*w.dotLen < 100000) ? 1 : static_cast<int>(Parallel::NumCores());
+
+      const bool first = (a == 0), last = (a == naxes-1);
+      if (first && last)
+        resample_axis(in, out, outer, sizes[a], sizesOut[a], stride, w, nproc);
+      else if (first)
+      {
+        dst.resize(numOut);
+        resample_axis(in, &dst[0], outer, sizes[a], sizesOut[a], stride, w, nproc);
+      }
+      else if (last)
+        resample_axis(&src[0], out, outer, sizes[a], sizesOut[a], stride, w, nproc);
+      else
+      {
+        dst.resize(numOut);
+        resample_axis(&src[0], &dst[0], outer, sizes[a], sizesOut[a], stride, w, nproc);
+      }
+      src.swap(dst);
+      std::vector<double>().swap(dst);
+
+      sizes[a] = sizesOut[a];
+      progress(a+1, naxes);
+    }
+  }
+
+  template <class T, class Progress>
+  void resample_values(VField* in, VField* out, const std::vector<size_t>& sizesIn,
+    const std::vector<size_t>& sizesOut, const std::vector<double>& lengths, const ResampleKernel& kernel,
+    Progress progress)
+  {
+    resample_grid(static_cast<const T*>(in->get_values_pointer()), static_cast<T*>(out->get_values_pointer()),
+      1, sizesIn, sizesOut, lengths, kernel, progress);
+  }
+}
+
 ///////////////////////////////////////////////////////
-// Refine elements for a TetVol 
+// Resample a regular grid with a separable kernel
 
 bool  
 ResampleRegularMeshAlgo::runImpl(FieldHandle input, FieldHandle& output) const
@@ -94,295 +364,122 @@ ResampleRegularMeshAlgo::runImpl(FieldHandle input, FieldHandle& output) const
     error("This algorithm only operates on regular grids");
     return (false);
   }
-  
-  // Convert data to nrrd and run through teem resampler
-  Nrrd* nin;
-  Nrrd* nout;
-
-  VField::size_type num_values = input->vfield()->num_values();
-
-  nin = nrrdNew();
-  nout = nrrdNew();
-
-  // Determine dimensions
-  size_t nrrddims[NRRD_DIM_MAX];
-  int nrrddim = 0;
-  bool nrrdoffset = 0;
-
-  VMesh::dimension_type dims;
 
   VMesh*  vmesh  = input->vmesh();
   VField* vfield = input->vfield();
 
-  if (vfield->is_vector())
-  {
-    nrrddims[0] = 3; nrrddim = 1; nrrdoffset = 1;
-  }
-  else if (vfield->is_tensor())
-  {
-    nrrddims[0] = 6; nrrddim = 1; nrrdoffset = 1;
-  }
-  
+  VMesh::dimension_type dims;
   if (fi.is_lineardata()) vmesh->get_dimensions(dims);  
   else vmesh->get_elem_dimensions(dims);
 
-  int dimsSize = static_cast<int>(dims.size());
-  for (int k = nrrddim; k < nrrddim + dimsSize; k++)
-    nrrddims[k] = dims[k-nrrddim];
-  nrrddim += dimsSize;
-  
-  if (vfield->is_char())
-  {
-    nrrdAlloc_nva(nin,nrrdTypeChar,nrrddim,nrrddims);
-    vfield->get_values(reinterpret_cast<char *>(nin->data),num_values);
-  }
-  else if (vfield->is_unsigned_char())
-  {
-    nrrdAlloc_nva(nin,nrrdTypeUChar,nrrddim,nrrddims);
-    vfield->get_values(reinterpret_cast<unsigned char *>(nin->data),num_values);
-  }
-  else if (vfield->is_short())
-  {
-    nrrdAlloc_nva(nin,nrrdTypeShort,nrrddim,nrrddims);
-    vfield->get_values(reinterpret_cast<short *>(nin->data),num_values);
-  }
-  else if (vfield->is_unsigned_short())
-  {
-    nrrdAlloc_nva(nin,nrrdTypeUShort,nrrddim,nrrddims);
-    vfield->get_values(reinterpret_cast<unsigned short *>(nin->data),num_values);
-  }  
-  else if (vfield->is_int())
-  {
-    nrrdAlloc_nva(nin,nrrdTypeInt,nrrddim,nrrddims);
-    vfield->get_values(reinterpret_cast<int *>(nin->data),num_values);
-  }
-  else if (vfield->is_unsigned_int())
-  {
-    nrrdAlloc_nva(nin,nrrdTypeUInt,nrrddim,nrrddims);
-    vfield->get_values(reinterpret_cast<unsigned int *>(nin->data),num_values);
-  }
-  else if (vfield->is_long())
-  {
-    nrrdAlloc_nva(nin,nrrdTypeLLong,nrrddim,nrrddims);
-    vfield->get_values(reinterpret_cast<long long *>(nin->data),num_values);
-  }
-  else if (vfield->is_unsigned_long())
-  {
-    nrrdAlloc_nva(nin,nrrdTypeULLong,nrrddim,nrrddims);
-    vfield->get_values(reinterpret_cast<unsigned long long *>(nin->data),num_values);
-  }  
-  else if (vfield->is_longlong())
-  {
-    nrrdAlloc_nva(nin,nrrdTypeLLong,nrrddim,nrrddims);
-    vfield->get_values(reinterpret_cast<long long *>(nin->data),num_values);
-  }
-  else if (vfield->is_unsigned_longlong())
-  {
-    nrrdAlloc_nva(nin,nrrdTypeULLong,nrrddim,nrrddims);
-    vfield->get_values(reinterpret_cast<unsigned long long *>(nin->data),num_values);
-  }  
-  else if (vfield->is_float())
-  {
-    nrrdAlloc_nva(nin,nrrdTypeFloat,nrrddim,nrrddims);
-    vfield->get_values(reinterpret_cast<float *>(nin->data),num_values);
-  }
-  else if (vfield->is_double())
-  {
-    nrrdAlloc_nva(nin,nrrdTypeDouble,nrrddim,nrrddims);
-    vfield->get_values(reinterpret_cast<double *>(nin->data),num_values);
-  }  
-  else if (vfield->is_vector())
-  {
-    nrrdAlloc_nva(nin,nrrdTypeDouble,nrrddim,nrrddims);
-    double* ptr = reinterpret_cast<double *>(nin->data);
-    size_t k = 0;
-    for (VField::index_type idx=0; idx<num_values; idx++)
-    {
-      Vector v;
-      vfield->get_value(v,idx);
-      ptr[k] = v.x(); ptr[k+1] = v.y(); ptr[k+2] = v.z();
-      k += 3;
-    }
-  }
-  else if (vfield->is_tensor())
-  {
-    nrrdAlloc_nva(nin,nrrdTypeDouble,nrrddim,nrrddims);
-    double* ptr = reinterpret_cast<double *>(nin->data);
-    size_t k = 0;
-    for (VField::index_type idx=0; idx<num_values; idx++)
-    {
-      Tensor v;
-      vfield->get_value(v,idx);
-      ptr[k  ] = v.xx(); ptr[k+1] = v.xy(); ptr[k+2] = v.xz();
-      ptr[k+3] = v.yy(); ptr[k+4] = v.yz(); ptr[k+5] = v.zz();
-      k += 6;
-    }
-  }  
-  else
+  std::vector<size_t> sizesIn(dims.begin(), dims.end());
+  size_t num_values = 1;
+  for (size_t k = 0; k < sizesIn.size(); k++) num_values *= sizesIn[k];
+
+  if (sizesIn.empty() || num_values == 0 || static_cast<size_t>(vfield->num_values()) != num_values)
   {
-    error("Unknown datatype.");
-    return (false);  
+    error("Field values do not match the grid dimensions.");
+    return (false);
   }
-  
-  NrrdKernel *kern = 0;
-  
-  double param[NRRD_KERNEL_PARMS_NUM]; param[0] =  1.0;
-  for (int j=1; j<NRRD_KERNEL_PARMS_NUM; j++) param[j] = 0.0;
-  
+
+  ResampleKernel kernel(ResampleKernel::BOX, 1.0);
   if (check_option(Parameters::ResampleMethod,"Box")) 
   {
-    kern = nrrdKernelBox;
+    kernel = ResampleKernel(ResampleKernel::BOX, 1.0);
   } 
   else if (check_option(Parameters::ResampleMethod,"Tent"))
   {
-    kern = nrrdKernelTent;
+    kernel = ResampleKernel(ResampleKernel::TENT, 1.0);
   } 
   else if (check_option(Parameters::ResampleMethod,"Cubic (Catmull-Rom)")) 
   { 
-    kern = nrrdKernelBCCubic; 
-    param[1] = 0.0; 
-    param[2] = 0.5; 
+    kernel = ResampleKernel(ResampleKernel::BCCUBIC, 1.0, 0.0, 0.5);
   } 
   else if (check_option(Parameters::ResampleMethod,"Cubic (B-Spline)"))
   { 
-    kern = nrrdKernelBCCubic; 
-    param[1] = 1.0; 
-    param[2] = 0.0; 
+    kernel = ResampleKernel(ResampleKernel::BCCUBIC, 1.0, 1.0, 0.0);
   } 
   else if (check_option(Parameters::ResampleMethod,"Gaussian"))
   { 
-    kern = nrrdKernelGaussian; 
-    param[0] = get(Parameters::ResampleGaussianSigma).toDouble(); 
-    param[1] = get(Parameters::ResampleGaussianExtend).toDouble(); 
+    kernel = ResampleKernel(ResampleKernel::GAUSSIAN, get(Parameters::ResampleGaussianSigma).toDouble(),
+      get(Parameters::ResampleGaussianExtend).toDouble());
   } 
   else  
   { // default is quartic
     LOG_DEBUG("ResampleRegularMeshAlgo defaulting to Quartic kernel." << std::endl);
-    kern = nrrdKernelAQuartic; 
-    param[1] = 0.0834; // most accurate as per Teem documentation
+    kernel = ResampleKernel(ResampleKernel::AQUARTIC, 1.0, 0.0834); // most accurate as per Teem documentation
   }  
-  
-  NrrdResampleInfo *info = nrrdResampleInfoNew();
-  
-  if (nrrdoffset) 
-  { 
-    info->kernel[0] = 0;
-    nin->axis[0].min = 0.0;
-    nin->axis[0].max = 1.0;
-    info->min[0] = 0.0;
-    info->max[0] = 1.0;
-  }
-  
-  Transform trans;
-  vmesh->get_canonical_transform(trans);
 
-  // Set the lengths along the axis
-  info->min[nrrdoffset] = 0.0;
-  nin->axis[nrrdoffset].min = 0.0;
-  info->max[nrrdoffset] = trans.project(Vector(1.0,0.0,0.0)).length();
-  nin->axis[nrrdoffset].max = info->max[nrrdoffset];
-  info->min[nrrdoffset+1] = 0.0;
-  nin->axis[nrrdoffset+1].min = 0.0;
-  info->max[nrrdoffset+1] = trans.project(Vector(0.0,1.0,0.0)).length();
-  nin->axis[nrrdoffset+1].max = info->max[nrrdoffset+1];
-  info->min[nrrdoffset+2] = 0.0;
-  nin->axis[nrrdoffset+2].min = 0.0;
-  info->max[nrrdoffset+2] = trans.project(Vector(0.0,0.0,1.0)).length();
-  nin->axis[nrrdoffset+2].max = info->max[nrrdoffset+2];
-  
-  
-  for (int a = nrrdoffset; a < nrrddim; a++) 
-  {
-    info->kernel[a] = kern;
-    for (int b=0; b<NRRD_KERNEL_PARMS_NUM; b++) info->parm[a][b] = param[b];
-  }    
-  
-  // Set the resampling options
-  if (!get(Parameters::ResampleXDimUseScalingFactor).toBool())
+  if (!(kernel.support() > 0.0))
   {
-    info->kernel[nrrdoffset] = kern;
-    info->samples[nrrdoffset] = static_cast<size_t>(get(Parameters::ResampleXDim).toDouble());
-  }
-  else
-  {
-    info->kernel[nrrdoffset] = kern;
-    info->samples[nrrdoffset] = static_cast<size_t>(get(Parameters::ResampleXDim).toDouble() * nrrddims[nrrdoffset]);
+    error("Resampling kernel has no support.");
+    return (false);
   }
 
-  if (nrrddim-nrrdoffset > 1)
-  {
-    if (!get(Parameters::ResampleYDimUseScalingFactor).toBool())
-    {
-      info->kernel[nrrdoffset+1] = kern;
-      info->samples[nrrdoffset+1] = static_cast<size_t>(get(Parameters::ResampleYDim).toDouble());
-    }
-    else
-    {
-      info->kernel[nrrdoffset+1] = kern;
-      info->samples[nrrdoffset+1] = static_cast<size_t>(get(Parameters::ResampleYDim).toDouble()*nrrddims[nrrdoffset+1]);
-    }
-  }
+  // Set the resampling options
+  const AlgorithmParameterName dimParams[] = { Parameters::ResampleXDim, Parameters::ResampleYDim, Parameters::ResampleZDim };
+  const AlgorithmParameterName scaleParams[] = { Parameters::ResampleXDimUseScalingFactor,
+    Parameters::ResampleYDimUseScalingFactor, Parameters::ResampleZDimUseScalingFactor };
 
-  if (nrrddim-nrrdoffset > 2)
+  std::vector<size_t> samples(sizesIn.size());
+  for (size_t k = 0; k < samples.size(); k++)
   {
-    if (!get(Parameters::ResampleZDimUseScalingFactor).toBool())
-    {
-      info->kernel[nrrdoffset+2] = kern;
-      info->samples[nrrdoffset+2] = static_cast<size_t>(get(Parameters::ResampleZDim).toDouble());
-    }
+    if (!get(scaleParams[k]).toBool())
+      samples[k] = static_cast<size_t>(get(dimParams[k]).toDouble());
     else
+      samples[k] = static_cast<size_t>(get(dimParams[k]).toDouble() * sizesIn[k]);
+
+    if (samples[k] == 0)
     {
-      info->kernel[nrrdoffset+2] = kern;
-      info->samples[nrrdoffset+2] = static_cast<size_t>(get(Parameters::ResampleZDim).toDouble()*nrrddims[nrrdoffset+2]);
+      error("Trouble resampling: number of samples along an axis must be positive.");
+      return (false);
     }
   }
 
-  if (nrrdSpatialResample(nout, nin, info)) 
-  {
-    char *err = biffGetDone(NRRD);
-    error(std::string("Trouble resampling: ") +  err);
-    free(err);
-    return (false);
-  }
+  Transform trans;
+  vmesh->get_canonical_transform(trans);
 
-  nrrdNix(nin);
+  // Lengths along the axis
+  std::vector<double> lengths(sizesIn.size());
+  const Vector axes[] = { Vector(1.0,0.0,0.0), Vector(0.0,1.0,0.0), Vector(0.0,0.0,1.0) };
+  for (size_t k = 0; k < lengths.size(); k++)
+    lengths[k] = trans.project(axes[k]).length();
 
   MeshHandle mesh;
   if (dims.size() == 3)
   {
     if (fi.is_lineardata())
     {
-      mesh = CreateMesh(fi,info->samples[nrrdoffset] ,info->samples[nrrdoffset+1],info->samples[nrrdoffset+2],Point(0.0,0.0,0.0),Point(1.0,1.0,1.0));
+      mesh = CreateMesh(fi,samples[0] ,samples[1],samples[2],Point(0.0,0.0,0.0),Point(1.0,1.0,1.0));
     }
     else
     {
-      mesh = CreateMesh(fi,info->samples[nrrdoffset]+1 ,info->samples[nrrdoffset+1]+1,info->samples[nrrdoffset+2]+1,Point(0.0,0.0,0.0),Point(1.0,1.0,1.0));    
+      mesh = CreateMesh(fi,samples[0]+1 ,samples[1]+1,samples[2]+1,Point(0.0,0.0,0.0),Point(1.0,1.0,1.0));    
     }
   }
   else if (dims.size() == 2)
   {
     if (fi.is_lineardata())
     {
-      mesh = CreateMesh(fi,info->samples[nrrdoffset] ,info->samples[nrrdoffset+1],Point(0.0,0.0,0.0),Point(1.0,1.0,0.0));
+      mesh = CreateMesh(fi,samples[0] ,samples[1],Point(0.0,0.0,0.0),Point(1.0,1.0,0.0));
     }
     else
     {
-      mesh = CreateMesh(fi,info->samples[nrrdoffset]+1 ,info->samples[nrrdoffset+1]+1,Point(0.0,0.0,0.0),Point(1.0,1.0,0.0));    
+      mesh = CreateMesh(fi,samples[0]+1 ,samples[1]+1,Point(0.0,0.0,0.0),Point(1.0,1.0,0.0));    
     }
   }
   else if (dims.size() == 1)
   {
     if (fi.is_lineardata())
     {
-      mesh = CreateMesh(fi,info->samples[nrrdoffset] ,Point(0.0,0.0,0.0),Point(1.0,0.0,0.0));
+      mesh = CreateMesh(fi,samples[0] ,Point(0.0,0.0,0.0),Point(1.0,0.0,0.0));
     }
     else
     {
-      mesh = CreateMesh(fi,info->samples[nrrdoffset]+1 ,Point(0.0,0.0,0.0),Point(1.0,0.0,0.0));    
+      mesh = CreateMesh(fi,samples[0]+1 ,Point(0.0,0.0,0.0),Point(1.0,0.0,0.0));    
     }
   }
 
-  
   if (!mesh)
   {
     error("Could not create output mesh");
@@ -396,80 +493,56 @@ ResampleRegularMeshAlgo::runImpl(FieldHandle input, FieldHandle& output) const
   }
   output->vmesh()->transform(trans);
 
-  vfield = output->vfield();
-  num_values = vfield->num_values();
-
-  if (vfield->is_char())
-  {
-    vfield->set_values(reinterpret_cast<char *>(nout->data),num_values);
-  }
-  else if (vfield->is_unsigned_char())
-  {
-    vfield->set_values(reinterpret_cast<unsigned char *>(nout->data),num_values);
-  }
-  else if (vfield->is_short())
-  {
-    vfield->set_values(reinterpret_cast<short *>(nout->data),num_values);
-  }
-  else if (vfield->is_unsigned_short())
-  {
-    vfield->set_values(reinterpret_cast<unsigned short *>(nout->data),num_values);
-  }  
-  if (vfield->is_int())
-  {
-    vfield->set_values(reinterpret_cast<int *>(nout->data),num_values);
-  }
-  else if (vfield->is_unsigned_int())
-  {
-    vfield->set_values(reinterpret_cast<unsigned int *>(nout->data),num_values);
-  }
-  else if (vfield->is_long())
-  {
-    vfield->set_values(reinterpret_cast<long long *>(nout->data),num_values);
-  }
-  else if (vfield->is_unsigned_long())
-  {
-    vfield->set_values(reinterpret_cast<unsigned long long *>(nout->data),num_values);
-  }  
-  else if (vfield->is_longlong())
-  {
-    vfield->set_values(reinterpret_cast<long long *>(nout->data),num_values);
-  }
-  else if (vfield->is_unsigned_longlong())
-  {
-    vfield->set_values(reinterpret_cast<unsigned long long *>(nout->data),num_values);
-  }  
-  else if (vfield->is_float())
-  {
-    vfield->set_values(reinterpret_cast<float *>(nout->data),num_values);
-  }
-  else if (vfield->is_double())
-  {
-    vfield->set_values(reinterpret_cast<double *>(nout->data),num_values);
-  }  
+  VField* ofield = output->vfield();
+  auto progress = [this](size_t pass, size_t passes) { update_progress_max(pass, passes); };
+
+  // Scalar values are resampled in place of the field storage, vectors as
+  // three interleaved components and tensors through a six component copy
+  if (vfield->is_char()) resample_values<char>(vfield, ofield, sizesIn, samples, lengths, kernel, progress);
+  else if (vfield->is_unsigned_char()) resample_values<unsigned char>(vfield, ofield, sizesIn, samples, lengths, kernel, progress);
+  else if (vfield->is_short()) resample_values<short>(vfield, ofield, sizesIn, samples, lengths, kernel, progress);
+  else if (vfield->is_unsigned_short()) resample_values<unsigned short>(vfield, ofield, sizesIn, samples, lengths, kernel, progress);
+  else if (vfield->is_int()) resample_values<int>(vfield, ofield, sizesIn, samples, lengths, kernel, progress);
+  else if (vfield->is_unsigned_int()) resample_values<unsigned int>(vfield, ofield, sizesIn, samples, lengths, kernel, progress);
+  else if (vfield->is_long()) resample_values<long>(vfield, ofield, sizesIn, samples, lengths, kernel, progress);
+  else if (vfield->is_unsigned_long()) resample_values<unsigned long>(vfield, ofield, sizesIn, samples, lengths, kernel, progress);
+  else if (vfield->is_longlong()) resample_values<long long>(vfield, ofield, sizesIn, samples, lengths, kernel, progress);
+  else if (vfield->is_unsigned_longlong()) resample_values<unsigned long long>(vfield, ofield, sizesIn, samples, lengths, kernel, progress);
+  else if (vfield->is_float()) resample_values<float>(vfield, ofield, sizesIn, samples, lengths, kernel, progress);
+  else if (vfield->is_double()) resample_values<double>(vfield, ofield, sizesIn, samples, lengths, kernel, progress);
   else if (vfield->is_vector())
   {
-    double* ptr = reinterpret_cast<double *>(nout->data);
-    size_t k = 0;
-    for (VField::index_type idx=0; idx<num_values; idx++)
-    {
-      Vector v(ptr[k],ptr[k+1],ptr[k+2]); k+=3;
-      vfield->set_value(v,idx);
-    }
+    static_assert(sizeof(Vector) == 3*sizeof(double), "Vector values are resampled as three doubles");
+    resample_grid(static_cast<const double*>(vfield->get_values_pointer()),
+      static_cast<double*>(ofield->get_values_pointer()), 3, sizesIn, samples, lengths, kernel, progress);
   }
   else if (vfield->is_tensor())
   {
-    double* ptr = reinterpret_cast<double *>(nout->data);
-    size_t k = 0;
-    for (VField::index_type idx=0; idx<num_values; idx++)
+    std::vector<double> in(6*num_values);
+    for (VField::index_type idx=0; idx<static_cast<VField::index_type>(num_values); idx++)
     {
-      Tensor v(ptr[k],ptr[k+1],ptr[k+2],ptr[k+3],ptr[k+4],ptr[k+5]);
-      vfield->set_value(v,idx);
-      k += 6;
+      Tensor v;
+      vfield->get_value(v,idx);
+      double* ptr = &in[6*idx];
+      ptr[0] = v.xx(); ptr[1] = v.xy(); ptr[2] = v.xz();
+      ptr[3] = v.yy(); ptr[4] = v.yz(); ptr[5] = v.zz();
     }
-  }  
 
-  nrrdNix(nout);
+    VField::size_type num_out = ofield->num_values();
+    std::vector<double> out(6*num_out);
+    resample_grid(&in[0], &out[0], 6, sizesIn, samples, lengths, kernel, progress);
+
+    for (VField::index_type idx=0; idx<num_out; idx++)
+    {
+      const double* ptr = &out[6*idx];
+      ofield->set_value(Tensor(ptr[0],ptr[1],ptr[2],ptr[3],ptr[4],ptr[5]),idx);
+    }
+  }  
+  else
+  {
+    error("Unknown datatype.");
+    return (false);  
+  }
 
   return (true);
 }                           
@@ -88,6 +88,18 @@ bool FairMeshAlgo::runImpl(FieldHandle input,FieldHandle& output) const
   VMesh::size_type num_nodes = mesh->num_nodes();
   mesh->unsynchronize(Mesh::NORMALS_E);
 
+  // Meshes with compact storage have no raw coordinate array, smooth a
+  // copy of the nodes and write it back at the end
+  std::vector<Point> buffer;
+  Point*  point = mesh->get_points_pointer();
+  if (point == 0 && num_nodes > 0)
+  {
+    buffer.resize(num_nodes);
+    for (VMesh::Node::index_type idx=0; idx<num_nodes; idx++)
+      mesh->get_center(buffer[idx],idx);
+    point = &buffer[0];
+  }
+
   if (method == "fast")
   {
     // Fast neighborhoods
@@ -100,7 +112,6 @@ bool FairMeshAlgo::runImpl(FieldHandle input,FieldHandle& output) const
     }
 
     std::vector<Vector> disp(num_nodes);
-    Point*  point = mesh->get_points_pointer();
     Point p0;
     for (int it = 0; it<num_iter; it++)
     {
@@ -161,7 +172,6 @@ bool FairMeshAlgo::runImpl(FieldHandle input,FieldHandle& output) const
     }
     
     std::vector<Vector> disp(num_nodes);
-    Point*  point = mesh->get_points_pointer();
     Point p0;
 
     double epsilon = mesh->get_epsilon();
@@ -244,6 +254,9 @@ bool FairMeshAlgo::runImpl(FieldHandle input,FieldHandle& output) const
       update_progress_max(it,num_iter);
     }
   }
+
+  for (size_t idx=0; idx<buffer.size(); idx++)
+    mesh->set_point(buffer[idx],VMesh::Node::index_type(idx));
   
   return (true);
 } 
@@ -52,6 +52,7 @@ DEALINGS IN THE SOFTWARE.
 #include <Core/Datatypes/Legacy/Field/Field.h>
 #include <Core/Datatypes/Legacy/Field/FieldInformation.h>
 #include <Core/Logging/LoggerInterface.h>
+#include <Core/Algorithms/Math/DirichletCondensation.h>
 
 #include <Dataflow/Network/Module.h>
 #include <vector>
@@ -59,6 +60,7 @@ DEALINGS IN THE SOFTWARE.
 using namespace SCIRun;
 using namespace SCIRun::Core::Algorithms;
 using namespace SCIRun::Core::Algorithms::FiniteElements;
+using namespace SCIRun::Core::Algorithms::Math;
 using namespace SCIRun::Core::Datatypes;
 using namespace SCIRun::Core::Geometry;
 
@@ -70,49 +72,21 @@ ApplyFEMVoltageSourceAlgo::ApplyFEMVoltageSourceAlgo()
 
 void ApplyFEMVoltageSourceAlgo::ExecuteAlgorithm(const DenseMatrixHandle& dirBC, DenseColumnMatrixHandle& rhs, SparseRowMatrixHandle& mat)
 {
-  //! adjusting matrix for Dirichlet BC
-  index_type *idcNz; 
-  double *valNz;
-  index_type idcNzsize;
-    
-  std::vector<double> dbc;
-  index_type idx;
-  size_type size = dirBC->nrows();
-  for(idx = 0; idx<size; ++idx)
+  //! collecting the dirichlet nodes, a node listed twice takes the last value
+  DirichletCondensation dirichlet(mat->nrows());
+  size_type size = dirBC->ncols() > 2 ? dirBC->nrows() : 0;
+  for (index_type idx = 0; idx<size; ++idx)
   {
     index_type ni = (*dirBC)(idx, 1);
     double val = (*dirBC)(idx, 2);
-  
-    // -- getting column indices of non-zero elements for the current row
-    mat->getRowNonzerosNoCopy(ni, idcNzsize, idcNz, valNz);
-  
-    // -- updating rhs
-    for (index_type i=0; i<idcNzsize; ++i)
-    {
-      index_type j = idcNz ? idcNz[i] : i;
-      (*rhs)[j] += -val * valNz[i];
-    }
+    dirichlet.setKnown(ni, val);
   }
- 
-  //! zeroing matrix row and column corresponding to the dirichlet nodes
-  size = dirBC->nrows();
-  for(idx = 0; idx<size; ++idx)
-  {
-    index_type ni = (*dirBC)(idx, 1);
-    double val = (*dirBC)(idx, 2);
-  
-    mat->getRowNonzerosNoCopy(ni, idcNzsize, idcNz, valNz);
-    
-    for (index_type i=0; i<idcNzsize; ++i)
-    {
-      index_type j = idcNz?idcNz[i]:i;
-      mat->put(ni, j, 0.0);
-      mat->put(j, ni, 0.0); 
-    }
-    
-    //! updating dirichlet node and corresponding entry in rhs
-    mat->put(ni, ni, 1);
-    (*rhs)[ni] = val;
-  }
-  
+
+  //! zeroing matrix row and column corresponding to the dirichlet nodes and
+  //! moving their columns to the rhs; the input matrix is left untouched
+  SparseRowMatrixHandle condensedMat;
+  DenseColumnMatrixHandle condensedRhs;
+  dirichlet.eliminate(*mat, *rhs, condensedMat, condensedRhs);
+  mat = condensedMat;
+  rhs = condensedRhs;
 }
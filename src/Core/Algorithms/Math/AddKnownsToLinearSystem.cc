@@ -32,11 +32,11 @@ Last modification : 9/5/2014
 */
 
 #include <Core/Algorithms/Math/AddKnownsToLinearSystem.h>
+#include <Core/Algorithms/Math/DirichletCondensation.h>
 #include <Core/Datatypes/DenseMatrix.h>
 #include <Core/Datatypes/DenseColumnMatrix.h>
 #include <Core/Datatypes/MatrixTypeConversions.h>
 #include <Core/Datatypes/SparseRowMatrix.h>
-#include <Core/Datatypes/SparseRowMatrixFromMap.h>
 #include <Core/Algorithms/Base/AlgorithmPreconditions.h>
 
 #include <Core/GeometryPrimitives/Point.h>
@@ -62,9 +62,6 @@ bool AddKnownsToLinearSystemAlgo::run(SparseRowMatrixHandle stiff,
   SparseRowMatrixHandle& output_stiff,
   DenseColumnMatrixHandle& output_rhs) const
 {
-
-  SparseRowMatrixFromMap::Values additionalData;
-
   // Making sure the stiff matrix (left hand side) is symmetric
   if (!isSymmetricMatrix(*stiff,bound_for_equality))
   {
@@ -89,7 +86,7 @@ bool AddKnownsToLinearSystemAlgo::run(SparseRowMatrixHandle stiff,
   // casting rhs to be a column
   auto rhsCol = rhs ?  matrix_convert::to_column(rhs) : boost::make_shared<DenseColumnMatrix>(DenseColumnMatrix::Zero(numCols));
   ENSURE_NOT_NULL(rhsCol, "rhsCol");
-  DenseColumnMatrix& rhsColRef = *rhsCol;
+  const DenseColumnMatrix& rhsColRef = *rhsCol;
 
   // Checking if x matrix was given and that the dimensions agree with the stiff matrix
   if (!x)
@@ -107,72 +104,28 @@ bool AddKnownsToLinearSystemAlgo::run(SparseRowMatrixHandle stiff,
   ENSURE_NOT_NULL(xCol, "xColumn");
   const DenseColumnMatrix& xColRef = *xCol;
 
-  // cnt used for updating the progress bar
-  index_type cnt = 0;
-
-  bool just_copying_inputs = true;
-
-  // performs calculation adjustments for setting row and col values to zero
-  // NOTE: right hand side vector values are reset multiple times during this
-  //   process, thus it was necessary to have a second for loop to set the
-  //   right hand side vector equal to the known values
-  for (index_type i=0; i<numRows; i++)
-  {
-    for (SparseRowMatrix::InnerIterator it(*stiff,i); it; ++it)
-    //for (index_type p=0; p<numCols; p++)    
-    {
-      const int p = it.col();
-      // making sure the rhs vector is finite
-      if (!IsFinite(rhsColRef[p]))
-        THROW_ALGORITHM_INPUT_ERROR("NaN exist in the b vector");
-
-      const double xCol_p = xColRef[p];
-      if (IsFinite(xCol_p))
-      {
-        just_copying_inputs = false;
-        if (i!=p)
-        {
-          rhsColRef[i] += -it.value() * xCol_p;
-          additionalData[i][p] = 0.0;
-          additionalData[p][i] = 0.0;
-        }
-      }
-      cnt++;
-      if (cnt == 1000)
-      {
-        cnt = 0;
-        update_progress_max(i, numRows);
-      }
-    }
-  }
-
-  for (int i = 0; i < std::min(numRows, numCols); ++i)
+  // making sure the rhs vector is finite
+  for (index_type p=0; p<numCols; p++)
   {
-    if (IsFinite(xColRef[i]))
-      additionalData[i][i] = 1.0;
+    if (!IsFinite(rhsColRef[p]))
+      THROW_ALGORITHM_INPUT_ERROR("NaN exist in the b vector");
   }
 
-  // assigns value for right hand side vector
+  // finite entries of x are the knowns
+  DirichletCondensation knowns(numRows);
   for (index_type p=0; p<numCols; p++)
   {
     if (IsFinite(xColRef[p]))
-    {
-      just_copying_inputs = false;
-      rhsColRef[p] = xColRef[p];
-    }
-    cnt++;
-    if (cnt == 100)
-    {
-      cnt = 0;
-      update_progress((double)p/numCols);
-    }
+      knowns.setKnown(p, xColRef[p]);
   }
 
-  if (just_copying_inputs)
+  if (knowns.numKnowns() == 0)
     remark("X vector does not contain any knowns! Copying inputs to outputs.");
 
-  output_stiff = SparseRowMatrixFromMap::appendToSparseMatrix(numCols, numRows, *stiff, additionalData);
-  output_rhs = rhsCol;
+  // zeroes the rows and columns of the knowns and moves their columns to
+  // the right hand side in one pass over the matrix
+  knowns.eliminate(*stiff, rhsColRef, output_stiff, output_rhs);
+  update_progress(1.0);
 
   return true;
 }
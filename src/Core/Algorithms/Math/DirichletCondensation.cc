@@ -0,0 +1,254 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Core/Algorithms/Math/DirichletCondensation.h>
+#include <Core/Datatypes/DenseColumnMatrix.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
+#include <Core/Math/MiscMath.h>
+#include <Core/Thread/Parallel.h>
+#include <Core/Utils/Exception.h>
+#include <algorithm>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Algorithms::Math;
+using namespace SCIRun::Core::Thread;
+
+namespace
+{
+  // Small systems are not worth starting threads for
+  int num_procs(size_type size)
+  {
+    const int nproc = static_cast<int>(Parallel::NumCores());
+    return std::max(1, std::min(nproc, static_cast<int>(size/1024)));
+  }
+
+  index_type range_start(size_type size, int proc, int nproc)
+  {
+    return (size/nproc)*proc;
+  }
+
+  index_type range_end(size_type size, int proc, int nproc)
+  {
+    return (proc < nproc-1) ? (size/nproc)*(proc+1) : size;
+  }
+}
+
+DirichletCondensation::DirichletCondensation(size_type size) :
+  known_(size, 0), values_(size, 0.0), numKnowns_(0)
+{
+}
+
+void DirichletCondensation::setKnown(index_type node, double value)
+{
+  if (node < 0 || node >= size())
+    THROW_OUT_OF_RANGE("Dirichlet node is outside of the linear system");
+  if (!IsFinite(value))
+    THROW_INVALID_ARGUMENT("Dirichlet value needs to be a finite number");
+
+  if (!known_[node]) numKnowns_++;
+  known_[node] = 1;
+  values_[node] = value;
+}
+
+void DirichletCondensation::check_system(const SparseRowMatrix& A, const DenseColumnMatrix& b) const
+{
+  if (static_cast<size_type>(A.nrows()) != size() || static_cast<size_type>(A.ncols()) != size())
+    THROW_INVALID_ARGUMENT("Matrix does not match the number of nodes of the boundary conditions");
+  if (static_cast<size_type>(b.nrows()) != size())
+    THROW_INVALID_ARGUMENT("Right hand side does not match the number of nodes of the boundary conditions");
+}
+
+void DirichletCondensation::reduced_indices(std::vector<index_type>& unknowns, std::vector<index_type>& reduced) const
+{
+  unknowns.clear();
+  unknowns.reserve(size() - numKnowns_);
+  reduced.assign(size(), -1);
+  for (index_type i = 0; i < size(); i++)
+  {
+    if (!known_[i])
+    {
+      reduced[i] = static_cast<index_type>(unknowns.size());
+      unknowns.push_back(i);
+    }
+  }
+}
+
+std::vector<index_type> DirichletCondensation::unknowns() const
+{
+  std::vector<index_type> unknowns, reduced;
+  reduced_indices(unknowns, reduced);
+  return unknowns;
+}
+
+void DirichletCondensation::eliminate(const SparseRowMatrix& A, const DenseColumnMatrix& b,
+  SparseRowMatrixHandle& outputA, DenseColumnMatrixHandle& outputb) const
+{
+  check_system(A, b);
+
+  const size_type n = size();
+  const int nproc = num_procs(n);
+
+  // Count the entries that remain in every row
+  std::vector<index_type> offset(n+1, 0);
+  Parallel::RunTasks([&](int proc)
+  {
+    for (index_type i = range_start(n, proc, nproc); i < range_end(n, proc, nproc); i++)
+    {
+      index_type count = 1;
+      if (!known_[i])
+      {
+        count = 0;
+        for (SparseRowMatrix::InnerIterator it(A, i); it; ++it)
+          if (!known_[it.col()]) count++;
+      }
+      offset[i+1] = count;
+    }
+  }, nproc);
+
+  for (index_type i = 0; i < n; i++) offset[i+1] += offset[i];
+
+  outputA = boost::make_shared<SparseRowMatrix>(n, n);
+  outputA->resizeNonZeros(offset[n]);
+  std::copy(offset.begin(), offset.end(), outputA->outerIndexPtr());
+  index_type* cols = outputA->innerIndexPtr();
+  double* values = outputA->valuePtr();
+  outputb = boost::make_shared<DenseColumnMatrix>(b);
+  DenseColumnMatrix& rhs = *outputb;
+
+  Parallel::RunTasks([&](int proc)
+  {
+    for (index_type i = range_start(n, proc, nproc); i < range_end(n, proc, nproc); i++)
+    {
+      index_type k = offset[i];
+      if (known_[i])
+      {
+        cols[k] = i;
+        values[k] = 1.0;
+        rhs[i] = values_[i];
+        continue;
+      }
+      for (SparseRowMatrix::InnerIterator it(A, i); it; ++it)
+      {
+        const index_type j = it.col();
+        if (known_[j])
+        {
+          rhs[i] -= it.value() * values_[j];
+        }
+        else
+        {
+          cols[k] = j;
+          values[k] = it.value();
+          k++;
+        }
+      }
+    }
+  }, nproc);
+}
+
+void DirichletCondensation::reduce(const SparseRowMatrix& A, const DenseColumnMatrix& b,
+  SparseRowMatrixHandle& outputA, DenseColumnMatrixHandle& outputb) const
+{
+  check_system(A, b);
+
+  std::vector<index_type> unknowns, reduced;
+  reduced_indices(unknowns, reduced);
+
+  const size_type m = static_cast<size_type>(unknowns.size());
+  const int nproc = num_procs(m);
+
+  std::vector<index_type> offset(m+1, 0);
+  Parallel::RunTasks([&](int proc)
+  {
+    for (index_type r = range_start(m, proc, nproc); r < range_end(m, proc, nproc); r++)
+    {
+      index_type count = 0;
+      for (SparseRowMatrix::InnerIterator it(A, unknowns[r]); it; ++it)
+        if (!known_[it.col()]) count++;
+      offset[r+1] = count;
+    }
+  }, nproc);
+
+  for (index_type r = 0; r < m; r++) offset[r+1] += offset[r];
+
+  outputA = boost::make_shared<SparseRowMatrix>(m, m);
+  outputA->resizeNonZeros(offset[m]);
+  std::copy(offset.begin(), offset.end(), outputA->outerIndexPtr());
+  index_type* cols = outputA->innerIndexPtr();
+  double* values = outputA->valuePtr();
+  outputb = boost::make_shared<DenseColumnMatrix>(m);
+  DenseColumnMatrix& rhs = *outputb;
+
+  // The unknowns keep their order, so every row stays sorted by column
+  Parallel::RunTasks([&](int proc)
+  {
+    for (index_type r = range_start(m, proc, nproc); r < range_end(m, proc, nproc); r++)
+    {
+      const index_type i = unknowns[r];
+      index_type k = offset[r];
+      double value = b[i];
+      for (SparseRowMatrix::InnerIterator it(A, i); it; ++it)
+      {
+        const index_type j = it.col();
+        if (known_[j])
+        {
+          value -= it.value() * values_[j];
+        }
+        else
+        {
+          cols[k] = reduced[j];
+          values[k] = it.value();
+          k++;
+        }
+      }
+      rhs[r] = value;
+    }
+  }, nproc);
+}
+
+DenseColumnMatrixHandle DirichletCondensation::expand(const DenseColumnMatrix& x) const
+{
+  if (static_cast<size_type>(x.nrows()) != size() - numKnowns_)
+    THROW_INVALID_ARGUMENT("Solution does not match the number of unknowns of the reduced system");
+
+  std::vector<index_type> unknowns, reduced;
+  reduced_indices(unknowns, reduced);
+
+  const size_type n = size();
+  const int nproc = num_procs(n);
+  DenseColumnMatrixHandle output(boost::make_shared<DenseColumnMatrix>(n));
+  DenseColumnMatrix& full = *output;
+
+  Parallel::RunTasks([&](int proc)
+  {
+    for (index_type i = range_start(n, proc, nproc); i < range_end(n, proc, nproc); i++)
+      full[i] = known_[i] ? values_[i] : x[reduced[i]];
+  }, nproc);
+
+  return output;
+}
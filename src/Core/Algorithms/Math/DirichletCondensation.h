@@ -0,0 +1,87 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef CORE_ALGORITHMS_MATH_DIRICHLETCONDENSATION_H
+#define CORE_ALGORITHMS_MATH_DIRICHLETCONDENSATION_H 1
+
+#include <Core/Datatypes/MatrixFwd.h>
+#include <Core/Datatypes/Legacy/Base/Types.h>
+#include <Core/Algorithms/Math/share.h>
+#include <vector>
+
+namespace SCIRun {
+  namespace Core {
+    namespace Algorithms {
+      namespace Math {
+
+        /// Applies Dirichlet boundary conditions to a linear system A x = b.
+        /// The known nodes are kept in a mask; every method makes a single
+        /// parallel pass over the rows of A and never searches the matrix.
+        class SCISHARE DirichletCondensation
+        {
+        public:
+          explicit DirichletCondensation(size_type size);
+
+          size_type size() const { return static_cast<size_type>(known_.size()); }
+          size_type numKnowns() const { return numKnowns_; }
+          bool isKnown(index_type node) const { return known_[node] != 0; }
+
+          /// Fix the value of a node, setting it again replaces the value.
+          void setKnown(index_type node, double value);
+
+          /// Zero the rows and columns of the known nodes, put a one on their
+          /// diagonal and move the known columns to the right hand side. The
+          /// result stays symmetric if A is.
+          void eliminate(const Datatypes::SparseRowMatrix& A, const Datatypes::DenseColumnMatrix& b,
+            Datatypes::SparseRowMatrixHandle& outputA, Datatypes::DenseColumnMatrixHandle& outputb) const;
+
+          /// Remove the known nodes from the system, which is SPD if A is.
+          /// Row i of the reduced system belongs to node unknowns()[i].
+          void reduce(const Datatypes::SparseRowMatrix& A, const Datatypes::DenseColumnMatrix& b,
+            Datatypes::SparseRowMatrixHandle& outputA, Datatypes::DenseColumnMatrixHandle& outputb) const;
+
+          /// Full solution from the solution of the reduced system.
+          Datatypes::DenseColumnMatrixHandle expand(const Datatypes::DenseColumnMatrix& x) const;
+
+          std::vector<index_type> unknowns() const;
+
+        private:
+          void check_system(const Datatypes::SparseRowMatrix& A, const Datatypes::DenseColumnMatrix& b) const;
+          void reduced_indices(std::vector<index_type>& unknowns, std::vector<index_type>& reduced) const;
+
+          std::vector<char> known_;
+          std::vector<double> values_;
+          size_type numKnowns_;
+        };
+
+      }
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,152 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+#include <Core/Algorithms/Math/DirichletCondensation.h>
+#include <Core/Datatypes/DenseColumnMatrix.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
+#include <Core/Utils/Exception.h>
+#include <limits>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Algorithms::Math;
+
+namespace
+{
+  // symmetric tridiagonal matrix
+  SparseRowMatrixHandle LHS()
+  {
+    SparseRowMatrixHandle m(boost::make_shared<SparseRowMatrix>(4,4));
+    m->insert(0,0) = 2;
+    m->insert(0,1) = -1;
+    m->insert(1,0) = -1;
+    m->insert(1,1) = 2;
+    m->insert(1,2) = -1;
+    m->insert(2,1) = -1;
+    m->insert(2,2) = 2;
+    m->insert(2,3) = -1;
+    m->insert(3,2) = -1;
+    m->insert(3,3) = 2;
+    m->makeCompressed();
+    return m;
+  }
+
+  DenseColumnMatrix rhs()
+  {
+    DenseColumnMatrix b(4);
+    b << 1, 2, 3, 4;
+    return b;
+  }
+}
+
+TEST(DirichletCondensationTests, EliminateKeepsSymmetry)
+{
+  DirichletCondensation knowns(4);
+  knowns.setKnown(0, 5);
+  knowns.setKnown(3, -1);
+
+  SparseRowMatrixHandle A;
+  DenseColumnMatrixHandle b;
+  knowns.eliminate(*LHS(), rhs(), A, b);
+
+  ASSERT_EQ(4, A->nrows());
+  EXPECT_EQ(1, A->coeff(0,0));
+  EXPECT_EQ(0, A->coeff(0,1));
+  EXPECT_EQ(0, A->coeff(1,0));
+  EXPECT_EQ(2, A->coeff(1,1));
+  EXPECT_EQ(-1, A->coeff(1,2));
+  EXPECT_EQ(-1, A->coeff(2,1));
+  EXPECT_EQ(0, A->coeff(2,3));
+  EXPECT_EQ(0, A->coeff(3,2));
+  EXPECT_EQ(1, A->coeff(3,3));
+
+  EXPECT_EQ(5, (*b)[0]);
+  EXPECT_EQ(7, (*b)[1]);
+  EXPECT_EQ(2, (*b)[2]);
+  EXPECT_EQ(-1, (*b)[3]);
+}
+
+TEST(DirichletCondensationTests, ReduceAndExpand)
+{
+  DirichletCondensation knowns(4);
+  knowns.setKnown(0, 5);
+  knowns.setKnown(3, -1);
+
+  SparseRowMatrixHandle A;
+  DenseColumnMatrixHandle b;
+  knowns.reduce(*LHS(), rhs(), A, b);
+
+  ASSERT_EQ(2, A->nrows());
+  ASSERT_EQ(2, A->ncols());
+  EXPECT_EQ(4, A->nonZeros());
+  EXPECT_EQ(2, A->coeff(0,0));
+  EXPECT_EQ(-1, A->coeff(0,1));
+  EXPECT_EQ(7, (*b)[0]);
+  EXPECT_EQ(2, (*b)[1]);
+
+  std::vector<index_type> unknowns = knowns.unknowns();
+  ASSERT_EQ(2, unknowns.size());
+  EXPECT_EQ(1, unknowns[0]);
+  EXPECT_EQ(2, unknowns[1]);
+
+  // solution of [2 -1; -1 2] x = [7; 2]
+  DenseColumnMatrix x(2);
+  x << 16.0/3.0, 11.0/3.0;
+  DenseColumnMatrixHandle full = knowns.expand(x);
+  ASSERT_EQ(4, full->nrows());
+  EXPECT_EQ(5, (*full)[0]);
+  EXPECT_DOUBLE_EQ(16.0/3.0, (*full)[1]);
+  EXPECT_DOUBLE_EQ(11.0/3.0, (*full)[2]);
+  EXPECT_EQ(-1, (*full)[3]);
+}
+
+TEST(DirichletCondensationTests, SettingANodeTwiceReplacesTheValue)
+{
+  DirichletCondensation knowns(4);
+  knowns.setKnown(1, 3);
+  knowns.setKnown(1, 4);
+  EXPECT_EQ(1, knowns.numKnowns());
+
+  SparseRowMatrixHandle A;
+  DenseColumnMatrixHandle b;
+  knowns.eliminate(*LHS(), rhs(), A, b);
+  EXPECT_EQ(4, (*b)[1]);
+  EXPECT_EQ(5, (*b)[0]);
+}
+
+TEST(DirichletCondensationTests, ThrowsForInvalidInput)
+{
+  DirichletCondensation knowns(4);
+  EXPECT_THROW(knowns.setKnown(4, 1.0), SCIRun::Core::OutOfRangeException);
+  EXPECT_THROW(knowns.setKnown(0, std::numeric_limits<double>::quiet_NaN()), SCIRun::Core::InvalidArgumentException);
+
+  SparseRowMatrixHandle A;
+  DenseColumnMatrixHandle b;
+  EXPECT_THROW(knowns.eliminate(*LHS(), DenseColumnMatrix(3), A, b), SCIRun::Core::InvalidArgumentException);
+}
@@ -0,0 +1,215 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Core/Algorithms/Worker/AlgorithmWorker.h>
+#include <Core/Algorithms/Worker/WorkerProtocol.h>
+#include <Core/Algorithms/Base/AlgorithmBase.h>
+#include <Core/Algorithms/Base/AlgorithmFactory.h>
+#include <Core/ICom/IComAddress.h>
+#include <Core/Logging/Log.h>
+#include <boost/lexical_cast.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread.hpp>
+
+using namespace SCIRun;
+using namespace SCIRun::Core;
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Algorithms::Remote;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Logging;
+
+namespace
+{
+  // Forwards the messages of an algorithm running in the worker to the client.
+  class ForwardingLogger : public LegacyLoggerInterface
+  {
+  public:
+    explicit ForwardingLogger(WorkerConnectionHandle connection) : connection_(connection) {}
+    virtual void error(const std::string& msg) const override { connection_->sendMessage(LOG_MESSAGE, msg, LOG_ERROR); }
+    virtual void warning(const std::string& msg) const override { connection_->sendMessage(LOG_MESSAGE, msg, LOG_WARNING); }
+    virtual void remark(const std::string& msg) const override { connection_->sendMessage(LOG_MESSAGE, msg, LOG_REMARK); }
+    virtual void status(const std::string& msg) const override { connection_->sendMessage(LOG_MESSAGE, msg, LOG_STATUS); }
+  private:
+    WorkerConnectionHandle connection_;
+  };
+}
+
+AlgorithmWorker::AlgorithmWorker(AlgorithmFactoryHandle factory) : factory_(factory), port_(0), stopped_(false)
+{
+}
+
+AlgorithmWorker::~AlgorithmWorker()
+{
+  if (listener_)
+    listener_->close();
+}
+
+bool AlgorithmWorker::listen(const std::string& host, int port)
+{
+  listener_.reset(new IComSocket("scirun"));
+  IComAddress address("scirun", host, boost::lexical_cast<std::string>(port));
+  if (!address.isvalid())
+  {
+    error_ = "Invalid worker address " + host + ":" + boost::lexical_cast<std::string>(port);
+    return false;
+  }
+  if (!listener_->create() || !listener_->bind(address) || !listener_->listen())
+  {
+    error_ = listener_->geterror();
+    listener_.reset();
+    return false;
+  }
+  port_ = address.getport();
+  return true;
+}
+
+void AlgorithmWorker::serve()
+{
+  while (listener_ && !stopped_)
+  {
+    IComSocketHandle socket;
+    if (!listener_->accept(socket))
+    {
+      if (!stopped_)
+        Log::get() << ERROR_LOG << "AlgorithmWorker: accept failed: " << listener_->geterror() << std::endl;
+      break;
+    }
+    if (stopped_)
+      break;
+    boost::thread(&AlgorithmWorker::handleConnection, this, socket).detach();
+  }
+}
+
+void AlgorithmWorker::stop()
+{
+  stopped_ = true;
+  // Wake up the blocking accept in serve()
+  IComSocket wakeup("scirun");
+  IComAddress address("scirun", "localhost", boost::lexical_cast<std::string>(port_));
+  if (wakeup.create() && wakeup.connect(address))
+    wakeup.close();
+}
+
+void AlgorithmWorker::handleConnection(IComSocketHandle socket)
+{
+  IComPacketHandle packet(new IComPacket);
+  while (socket->recv(packet))
+  {
+    if (packet->gettag() != RUN_ALGORITHM)
+    {
+      LOG_DEBUG("AlgorithmWorker: unexpected message " << packet->gettag() << ", closing connection");
+      break;
+    }
+    if (!handleRequest(socket, packet->getstring(), packet->getparam1() == PAYLOAD_SHARED_FILE))
+      break;
+    packet.reset(new IComPacket);
+  }
+  socket->close();
+}
+
+bool AlgorithmWorker::handleRequest(IComSocketHandle socket, const std::string& moduleName, bool sharedFiles)
+{
+  auto connection = boost::make_shared<WorkerConnection>(socket, sharedFiles);
+
+  std::vector<Variable> parameters;
+  AlgorithmData::Map inputs;
+  try
+  {
+    IComPacketHandle packet;
+    while (true)
+    {
+      if (!connection->receive(packet))
+        return false;
+      const int tag = packet->gettag();
+      if (tag == EXECUTE)
+        break;
+      if (tag == PARAMETER)
+        parameters.push_back(WorkerConnection::readParameter(*packet));
+      else if (tag == INPUT)
+      {
+        Name name;
+        size_t index;
+        auto data = connection->receiveData(packet, name, index);
+        auto& list = inputs[name];
+        if (list.size() <= index)
+          list.resize(index + 1);
+        list[index] = data;
+      }
+      else
+        THROW_INVALID_ARGUMENT("Unexpected message in worker request");
+    }
+  }
+  catch (const std::exception& e)
+  {
+    // The rest of the request cannot be trusted, report and drop the connection
+    connection->sendMessage(FAILED, std::string("Invalid worker request: ") + e.what());
+    return false;
+  }
+
+  std::string failure;
+  try
+  {
+    auto algo = factory_->create(moduleName, nullptr);
+    if (!algo)
+      failure = "Worker has no algorithm for module " + moduleName;
+    else
+    {
+      algo->setLogger(boost::make_shared<ForwardingLogger>(connection));
+      algo->setUpdaterFunc([connection](double fraction) { connection->sendProgress(fraction); });
+      for (const auto& parameter : parameters)
+        algo->set(parameter.name(), parameter.value());
+
+      auto output = algo->run_generic(AlgorithmInput(inputs));
+
+      for (const auto& item : output.items())
+      {
+        for (size_t i = 0; i < item.second.size() && failure.empty(); ++i)
+        {
+          if (!connection->sendData(OUTPUT, item.first, i, item.second[i]))
+            failure = connection->error();
+        }
+      }
+    }
+  }
+  catch (const std::bad_alloc&)
+  {
+    failure = "Worker ran out of memory running " + moduleName;
+  }
+  catch (const std::exception& e)
+  {
+    failure = e.what();
+  }
+  catch (...)
+  {
+    failure = "Unhandled exception in worker running " + moduleName;
+  }
+
+  if (!failure.empty())
+    return connection->sendMessage(FAILED, failure);
+  return connection->sendMessage(FINISHED, moduleName);
+}
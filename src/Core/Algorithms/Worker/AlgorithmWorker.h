@@ -0,0 +1,79 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef ALGORITHMS_WORKER_ALGORITHMWORKER_H
+#define ALGORITHMS_WORKER_ALGORITHMWORKER_H
+
+#include <Core/Algorithms/Base/AlgorithmFwd.h>
+#include <string>
+#include <Core/ICom/IComSocket.h>
+#include <boost/atomic.hpp>
+#include <boost/noncopyable.hpp>
+#include <Core/Algorithms/Worker/share.h>
+
+namespace SCIRun {
+namespace Core {
+namespace Algorithms {
+namespace Remote {
+
+  /// Server side of the worker protocol: listens on a socket and runs the algorithm
+  /// requests sent by a WorkerPool, each connection on its own thread. Algorithms are
+  /// created by module name from the given factory, log messages and progress of the
+  /// running algorithm are sent back while it runs, followed by its outputs.
+  class SCISHARE AlgorithmWorker : boost::noncopyable
+  {
+  public:
+    explicit AlgorithmWorker(AlgorithmFactoryHandle factory);
+    ~AlgorithmWorker();
+
+    /// Bind to host:port and start listening. An empty host accepts connections on
+    /// all interfaces, port 0 lets the system pick a free port.
+    bool listen(const std::string& host, int port);
+    int port() const { return port_; }
+    std::string error() const { return error_; }
+
+    /// Accept connections until stop() is called.
+    void serve();
+    void stop();
+
+    /// Run the requests arriving on a connected socket until the client disconnects.
+    void handleConnection(IComSocketHandle socket);
+
+  private:
+    bool handleRequest(IComSocketHandle socket, const std::string& moduleName, bool sharedFiles);
+
+    AlgorithmFactoryHandle factory_;
+    IComSocketHandle listener_;
+    int port_;
+    std::string error_;
+    boost::atomic<bool> stopped_;
+  };
+
+}}}}
+
+#endif
@@ -0,0 +1,425 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+
+#include <Core/Algorithms/Worker/AlgorithmWorker.h>
+#include <Core/Algorithms/Worker/WorkerAlgorithm.h>
+#include <Core/Algorithms/Worker/WorkerProtocol.h>
+#include <Core/Algorithms/Base/AlgorithmFactory.h>
+#include <Core/Algorithms/Base/AlgorithmPreconditions.h>
+#include <Core/Datatypes/DenseMatrix.h>
+#include <Core/Datatypes/String.h>
+#include <Core/ICom/IComAddress.h>
+#include <boost/atomic.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread.hpp>
+#include <fstream>
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Algorithms::Remote;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Logging;
+
+namespace
+{
+  const AlgorithmParameterName Factor("Factor");
+  const AlgorithmParameterName Mode("Mode");
+  const AlgorithmInputName InputMatrix("InputMatrix");
+  const AlgorithmOutputName OutputMatrix("OutputMatrix");
+  const AlgorithmOutputName Summary("Summary");
+
+  boost::atomic<int> remoteRuns(0);
+
+  class ScaleMatrixAlgo : public AlgorithmBase
+  {
+  public:
+    ScaleMatrixAlgo()
+    {
+      addParameter(Factor, 1.0);
+      add_option(Mode, "scale", "scale|negate");
+    }
+
+    virtual AlgorithmOutput run_generic(const AlgorithmInput& input) const override
+    {
+      auto matrix = input.get<DenseMatrix>(InputMatrix);
+      if (!matrix)
+        THROW_ALGORITHM_INPUT_ERROR("No input matrix");
+      double factor = get(Factor).toDouble();
+      if (factor < 0)
+        THROW_ALGORITHM_PROCESSING_ERROR("Factor must not be negative");
+      if (get_option(Mode) == "negate")
+        factor = -factor;
+
+      remark("scaling");
+      update_progress(0.5);
+
+      AlgorithmOutput output;
+      output[OutputMatrix] = boost::make_shared<DenseMatrix>(factor * *matrix);
+      output[Summary] = boost::make_shared<String>("scaled");
+      return output;
+    }
+  };
+
+  class WorkerAlgorithmFactory : public AlgorithmFactory
+  {
+  public:
+    virtual AlgorithmHandle create(const std::string& name, const AlgorithmCollaborator*) const override
+    {
+      if (name != "ScaleMatrix")
+        return AlgorithmHandle();
+      ++remoteRuns;
+      return boost::make_shared<ScaleMatrixAlgo>();
+    }
+  };
+
+  class RecordingLogger : public LegacyLoggerInterface
+  {
+  public:
+    virtual void error(const std::string& msg) const override { errors.push_back(msg); }
+    virtual void warning(const std::string& msg) const override { warnings.push_back(msg); }
+    virtual void remark(const std::string& msg) const override { remarks.push_back(msg); }
+    virtual void status(const std::string&) const override {}
+    mutable std::vector<std::string> errors, warnings, remarks;
+  };
+
+  DenseMatrixHandle makeMatrix()
+  {
+    auto m = boost::make_shared<DenseMatrix>(3, 2);
+    for (int i = 0; i < 3; ++i)
+      for (int j = 0; j < 2; ++j)
+        (*m)(i, j) = i - j + 0.5;
+    return m;
+  }
+
+  AlgorithmInput makeInput(DenseMatrixHandle m)
+  {
+    AlgorithmInput input;
+    input[InputMatrix] = m;
+    return input;
+  }
+
+  // Both ends of a local connection, made the way AlgorithmWorker and WorkerPool do
+  bool connectSockets(IComSocketHandle& client, IComSocketHandle& server)
+  {
+    IComSocket listener("scirun");
+    IComAddress address("scirun", "localhost", "0");
+    if (!listener.create() || !listener.bind(address) || !listener.listen())
+      return false;
+    client = boost::make_shared<IComSocket>("scirun");
+    IComAddress remote("scirun", "localhost", boost::lexical_cast<std::string>(address.getport()));
+    return client->create() && client->connect(remote) && listener.accept(server);
+  }
+
+  size_t payloadFileCount()
+  {
+    size_t count = 0;
+    boost::filesystem::directory_iterator end;
+    for (boost::filesystem::directory_iterator it(sharedPayloadDirectory()); it != end; ++it)
+      if (it->path().filename().string().compare(0, 15, "scirun_payload_") == 0)
+        ++count;
+    return count;
+  }
+}
+
+class AlgorithmWorkerTests : public ::testing::Test
+{
+protected:
+  virtual void SetUp() override
+  {
+    worker_.reset(new AlgorithmWorker(boost::make_shared<WorkerAlgorithmFactory>()));
+    ASSERT_TRUE(worker_->listen("localhost", 0)) << worker_->error();
+    ASSERT_GT(worker_->port(), 0);
+    thread_ = boost::thread(&AlgorithmWorker::serve, worker_.get());
+    logger_ = boost::make_shared<RecordingLogger>();
+    remoteRuns = 0;
+  }
+
+  virtual void TearDown() override
+  {
+    worker_->stop();
+    thread_.join();
+  }
+
+  boost::shared_ptr<WorkerAlgorithm> makeAlgorithm(WorkerPool& pool)
+  {
+    auto algo = boost::make_shared<WorkerAlgorithm>("ScaleMatrix", boost::make_shared<ScaleMatrixAlgo>(), pool);
+    algo->setLogger(logger_);
+    return algo;
+  }
+
+  // Sends a request whose input claims to be the shared payload file named fileName and
+  // returns the message of the worker's reply.
+  std::string sendSharedInput(const std::string& fileName)
+  {
+    auto socket = boost::make_shared<IComSocket>("scirun");
+    IComAddress address("scirun", "localhost", boost::lexical_cast<std::string>(worker_->port()));
+    if (!socket->create() || !socket->connect(address))
+      return "cannot connect";
+    WorkerConnection connection(socket, true);
+    connection.sendMessage(RUN_ALGORITHM, "ScaleMatrix", PAYLOAD_SHARED_FILE);
+    connection.sendMessage(INPUT, InputMatrix.name() + "\n0\n.mat\n" + fileName, PAYLOAD_SHARED_FILE);
+    connection.sendMessage(EXECUTE, "ScaleMatrix");
+    IComPacketHandle packet;
+    while (connection.receive(packet))
+    {
+      if (packet->gettag() == FAILED || packet->gettag() == FINISHED)
+        return packet->getstring();
+    }
+    return "connection lost";
+  }
+
+  boost::scoped_ptr<AlgorithmWorker> worker_;
+  boost::thread thread_;
+  boost::shared_ptr<RecordingLogger> logger_;
+};
+
+TEST(WorkerProtocolTests, ParameterValuesSurviveEncoding)
+{
+  Variable::List list;
+  list.push_back(makeVariable("i", 7));
+  list.push_back(makeVariable("s", std::string("a:b\nc")));
+  list.push_back(makeVariable("inner", Variable::List { makeVariable("d", 0.1) }));
+
+  std::vector<Variable::Value> values { -3, 1.0/3.0, std::string("12:x"), true,
+    AlgoOption("cg", { "cg", "bicg", "jacobi" }), list, Variable::List() };
+
+  for (const auto& value : values)
+  {
+    EXPECT_EQ(Variable(Name("p"), value), Variable(Name("p"), decodeValue(encodeValue(value))));
+  }
+  EXPECT_THROW(decodeValue("s10:short"), SCIRun::Core::InvalidArgumentException);
+}
+
+#ifndef _WIN32
+TEST(WorkerProtocolTests, SharedPayloadFilesAreOwnerOnly)
+{
+  const mode_t oldMask = umask(022);
+  IComSocketHandle client, server;
+  ASSERT_TRUE(connectSockets(client, server));
+  WorkerConnection sender(client, true), receiver(server, true);
+
+  auto matrix = makeMatrix();
+  const bool sent = sender.sendData(INPUT, InputMatrix, 0, matrix);
+  umask(oldMask);
+  ASSERT_TRUE(sent) << sender.error();
+  IComPacketHandle packet;
+  ASSERT_TRUE(receiver.receive(packet));
+  ASSERT_EQ(PAYLOAD_SHARED_FILE, packet->getparam1());
+
+  auto header = packet->getstring();
+  const auto file = sharedPayloadDirectory() / header.substr(header.rfind('\n') + 1);
+  struct stat st;
+  ASSERT_EQ(0, lstat(file.c_str(), &st)) << file;
+  EXPECT_TRUE(S_ISREG(st.st_mode));
+  EXPECT_EQ(static_cast<mode_t>(S_IRUSR | S_IWUSR), st.st_mode & 0777);
+
+  Name name;
+  size_t index = 1;
+  auto received = boost::dynamic_pointer_cast<DenseMatrix>(receiver.receiveData(packet, name, index));
+  ASSERT_TRUE(received != nullptr);
+  EXPECT_EQ(InputMatrix.name(), name.name());
+  EXPECT_EQ(0u, index);
+  EXPECT_TRUE(matrix->isApprox(*received));
+  EXPECT_FALSE(boost::filesystem::exists(file));
+}
+#endif
+
+TEST_F(AlgorithmWorkerTests, RunsAlgorithmWithStreamedPayload)
+{
+  WorkerPool pool;
+  pool.addWorker("localhost", worker_->port(), false);
+  auto algo = makeAlgorithm(pool);
+  algo->set(Factor, 2.5);
+
+  double progress = -1;
+  algo->setUpdaterFunc([&progress](double p) { progress = p; });
+
+  auto m = makeMatrix();
+  auto output = algo->run(makeInput(m));
+
+  auto result = output.get<DenseMatrix>(OutputMatrix);
+  ASSERT_TRUE(result != nullptr);
+  EXPECT_TRUE(result->isApprox(2.5 * *m));
+  auto summary = output.get<String>(Summary);
+  ASSERT_TRUE(summary != nullptr);
+  EXPECT_EQ("scaled", summary->value());
+
+  EXPECT_EQ(1, remoteRuns);
+  EXPECT_EQ(0.5, progress);
+  ASSERT_EQ(1u, logger_->remarks.size());
+  EXPECT_EQ("scaling", logger_->remarks[0]);
+  EXPECT_TRUE(logger_->warnings.empty());
+}
+
+TEST_F(AlgorithmWorkerTests, LocalWorkersExchangeDataThroughSharedFiles)
+{
+  const auto filesBefore = payloadFileCount();
+
+  WorkerPool pool;
+  pool.addWorker("localhost", worker_->port(), true);
+  auto algo = makeAlgorithm(pool);
+  algo->set_option(Mode, "negate");
+
+  auto m = makeMatrix();
+  auto output = algo->run(makeInput(m));
+
+  auto result = output.get<DenseMatrix>(OutputMatrix);
+  ASSERT_TRUE(result != nullptr);
+  EXPECT_TRUE(result->isApprox(-1.0 * *m));
+  EXPECT_EQ(1, remoteRuns);
+  EXPECT_EQ(filesBefore, payloadFileCount());
+}
+
+TEST_F(AlgorithmWorkerTests, AlgorithmErrorsAreReportedOnce)
+{
+  WorkerPool pool;
+  pool.addWorker("localhost", worker_->port(), false);
+  auto algo = makeAlgorithm(pool);
+  algo->set(Factor, -1.0);
+
+  EXPECT_THROW(algo->run(makeInput(makeMatrix())), AlgorithmProcessingException);
+  ASSERT_EQ(1u, logger_->errors.size());
+  EXPECT_EQ("Factor must not be negative", logger_->errors[0]);
+
+  // The worker keeps serving after a failed run
+  algo->set(Factor, 1.0);
+  auto output = algo->run(makeInput(makeMatrix()));
+  EXPECT_TRUE(output.get<DenseMatrix>(OutputMatrix) != nullptr);
+}
+
+TEST_F(AlgorithmWorkerTests, UnknownAlgorithmFails)
+{
+  WorkerPool pool;
+  pool.addWorker("localhost", worker_->port(), false);
+  ScaleMatrixAlgo reporter;
+  reporter.setLogger(logger_);
+
+  EXPECT_THROW(pool.run("NoSuchModule", {}, makeInput(makeMatrix()), reporter), AlgorithmProcessingException);
+  ASSERT_EQ(1u, logger_->errors.size());
+  EXPECT_EQ("Worker has no algorithm for module NoSuchModule", logger_->errors[0]);
+}
+
+TEST_F(AlgorithmWorkerTests, RunsLocallyWhenNoWorkerIsReachable)
+{
+  // Find a port nobody listens on
+  int closedPort;
+  {
+    AlgorithmWorker unused(boost::make_shared<WorkerAlgorithmFactory>());
+    ASSERT_TRUE(unused.listen("localhost", 0));
+    closedPort = unused.port();
+  }
+
+  WorkerPool pool;
+  pool.addWorker("localhost", closedPort, false);
+  auto algo = makeAlgorithm(pool);
+  algo->set(Factor, 3.0);
+
+  auto m = makeMatrix();
+  auto output = algo->run(makeInput(m));
+
+  auto result = output.get<DenseMatrix>(OutputMatrix);
+  ASSERT_TRUE(result != nullptr);
+  EXPECT_TRUE(result->isApprox(3.0 * *m));
+  EXPECT_EQ(0, remoteRuns);
+  EXPECT_EQ(1u, logger_->warnings.size());
+}
+
+TEST_F(AlgorithmWorkerTests, ConcurrentRunsShareTheWorkers)
+{
+  AlgorithmWorker second(boost::make_shared<WorkerAlgorithmFactory>());
+  ASSERT_TRUE(second.listen("localhost", 0));
+  boost::thread secondThread(&AlgorithmWorker::serve, &second);
+
+  WorkerPool pool;
+  pool.addWorker("localhost", worker_->port(), true);
+  pool.addWorker("localhost", second.port(), false);
+
+  const int runs = 8;
+  std::vector<bool> correct(runs, false);
+  boost::thread_group group;
+  for (int i = 0; i < runs; ++i)
+  {
+    group.create_thread([&pool, &correct, i]()
+    {
+      WorkerAlgorithm algo("ScaleMatrix", boost::make_shared<ScaleMatrixAlgo>(), pool);
+      algo.setLogger(boost::make_shared<RecordingLogger>());
+      algo.set(Factor, static_cast<double>(i));
+      auto m = makeMatrix();
+      auto result = algo.run(makeInput(m)).get<DenseMatrix>(OutputMatrix);
+      correct[i] = result && result->isApprox(static_cast<double>(i) * *m);
+    });
+  }
+  group.join_all();
+
+  second.stop();
+  secondThread.join();
+
+  for (int i = 0; i < runs; ++i)
+    EXPECT_TRUE(correct[i]) << "run " << i;
+  EXPECT_EQ(runs, remoteRuns);
+}
+
+TEST_F(AlgorithmWorkerTests, SharedPayloadsOutsideThePayloadDirectoryAreRejected)
+{
+  namespace fs = boost::filesystem;
+  const auto dir = fs::temp_directory_path() / fs::unique_path("scirun_worker_test_%%%%-%%%%");
+  fs::create_directories(dir);
+  const auto victim = dir / "scirun_payload_0000-0000-0000-0000.mat";
+  {
+    std::ofstream out(victim.string().c_str());
+    out << "not a payload";
+  }
+  const auto link = sharedPayloadDirectory() / fs::unique_path("scirun_payload_%%%%-%%%%-%%%%-%%%%.mat");
+  boost::system::error_code ec;
+  fs::create_symlink(victim, link, ec);
+
+  std::vector<std::string> names { victim.string(), "../../.." + victim.string(),
+    "other_0000.mat", "scirun_payload_../../x.mat" };
+  if (!ec)
+    names.push_back(link.filename().string());
+
+  for (const auto& name : names)
+  {
+    auto reply = sendSharedInput(name);
+    EXPECT_NE(std::string::npos, reply.find("Invalid worker request")) << name << ": " << reply;
+    EXPECT_TRUE(fs::exists(victim)) << name;
+    EXPECT_EQ(13u, fs::file_size(victim)) << name;
+  }
+  EXPECT_EQ(0, remoteRuns);
+
+  fs::remove(link, ec);
+  fs::remove_all(dir, ec);
+}
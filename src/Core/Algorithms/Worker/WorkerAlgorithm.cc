@@ -0,0 +1,91 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Core/Algorithms/Worker/WorkerAlgorithm.h>
+#include <Core/Algorithms/Worker/WorkerProtocol.h>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Algorithms::Remote;
+using namespace SCIRun::Core::Datatypes;
+
+WorkerAlgorithm::WorkerAlgorithm(const std::string& moduleName, AlgorithmHandle local, WorkerPool& pool) :
+  moduleName_(moduleName), local_(local), pool_(pool)
+{
+  ENSURE_NOT_NULL(local_, "WorkerAlgorithm needs the local algorithm of " + moduleName);
+  // Start from the parameters and defaults of the wrapped algorithm
+  AlgorithmParameterList::operator=(*local_);
+  setLogger(local_->getLogger());
+  setUpdaterFunc(local_->getUpdaterFunc());
+}
+
+bool WorkerAlgorithm::keyNotFoundPolicy(const AlgorithmParameterName& key) const
+{
+  return local_->keyNotFoundPolicy(key);
+}
+
+AlgorithmOutput WorkerAlgorithm::runLocally(const AlgorithmInput& input) const
+{
+  for (auto param = paramsBegin(); param != paramsEnd(); ++param)
+    local_->set(param->first, param->second.value());
+  local_->setLogger(getLogger());
+  local_->setUpdaterFunc(getUpdaterFunc());
+  return local_->run_generic(input);
+}
+
+AlgorithmOutput WorkerAlgorithm::run_generic(const AlgorithmInput& input) const
+{
+  if (!input.getTransient().empty())
+    return runLocally(input);
+
+  for (const auto& item : input.items())
+  {
+    for (const auto& data : item.second)
+    {
+      if (data && !canTransfer(data))
+      {
+        remark("Input " + item.first.name() + " cannot be sent to a worker, running " + moduleName_ + " in this process");
+        return runLocally(input);
+      }
+    }
+  }
+
+  std::vector<Variable> parameters;
+  for (auto param = paramsBegin(); param != paramsEnd(); ++param)
+    parameters.push_back(param->second);
+
+  try
+  {
+    return pool_.run(moduleName_, parameters, input, *this);
+  }
+  catch (const WorkerUnavailable& e)
+  {
+    warning(std::string(e.what()) + ", running " + moduleName_ + " in this process");
+  }
+  return runLocally(input);
+}
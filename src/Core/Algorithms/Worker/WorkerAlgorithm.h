@@ -0,0 +1,65 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef ALGORITHMS_WORKER_WORKERALGORITHM_H
+#define ALGORITHMS_WORKER_WORKERALGORITHM_H
+
+#include <Core/Algorithms/Base/AlgorithmBase.h>
+#include <Core/Algorithms/Worker/WorkerPool.h>
+#include <Core/Algorithms/Worker/share.h>
+
+namespace SCIRun {
+namespace Core {
+namespace Algorithms {
+namespace Remote {
+
+  /// Stands in for the algorithm of an offloaded module. It holds the same parameters
+  /// as the wrapped algorithm, and run_generic sends them with the inputs to the
+  /// worker pool. Runs with inputs that cannot be sent, or when no worker can be
+  /// reached, use the wrapped algorithm in this process.
+  class SCISHARE WorkerAlgorithm : public AlgorithmBase
+  {
+  public:
+    WorkerAlgorithm(const std::string& moduleName, AlgorithmHandle local, WorkerPool& pool = WorkerPool::Instance());
+
+    virtual AlgorithmOutput run_generic(const AlgorithmInput& input) const override;
+    virtual bool keyNotFoundPolicy(const AlgorithmParameterName& key) const override;
+
+    AlgorithmHandle localAlgorithm() const { return local_; }
+
+  private:
+    AlgorithmOutput runLocally(const AlgorithmInput& input) const;
+
+    std::string moduleName_;
+    AlgorithmHandle local_;
+    WorkerPool& pool_;
+  };
+
+}}}}
+
+#endif
@@ -0,0 +1,105 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Core/Algorithms/Worker/AlgorithmWorker.h>
+#include <Core/Algorithms/Worker/WorkerProtocol.h>
+#include <Core/Algorithms/Factory/HardCodedAlgorithmFactory.h>
+#include <Core/Algorithms/Base/AlgorithmParameterHelper.h>
+
+#include <boost/make_shared.hpp>
+#include <boost/program_options.hpp>
+
+#include <iostream>
+#ifndef _WIN32
+#include <signal.h>
+#endif
+
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Algorithms::Remote;
+namespace po = boost::program_options;
+
+/// SCIRunAlgorithmWorker: runs module algorithms sent by a SCIRun worker pool, e.g.
+///   SCIRunAlgorithmWorker --host 0.0.0.0 --port 9600
+/// on a compute host, and scirun --worker host:9600 --offload BuildBEMatrix
+
+int main(int argc, const char* argv[])
+{
+  std::string host;
+  int port = 0;
+  std::string dataDir;
+
+  po::options_description desc("SCIRun algorithm worker options");
+  desc.add_options()
+    ("help,h", "prints usage information")
+    ("host", po::value<std::string>(&host)->default_value("localhost"), "interface to listen on, 0.0.0.0 for all")
+    ("port,p", po::value<int>(&port)->default_value(0), "port to listen on, 0 picks a free port")
+    ("datadir,d", po::value<std::string>(&dataDir), "scirun data directory")
+    ("announce", "print the port once listening")
+    ;
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+  }
+  catch (po::error& e)
+  {
+    std::cerr << e.what() << "\n" << desc << std::endl;
+    return 2;
+  }
+
+  if (vm.count("help"))
+  {
+    std::cout << desc << std::endl;
+    return 0;
+  }
+
+#ifndef _WIN32
+  // A client that goes away mid-transfer must not terminate the worker
+  ::signal(SIGPIPE, SIG_IGN);
+#endif
+
+  if (!dataDir.empty())
+    AlgorithmParameterHelper::setDataDir(dataDir);
+
+  AlgorithmWorker worker(boost::make_shared<HardCodedAlgorithmFactory>());
+  if (!worker.listen(host, port))
+  {
+    std::cerr << "Cannot listen on " << host << ":" << port << ": " << worker.error() << std::endl;
+    return 1;
+  }
+
+  if (vm.count("announce"))
+    std::cout << WorkerPortAnnouncement << " " << worker.port() << std::endl;
+  else
+    std::cerr << "SCIRun algorithm worker listening on port " << worker.port() << std::endl;
+
+  worker.serve();
+  return 0;
+}
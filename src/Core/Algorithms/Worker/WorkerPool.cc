@@ -0,0 +1,364 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Core/Algorithms/Worker/WorkerPool.h>
+#include <Core/Algorithms/Worker/WorkerProtocol.h>
+#include <Core/Algorithms/Base/AlgorithmBase.h>
+#include <Core/ICom/IComAddress.h>
+#include <Core/Logging/Log.h>
+#include <boost/function.hpp>
+#include <boost/lexical_cast.hpp>
+#include <sstream>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#endif
+
+using namespace SCIRun;
+using namespace SCIRun::Core;
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Algorithms::Remote;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Logging;
+using namespace SCIRun::Core::Thread;
+
+CORE_SINGLETON_IMPLEMENTATION( WorkerPool )
+
+namespace
+{
+  // Seconds a started worker process gets to report its port.
+  const int StartupTimeout = 30;
+
+#ifndef _WIN32
+  // Reads the port a worker started with --announce prints, -1 on timeout or exit.
+  int readAnnouncedPort(int fd)
+  {
+    std::string line;
+    char c;
+    while (true)
+    {
+      pollfd pfd;
+      pfd.fd = fd;
+      pfd.events = POLLIN;
+      if (::poll(&pfd, 1, StartupTimeout * 1000) <= 0)
+        return -1;
+      if (::read(fd, &c, 1) != 1)
+        return -1;
+      if (c != '\n')
+      {
+        line += c;
+        continue;
+      }
+      if (line.compare(0, WorkerPortAnnouncement.size(), WorkerPortAnnouncement) == 0)
+      {
+        std::istringstream str(line.substr(WorkerPortAnnouncement.size()));
+        int port = -1;
+        str >> port;
+        return port;
+      }
+      line.clear();
+    }
+  }
+#endif
+
+  // Keeps a worker marked busy and its connection open for the duration of a run.
+  class WorkerSession : boost::noncopyable
+  {
+  public:
+    WorkerSession(boost::function<void()> release) : release_(release) {}
+    ~WorkerSession()
+    {
+      if (connection)
+        connection->removeUnreadFiles();
+      if (socket)
+        socket->close();
+      release_();
+    }
+    IComSocketHandle socket;
+    WorkerConnectionHandle connection;
+  private:
+    boost::function<void()> release_;
+  };
+}
+
+WorkerPool::WorkerPool() : lock_("WorkerPool"), idle_("WorkerPoolIdle"), next_(0)
+{
+}
+
+WorkerPool::~WorkerPool()
+{
+  shutdown();
+}
+
+void WorkerPool::setOffloadedModules(const std::set<std::string>& moduleNames)
+{
+  Guard g(lock_.get());
+  offloaded_ = moduleNames;
+}
+
+bool WorkerPool::offloads(const std::string& moduleName) const
+{
+  Guard g(lock_.get());
+  return offloaded_.find(moduleName) != offloaded_.end();
+}
+
+void WorkerPool::addWorker(const std::string& host, int port, bool local)
+{
+  Worker worker = { host, port, local, false, 0 };
+  {
+    Guard g(lock_.get());
+    workers_.push_back(worker);
+  }
+  idle_.conditionBroadcast();
+}
+
+size_t WorkerPool::size() const
+{
+  Guard g(lock_.get());
+  return workers_.size();
+}
+
+int WorkerPool::startLocalWorkers(int count, const boost::filesystem::path& executable)
+{
+#ifndef _WIN32
+  int started = 0;
+  const std::string exe = executable.string();
+  for (int i = 0; i < count; ++i)
+  {
+    int fds[2];
+    if (::pipe(fds) != 0)
+      break;
+
+    pid_t pid = ::fork();
+    if (pid == 0)
+    {
+      ::dup2(fds[1], STDOUT_FILENO);
+      ::close(fds[0]);
+      ::close(fds[1]);
+      ::execl(exe.c_str(), exe.c_str(), "--host", "localhost", "--port", "0", "--announce", static_cast<char*>(nullptr));
+      ::_exit(127);
+    }
+    ::close(fds[1]);
+    if (pid < 0)
+    {
+      ::close(fds[0]);
+      break;
+    }
+
+    int port = readAnnouncedPort(fds[0]);
+    ::close(fds[0]);
+    if (port <= 0)
+    {
+      Log::get() << ERROR_LOG << "WorkerPool: could not start algorithm worker " << exe << std::endl;
+      ::kill(pid, SIGTERM);
+      ::waitpid(pid, nullptr, 0);
+      break;
+    }
+
+    Worker worker = { "localhost", port, true, false, pid };
+    {
+      Guard g(lock_.get());
+      workers_.push_back(worker);
+    }
+    idle_.conditionBroadcast();
+    ++started;
+  }
+  return started;
+#else
+  Log::get() << ERROR_LOG << "WorkerPool: starting local worker processes is not supported on this platform, start "
+    << executable.string() << " by hand and add it as a worker" << std::endl;
+  return 0;
+#endif
+}
+
+void WorkerPool::shutdown()
+{
+  std::vector<Worker> workers;
+  {
+    Guard g(lock_.get());
+    workers.swap(workers_);
+    next_ = 0;
+  }
+#ifndef _WIN32
+  for (const auto& worker : workers)
+  {
+    if (worker.pid > 0)
+    {
+      ::kill(worker.pid, SIGTERM);
+      ::waitpid(worker.pid, nullptr, 0);
+    }
+  }
+#endif
+  idle_.conditionBroadcast();
+}
+
+int WorkerPool::acquire(const std::set<int>& tried)
+{
+  UniqueLock lock(lock_.get());
+  while (true)
+  {
+    const size_t n = workers_.size();
+    bool untried = false;
+    for (size_t k = 0; k < n; ++k)
+    {
+      const int index = static_cast<int>((next_ + k) % n);
+      if (tried.find(index) != tried.end())
+        continue;
+      untried = true;
+      if (!workers_[index].busy)
+      {
+        workers_[index].busy = true;
+        next_ = index + 1;
+        return index;
+      }
+    }
+    if (!untried)
+      return -1;
+    idle_.wait(lock);
+  }
+}
+
+void WorkerPool::release(int index)
+{
+  {
+    Guard g(lock_.get());
+    if (index < static_cast<int>(workers_.size()))
+      workers_[index].busy = false;
+  }
+  idle_.conditionBroadcast();
+}
+
+AlgorithmOutput WorkerPool::run(const std::string& moduleName, const std::vector<Variable>& parameters,
+  const AlgorithmInput& input, const AlgorithmBase& reporter)
+{
+  std::set<int> tried;
+  while (true)
+  {
+    const int index = acquire(tried);
+    if (index < 0)
+      BOOST_THROW_EXCEPTION(WorkerUnavailable() << ErrorMessage(tried.empty() ?
+        "No algorithm workers are configured" : "No algorithm worker could be reached"));
+    tried.insert(index);
+
+    Worker worker;
+    {
+      Guard g(lock_.get());
+      if (index >= static_cast<int>(workers_.size()))
+        continue;
+      worker = workers_[index];
+    }
+    const std::string where = worker.host + ":" + boost::lexical_cast<std::string>(worker.port);
+
+    WorkerSession session([this, index]() { release(index); });
+    session.socket.reset(new IComSocket("scirun"));
+    IComAddress address("scirun", worker.host, boost::lexical_cast<std::string>(worker.port));
+    if (!address.isvalid() || !session.socket->create() || !session.socket->connect(address))
+    {
+      LOG_DEBUG("WorkerPool: cannot connect to worker " << where << ": " << session.socket->geterror());
+      continue;
+    }
+
+    session.connection.reset(new WorkerConnection(session.socket, worker.local));
+    auto& connection = *session.connection;
+
+    bool sent = connection.sendMessage(RUN_ALGORITHM, moduleName, worker.local ? PAYLOAD_SHARED_FILE : PAYLOAD_STREAM);
+    for (size_t i = 0; sent && i < parameters.size(); ++i)
+      sent = connection.sendParameter(parameters[i]);
+    for (const auto& item : input.items())
+    {
+      for (size_t i = 0; sent && i < item.second.size(); ++i)
+        sent = connection.sendData(INPUT, item.first, i, item.second[i]);
+    }
+    sent = sent && connection.sendMessage(EXECUTE, moduleName);
+    if (!sent)
+    {
+      LOG_DEBUG("WorkerPool: sending request to worker " << where << " failed: " << connection.error());
+      continue;
+    }
+
+    AlgorithmData::Map outputs;
+    std::string lastError;
+    IComPacketHandle packet;
+    while (true)
+    {
+      if (!connection.receive(packet))
+      {
+        const std::string message = "Lost algorithm worker " + where + " while running " + moduleName;
+        reporter.error(message);
+        BOOST_THROW_EXCEPTION(AlgorithmProcessingException() << ErrorMessage(message));
+      }
+
+      switch (packet->gettag())
+      {
+      case LOG_MESSAGE:
+        switch (packet->getparam1())
+        {
+        case LOG_ERROR: lastError = packet->getstring(); reporter.error(lastError); break;
+        case LOG_WARNING: reporter.warning(packet->getstring()); break;
+        case LOG_REMARK: reporter.remark(packet->getstring()); break;
+        default: reporter.status(packet->getstring()); break;
+        }
+        break;
+      case PROGRESS:
+        reporter.update_progress(WorkerConnection::readProgress(*packet));
+        break;
+      case OUTPUT:
+      {
+        Name name;
+        size_t i;
+        auto data = connection.receiveData(packet, name, i);
+        auto& list = outputs[name];
+        if (list.size() <= i)
+          list.resize(i + 1);
+        list[i] = data;
+        break;
+      }
+      case FINISHED:
+      {
+        AlgorithmOutput output;
+        for (const auto& item : outputs)
+          output.setList(item.first, item.second);
+        return output;
+      }
+      case FAILED:
+      {
+        // Algorithms usually log the error they throw, do not repeat it
+        const std::string message = packet->getstring();
+        if (message != lastError)
+          reporter.error(message);
+        BOOST_THROW_EXCEPTION(AlgorithmProcessingException() << ErrorMessage(message));
+      }
+      default:
+        LOG_DEBUG("WorkerPool: ignoring unexpected message " << packet->gettag() << " from worker " << where);
+      }
+    }
+  }
+}
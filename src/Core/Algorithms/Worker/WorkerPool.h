@@ -0,0 +1,107 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef ALGORITHMS_WORKER_WORKERPOOL_H
+#define ALGORITHMS_WORKER_WORKERPOOL_H
+
+#include <Core/Algorithms/Base/AlgorithmBase.h>
+#include <Core/Algorithms/Base/AlgorithmPreconditions.h>
+#include <Core/Thread/Mutex.h>
+#include <Core/Thread/ConditionVariable.h>
+#include <Core/Utils/Singleton.h>
+#include <boost/filesystem/path.hpp>
+#include <boost/noncopyable.hpp>
+#include <set>
+#include <Core/Algorithms/Worker/share.h>
+
+namespace SCIRun {
+namespace Core {
+namespace Algorithms {
+namespace Remote {
+
+  /// No worker of the pool could be reached, nothing was run.
+  struct SCISHARE WorkerUnavailable : virtual AlgorithmProcessingException {};
+
+  /// Client side of the worker protocol. Keeps the list of worker processes, local or
+  /// on other hosts, and sends algorithm runs to an idle one. Workers started on this
+  /// machine, or added as local, exchange datatypes through shared memory files;
+  /// remote workers get them streamed over the connection.
+  class SCISHARE WorkerPool : boost::noncopyable
+  {
+    CORE_SINGLETON( WorkerPool );
+
+  public:
+    WorkerPool();
+    ~WorkerPool();
+
+    /// Modules whose algorithms run on a worker. The algorithm factory wraps the
+    /// algorithms of these modules in a WorkerAlgorithm when the module is created.
+    void setOffloadedModules(const std::set<std::string>& moduleNames);
+    bool offloads(const std::string& moduleName) const;
+
+    void addWorker(const std::string& host, int port, bool local);
+
+    /// Start worker processes from the given executable on this machine, each
+    /// listening on a free port of the loopback interface. Returns how many came up.
+    int startLocalWorkers(int count, const boost::filesystem::path& executable);
+
+    /// Stop the started worker processes and forget all workers.
+    void shutdown();
+
+    size_t size() const;
+
+    /// Run the algorithm of a module on an idle worker, waiting while all of them are
+    /// busy. Log messages and progress of the remote run go to reporter. Throws
+    /// WorkerUnavailable when no worker accepts the request, and
+    /// AlgorithmProcessingException when the algorithm fails or its worker is lost.
+    AlgorithmOutput run(const std::string& moduleName, const std::vector<Variable>& parameters,
+      const AlgorithmInput& input, const AlgorithmBase& reporter);
+
+  private:
+    struct Worker
+    {
+      std::string host;
+      int port;
+      bool local;
+      bool busy;
+      int pid;
+    };
+
+    int acquire(const std::set<int>& tried);
+    void release(int index);
+
+    mutable Thread::Mutex lock_;
+    Thread::ConditionVariable idle_;
+    std::vector<Worker> workers_;
+    std::set<std::string> offloaded_;
+    size_t next_;
+  };
+
+}}}}
+
+#endif
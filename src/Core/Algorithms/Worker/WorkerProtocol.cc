@@ -0,0 +1,541 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Core/Algorithms/Worker/WorkerProtocol.h>
+#include <Core/Datatypes/String.h>
+#include <Core/Datatypes/Matrix.h>
+#include <Core/Datatypes/Legacy/Field/Field.h>
+#include <Core/Persistent/Pstreams.h>
+#include <Core/Utils/Exception.h>
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+#include <fstream>
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+#include <iomanip>
+#include <cstdlib>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace SCIRun;
+using namespace SCIRun::Core;
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Algorithms::Remote;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Thread;
+
+namespace
+{
+  const std::string FIELD_EXT(".fld");
+  const std::string MATRIX_EXT(".mat");
+  const std::string STRING_EXT(".str");
+
+  const int ChunkSize = 1 << 20;
+
+  // Values are written as <type><length>:<payload>, lists and options nest
+  // further tokens in their payload.
+  void writeToken(std::ostream& out, char type, const std::string& payload)
+  {
+    out << type << payload.size() << ':' << payload;
+  }
+
+  struct TokenReader
+  {
+    explicit TokenReader(const std::string& text) : text_(text), pos_(0) {}
+
+    bool done() const { return pos_ >= text_.size(); }
+
+    char next(std::string& payload)
+    {
+      if (done())
+        THROW_INVALID_ARGUMENT("Truncated worker parameter value");
+      char type = text_[pos_++];
+      auto colon = text_.find(':', pos_);
+      if (colon == std::string::npos)
+        THROW_INVALID_ARGUMENT("Malformed worker parameter value");
+      auto length = boost::lexical_cast<size_t>(text_.substr(pos_, colon - pos_));
+      if (colon + 1 + length > text_.size())
+        THROW_INVALID_ARGUMENT("Truncated worker parameter value");
+      payload = text_.substr(colon + 1, length);
+      pos_ = colon + 1 + length;
+      return type;
+    }
+
+    std::string nextString()
+    {
+      std::string payload;
+      if (next(payload) != 's')
+        THROW_INVALID_ARGUMENT("Expected a string in worker parameter value");
+      return payload;
+    }
+
+    const std::string& text_;
+    size_t pos_;
+  };
+
+  class ValueEncoder : public boost::static_visitor<>
+  {
+  public:
+    explicit ValueEncoder(std::ostream& out) : out_(out) {}
+
+    void operator()(int v) const { writeToken(out_, 'i', boost::lexical_cast<std::string>(v)); }
+    void operator()(double v) const
+    {
+      std::ostringstream str;
+      str << std::setprecision(17) << v;
+      writeToken(out_, 'd', str.str());
+    }
+    void operator()(const std::string& v) const { writeToken(out_, 's', v); }
+    void operator()(bool v) const { writeToken(out_, 'b', v ? "1" : "0"); }
+    void operator()(const AlgoOption& v) const
+    {
+      std::ostringstream str;
+      writeToken(str, 's', v.option_);
+      for (const auto& option : v.options_)
+        writeToken(str, 's', option);
+      writeToken(out_, 'o', str.str());
+    }
+    void operator()(const Variable::List& v) const
+    {
+      std::ostringstream str;
+      for (const auto& var : v)
+      {
+        writeToken(str, 's', var.name().name());
+        str << encodeValue(var.value());
+      }
+      writeToken(out_, 'l', str.str());
+    }
+
+  private:
+    std::ostream& out_;
+  };
+
+  Variable::Value decodeToken(char type, const std::string& payload)
+  {
+    switch (type)
+    {
+    case 'i':
+      return boost::lexical_cast<int>(payload);
+    case 'd':
+      return std::strtod(payload.c_str(), nullptr);
+    case 's':
+      return payload;
+    case 'b':
+      return payload == "1";
+    case 'o':
+    {
+      TokenReader reader(payload);
+      AlgoOption option;
+      option.option_ = reader.nextString();
+      while (!reader.done())
+        option.options_.insert(reader.nextString());
+      return option;
+    }
+    case 'l':
+    {
+      TokenReader reader(payload);
+      Variable::List list;
+      while (!reader.done())
+      {
+        auto name = reader.nextString();
+        std::string value;
+        char valueType = reader.next(value);
+        list.push_back(Variable(Name(name), decodeToken(valueType, value)));
+      }
+      return list;
+    }
+    }
+    THROW_INVALID_ARGUMENT(std::string("Unknown worker parameter type ") + type);
+  }
+
+  std::string payloadExtension(const DatatypeHandle& data)
+  {
+    if (boost::dynamic_pointer_cast<Field>(data))
+      return FIELD_EXT;
+    if (boost::dynamic_pointer_cast<Matrix>(data))
+      return MATRIX_EXT;
+    if (boost::dynamic_pointer_cast<String>(data))
+      return STRING_EXT;
+    return std::string();
+  }
+
+  template <class HType>
+  bool writeHandle(const boost::filesystem::path& file, HType handle)
+  {
+    PiostreamPtr stream = auto_ostream(file.string(), "Binary");
+    if (!stream || stream->error())
+      return false;
+    Pio(*stream, handle);
+    return !stream->error();
+  }
+
+  template <class HType>
+  DatatypeHandle readHandle(const boost::filesystem::path& file)
+  {
+    PiostreamPtr stream = auto_istream(file.string());
+    if (!stream || stream->error())
+      return DatatypeHandle();
+    HType handle;
+    Pio(*stream, handle);
+    if (stream->error())
+      return DatatypeHandle();
+    return handle;
+  }
+
+  bool writePayload(const boost::filesystem::path& file, const std::string& ext, const DatatypeHandle& data)
+  {
+    if (ext == FIELD_EXT)
+      return writeHandle(file, boost::dynamic_pointer_cast<Field>(data));
+    if (ext == MATRIX_EXT)
+      return writeHandle(file, boost::dynamic_pointer_cast<Matrix>(data));
+    if (ext == STRING_EXT)
+    {
+      PiostreamPtr stream = auto_ostream(file.string(), "Binary");
+      if (!stream || stream->error())
+        return false;
+      auto str = boost::dynamic_pointer_cast<String>(data);
+      Pio2(*stream, str);
+      return !stream->error();
+    }
+    return false;
+  }
+
+  DatatypeHandle readPayload(const boost::filesystem::path& file, const std::string& ext)
+  {
+    if (ext == FIELD_EXT)
+      return readHandle<FieldHandle>(file);
+    if (ext == MATRIX_EXT)
+      return readHandle<MatrixHandle>(file);
+    if (ext == STRING_EXT)
+    {
+      PiostreamPtr stream = auto_istream(file.string());
+      if (!stream || stream->error())
+        return DatatypeHandle();
+      StringHandle str;
+      Pio2(*stream, str);
+      return str;
+    }
+    return DatatypeHandle();
+  }
+
+  const std::string PAYLOAD_PREFIX("scirun_payload_");
+
+  boost::filesystem::path payloadFile(const boost::filesystem::path& dir, const std::string& ext)
+  {
+    return dir / boost::filesystem::unique_path(PAYLOAD_PREFIX + "%%%%-%%%%-%%%%-%%%%" + ext);
+  }
+
+  // Only names made by payloadFile() are accepted from the other end: no directories, and
+  // nothing but the prefix, hex digits and dashes before the extension.
+  bool isPayloadFileName(const std::string& name, const std::string& ext)
+  {
+    if (ext != FIELD_EXT && ext != MATRIX_EXT && ext != STRING_EXT)
+      return false;
+    if (name.size() <= PAYLOAD_PREFIX.size() + ext.size()
+      || name.compare(0, PAYLOAD_PREFIX.size(), PAYLOAD_PREFIX) != 0
+      || name.compare(name.size() - ext.size(), ext.size(), ext) != 0)
+      return false;
+    const auto unique = name.substr(PAYLOAD_PREFIX.size(), name.size() - PAYLOAD_PREFIX.size() - ext.size());
+    return std::all_of(unique.begin(), unique.end(), [](char c) { return std::isxdigit(static_cast<unsigned char>(c)) || c == '-'; });
+  }
+
+  // Payload files sit in directories every user can read, so they are created owner-only
+  // before a stream opens them by name; O_EXCL refuses a name that already exists.
+  bool createPrivateFile(const boost::filesystem::path& file)
+  {
+#ifndef _WIN32
+    int fd = ::open(file.c_str(), O_WRONLY | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+    if (fd < 0)
+      return false;
+    ::close(fd);
+#endif
+    return true;
+  }
+
+  void removeFile(const boost::filesystem::path& file)
+  {
+    boost::system::error_code ec;
+    boost::filesystem::remove(file, ec);
+  }
+}
+
+const std::string Remote::WorkerPortAnnouncement("SCIRUN_WORKER_PORT");
+
+std::string Remote::encodeValue(const Variable::Value& value)
+{
+  std::ostringstream out;
+  boost::apply_visitor(ValueEncoder(out), value);
+  return out.str();
+}
+
+Variable::Value Remote::decodeValue(const std::string& text)
+{
+  TokenReader reader(text);
+  std::string payload;
+  char type = reader.next(payload);
+  return decodeToken(type, payload);
+}
+
+bool Remote::canTransfer(const DatatypeHandle& data)
+{
+  return !payloadExtension(data).empty();
+}
+
+boost::filesystem::path Remote::sharedPayloadDirectory()
+{
+#ifndef _WIN32
+  boost::system::error_code ec;
+  const boost::filesystem::path shm("/dev/shm");
+  if (boost::filesystem::is_directory(shm, ec))
+    return shm;
+#endif
+  return boost::filesystem::temp_directory_path();
+}
+
+WorkerConnection::WorkerConnection(IComSocketHandle socket, bool sharedFiles) :
+  socket_(socket), sharedFiles_(sharedFiles), sendLock_("WorkerConnection")
+{
+}
+
+bool WorkerConnection::send(IComPacketHandle& packet)
+{
+  if (!socket_->send(packet))
+  {
+    error_ = "Could not send to worker connection: " + socket_->geterror();
+    return false;
+  }
+  return true;
+}
+
+bool WorkerConnection::sendMessage(int tag, const std::string& text, int param1)
+{
+  IComPacketHandle packet(new IComPacket);
+  packet->settag(tag);
+  packet->setparam1(param1);
+  packet->setstring(text);
+  Guard g(sendLock_.get());
+  return send(packet);
+}
+
+bool WorkerConnection::sendProgress(double fraction)
+{
+  IComPacketHandle packet(new IComPacket);
+  packet->settag(PROGRESS);
+  packet->setvalue(fraction);
+  Guard g(sendLock_.get());
+  return send(packet);
+}
+
+bool WorkerConnection::sendParameter(const Variable& parameter)
+{
+  return sendMessage(PARAMETER, parameter.name().name() + '\n' + encodeValue(parameter.value()));
+}
+
+Variable WorkerConnection::readParameter(IComPacket& packet)
+{
+  auto text = packet.getstring();
+  auto split = text.find('\n');
+  if (split == std::string::npos)
+    THROW_INVALID_ARGUMENT("Malformed worker parameter message");
+  return Variable(Name(text.substr(0, split)), decodeValue(text.substr(split + 1)));
+}
+
+double WorkerConnection::readProgress(IComPacket& packet)
+{
+  double fraction = 0;
+  packet.getvalue(fraction);
+  return fraction;
+}
+
+bool WorkerConnection::sendData(int tag, const Name& name, size_t index, const DatatypeHandle& data)
+{
+  std::ostringstream header;
+  header << name.name() << '\n' << index;
+
+  if (!data)
+    return sendMessage(tag, header.str(), PAYLOAD_NONE);
+
+  const auto ext = payloadExtension(data);
+  if (ext.empty())
+  {
+    error_ = "Datatype of " + name.name() + " cannot be sent to a worker";
+    return false;
+  }
+
+  const auto file = payloadFile(sharedFiles_ ? sharedPayloadDirectory() : boost::filesystem::temp_directory_path(), ext);
+  if (!createPrivateFile(file))
+  {
+    error_ = "Could not create payload file " + file.string();
+    return false;
+  }
+  if (!writePayload(file, ext, data))
+  {
+    removeFile(file);
+    error_ = "Could not write payload file " + file.string();
+    return false;
+  }
+
+  header << '\n' << ext;
+  IComPacketHandle packet(new IComPacket);
+  packet->settag(tag);
+
+  Guard g(sendLock_.get());
+  if (sharedFiles_)
+  {
+    // The receiver takes over the file and removes it after reading. Only the name is sent,
+    // the receiver looks for it in its own shared payload directory.
+    header << '\n' << file.filename().string();
+    packet->setparam1(PAYLOAD_SHARED_FILE);
+    packet->setstring(header.str());
+    if (!send(packet))
+    {
+      removeFile(file);
+      return false;
+    }
+    sentFiles_.push_back(file);
+    return true;
+  }
+
+  packet->setparam1(PAYLOAD_STREAM);
+  packet->setstring(header.str());
+  bool sent = send(packet) && streamFile(file);
+  removeFile(file);
+  return sent;
+}
+
+void WorkerConnection::removeUnreadFiles()
+{
+  for (const auto& file : sentFiles_)
+    removeFile(file);
+  sentFiles_.clear();
+}
+
+bool WorkerConnection::streamFile(const boost::filesystem::path& file)
+{
+  std::ifstream in(file.string().c_str(), std::ios::binary);
+  std::vector<char> buffer(ChunkSize);
+  while (in)
+  {
+    in.read(&buffer[0], buffer.size());
+    int count = static_cast<int>(in.gcount());
+    if (count <= 0)
+      break;
+    IComPacketHandle packet(new IComPacket);
+    packet->settag(DATA_CHUNK);
+    packet->set(&buffer[0], count);
+    if (!send(packet))
+      return false;
+  }
+  IComPacketHandle end(new IComPacket);
+  end->settag(DATA_END);
+  return send(end);
+}
+
+bool WorkerConnection::receive(IComPacketHandle& packet)
+{
+  packet.reset(new IComPacket);
+  if (!socket_->recv(packet))
+  {
+    error_ = "Worker connection lost: " + socket_->geterror();
+    return false;
+  }
+  return true;
+}
+
+bool WorkerConnection::receiveFile(const boost::filesystem::path& file)
+{
+  std::ofstream out(file.string().c_str(), std::ios::binary);
+  IComPacketHandle packet;
+  while (receive(packet))
+  {
+    if (packet->gettag() == DATA_END)
+      return static_cast<bool>(out);
+    if (packet->gettag() != DATA_CHUNK)
+    {
+      error_ = "Unexpected message in payload stream";
+      return false;
+    }
+    out.write(static_cast<const char*>(packet->getbuffer()), packet->getdatasize());
+  }
+  return false;
+}
+
+DatatypeHandle WorkerConnection::receiveData(IComPacketHandle& header, Name& name, size_t& index)
+{
+  std::vector<std::string> fields;
+  auto text = header->getstring();
+  boost::split(fields, text, boost::is_any_of("\n"));
+  if (fields.size() < 2)
+    THROW_INVALID_ARGUMENT("Malformed worker data message");
+
+  name = Name(fields[0]);
+  index = boost::lexical_cast<size_t>(fields[1]);
+
+  const int transfer = header->getparam1();
+  if (transfer == PAYLOAD_NONE)
+    return DatatypeHandle();
+  if (fields.size() < 3)
+    THROW_INVALID_ARGUMENT("Malformed worker data message");
+  const auto& ext = fields[2];
+
+  if (transfer == PAYLOAD_SHARED_FILE)
+  {
+    if (fields.size() < 4)
+      THROW_INVALID_ARGUMENT("Malformed worker data message");
+    if (!sharedFiles_)
+      THROW_INVALID_ARGUMENT("Shared payload on a connection without shared files");
+    if (!isPayloadFileName(fields[3], ext))
+      THROW_INVALID_ARGUMENT("Invalid shared payload name " + fields[3]);
+    const auto file = sharedPayloadDirectory() / fields[3];
+    boost::system::error_code ec;
+    if (boost::filesystem::symlink_status(file, ec).type() != boost::filesystem::regular_file)
+      THROW_INVALID_ARGUMENT("Shared payload " + fields[3] + " is not a regular file");
+    auto data = readPayload(file, ext);
+    removeFile(file);
+    if (!data)
+      THROW_INVALID_ARGUMENT("Could not read shared payload " + file.string());
+    return data;
+  }
+
+  const auto file = payloadFile(boost::filesystem::temp_directory_path(), ext);
+  if (!createPrivateFile(file))
+    THROW_INVALID_ARGUMENT("Could not create payload file " + file.string());
+  bool received = receiveFile(file);
+  auto data = received ? readPayload(file, ext) : DatatypeHandle();
+  removeFile(file);
+  if (!received)
+    THROW_INVALID_ARGUMENT(error_);
+  if (!data)
+    THROW_INVALID_ARGUMENT("Could not read streamed payload for " + name.name());
+  return data;
+}
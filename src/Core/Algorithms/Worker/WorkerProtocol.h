@@ -0,0 +1,145 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef ALGORITHMS_WORKER_WORKERPROTOCOL_H
+#define ALGORITHMS_WORKER_WORKERPROTOCOL_H
+
+#include <string>
+#include <vector>
+#include <Core/ICom/IComSocket.h>
+#include <Core/Algorithms/Base/Variable.h>
+#include <Core/Datatypes/DatatypeFwd.h>
+#include <Core/Thread/Mutex.h>
+#include <boost/filesystem/path.hpp>
+#include <boost/noncopyable.hpp>
+#include <Core/Algorithms/Worker/share.h>
+
+namespace SCIRun {
+namespace Core {
+namespace Algorithms {
+namespace Remote {
+
+  /// Packet tags of the worker protocol. A request is RUN_ALGORITHM (module name),
+  /// any number of PARAMETER and INPUT messages, then EXECUTE. The worker answers
+  /// with LOG_MESSAGE and PROGRESS while the algorithm runs, one OUTPUT per output
+  /// datatype, and FINISHED or FAILED.
+  enum WorkerMessage
+  {
+    RUN_ALGORITHM = 1,
+    PARAMETER,
+    INPUT,
+    DATA_CHUNK,
+    DATA_END,
+    EXECUTE,
+    LOG_MESSAGE,
+    PROGRESS,
+    OUTPUT,
+    FINISHED,
+    FAILED
+  };
+
+  /// How the datatype announced by an INPUT or OUTPUT message travels. Shared files
+  /// are only used between processes on the same machine; the payload is written to
+  /// the shared payload directory, only its generated name is sent, and the receiver
+  /// reads and removes it. Other names and symbolic links are rejected. Streamed
+  /// payloads follow as DATA_CHUNK packets terminated by DATA_END.
+  enum PayloadTransfer
+  {
+    PAYLOAD_NONE = 0,
+    PAYLOAD_SHARED_FILE,
+    PAYLOAD_STREAM
+  };
+
+  enum WorkerLogLevel
+  {
+    LOG_ERROR = 0,
+    LOG_WARNING,
+    LOG_REMARK,
+    LOG_STATUS
+  };
+
+  /// Printed by a worker started with --announce once it listens, followed by its port.
+  SCISHARE extern const std::string WorkerPortAnnouncement;
+
+  /// Text encoding of algorithm parameter values, including nested lists and options.
+  SCISHARE std::string encodeValue(const Variable::Value& value);
+  SCISHARE Variable::Value decodeValue(const std::string& text);
+
+  /// Fields, matrices and strings can be sent to a worker, using the binary Pio format.
+  SCISHARE bool canTransfer(const Datatypes::DatatypeHandle& data);
+
+  /// Directory for shared payload files: /dev/shm where it exists, so the files stay
+  /// in memory, otherwise the temporary directory.
+  SCISHARE boost::filesystem::path sharedPayloadDirectory();
+
+  /// One end of a worker connection. Sending is serialized, so algorithm threads on
+  /// the worker side can report progress while outputs are being sent.
+  class SCISHARE WorkerConnection : boost::noncopyable
+  {
+  public:
+    WorkerConnection(IComSocketHandle socket, bool sharedFiles);
+
+    bool sendMessage(int tag, const std::string& text, int param1 = 0);
+    bool sendProgress(double fraction);
+    bool sendParameter(const Variable& parameter);
+    bool sendData(int tag, const Name& name, size_t index, const Datatypes::DatatypeHandle& data);
+
+    /// Blocks for the next packet, returns false when the connection is lost.
+    bool receive(IComPacketHandle& packet);
+
+    /// Reads the datatype announced by an INPUT or OUTPUT packet, including the
+    /// chunks of a streamed payload. Returns a null handle for an empty input.
+    Datatypes::DatatypeHandle receiveData(IComPacketHandle& header, Name& name, size_t& index);
+
+    static Variable readParameter(IComPacket& packet);
+    static double readProgress(IComPacket& packet);
+
+    /// Remove the shared payload files sent on this connection that the other end
+    /// did not take over, e.g. because it exited.
+    void removeUnreadFiles();
+
+    bool sharedFiles() const { return sharedFiles_; }
+    std::string error() const { return error_; }
+
+  private:
+    bool send(IComPacketHandle& packet);
+    bool streamFile(const boost::filesystem::path& file);
+    bool receiveFile(const boost::filesystem::path& file);
+
+    IComSocketHandle socket_;
+    bool sharedFiles_;
+    std::vector<boost::filesystem::path> sentFiles_;
+    std::string error_;
+    Thread::Mutex sendLock_;
+  };
+
+  typedef boost::shared_ptr<WorkerConnection> WorkerConnectionHandle;
+
+}}}}
+
+#endif
@@ -33,8 +33,10 @@
 #include <Dataflow/Engine/Controller/NetworkEditorController.h>
 #include <Modules/Factory/HardCodedModuleFactory.h>
 #include <Core/Algorithms/Factory/HardCodedAlgorithmFactory.h>
+#include <Core/Algorithms/Worker/WorkerPool.h>
 #include <Dataflow/State/SimpleMapModuleState.h>
 #include <Dataflow/Network/Module.h>  //TODO move Reex
+#include <Dataflow/Network/PortDataCache.h>
 #include <Dataflow/Engine/Scheduler/DesktopExecutionStrategyFactory.h>
 #include <Core/Command/GlobalCommandBuilderFromCommandLine.h>
 #include <Core/Logging/Log.h>
@@ -98,6 +100,7 @@ void Application::shutdown()
     Log::get() << NOTICE << "Application shutdown called with null internals" << std::endl;
   try
   {
+    Remote::WorkerPool::Instance().shutdown();
     private_.reset();
   }
   catch (std::exception& e)
@@ -170,6 +173,12 @@ NetworkEditorControllerHandle Application::controller()
     ReexecuteStrategyFactoryHandle reexFactory(new DynamicReexecutionStrategyFactory(parameters()->reexecuteMode()));
     private_->controller_.reset(new NetworkEditorController(moduleFactory, sf, exe, algoFactory, reexFactory, private_->cmdFactory_));
 
+    auto portCacheBudget = parameters()->portCacheBudget();
+    if (portCacheBudget && *portCacheBudget > 0)
+      PortDataCache::Instance().setMemoryBudget(static_cast<size_t>(*portCacheBudget) * 1024 * 1024);
+
+    configureAlgorithmWorkers();
+
     /// @todo: sloppy way to initialize this but similar to v4, oh well
     IEPluginManager::Initialize();
 
@@ -180,6 +189,40 @@ NetworkEditorControllerHandle Application::controller()
   return private_->controller_;
 }
 
+void Application::configureAlgorithmWorkers()
+{
+  const auto& modules = parameters()->offloadedModules();
+  if (modules.empty())
+    return;
+
+  auto& pool = Remote::WorkerPool::Instance();
+  pool.setOffloadedModules(std::set<std::string>(modules.begin(), modules.end()));
+
+  for (const auto& worker : parameters()->algorithmWorkers())
+  {
+    auto colon = worker.rfind(':');
+    int port = 0;
+    if (colon != std::string::npos)
+      port = atoi(worker.c_str() + colon + 1);
+    if (colon == std::string::npos || colon == 0 || port <= 0)
+    {
+      Log::get() << ERROR_LOG << "Algorithm worker should be given as host:port, ignoring " << worker << std::endl;
+      continue;
+    }
+    pool.addWorker(worker.substr(0, colon), port, false);
+  }
+
+  auto localWorkers = parameters()->localWorkers();
+  if (localWorkers && *localWorkers > 0)
+  {
+    auto started = pool.startLocalWorkers(*localWorkers, executablePath() / "SCIRunAlgorithmWorker");
+    Log::get() << INFO << "Started " << started << " local algorithm workers" << std::endl;
+  }
+
+  if (pool.size() == 0)
+    Log::get() << WARN << "No algorithm workers available, offloaded modules run in process" << std::endl;
+}
+
 void Application::executeCommandLineRequests()
 {
   ENSURE_NOT_NULL(private_, "Application internals are uninitialized!");
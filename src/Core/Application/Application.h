@@ -104,6 +104,9 @@ public:
 #endif
 
 private:
+  /// Set up the worker pool for the modules listed with --offload.
+  void configureAlgorithmWorkers();
+
 	ApplicationPrivateHandle private_;
 
 //public:
@@ -90,6 +90,17 @@ using namespace SCIRun::Core::Algorithms;
         load->set(Name("FileNum"), i);
         q->enqueue(load);
 
+        if (params->parameterSweepFile())
+        {
+          if (params->disableGui())
+          {
+            q->enqueue(cmdFactory_->create(RunParameterSweep));
+            q->enqueue(cmdFactory_->create(QuitCommand));
+            return q;
+          }
+          std::cout << "Parameter sweeps run in headless mode only, ignoring --sweep" << std::endl;
+        }
+
         if (params->executeNetwork())
           q->enqueue(cmdFactory_->create(ExecuteCurrentNetwork));
         else if (params->executeNetworkAndQuit())
@@ -30,7 +30,10 @@
 #include <boost/program_options.hpp>
 #include <boost/make_shared.hpp>
 #include <boost/algorithm/string/join.hpp>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/classification.hpp>
 
+#include <algorithm>
 #include <iostream>
 
 using namespace SCIRun::Core::CommandLine;
@@ -65,6 +68,12 @@ public:
       ("reexecuteMode", po::value<std::string>(), "network reexecution mode--DEVELOPER USE ONLY")
       ("frameInitLimit", po::value<int>(), "ViewScene frame init limit--increase if renderer fails")
       ("list-modules", "print list of available modules")
+      ("portCacheBudget", po::value<int>(), "port data memory budget in MB")
+      ("checkpoint", "keep port data next to saved networks")
+      ("sweep", po::value<std::string>(), "run a parameter sweep spec on the network (headless)")
+      ("offload", po::value<std::string>(), "comma separated modules to run in algorithm workers")
+      ("localWorkers", po::value<int>(), "number of algorithm worker processes to start")
+      ("worker", po::value<std::vector<std::string>>(), "algorithm worker at host:port")
       ;
 
       positional_.add("input-file", -1);
@@ -117,12 +126,13 @@ public:
       bool disableSplash,
       bool isRegressionMode,
       bool isVerboseMode,
-      bool printModules) : help_(help), version_(version), executeNetwork_(executeNetwork),
+      bool printModules,
+      bool networkCheckpoints) : help_(help), version_(version), executeNetwork_(executeNetwork),
       executeNetworkAndQuit_(executeNetworkAndQuit), disableGui_(disableGui),
       disableSplash_(disableSplash), isRegressionMode_(isRegressionMode), isVerboseMode_(isVerboseMode),
-      printModules_(printModules)
+      printModules_(printModules), networkCheckpoints_(networkCheckpoints)
     {}
-    bool help_, version_, executeNetwork_, executeNetworkAndQuit_, disableGui_, disableSplash_, isRegressionMode_, isVerboseMode_, printModules_;
+    bool help_, version_, executeNetwork_, executeNetworkAndQuit_, disableGui_, disableSplash_, isRegressionMode_, isVerboseMode_, printModules_, networkCheckpoints_;
   };
   ApplicationParametersImpl(
     const std::string& entireCommandLine,
@@ -133,11 +143,18 @@ public:
     const boost::optional<std::string>& reexecuteMode,
     const boost::optional<int>& frameInitLimit,
     const boost::optional<int>& regressionTimeout,
+    const boost::optional<int>& portCacheBudget,
+    const boost::optional<boost::filesystem::path>& parameterSweepFile,
+    std::vector<std::string>&& offloadedModules,
+    std::vector<std::string>&& algorithmWorkers,
+    const boost::optional<int>& localWorkers,
     const Flags& flags
    ) : entireCommandLine_(entireCommandLine),
     inputFiles_(inputFiles), pythonScriptFile_(pythonScriptFile), dataDirectory_(dataDirectory),
+    parameterSweepFile_(parameterSweepFile),
     threadMode_(threadMode), reexecuteMode_(reexecuteMode), frameInitLimit_(frameInitLimit),
-    regressionTimeout_(regressionTimeout),
+    regressionTimeout_(regressionTimeout), portCacheBudget_(portCacheBudget),
+    offloadedModules_(offloadedModules), algorithmWorkers_(algorithmWorkers), localWorkers_(localWorkers),
     flags_(flags)
   {}
 
@@ -156,6 +173,11 @@ public:
     return dataDirectory_;
   }
 
+  virtual boost::optional<boost::filesystem::path> parameterSweepFile() const override
+  {
+    return parameterSweepFile_;
+  }
+
   virtual bool help() const override
   {
     return flags_.help_;
@@ -216,11 +238,36 @@ public:
     return frameInitLimit_;
   }
 
+  virtual boost::optional<int> portCacheBudget() const override
+  {
+    return portCacheBudget_;
+  }
+
+  virtual const std::vector<std::string>& offloadedModules() const override
+  {
+    return offloadedModules_;
+  }
+
+  virtual const std::vector<std::string>& algorithmWorkers() const override
+  {
+    return algorithmWorkers_;
+  }
+
+  virtual boost::optional<int> localWorkers() const override
+  {
+    return localWorkers_;
+  }
+
   virtual bool printModuleList() const override
   {
     return flags_.printModules_;
   }
 
+  virtual bool networkCheckpoints() const override
+  {
+    return flags_.networkCheckpoints_;
+  }
+
   virtual const std::string& entireCommandLine() const override
   {
     return entireCommandLine_;
@@ -231,8 +278,11 @@ private:
   std::vector<std::string> inputFiles_;
   boost::optional<boost::filesystem::path> pythonScriptFile_;
   boost::optional<boost::filesystem::path> dataDirectory_;
+  boost::optional<boost::filesystem::path> parameterSweepFile_;
   boost::optional<std::string> threadMode_, reexecuteMode_;
-  boost::optional<int> frameInitLimit_, regressionTimeout_;
+  boost::optional<int> frameInitLimit_, regressionTimeout_, portCacheBudget_;
+  std::vector<std::string> offloadedModules_, algorithmWorkers_;
+  boost::optional<int> localWorkers_;
   Flags flags_;
 };
 
@@ -264,10 +314,25 @@ ApplicationParametersHandle CommandLineParser::parse(int argc, const char* argv[
     {
       dataDirectory = boost::filesystem::path(parsed["datadir"].as<std::string>());
     }
+    auto parameterSweepFile = boost::optional<boost::filesystem::path>();
+    if (parsed.count("sweep") != 0 && !parsed["sweep"].empty() && !parsed["sweep"].defaulted())
+    {
+      parameterSweepFile = boost::filesystem::path(parsed["sweep"].as<std::string>());
+    }
     auto threadMode = parsed.count("threadMode") != 0 ? parsed["threadMode"].as<std::string>() : boost::optional<std::string>();
     auto reexecuteMode = parsed.count("reexecuteMode") != 0 ? parsed["reexecuteMode"].as<std::string>() : boost::optional<std::string>();
     auto frameInitLimit = parsed.count("frameInitLimit") != 0 ? parsed["frameInitLimit"].as<int>() : boost::optional<int>();
     auto regressionTimeout = parsed.count("regression") != 0 ? parsed["regression"].as<int>() : boost::optional<int>();
+    auto portCacheBudget = parsed.count("portCacheBudget") != 0 ? parsed["portCacheBudget"].as<int>() : boost::optional<int>();
+    std::vector<std::string> offloadedModules;
+    if (parsed.count("offload") != 0)
+    {
+      auto modules = parsed["offload"].as<std::string>();
+      boost::algorithm::split(offloadedModules, modules, boost::is_any_of(","), boost::token_compress_on);
+      offloadedModules.erase(std::remove(offloadedModules.begin(), offloadedModules.end(), std::string()), offloadedModules.end());
+    }
+    auto algorithmWorkers = parsed.count("worker") != 0 ? parsed["worker"].as<std::vector<std::string>>() : std::vector<std::string>();
+    auto localWorkers = parsed.count("localWorkers") != 0 ? parsed["localWorkers"].as<int>() : boost::optional<int>();
     return boost::make_shared<ApplicationParametersImpl>
       (boost::algorithm::join(cmdline, " "),
       std::move(inputFiles),
@@ -277,6 +342,11 @@ ApplicationParametersHandle CommandLineParser::parse(int argc, const char* argv[
       reexecuteMode,
       frameInitLimit,
       regressionTimeout,
+      portCacheBudget,
+      parameterSweepFile,
+      std::move(offloadedModules),
+      std::move(algorithmWorkers),
+      localWorkers,
       ApplicationParametersImpl::Flags(
         parsed.count("help") != 0,
         parsed.count("version") != 0,
@@ -286,7 +356,8 @@ ApplicationParametersHandle CommandLineParser::parse(int argc, const char* argv[
         parsed.count("no_splash") != 0,
         parsed.count("regression") != 0,
         parsed.count("verbose") != 0,
-        parsed.count("list-modules") != 0)
+        parsed.count("list-modules") != 0,
+        parsed.count("checkpoint") != 0)
       );
   }
   catch (std::exception& e)
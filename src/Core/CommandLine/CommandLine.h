@@ -47,6 +47,7 @@ namespace SCIRun {
         virtual const std::vector<std::string>& inputFiles() const = 0;
         virtual boost::optional<boost::filesystem::path> pythonScriptFile() const = 0;
         virtual boost::optional<boost::filesystem::path> dataDirectory() const = 0;
+        virtual boost::optional<boost::filesystem::path> parameterSweepFile() const = 0;
         virtual bool help() const = 0;
         virtual bool version() const = 0;
         virtual bool executeNetwork() const = 0;
@@ -59,7 +60,12 @@ namespace SCIRun {
         virtual boost::optional<std::string> threadMode() const = 0;
         virtual boost::optional<std::string> reexecuteMode() const = 0;
         virtual boost::optional<int> frameInitLimit() const = 0;
+        virtual boost::optional<int> portCacheBudget() const = 0;
+        virtual const std::vector<std::string>& offloadedModules() const = 0;
+        virtual const std::vector<std::string>& algorithmWorkers() const = 0;
+        virtual boost::optional<int> localWorkers() const = 0;
         virtual bool printModuleList() const = 0;
+        virtual bool networkCheckpoints() const = 0;
         virtual const std::string& entireCommandLine() const = 0;
       };
 
@@ -55,7 +55,13 @@ TEST(ScirunCommandLineSpecTest, CanReadBasicOptions)
     "  --reexecuteMode arg     network reexecution mode--DEVELOPER USE ONLY\n"
     "  --frameInitLimit arg    ViewScene frame init limit--increase if renderer \n"
     "                          fails\n"
-    "  --list-modules          print list of available modules\n";
+    "  --list-modules          print list of available modules\n"
+    "  --portCacheBudget arg   port data memory budget in MB\n"
+    "  --checkpoint            keep port data next to saved networks\n"
+    "  --sweep arg             run a parameter sweep spec on the network (headless)\n"
+    "  --offload arg           comma separated modules to run in algorithm workers\n"
+    "  --localWorkers arg      number of algorithm worker processes to start\n"
+    "  --worker arg            algorithm worker at host:port\n";
 
   EXPECT_EQ(expectedHelp, parser.describe());
 
@@ -155,4 +161,55 @@ TEST(ScirunCommandLineSpecTest, CanReadBasicOptions)
     ASSERT_TRUE(!!aph->threadMode());
     EXPECT_EQ("serial", *aph->threadMode());
   }
+
+  {
+    const char* argv[] = {"scirun.exe", "--portCacheBudget", "2048"};
+    int argc = sizeof(argv)/sizeof(char*);
+
+    ApplicationParametersHandle aph = parser.parse(argc, argv);
+
+    ASSERT_TRUE(!!aph->portCacheBudget());
+    EXPECT_EQ(2048, *aph->portCacheBudget());
+    EXPECT_FALSE(aph->networkCheckpoints());
+  }
+
+  {
+    const char* argv[] = {"scirun.exe", "--checkpoint", "net.srn5"};
+    int argc = sizeof(argv)/sizeof(char*);
+
+    ApplicationParametersHandle aph = parser.parse(argc, argv);
+
+    EXPECT_TRUE(aph->networkCheckpoints());
+    EXPECT_EQ("net.srn5", aph->inputFiles()[0]);
+    EXPECT_FALSE(!!aph->parameterSweepFile());
+  }
+
+  {
+    const char* argv[] = {"scirun.exe", "-x", "--sweep", "conductivity.txt", "net.srn5"};
+    int argc = sizeof(argv)/sizeof(char*);
+
+    ApplicationParametersHandle aph = parser.parse(argc, argv);
+
+    EXPECT_TRUE(aph->disableGui());
+    ASSERT_TRUE(!!aph->parameterSweepFile());
+    EXPECT_EQ("conductivity.txt", aph->parameterSweepFile()->string());
+    EXPECT_EQ("net.srn5", aph->inputFiles()[0]);
+  }
+
+  {
+    const char* argv[] = {"scirun.exe", "--offload", "FairMesh,ClipVolumeByIsovalue", "--localWorkers", "2",
+      "--worker", "node1:9001", "--worker", "node2:9001", "net.srn5"};
+    int argc = sizeof(argv)/sizeof(char*);
+
+    ApplicationParametersHandle aph = parser.parse(argc, argv);
+
+    ASSERT_EQ(2u, aph->offloadedModules().size());
+    EXPECT_EQ("FairMesh", aph->offloadedModules()[0]);
+    EXPECT_EQ("ClipVolumeByIsovalue", aph->offloadedModules()[1]);
+    ASSERT_TRUE(!!aph->localWorkers());
+    EXPECT_EQ(2, *aph->localWorkers());
+    ASSERT_EQ(2u, aph->algorithmWorkers().size());
+    EXPECT_EQ("node2:9001", aph->algorithmWorkers()[1]);
+    EXPECT_EQ("net.srn5", aph->inputFiles()[0]);
+  }
 }
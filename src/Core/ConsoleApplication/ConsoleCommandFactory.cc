@@ -60,6 +60,8 @@ CommandHandle ConsoleGlobalCommandFactory::create(GlobalCommands type) const
     return boost::make_shared<RunPythonScriptCommandConsole>();
   case ExecuteCurrentNetwork:
     return boost::make_shared<ExecuteCurrentNetworkCommandConsole>();
+  case RunParameterSweep:
+    return boost::make_shared<RunParameterSweepCommandConsole>();
   case SetupQuitAfterExecute:
     return boost::make_shared<QuitAfterExecuteCommandConsole>();
   case QuitCommand:
@@ -28,6 +28,7 @@ DEALINGS IN THE SOFTWARE.
 
 #include <Core/ConsoleApplication/ConsoleCommands.h>
 #include <Dataflow/Engine/Controller/NetworkEditorController.h>
+#include <Dataflow/Network/NetworkCheckpoint.h>
 #include <Core/Application/Application.h>
 #include <Dataflow/Serialization/Network/XMLSerializer.h>
 #include <Dataflow/Serialization/Network/NetworkDescriptionSerialization.h>
@@ -62,6 +63,8 @@ bool LoadFileCommandConsole::execute()
       {
         Application::Instance().controller()->clear();
         Application::Instance().controller()->loadNetwork(openedFile);
+        if (Application::Instance().parameters()->networkCheckpoints())
+          NetworkCheckpoint(filename).restore(*Application::Instance().controller()->getNetwork());
         /// @todo: real logger
         std::cout << "File load done: " << filename << std::endl;
         return true;
@@ -93,6 +96,31 @@ bool ExecuteCurrentNetworkCommandConsole::execute()
   return true;
 }
 
+bool RunParameterSweepCommandConsole::execute()
+{
+  auto specFile = Application::Instance().parameters()->parameterSweepFile();
+  if (!specFile)
+    return false;
+
+  std::cout << "Running parameter sweep " << specFile->string() << std::endl;
+  try
+  {
+    auto results = Application::Instance().controller()->runParameterSweep(SCIRun::Dataflow::Engine::ParameterSweepSpec::read(*specFile));
+    bool allSucceeded = true;
+    for (const auto& result : results)
+    {
+      std::cout << "  " << result.name << ": " << (result.succeeded ? "done" : "failed, " + result.message) << std::endl;
+      allSucceeded = allSucceeded && result.succeeded;
+    }
+    return allSucceeded;
+  }
+  catch (ExceptionBase& e)
+  {
+    std::cout << "Parameter sweep failed: " << e.what() << std::endl;
+  }
+  return false;
+}
+
 bool QuitAfterExecuteCommandConsole::execute()
 {
   std::cout << "Goodbye!" << std::endl;
@@ -66,6 +66,12 @@ namespace Console {
     virtual bool execute() override;
   };
 
+  class SCISHARE RunParameterSweepCommandConsole : public Core::Commands::ConsoleCommand
+  {
+  public:
+    virtual bool execute() override;
+  };
+
   class SCISHARE QuitAfterExecuteCommandConsole : public Core::Commands::ConsoleCommand
   {
   public:
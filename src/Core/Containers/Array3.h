@@ -41,7 +41,12 @@
 #ifndef CORE_CONAINTERS_ARRAY3_H
 #define CORE_CONAINTERS_ARRAY3_H 1
 
-#include <boost/multi_array.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/checked_delete.hpp>
+#include <boost/type_traits/is_pod.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <new>
 
 #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
 #include <sci_defs/bits_defs.h>
@@ -60,26 +65,93 @@
 
 namespace SCIRun {
 
+/// Dense 3D array stored in row major order (the last index is contiguous).
+/// The storage is either owned by the array or shared with another object,
+/// for instance a nrrd whose buffer is used as field data without copying.
+/// Shared storage is a view, not copy-on-write: writes through the array are
+/// seen by the other owner and vice versa. Copies and resize() always give
+/// the array private storage, so modules that clone a field before changing
+/// it (as they are required to) never write into memory shared with a nrrd.
 template<class T> 
 class Array3 
 {
 public:
-  typedef boost::multi_array<T, 3> impl_type;
   typedef T value_type;
 
-  Array3() {}
+  Array3() : data_(0), shared_(false)
+  {
+    dims_[0] = dims_[1] = dims_[2] = 0;
+  }
 
-  Array3(size_t size1, size_t size2, size_t size3) 
+  Array3(size_t size1, size_t size2, size_t size3) : data_(0), shared_(false)
   {
+    dims_[0] = dims_[1] = dims_[2] = 0;
     resize(size1, size2, size3);
   }
 
+  Array3(const Array3& copy) : data_(0), shared_(false)
+  {
+    dims_[0] = dims_[1] = dims_[2] = 0;
+    copy_from(copy);
+  }
+
+  Array3& operator=(const Array3& copy)
+  {
+    if (this != &copy) copy_from(copy);
+    return *this;
+  }
+
+  /// Elements in the overlapping range keep their values, new ones are
+  /// value initialized. Shared storage is replaced by a private copy even if
+  /// the dimensions do not change.
   void resize(size_t size1, size_t size2, size_t size3)
   {
-    typename impl_type::extent_gen extents;
-    impl_.resize(extents[size1][size2][size3]);
+    if (size1 == dims_[0] && size2 == dims_[1] && size3 == dims_[2])
+    {
+      if (shared_) copy_from(*this);
+      return;
+    }
+
+    boost::shared_ptr<T> storage = allocate(size1*size2*size3);
+    T* data = storage.get();
+
+    const size_t n1 = std::min(size1, dims_[0]);
+    const size_t n2 = std::min(size2, dims_[1]);
+    const size_t n3 = std::min(size3, dims_[2]);
+    for (size_t i = 0; i < n1; i++)
+      for (size_t j = 0; j < n2; j++)
+        std::copy(data_ + (i*dims_[1] + j)*dims_[2],
+                  data_ + (i*dims_[1] + j)*dims_[2] + n3,
+                  data + (i*size2 + j)*size3);
+
+    storage_ = storage;
+    data_ = data;
+    dims_[0] = size1; dims_[1] = size2; dims_[2] = size3;
+    shared_ = false;
+  }
+
+  /// Use memory owned by another object as storage, without copying it.
+  /// The owner is kept alive for as long as the array refers to the memory.
+  void share(T* data, size_t size1, size_t size2, size_t size3,
+             const boost::shared_ptr<void>& owner)
+  {
+    storage_ = boost::shared_ptr<T>(owner, data);
+    data_ = data;
+    dims_[0] = size1; dims_[1] = size2; dims_[2] = size3;
+    shared_ = true;
+  }
+
+  /// Hand the storage to another object, e.g. as the buffer of a nrrd. The
+  /// returned pointer keeps the memory alive even if the array is resized or
+  /// destroyed; from then on the array counts as shared.
+  boost::shared_ptr<void> shared_storage()
+  {
+    shared_ = (storage_.get() != 0);
+    return storage_;
   }
 
+  bool is_shared() const { return shared_; }
+
   size_t size() const
   {
     return dim1() * dim2() * dim3();
@@ -87,30 +159,58 @@ public:
 
   T& operator[](size_t idx)
   {
-    return impl_.origin()[idx];
+    return data_[idx];
   }
 
   const T& operator[](size_t idx) const
   {
-    return impl_.origin()[idx];
+    return data_[idx];
   }
 
   const T& operator()(size_t i1, size_t i2, size_t i3) const
   {
-    return impl_[i1][i2][i3];
+    return data_[(i1*dims_[1] + i2)*dims_[2] + i3];
   }
 
   T& operator()(size_t i1, size_t i2, size_t i3) 
   {
-    return impl_[i1][i2][i3];
+    return data_[(i1*dims_[1] + i2)*dims_[2] + i3];
   }
 
-  inline size_t dim1() const {return impl_.shape()[0];}
-  inline size_t dim2() const {return impl_.shape()[1];}
-  inline size_t dim3() const {return impl_.shape()[2];}
+  inline size_t dim1() const {return dims_[0];}
+  inline size_t dim2() const {return dims_[1];}
+  inline size_t dim3() const {return dims_[2];}
 
 private:
-  impl_type impl_;
+  void copy_from(const Array3& copy)
+  {
+    boost::shared_ptr<T> storage = allocate(copy.size());
+    if (copy.size() > 0) std::copy(copy.data_, copy.data_ + copy.size(), storage.get());
+    storage_ = storage;
+    data_ = storage.get();
+    dims_[0] = copy.dims_[0]; dims_[1] = copy.dims_[1]; dims_[2] = copy.dims_[2];
+    shared_ = false;
+  }
+
+  // Plain data comes zeroed from calloc, which maps large blocks lazily:
+  // a buffer that is replaced by shared memory right after the field is
+  // created never costs any physical memory.
+  static boost::shared_ptr<T> allocate(size_t n)
+  {
+    if (n == 0) return boost::shared_ptr<T>();
+    if (boost::is_pod<T>::value)
+    {
+      T* data = static_cast<T*>(std::calloc(n, sizeof(T)));
+      if (!data) throw std::bad_alloc();
+      return boost::shared_ptr<T>(data, std::free);
+    }
+    return boost::shared_ptr<T>(new T[n](), boost::checked_array_deleter<T>());
+  }
+
+  boost::shared_ptr<T> storage_;
+  T* data_;
+  size_t dims_[3];
+  bool shared_;
 };
 
 template<class T> void Pio(Piostream& stream, Array3<T>& array);
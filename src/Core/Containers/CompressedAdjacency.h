@@ -0,0 +1,256 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+/// @file   CompressedAdjacency.h
+/// @brief  Compressed row storage for mesh adjacency lists
+
+#ifndef CORE_CONTAINERS_COMPRESSEDADJACENCY_H
+#define CORE_CONTAINERS_COMPRESSEDADJACENCY_H 1
+
+#include <algorithm>
+#include <vector>
+
+namespace SCIRun {
+
+/// Replacement for std::vector<std::vector<T> > as used for node-to-element
+/// tables: all rows are stored back to back in a single array and located
+/// through an offset array, so building the table costs two allocations
+/// instead of one per row.
+///
+/// Rows can still be modified after the table has been built, for meshes
+/// that are edited while their neighbor information is kept synchronized.
+/// A row that outgrows its slot is moved to the end of the value array;
+/// the space it leaves behind is reclaimed when it exceeds half the array.
+template<class T>
+class CompressedAdjacency
+{
+public:
+  typedef T value_type;
+
+  /// Read only view of one row.
+  class Row
+  {
+  public:
+    typedef const T* const_iterator;
+    Row(const T* b, const T* e) : begin_(b), end_(e) {}
+    const_iterator begin() const { return begin_; }
+    const_iterator end() const { return end_; }
+    size_t size() const { return static_cast<size_t>(end_ - begin_); }
+    bool empty() const { return begin_ == end_; }
+    const T& operator[](size_t i) const { return begin_[i]; }
+  private:
+    const T* begin_;
+    const T* end_;
+  };
+
+  CompressedAdjacency() : waste_(0) {}
+
+  /// Number of rows.
+  size_t size() const { return offsets_.empty() ? 0 : offsets_.size() - 1; }
+  bool empty() const { return size() == 0; }
+
+  /// Total number of entries in all rows.
+  size_t num_values() const
+  {
+    return values_.size() - waste_ - (ends_.empty() ? 0 : slack());
+  }
+
+  Row operator[](size_t row) const
+  {
+    const T* base = values_.empty() ? 0 : &values_[0];
+    return Row(base + offsets_[row], base + row_end(row));
+  }
+
+  /// Remove all rows and free the memory.
+  void clear()
+  {
+    std::vector<size_t>().swap(offsets_);
+    std::vector<size_t>().swap(ends_);
+    std::vector<size_t>().swap(limits_);
+    std::vector<T>().swap(values_);
+    waste_ = 0;
+  }
+
+  /// Reset to num_rows empty rows.
+  void resize(size_t num_rows)
+  {
+    clear();
+    offsets_.assign(num_rows + 1, 0);
+  }
+
+  /// Build the inverse of a mapping: entry i of keys names the row that
+  /// value(i) is added to. Rows list their values in increasing i.
+  template<class KEYS, class VALUE>
+  void build_inverse(size_t num_rows, const KEYS& keys, VALUE value)
+  {
+    resize(num_rows);
+    const size_t n = keys.size();
+    for (size_t i = 0; i < n; i++)
+      offsets_[static_cast<size_t>(keys[i]) + 1]++;
+    for (size_t r = 0; r < num_rows; r++)
+      offsets_[r + 1] += offsets_[r];
+
+    values_.resize(n);
+    std::vector<size_t> fill(offsets_.begin(), offsets_.end() - 1);
+    for (size_t i = 0; i < n; i++)
+      values_[fill[static_cast<size_t>(keys[i])]++] = value(i);
+  }
+
+  /// Take over rows that were assembled by the caller: row r holds
+  /// values[offsets[r]] up to values[offsets[r+1]]. Both vectors are left
+  /// empty.
+  void assign(std::vector<size_t>& offsets, std::vector<T>& values)
+  {
+    clear();
+    offsets_.swap(offsets);
+    values_.swap(values);
+  }
+
+  /// Append an empty row.
+  void push_row()
+  {
+    if (offsets_.empty()) offsets_.push_back(0);
+    if (ends_.empty())
+    {
+      offsets_.push_back(offsets_.back());
+    }
+    else
+    {
+      offsets_.back() = values_.size();
+      offsets_.push_back(values_.size());
+      ends_.push_back(values_.size());
+      limits_.push_back(values_.size());
+    }
+  }
+
+  /// Append a value to a row.
+  void push_back(size_t row, const T& value)
+  {
+    unpack();
+    if (ends_[row] == limits_[row])
+    {
+      const size_t sz = ends_[row] - offsets_[row];
+      if (limits_[row] == values_.size())
+      {
+        values_.resize(values_.size() + std::max<size_t>(sz, 4));
+      }
+      else
+      {
+        const size_t start = values_.size();
+        values_.resize(start + std::max<size_t>(2 * sz, 4));
+        std::copy(values_.begin() + offsets_[row], values_.begin() + ends_[row],
+                  values_.begin() + start);
+        waste_ += limits_[row] - offsets_[row];
+        offsets_[row] = start;
+        ends_[row] = start + sz;
+      }
+      limits_[row] = values_.size();
+    }
+    values_[ends_[row]++] = value;
+    if (2 * waste_ > values_.size()) compact();
+  }
+
+  /// Remove the first occurrence of value from a row, keeping the order of
+  /// the other values. Returns false if the row does not contain the value.
+  bool erase(size_t row, const T& value)
+  {
+    unpack();
+    typename std::vector<T>::iterator b = values_.begin() + offsets_[row];
+    typename std::vector<T>::iterator e = values_.begin() + ends_[row];
+    typename std::vector<T>::iterator it = std::find(b, e, value);
+    if (it == e) return false;
+    std::copy(it + 1, e, it);
+    ends_[row]--;
+    return true;
+  }
+
+  /// Remove all values from a row.
+  void clear_row(size_t row)
+  {
+    unpack();
+    ends_[row] = offsets_[row];
+  }
+
+  /// Store all rows back to back again, dropping unused space.
+  void compact()
+  {
+    if (ends_.empty()) return;
+    const size_t num_rows = size();
+    std::vector<T> values;
+    values.reserve(num_values());
+    for (size_t r = 0; r < num_rows; r++)
+    {
+      const size_t start = values.size();
+      values.insert(values.end(), values_.begin() + offsets_[r], values_.begin() + ends_[r]);
+      offsets_[r] = start;
+    }
+    offsets_[num_rows] = values.size();
+    values_.swap(values);
+    std::vector<size_t>().swap(ends_);
+    std::vector<size_t>().swap(limits_);
+    waste_ = 0;
+  }
+
+  /// Memory used by the table in bytes.
+  size_t memory_size() const
+  {
+    return sizeof(*this) + values_.capacity() * sizeof(T) +
+      (offsets_.capacity() + ends_.capacity() + limits_.capacity()) * sizeof(size_t);
+  }
+
+private:
+  size_t row_end(size_t row) const
+  {
+    return ends_.empty() ? offsets_[row + 1] : ends_[row];
+  }
+
+  size_t slack() const
+  {
+    size_t s = 0;
+    for (size_t r = 0; r < ends_.size(); r++) s += limits_[r] - ends_[r];
+    return s;
+  }
+
+  /// Switch to per row end and capacity so rows can change size.
+  void unpack()
+  {
+    if (!ends_.empty() || offsets_.size() < 2) return;
+    ends_.assign(offsets_.begin() + 1, offsets_.end());
+    limits_ = ends_;
+  }
+
+  std::vector<size_t> offsets_;
+  std::vector<size_t> ends_;
+  std::vector<size_t> limits_;
+  std::vector<T>      values_;
+  size_t              waste_;
+};
+
+}
+
+#endif
@@ -0,0 +1,212 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+/// @file   SortedVectorMap.h
+/// @brief  Map stored as a sorted array, for large lookup tables
+
+#ifndef CORE_CONTAINERS_SORTEDVECTORMAP_H
+#define CORE_CONTAINERS_SORTEDVECTORMAP_H 1
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace SCIRun {
+
+/// Associative table for the edge and face lookups of unstructured meshes.
+/// Entries live in one array sorted by key and are found by binary search;
+/// tables built in bulk are handed over in sorted order with assign_sorted().
+///
+/// Entries inserted later go to a small side table and are merged into the
+/// sorted array once it grows past an eighth of the array; erased entries are
+/// flagged and dropped on the next merge. Like a hash map, inserting or
+/// erasing may invalidate iterators, and find() returns end() if the key is
+/// not present. Iteration over the table is not supported.
+template<class KEY, class VALUE, class COMPARE = std::less<KEY> >
+class SortedVectorMap
+{
+public:
+  typedef KEY                   key_type;
+  typedef VALUE                 mapped_type;
+  typedef std::pair<KEY, VALUE> value_type;
+  typedef value_type*           iterator;
+  typedef const value_type*     const_iterator;
+
+  explicit SortedVectorMap(const COMPARE& less = COMPARE()) :
+    num_erased_(0), less_(less) {}
+
+  size_t size() const { return sorted_.size() - num_erased_ + pending_.size(); }
+  bool empty() const { return size() == 0; }
+
+  iterator end() { return 0; }
+  const_iterator end() const { return 0; }
+
+  /// Remove all entries and free the memory.
+  void clear()
+  {
+    std::vector<value_type>().swap(sorted_);
+    std::vector<char>().swap(erased_);
+    std::vector<value_type>().swap(pending_);
+    pending_index_.clear();
+    num_erased_ = 0;
+  }
+
+  /// Replace the contents with entries that are sorted by key and unique.
+  /// The entries are taken over; the vector is left empty.
+  void assign_sorted(std::vector<value_type>& entries)
+  {
+    clear();
+    sorted_.swap(entries);
+    erased_.assign(sorted_.size(), 0);
+  }
+
+  iterator find(const KEY& key)
+  {
+    return const_cast<iterator>(static_cast<const SortedVectorMap*>(this)->find(key));
+  }
+
+  const_iterator find(const KEY& key) const
+  {
+    typename std::vector<value_type>::const_iterator it =
+      std::lower_bound(sorted_.begin(), sorted_.end(), key, KeyLess(less_));
+    if (it != sorted_.end() && !less_(key, it->first))
+      return erased_[it - sorted_.begin()] ? end() : &(*it);
+
+    typename std::map<KEY, size_t, COMPARE>::const_iterator p = pending_index_.find(key);
+    if (p != pending_index_.end()) return &pending_[p->second];
+    return end();
+  }
+
+  /// Returns the value stored for key, inserting a default value if needed.
+  VALUE& operator[](const KEY& key)
+  {
+    iterator it = find(key);
+    if (it != end()) return it->second;
+
+    if (pending_.size() >= std::max<size_t>(MIN_PENDING, sorted_.size() / 8)) merge();
+
+    // Reuse the slot of an erased entry with the same key.
+    typename std::vector<value_type>::iterator s =
+      std::lower_bound(sorted_.begin(), sorted_.end(), key, KeyLess(less_));
+    if (s != sorted_.end() && !less_(key, s->first))
+    {
+      erased_[s - sorted_.begin()] = 0;
+      num_erased_--;
+      s->second = VALUE();
+      return s->second;
+    }
+
+    pending_index_[key] = pending_.size();
+    pending_.push_back(value_type(key, VALUE()));
+    return pending_.back().second;
+  }
+
+  void erase(iterator it)
+  {
+    if (it == end()) return;
+    if (!sorted_.empty() && it >= &sorted_[0] && it < &sorted_[0] + sorted_.size())
+    {
+      erased_[it - &sorted_[0]] = 1;
+      if (2 * ++num_erased_ > sorted_.size()) merge();
+      return;
+    }
+
+    // Move the last pending entry into the hole.
+    const size_t idx = it - &pending_[0];
+    pending_index_.erase(it->first);
+    if (idx + 1 != pending_.size())
+    {
+      pending_[idx] = pending_.back();
+      pending_index_[pending_[idx].first] = idx;
+    }
+    pending_.pop_back();
+  }
+
+  size_t erase(const KEY& key)
+  {
+    iterator it = find(key);
+    if (it == end()) return 0;
+    erase(it);
+    return 1;
+  }
+
+  /// Memory used by the table in bytes, not counting the side table.
+  size_t memory_size() const
+  {
+    return sizeof(*this) + sorted_.capacity() * sizeof(value_type) +
+      erased_.capacity() + pending_.capacity() * sizeof(value_type);
+  }
+
+private:
+  enum { MIN_PENDING = 1024 };
+
+  class KeyLess
+  {
+  public:
+    explicit KeyLess(const COMPARE& less) : less_(less) {}
+    bool operator()(const value_type& a, const KEY& b) const { return less_(a.first, b); }
+    bool operator()(const value_type& a, const value_type& b) const { return less_(a.first, b.first); }
+  private:
+    COMPARE less_;
+  };
+
+  void merge()
+  {
+    std::sort(pending_.begin(), pending_.end(), KeyLess(less_));
+    std::vector<value_type> merged;
+    merged.reserve(size());
+    size_t i = 0, j = 0;
+    while (i < sorted_.size() || j < pending_.size())
+    {
+      if (i < sorted_.size() && erased_[i]) { i++; continue; }
+      if (j == pending_.size() ||
+          (i < sorted_.size() && less_(sorted_[i].first, pending_[j].first)))
+        merged.push_back(sorted_[i++]);
+      else
+        merged.push_back(pending_[j++]);
+    }
+    sorted_.swap(merged);
+    erased_.assign(sorted_.size(), 0);
+    num_erased_ = 0;
+    std::vector<value_type>().swap(pending_);
+    pending_index_.clear();
+  }
+
+  std::vector<value_type>         sorted_;
+  std::vector<char>               erased_;
+  size_t                          num_erased_;
+  std::vector<value_type>         pending_;
+  std::map<KEY, size_t, COMPARE>  pending_index_;
+  COMPARE                         less_;
+};
+
+}
+
+#endif
@@ -0,0 +1,131 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+#include <gtest/gtest.h>
+#include <Core/Containers/Array3.h>
+
+using namespace SCIRun;
+
+TEST(Array3Test, ResizeKeepsOverlappingValues)
+{
+  Array3<double> a(2, 2, 2);
+  for (size_t i = 0; i < a.size(); ++i)
+    a[i] = static_cast<double>(i);
+  a.resize(3, 2, 1);
+  EXPECT_EQ(6, a.size());
+  EXPECT_EQ(0, a(0,0,0));
+  EXPECT_EQ(2, a(0,1,0));
+  EXPECT_EQ(4, a(1,0,0));
+  EXPECT_EQ(6, a(1,1,0));
+  EXPECT_EQ(0, a(2,1,0));
+}
+
+TEST(Array3Test, CanShareExternalStorage)
+{
+  boost::shared_ptr<std::vector<float> > buffer(new std::vector<float>(24, 1.0f));
+  Array3<float> a;
+  a.share(&(*buffer)[0], 2, 3, 4, buffer);
+  EXPECT_TRUE(a.is_shared());
+  EXPECT_EQ(24, a.size());
+  EXPECT_EQ(&(*buffer)[0], &a[0]);
+
+  (*buffer)[23] = 5.0f;
+  EXPECT_EQ(5.0f, a(1,2,3));
+
+  buffer.reset();
+  EXPECT_EQ(5.0f, a(1,2,3));
+}
+
+TEST(Array3Test, CopyOfSharedArrayIsDeep)
+{
+  std::vector<int> buffer(8, 3);
+  Array3<int> a;
+  a.share(&buffer[0], 2, 2, 2, boost::shared_ptr<void>());
+  Array3<int> b(a);
+  EXPECT_FALSE(b.is_shared());
+  EXPECT_NE(&a[0], &b[0]);
+  b[0] = 7;
+  EXPECT_EQ(3, buffer[0]);
+  EXPECT_EQ(3, a[0]);
+}
+
+TEST(Array3Test, ResizeToSameSizeDetachesFromSharedStorage)
+{
+  boost::shared_ptr<std::vector<int> > buffer(new std::vector<int>(8));
+  for (size_t i = 0; i < buffer->size(); ++i)
+    (*buffer)[i] = static_cast<int>(i);
+  Array3<int> a;
+  a.share(&(*buffer)[0], 2, 2, 2, buffer);
+
+  a.resize(2, 2, 2);
+  EXPECT_FALSE(a.is_shared());
+  EXPECT_NE(&(*buffer)[0], &a[0]);
+  EXPECT_EQ(7, a(1,1,1));
+
+  a[0] = -1;
+  EXPECT_EQ(0, (*buffer)[0]);
+  (*buffer)[1] = -2;
+  EXPECT_EQ(1, a[1]);
+}
+
+TEST(Array3Test, SharedStorageOutlivesArray)
+{
+  boost::shared_ptr<void> storage;
+  {
+    Array3<double> a(2, 2, 2);
+    for (size_t i = 0; i < a.size(); ++i)
+      a[i] = static_cast<double>(i);
+    EXPECT_FALSE(a.is_shared());
+
+    storage = a.shared_storage();
+    EXPECT_TRUE(a.is_shared());
+    EXPECT_EQ(static_cast<void*>(&a[0]), storage.get());
+
+    // Writes are not copied on write, both sides see them.
+    a[1] = 10.0;
+    EXPECT_EQ(10.0, static_cast<double*>(storage.get())[1]);
+
+    a.resize(2, 2, 2);
+    a[2] = 20.0;
+    EXPECT_EQ(2.0, static_cast<double*>(storage.get())[2]);
+  }
+  EXPECT_EQ(7.0, static_cast<double*>(storage.get())[7]);
+}
+
+TEST(Array3Test, AssignmentFromSharedArrayIsDeep)
+{
+  boost::shared_ptr<std::vector<float> > buffer(new std::vector<float>(8, 2.0f));
+  Array3<float> a;
+  a.share(&(*buffer)[0], 2, 2, 2, buffer);
+  Array3<float> b;
+  b = a;
+  b(1,1,1) = 4.0f;
+  EXPECT_EQ(2.0f, (*buffer)[7]);
+  (*buffer)[0] = 3.0f;
+  EXPECT_EQ(2.0f, b[0]);
+}
+
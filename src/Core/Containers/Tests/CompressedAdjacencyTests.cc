@@ -0,0 +1,109 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+#include <gtest/gtest.h>
+#include <Core/Containers/CompressedAdjacency.h>
+
+using namespace SCIRun;
+
+namespace
+{
+  std::vector<int> row(const CompressedAdjacency<int>& a, size_t r)
+  {
+    return std::vector<int>(a[r].begin(), a[r].end());
+  }
+}
+
+TEST(CompressedAdjacencyTest, BuildsInverseOfMapping)
+{
+  // Two triangles sharing the edge 1-2.
+  std::vector<int> cells = { 0, 1, 2, 2, 1, 3 };
+  CompressedAdjacency<int> a;
+  a.build_inverse(4, cells, [](size_t i) { return static_cast<int>(i / 3); });
+
+  ASSERT_EQ(4, a.size());
+  EXPECT_EQ(6, a.num_values());
+  EXPECT_EQ(std::vector<int>({ 0 }), row(a, 0));
+  EXPECT_EQ(std::vector<int>({ 0, 1 }), row(a, 1));
+  EXPECT_EQ(std::vector<int>({ 0, 1 }), row(a, 2));
+  EXPECT_EQ(std::vector<int>({ 1 }), row(a, 3));
+  EXPECT_EQ(1, a[1][1]);
+}
+
+TEST(CompressedAdjacencyTest, RowsCanBeEditedAfterBuild)
+{
+  std::vector<int> keys = { 0, 1, 1, 2 };
+  CompressedAdjacency<int> a;
+  a.build_inverse(3, keys, [](size_t i) { return static_cast<int>(i); });
+
+  for (int k = 10; k < 20; ++k)
+    a.push_back(1, k);
+  EXPECT_TRUE(a.erase(1, 2));
+  EXPECT_FALSE(a.erase(0, 5));
+  a.push_row();
+  a.push_back(3, 7);
+
+  ASSERT_EQ(4, a.size());
+  EXPECT_EQ(std::vector<int>({ 0 }), row(a, 0));
+  EXPECT_EQ(std::vector<int>({ 1, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19 }), row(a, 1));
+  EXPECT_EQ(std::vector<int>({ 3 }), row(a, 2));
+  EXPECT_EQ(std::vector<int>({ 7 }), row(a, 3));
+
+  a.compact();
+  EXPECT_EQ(14, a.num_values());
+  a.clear_row(2);
+  EXPECT_TRUE(a[2].empty());
+  EXPECT_EQ(std::vector<int>({ 1, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19 }), row(a, 1));
+  EXPECT_EQ(std::vector<int>({ 7 }), row(a, 3));
+}
+
+TEST(CompressedAdjacencyTest, ResizeGivesEmptyRows)
+{
+  CompressedAdjacency<int> a;
+  a.resize(5);
+  EXPECT_EQ(5, a.size());
+  EXPECT_TRUE(a[4].empty());
+  a.push_back(4, 1);
+  a.push_back(0, 2);
+  EXPECT_EQ(std::vector<int>({ 1 }), row(a, 4));
+  EXPECT_EQ(std::vector<int>({ 2 }), row(a, 0));
+  a.clear();
+  EXPECT_TRUE(a.empty());
+}
+
+TEST(CompressedAdjacencyTest, CanAssignAssembledRows)
+{
+  std::vector<size_t> offsets = { 0, 2, 2, 5 };
+  std::vector<int> values = { 4, 5, 6, 7, 8 };
+  CompressedAdjacency<int> a;
+  a.assign(offsets, values);
+  EXPECT_TRUE(offsets.empty());
+  ASSERT_EQ(3, a.size());
+  EXPECT_EQ(std::vector<int>({ 4, 5 }), row(a, 0));
+  EXPECT_TRUE(a[1].empty());
+  EXPECT_EQ(std::vector<int>({ 6, 7, 8 }), row(a, 2));
+}
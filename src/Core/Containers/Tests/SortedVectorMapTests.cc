@@ -0,0 +1,86 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+#include <gtest/gtest.h>
+#include <Core/Containers/SortedVectorMap.h>
+#include <map>
+#include <random>
+
+using namespace SCIRun;
+
+TEST(SortedVectorMapTest, FindsBulkAssignedEntries)
+{
+  std::vector<std::pair<int, int> > entries;
+  for (int i = 0; i < 100; ++i)
+    entries.push_back(std::make_pair(2 * i, i));
+
+  SortedVectorMap<int, int> table;
+  table.assign_sorted(entries);
+  EXPECT_TRUE(entries.empty());
+  EXPECT_EQ(100, table.size());
+  ASSERT_NE(table.end(), table.find(42));
+  EXPECT_EQ(21, table.find(42)->second);
+  EXPECT_EQ(table.end(), table.find(43));
+}
+
+TEST(SortedVectorMapTest, MatchesStdMapUnderRandomEdits)
+{
+  std::mt19937 gen(5);
+  std::uniform_int_distribution<int> key(0, 5000);
+  SortedVectorMap<int, int> table;
+  std::map<int, int> reference;
+
+  for (int step = 0; step < 50000; ++step)
+  {
+    int k = key(gen);
+    if (step % 3 == 0)
+    {
+      EXPECT_EQ(reference.erase(k), table.erase(k));
+    }
+    else
+    {
+      table[k] = step;
+      reference[k] = step;
+    }
+  }
+
+  EXPECT_EQ(reference.size(), table.size());
+  for (int k = 0; k <= 5000; ++k)
+  {
+    auto r = reference.find(k);
+    auto t = table.find(k);
+    if (r == reference.end())
+    {
+      EXPECT_EQ(table.end(), t);
+    }
+    else
+    {
+      ASSERT_NE(table.end(), t);
+      EXPECT_EQ(r->second, t->second);
+    }
+  }
+}
@@ -78,6 +78,9 @@ FieldTypeInformation::insert_field_type_information(Field* field)
   const TypeDescription* container_td = field->get_type_description(Field::FDATA_TD_E);
   temp = container_td->get_name(); 
   container_type = temp.substr(0,temp.find("<"));
+
+  MeshHandle mesh = field->mesh();
+  storage_mode = mesh ? mesh->storage_mode() : 0;
 }
 
 
@@ -659,6 +662,20 @@ FieldInformation::set_container_type(const std::string& type)
 }
 
 
+bool
+FieldInformation::make_compact_storage()
+{
+  storage_mode = Mesh::COMPACT_STORAGE_E;
+  return (true);
+}
+
+bool
+FieldInformation::is_compact_storage() const
+{
+  return (storage_mode == Mesh::COMPACT_STORAGE_E);
+}
+
+
 std::string
 FieldInformation::get_field_name() const
 {
@@ -1560,6 +1577,7 @@ SCIRun::CreateField(FieldInformation &info)
   MeshHandle meshhandle = CreateMesh(meshtype);
   
   if (!meshhandle) return FieldHandle();
+  if (info.get_storage_mode()) meshhandle->set_storage_mode(info.get_storage_mode());
 
   return (CreateField(type,meshhandle));              
 }
@@ -1576,7 +1594,9 @@ MeshHandle
 SCIRun::CreateMesh(FieldInformation &info)
 {
   std::string type = info.get_mesh_type_id();
-  return (CreateMesh(type));
+  MeshHandle mesh = CreateMesh(type);
+  if (mesh && info.get_storage_mode()) mesh->set_storage_mode(info.get_storage_mode());
+  return (mesh);
 }
 
 MeshHandle 
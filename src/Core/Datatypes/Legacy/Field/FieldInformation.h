@@ -45,6 +45,8 @@ class SCISHARE FieldTypeInformation
 
   public:
 
+    FieldTypeInformation() : storage_mode(0) {}
+
     bool        is_isomorphic() const;
     bool        is_nonlinear() const;
     bool        is_linear() const;
@@ -143,7 +145,9 @@ class SCISHARE FieldTypeInformation
     std::string basis_type;
     std::string data_type;
     std::string container_type;
-    
+
+    // Mesh storage flags (see Mesh::set_storage_mode), not part of the type
+    mask_type   storage_mode;
 };
 
 
@@ -199,6 +203,12 @@ class SCISHARE FieldInformation : public FieldTypeInformation {
     std::string get_container_type() const;
     void        set_container_type(const std::string&);
 
+    // Request float coordinates and 32 bit connectivity for new meshes
+    mask_type   get_storage_mode() const { return (storage_mode); }
+    void        set_storage_mode(mask_type mode) { storage_mode = mode; }
+    bool        make_compact_storage();
+    bool        is_compact_storage() const;
+
     std::string get_field_name() const;
     std::string get_field_type_id() const;
     std::string get_field_filename() const;
@@ -35,6 +35,8 @@
 #include <Core/Datatypes/Legacy/Field/MeshSupport.h>
 
 #include <Core/Containers/StackVector.h>
+#include <Core/Containers/CompressedAdjacency.h>
+#include <Core/Containers/SortedVectorMap.h>
 
 #include <Core/GeometryPrimitives/SearchGridT.h>
 #include <Core/GeometryPrimitives/BBox.h>
@@ -1521,6 +1523,15 @@ public:
   
   /// must detach, if altering points!
   std::vector<Core::Geometry::Point>& get_points() { return points_; }
+
+  /// Bytes held by the edge, face and node neighbor tables that synchronize
+  /// builds, reported by the benchmark suite.
+  size_t adjacency_memory_size() const
+  {
+    return faces_.capacity() * sizeof(PFaceCell) + face_table_.memory_size() +
+      edges_.memory_size() + edge_table_.memory_size() +
+      node_neighbors_.memory_size() + boundary_faces_.capacity();
+  }
  
   int compute_checksum();
    
@@ -1543,12 +1554,12 @@ protected:
     ASSERTMSG(synchronized_ & Mesh::EDGES_E,
       "HexVolMesh: Must call synchronize EDGES_E first");
     
-    if (edges_[idx].cells_.size() == 0)
+    if (edges_[idx].size() == 0)
       { array.clear(); return; }
 
     array.resize(2);
     
-    index_type cell_edge_index = edges_[idx].cells_[0];
+    index_type cell_edge_index = edges_[idx][0];
     index_type cell_index = (cell_edge_index>>4) << 3;
     index_type edge_index = (cell_edge_index)&0xF;
     
@@ -1784,7 +1795,7 @@ protected:
       "HexVolMesh: Must call synchronize EDGES_E first");
 
     // Get all the nodes that share an edge with this node
-    const std::vector<typename Cell::index_type>& neighbors = node_neighbors_[idx];
+    typename NodeNeighborMap::Row neighbors = node_neighbors_[idx];
     
     array.clear();
     array.reserve(neighbors.size());
@@ -1798,17 +1809,17 @@ protected:
        
       PEdgeNode e(cells_[cell_index+offset[0]],cells_[cell_index+offset[1]]);
       typename edge_nt::const_iterator iter = edge_table_.find(e);
-      if (((edges_[iter->second].cells_[0])&(~0xf))==(cell_index<<1) )
+      if (((edges_[iter->second][0])&(~0xf))==(cell_index<<1) )
         array.push_back(typename ARRAY::value_type(iter->second));
 
       PEdgeNode e1(cells_[cell_index+offset[2]],cells_[cell_index+offset[3]]);
       iter = edge_table_.find(e1);
-      if (((edges_[iter->second].cells_[0])&(~0xf))==(cell_index<<1) )
+      if (((edges_[iter->second][0])&(~0xf))==(cell_index<<1) )
         array.push_back(typename ARRAY::value_type(iter->second));
 
       PEdgeNode e2(cells_[cell_index+offset[4]],cells_[cell_index+offset[5]]);
       iter = edge_table_.find(e2);
-      if (((edges_[iter->second].cells_[0])&(~0xf))==(cell_index<<1) )
+      if (((edges_[iter->second][0])&(~0xf))==(cell_index<<1) )
         array.push_back(typename ARRAY::value_type(iter->second));
     }  
   }
@@ -1823,10 +1834,10 @@ protected:
 
     array.clear();
     
-    for (size_t c=0; c<edges_[idx].cells_.size();c++)
+    for (size_t c=0; c<edges_[idx].size();c++)
     {
-      index_type cell_index = ((edges_[idx].cells_[c])>>4)<<3;
-      index_type face_index = (edges_[idx].cells_[c])&0xF;
+      index_type cell_index = ((edges_[idx][c])>>4)<<3;
+      index_type face_index = (edges_[idx][c])&0xF;
 
       const int* off = HexVolFacePerEdgeTable[face_index];
 
@@ -1866,7 +1877,7 @@ protected:
       "HexVolMesh: Must call synchronize FACES_E first");
 
     array.clear();
-    const std::vector<typename Cell::index_type>& neighbors = node_neighbors_[idx];
+    typename NodeNeighborMap::Row neighbors = node_neighbors_[idx];
 
     // Iterate through all those edges
     for (size_t n = 0; n < neighbors.size(); n++)
@@ -1916,9 +1927,9 @@ protected:
     ASSERTMSG(synchronized_ & Mesh::EDGES_E,
                     "HexVolMesh: Must call synchronize EDGES_E first");
     
-    array.resize(edges_[idx].cells_.size());
-    for (size_t i=0; i<edges_[idx].cells_.size();i++)
-      array[i] = static_cast<typename ARRAY::value_type>((edges_[idx].cells_[i])>>4);
+    array.resize(edges_[idx].size());
+    for (size_t i=0; i<edges_[idx].size();i++)
+      array[i] = static_cast<typename ARRAY::value_type>((edges_[idx][i])>>4);
   }
 
   template<class ARRAY, class INDEX>
@@ -2565,14 +2576,6 @@ protected:
     }
   };
 
-  class PFace : public PFaceNode, public PFaceCell
-  {
-    public:
-      PFace(typename Node::index_type n1, typename Node::index_type n2,
-          typename Node::index_type n3, typename Node::index_type n4) :
-        PFaceNode(n1,n2,n3,n4) {}
-  };
-
   /// Edge information.
   class PEdgeNode {
     public:
@@ -2616,24 +2619,6 @@ protected:
       }
   };
 
-  class PEdgeCell {
-  public:
-    /// list of all the cells this edge is in.
-    //typedef StackBasedVector<index_type,4> cells_type ;
-    typedef std::vector<index_type> cells_type;
-    cells_type cells_;
-
-    bool shared() const { return cells_.size() > 1; }
-  };
-  
-  /// Edge information.
-  class PEdge : public PEdgeNode, public PEdgeCell 
-  {
-    public:
-      PEdge(typename Node::index_type n1,typename Node::index_type n2) :
-        PEdgeNode(n1,n2) {}
-  };
-
   /// hash the egde's node_indecies such that edges with the same nodes
   ///  hash to the same value. nodes are sorted on edge construction. 
   static const int sz_int = sizeof(int) * 8; // in bits
@@ -2732,32 +2717,14 @@ protected:
     }
   };
 
-/// Define the hash_map type, as this is not yet an approved type under Windows
-/// it is located in stdext
-
-#ifdef HAVE_HASH_MAP
-  #if defined(_WIN32)
-    /// hash_map is in stdext namespace
-    typedef stdext::hash_map<PFace, typename Face::index_type, FaceHash> face_ht;
-    typedef stdext::hash_map<PFaceNode, typename Face::index_type, FaceHash> face_nt;
-    typedef stdext::hash_map<PEdge, typename Edge::index_type, EdgeHash> edge_ht;
-    typedef stdext::hash_map<PEdgeNode, typename Edge::index_type, EdgeHash> edge_nt;
-  #else
-    /// hash_map is in std namespace
-    typedef hash_map<PFace, typename Face::index_type, FaceHash> face_ht;
-    typedef hash_map<PFaceNode, typename Face::index_type, FaceHash> face_nt;
-    typedef hash_map<PEdge, typename Edge::index_type, EdgeHash> edge_ht;
-    typedef hash_map<PEdgeNode, typename Edge::index_type, EdgeHash> edge_nt;
-  #endif
-#else
-  typedef std::map<PFace, typename Face::index_type, FaceHash> face_ht;
-  typedef std::map<PFaceNode, typename Face::index_type, FaceHash> face_nt;
-  typedef std::map<PEdge, typename Edge::index_type, EdgeHash> edge_ht;
-  typedef std::map<PEdgeNode, typename Edge::index_type, EdgeHash> edge_nt;
-#endif
+/// Edge and face lookup tables, stored as arrays sorted by node indices.
+  typedef SortedVectorMap<PFaceNode, typename Face::index_type, FaceHash> face_nt;
+  typedef SortedVectorMap<PEdgeNode, typename Edge::index_type, EdgeHash> edge_nt;
 
   typedef std::vector<PFaceCell> face_ct;
-  typedef std::vector<PEdgeCell> edge_ct;
+  /// For every edge the combined (cell,edge) indices of the cells using it.
+  typedef CompressedAdjacency<index_type> EdgeCellMap;
+  typedef CompressedAdjacency<typename Cell::index_type> NodeNeighborMap;
 
   /// container for face storage. Must be computed each time
   ///  nodes or cells change. 
@@ -2766,18 +2733,9 @@ protected:
   face_nt face_table_;
   /// container for edge storage. Must be computed each time
   ///  nodes or cells change. 
-  edge_ct edges_;
+  EdgeCellMap edges_;
   edge_nt edge_table_;
 
-  inline
-  void hash_edge(typename Node::index_type n1, typename Node::index_type n2,
-                 index_type combind_index, edge_ht &table) const;
-
-  inline
-  void hash_face(typename Node::index_type n1, typename Node::index_type n2,
-                 typename Node::index_type n3, typename Node::index_type n4,
-                 index_type combined_index, face_ht &table) const;
-
   template <class INDEX>
   bool order_face_nodes(INDEX& n1, INDEX& n2, INDEX& n3, INDEX& n4) const
   {
@@ -2847,7 +2805,7 @@ protected:
     typename Node::array_type   nodes_;
   };
 
-  std::vector<std::vector<typename Cell::index_type> > node_neighbors_;
+  NodeNeighborMap node_neighbors_;
   std::vector<unsigned char> boundary_faces_;
 
   /// This grid is used as an acceleration structure to expedite calls
@@ -2893,7 +2851,7 @@ HexVolMesh<Basis>::HexVolMesh() :
   cells_(0),
   faces_(0),
   face_table_(),
-  edges_(0),
+  edges_(),
   edge_table_(),
   synchronize_lock_("HexVolMesh Lock"),
   synchronize_cond_("HexVolMesh condition variable"),
@@ -2915,7 +2873,7 @@ HexVolMesh<Basis>::HexVolMesh(const HexVolMesh &copy) :
   cells_(0),
   faces_(0),
   face_table_(),
-  edges_(0),
+  edges_(),
   edge_table_(),
   synchronize_lock_("HexVolMesh Lock"),
   synchronize_cond_("HexVolMesh condition variable"),
@@ -3205,179 +3163,148 @@ HexVolMesh<Basis>::transform(const Core::Geometry::Transform &t)
   synchronize_lock_.unlock();
 }
 
-template <class Basis>
-void
-HexVolMesh<Basis>::hash_face(typename Node::index_type n1,
-                             typename Node::index_type n2,
-                             typename Node::index_type n3,
-                             typename Node::index_type n4,
-                             index_type combined_index,
-                             face_ht &table) const
-{
-  // Reorder nodes while maintaining CCW or CW orientation
-  // Check for degenerate faces, if faces has degeneracy it
-  // will be ignored (e.g. nodes on opposite corners are equal,
-  // or more then two nodes are equal)
-   
-  if (!(order_face_nodes(n1,n2,n3,n4))) return;
-  PFace f(n1, n2, n3, n4);
-
-     
-  typename face_ht::iterator iter = table.find(f);
-
-  if (iter == table.end()) 
-  {
-    f.cells_[0] = combined_index;
-    table[f] = 0; // insert for the first time
-  } 
-  else 
-  {
-    PFace f = (*iter).first;
-    if (f.cells_[1] != MESH_NO_NEIGHBOR) 
-    {
-      std::cerr << "HexVolMesh - This Mesh has problems: Cells #"
-           << (f.cells_[0]>>3) << ", #" << (f.cells_[1]>>3) << ", and #" << (combined_index>>3)
-           << " are illegally adjacent." << std::endl;
-    } 
-    else if ((f.cells_[0]>>3) == (combined_index>>3)) 
-    {
-      std::cerr << "HexVolMesh - This Mesh has problems: Cells #"
-           << (f.cells_[0]>>3) << ", #" << (f.cells_[1]>>3) << ", and #" << (combined_index>>3)
-           << " are the same." << std::endl;
-    } 
-    else 
-    {
-      f.cells_[1] = combined_index; // add this cell
-      table.erase(iter);
-      table[f] = 0;
-    }
-  }
-}
-
 template <class Basis>
 void
 HexVolMesh<Basis>::compute_faces()
 {
-  face_table_.clear();
+  // Collect the faces of all cells and sort them by their nodes, which
+  // places the cells sharing a face next to each other.
+  typedef std::pair<PFaceNode, index_type> cell_face_type;
+  std::vector<cell_face_type> cell_faces;
+  cell_faces.reserve((cells_.size() >> 3) * 6);
 
   typename Cell::iterator ci, cie;
   begin(ci); end(cie);
   typename Node::array_type arr(8);
   
-  face_ht table;
-  
+  // 6 faces -- each is entered CCW from outside looking in
+  static const int face_nodes[6][4] = { {0,1,2,3}, {7,6,5,4}, {0,4,5,1},
+                                        {2,6,7,3}, {3,7,4,0}, {1,5,6,2} };
   while (ci != cie)
   {
     get_nodes(arr, *ci);
-    // 6 faces -- each is entered CCW from outside looking in
     index_type cell_index = (*ci)<<3;
-    hash_face(arr[0], arr[1], arr[2], arr[3], cell_index, table);
-    hash_face(arr[7], arr[6], arr[5], arr[4], cell_index + 1, table);
-    hash_face(arr[0], arr[4], arr[5], arr[1], cell_index + 2, table);
-    hash_face(arr[2], arr[6], arr[7], arr[3], cell_index + 3, table);
-    hash_face(arr[3], arr[7], arr[4], arr[0], cell_index + 4, table);
-    hash_face(arr[1], arr[5], arr[6], arr[2], cell_index + 5, table);
-
+    for (int k = 0; k < 6; ++k)
+    {
+      // Reorder nodes while maintaining CCW or CW orientation. Degenerate
+      // faces (nodes on opposite corners are equal, or more then two nodes
+      // are equal) are ignored.
+      typename Node::index_type n1 = arr[face_nodes[k][0]];
+      typename Node::index_type n2 = arr[face_nodes[k][1]];
+      typename Node::index_type n3 = arr[face_nodes[k][2]];
+      typename Node::index_type n4 = arr[face_nodes[k][3]];
+      if (order_face_nodes(n1,n2,n3,n4))
+        cell_faces.push_back(cell_face_type(PFaceNode(n1,n2,n3,n4), cell_index + k));
+    }
     ++ci;
   }
 
-  faces_.resize(table.size());
+  std::sort(cell_faces.begin(), cell_faces.end(),
+    [](const cell_face_type& a, const cell_face_type& b)
+    { return (a.first < b.first) || (!(b.first < a.first) && a.second < b.second); });
+
+  std::vector<typename face_nt::value_type> table;
+  faces_.clear();
   boundary_faces_.resize(cells_.size()>>3);
-  
-  typename face_ht::iterator ht_iter = table.begin();
-  typename face_ht::iterator ht_iter_end = table.end();
-  
-  index_type uidx = 0;
-  while (ht_iter != ht_iter_end) 
+
+  size_t i = 0;
+  while (i < cell_faces.size())
   {
-    const PFace& pface = (*ht_iter).first;
-    faces_[uidx].cells_[0] = pface.cells_[0];
-    faces_[uidx].cells_[1] = pface.cells_[1];
-    face_table_[PFaceNode(pface.nodes_[0],pface.nodes_[1],pface.nodes_[2],pface.nodes_[3])] = uidx;
+    const PFaceNode& pface = cell_faces[i].first;
+    PFaceCell face;
+    face.cells_[0] = cell_faces[i].second;
+
+    for (++i; i < cell_faces.size() && !(pface < cell_faces[i].first); ++i)
+    {
+      index_type combined_index = cell_faces[i].second;
+      if (face.cells_[1] != MESH_NO_NEIGHBOR) 
+      {
+        std::cerr << "HexVolMesh - This Mesh has problems: Cells #"
+             << (face.cells_[0]>>3) << ", #" << (face.cells_[1]>>3) << ", and #" << (combined_index>>3)
+             << " are illegally adjacent." << std::endl;
+      } 
+      else if ((face.cells_[0]>>3) == (combined_index>>3)) 
+      {
+        std::cerr << "HexVolMesh - This Mesh has problems: Cells #"
+             << (face.cells_[0]>>3) << ", #" << (face.cells_[1]>>3) << ", and #" << (combined_index>>3)
+             << " are the same." << std::endl;
+      } 
+      else 
+      {
+        face.cells_[1] = combined_index; // add this cell
+      }
+    }
 
-    if (pface.cells_[1] == -1)
+    if (face.cells_[1] == -1)
     {
-      index_type cell = (pface.cells_[0]) >> 3;
-      index_type face = (pface.cells_[0]) & 0x7;
-      boundary_faces_[cell] |= 1 << face;
+      index_type cell = (face.cells_[0]) >> 3;
+      index_type f = (face.cells_[0]) & 0x7;
+      boundary_faces_[cell] |= 1 << f;
     }
-    
-    ++ht_iter; uidx++;
+
+    table.push_back(typename face_nt::value_type(pface,
+      static_cast<typename Face::index_type>(faces_.size())));
+    faces_.push_back(face);
   }
+  face_table_.assign_sorted(table);
 
   synchronize_lock_.lock();
   synchronized_ |= Mesh::FACES_E;
   synchronize_lock_.unlock();
 }
 
-template <class Basis>
-void
-HexVolMesh<Basis>::hash_edge(typename Node::index_type n1,
-                             typename Node::index_type n2,
-                             index_type combined_index,
-                             edge_ht &table) const
-{
-  if (n1 == n2) return;
-  PEdge e(n1, n2);
-  typename edge_ht::iterator iter = table.find(e);
-  if (iter == table.end()) 
-  {
-    e.cells_.push_back(combined_index); // add this cell
-    table[e] = 0; // insert for the first time
-  }
-  else
-  {
-    PEdge e = (*iter).first;
-    e.cells_.push_back(combined_index); // add this cell
-    table.erase(iter);
-    table[e] = 0;
-  }
-}
-
 template <class Basis>
 void
 HexVolMesh<Basis>::compute_edges()
 {
+  // Collect the edges of all cells and sort them by their nodes, which
+  // places the cells sharing an edge next to each other.
+  typedef std::pair<PEdgeNode, index_type> cell_edge_type;
+  std::vector<cell_edge_type> cell_edges;
+  cell_edges.reserve((cells_.size() >> 3) * 12);
+
   typename Cell::iterator ci, cie;
   begin(ci); end(cie);
-  edge_ht table;
+
+  static const int edge_nodes[12][2] = { {0,1}, {1,2}, {2,3}, {3,0},
+                                         {4,5}, {5,6}, {6,7}, {7,4},
+                                         {0,4}, {5,1}, {2,6}, {7,3} };
   typename Node::array_type arr;
   while (ci != cie)
   {
     get_nodes(arr, *ci);
     index_type cell_index = (*ci)<<4;
-    hash_edge(arr[0], arr[1], cell_index  , table);
-    hash_edge(arr[1], arr[2], cell_index+1, table);
-    hash_edge(arr[2], arr[3], cell_index+2, table);
-    hash_edge(arr[3], arr[0], cell_index+3, table);
-
-    hash_edge(arr[4], arr[5], cell_index+4, table);
-    hash_edge(arr[5], arr[6], cell_index+5, table);
-    hash_edge(arr[6], arr[7], cell_index+6, table);
-    hash_edge(arr[7], arr[4], cell_index+7, table);
-
-    hash_edge(arr[0], arr[4], cell_index+8, table);
-    hash_edge(arr[5], arr[1], cell_index+9, table);
-    hash_edge(arr[2], arr[6], cell_index+10,table);
-    hash_edge(arr[7], arr[3], cell_index+11,table);
+    for (int k = 0; k < 12; ++k)
+    {
+      typename Node::index_type n1 = arr[edge_nodes[k][0]];
+      typename Node::index_type n2 = arr[edge_nodes[k][1]];
+      if (n1 != n2) cell_edges.push_back(cell_edge_type(PEdgeNode(n1, n2), cell_index + k));
+    }
     ++ci;
   }
 
+  std::sort(cell_edges.begin(), cell_edges.end(),
+    [](const cell_edge_type& a, const cell_edge_type& b)
+    { return (a.first < b.first) || (a.first == b.first && a.second < b.second); });
+
   // dump edges into the edges_ container.
-  
-  edges_.resize(table.size());
-  
-  typename edge_ht::iterator ht_iter = table.begin();
-  typename edge_ht::iterator ht_iter_end = table.end();
-  
-  index_type uidx = 0;
-  while (ht_iter != ht_iter_end) 
+  std::vector<typename edge_nt::value_type> table;
+  std::vector<size_t> offsets(1, 0);
+  std::vector<index_type> edge_cells;
+  edge_cells.reserve(cell_edges.size());
+
+  size_t i = 0;
+  while (i < cell_edges.size())
   {
-    const PEdge& pedge = (*ht_iter).first;
-    edges_[uidx].cells_ = pedge.cells_;
-    edge_table_[PEdgeNode(pedge.nodes_[0],pedge.nodes_[1])] = uidx;
-    ++ht_iter; uidx++;
+    const PEdgeNode& pedge = cell_edges[i].first;
+    table.push_back(typename edge_nt::value_type(pedge,
+      static_cast<typename Edge::index_type>(table.size())));
+    for (; i < cell_edges.size() && cell_edges[i].first == pedge; ++i)
+      edge_cells.push_back(cell_edges[i].second);
+    offsets.push_back(edge_cells.size());
   }
+  edges_.assign(offsets, edge_cells);
+  edge_table_.assign_sorted(table);
 
   synchronize_lock_.lock();
   synchronized_ |= Mesh::EDGES_E;
@@ -3667,13 +3594,8 @@ template <class Basis>
 void
 HexVolMesh<Basis>::compute_node_neighbors()
 {
-  node_neighbors_.clear();
-  node_neighbors_.resize(points_.size());
-  index_type i, num_cells = cells_.size();
-  for (i = 0; i < num_cells; i++)
-  {
-    node_neighbors_[cells_[i]].push_back(i);
-  }
+  node_neighbors_.build_inverse(points_.size(), cells_,
+    [](size_t i) { return static_cast<typename Cell::index_type>(i); });
   
   synchronize_lock_.lock();
   synchronized_ |= Mesh::NODE_NEIGHBORS_E;
@@ -93,6 +93,20 @@ public:
   virtual bool synchronize(mask_type) { return false; }
   virtual bool unsynchronize(mask_type) { return false; }
 
+  /// Storage precision of node coordinates and element connectivity.
+  /// Compact storage uses floats and 32 bit indices; meshes that do not
+  /// support it only accept DEFAULT_STORAGE_E.
+  enum
+  {
+    DEFAULT_STORAGE_E = 0,
+    FLOAT_POINTS_E    = 1 << 0,
+    INT32_INDICES_E   = 1 << 1,
+    COMPACT_STORAGE_E = FLOAT_POINTS_E | INT32_INDICES_E
+  };
+
+  virtual bool set_storage_mode(mask_type mode) { return (mode == DEFAULT_STORAGE_E); }
+  virtual mask_type storage_mode() const { return (DEFAULT_STORAGE_E); }
+
   virtual int basis_order();
   
   /// Persistent I/O.
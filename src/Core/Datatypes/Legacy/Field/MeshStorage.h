@@ -0,0 +1,307 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef CORE_DATATYPES_MESHSTORAGE_H
+#define CORE_DATATYPES_MESHSTORAGE_H 1
+
+#include <Core/Datatypes/Legacy/Base/Types.h>
+#include <Core/GeometryPrimitives/Point.h>
+#include <Core/Persistent/PersistentSTL.h>
+#include <Core/Utils/Legacy/CheckSum.h>
+#include <Core/Utils/Exception.h>
+
+#include <limits>
+#include <vector>
+
+namespace SCIRun {
+
+/// Node coordinates of an unstructured mesh. By default points are kept
+/// as doubles; in float mode they are packed as three floats per node,
+/// which halves the memory used by large meshes. Elements are returned
+/// by value, writes go through set().
+
+class PointStorage
+{
+  public:
+    typedef Core::Geometry::Point value_type;
+
+    PointStorage() : float_(false) {}
+
+    bool is_float() const { return float_; }
+
+    /// Switch the representation, converting the current points.
+    void set_float(bool use_float)
+    {
+      if (use_float == float_) return;
+      if (use_float)
+      {
+        fpoints_.resize(3*points_.size());
+        for (size_t i = 0; i < points_.size(); i++)
+        {
+          fpoints_[3*i]   = static_cast<float>(points_[i].x());
+          fpoints_[3*i+1] = static_cast<float>(points_[i].y());
+          fpoints_[3*i+2] = static_cast<float>(points_[i].z());
+        }
+        std::vector<value_type>().swap(points_);
+      }
+      else
+      {
+        points_.resize(fpoints_.size()/3);
+        for (size_t i = 0; i < points_.size(); i++) points_[i] = (*this)[i];
+        std::vector<float>().swap(fpoints_);
+      }
+      float_ = use_float;
+    }
+
+    size_t size() const { return float_ ? fpoints_.size()/3 : points_.size(); }
+    bool empty() const { return size() == 0; }
+
+    void clear() { points_.clear(); fpoints_.clear(); }
+    void reserve(size_t n) { if (float_) fpoints_.reserve(3*n); else points_.reserve(n); }
+    void resize(size_t n) { if (float_) fpoints_.resize(3*n, 0.0f); else points_.resize(n); }
+
+    const value_type operator[](size_t i) const
+    {
+      if (!float_) return points_[i];
+      const float* p = &fpoints_[3*i];
+      return value_type(p[0], p[1], p[2]);
+    }
+
+    void set(size_t i, const value_type& p)
+    {
+      if (!float_) { points_[i] = p; return; }
+      fpoints_[3*i]   = static_cast<float>(p.x());
+      fpoints_[3*i+1] = static_cast<float>(p.y());
+      fpoints_[3*i+2] = static_cast<float>(p.z());
+    }
+
+    void push_back(const value_type& p)
+    {
+      if (!float_) { points_.push_back(p); return; }
+      fpoints_.push_back(static_cast<float>(p.x()));
+      fpoints_.push_back(static_cast<float>(p.y()));
+      fpoints_.push_back(static_cast<float>(p.z()));
+    }
+
+    void erase(size_t i)
+    {
+      if (!float_) points_.erase(points_.begin() + i);
+      else fpoints_.erase(fpoints_.begin() + 3*i, fpoints_.begin() + 3*i + 3);
+    }
+
+    void assign(const std::vector<value_type>& points)
+    {
+      if (!float_) { points_ = points; return; }
+      fpoints_.clear();
+      fpoints_.reserve(3*points.size());
+      for (size_t i = 0; i < points.size(); i++) push_back(points[i]);
+    }
+
+    void copy_to(std::vector<value_type>& points) const
+    {
+      points.resize(size());
+      for (size_t i = 0; i < points.size(); i++) points[i] = (*this)[i];
+    }
+
+    /// Direct access to the double coordinates, returns 0 in float mode.
+    value_type* data() { return (float_ || points_.empty()) ? 0 : &points_[0]; }
+
+    size_t memory_size() const
+    {
+      return points_.capacity()*sizeof(value_type) + fpoints_.capacity()*sizeof(float);
+    }
+
+    int checksum() const
+    {
+      if (float_) return fpoints_.empty() ? 0 :
+        compute_checksum(const_cast<float*>(&fpoints_[0]), fpoints_.size());
+      return points_.empty() ? 0 :
+        compute_checksum(const_cast<value_type*>(&points_[0]), points_.size());
+    }
+
+    friend inline void Pio(Piostream& stream, PointStorage& data);
+
+  private:
+    std::vector<value_type> points_;
+    std::vector<float>      fpoints_;
+    bool                    float_;
+};
+
+
+/// Element connectivity of an unstructured mesh. By default indices are
+/// 64 bit; in 32 bit mode they take half the space, which limits the mesh
+/// to 2^31 nodes; storing a larger index throws OutOfRangeException.
+
+class IndexStorage
+{
+  public:
+    typedef SCIRun::index_type value_type;
+
+    IndexStorage() : int32_(false) {}
+
+    bool is_int32() const { return int32_; }
+
+    /// Switch the representation, converting the current indices. Fails
+    /// when an index does not fit in 32 bits.
+    bool set_int32(bool use_int32)
+    {
+      if (use_int32 == int32_) return true;
+      if (use_int32)
+      {
+        for (size_t i = 0; i < indices_.size(); i++)
+          if (!fits(indices_[i])) return false;
+        iindices_.assign(indices_.begin(), indices_.end());
+        std::vector<value_type>().swap(indices_);
+      }
+      else
+      {
+        indices_.assign(iindices_.begin(), iindices_.end());
+        std::vector<int>().swap(iindices_);
+      }
+      int32_ = use_int32;
+      return true;
+    }
+
+    size_t size() const { return int32_ ? iindices_.size() : indices_.size(); }
+    bool empty() const { return size() == 0; }
+
+    void clear() { indices_.clear(); iindices_.clear(); }
+    void reserve(size_t n) { if (int32_) iindices_.reserve(n); else indices_.reserve(n); }
+    void resize(size_t n) { if (int32_) iindices_.resize(n, 0); else indices_.resize(n); }
+
+    value_type operator[](size_t i) const
+    {
+      return int32_ ? static_cast<value_type>(iindices_[i]) : indices_[i];
+    }
+
+    void set(size_t i, value_type v)
+    {
+      if (int32_) iindices_[i] = to_int32(v); else indices_[i] = v;
+    }
+
+    void push_back(value_type v)
+    {
+      if (int32_) iindices_.push_back(to_int32(v)); else indices_.push_back(v);
+    }
+
+    /// Remove the entries in [first,last).
+    void erase(size_t first, size_t last)
+    {
+      if (int32_) iindices_.erase(iindices_.begin() + first, iindices_.begin() + last);
+      else indices_.erase(indices_.begin() + first, indices_.begin() + last);
+    }
+
+    void assign(const std::vector<value_type>& indices)
+    {
+      if (!int32_) { indices_ = indices; return; }
+      iindices_.clear();
+      iindices_.reserve(indices.size());
+      for (size_t i = 0; i < indices.size(); i++) push_back(indices[i]);
+    }
+
+    void copy_to(std::vector<value_type>& indices) const
+    {
+      if (!int32_) indices = indices_;
+      else indices.assign(iindices_.begin(), iindices_.end());
+    }
+
+    /// Direct access to the 64 bit indices, returns 0 in 32 bit mode.
+    value_type* data() { return (int32_ || indices_.empty()) ? 0 : &indices_[0]; }
+
+    size_t memory_size() const
+    {
+      return indices_.capacity()*sizeof(value_type) + iindices_.capacity()*sizeof(int);
+    }
+
+    int checksum() const
+    {
+      if (int32_) return iindices_.empty() ? 0 :
+        compute_checksum(const_cast<int*>(&iindices_[0]), iindices_.size());
+      return indices_.empty() ? 0 :
+        compute_checksum(const_cast<value_type*>(&indices_[0]), indices_.size());
+    }
+
+    friend inline void Pio_index(Piostream& stream, IndexStorage& data);
+
+  private:
+    static bool fits(value_type v)
+    {
+      return v >= std::numeric_limits<int>::min() && v <= std::numeric_limits<int>::max();
+    }
+
+    static int to_int32(value_type v)
+    {
+      if (!fits(v))
+        BOOST_THROW_EXCEPTION(Core::OutOfRangeException() <<
+          Core::ErrorMessage("Index does not fit in 32 bit mesh storage"));
+      return static_cast<int>(v);
+    }
+
+    std::vector<value_type> indices_;
+    std::vector<int>        iindices_;
+    bool                    int32_;
+};
+
+/// Files always hold double points and 64 bit indices, independent of the
+/// storage mode of the mesh.
+inline void Pio(Piostream& stream, PointStorage& data)
+{
+  if (!data.float_) { Pio(stream, data.points_); return; }
+  std::vector<Core::Geometry::Point> points;
+  if (!stream.reading()) data.copy_to(points);
+  Pio(stream, points);
+  if (stream.reading()) data.assign(points);
+}
+
+inline void Pio_index(Piostream& stream, IndexStorage& data)
+{
+  if (!data.int32_) { Pio_index(stream, data.indices_); return; }
+  std::vector<index_type> indices;
+  if (!stream.reading()) data.copy_to(indices);
+  Pio_index(stream, indices);
+  if (stream.reading()) data.assign(indices);
+}
+
+/// Raw coordinate/index access for code shared between meshes that use
+/// std::vector and meshes that use the storage classes above.
+inline Core::Geometry::Point* storage_pointer(std::vector<Core::Geometry::Point>& v)
+{ return v.empty() ? 0 : &v[0]; }
+
+inline Core::Geometry::Point* storage_pointer(PointStorage& s)
+{ return s.data(); }
+
+inline index_type* storage_pointer(std::vector<index_type>& v)
+{ return v.empty() ? 0 : &v[0]; }
+
+inline index_type* storage_pointer(IndexStorage& s)
+{ return s.data(); }
+
+} // end namespace SCIRun
+
+#endif
@@ -34,6 +34,7 @@
 #include <Core/Datatypes/Legacy/Field/MeshSupport.h>
 
 #include <Core/Containers/StackVector.h>
+#include <Core/Containers/CompressedAdjacency.h>
 
 #include <Core/GeometryPrimitives/SearchGridT.h>
 #include <Core/GeometryPrimitives/BBox.h>
@@ -1726,7 +1727,7 @@ protected:
     // Get the table of faces that are connected to the two nodes
     Core::Thread::Guard nn(synchronize_lock_.get());
  
-    const std::vector<typename Face::index_type>& faces  = node_neighbors_[idx];
+    typename NodeNeighborMap::Row faces  = node_neighbors_[idx];
     array.clear();
     
     typename ARRAY::value_type edge;
@@ -1830,7 +1831,7 @@ protected:
 
     // Get all the neighboring elements
     typename Node::array_type nodes;
-    const std::vector<typename Face::index_type>& faces  = node_neighbors_[idx]; 
+    typename NodeNeighborMap::Row faces  = node_neighbors_[idx]; 
     // Make a conservative estimate of the number of node neighbors
     array.reserve(2*faces.size());
      
@@ -2222,7 +2223,7 @@ protected:
   /// array with information from halfedge (computed directly from face) to the edge number
   std::vector<index_type>                    halfedge_to_edge_;  // halfedge->edge map
   
-  typedef std::vector<std::vector<typename Elem::index_type> > NodeNeighborMap;
+  typedef CompressedAdjacency<typename Elem::index_type> NodeNeighborMap;
   NodeNeighborMap                       node_neighbors_;  
   
   std::vector<Core::Geometry::Vector>                           normals_; /// normalized per node
@@ -3001,13 +3002,8 @@ template <class Basis>
 void
 QuadSurfMesh<Basis>::compute_node_neighbors()
 {
-  node_neighbors_.clear();
-  node_neighbors_.resize(points_.size());
-  index_type i, num_elems = static_cast<index_type>(faces_.size());
-  for (i = 0; i < num_elems; i++)
-  {
-    node_neighbors_[faces_[i]].push_back(i/4);
-  }
+  node_neighbors_.build_inverse(points_.size(), faces_,
+    [](size_t i) { return static_cast<typename Elem::index_type>(i/4); });
   
   synchronize_lock_.lock();
   synchronized_ |= Mesh::NODE_NEIGHBORS_E;
@@ -0,0 +1,128 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Testing/Utils/SCIRunFieldSamples.h>
+#include <Testing/Utils/FieldTestUtilities.h>
+
+#include <Core/Datatypes/Legacy/Field/Field.h>
+#include <Core/Datatypes/Legacy/Field/FieldInformation.h>
+#include <Core/Persistent/Persistent.h>
+#include <Core/Persistent/ChunkedGZip.h>
+
+#include <gtest/gtest.h>
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+#include <iterator>
+
+using namespace SCIRun;
+using namespace SCIRun::TestUtils;
+
+namespace
+{
+  class ScratchFile
+  {
+  public:
+    explicit ScratchFile(const std::string& model) :
+      path_(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path(model)) {}
+    ~ScratchFile() { boost::system::error_code ec; boost::filesystem::remove(path_, ec); }
+    std::string name() const { return path_.string(); }
+  private:
+    boost::filesystem::path path_;
+  };
+
+  void writeField(FieldHandle field, const std::string& file, const std::string& type)
+  {
+    PiostreamPtr stream = auto_ostream(file, type, nullptr);
+    ASSERT_TRUE(stream && !stream->error());
+    Pio(*stream, field);
+    ASSERT_FALSE(stream->error());
+  }
+
+  FieldHandle readField(const std::string& file)
+  {
+    PiostreamPtr stream = auto_istream(file, nullptr);
+    if (!stream || stream->error())
+      return FieldHandle();
+    FieldHandle field;
+    Pio(*stream, field);
+    return stream->error() ? FieldHandle() : field;
+  }
+}
+
+// About 14 MB of Pio data, so the stream spans several compressed blocks.
+TEST(CompressedPiostreamTests, FieldRoundTripsThroughCompressedStream)
+{
+  FieldHandle field = TetVolGrid(40, LINEARDATA_E);
+  ScratchFile file("scirun_compressed_%%%%-%%%%.fld.gz");
+  writeField(field, file.name(), "Compressed");
+
+  {
+    ChunkedGZipReader reader(file.name());
+    ASSERT_TRUE(reader.isOpen());
+    EXPECT_TRUE(reader.isChunked());
+  }
+
+  FieldHandle loaded = readField(file.name());
+  ASSERT_TRUE(loaded != nullptr);
+  EXPECT_TRUE(same_field(field, loaded));
+}
+
+TEST(CompressedPiostreamTests, ReadsLegacySingleMemberGzipFile)
+{
+  FieldHandle field = TetVolGrid(8, CONSTANTDATA_E);
+  ScratchFile binary("scirun_binary_%%%%-%%%%.fld");
+  writeField(field, binary.name(), "Binary");
+
+  std::string contents;
+  {
+    std::ifstream in(binary.name().c_str(), std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+  ASSERT_FALSE(contents.empty());
+
+  // What gzip(1) or the old GZPiostream wrote: one member without the block index.
+  ScratchFile file("scirun_legacy_%%%%-%%%%.fld.gz");
+  {
+    gzFile gz = gzopen(file.name().c_str(), "wb");
+    ASSERT_TRUE(gz != 0);
+    ASSERT_EQ(static_cast<int>(contents.size()), gzwrite(gz, contents.data(), static_cast<unsigned int>(contents.size())));
+    ASSERT_EQ(Z_OK, gzclose(gz));
+  }
+
+  {
+    ChunkedGZipReader reader(file.name());
+    ASSERT_TRUE(reader.isOpen());
+    EXPECT_FALSE(reader.isChunked());
+  }
+
+  FieldHandle loaded = readField(file.name());
+  ASSERT_TRUE(loaded != nullptr);
+  EXPECT_TRUE(same_field(field, loaded));
+}
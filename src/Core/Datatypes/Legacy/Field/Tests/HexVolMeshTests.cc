@@ -0,0 +1,131 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Core/Datatypes/Legacy/Field/HexVolMesh.h>
+#include <Core/Basis/HexTrilinearLgn.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <map>
+#include <set>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Geometry;
+
+namespace
+{
+  typedef HexVolMesh<Core::Basis::HexTrilinearLgn<Point> > HVMesh;
+  typedef std::vector<index_type> NodeKey;
+
+  const int HexEdges[12][2] = { {0,1}, {1,2}, {2,3}, {3,0}, {4,5}, {5,6},
+                                {6,7}, {7,4}, {0,4}, {1,5}, {2,6}, {3,7} };
+  const int HexFaces[6][4] = { {0,1,2,3}, {4,5,6,7}, {0,1,5,4},
+                               {1,2,6,5}, {2,3,7,6}, {3,0,4,7} };
+
+  NodeKey sorted(NodeKey k)
+  {
+    std::sort(k.begin(), k.end());
+    return k;
+  }
+
+  void makeHexGrid(HVMesh& mesh, int n)
+  {
+    for (int k = 0; k <= n; ++k)
+      for (int j = 0; j <= n; ++j)
+        for (int i = 0; i <= n; ++i)
+          mesh.add_point(Point(i, j, k));
+
+    auto node = [n](int i, int j, int k) { return i + (n+1)*(j + (n+1)*k); };
+    for (int k = 0; k < n; ++k)
+      for (int j = 0; j < n; ++j)
+        for (int i = 0; i < n; ++i)
+          mesh.add_hex(node(i,j,k), node(i+1,j,k), node(i+1,j+1,k), node(i,j+1,k),
+            node(i,j,k+1), node(i+1,j,k+1), node(i+1,j+1,k+1), node(i,j+1,k+1));
+  }
+}
+
+TEST(HexVolMeshTest, EdgeAndFaceTablesMatchHexGridCounts)
+{
+  const int n = 3;
+  HVMesh mesh;
+  makeHexGrid(mesh, n);
+  mesh.synchronize(Mesh::EDGES_E | Mesh::FACES_E);
+
+  const size_type E = 3*n*(n+1)*(n+1);
+  const size_type F = 3*n*n*(n+1);
+
+  std::map<NodeKey, std::set<index_type> > refEdges, refFaces;
+  HVMesh::Node::array_type nodes;
+  for (index_type c = 0; c < n*n*n; ++c)
+  {
+    mesh.get_nodes(nodes, HVMesh::Cell::index_type(c));
+    for (int e = 0; e < 12; ++e)
+      refEdges[sorted({ nodes[HexEdges[e][0]], nodes[HexEdges[e][1]] })].insert(c);
+    for (int f = 0; f < 6; ++f)
+      refFaces[sorted({ nodes[HexFaces[f][0]], nodes[HexFaces[f][1]],
+        nodes[HexFaces[f][2]], nodes[HexFaces[f][3]] })].insert(c);
+  }
+  ASSERT_EQ(E, static_cast<size_type>(refEdges.size()));
+  ASSERT_EQ(F, static_cast<size_type>(refFaces.size()));
+
+  HVMesh::Edge::size_type nedges;
+  HVMesh::Face::size_type nfaces;
+  mesh.size(nedges);
+  mesh.size(nfaces);
+  EXPECT_EQ(E, static_cast<size_type>(nedges));
+  EXPECT_EQ(F, static_cast<size_type>(nfaces));
+
+  HVMesh::Cell::array_type cells;
+  std::set<NodeKey> seen;
+  for (index_type e = 0; e < static_cast<index_type>(nedges); ++e)
+  {
+    mesh.get_nodes(nodes, HVMesh::Edge::index_type(e));
+    ASSERT_EQ(2u, nodes.size());
+    NodeKey k = sorted({ nodes[0], nodes[1] });
+    EXPECT_TRUE(seen.insert(k).second);
+    ASSERT_EQ(1u, refEdges.count(k));
+
+    cells.assign(9, HVMesh::Cell::index_type(-1));
+    mesh.get_cells(cells, HVMesh::Edge::index_type(e));
+    EXPECT_EQ(refEdges[k], std::set<index_type>(cells.begin(), cells.end()));
+  }
+
+  seen.clear();
+  for (index_type f = 0; f < static_cast<index_type>(nfaces); ++f)
+  {
+    mesh.get_nodes(nodes, HVMesh::Face::index_type(f));
+    ASSERT_EQ(4u, nodes.size());
+    NodeKey k = sorted({ nodes[0], nodes[1], nodes[2], nodes[3] });
+    EXPECT_TRUE(seen.insert(k).second);
+    ASSERT_EQ(1u, refFaces.count(k));
+
+    mesh.get_cells(cells, HVMesh::Face::index_type(f));
+    EXPECT_EQ(refFaces[k], std::set<index_type>(cells.begin(), cells.end()));
+  }
+}
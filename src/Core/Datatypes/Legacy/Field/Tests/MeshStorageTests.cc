@@ -0,0 +1,307 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Testing/Utils/SCIRunFieldSamples.h>
+
+#include <Core/Datatypes/Legacy/Field/MeshStorage.h>
+#include <Core/Datatypes/Legacy/Field/Mesh.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/Legacy/Field/Field.h>
+#include <Core/Datatypes/Legacy/Field/FieldInformation.h>
+#include <Core/Persistent/Persistent.h>
+
+#include <gtest/gtest.h>
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+#include <iterator>
+#include <limits>
+
+using namespace SCIRun;
+using namespace SCIRun::Core;
+using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::TestUtils;
+
+namespace
+{
+  void expectSameMesh(VMesh* expected, VMesh* actual)
+  {
+    ASSERT_EQ(expected->num_nodes(), actual->num_nodes());
+    ASSERT_EQ(expected->num_elems(), actual->num_elems());
+
+    Point p, q;
+    for (VMesh::Node::index_type i = 0; i < expected->num_nodes(); ++i)
+    {
+      expected->get_center(p, i);
+      actual->get_center(q, i);
+      EXPECT_EQ(p, q);
+    }
+
+    VMesh::Node::array_type a, b;
+    for (VMesh::Elem::index_type e = 0; e < expected->num_elems(); ++e)
+    {
+      expected->get_nodes(a, e);
+      actual->get_nodes(b, e);
+      EXPECT_EQ(a, b);
+    }
+  }
+
+  boost::filesystem::path scratchFile()
+  {
+    return boost::filesystem::temp_directory_path() /
+      boost::filesystem::unique_path("scirun_meshstorage_%%%%-%%%%.mesh");
+  }
+
+  void writeMesh(MeshHandle mesh, const boost::filesystem::path& file)
+  {
+    PiostreamPtr stream = auto_ostream(file.string(), "Binary", nullptr);
+    ASSERT_TRUE(stream && !stream->error());
+    mesh->io(*stream);
+    ASSERT_FALSE(stream->error());
+  }
+
+  void readMesh(MeshHandle mesh, const boost::filesystem::path& file)
+  {
+    PiostreamPtr stream = auto_istream(file.string(), nullptr);
+    ASSERT_TRUE(stream && !stream->error());
+    mesh->io(*stream);
+    ASSERT_FALSE(stream->error());
+  }
+
+  std::string fileContents(const boost::filesystem::path& file)
+  {
+    std::ifstream in(file.string().c_str(), std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+
+  void storageModeRoundTrip(FieldHandle field)
+  {
+    FieldHandle reference(field->deep_clone());
+    MeshHandle mesh = field->mesh();
+    VMesh* vmesh = field->vmesh();
+    ASSERT_TRUE(vmesh->get_points_pointer() != 0);
+    ASSERT_TRUE(vmesh->get_elems_pointer() != 0);
+
+    ASSERT_TRUE(mesh->set_storage_mode(Mesh::COMPACT_STORAGE_E));
+    EXPECT_EQ(Mesh::COMPACT_STORAGE_E, mesh->storage_mode());
+    EXPECT_TRUE(vmesh->get_points_pointer() == 0);
+    EXPECT_TRUE(vmesh->get_elems_pointer() == 0);
+    expectSameMesh(reference->vmesh(), vmesh);
+
+    ASSERT_TRUE(mesh->set_storage_mode(Mesh::FLOAT_POINTS_E));
+    EXPECT_EQ(Mesh::FLOAT_POINTS_E, mesh->storage_mode());
+    EXPECT_TRUE(vmesh->get_points_pointer() == 0);
+    EXPECT_TRUE(vmesh->get_elems_pointer() != 0);
+    expectSameMesh(reference->vmesh(), vmesh);
+
+    ASSERT_TRUE(mesh->set_storage_mode(Mesh::DEFAULT_STORAGE_E));
+    EXPECT_EQ(Mesh::DEFAULT_STORAGE_E, mesh->storage_mode());
+    EXPECT_TRUE(vmesh->get_points_pointer() != 0);
+    EXPECT_TRUE(vmesh->get_elems_pointer() != 0);
+    expectSameMesh(reference->vmesh(), vmesh);
+  }
+}
+
+TEST(MeshStorageTests, PointStorageRoundsToFloatAndBack)
+{
+  PointStorage points;
+  points.push_back(Point(0.1, 0.2, 0.3));
+  points.push_back(Point(1.0, 2.0, 3.0));
+
+  points.set_float(true);
+  EXPECT_TRUE(points.is_float());
+  EXPECT_TRUE(points.data() == 0);
+  ASSERT_EQ(2u, points.size());
+  const Point rounded(static_cast<float>(0.1), static_cast<float>(0.2), static_cast<float>(0.3));
+  EXPECT_EQ(rounded, points[0]);
+  EXPECT_EQ(Point(1.0, 2.0, 3.0), points[1]);
+
+  points.set(1, Point(4.0, 5.0, 6.0));
+  points.set_float(false);
+  EXPECT_FALSE(points.is_float());
+  ASSERT_TRUE(points.data() != 0);
+  EXPECT_EQ(rounded, points.data()[0]);
+  EXPECT_EQ(Point(4.0, 5.0, 6.0), points.data()[1]);
+}
+
+TEST(MeshStorageTests, IndexStorageRoundTripsThroughInt32)
+{
+  IndexStorage indices;
+  const index_type largest = std::numeric_limits<int>::max();
+  indices.push_back(0);
+  indices.push_back(7);
+  indices.push_back(largest);
+
+  ASSERT_TRUE(indices.set_int32(true));
+  EXPECT_TRUE(indices.data() == 0);
+  EXPECT_EQ(largest, indices[2]);
+
+  indices.set(1, 9);
+  ASSERT_TRUE(indices.set_int32(false));
+  ASSERT_TRUE(indices.data() != 0);
+  EXPECT_EQ(0, indices.data()[0]);
+  EXPECT_EQ(9, indices.data()[1]);
+  EXPECT_EQ(largest, indices.data()[2]);
+}
+
+TEST(MeshStorageTests, IndexStorageRejectsIndicesAbove32Bits)
+{
+  const index_type tooLarge = static_cast<index_type>(std::numeric_limits<int>::max()) + 1;
+  IndexStorage indices;
+  indices.push_back(tooLarge);
+  EXPECT_FALSE(indices.set_int32(true));
+  EXPECT_FALSE(indices.is_int32());
+  EXPECT_EQ(tooLarge, indices[0]);
+
+  IndexStorage compact;
+  ASSERT_TRUE(compact.set_int32(true));
+  compact.push_back(1);
+  EXPECT_THROW(compact.push_back(tooLarge), OutOfRangeException);
+  EXPECT_THROW(compact.set(0, tooLarge), OutOfRangeException);
+  ASSERT_EQ(1u, compact.size());
+  EXPECT_EQ(1, compact[0]);
+}
+
+TEST(MeshStorageTests, TetVolStorageModeRoundTrip)
+{
+  storageModeRoundTrip(CubeTetVolLinearBasis(DOUBLE_E));
+}
+
+TEST(MeshStorageTests, TriSurfStorageModeRoundTrip)
+{
+  storageModeRoundTrip(CubeTriSurfLinearBasis(DOUBLE_E));
+}
+
+TEST(MeshStorageTests, CompactTetVolWritesTheDefaultFileLayout)
+{
+  FieldHandle field = CubeTetVolLinearBasis(DOUBLE_E);
+  FieldHandle compactField(field->deep_clone());
+  ASSERT_TRUE(compactField->mesh()->set_storage_mode(Mesh::COMPACT_STORAGE_E));
+
+  auto defaultFile = scratchFile();
+  auto compactFile = scratchFile();
+  writeMesh(field->mesh(), defaultFile);
+  writeMesh(compactField->mesh(), compactFile);
+  EXPECT_EQ(fileContents(defaultFile), fileContents(compactFile));
+
+  FieldInformation fi(field);
+  MeshHandle read = CreateMesh(fi);
+  readMesh(read, compactFile);
+  EXPECT_EQ(Mesh::DEFAULT_STORAGE_E, read->storage_mode());
+  expectSameMesh(field->vmesh(), read->vmesh());
+
+  MeshHandle readCompact = CreateMesh(fi);
+  ASSERT_TRUE(readCompact->set_storage_mode(Mesh::COMPACT_STORAGE_E));
+  readMesh(readCompact, defaultFile);
+  EXPECT_EQ(Mesh::COMPACT_STORAGE_E, readCompact->storage_mode());
+  expectSameMesh(field->vmesh(), readCompact->vmesh());
+
+  boost::filesystem::remove(defaultFile);
+  boost::filesystem::remove(compactFile);
+}
+
+TEST(MeshStorageTests, CreateMeshAppliesTheRequestedStorageMode)
+{
+  FieldInformation tetInfo(TETVOLMESH_E, LINEARDATA_E, DOUBLE_E);
+  EXPECT_FALSE(tetInfo.is_compact_storage());
+  tetInfo.make_compact_storage();
+  EXPECT_TRUE(tetInfo.is_compact_storage());
+
+  MeshHandle tetMesh = CreateMesh(tetInfo);
+  ASSERT_TRUE(tetMesh != nullptr);
+  EXPECT_EQ(Mesh::COMPACT_STORAGE_E, tetMesh->storage_mode());
+
+  FieldHandle tetField = CreateField(tetInfo);
+  ASSERT_TRUE(tetField != nullptr);
+  EXPECT_EQ(Mesh::COMPACT_STORAGE_E, tetField->mesh()->storage_mode());
+  EXPECT_TRUE(FieldInformation(tetField).is_compact_storage());
+
+  FieldInformation triInfo(TRISURFMESH_E, LINEARDATA_E, DOUBLE_E);
+  triInfo.set_storage_mode(Mesh::INT32_INDICES_E);
+  EXPECT_EQ(Mesh::INT32_INDICES_E, CreateMesh(triInfo)->storage_mode());
+
+  // Meshes without compact storage keep their default layout
+  FieldInformation hexInfo(HEXVOLMESH_E, LINEARDATA_E, DOUBLE_E);
+  hexInfo.make_compact_storage();
+  MeshHandle hexMesh = CreateMesh(hexInfo);
+  ASSERT_TRUE(hexMesh != nullptr);
+  EXPECT_EQ(Mesh::DEFAULT_STORAGE_E, hexMesh->storage_mode());
+  EXPECT_FALSE(hexMesh->set_storage_mode(Mesh::COMPACT_STORAGE_E));
+}
+
+TEST(MeshStorageTests, CopyNodesAndElemsWithoutRawPointers)
+{
+  FieldHandle source = CubeTetVolLinearBasis(DOUBLE_E);
+  FieldInformation fi(source);
+
+  // Compact destination, default source
+  FieldInformation compactInfo(fi);
+  compactInfo.make_compact_storage();
+  FieldHandle compact = CreateField(compactInfo);
+  compact->vmesh()->copy_nodes(source->vmesh());
+  compact->vmesh()->resize_elems(source->vmesh()->num_elems());
+  compact->vmesh()->copy_elems(source->vmesh());
+  ASSERT_TRUE(compact->vmesh()->get_points_pointer() == 0);
+  expectSameMesh(source->vmesh(), compact->vmesh());
+
+  // Default destination, compact source
+  FieldHandle copy = CreateField(fi);
+  copy->vmesh()->copy_nodes(compact->vmesh());
+  copy->vmesh()->resize_elems(compact->vmesh()->num_elems());
+  copy->vmesh()->copy_elems(compact->vmesh());
+  ASSERT_TRUE(copy->vmesh()->get_points_pointer() != 0);
+  expectSameMesh(source->vmesh(), copy->vmesh());
+
+  // Copy a range of elements, shifting their node indices
+  FieldHandle offset = CreateField(compactInfo);
+  offset->vmesh()->resize_nodes(2 * source->vmesh()->num_nodes());
+  offset->vmesh()->copy_nodes(source->vmesh(), VMesh::Node::index_type(0),
+    VMesh::Node::index_type(source->vmesh()->num_nodes()), source->vmesh()->num_nodes());
+  offset->vmesh()->resize_elems(2);
+  offset->vmesh()->copy_elems(source->vmesh(), VMesh::Elem::index_type(1),
+    VMesh::Elem::index_type(0), 2, source->vmesh()->num_nodes());
+
+  Point p, q;
+  for (VMesh::Node::index_type i = 0; i < source->vmesh()->num_nodes(); ++i)
+  {
+    source->vmesh()->get_center(p, i);
+    offset->vmesh()->get_center(q, VMesh::Node::index_type(i + source->vmesh()->num_nodes()));
+    EXPECT_EQ(p, q);
+  }
+
+  VMesh::Node::array_type a, b;
+  for (VMesh::Elem::index_type e = 0; e < 2; ++e)
+  {
+    source->vmesh()->get_nodes(a, VMesh::Elem::index_type(e + 1));
+    offset->vmesh()->get_nodes(b, e);
+    ASSERT_EQ(a.size(), b.size());
+    for (size_t k = 0; k < a.size(); ++k)
+      EXPECT_EQ(a[k] + source->vmesh()->num_nodes(), b[k]);
+  }
+}
@@ -32,9 +32,15 @@
 #include <Core/Datatypes/Legacy/Field/Field.h>
 #include <Core/Datatypes/Legacy/Field/VField.h>
 #include <Core/Datatypes/Legacy/Field/FieldInformation.h>
+#include <Core/Datatypes/Legacy/Field/TetVolMesh.h>
+#include <Core/Basis/TetLinearLgn.h>
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <map>
+#include <set>
+
 using namespace SCIRun;
 using namespace SCIRun::Core::Datatypes;
 using namespace SCIRun::Core::Geometry;
@@ -69,4 +75,185 @@ TEST(TetVolMeshTest, CheckMeshIteratorTetVolMesh)
   
 }
 
+namespace
+{
+  typedef TetVolMesh<Core::Basis::TetLinearLgn<Point> > TVMesh;
+  typedef std::vector<index_type> NodeKey;
+
+  const int TetEdges[6][2] = { {0,1}, {1,2}, {2,0}, {3,0}, {3,1}, {3,2} };
+  const int TetFaces[4][3] = { {0,2,1}, {1,2,3}, {0,1,3}, {0,3,2} };
+
+  NodeKey key(index_type a, index_type b)
+  {
+    NodeKey k = { a, b };
+    std::sort(k.begin(), k.end());
+    return k;
+  }
+
+  NodeKey key(index_type a, index_type b, index_type c)
+  {
+    NodeKey k = { a, b, c };
+    std::sort(k.begin(), k.end());
+    return k;
+  }
+
+  /// n^3 cubes, each split into the six Freudenthal tets around its main
+  /// diagonal, so neighboring cubes share their edges and faces.
+  void makeCubeGrid(TVMesh& mesh, int n)
+  {
+    for (int k = 0; k <= n; ++k)
+      for (int j = 0; j <= n; ++j)
+        for (int i = 0; i <= n; ++i)
+          mesh.add_point(Point(i, j, k));
+
+    const int perms[6][3] = { {0,1,2}, {0,2,1}, {1,0,2}, {1,2,0}, {2,0,1}, {2,1,0} };
+    for (int k = 0; k < n; ++k)
+      for (int j = 0; j < n; ++j)
+        for (int i = 0; i < n; ++i)
+          for (int p = 0; p < 6; ++p)
+          {
+            int c[3] = { i, j, k };
+            index_type nodes[4];
+            nodes[0] = c[0] + (n+1)*(c[1] + (n+1)*c[2]);
+            for (int s = 0; s < 3; ++s)
+            {
+              ++c[perms[p][s]];
+              nodes[s+1] = c[0] + (n+1)*(c[1] + (n+1)*c[2]);
+            }
+            mesh.add_tet(nodes[0], nodes[1], nodes[2], nodes[3]);
+          }
+  }
+
+  /// Reference edge and face to cell maps built from the cell definitions.
+  void referenceTables(const TVMesh& mesh,
+    std::map<NodeKey, std::set<index_type> >& edges,
+    std::map<NodeKey, std::set<index_type> >& faces)
+  {
+    TVMesh::Cell::size_type ncells;
+    mesh.size(ncells);
+    TVMesh::Node::array_type nodes;
+    for (index_type c = 0; c < static_cast<index_type>(ncells); ++c)
+    {
+      mesh.get_nodes(nodes, TVMesh::Cell::index_type(c));
+      for (int e = 0; e < 6; ++e)
+        edges[key(nodes[TetEdges[e][0]], nodes[TetEdges[e][1]])].insert(c);
+      for (int f = 0; f < 4; ++f)
+        faces[key(nodes[TetFaces[f][0]], nodes[TetFaces[f][1]], nodes[TetFaces[f][2]])].insert(c);
+    }
+  }
+
+  std::set<index_type> cellsOfEdge(const TVMesh& mesh, index_type e)
+  {
+    // Prefill so a stale array shows up if get_cells appends instead of resizing.
+    TVMesh::Cell::array_type cells(9, TVMesh::Cell::index_type(-1));
+    mesh.get_cells(cells, TVMesh::Edge::index_type(e));
+    return std::set<index_type>(cells.begin(), cells.end());
+  }
+}
+
+TEST(TetVolMeshTest, EdgeAndFaceTablesMatchCubeGridCounts)
+{
+  const int n = 3;
+  TVMesh mesh;
+  makeCubeGrid(mesh, n);
+  mesh.synchronize(Mesh::EDGES_E | Mesh::FACES_E);
+
+  const size_type V = (n+1)*(n+1)*(n+1);
+  const size_type C = 6*n*n*n;
+  // Axis edges, face diagonals and one cube diagonal per cube.
+  const size_type E = 3*n*(n+1)*(n+1) + 3*n*n*(n+1) + n*n*n;
+  // Euler characteristic of a ball: V - E + F - C = 1.
+  const size_type F = 1 - V + E + C;
+
+  std::map<NodeKey, std::set<index_type> > refEdges, refFaces;
+  referenceTables(mesh, refEdges, refFaces);
+  ASSERT_EQ(E, static_cast<size_type>(refEdges.size()));
+  ASSERT_EQ(F, static_cast<size_type>(refFaces.size()));
 
+  TVMesh::Edge::size_type nedges;
+  TVMesh::Face::size_type nfaces;
+  mesh.size(nedges);
+  mesh.size(nfaces);
+  EXPECT_EQ(E, static_cast<size_type>(nedges));
+  EXPECT_EQ(F, static_cast<size_type>(nfaces));
+
+  TVMesh::Node::array_type nodes;
+  std::set<NodeKey> seen;
+  for (index_type e = 0; e < static_cast<index_type>(nedges); ++e)
+  {
+    mesh.get_nodes(nodes, TVMesh::Edge::index_type(e));
+    ASSERT_EQ(2u, nodes.size());
+    NodeKey k = key(nodes[0], nodes[1]);
+    EXPECT_TRUE(seen.insert(k).second);
+    ASSERT_EQ(1u, refEdges.count(k));
+    EXPECT_EQ(refEdges[k], cellsOfEdge(mesh, e));
+  }
+
+  seen.clear();
+  TVMesh::Cell::array_type cells;
+  for (index_type f = 0; f < static_cast<index_type>(nfaces); ++f)
+  {
+    mesh.get_nodes(nodes, TVMesh::Face::index_type(f));
+    ASSERT_EQ(3u, nodes.size());
+    NodeKey k = key(nodes[0], nodes[1], nodes[2]);
+    EXPECT_TRUE(seen.insert(k).second);
+    ASSERT_EQ(1u, refFaces.count(k));
+    mesh.get_cells(cells, TVMesh::Face::index_type(f));
+    EXPECT_EQ(refFaces[k], std::set<index_type>(cells.begin(), cells.end()));
+  }
+}
+
+TEST(TetVolMeshTest, DeletingAndRecreatingCellEdgesUpdatesTables)
+{
+  const int n = 2;
+  TVMesh mesh;
+  makeCubeGrid(mesh, n);
+  mesh.synchronize(Mesh::EDGES_E);
+
+  std::map<NodeKey, std::set<index_type> > refEdges, refFaces;
+  referenceTables(mesh, refEdges, refFaces);
+
+  TVMesh::Edge::size_type nedges;
+  mesh.size(nedges);
+  std::map<NodeKey, index_type> edgeIndex;
+  TVMesh::Node::array_type nodes;
+  for (index_type e = 0; e < static_cast<index_type>(nedges); ++e)
+  {
+    mesh.get_nodes(nodes, TVMesh::Edge::index_type(e));
+    edgeIndex[key(nodes[0], nodes[1])] = e;
+  }
+
+  TVMesh::Node::array_type cellNodes;
+  mesh.get_nodes(cellNodes, TVMesh::Cell::index_type(0));
+  mesh.delete_cell_edges(TVMesh::Cell::index_type(0));
+
+  for (int e = 0; e < 6; ++e)
+  {
+    NodeKey k = key(cellNodes[TetEdges[e][0]], cellNodes[TetEdges[e][1]]);
+    std::set<index_type> expected = refEdges[k];
+    expected.erase(0);
+    EXPECT_EQ(expected, cellsOfEdge(mesh, edgeIndex[k]));
+    // An edge that only belonged to cell 0 is emptied.
+    mesh.get_nodes(nodes, TVMesh::Edge::index_type(edgeIndex[k]));
+    EXPECT_EQ(expected.empty() ? 0u : 2u, nodes.size());
+  }
+
+  // Untouched edges keep their cells.
+  for (const auto& edge : refEdges)
+  {
+    if (edge.second.count(0) == 0)
+      EXPECT_EQ(edge.second, cellsOfEdge(mesh, edgeIndex[edge.first]));
+  }
+
+  mesh.create_cell_edges(TVMesh::Cell::index_type(0));
+  TVMesh::Edge::size_type nedgesAfter;
+  mesh.size(nedgesAfter);
+  for (index_type e = 0; e < static_cast<index_type>(nedgesAfter); ++e)
+  {
+    mesh.get_nodes(nodes, TVMesh::Edge::index_type(e));
+    if (nodes.empty())
+      continue;
+    NodeKey k = key(nodes[0], nodes[1]);
+    EXPECT_EQ(refEdges[k], cellsOfEdge(mesh, e));
+  }
+}
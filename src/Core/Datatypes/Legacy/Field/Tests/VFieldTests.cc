@@ -30,6 +30,8 @@
 
 #include <Core/Datatypes/Legacy/Field/Field.h> 
 #include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/Legacy/Field/FieldInformation.h>
 
 #include <Testing/Utils/SCIRunFieldSamples.h>
 
@@ -37,6 +39,7 @@
 
 using namespace SCIRun;
 using namespace SCIRun::TestUtils;
+using namespace SCIRun::Core::Geometry;
 
 TEST(VFieldTest, EmptyFieldConstantBasis)
 {
@@ -135,4 +138,85 @@ TEST(VFieldTest, TetVolMeshAddValuesLinearBasis)
   vfield->set_values(values);
   
   ASSERT_EQ(vfield->num_values(), 4);
-}
\ No newline at end of file
+}
+
+namespace
+{
+  FieldHandle LatVolField(int size)
+  {
+    FieldInformation fi("LatVolMesh", 1, "double");
+    MeshHandle mesh = CreateMesh(fi, size, size, size, Point(0,0,0), Point(1,1,1));
+    return CreateField(fi, mesh);
+  }
+}
+
+TEST(VFieldTest, LatVolSharedValuesAreNotChangedThroughCopies)
+{
+  FieldHandle field = LatVolField(3);
+  VField *vfield = field->vfield();
+
+  boost::shared_ptr<std::vector<double> > buffer(new std::vector<double>(27));
+  for (size_t i = 0; i < buffer->size(); ++i)
+    (*buffer)[i] = static_cast<double>(i);
+
+  ASSERT_TRUE(vfield->share_values_pointer(&(*buffer)[0], buffer));
+  EXPECT_EQ(&(*buffer)[0], vfield->get_values_pointer());
+
+  double val;
+  vfield->get_value(val, 26);
+  EXPECT_EQ(26.0, val);
+
+  // Sharing is a view: changes to the owner show up in the field.
+  (*buffer)[26] = 100.0;
+  vfield->get_value(val, 26);
+  EXPECT_EQ(100.0, val);
+
+  // A clone owns its values, changing it leaves the shared memory alone.
+  FieldHandle copy(field->clone());
+  copy->vfield()->set_value(-1.0, 0);
+  EXPECT_EQ(0.0, (*buffer)[0]);
+  copy->vfield()->get_value(val, 26);
+  EXPECT_EQ(100.0, val);
+
+  // Resizing detaches the field from the shared memory, even at equal size.
+  vfield->resize_values();
+  EXPECT_NE(&(*buffer)[0], vfield->get_values_pointer());
+  vfield->set_value(-2.0, 1);
+  EXPECT_EQ(1.0, (*buffer)[1]);
+  vfield->get_value(val, 2);
+  EXPECT_EQ(2.0, val);
+}
+
+TEST(VFieldTest, LatVolValuesStorageOutlivesField)
+{
+  FieldHandle field = LatVolField(2);
+  VField *vfield = field->vfield();
+  for (VMesh::index_type i = 0; i < 8; ++i)
+    vfield->set_value(static_cast<double>(i), i);
+
+  boost::shared_ptr<void> storage = vfield->get_values_storage();
+  ASSERT_TRUE(storage.get() != nullptr);
+  const double* data = static_cast<const double*>(storage.get());
+  EXPECT_EQ(vfield->get_values_pointer(), storage.get());
+
+  // Once the storage is handed out the field writes into its own copy.
+  vfield->resize_values();
+  vfield->set_value(-1.0, 3);
+  EXPECT_EQ(3.0, data[3]);
+
+  field.reset();
+  EXPECT_EQ(7.0, data[7]);
+}
+
+TEST(VFieldTest, UnstructuredValuesCannotBeShared)
+{
+  FieldHandle field = TetrahedronTetVolConstantBasis(DOUBLE_E);
+  VField *vfield = field->vfield();
+  vfield->resize_values();
+
+  EXPECT_TRUE(vfield->get_values_storage().get() == nullptr);
+
+  boost::shared_ptr<std::vector<double> > buffer(new std::vector<double>(1, 5.0));
+  EXPECT_FALSE(vfield->share_values_pointer(&(*buffer)[0], buffer));
+  EXPECT_NE(&(*buffer)[0], vfield->get_values_pointer());
+}
@@ -505,8 +505,7 @@ VMesh::index_type*
 VTetVolMesh<MESH>::
 get_elems_pointer() const
 {
-  if (this->mesh_->cells_.size() == 0) return (0);
-   return (&(this->mesh_->cells_[0]));
+  return (storage_pointer(this->mesh_->cells_));
 }
 
 
@@ -33,8 +33,11 @@
 /// Include what kind of support we want to have
 /// Need to fix this and couple it sci-defs
 #include <Core/Datatypes/Legacy/Field/MeshSupport.h>
+#include <Core/Datatypes/Legacy/Field/MeshStorage.h>
 
 #include <Core/Containers/StackVector.h>
+#include <Core/Containers/CompressedAdjacency.h>
+#include <Core/Containers/SortedVectorMap.h>
 #include <Core/Persistent/PersistentSTL.h>
 
 #include <Core/GeometryPrimitives/SearchGridT.h>
@@ -262,22 +265,22 @@ public:
     }
 
     inline
-    const Core::Geometry::Point &node0() const 
+    const Core::Geometry::Point node0() const 
     {
       return mesh_.points_[node0_index()];
     }
     inline
-    const Core::Geometry::Point &node1() const 
+    const Core::Geometry::Point node1() const 
     {
       return mesh_.points_[node1_index()];
     }
     inline
-    const Core::Geometry::Point &node2() const 
+    const Core::Geometry::Point node2() const 
     {
       return mesh_.points_[node2_index()];
     }
     inline
-    const Core::Geometry::Point &node3() const 
+    const Core::Geometry::Point node3() const 
     {
       return mesh_.points_[node3_index()];
     }
@@ -411,6 +414,10 @@ public:
   virtual bool synchronize(mask_type mask);
   virtual bool unsynchronize(mask_type mask);
   bool clear_synchronization();
+
+  /// Select float coordinates and/or 32 bit connectivity.
+  virtual bool set_storage_mode(mask_type mode);
+  virtual mask_type storage_mode() const;
   
   /// Get the basis class.  
   Basis& get_basis() { return basis_; }
@@ -648,7 +655,7 @@ public:
   void get_point(Core::Geometry::Point &result, typename Node::index_type index) const
   { result = points_[index]; }
   void set_point(const Core::Geometry::Point &point, typename Node::index_type index)
-  { points_[index] = point; }
+  { points_.set(index, point); }
   void get_random_point(Core::Geometry::Point &p, typename Elem::index_type i, FieldRNG &r) const;
     
   /// Normals for visualizations
@@ -700,10 +707,10 @@ public:
  
   /// Functions to improve memory management. Often one knows how many
   /// nodes/elements one needs, prereserving memory is often possible. 
-  void node_reserve(size_type s) { points_.reserve(static_cast<std::vector<Core::Geometry::Point>::size_type>(s)); }
-  void elem_reserve(size_type s) { cells_.reserve(static_cast<std::vector<index_type>::size_type>(s*4)); }
-  void resize_nodes(size_type s) { points_.resize(static_cast<std::vector<Core::Geometry::Point>::size_type>(s)); }
-  void resize_elems(size_type s) { cells_.resize(static_cast<std::vector<index_type>::size_type>(s*4)); }
+  void node_reserve(size_type s) { points_.reserve(static_cast<size_t>(s)); }
+  void elem_reserve(size_type s) { cells_.reserve(static_cast<size_t>(s*4)); }
+  void resize_nodes(size_type s) { points_.resize(static_cast<size_t>(s)); }
+  void resize_elems(size_type s) { cells_.resize(static_cast<size_t>(s*4)); }
 
   /// Get the local coordinates for a certain point within an element
   /// This function uses a couple of newton iterations to find the local
@@ -1476,7 +1483,16 @@ public:
 			   const Core::Geometry::Point &p);
 
   /// must detach, if altering points!
-  std::vector<Core::Geometry::Point>& get_points() { return points_; }
+  PointStorage& get_points() { return points_; }
+
+  /// Bytes held by the edge, face and node neighbor tables that synchronize
+  /// builds, reported by the benchmark suite.
+  size_t adjacency_memory_size() const
+  {
+    return faces_.capacity() * sizeof(PFaceCell) + face_table_.memory_size() +
+      edges_.memory_size() + edge_table_.memory_size() +
+      node_neighbors_.memory_size() + boundary_faces_.capacity();
+  }
  
   int compute_checksum();
 
@@ -1499,12 +1515,12 @@ protected:
     ASSERTMSG(synchronized_ & Mesh::EDGES_E,
               "TetVolMesh: Must call synchronize EDGES_E first");
 
-    if (edges_[idx].cells_.size() == 0)
+    if (edges_[idx].size() == 0)
       { array.clear(); return; }
     
     array.resize(2);
 
-    index_type cell_edge_index = edges_[idx].cells_[0];
+    index_type cell_edge_index = edges_[idx][0];
     index_type cell_index = (cell_edge_index>>3) << 2;
     index_type edge_index = (cell_edge_index)&0x7;
 
@@ -1611,37 +1627,37 @@ protected:
     typedef typename ARRAY::value_type T;
     if (n1 != n2) 
     { 
-      PEdge e(n1,n2); 
+      PEdgeNode e(n1,n2); 
       array[i++] = (static_cast<T>((*(edge_table_.find(e))).second)); 
     }
     n1 = cells_[off + 1]; n2 = cells_[off + 2];
     if (n1 != n2) 
     { 
-      PEdge e(n1,n2); 
+      PEdgeNode e(n1,n2); 
       array[i++] = (static_cast<T>((*(edge_table_.find(e))).second)); 
     }
     n1 = cells_[off + 2]; n2 = cells_[off    ];
     if (n1 != n2) 
     { 
-      PEdge e(n1,n2); 
+      PEdgeNode e(n1,n2); 
       array[i++] = (static_cast<T>((*(edge_table_.find(e))).second)); 
     }
     n1 = cells_[off    ]; n2 = cells_[off + 3];
     if (n1 != n2) 
     { 
-      PEdge e(n1,n2); 
+      PEdgeNode e(n1,n2); 
       array[i++] = (static_cast<T>((*(edge_table_.find(e))).second)); 
     }
     n1 = cells_[off + 1]; n2 = cells_[off + 3];
     if (n1 != n2) 
     { 
-      PEdge e(n1,n2); 
+      PEdgeNode e(n1,n2); 
       array[i++] = (static_cast<T>((*(edge_table_.find(e))).second)); 
     }
     n1 = cells_[off + 2]; n2 = cells_[off + 3];
     if (n1 != n2) 
     { 
-      PEdge e(n1,n2); 
+      PEdgeNode e(n1,n2); 
       array[i++] = (static_cast<T>((*(edge_table_.find(e))).second)); 
     }
   }
@@ -1703,7 +1719,7 @@ protected:
       "HexVolMesh: Must call synchronize EDGES_E first");
 
     // Get all the nodes that share an edge with this node
-    const std::vector<typename Cell::index_type>& neighbors = node_neighbors_[idx];
+    typename NodeNeighborMap::Row neighbors = node_neighbors_[idx];
     
     array.clear();
     array.reserve(neighbors.size());
@@ -1717,17 +1733,17 @@ protected:
        
       PEdgeNode e(cells_[cell_index+offset[0]],cells_[cell_index+offset[1]]);
       typename edge_nt::const_iterator iter = edge_table_.find(e);
-      if (((edges_[iter->second].cells_[0])&(~0x7))==(cell_index<<1) )
+      if (((edges_[iter->second][0])&(~0x7))==(cell_index<<1) )
         array.push_back(typename ARRAY::value_type(iter->second));
 
       PEdgeNode e1(cells_[cell_index+offset[2]],cells_[cell_index+offset[3]]);
       iter = edge_table_.find(e1);
-      if (((edges_[iter->second].cells_[0])&(~0x7))==(cell_index<<1) )
+      if (((edges_[iter->second][0])&(~0x7))==(cell_index<<1) )
         array.push_back(typename ARRAY::value_type(iter->second));
 
       PEdgeNode e2(cells_[cell_index+offset[4]],cells_[cell_index+offset[5]]);
       iter = edge_table_.find(e2);
-      if (((edges_[iter->second].cells_[0])&(~0x7))==(cell_index<<1) )
+      if (((edges_[iter->second][0])&(~0x7))==(cell_index<<1) )
         array.push_back(typename ARRAY::value_type(iter->second));
     }
   }
@@ -1742,10 +1758,11 @@ protected:
 
     array.clear();
     
-    for (size_t c=0; c<edges_[idx].cells_.size();c++)
+    typename EdgeCellMap::Row edge_cells = edges_[idx];
+    for (size_t c=0; c<edge_cells.size();c++)
     {
-      index_type cell_index = ((edges_[idx].cells_[c])>>3)<<2;
-      index_type face_index = (edges_[idx].cells_[c])&0x7;
+      index_type cell_index = ((edge_cells[c])>>3)<<2;
+      index_type face_index = (edge_cells[c])&0x7;
 
       const int* off = TetVolFacePerEdgeTable[face_index];
 
@@ -1779,7 +1796,7 @@ protected:
       "TetVolMesh: Must call synchronize FACES_E first");
     
     // Get all the nodes that share an edge with this node
-    const std::vector<typename Cell::index_type>& neighbors = node_neighbors_[idx];
+    typename NodeNeighborMap::Row neighbors = node_neighbors_[idx];
     
     array.clear();
     array.reserve(neighbors.size());
@@ -1817,8 +1834,10 @@ protected:
   {
     ASSERTMSG(synchronized_ & Mesh::EDGES_E,
               "TetVolMesh: Must call synchronize EDGES_E first");
-    for (size_t i=0; i< edges_[idx].cells_.size(); i++)
-      array[i] = static_cast<typename ARRAY::value_type>(edges_[idx].cells_[i]);  
+    typename EdgeCellMap::Row edge_cells = edges_[idx];
+    array.resize(edge_cells.size());
+    for (size_t i=0; i< edge_cells.size(); i++)
+      array[i] = static_cast<typename ARRAY::value_type>(edge_cells[i]>>3);
   }
   
   template<class ARRAY, class INDEX>
@@ -1843,7 +1862,7 @@ protected:
   inline void set_nodes_by_elem(ARRAY &array, INDEX idx)
   {
     for (index_type n = 0; n < 4; ++n)
-      cells_[idx * 4 + n] = static_cast<index_type>(array[n]);
+      cells_.set(idx * 4 + n, static_cast<index_type>(array[n]));
   }
 
   template <class INDEX1, class INDEX2>
@@ -2252,7 +2271,7 @@ protected:
   void insert_node_into_grid(typename Node::index_type ci);
   void remove_node_from_grid(typename Node::index_type ci);
 
-  const Core::Geometry::Point &point(typename Node::index_type i) { return points_[i]; }
+  const Core::Geometry::Point point(typename Node::index_type i) { return points_[i]; }
 
   template<class INDEX>
   bool inside(INDEX idx, const Core::Geometry::Point &p) const
@@ -2309,10 +2328,10 @@ protected:
   }
 
   /// all the nodes.
-  std::vector<Core::Geometry::Point>         points_;
+  PointStorage               points_;
 
   /// each 4 indicies make up a tet
-  std::vector<under_type>    cells_;
+  IndexStorage               cells_;
 
   /// Face information.
   class PFaceCell {
@@ -2398,14 +2417,6 @@ protected:
     }
   };
 
-  class PFace : public PFaceNode, public PFaceCell
-  {
-    public:
-      PFace(typename Node::index_type n1, typename Node::index_type n2,
-          typename Node::index_type n3) :
-        PFaceNode(n1,n2,n3) {}
-  };
-
   /// Edge information.
   class PEdgeNode {
     public:
@@ -2449,22 +2460,6 @@ protected:
     }
   };
 
-  class PEdgeCell {
-    public:
-      /// list of all the cells this edge is in.
-      std::vector<index_type> cells_;
-
-      bool shared() const { return cells_.size() > 1; }
-  };
-  
-  /// Edge information.
-  class PEdge : public PEdgeNode, public PEdgeCell 
-  {
-    public:
-      PEdge(typename Node::index_type n1,typename Node::index_type n2) :
-        PEdgeNode(n1,n2) {}
-  };  
-  
   /// hash the egde's node_indecies such that edges with the same nodes
   ///  hash to the same value. nodes are sorted on edge construction. 
   static const int sz_int = sizeof(int) * 8; // in bits
@@ -2532,32 +2527,14 @@ protected:
     }
   };
 
-/// Define the hash_map type, as this is not yet an approved type under Windows
-/// it is located in stdext
-
-#ifdef HAVE_HASH_MAP
-  #if defined(_WIN32)
-    /// hash_map is in stdext namespace
-  typedef stdext::hash_map<PFace, typename Face::index_type, FaceHash> face_ht;
-  typedef stdext::hash_map<PFaceNode, typename Face::index_type, FaceHash> face_nt;
-  typedef stdext::hash_map<PEdge, typename Edge::index_type, EdgeHash> edge_ht;
-  typedef stdext::hash_map<PEdgeNode, typename Edge::index_type, EdgeHash> edge_nt;
-  #else
-    /// hash_map is in stdext namespace
-  typedef hash_map<PFace, typename Face::index_type, FaceHash> face_ht;
-  typedef hash_map<PFaceNode, typename Face::index_type, FaceHash> face_nt;
-  typedef hash_map<PEdge, typename Edge::index_type, EdgeHash> edge_ht;  
-  typedef hash_map<PEdgeNode, typename Edge::index_type, EdgeHash> edge_nt;  
-  #endif
-#else
-  typedef std::map<PFace, typename Face::index_type, FaceHash> face_ht;
-  typedef std::map<PFaceNode, typename Face::index_type, FaceHash> face_nt;
-  typedef std::map<PEdge, typename Edge::index_type, EdgeHash> edge_ht;
-  typedef std::map<PEdgeNode, typename Edge::index_type, EdgeHash> edge_nt;
-#endif
+  /// Edge and face lookup tables, stored as arrays sorted by node indices.
+  typedef SortedVectorMap<PFaceNode, typename Face::index_type, FaceHash> face_nt;
+  typedef SortedVectorMap<PEdgeNode, typename Edge::index_type, EdgeHash> edge_nt;
 
   typedef std::vector<PFaceCell> face_ct;
-  typedef std::vector<PEdgeCell> edge_ct;
+  /// For every edge the combined (cell,edge) indices of the cells using it.
+  typedef CompressedAdjacency<index_type> EdgeCellMap;
+  typedef CompressedAdjacency<typename Cell::index_type> NodeNeighborMap;
 
   // These should not be called outside of the synchronize_lock_.
   
@@ -2567,7 +2544,7 @@ protected:
   face_nt face_table_;
   /// container for edge storage. Must be computed each time
   ///  nodes or cells change. 
-  edge_ct edges_;
+  EdgeCellMap edges_;
   edge_nt edge_table_;
 
   inline void remove_edge(typename Node::index_type n1,
@@ -2575,11 +2552,6 @@ protected:
 			  typename Cell::index_type ci,
 			  bool table_only = false);
 
-  inline void hash_edge(typename Node::index_type n1, 
-                        typename Node::index_type n2,
-                        index_type combined_index,
-                        edge_ht& table);
-                        
   inline void add_edge(typename Node::index_type n1, 
                         typename Node::index_type n2,
                         index_type combined_index);
@@ -2589,16 +2561,12 @@ protected:
                           typename Node::index_type n3,
                           typename Cell::index_type ci,
                           bool table_only = false);
-  inline void hash_face(typename Node::index_type n1, 
-                        typename Node::index_type n2,
-                        typename Node::index_type n3, 
-                        index_type ci, face_ht& table);
   inline void add_face(typename Node::index_type n1, 
                        typename Node::index_type n2,
                        typename Node::index_type n3, 
                        index_type combined_index);
 
-  std::vector<std::vector<typename Cell::index_type> > node_neighbors_;
+  NodeNeighborMap node_neighbors_;
   std::vector<unsigned char> boundary_faces_;
 
   /// This grid is used as an acceleration structure to expedite calls
@@ -2652,18 +2620,18 @@ int
 TetVolMesh<Basis>::compute_checksum()
 {
   int sum = 0;
-  sum += SCIRun::compute_checksum(&points_[0],points_.size());
-  sum += SCIRun::compute_checksum(&cells_[0],cells_.size());
+  sum += points_.checksum();
+  sum += cells_.checksum();
   return (sum);
 }
 
 template <class Basis>
 TetVolMesh<Basis>::TetVolMesh() :
-  points_(0),
-  cells_(0),
+  points_(),
+  cells_(),
   faces_(0),
   face_table_(),
-  edges_(0),
+  edges_(),
   edge_table_(),
   synchronize_lock_("TetVolMesh lock"),
   synchronize_cond_("TetVolMesh condition variable"),
@@ -2681,11 +2649,11 @@ TetVolMesh<Basis>::TetVolMesh() :
 template <class Basis>
 TetVolMesh<Basis>::TetVolMesh(const TetVolMesh &copy) :
   Mesh(copy),
-  points_(0),
-  cells_(0),
+  points_(),
+  cells_(),
   faces_(0),
   face_table_(),
-  edges_(0),
+  edges_(),
   edge_table_(),
   synchronize_lock_("TetVolMesh lock"),
   synchronize_cond_("TetVolMesh condition variable"),
@@ -2734,11 +2702,11 @@ TetVolMesh<Basis>::fill_points(Iter begin, Iter end, Functor fill_ftor)
   synchronize_lock_.lock();
   Iter iter = begin;
   points_.resize(end - begin); // resize to the new size
-  std::vector<Core::Geometry::Point>::iterator piter = points_.begin();
+  size_t i = 0;
   while (iter != end) 
   {
-    *piter = fill_ftor(*iter);
-    ++piter; ++iter;
+    points_.set(i, fill_ftor(*iter));
+    ++i; ++iter;
   }
   synchronize_lock_.unlock();
 }
@@ -2751,18 +2719,15 @@ TetVolMesh<Basis>::fill_cells(Iter begin, Iter end, Functor fill_ftor)
   synchronize_lock_.lock();
   Iter iter = begin;
   cells_.resize((end - begin) * 4); // resize to the new size
-  std::vector<under_type>::iterator citer = cells_.begin();
+  size_t i = 0;
   while (iter != end) 
   {
     index_type *nodes = fill_ftor(*iter); // returns an array of length 4
-    *citer = nodes[0];
-    ++citer;
-    *citer = nodes[1];
-    ++citer;
-    *citer = nodes[2];
-    ++citer;
-    *citer = nodes[3];
-    ++citer; ++iter;
+    cells_.set(i++, nodes[0]);
+    cells_.set(i++, nodes[1]);
+    cells_.set(i++, nodes[2]);
+    cells_.set(i++, nodes[3]);
+    ++iter;
   }
   synchronize_lock_.unlock();
 }
@@ -2870,12 +2835,9 @@ TetVolMesh<Basis>::transform(const Core::Geometry::Transform &t)
 {
   synchronize_lock_.lock();
   
-  std::vector<Core::Geometry::Point>::iterator itr = points_.begin();
-  std::vector<Core::Geometry::Point>::iterator eitr = points_.end();
-  while (itr != eitr)
+  for (size_t i = 0; i < points_.size(); i++)
   {
-    *itr = t.project(*itr);
-    ++itr;
+    points_.set(i, t.project(points_[i]));
   }
 
   if (bbox_.valid())
@@ -2952,98 +2914,87 @@ TetVolMesh<Basis>::remove_face(typename Node::index_type n1,
   }
 }
 
-template <class Basis>
-void
-TetVolMesh<Basis>::hash_face(typename Node::index_type n1,
-                             typename Node::index_type n2,
-                             typename Node::index_type n3,
-                             index_type combined_index,
-                             face_ht& table)
-{
-  PFace f(n1, n2, n3);
-
-  typename face_ht::iterator iter = table.find(f);
-  if (iter == table.end()) 
-  {
-    f.cells_[0] = combined_index;
-    table[f] = 0; // insert for the first time
-  } 
-  else 
-  {
-    PFace f = (*iter).first;
-    if (f.cells_[1] != MESH_NO_NEIGHBOR) 
-    {
-      std::cerr << "TetVolMesh - This Mesh has problems: Cells #"
-           << (f.cells_[0]>>2) << ", #" << (f.cells_[1]>>2) << ", and #" 
-           << (combined_index>>2) << " are illegally adjacent." << std::endl;
-    } 
-    else if ((f.cells_[0]>>2) == (combined_index>>2)) 
-    {
-      std::cerr << "TetVolMesh - This Mesh has problems: Cells #"
-           << (f.cells_[0]>>2) << " and #" << (combined_index>>2)
-           << " are the same." << std::endl;
-    } 
-    else 
-    {
-      f.cells_[1] = combined_index; // add this cell
-      table.erase(iter);
-      table[f] = 0;
-    }
-  }
-}
 
 template <class Basis>
 void
 TetVolMesh<Basis>::compute_faces()
 {
+  // Collect the faces of all cells and sort them by their nodes, which
+  // places the cells sharing a face next to each other.
+  typedef std::pair<PFaceNode, index_type> cell_face_type;
+  std::vector<cell_face_type> cell_faces;
+  cell_faces.reserve(cells_.size());
+
   typename Cell::iterator ci, cie;
   begin(ci); end(cie);
   typename Node::array_type arr(4);
   
-  face_ht table;
-  
   while (ci != cie)
   {
     get_nodes(arr, *ci);
     // 4 faces -- each is entered CCW from outside looking in
 
     index_type cell_index = (*ci)<<2;
-    hash_face(arr[0], arr[2], arr[1], cell_index, table);
-    hash_face(arr[1], arr[2], arr[3], cell_index + 1, table);
-    hash_face(arr[0], arr[1], arr[3], cell_index + 2, table);
-    hash_face(arr[0], arr[3], arr[2], cell_index + 3, table);
+    cell_faces.push_back(cell_face_type(PFaceNode(arr[0], arr[2], arr[1]), cell_index));
+    cell_faces.push_back(cell_face_type(PFaceNode(arr[1], arr[2], arr[3]), cell_index + 1));
+    cell_faces.push_back(cell_face_type(PFaceNode(arr[0], arr[1], arr[3]), cell_index + 2));
+    cell_faces.push_back(cell_face_type(PFaceNode(arr[0], arr[3], arr[2]), cell_index + 3));
     ++ci;
   }
 
-  faces_.resize(table.size());
+  std::sort(cell_faces.begin(), cell_faces.end(),
+    [](const cell_face_type& a, const cell_face_type& b)
+    { return (a.first < b.first) || (a.first == b.first && a.second < b.second); });
 
-  typename face_ht::iterator ht_iter = table.begin();
-  typename face_ht::iterator ht_iter_end = table.end();
-  
+  std::vector<typename face_nt::value_type> table;
+  faces_.clear();
+  boundary_faces_.clear();
   boundary_faces_.resize(cells_.size() >> 2);
-  
-  index_type uidx = 0;
-  while (ht_iter != ht_iter_end) 
+
+  size_t i = 0;
+  while (i < cell_faces.size())
   {
-    const PFace& pface = (*ht_iter).first;
-    faces_[uidx].cells_[0] = pface.cells_[0];
-    faces_[uidx].cells_[1] = pface.cells_[1];
-    face_table_[PFaceNode(pface.nodes_[0],pface.nodes_[1],pface.nodes_[2])] = uidx;
+    const PFaceNode& pface = cell_faces[i].first;
+    PFaceCell face;
+    face.cells_[0] = cell_faces[i].second;
 
-    if (pface.cells_[1] == -1)
+    for (++i; i < cell_faces.size() && cell_faces[i].first == pface; ++i)
     {
-      index_type cell = (pface.cells_[0]) >> 2;
-      index_type face = (pface.cells_[0]) & 0x3;
-      boundary_faces_[cell] |= 1 << face;
+      index_type combined_index = cell_faces[i].second;
+      if (face.cells_[1] != MESH_NO_NEIGHBOR) 
+      {
+        std::cerr << "TetVolMesh - This Mesh has problems: Cells #"
+             << (face.cells_[0]>>2) << ", #" << (face.cells_[1]>>2) << ", and #" 
+             << (combined_index>>2) << " are illegally adjacent." << std::endl;
+      } 
+      else if ((face.cells_[0]>>2) == (combined_index>>2)) 
+      {
+        std::cerr << "TetVolMesh - This Mesh has problems: Cells #"
+             << (face.cells_[0]>>2) << " and #" << (combined_index>>2)
+             << " are the same." << std::endl;
+      } 
+      else 
+      {
+        face.cells_[1] = combined_index;
+      }
     }
-    ++ht_iter; uidx++;
+
+    if (face.cells_[1] == MESH_NO_NEIGHBOR)
+    {
+      index_type cell = (face.cells_[0]) >> 2;
+      index_type f = (face.cells_[0]) & 0x3;
+      boundary_faces_[cell] |= 1 << f;
+    }
+
+    table.push_back(typename face_nt::value_type(pface,
+      static_cast<typename Face::index_type>(faces_.size())));
+    faces_.push_back(face);
   }
+  face_table_.assign_sorted(table);
   
   synchronize_lock_.lock();
   synchronized_ |= Mesh::FACES_E;
   synchronize_lock_.unlock();
-
-  
 }
 
 
@@ -3081,66 +3032,56 @@ TetVolMesh<Basis>::add_face(typename Node::index_type n1,
   }
 }
 
-template <class Basis>
-void
-TetVolMesh<Basis>::hash_edge(typename Node::index_type n1,
-                             typename Node::index_type n2,
-                             index_type combined_index,
-                             edge_ht& table)
-{
-  if (n1 == n2) return;
-  PEdge e(n1, n2);
-  typename edge_ht::iterator iter = table.find(e);
-
-  if (iter == table.end()) 
-  {
-    e.cells_.push_back(combined_index); // add this cell
-    table[e] = 0; // insert for the first time
-  } 
-  else
-  {
-    PEdge e = (*iter).first;
-    e.cells_.push_back(combined_index); // add this cell
-    table.erase(iter);
-    table[e] = 0;
-  }
-}
 
 template <class Basis>
 void
 TetVolMesh<Basis>::compute_edges()
 {
+  // Collect the edges of all cells and sort them by their nodes, which
+  // places the cells sharing an edge next to each other.
+  typedef std::pair<PEdgeNode, index_type> cell_edge_type;
+  std::vector<cell_edge_type> cell_edges;
+  cell_edges.reserve((cells_.size() >> 2) * 6);
+
   typename Cell::iterator ci, cie;
   begin(ci); end(cie);
-  edge_ht table;
   
+  static const int edge_nodes[6][2] = { {0,1}, {1,2}, {2,0}, {3,0}, {3,1}, {3,2} };
   typename Node::array_type arr;
   while (ci != cie)
   {
     get_nodes(arr, *ci);
     index_type cell_index = (*ci)<<3;
-    hash_edge(arr[0], arr[1], cell_index  ,table);
-    hash_edge(arr[1], arr[2], cell_index+1,table);
-    hash_edge(arr[2], arr[0], cell_index+2,table);
-    hash_edge(arr[3], arr[0], cell_index+3,table);
-    hash_edge(arr[3], arr[1], cell_index+4,table);
-    hash_edge(arr[3], arr[2], cell_index+5,table);
+    for (int k = 0; k < 6; ++k)
+    {
+      typename Node::index_type n1 = arr[edge_nodes[k][0]];
+      typename Node::index_type n2 = arr[edge_nodes[k][1]];
+      if (n1 != n2) cell_edges.push_back(cell_edge_type(PEdgeNode(n1, n2), cell_index + k));
+    }
     ++ci;
   }
   
-  edges_.resize(table.size());
-  
-  typename edge_ht::iterator ht_iter = table.begin();
-  typename edge_ht::iterator ht_iter_end = table.end();
-  
-  index_type uidx = 0;
-  while (ht_iter != ht_iter_end) 
+  std::sort(cell_edges.begin(), cell_edges.end(),
+    [](const cell_edge_type& a, const cell_edge_type& b)
+    { return (a.first < b.first) || (a.first == b.first && a.second < b.second); });
+
+  std::vector<typename edge_nt::value_type> table;
+  std::vector<size_t> offsets(1, 0);
+  std::vector<index_type> edge_cells;
+  edge_cells.reserve(cell_edges.size());
+
+  size_t i = 0;
+  while (i < cell_edges.size())
   {
-    const PEdge& pedge = (*ht_iter).first;
-    edges_[uidx].cells_ = pedge.cells_;
-    edge_table_[PEdgeNode(pedge.nodes_[0],pedge.nodes_[1])] = uidx;
-    ++ht_iter; uidx++;
+    const PEdgeNode& pedge = cell_edges[i].first;
+    table.push_back(typename edge_nt::value_type(pedge,
+      static_cast<typename Edge::index_type>(table.size())));
+    for (; i < cell_edges.size() && cell_edges[i].first == pedge; ++i)
+      edge_cells.push_back(cell_edges[i].second);
+    offsets.push_back(edge_cells.size());
   }
+  edges_.assign(offsets, edge_cells);
+  edge_table_.assign_sorted(table);
 
   synchronize_lock_.lock();
   synchronized_ |= Mesh::EDGES_E;
@@ -3158,13 +3099,12 @@ TetVolMesh<Basis>::add_edge(typename Node::index_type n1,
   {
     index_type uidx = static_cast<index_type>(edges_.size());
     edge_table_[e] = uidx;
-    PEdgeCell c;
-    edges_.push_back(c);
-    edges_[uidx].cells_.push_back(combined_index);
+    edges_.push_row();
+    edges_.push_back(uidx, combined_index);
   }
   else
   {
-    edges_[ht_iter->second].cells_.push_back(combined_index);
+    edges_.push_back(ht_iter->second, combined_index);
   }
 }
 
@@ -3294,6 +3234,33 @@ TetVolMesh<Basis>::unsynchronize(mask_type /*sync*/)
   return (true);
 }
 
+template <class Basis>
+bool
+TetVolMesh<Basis>::set_storage_mode(mask_type mode)
+{
+  synchronize_lock_.lock();
+  const bool use_float = (mode & Mesh::FLOAT_POINTS_E) != 0;
+  const bool ok = cells_.set_int32((mode & Mesh::INT32_INDICES_E) != 0);
+  if (ok && use_float != points_.is_float())
+  {
+    points_.set_float(use_float);
+    // Rounded coordinates need new search structures
+    synchronized_ &= ~(Mesh::LOCATE_E|Mesh::BOUNDING_BOX_E);
+  }
+  synchronize_lock_.unlock();
+  return (ok);
+}
+
+template <class Basis>
+mask_type
+TetVolMesh<Basis>::storage_mode() const
+{
+  mask_type mode = Mesh::DEFAULT_STORAGE_E;
+  if (points_.is_float()) mode |= Mesh::FLOAT_POINTS_E;
+  if (cells_.is_int32()) mode |= Mesh::INT32_INDICES_E;
+  return (mode);
+}
+
 template <class Basis>
 bool
 TetVolMesh<Basis>::clear_synchronization()
@@ -3461,7 +3428,7 @@ TetVolMesh<Basis>::remove_edge(typename Node::index_type n1,
   PEdgeNode found_edge = (*iter).first;
   index_type found_idx = (*iter).second;
   
-  const std::vector<index_type>& cells = edges_[found_idx].cells_;
+  typename EdgeCellMap::Row cells = edges_[found_idx];
   if (cells.size() < 2)
   {
     if ((cells[0] >>3) !=  ci)
@@ -3469,27 +3436,18 @@ TetVolMesh<Basis>::remove_edge(typename Node::index_type n1,
       ASSERTFAIL("this edge does exist in the table but is not connected to this cell");
     }
     edge_table_.erase(iter);
-    if (!table_only) edges_[found_idx].cells_.clear();
+    if (!table_only) edges_.clear_row(found_idx);
   }
   else
-  {   
-    typename std::vector<index_type>::iterator citer = edges_[found_idx].cells_.begin();
-    typename std::vector<index_type>::iterator citer_end = edges_[found_idx].cells_.end();
-    
-    index_type cell_idx = ci;
-    while(citer != citer_end)
+  {
+    // Erasing invalidates the row, so collect the entries of this cell first.
+    std::vector<index_type> cell_edges;
+    for (size_t c = 0; c < cells.size(); c++)
     {
-      if (((*citer)>>3)==cell_idx) {
-         // temporary fix
-         // should be replaced with algorithm
-        edges_[found_idx].cells_.erase(citer);
-        citer = edges_[found_idx].cells_.begin();
-        citer_end = edges_[found_idx].cells_.end();
-      }
-      else {
-        ++citer;
-      }
+      if ((cells[c]>>3) == ci) cell_edges.push_back(cells[c]);
     }
+    for (size_t c = 0; c < cell_edges.size(); c++)
+      edges_.erase(found_idx, cell_edges[c]);
   }
 }
  
@@ -3542,7 +3500,7 @@ TetVolMesh<Basis>::create_cell_node_neighbors(typename Cell::index_type c)
 {
   for (index_type i = c*4; i < c*4+4; ++i)
   {
-    node_neighbors_[cells_[i]].push_back(i);
+    node_neighbors_.push_back(cells_[i], i);
   }
 }
 
@@ -3553,17 +3511,11 @@ TetVolMesh<Basis>::delete_cell_node_neighbors(typename Cell::index_type c)
 {
   for (index_type i = c*4; i < c*4+4; ++i)
   {
-    const index_type n = cells_[i];
-    typename std::vector<typename Cell::index_type>::iterator node_cells_end =
-      node_neighbors_[n].end();
-    typename std::vector<typename Cell::index_type>::iterator cell =
-      node_neighbors_[n].begin();
-    while (cell != node_cells_end && (*cell) != i) ++cell;
-
     /// ASSERT that the node_neighbors_ structure contains this cell
-    ASSERT(cell != node_cells_end);
-
-    node_neighbors_[n].erase(cell);
+    if (!node_neighbors_.erase(cells_[i], i))
+    {
+      ASSERTFAIL("node_neighbors_ does not contain this cell");
+    }
   }
 }
 
@@ -3662,7 +3614,7 @@ TetVolMesh<Basis>::set_nodes(typename Node::array_type &array,
   delete_cell_syncinfo(idx);
 
   for (index_type n = 0; n < 4; ++n)
-    cells_[idx * 4 + n] = array[n];
+    cells_.set(idx * 4 + n, array[n]);
 
   create_cell_syncinfo(idx);
 }
@@ -3671,13 +3623,8 @@ template <class Basis>
 void
 TetVolMesh<Basis>::compute_node_neighbors()
 {
-  node_neighbors_.clear();
-  node_neighbors_.resize(points_.size());
-  index_type i, num_cells = cells_.size();
-  for (i = 0; i < num_cells; i++)
-  {
-    node_neighbors_[cells_[i]].push_back(i);
-  }
+  node_neighbors_.build_inverse(points_.size(), cells_,
+    [](size_t i) { return static_cast<typename Cell::index_type>(i); });
   
   synchronize_lock_.lock();
   synchronized_ |= Mesh::NODE_NEIGHBORS_E;
@@ -3889,7 +3836,7 @@ TetVolMesh<Basis>::add_find_point(const Core::Geometry::Point &p, double /*err*/
     if (synchronized_ & Mesh::NODE_NEIGHBORS_E) 
     {
       synchronize_lock_.lock();
-      node_neighbors_.push_back(std::vector<typename Cell::index_type>());
+      node_neighbors_.push_row();
       synchronize_lock_.unlock();
     }
     return static_cast<typename Node::index_type>(points_.size() - 1);
@@ -3972,16 +3919,16 @@ TetVolMesh<Basis>::mod_tet_pos(typename TetVolMesh<Basis>::Elem::index_type ci,
 
   if (Dot(Cross(p1-p0,p2-p0),p3-p0) >= 0.0)
   {
-    cells_[ci*4+0] = a;
-    cells_[ci*4+1] = b;
+    cells_.set(ci*4+0, a);
+    cells_.set(ci*4+1, b);
   }
   else
   {
-    cells_[ci*4+0] = b;
-    cells_[ci*4+1] = a;
+    cells_.set(ci*4+0, b);
+    cells_.set(ci*4+1, a);
   }
-  cells_[ci*4+2] = c;
-  cells_[ci*4+3] = d;
+  cells_.set(ci*4+2, c);
+  cells_.set(ci*4+3, d);
 }
 
 template <class Basis>
@@ -3995,10 +3942,7 @@ TetVolMesh<Basis>::delete_cells(std::set<index_type> &to_delete)
     // erase the correct cell
     typename TetVolMesh<Basis>::Cell::index_type ci = *iter++;
     index_type ind = ci * 4;
-    std::vector<index_type>::iterator cb = cells_.begin() + ind;
-    std::vector<index_type>::iterator ce = cb;
-    ce+=4;
-    cells_.erase(cb, ce);
+    cells_.erase(ind, ind + 4);
   }
 
   synchronized_ &= ~Mesh::LOCATE_E;
@@ -4025,8 +3969,7 @@ TetVolMesh<Basis>::delete_nodes(std::set<index_type> &to_delete)
   while (iter != to_delete.rend()) 
   {
     typename TetVolMesh::Node::index_type n = *iter++;
-    std::vector<Core::Geometry::Point>::iterator pit = points_.begin() + n;
-    points_.erase(pit);
+    points_.erase(n);
   }
   synchronized_ &= ~Mesh::LOCATE_E;
   synchronized_ &= ~Mesh::NODE_NEIGHBORS_E;
@@ -4300,7 +4243,8 @@ TetVolMesh<Basis>::insert_node_in_elem(typename Elem::array_type &tets,
     
     typename edge_nt::iterator iter = edge_table_.find(etmp);
     PEdgeNode e = iter->first;
-    const std::vector<index_type>& cells = edges_[iter->second].cells_;
+    const std::vector<index_type> cells(edges_[iter->second].begin(),
+                                        edges_[iter->second].end());
 
     pi = add_point(p);
     tets.clear();
@@ -4368,8 +4312,8 @@ TetVolMesh<Basis>::orient(typename Cell::index_type ci)
   if (sgn < 0.0)
   {
     typename Node::index_type tmp = cells_[ci*4+0];
-    cells_[ci*4+0] = cells_[ci*4+1];
-    cells_[ci*4+1] = tmp;
+    cells_.set(ci*4+0, cells_[ci*4+1]);
+    cells_.set(ci*4+1, tmp);
   }
 }
 
@@ -388,8 +388,7 @@ VMesh::index_type*
 VTriSurfMesh<MESH>::
 get_elems_pointer() const
 {
-  if (this->mesh_->faces_.size() == 0) return (0);
-   return (&(this->mesh_->faces_[0]));
+  return (storage_pointer(this->mesh_->faces_));
 }
 
 /// @todo: Fix this function so it does not need the vector conversion
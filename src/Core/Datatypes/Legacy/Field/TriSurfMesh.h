@@ -32,8 +32,10 @@
 /// Include what kind of support we want to have
 /// Need to fix this and couple it sci-defs
 #include <Core/Datatypes/Legacy/Field/MeshSupport.h>
+#include <Core/Datatypes/Legacy/Field/MeshStorage.h>
 
 #include <Core/Containers/StackVector.h>
+#include <Core/Containers/CompressedAdjacency.h>
 
 #include <Core/GeometryPrimitives/Transform.h>
 #include <Core/GeometryPrimitives/Point.h>
@@ -204,15 +206,15 @@ public:
     }
 
     inline
-    const Core::Geometry::Point &node0() const {
+    const Core::Geometry::Point node0() const {
       return mesh_.points_[node0_index()];
     }
     inline
-    const Core::Geometry::Point &node1() const {
+    const Core::Geometry::Point node1() const {
       return mesh_.points_[node1_index()];
     }
     inline
-    const Core::Geometry::Point &node2() const {
+    const Core::Geometry::Point node2() const {
       return mesh_.points_[node2_index()];
     }
 
@@ -349,6 +351,10 @@ public:
   virtual bool unsynchronize(mask_type mask);
   bool clear_synchronization();
 
+  /// Select float coordinates and/or 32 bit connectivity.
+  virtual bool set_storage_mode(mask_type mode);
+  virtual mask_type storage_mode() const;
+
   /// Get the basis class.
   Basis& get_basis() { return basis_; }
 
@@ -551,7 +557,7 @@ public:
   void get_point(Core::Geometry::Point &result, typename Node::index_type index) const
     { result = points_[index]; }
   void set_point(const Core::Geometry::Point &point, typename Node::index_type index)
-    { points_[index] = point; }
+    { points_.set(index, point); }
 
   void get_random_point(Core::Geometry::Point &, typename Elem::index_type, FieldRNG &rng) const;
 
@@ -1417,7 +1423,7 @@ public:
 
 
 
-  const Core::Geometry::Point &point(typename Node::index_type i) { return points_[i]; }
+  const Core::Geometry::Point point(typename Node::index_type i) { return points_[i]; }
 
   // This one should be made obsolete
   bool get_neighbor(index_type &nbr_half_edge,
@@ -1549,7 +1555,7 @@ protected:
               "Must call synchronize NODE_NEIGHBORS_E on TriSurfMesh first");
 
     // Get the table of faces that are connected to the two nodes
-    const std::vector<index_type>& faces  = node_neighbors_[idx];
+    typename NodeNeighborMap::Row faces  = node_neighbors_[idx];
     array.clear();
 
     typename ARRAY::value_type edge;
@@ -1589,7 +1595,7 @@ protected:
   inline void set_nodes_by_elem(ARRAY &array, INDEX idx)
   {
     for (index_type n = 0; n < 3; ++n)
-      faces_[idx * 3 + n] = static_cast<index_type>(array[n]);
+      faces_.set(idx * 3 + n, static_cast<index_type>(array[n]));
   }
 
 
@@ -1677,7 +1683,7 @@ protected:
     array.clear();
 
     // Get all the neighboring elements
-    const std::vector<index_type>& faces  = node_neighbors_[idx];
+    typename NodeNeighborMap::Row faces  = node_neighbors_[idx];
     // Make a conservative estimate of the number of node neighbors
     array.reserve(2*faces.size());
 
@@ -1991,13 +1997,14 @@ protected:
   static index_type prev(index_type i) { return ((i%3)==0) ? (i+2) : (i-1); }
 
   /// Actual parameters
-  std::vector<Core::Geometry::Point>         points_;              // Location of vertices
+  PointStorage               points_;              // Location of vertices
   std::vector<std::vector<index_type> >    edges_;               // edges->halfedge map
   std::vector<index_type>    halfedge_to_edge_;    // halfedge->edge map
-  std::vector<index_type>    faces_;               // Connectivity of this mesh
+  IndexStorage               faces_;               // Connectivity of this mesh
   std::vector<index_type>    edge_neighbors_;      // Neighbor connectivity
   std::vector<Core::Geometry::Vector>        normals_;             // normalized per node normal.
-  std::vector<std::vector<index_type> > node_neighbors_; // Node neighbor connectivity
+  typedef CompressedAdjacency<index_type> NodeNeighborMap;
+  NodeNeighborMap            node_neighbors_;      // Node neighbor connectivity
   std::vector<std::vector<index_type> > edge_on_node_; // Edges emanating from a node
 
   boost::shared_ptr<SearchGridT<index_type> > node_grid_; // Lookup table for nodes
@@ -2085,10 +2092,10 @@ TriSurfMesh<Basis>::type_name(int n)
 
 template <class Basis>
 TriSurfMesh<Basis>::TriSurfMesh()
-  : points_(0),
-    faces_(0),
+  : points_(),
+    faces_(),
     edge_neighbors_(0),
-    node_neighbors_(0),
+    node_neighbors_(),
     synchronize_lock_("TriSurfMesh lock"),
     synchronize_cond_("TriSurfMesh condition variable"),
     synchronized_(Mesh::NODES_E | Mesh::FACES_E | Mesh::CELLS_E),
@@ -2106,13 +2113,13 @@ TriSurfMesh<Basis>::TriSurfMesh()
 template <class Basis>
 TriSurfMesh<Basis>::TriSurfMesh(const TriSurfMesh &copy)
   : Mesh(copy),
-    points_(0),
+    points_(),
     edges_(0),
     halfedge_to_edge_(0),
-    faces_(0),
+    faces_(),
     edge_neighbors_(0),
     normals_(0),
-    node_neighbors_(0),
+    node_neighbors_(),
     synchronize_lock_("TriSurfMesh lock"),
     synchronize_cond_("TriSurfMesh condition variable"),
     synchronized_(Mesh::NODES_E | Mesh::FACES_E | Mesh::CELLS_E),
@@ -2212,12 +2219,9 @@ void
 TriSurfMesh<Basis>::transform(const Core::Geometry::Transform &t)
 {
   synchronize_lock_.lock();
-  std::vector<Core::Geometry::Point>::iterator itr = points_.begin();
-  std::vector<Core::Geometry::Point>::iterator eitr = points_.end();
-  while (itr != eitr)
+  for (size_t i = 0; i < points_.size(); i++)
   {
-    *itr = t.project(*itr);
-    ++itr;
+    points_.set(i, t.project(points_[i]));
   }
 
   if (bbox_.valid())
@@ -2532,6 +2536,34 @@ TriSurfMesh<Basis>::unsynchronize(mask_type /*sync*/)
   return (true);
 }
 
+template <class Basis>
+bool
+TriSurfMesh<Basis>::set_storage_mode(mask_type mode)
+{
+  synchronize_lock_.lock();
+  const bool use_float = (mode & Mesh::FLOAT_POINTS_E) != 0;
+  const bool ok = faces_.set_int32((mode & Mesh::INT32_INDICES_E) != 0);
+  if (ok && use_float != points_.is_float())
+  {
+    points_.set_float(use_float);
+    // Rounded coordinates need new normals and search structures
+    normals_.clear();
+    synchronized_ &= ~(Mesh::NORMALS_E|Mesh::LOCATE_E|Mesh::BOUNDING_BOX_E);
+  }
+  synchronize_lock_.unlock();
+  return (ok);
+}
+
+template <class Basis>
+mask_type
+TriSurfMesh<Basis>::storage_mode() const
+{
+  mask_type mode = Mesh::DEFAULT_STORAGE_E;
+  if (points_.is_float()) mode |= Mesh::FLOAT_POINTS_E;
+  if (faces_.is_int32()) mode |= Mesh::INT32_INDICES_E;
+  return (mode);
+}
+
 template <class Basis>
 bool
 TriSurfMesh<Basis>::clear_synchronization()
@@ -2639,7 +2671,7 @@ TriSurfMesh<Basis>::insert_node(typename Face::index_type face, const Core::Geom
   faces_.push_back(pi);
 
   // must do last
-  faces_[f0+2] = pi;
+  faces_.set(f0+2, pi);
 
   if (do_neighbors)
   {
@@ -2748,7 +2780,7 @@ TriSurfMesh<Basis>::insert_node_in_edge_aux(typename Face::array_type &tris,
 
   // f0
   tris.push_back(halfedge / 3);
-  faces_[next(halfedge)] = ni;
+  faces_.set(next(halfedge), ni);
   edge_neighbors_[halfedge] = (nbr!=MESH_NO_NEIGHBOR)?f3:MESH_NO_NEIGHBOR;
   edge_neighbors_[next(halfedge)] = prev(f1);
   edge_neighbors_[prev(halfedge)] = edge_neighbors_[prev(halfedge)];
@@ -2773,7 +2805,7 @@ TriSurfMesh<Basis>::insert_node_in_edge_aux(typename Face::array_type &tris,
 
     // f2
     tris.push_back(nbr / 3);
-    faces_[next(nbr)] = ni;
+    faces_.set(next(nbr), ni);
     edge_neighbors_[nbr] = f1;
     edge_neighbors_[next(nbr)] = f3+2;
   }
@@ -2841,7 +2873,7 @@ TriSurfMesh<Basis>::insert_node_in_face_aux(typename Face::array_type &tris,
 
   // Must do last
   tris.push_back(face);
-  faces_[f0+2] = ni;
+  faces_.set(f0+2, ni);
   edge_neighbors_[f0+1] = f1+2;
   edge_neighbors_[f0+2] = f2+1;
 
@@ -2940,7 +2972,7 @@ TriSurfMesh<Basis>::collapse_edges(const std::vector<index_type> &nodemap)
 {
   for (size_t i = 0; i < faces_.size(); i++)
   {
-    faces_[i] = nodemap[faces_[i]];
+    faces_.set(i, nodemap[faces_[i]]);
   }
 }
 
@@ -2949,7 +2981,8 @@ template <class Basis>
 void
 TriSurfMesh<Basis>::remove_obvious_degenerate_triangles()
 {
-  std::vector<index_type> oldfaces = faces_;
+  std::vector<index_type> oldfaces;
+  faces_.copy_to(oldfaces);
   faces_.clear();
   for (size_t i = 0; i< oldfaces.size(); i+=3)
   {
@@ -3023,9 +3056,9 @@ TriSurfMesh<Basis>::bisect_element(const typename Face::index_type face)
   faces_.push_back(nodes[5]);
   faces_.push_back(nodes[4]);
 
-  faces_[f0+0] = nodes[3];
-  faces_[f0+1] = nodes[4];
-  faces_[f0+2] = nodes[5];
+  faces_.set(f0+0, nodes[3]);
+  faces_.set(f0+1, nodes[4]);
+  faces_.set(f0+2, nodes[5]);
 
 
   if (do_neighbors)
@@ -3080,7 +3113,7 @@ TriSurfMesh<Basis>::bisect_element(const typename Face::index_type face)
     edge_neighbors_.push_back(pnbr);
     edge_neighbors_.push_back(edge_neighbors_[pnbr]);
     edge_neighbors_[edge_neighbors_.back()] = f4+2;
-    faces_[nbr] = nodes[3];
+    faces_.set(nbr, nodes[3]);
     edge_neighbors_[pnbr] = f4+1;
     if (do_normals)
     {
@@ -3104,7 +3137,7 @@ TriSurfMesh<Basis>::bisect_element(const typename Face::index_type face)
     edge_neighbors_.push_back(pnbr);
     edge_neighbors_.push_back(edge_neighbors_[pnbr]);
     edge_neighbors_[edge_neighbors_.back()] = f5+2;
-    faces_[nbr] = nodes[4];
+    faces_.set(nbr, nodes[4]);
     edge_neighbors_[pnbr] = f5+1;
     if (do_normals)
     {
@@ -3128,7 +3161,7 @@ TriSurfMesh<Basis>::bisect_element(const typename Face::index_type face)
     edge_neighbors_.push_back(pnbr);
     edge_neighbors_.push_back(edge_neighbors_[pnbr]);
     edge_neighbors_[edge_neighbors_.back()] = f6+2;
-    faces_[nbr] = nodes[5];
+    faces_.set(nbr, nodes[5]);
     edge_neighbors_[pnbr] = f6+1;
     if (do_normals)
     {
@@ -3151,13 +3184,8 @@ template <class Basis>
 void
 TriSurfMesh<Basis>::compute_node_neighbors()
 {
-  node_neighbors_.clear();
-  node_neighbors_.resize(points_.size());
-  size_type nfaces = static_cast<size_type>(faces_.size());
-  for (index_type f = 0; f < nfaces; ++f)
-  {
-    node_neighbors_[faces_[f]].push_back(f/3);
-  }
+  node_neighbors_.build_inverse(points_.size(), faces_,
+    [](size_t f) { return static_cast<index_type>(f/3); });
   synchronize_lock_.lock();
   synchronized_ |= Mesh::NODE_NEIGHBORS_E;
   synchronize_lock_.unlock();
@@ -3275,7 +3303,7 @@ TriSurfMesh<Basis>::add_find_point(const Core::Geometry::Point &p, double err)
   {
     synchronize_lock_.lock();
     points_.push_back(p);
-    node_neighbors_.push_back(std::vector<under_type>());
+    node_neighbors_.push_row();
     synchronize_lock_.unlock();
     return static_cast<typename Node::index_type>(points_.size() - 1);
   }
@@ -3319,13 +3347,13 @@ TriSurfMesh<Basis>::swap_shared_edge(typename Face::index_type f1,
   index_type s2 = *iter;
 
   synchronize_lock_.lock();
-  faces_[face1] = s1;
-  faces_[face1 + 1] = not_shar[0];
-  faces_[face1 + 2] = s2;
+  faces_.set(face1, s1);
+  faces_.set(face1 + 1, not_shar[0]);
+  faces_.set(face1 + 2, s2);
 
-  faces_[face2] = s2;
-  faces_[face2 + 1] = not_shar[1];
-  faces_[face2 + 2] = s1;
+  faces_.set(face2, s2);
+  faces_.set(face2 + 1, not_shar[1]);
+  faces_.set(face2 + 2, s1);
 
   synchronized_ &= ~Mesh::ELEM_NEIGHBORS_E;
   synchronized_ &= ~Mesh::NODE_NEIGHBORS_E;
@@ -3344,8 +3372,10 @@ TriSurfMesh<Basis>::remove_orphan_nodes()
   /// find the orphan nodes.
   std::vector<index_type> onodes;
   /// check each point against the face list.
+  std::vector<bool> used(points_.size(), false);
+  for (size_t i = 0; i < faces_.size(); i++) used[faces_[i]] = true;
   for (index_type i = 0; i < static_cast<index_type>(points_.size()); i++) {
-    if (find(faces_.begin(), faces_.end(), i) == faces_.end()) {
+    if (!used[i]) {
       /// node does not belong to a face
       onodes.push_back(i);
     }
@@ -3358,18 +3388,15 @@ TriSurfMesh<Basis>::remove_orphan_nodes()
   while (orph_iter != onodes.rend())
   {
     index_type i = *orph_iter++;
-    std::vector<index_type>::iterator iter = faces_.begin();
-    while (iter != faces_.end())
+    for (size_t k = 0; k < faces_.size(); k++)
     {
-      index_type &node = *iter++;
+      const index_type node = faces_[k];
       if (node > i)
       {
-        node--;
+        faces_.set(k, node - 1);
       }
     }
-    std::vector<Core::Geometry::Point>::iterator niter = points_.begin();
-    niter += i;
-    points_.erase(niter);
+    points_.erase(i);
   }
 
   synchronized_ &= ~Mesh::ELEM_NEIGHBORS_E;
@@ -3385,10 +3412,10 @@ TriSurfMesh<Basis>::remove_face(typename Face::index_type f)
   bool rval = true;
 
   synchronize_lock_.lock();
-  std::vector<under_type>::iterator fb = faces_.begin() + f*3;
-  std::vector<under_type>::iterator fe = fb + 3;
+  const size_t fb = static_cast<size_t>(f*3);
+  const size_t fe = fb + 3;
 
-  if (fe <= faces_.end())
+  if (fe <= faces_.size())
     faces_.erase(fb, fe);
   else {
     rval = false;
@@ -3447,8 +3474,8 @@ TriSurfMesh<Basis>::flip_face(typename Face::index_type face)
 {
   const index_type base = face * 3;
   index_type tmp = faces_[base + 1];
-  faces_[base + 1] = faces_[base + 2];
-  faces_[base + 2] = tmp;
+  faces_.set(base + 1, faces_[base + 2]);
+  faces_.set(base + 2, tmp);
 
   synchronized_ &= ~(Mesh::EDGES_E);
   synchronized_ &= ~Mesh::ELEM_NEIGHBORS_E;
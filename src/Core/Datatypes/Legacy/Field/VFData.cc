@@ -125,6 +125,18 @@ VFData::efdata_pointer() const
   ASSERTFAIL("VFData interface has no virtual function implementation for efdata_pointer");
 }
 
+bool
+VFData::share_fdata(void*, const boost::shared_ptr<void>&)
+{
+  return (false);
+}
+
+boost::shared_ptr<void>
+VFData::fdata_storage()
+{
+  return (boost::shared_ptr<void>());
+}
+
 void
 VFData::resize_fdata(VMesh::dimension_type )
 {
@@ -96,6 +96,15 @@ public:
   virtual void* fdata_pointer() const;
   virtual void* efdata_pointer() const;
 
+  /// Make the field data refer to memory owned by another object instead of
+  /// copying it. Only storage that supports this (Array3) accepts it, the
+  /// memory has to hold fdata_size() values of the field's data type.
+  virtual bool share_fdata(void* data, const boost::shared_ptr<void>& owner);
+
+  /// Storage of the field data for another object to use without copying,
+  /// or an empty pointer if the storage cannot be shared (anything but Array3).
+  virtual boost::shared_ptr<void> fdata_storage();
+
   VFDATA_ACCESS_DECLARATION(char)
   VFDATA_ACCESS_DECLARATION(unsigned char)
   VFDATA_ACCESS_DECLARATION(short)
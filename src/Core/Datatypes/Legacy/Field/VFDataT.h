@@ -218,6 +218,43 @@ private:
     if (dim.size() > 2) sz3 = dim[2]; 
     fdata.resize(sz3,sz2,sz1);  
   }
+
+  template<class T>
+  bool share(std::vector<T>&, void*, const boost::shared_ptr<void>&)
+  {
+    return (false);
+  }
+
+  template<class T>
+  bool share(Array2<T>&, void*, const boost::shared_ptr<void>&)
+  {
+    return (false);
+  }
+
+  template<class T>
+  bool share(Array3<T>& fdata, void* data, const boost::shared_ptr<void>& owner)
+  {
+    fdata.share(static_cast<T*>(data),fdata.dim1(),fdata.dim2(),fdata.dim3(),owner);
+    return (true);
+  }
+
+  template<class T>
+  boost::shared_ptr<void> storage(std::vector<T>&)
+  {
+    return (boost::shared_ptr<void>());
+  }
+
+  template<class T>
+  boost::shared_ptr<void> storage(Array2<T>&)
+  {
+    return (boost::shared_ptr<void>());
+  }
+
+  template<class T>
+  boost::shared_ptr<void> storage(Array3<T>& fdata)
+  {
+    return (fdata.shared_storage());
+  }
   
 public:
   // constructor
@@ -255,6 +292,16 @@ public:
       return (&(efdata_[0])); 
     }
 
+  virtual bool share_fdata(void* data, const boost::shared_ptr<void>& owner)
+    {
+      return (share(fdata_,data,owner));
+    }
+
+  virtual boost::shared_ptr<void> fdata_storage()
+    {
+      return (storage(fdata_));
+    }
+
   VFDATA_ACCESS_DECLARATION(char)
   VFDATA_ACCESS_DECLARATION(unsigned char)
   VFDATA_ACCESS_DECLARATION(short)
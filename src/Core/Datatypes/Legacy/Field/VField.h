@@ -605,6 +605,21 @@ public:
         
   inline void* fdata_pointer()   { return (vfdata_->fdata_pointer()); }      
   inline void* efdata_pointer()   { return (vfdata_->efdata_pointer()); }      
+
+  // Use the memory pointed to by data as the values of the field without
+  // copying it, owner is kept alive as long as the field uses the memory.
+  // The memory needs to hold num_values() values of the field's type.
+  // Returns false if the field's storage cannot share memory, in which case
+  // the values need to be copied with set_values().
+  inline bool share_values_pointer(void* data, const boost::shared_ptr<void>& owner)
+    { return (vfdata_->share_fdata(data,owner)); }
+
+  // Counterpart of share_values_pointer(): the storage behind
+  // get_values_pointer() for another object to keep alive while it uses the
+  // memory. Empty if the storage cannot be shared (only Array3 can).
+  // Sharing is not copy-on-write, neither side may be changed in place.
+  inline boost::shared_ptr<void> get_values_storage()
+    { return (vfdata_->fdata_storage()); }
         
   inline bool is_nodata()        { return (basis_order_ == -1); }
   inline bool is_constantdata()  { return (basis_order_ == 0); }
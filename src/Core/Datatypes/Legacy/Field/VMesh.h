@@ -783,16 +783,27 @@ public:
   {
     Core::Geometry::Point* ipoint = imesh->get_points_pointer();
     Core::Geometry::Point* opoint = get_points_pointer();
-    for (index_type j=0; j<size; j++,i++,o++ ) opoint[o] = ipoint[i];
+    if (ipoint && opoint)
+    {
+      for (index_type j=0; j<size; j++,i++,o++ ) opoint[o] = ipoint[i];
+    }
+    else
+    {
+      // Compact storage has no raw array
+      Core::Geometry::Point p;
+      for (index_type j=0; j<size; j++,i++,o++ )
+      {
+        imesh->get_center(p,i);
+        set_point(p,o);
+      }
+    }
   }
 
   inline void copy_nodes(VMesh* imesh)
   {
     size_type size = imesh->num_nodes();
     resize_nodes(size);
-    Core::Geometry::Point* ipoint = imesh->get_points_pointer();
-    Core::Geometry::Point* opoint = get_points_pointer();
-    for (index_type j=0; j<size; j++) opoint[j] = ipoint[j];
+    copy_nodes(imesh,Node::index_type(0),Node::index_type(0),size);
   }
   
   inline void copy_elems(VMesh* imesh, Elem::index_type i, 
@@ -801,18 +812,29 @@ public:
   {
     VMesh::index_type* ielem = imesh->get_elems_pointer();
     VMesh::index_type* oelem  = get_elems_pointer();
-    index_type ii = i*num_nodes_per_elem_;
-    index_type oo = o*num_nodes_per_elem_;
-    size_type  ss = size*num_nodes_per_elem_;
-    for (index_type j=0; j <ss; j++,ii++,oo++) oelem[oo] = ielem[ii]+offset;
+    if (ielem && oelem)
+    {
+      index_type ii = i*num_nodes_per_elem_;
+      index_type oo = o*num_nodes_per_elem_;
+      size_type  ss = size*num_nodes_per_elem_;
+      for (index_type j=0; j <ss; j++,ii++,oo++) oelem[oo] = ielem[ii]+offset;
+    }
+    else
+    {
+      // Compact storage has no raw array
+      Node::array_type nodes;
+      for (index_type j=0; j<size; j++,i++,o++)
+      {
+        imesh->get_nodes(nodes,i);
+        for (size_t k=0; k<nodes.size(); k++) nodes[k] += offset;
+        set_nodes(nodes,o);
+      }
+    }
   }
 
   inline void copy_elems(VMesh* imesh)
   {
-    VMesh::index_type* ielem = imesh->get_elems_pointer();
-    VMesh::index_type* oelem  = get_elems_pointer();
-    size_type  ss = num_elems()*num_nodes_per_elem_;
-    for (index_type j=0; j <ss; j++) oelem[j] = ielem[j];
+    copy_elems(imesh,Elem::index_type(0),Elem::index_type(0),num_elems(),0);
   }
   
   /// Preallocate memory for better performance
@@ -89,7 +89,6 @@ NrrdData::NrrdData() :
   nrrd_(nrrdNew()),
   write_nrrd_(true),
   embed_object_(false)
-  //data_owner_(0)
 {
   DEBUG_CONSTRUCTOR("NrrdData")
 }
@@ -99,13 +98,11 @@ NrrdData::NrrdData(Nrrd *n) :
   nrrd_(n),
   write_nrrd_(true),
   embed_object_(false)
-  //data_owner_(0)
 {
   DEBUG_CONSTRUCTOR("NrrdData")
 }
 
-/*
-NrrdData::NrrdData(LockingHandle<Datatype> data_owner) :
+NrrdData::NrrdData(const boost::shared_ptr<void>& data_owner) :
   nrrd_(nrrdNew()),
   write_nrrd_(true),
   embed_object_(false),
@@ -113,12 +110,10 @@ NrrdData::NrrdData(LockingHandle<Datatype> data_owner) :
 {
   DEBUG_CONSTRUCTOR("NrrdData")
 }
-*/
 
 NrrdData::NrrdData(const NrrdData &copy) :
   Datatype(copy),
   nrrd_(nrrdNew()),
-  //data_owner_(0),
   nrrd_fname_(copy.nrrd_fname_)
 {
   DEBUG_CONSTRUCTOR("NrrdData")
@@ -130,15 +125,15 @@ NrrdData::~NrrdData()
 {
   DEBUG_DESTRUCTOR("NrrdData")
 
-//  if(!data_owner_)
-//  {
+  if (!data_owner_)
+  {
     nrrdNuke(nrrd_);
-//  }
-//  else
-//  {
-//    nrrdNix(nrrd_);
-//    data_owner_ = 0;
-//  }
+  }
+  else
+  {
+    nrrdNix(nrrd_);
+    data_owner_.reset();
+  }
 }
 
 
@@ -201,15 +196,15 @@ void NrrdData::io(Piostream& stream)
       // memory.
       if (nrrd_)
       {   // make sure we free any existing Nrrd Data set
-        //if (!data_owner_.get_rep())
-        //{
+        if (!data_owner_)
+        {
           nrrdNuke(nrrd_);
-        //}
-        //else
-        //{
-        //  nrrdNix(nrrd_);
-        //  data_owner_ = 0;
-        //}
+        }
+        else
+        {
+          nrrdNix(nrrd_);
+          data_owner_.reset();
+        }
         // Make sure we put a zero pointer in the field. There is no nrrd
         nrrd_ = nrrdNew();
       }
@@ -257,15 +252,15 @@ void NrrdData::io(Piostream& stream)
 
       if (nrrd_)
       {   // make sure we free any existing Nrrd Data set
-        //if(!data_owner_.get_rep())
-        //{
+        if (!data_owner_)
+        {
           nrrdNuke(nrrd_);
-        //}
-        //else
-        //{
-        //  nrrdNix(nrrd_);
-        //  data_owner_ = 0;
-        //}
+        }
+        else
+        {
+          nrrdNix(nrrd_);
+          data_owner_.reset();
+        }
       }
 
       // Create a new nrrd structure
@@ -303,7 +298,6 @@ void NrrdData::io(Piostream& stream)
         free(err);
         biffDone(NRRD);
       }
-      //data_owner_ = 0;
 
       stream.begin_cheap_delim();
       // Read the contents of the axis
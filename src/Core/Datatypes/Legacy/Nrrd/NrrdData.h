@@ -53,6 +53,11 @@ class SCISHARE NrrdData : public Core::Datatypes::Datatype, public Core::Datatyp
 public:
   NrrdData();
   explicit NrrdData(Nrrd* nrrd);
+  /// For nrrds that wrap memory owned by another object (e.g. the storage of
+  /// field data): the owner is kept alive and the wrapped data is not freed
+  /// by the nrrd. The memory is shared, not copied on write, so the data of
+  /// such a nrrd must not be changed in place.
+  explicit NrrdData(const boost::shared_ptr<void>& data_owner);
   explicit NrrdData(const NrrdData&);
   virtual ~NrrdData();
 
@@ -85,6 +90,7 @@ private:
   Nrrd *nrrd_;
   bool    write_nrrd_;
   bool    embed_object_;
+  boost::shared_ptr<void> data_owner_;
 
   bool in_name_set(const std::string &s) const;
 
@@ -0,0 +1,188 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Core/Datatypes/SparseRowMatrixAccumulator.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
+#include <Core/Thread/Parallel.h>
+#include <Core/Utils/Exception.h>
+#include <algorithm>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Thread;
+
+SparseRowMatrixAccumulator::SparseRowMatrixAccumulator(size_type rows, size_type cols, int numThreads) :
+  rows_(rows), cols_(cols), buffers_(std::max(numThreads, 1))
+{
+}
+
+SparseRowMatrixHandle SparseRowMatrixAccumulator::make() const
+{
+  return assemble(nullptr);
+}
+
+SparseRowMatrixHandle SparseRowMatrixAccumulator::addTo(const SparseRowMatrix& sparse) const
+{
+  if (rows_ < static_cast<size_type>(sparse.nrows()) || cols_ < static_cast<size_type>(sparse.ncols()))
+    THROW_INVALID_ARGUMENT("new matrix needs to be at least the size of old matrix");
+  return assemble(&sparse);
+}
+
+SparseRowMatrixHandle SparseRowMatrixAccumulator::assemble(const SparseRowMatrix* sparse) const
+{
+  const int nproc = numThreads();
+  const index_type block = rows_/nproc;
+  auto blockStart = [&](int proc) { return block*proc; };
+  auto blockEnd = [&](int proc) { return (proc < nproc-1) ? block*(proc+1) : rows_; };
+  auto blockOf = [&](index_type row) { return block > 0 ? static_cast<int>(std::min<index_type>(row/block, nproc-1)) : nproc-1; };
+
+  // Sort the triplets of every buffer by row block, keeping their order
+  std::vector<std::vector<Entry> > sorted(nproc);
+  std::vector<std::vector<size_t> > offsets(nproc, std::vector<size_t>(nproc+1, 0));
+  std::vector<char> outOfRange(nproc, 0);
+
+  Parallel::RunTasks([&](int proc)
+  {
+    const std::vector<Entry>& buffer = buffers_[proc];
+    std::vector<size_t>& offset = offsets[proc];
+    for (size_t j = 0; j < buffer.size(); j++)
+    {
+      const Entry& e = buffer[j];
+      if (e.row < 0 || e.row >= rows_ || e.col < 0 || e.col >= cols_)
+      {
+        outOfRange[proc] = 1;
+        return;
+      }
+      offset[blockOf(e.row)+1]++;
+    }
+    for (int p = 0; p < nproc; p++) offset[p+1] += offset[p];
+
+    std::vector<size_t> pos(offset.begin(), offset.end()-1);
+    sorted[proc].resize(buffer.size(), Entry(0, 0, 0.0));
+    for (size_t j = 0; j < buffer.size(); j++)
+      sorted[proc][pos[blockOf(buffer[j].row)]++] = buffer[j];
+  }, nproc);
+
+  if (std::find(outOfRange.begin(), outOfRange.end(), 1) != outOfRange.end())
+    THROW_INVALID_ARGUMENT("Sparse matrix entry is outside of the matrix");
+
+  // Gather the triplets of each row block, sort them by row and column and
+  // sum duplicates, then count the entries of each row after merging with
+  // the existing matrix
+  std::vector<std::vector<Entry> > reduced(nproc);
+  std::vector<index_type> rowCount(rows_, 0);
+  std::vector<index_type> blockCount(nproc, 0);
+  const index_type sparseRows = sparse ? static_cast<index_type>(sparse->nrows()) : 0;
+
+  auto mergeRow = [&](index_type row, const Entry*& next, const Entry* end, index_type* cols, double* values) -> index_type
+  {
+    index_type k = 0;
+    if (row < sparseRows)
+    {
+      for (SparseRowMatrix::InnerIterator it(*sparse, row); it; ++it)
+      {
+        while (next != end && next->row == row && next->col < it.col())
+        {
+          if (cols) { cols[k] = next->col; values[k] = next->value; }
+          k++; next++;
+        }
+        double value = it.value();
+        if (next != end && next->row == row && next->col == it.col())
+        {
+          value += next->value;
+          next++;
+        }
+        if (cols) { cols[k] = it.col(); values[k] = value; }
+        k++;
+      }
+    }
+    while (next != end && next->row == row)
+    {
+      if (cols) { cols[k] = next->col; values[k] = next->value; }
+      k++; next++;
+    }
+    return k;
+  };
+
+  Parallel::RunTasks([&](int proc)
+  {
+    std::vector<Entry>& entries = reduced[proc];
+    size_t size = 0;
+    for (int t = 0; t < nproc; t++) size += offsets[t][proc+1] - offsets[t][proc];
+    entries.reserve(size);
+    for (int t = 0; t < nproc; t++)
+      entries.insert(entries.end(), sorted[t].begin() + offsets[t][proc], sorted[t].begin() + offsets[t][proc+1]);
+
+    std::stable_sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b)
+      { return a.row < b.row || (a.row == b.row && a.col < b.col); });
+
+    size_t k = 0;
+    for (size_t j = 0; j < entries.size(); j++)
+    {
+      if (k > 0 && entries[k-1].row == entries[j].row && entries[k-1].col == entries[j].col)
+        entries[k-1].value += entries[j].value;
+      else
+        entries[k++] = entries[j];
+    }
+    entries.resize(k, Entry(0, 0, 0.0));
+
+    const Entry* next = entries.empty() ? nullptr : &entries[0];
+    const Entry* end = next + entries.size();
+    for (index_type row = blockStart(proc); row < blockEnd(proc); row++)
+    {
+      rowCount[row] = mergeRow(row, next, end, nullptr, nullptr);
+      blockCount[proc] += rowCount[row];
+    }
+  }, nproc);
+
+  std::vector<index_type> blockOffset(nproc+1, 0);
+  for (int p = 0; p < nproc; p++) blockOffset[p+1] = blockOffset[p] + blockCount[p];
+
+  SparseRowMatrixHandle mat(boost::make_shared<SparseRowMatrix>(rows_, cols_));
+  mat->resizeNonZeros(blockOffset[nproc]);
+  index_type* rows = mat->outerIndexPtr();
+  index_type* cols = mat->innerIndexPtr();
+  double* values = mat->valuePtr();
+  rows[0] = 0;
+
+  // Each block writes its rows straight into the arrays of the matrix
+  Parallel::RunTasks([&](int proc)
+  {
+    const std::vector<Entry>& entries = reduced[proc];
+    const Entry* next = entries.empty() ? nullptr : &entries[0];
+    const Entry* end = next + entries.size();
+    index_type k = blockOffset[proc];
+    for (index_type row = blockStart(proc); row < blockEnd(proc); row++)
+    {
+      k += mergeRow(row, next, end, cols + k, values + k);
+      rows[row+1] = k;
+    }
+  }, nproc);
+
+  return mat;
+}
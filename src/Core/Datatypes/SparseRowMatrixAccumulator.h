@@ -0,0 +1,90 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef CORE_DATATYPES_SPARSEROWMATRIXACCUMULATOR_H
+#define CORE_DATATYPES_SPARSEROWMATRIXACCUMULATOR_H
+
+#include <vector>
+#include <Core/Datatypes/MatrixFwd.h>
+#include <Core/Datatypes/Legacy/Base/Types.h>
+#include <Core/Datatypes/share.h>
+
+namespace SCIRun
+{
+  namespace Core
+  {
+    namespace Datatypes
+    {
+      /// Collects sparse matrix entries from several threads without locking.
+      /// Every thread appends (row, column, value) triplets to its own buffer.
+      /// Building the matrix sorts the triplets per block of rows in parallel,
+      /// sums entries with the same row and column and writes the compressed
+      /// rows directly, optionally merged with an existing sparse matrix.
+      class SCISHARE SparseRowMatrixAccumulator
+      {
+      public:
+        SparseRowMatrixAccumulator(size_type rows, size_type cols, int numThreads);
+
+        size_type nrows() const { return rows_; }
+        size_type ncols() const { return cols_; }
+        int numThreads() const { return static_cast<int>(buffers_.size()); }
+
+        void reserve(int thread, size_t size) { buffers_[thread].reserve(size); }
+
+        /// Only the thread owning the buffer may add to it.
+        void add(int thread, index_type row, index_type col, double value)
+        {
+          buffers_[thread].push_back(Entry(row, col, value));
+        }
+
+        /// Matrix with the sum of the added entries.
+        SparseRowMatrixHandle make() const;
+
+        /// Matrix with the sum of sparse and the added entries; sparse may
+        /// have fewer rows and columns than the accumulated matrix.
+        SparseRowMatrixHandle addTo(const SparseRowMatrix& sparse) const;
+
+      private:
+        struct Entry
+        {
+          Entry(index_type r, index_type c, double v) : row(r), col(c), value(v) {}
+          index_type row, col;
+          double value;
+        };
+
+        SparseRowMatrixHandle assemble(const SparseRowMatrix* sparse) const;
+
+        size_type rows_, cols_;
+        std::vector<std::vector<Entry> > buffers_;
+      };
+    }
+  }
+}
+
+#endif
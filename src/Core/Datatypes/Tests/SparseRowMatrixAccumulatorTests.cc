@@ -0,0 +1,229 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+
+#include <Core/Datatypes/MatrixFwd.h>
+#include <Core/Datatypes/DenseMatrix.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
+#include <Testing/Utils/MatrixTestUtilities.h>
+#include <Core/Datatypes/SparseRowMatrixAccumulator.h>
+#include <Core/Utils/Exception.h>
+#include <cmath>
+#include <map>
+#include <random>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::TestUtils;
+
+namespace
+{
+  typedef std::map<std::pair<index_type, index_type>, double> EntryMap;
+
+  // Columns must be strictly increasing within every row, so duplicates
+  // are stored once.
+  ::testing::AssertionResult sameEntries(const EntryMap& expected, const SparseRowMatrix& actual)
+  {
+    if (static_cast<size_t>(actual.nonZeros()) != expected.size())
+      return ::testing::AssertionFailure() << actual.nonZeros() << " stored entries, expected " << expected.size();
+    for (index_type r = 0; r < actual.outerSize(); ++r)
+    {
+      index_type last = -1;
+      for (SparseRowMatrix::InnerIterator it(actual, r); it; ++it)
+      {
+        if (it.col() <= last)
+          return ::testing::AssertionFailure() << "columns of row " << r << " are not increasing";
+        last = it.col();
+        auto e = expected.find(std::make_pair(r, static_cast<index_type>(it.col())));
+        if (e == expected.end())
+          return ::testing::AssertionFailure() << "unexpected entry (" << r << "," << it.col() << ")";
+        if (std::abs(e->second - it.value()) > 1e-12)
+          return ::testing::AssertionFailure() << "entry (" << r << "," << it.col() << ") is " << it.value() << ", expected " << e->second;
+      }
+    }
+    return ::testing::AssertionSuccess();
+  }
+}
+
+TEST(SparseRowMatrixAccumulatorTest, DuplicateEntriesAreSummed)
+{
+  SparseRowMatrixAccumulator acc(3, 3, 2);
+
+  acc.add(0, 2, 1, 1);
+  acc.add(1, 0, 0, 1);
+  acc.add(1, 2, 1, 1);
+  acc.add(0, 0, 2, 3);
+
+  SparseRowMatrixHandle sparse = acc.make();
+
+  EXPECT_EQ(3, sparse->nrows());
+  EXPECT_EQ(3, sparse->ncols());
+
+  DenseMatrix expected = MAKE_DENSE_MATRIX(
+    (1,0,3)
+    (0,0,0)
+    (0,2,0));
+
+  DenseMatrixHandle actual = makeDense(*sparse);
+  EXPECT_MATRIX_EQ(*actual, expected);
+}
+
+TEST(SparseRowMatrixAccumulatorTest, AddToSmallerMatrix)
+{
+  SparseRowMatrix stiff(2, 2);
+  stiff.insert(0, 0) = 4;
+  stiff.insert(1, 1) = 5;
+  stiff.makeCompressed();
+
+  SparseRowMatrixAccumulator acc(3, 3, 3);
+  acc.add(0, 0, 0, 1);
+  acc.add(1, 2, 0, -1);
+  acc.add(2, 0, 2, -1);
+  acc.add(2, 2, 2, 2);
+
+  SparseRowMatrixHandle sparse = acc.addTo(stiff);
+
+  DenseMatrix expected = MAKE_DENSE_MATRIX(
+    (5,0,-1)
+    (0,5,0)
+    (-1,0,2));
+
+  DenseMatrixHandle actual = makeDense(*sparse);
+  EXPECT_MATRIX_EQ(*actual, expected);
+}
+
+TEST(SparseRowMatrixAccumulatorTest, EmptyAccumulatorGivesZeroMatrix)
+{
+  SparseRowMatrixAccumulator acc(4, 3, 2);
+  SparseRowMatrixHandle sparse = acc.make();
+
+  EXPECT_EQ(4, sparse->nrows());
+  EXPECT_EQ(3, sparse->ncols());
+  EXPECT_EQ(0, sparse->nonZeros());
+}
+
+TEST(SparseRowMatrixAccumulatorTest, ThrowsForEntryOutsideMatrix)
+{
+  SparseRowMatrixAccumulator acc(2, 2, 1);
+  acc.add(0, 2, 0, 1);
+
+  EXPECT_THROW(acc.make(), SCIRun::Core::InvalidArgumentException);
+}
+
+// More threads than rows leaves some row blocks empty.
+TEST(SparseRowMatrixAccumulatorTest, RandomDuplicatesAreSummedOnce)
+{
+  for (int numThreads : { 1, 3, 7 })
+  {
+    for (size_type rows : { 2, 23 })
+    {
+      const size_type cols = 17;
+      SparseRowMatrixAccumulator acc(rows, cols, numThreads);
+      EntryMap expected;
+      std::mt19937 rng(12345);
+      for (int t = 0; t < numThreads; ++t)
+      {
+        for (int j = 0; j < 400; ++j)
+        {
+          const index_type row = rng() % rows;
+          const index_type col = rng() % 5;
+          const double value = static_cast<double>(rng() % 100) / 8.0;
+          acc.add(t, row, col, value);
+          expected[std::make_pair(row, col)] += value;
+        }
+      }
+
+      SparseRowMatrixHandle sparse = acc.make();
+      EXPECT_EQ(rows, sparse->nrows());
+      EXPECT_EQ(cols, sparse->ncols());
+      EXPECT_TRUE(sameEntries(expected, *sparse)) << numThreads << " threads, " << rows << " rows";
+    }
+  }
+}
+
+TEST(SparseRowMatrixAccumulatorTest, ThrowsForEveryKindOfOutOfRangeEntry)
+{
+  const index_type entries[][2] = { { -1, 0 }, { 0, -1 }, { 3, 0 }, { 0, 4 }, { 3, 4 } };
+  for (const auto& entry : entries)
+  {
+    SparseRowMatrixAccumulator acc(3, 4, 2);
+    acc.add(0, 1, 1, 1);
+    acc.add(1, entry[0], entry[1], 1);
+    EXPECT_THROW(acc.make(), SCIRun::Core::InvalidArgumentException) << entry[0] << "," << entry[1];
+
+    SparseRowMatrix stiff(2, 2);
+    stiff.insert(0, 0) = 1;
+    stiff.makeCompressed();
+    EXPECT_THROW(acc.addTo(stiff), SCIRun::Core::InvalidArgumentException) << entry[0] << "," << entry[1];
+  }
+}
+
+TEST(SparseRowMatrixAccumulatorTest, AddToMergesRowsAndColumnsOfSmallerMatrix)
+{
+  // Entries before, on and after the existing ones in a row, and rows and
+  // columns the existing matrix does not have
+  SparseRowMatrix stiff(3, 2);
+  stiff.insert(0, 1) = 2;
+  stiff.insert(1, 0) = 3;
+  stiff.insert(1, 1) = 4;
+  stiff.insert(2, 1) = 5;
+  stiff.makeCompressed();
+
+  SparseRowMatrixAccumulator acc(5, 4, 2);
+  acc.add(0, 0, 0, 1);
+  acc.add(1, 0, 1, 0.5);
+  acc.add(0, 0, 3, 1);
+  acc.add(1, 1, 1, -4);
+  acc.add(0, 2, 1, 1);
+  acc.add(1, 2, 1, 1);
+  acc.add(0, 4, 2, 6);
+  acc.add(1, 4, 2, 1);
+
+  SparseRowMatrixHandle sparse = acc.addTo(stiff);
+  EXPECT_EQ(5, sparse->nrows());
+  EXPECT_EQ(4, sparse->ncols());
+
+  EntryMap expected;
+  expected[std::make_pair(0, 0)] = 1;
+  expected[std::make_pair(0, 1)] = 2.5;
+  expected[std::make_pair(0, 3)] = 1;
+  expected[std::make_pair(1, 0)] = 3;
+  expected[std::make_pair(1, 1)] = 0;
+  expected[std::make_pair(2, 1)] = 7;
+  expected[std::make_pair(4, 2)] = 7;
+  EXPECT_TRUE(sameEntries(expected, *sparse));
+}
+
+TEST(SparseRowMatrixAccumulatorTest, AddToThrowsForLargerMatrix)
+{
+  SparseRowMatrix stiff(3, 3);
+  stiff.makeCompressed();
+  SparseRowMatrixAccumulator acc(3, 2, 1);
+  EXPECT_THROW(acc.addTo(stiff), SCIRun::Core::InvalidArgumentException);
+}
@@ -257,6 +257,19 @@ bool	IComINetSocket::bind(IComAddress& address, IComSocketError &err)
 	if (!success) return(false);
 
 	address.selectaddress(addressnum);
+
+	// When binding to port 0 the system picks a free port, ask the socket which
+	// one it got so the caller can find out where to connect to
+	if (address.getport() == 0)
+	{
+		sockaddr_storage sa;
+		socklen_t salen = sizeof(sa);
+		if (::getsockname(socketfd_,reinterpret_cast<sockaddr *>(&sa),&salen) == 0)
+		{
+			address.setaddress(address.getprotocol(),reinterpret_cast<sockaddr *>(&sa));
+		}
+	}
+
 	localaddress_ = address;
 	isconnected_ = false;
 
@@ -767,7 +780,7 @@ bool	IComINetSocket::poll(IComPacketHandle &packet, IComSocketError &err)
 	{
 
 	}
-	if (len)
+	if (len > 0)
 	{
 		return(recv(packet,err));
 	}
@@ -777,6 +790,14 @@ bool	IComINetSocket::poll(IComPacketHandle &packet, IComSocketError &err)
 	// No package is waiting so the polling was not success, though there is no error
 }
 
+// Writing to a connection the other end closed should return EPIPE instead
+// of raising SIGPIPE, which would terminate the process
+#ifdef MSG_NOSIGNAL
+#define SEND_FLAGS MSG_NOSIGNAL
+#else
+#define SEND_FLAGS 0
+#endif
+
 bool IComINetSocket::send(IComPacketHandle &packet, IComSocketError &err)
 {
 	int header[8];
@@ -804,7 +825,7 @@ bool IComINetSocket::send(IComPacketHandle &packet, IComSocketError &err)
 	buf = reinterpret_cast<char *>(&header[0]);
 	while (bytessend < bytestosend)
 	{
-		len = ::send(socketfd_,&(buf[bytessend]),bytestosend-bytessend,0);
+		len = ::send(socketfd_,&(buf[bytessend]),bytestosend-bytessend,SEND_FLAGS);
 		if (len < 0)
 		{
 			if ((errno == EINTR)||(errno == EAGAIN)) continue;
@@ -835,7 +856,7 @@ bool IComINetSocket::send(IComPacketHandle &packet, IComSocketError &err)
 	buf = static_cast<char *>(packet->getbuffer());
 	while (bytessend < bytestosend)
 	{
-		len = ::send(socketfd_,&(buf[bytessend]),bytestosend-bytessend,0);
+		len = ::send(socketfd_,&(buf[bytessend]),bytestosend-bytessend,SEND_FLAGS);
 		if (len < 0)
 		{
 			if ((errno == EINTR)||(errno == EAGAIN)) continue;
@@ -894,6 +915,11 @@ bool	IComINetSocket::recv(IComPacketHandle &packet, IComSocketError &err)
 			if ((errno == EINTR)||(errno == EAGAIN)) continue;
 			break;
 		}
+		if (len == 0)
+		{	// The other end closed the connection
+			isconnected_ = false;
+			break;
+		}
 		bytesread += len;
 	}
 
@@ -929,6 +955,11 @@ bool	IComINetSocket::recv(IComPacketHandle &packet, IComSocketError &err)
 			if ((errno == EINTR)||(errno == EAGAIN)) continue;
 			break;
 		}
+		if (len == 0)
+		{	// The other end closed the connection
+			isconnected_ = false;
+			break;
+		}
 		bytesread += len;
 	}
 
@@ -945,7 +976,8 @@ bool	IComINetSocket::recv(IComPacketHandle &packet, IComSocketError &err)
 		err.error = std::string("Could not read enough bytes from stream");
 		return(false);
 	}
-	long* header = reinterpret_cast<long *>(buffer);
+	// The header is sent as 32 bit integers, long is 64 bits on most platforms
+	int* header = reinterpret_cast<int *>(buffer);
 
 
 	if (header[0] > 255)
@@ -985,6 +1017,11 @@ bool	IComINetSocket::recv(IComPacketHandle &packet, IComSocketError &err)
                 if ((errno == EINTR)||(errno == EAGAIN)) continue;
                 break;
             }
+            if (len == 0)
+            {
+                isconnected_ = false;
+                break;
+            }
             bytesread += len;
         }
 
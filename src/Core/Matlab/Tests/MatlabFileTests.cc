@@ -0,0 +1,187 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <gtest/gtest.h>
+#include <Core/Matlab/matlabfile.h>
+#include <Core/Matlab/matlabarray.h>
+#include <boost/filesystem.hpp>
+#include <zlib.h>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+using namespace SCIRun::MatlabIO;
+
+namespace
+{
+  class TempFile
+  {
+  public:
+    TempFile() : path_(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("matfile_%%%%-%%%%.mat")) {}
+    ~TempFile() { boost::system::error_code ec; boost::filesystem::remove(path_, ec); }
+    std::string name() const { return path_.string(); }
+  private:
+    boost::filesystem::path path_;
+  };
+
+  std::vector<char> readBytes(const std::string& name)
+  {
+    std::ifstream in(name.c_str(), std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+
+  // Rewrite a v5 file the way MATLAB saves with -v7: every top level
+  // miMATRIX element is deflated into an unpadded miCOMPRESSED element.
+  void compressFile(const std::string& from, const std::string& to)
+  {
+    std::vector<char> in = readBytes(from);
+    std::vector<char> out(in.begin(), in.begin() + 128);
+    size_t pos = 128;
+    while (pos + 8 <= in.size())
+    {
+      int32_t tag[2];
+      std::memcpy(tag, &in[pos], 8);
+      const size_t len = 8 + tag[1];
+
+      uLongf clen = compressBound(static_cast<uLong>(len));
+      std::vector<char> packed(clen);
+      ASSERT_EQ(Z_OK, compress(reinterpret_cast<Bytef*>(&packed[0]), &clen, reinterpret_cast<const Bytef*>(&in[pos]), static_cast<uLong>(len)));
+
+      int32_t ctag[2] = { static_cast<int32_t>(matlabarray::miCOMPRESSED), static_cast<int32_t>(clen) };
+      out.insert(out.end(), reinterpret_cast<char*>(ctag), reinterpret_cast<char*>(ctag) + 8);
+      out.insert(out.end(), packed.begin(), packed.begin() + clen);
+      pos += ((len + 7) / 8) * 8;
+    }
+    std::ofstream o(to.c_str(), std::ios::binary);
+    o.write(&out[0], out.size());
+  }
+
+  std::vector<double> denseValues(int m, int n)
+  {
+    std::vector<double> values(m*n);
+    for (size_t i = 0; i < values.size(); ++i) values[i] = (i % 13) * 0.25 - 1.0 + i;
+    return values;
+  }
+
+  void writeTestFile(const std::string& name)
+  {
+    matlabfile mf(name, "w");
+
+    matlabarray dense;
+    std::vector<double> values = denseValues(300, 70);
+    dense.createdoublematrix(300, 70, &values[0]);
+    mf.putmatlabarray(dense, "dense");
+
+    matlabarray ints;
+    std::vector<int> ivalues(1000);
+    for (size_t i = 0; i < ivalues.size(); ++i) ivalues[i] = static_cast<int>(i*i % 1001) - 500;
+    ints.createintvector(ivalues);
+    mf.putmatlabarray(ints, "ints");
+
+    // 4x3 sparse matrix with one entry per column
+    matlabarray sparse;
+    sparse.createsparsearray(4, 3, matlabarray::miDOUBLE);
+    double svalues[3] = { 1.5, -2.0, 4.0 };
+    int rows[3] = { 3, 0, 2 };
+    int cols[4] = { 0, 1, 2, 3 };
+    sparse.setnumericarray(svalues, 3);
+    sparse.setrowsarray(rows, 3);
+    sparse.setcolsarray(cols, 4);
+    mf.putmatlabarray(sparse, "sparse");
+
+    mf.close();
+  }
+}
+
+TEST(MatlabFileTests, CompressedFileReadsLikeUncompressed)
+{
+  TempFile plain, packed;
+  writeTestFile(plain.name());
+  compressFile(plain.name(), packed.name());
+  ASSERT_LT(readBytes(packed.name()).size(), readBytes(plain.name()).size());
+
+  matlabfile ref(plain.name(), "r");
+  matlabfile mf(packed.name(), "r");
+  ASSERT_EQ(3, mf.getnummatlabarrays());
+  ASSERT_EQ(ref.getnummatlabarrays(), mf.getnummatlabarrays());
+
+  for (int p = 0; p < mf.getnummatlabarrays(); ++p)
+  {
+    matlabarray a = ref.getmatlabarray(p);
+    matlabarray b = mf.getmatlabarray(p);
+    EXPECT_EQ(a.getname(), b.getname());
+    EXPECT_EQ(a.getm(), b.getm());
+    EXPECT_EQ(a.getn(), b.getn());
+    EXPECT_EQ(a.gettype(), b.gettype());
+    EXPECT_EQ(a.issparse(), b.issparse());
+
+    std::vector<double> va, vb;
+    a.getnumericarray(va);
+    b.getnumericarray(vb);
+    EXPECT_EQ(va, vb);
+  }
+
+  matlabarray dense = mf.getmatlabarray("dense");
+  std::vector<double> values;
+  dense.getnumericarray(values);
+  EXPECT_EQ(denseValues(300, 70), values);
+
+  matlabarray sparse = mf.getmatlabarray("sparse");
+  ASSERT_TRUE(sparse.issparse());
+  ASSERT_EQ(3, sparse.getnnz());
+  int rows[3], cols[4];
+  sparse.getrowsarray(rows, 3);
+  sparse.getcolsarray(cols, 4);
+  EXPECT_EQ(3, rows[0]);
+  EXPECT_EQ(0, rows[1]);
+  EXPECT_EQ(2, rows[2]);
+  EXPECT_EQ(3, cols[3]);
+}
+
+TEST(MatlabFileTests, CompressedVariablesCanBeReadOutOfOrder)
+{
+  TempFile plain, packed;
+  writeTestFile(plain.name());
+  compressFile(plain.name(), packed.name());
+
+  matlabfile mf(packed.name(), "r");
+  // Read the last variable first and a header only afterwards, each
+  // request inflates a different block
+  matlabarray sparse = mf.getmatlabarray("sparse");
+  EXPECT_EQ(4, sparse.getm());
+  matlabarray info = mf.getmatlabarrayinfo("dense");
+  EXPECT_EQ(300, info.getm());
+  EXPECT_EQ(70, info.getn());
+  matlabarray ints = mf.getmatlabarray("ints");
+  std::vector<int> ivalues;
+  ints.getnumericarray(ivalues);
+  ASSERT_EQ(1000u, ivalues.size());
+  EXPECT_EQ(-500, ivalues[0]);
+  EXPECT_EQ(static_cast<int>(999*999 % 1001) - 500, ivalues[999]);
+}
@@ -54,6 +54,7 @@
  */
 
 #include <Core/Matlab/matfile.h>
+#include <algorithm>
 #include <cstring>
 #include <zlib.h>
 
@@ -112,14 +113,13 @@ void matfile::mfwrite(void *buffer,int elsize,int size)
     if (ferror(fptr)) throw io_error();
 }
 
-void matfile::mfwrite(void *buffer,int elsize,int size,int offset)
+void matfile::mfwrite(void *buffer,int elsize,int size,int64_t offset)
 {
     FILE *fptr;
   	fptr = m_->fptr_;
 
 	  if (fptr == 0) return;
-    if (fseek(fptr,offset,SEEK_SET) != 0) throw io_error();
-    if (ferror(fptr)) throw io_error();
+    mfseek(offset);
     if (static_cast<int>(fwrite(buffer,elsize,size,fptr)) != size) throw io_error();
     if (ferror(fptr)) throw io_error();
 }
@@ -145,7 +145,7 @@ void matfile::mfread(void *buffer,int elsize,int size)
 	}
 }
 
-void matfile::mfread(void *buffer,int elsize,int size,int offset)
+void matfile::mfread(void *buffer,int elsize,int size,int64_t offset)
 {
 	if (m_->fcmpbuffer_ == 0)
 	{
@@ -153,8 +153,7 @@ void matfile::mfread(void *buffer,int elsize,int size,int offset)
 		fptr = m_->fptr_;
 
 		if (fptr == 0) return;
-		if (fseek(fptr,offset,SEEK_SET) != 0) throw io_error();
-		if (ferror(fptr)) throw io_error();
+		mfseek(offset);
 		if (static_cast<int>(fread(buffer,elsize,size,fptr)) != size) throw io_error();
 		if (ferror(fptr)) throw io_error();
 		if (m_->byteswap_) mfswapbytes(buffer,elsize,size);
@@ -162,7 +161,8 @@ void matfile::mfread(void *buffer,int elsize,int size,int offset)
 	else
 	{   // Read from the decompressed buffer instead of the file
 
-		m_->fcmpcount_ = offset-(m_->fcmpalignoffset_);
+		if (offset < m_->fcmpalignoffset_) throw io_error();
+		m_->fcmpcount_ = static_cast<int>(offset-(m_->fcmpalignoffset_));
 		if ((m_->fcmpcount_) + (size*elsize) > m_->fcmpsize_)	throw io_error();
 		std::memcpy(buffer,static_cast<void *>((m_->fcmpbuffer_)+m_->fcmpcount_),(size*elsize));
 		m_->fcmpcount_ += (size*elsize);
@@ -170,6 +170,68 @@ void matfile::mfread(void *buffer,int elsize,int size,int offset)
 	}
 }
 
+void matfile::mfseek(int64_t offset)
+{
+#ifdef _WIN32
+    if (_fseeki64(m_->fptr_,offset,SEEK_SET) != 0) throw io_error();
+#else
+    if (fseeko(m_->fptr_,static_cast<off_t>(offset),SEEK_SET) != 0) throw io_error();
+#endif
+    if (ferror(m_->fptr_)) throw io_error();
+}
+
+int matfile::mfinflate(int64_t offset,int srcsize,char *dest,int destsize)
+{
+    if (m_->fptr_ == 0) throw io_error();
+
+    z_stream strm;
+    std::memset(&strm,0,sizeof(z_stream));
+    if (inflateInit(&strm) != Z_OK) throw compression_error();
+
+    // Stage the compressed data in small pieces, so a block is never
+    // held in memory in both compressed and uncompressed form
+    // for the small header reads only a few kilobytes are staged
+    int stagingsize = std::min(std::min(srcsize,std::max(destsize,4096)),262144);
+    if (stagingsize < 1) stagingsize = 1;
+    char *staging = 0;
+
+    int remaining = srcsize;
+    strm.next_out = reinterpret_cast<Bytef *>(dest);
+    strm.avail_out = static_cast<uInt>(destsize);
+
+    try
+    {
+      staging = new char[stagingsize];
+      mfseek(offset);
+      while (strm.avail_out > 0)
+      {
+        if (strm.avail_in == 0)
+        {
+          if (remaining == 0) break;
+          int len = std::min(remaining,stagingsize);
+          if (static_cast<int>(fread(staging,1,len,m_->fptr_)) != len) throw io_error();
+          remaining -= len;
+          strm.next_in = reinterpret_cast<Bytef *>(staging);
+          strm.avail_in = static_cast<uInt>(len);
+        }
+
+        int ret = inflate(&strm,Z_NO_FLUSH);
+        if (ret == Z_STREAM_END) break;
+        if (ret != Z_OK) throw compression_error();
+      }
+    }
+    catch (...)
+    {
+      inflateEnd(&strm);
+      if (staging != 0) delete[] staging;
+      throw;
+    }
+
+    inflateEnd(&strm);
+    delete[] staging;
+
+    return(destsize-static_cast<int>(strm.avail_out));
+}
 
 // Separate functions for reading and writing the header
 
@@ -227,6 +289,8 @@ matfile::matfile(const std::string& filename,const std::string& mode)
 {
 	m_ = new mxfile;
 	m_->fptr_ = 0;
+	m_->fcmpbuffer_ = 0;
+	m_->fcmpsize_ = 0;
 	m_->byteswap_ = 0;
 	m_->ref_ = 1;
 	m_->compressmode_ = false;
@@ -312,8 +376,13 @@ void matfile::open(const std::string& filename,const std::string& mode)
             if (!(m_->fptr_ = fopen(m_->fname_.c_str(),"rb"))) throw could_not_open_file();
 
             // Determine file length, file needs to contain at least the 128 byte header
-            if (fseek(m_->fptr_,0,SEEK_END) != 0) throw io_error();
-            m_->flength_ = ftell(m_->fptr_);
+#ifdef _WIN32
+            if (_fseeki64(m_->fptr_,0,SEEK_END) != 0) throw io_error();
+            m_->flength_ = _ftelli64(m_->fptr_);
+#else
+            if (fseeko(m_->fptr_,0,SEEK_END) != 0) throw io_error();
+            m_->flength_ = static_cast<int64_t>(ftello(m_->fptr_));
+#endif
             if (m_->flength_ < 128) throw invalid_file_format();
 
             // Determine whether file is of a different type
@@ -422,10 +491,11 @@ void matfile::rewind()
 
   m_->compressmode_ = false;
 	m_->fcmpbuffer_ = 0;
+	m_->fcmpmbuffer_.clear();
 	m_->fcmpsize_ = 0;
 }
 
-int matfile::nexttag()
+int64_t matfile::nexttag()
 {
   bool compresstag = false;
 
@@ -495,6 +565,16 @@ bool matfile::openchild()
 // in the domain of the uncompressed memory block
 
 bool matfile::opencompression()
+{
+	return(mfopencompression(false));
+}
+
+bool matfile::opencompressionheader()
+{
+	return(mfopencompression(true));
+}
+
+bool matfile::mfopencompression(bool headeronly)
 {
 	// If the datablock cannot be found, there is nothing to do
 	// except to report an error
@@ -513,122 +593,84 @@ bool matfile::opencompression()
 	if (m_->fcmpbuffer_ != 0) throw compression_error();
 
 	// Get the size and position of the compressed data
-	int compressblockoffset = m_->curptr_.datptr;
+	int64_t compressblockoffset = m_->curptr_.datptr;
 	int compressblocksize = m_->curptr_.size;
 
 	// Make sure we are not in compressed mode
 	m_->fcmpbuffer_ = 0;
-
-	// Create a new buffer structure
-	compressbuffer cmpbuffer;
+	m_->fcmpmbuffer_.clear();
 
 	// First check whether the work we require has already been
 	// done. We should not overheat the processor without any good
 	// reason.
-	for (unsigned int p = 0;p<m_->cmplist_.size();p++)
+	for (size_t p = 0;p<m_->cmplist_.size();p++)
 	{
-		cmpbuffer = m_->cmplist_[p];
-		if (cmpbuffer.bufferoffset == compressblockoffset)
+		if (m_->cmplist_[p].bufferoffset == compressblockoffset)
 		{
 			// Yeah the job has already been done
 			// Enter the data of the block in the
 			// main file descriptor
-			m_->fcmpbuffer_ = static_cast<char *>(cmpbuffer.mbuffer.databuffer());
-			m_->fcmpsize_ = cmpbuffer.buffersize;
-			m_->fcmpoffset_ = cmpbuffer.bufferoffset;
-			m_->fcmpcount_ = 0;
+			m_->fcmpmbuffer_ = m_->cmplist_[p].mbuffer;
+			m_->fcmpsize_ = m_->cmplist_[p].buffersize;
 			break;
 		}
 	}
 
 	// We still need to uncompress the block
-	if (m_->fcmpbuffer_ == 0)
+	if (m_->fcmpmbuffer_.size() == 0)
 	{
-		// We need to decompress the buffer
-		char *sourcebuffer = 0;
+		// first only inflate the header to find out how big the data segment should be
+		// Only decompress the first 8 bytes. We need to know whether inside is a matrix
+		// and of what size this one is.
+		int32_t destbufferheader[2];
+		if (mfinflate(compressblockoffset,compressblocksize,
+			reinterpret_cast<char *>(&destbufferheader[0]),8) != 8) throw compression_error();
+
+		// If byteswapping needs to be done, it needs to be done
+		if (m_->byteswap_) mfswapbytes(&destbufferheader[0],sizeof(int32_t),2);
+
+		// The first int should be indicating it is a matrix
+		if (destbufferheader[0] != static_cast<int>(miMATRIX)) throw invalid_file_format();
+		// The secong int descibes the size of the contents of the matrix minus its header
+		// Hence the plus 8
+		int destlen = destbufferheader[1]+8;
+		if (destlen < 8) throw invalid_file_format();
+
+		// When indexing only the matrix header is needed: the class, dimensions and
+		// name tags are at the start of the block and are small.
+		const int headerlimit = 65536;
+		bool partial = (headeronly && destlen > headerlimit);
+		if (partial) destlen = headerlimit;
+
+		// Inflate straight into the buffer that will be read from
 		matfiledata destbuffer;
-		int32_t *destbufferheader = 0;
-		int destlen = 0;
+		destbuffer.newdatabuffer(destlen,miUINT8);
+		if (mfinflate(compressblockoffset,compressblocksize,
+			static_cast<char *>(destbuffer.databuffer()),destlen) != destlen) throw compression_error();
 
-		// We do some dynamic allocation here, if this fails the function
-		// should clear up its memory
-		try
+		m_->fcmpmbuffer_ = destbuffer;
+		m_->fcmpsize_ = destlen;
+
+		if (!partial)
 		{
-			// Read the block of compressed data
-			sourcebuffer = new char[compressblocksize];
-			mfread(static_cast<void *>(sourcebuffer),sizeof(char),compressblocksize,compressblockoffset);
-
-			// first only read the header to find out how big the data segment should be
-			// Only decompress the first 8 bytes. We need to know whether inside is a matrix
-			// and of what size this one is.
-
-			destlen = 8;
-			destbufferheader = new int32_t[2];
-			// uncompress the first few bytes
-			// we need to do a few ugly casts as somehow the compiler does not recognize
-			// they are all pointers.
-
-			uLongf clen = static_cast<uLongf>(destlen);
-      uncompress(reinterpret_cast<Bytef *>(destbufferheader),&clen,reinterpret_cast<const Bytef *>(sourcebuffer),(uLong)compressblocksize);
-			destlen = static_cast<int>(clen);
-
-			// In case something weird happened
-			if (destlen != 8) throw compression_error();
-
-			// If byteswapping needs to be done, it needs to be done
-			if (m_->byteswap_) mfswapbytes(destbufferheader,sizeof(int32_t),2);
-
-			// The first int should be indicating it is a matrix
-			if (destbufferheader[0] != static_cast<int>(miMATRIX)) throw invalid_file_format();
-			// The secong int descibes the size of the contents of the matrix minus its header
-			// Hence the plus 8
-			destlen = destbufferheader[1]+8;
-
-			// Uncompress the full thing including the previously read header
-			destbuffer.newdatabuffer(destlen,miUINT8);
-			//			destbuffer = new char[destlen];
-
-      clen = static_cast<uLongf>(destlen);
-			uncompress(reinterpret_cast<Bytef *>(destbuffer.databuffer()),&clen,reinterpret_cast<const Bytef *>(sourcebuffer),(uLong)compressblocksize);
-      destlen = static_cast<int>(clen);
-			if (destlen != destbufferheader[1]+8) throw compression_error();
-
-			// enter the information in the cmpbuffer structure
+			// Keep only the most recently decompressed block around
+			compressbuffer cmpbuffer;
 			cmpbuffer.mbuffer = destbuffer;
-			// destbuffer = 0;
 			cmpbuffer.buffersize = destlen;
 			cmpbuffer.bufferoffset = compressblockoffset;
-
-			// add this one to the list
+			m_->cmplist_.clear();
 			m_->cmplist_.push_back(cmpbuffer);
-
-			// Now fill out the fcmpbuffer stuff to
-			// force reading in the buffer
-			m_->fcmpbuffer_ = static_cast<char *>(cmpbuffer.mbuffer.databuffer());
-			m_->fcmpsize_ = cmpbuffer.buffersize;
-			m_->fcmpoffset_ = cmpbuffer.bufferoffset;
-			m_->fcmpcount_ = 0;
-
-			// free the remaining buffers
-			if (sourcebuffer != 0) delete[] sourcebuffer;
-			sourcebuffer = 0;
-			if (destbufferheader != 0) delete[] destbufferheader;
-			destbufferheader = 0;
-
-		}
-		catch(...)
-		{   // clean up
-			// if (destbuffer != 0) delete[] destbuffer;
-			if (sourcebuffer != 0) delete[] sourcebuffer;
-			sourcebuffer = 0;
-			if (destbufferheader != 0) delete[] destbufferheader;
-			destbufferheader = 0;
-			throw;
 		}
 	}
 
+	// Now fill out the fcmpbuffer stuff to
+	// force reading in the buffer
+	m_->fcmpbuffer_ = static_cast<char *>(m_->fcmpmbuffer_.databuffer());
+	m_->fcmpoffset_ = compressblockoffset;
+	m_->fcmpcount_ = 0;
+
     matfileptr childptr;
-    int datptr = m_->curptr_.datptr;
+    int64_t datptr = m_->curptr_.datptr;
     datptr = (((datptr-1)/8)+1)*8;
 
     childptr.hdrptr = datptr;
@@ -660,6 +702,7 @@ void matfile::closecompression()
     m_->ptrstack_.pop();
     m_->curptr_ = parptr;
     m_->fcmpbuffer_ = 0;
+    m_->fcmpmbuffer_.clear();
     m_->fcmpsize_ = 0;
     m_->fcmpoffset_ = 0;
     m_->fcmpcount_ = 0;
@@ -679,7 +722,7 @@ void matfile::closechild()
         int segsize;
         if (m_->curptr_.datptr != -1) nexttag();
 
-        segsize = m_->curptr_.hdrptr-parptr.datptr;
+        segsize = static_cast<int>(m_->curptr_.hdrptr-parptr.datptr);
 
 		m_->ptrstack_.pop();
         m_->curptr_ = parptr;
@@ -693,7 +736,7 @@ void matfile::closechild()
     }
 }
 
-int matfile::firsttag()
+int64_t matfile::firsttag()
 {
     m_->curptr_.hdrptr = m_->curptr_.startptr;
     m_->curptr_.datptr = -1;
@@ -701,7 +744,7 @@ int matfile::firsttag()
     if (m_->curptr_.hdrptr == m_->curptr_.endptr) return(0); else return(m_->curptr_.hdrptr);
 }
 
-int matfile::gototag(int tagaddress)
+int64_t matfile::gototag(int64_t tagaddress)
 {
     m_->curptr_.hdrptr = tagaddress;
     m_->curptr_.datptr = -1;
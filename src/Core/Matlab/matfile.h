@@ -99,11 +99,12 @@ class SCISHARE matfile : public matfilebase {
 	// typedef of a struct to use for indexing where we are in
 	// a file.
 	
+	// File offsets are 64 bit so files larger than 2GB can be indexed.
 	struct matfileptr {
-            int	hdrptr;		// location of tag header
-            int	datptr;		// location of data segment
-            int	startptr;	// location of the first tag header (to go one level up)
-            int	endptr;		// location of the end of the data segment (end+1)
+            int64_t	hdrptr;		// location of tag header
+            int64_t	datptr;		// location of data segment
+            int64_t	startptr;	// location of the first tag header (to go one level up)
+            int64_t	endptr;		// location of the end of the data segment (end+1)
             int	size;		// length of data segment
             mitype type;
             };
@@ -113,13 +114,15 @@ class SCISHARE matfile : public matfilebase {
 	// The basic idea is to decompress compressed pieces of the files and maintain a
 	// list of the pieces that have been compresse
 	// Using the offset in the file these pieces can be unique identified and cataloged
+	// Only the most recently decompressed block is kept, so reading variables
+	// one after another does not keep the whole file in memory.
 	
 
 	struct compressbuffer {
 			matfiledata mbuffer;	// Buffer with reference counting
 			// char	*buffer;	// buffer with uncompressed data
 			int	buffersize; // size of the buffer;
-			int	bufferoffset; // file offset of the buffer
+			int64_t	bufferoffset; // file offset of the buffer
 			};
 
 	struct mxfile {
@@ -143,15 +146,15 @@ class SCISHARE matfile : public matfilebase {
 			char		*fcmpbuffer_;   // Compression buffer
 			matfiledata fcmpmbuffer_;   // Same buffer but wrapped with my memory management system
 			int		fcmpsize_;		// Size of the buffer
-			int		fcmpoffset_;	// Offset of the buffer
+			int64_t	fcmpoffset_;	// Offset of the buffer
 			int		fcmpcount_;		// Counter to check where next to read data
-      int    fcmpalignoffset_;    // Correction for alignment problem in filess
+      int64_t fcmpalignoffset_;    // Correction for alignment problem in filess
 			
 			FILE		*fptr_;			// File pointer
 			std::string fname_;			// Filename
 			std::string fmode_;			// File access mode: "r" or "w"
         
-			int	    flength_;		// File length	
+			int64_t	    flength_;		// File length	
         
 			char	    headertext_[118]; 	// The text in the header of the matfile
 			int32_t		subsysdata_[2];		// NEW IN VERSION 7
@@ -167,8 +170,8 @@ class SCISHARE matfile : public matfilebase {
 			matfileptr curptr_;					// current pointer
             
 			// The next list contains the compressed buffers that were allocated
-			// Hence compressed variables have to be decompressed only once, which
-			// should boost the performance, but will cost memory
+			// Hence a compressed variable that is read again right after it was
+			// indexed or inspected does not need to be decompressed twice
 			
 			std::deque<compressbuffer> cmplist_;	// maintain a list of segments that have already been decompressed
 			};
@@ -200,10 +203,21 @@ class SCISHARE matfile : public matfilebase {
 	// The offset version start reading at an certain location (includes a fseek at the start)
 	  
   	void mfread(void *buffer,int elsize,int size);	// read data and do byte swapping
-	void mfread(void *buffer,int elsize,int size,int offset);
+	void mfread(void *buffer,int elsize,int size,int64_t offset);
    	
 	void mfwrite(void *buffer,int elsize,int size);
-	void mfwrite(void *buffer,int elsize,int size,int offset); 
+	void mfwrite(void *buffer,int elsize,int size,int64_t offset); 
+
+	// 64 bit safe seek in the raw file
+	void mfseek(int64_t offset);
+
+	// Inflate a compressed block straight from the file into dest. The
+	// compressed data is streamed through a small staging buffer and only
+	// as much of it is read as is needed to fill destsize bytes.
+	// Returns the number of bytes written to dest.
+	int mfinflate(int64_t offset,int srcsize,char *dest,int destsize);
+
+	bool mfopencompression(bool headeronly);
 
   public:
   	// constructors
@@ -250,6 +264,13 @@ class SCISHARE matfile : public matfilebase {
 	
 	bool opencompression();
 	void closecompression();	
+
+	// opencompressionheader:
+	// same as opencompression, but only decompresses the start of the block,
+	// enough to read the matrix class, dimensions and name. Reading beyond
+	// that point throws an io_error. Used for indexing a file without
+	// decompressing every variable in it.
+	bool opencompressionheader();
 			    
 	// navigation through file:
 	// firsttag:
@@ -264,9 +285,9 @@ class SCISHARE matfile : public matfilebase {
 	// rewind:
 	//  Go to the first tag at the top level
 	 
-	int firsttag();
-	int nexttag();
-	int gototag(int tag);
+	int64_t firsttag();
+	int64_t nexttag();
+	int64_t gototag(int64_t tag);
 	void rewind();
 		       
 	// A quick test to see what kind of access to the
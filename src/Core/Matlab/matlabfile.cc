@@ -61,42 +61,31 @@ void matlabfile::open(const std::string& filename,const std::string& accessmode)
   if (isreadaccess())
   {   // scan the file for the number of matrices
     // This function will index the file and get all the matrix names
-    // If it is a compressed file, it will automatically uncompress every
-    // block (this behavior may be changed to become more memory efficient)
+    // Compressed blocks are only inflated as far as needed to read the
+    // matrix name, the data itself is decompressed when the matrix is read
 
-    int tagptr;
-    matfiledata mfd;
-    std::stack<int> ptrstack;
+    int64_t tagptr;
+    std::stack<int64_t> ptrstack;
     std::stack<std::string> strstack;
-    bool compressedmatrix = false;
 
     tagptr = firsttag();
     while(tagptr)
     {
-      readtag(mfd);
-
-      // Bug fix, this bool was not reset
-      compressedmatrix = false;
-      // If the tag tells that the next block is compressed
-      // Open this compressed block before continuing
-      if (mfd.type() == miCOMPRESSED)
+      std::string name;
+      try
       {
-        compressedmatrix = true; // to mark that we have to close the compressed session
-        opencompression(); // uncompress the data
-        readtag(mfd); // read the first tag, which should be miMATRIX
+        name = readmatrixname(true);
+      }
+      catch (io_error&)
+      {
+        // The matrix header did not fit in the partially inflated block,
+        // go back to the tag and decompress the full block instead
+        rewind();
+        gototag(tagptr);
+        name = readmatrixname(false);
       }
-      if (mfd.type() != miMATRIX) throw invalid_file_format();
-
-      openchild();
-      readtag(mfd);
-      nexttag();
-      readtag(mfd);
-      nexttag();
-      readdat(mfd);
-      closechild();
-      if (compressedmatrix) closecompression();
 
-      strstack.push(mfd.getstring());
+      strstack.push(name);
       ptrstack.push(tagptr);
       tagptr = nexttag();    		
     }
@@ -116,6 +105,36 @@ void matlabfile::open(const std::string& filename,const std::string& accessmode)
 }
 
 
+std::string matlabfile::readmatrixname(bool headeronly)
+{
+  matfiledata mfd;
+  bool compressedmatrix = false;
+
+  readtag(mfd);
+
+  // If the tag tells that the next block is compressed
+  // Open this compressed block before continuing
+  if (mfd.type() == miCOMPRESSED)
+  {
+    compressedmatrix = true; // to mark that we have to close the compressed session
+    if (headeronly) opencompressionheader(); else opencompression();
+    readtag(mfd); // read the first tag, which should be miMATRIX
+  }
+  if (mfd.type() != miMATRIX) throw invalid_file_format();
+
+  openchild();
+  readtag(mfd);
+  nexttag();
+  readtag(mfd);
+  nexttag();
+  readdat(mfd);
+  closechild();
+  if (compressedmatrix) closecompression();
+
+  return(mfd.getstring());
+}
+
+
 void matlabfile::close()
 {
   matfile::close();
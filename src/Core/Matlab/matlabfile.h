@@ -88,11 +88,14 @@ namespace MatlabIO
 
     // NOTE: These fields are only available for
     // read access
-    std::vector<int> matrixaddress_;
+    std::vector<int64_t> matrixaddress_;
     std::vector<std::string> matrixname_;
 
   private:
     void importmatlabarray(matlabarray& ma,int mode);
+    // reads the name of the matrix at the current tag, with headeronly
+    // set only the start of a compressed block is decompressed
+    std::string readmatrixname(bool headeronly);
     void exportmatlabarray(matlabarray& ma); 
     mitype converttype(mxtype type);
     mxtype convertclass(mlclass mclass,mitype type);
@@ -0,0 +1,430 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Core/Persistent/ChunkedGZip.h>
+#include <Core/Thread/Parallel.h>
+
+#include <algorithm>
+#include <string.h>
+
+using namespace SCIRun::Core::Thread;
+
+namespace SCIRun {
+
+namespace
+{
+  // gzip member header: 10 fixed bytes, XLEN, and one 12 byte extra subfield
+  // ('S','C', length 8, member size, uncompressed size).
+  const size_t HEADER_SIZE = 24;
+  const size_t TRAILER_SIZE = 8;
+  const unsigned char GZIP_ID1 = 0x1f;
+  const unsigned char GZIP_ID2 = 0x8b;
+  const unsigned char GZIP_FEXTRA = 4;
+  const size_t MAX_BLOCK_SIZE = 1 << 30;
+
+  void put16(unsigned char* p, unsigned int v)
+  {
+    p[0] = v & 0xff;
+    p[1] = (v >> 8) & 0xff;
+  }
+
+  void put32(unsigned char* p, size_t v)
+  {
+    for (int i = 0; i < 4; ++i)
+      p[i] = (v >> (8 * i)) & 0xff;
+  }
+
+  size_t get16(const unsigned char* p)
+  {
+    return p[0] | (p[1] << 8);
+  }
+
+  size_t get32(const unsigned char* p)
+  {
+    size_t v = 0;
+    for (int i = 3; i >= 0; --i)
+      v = (v << 8) | p[i];
+    return v;
+  }
+
+  void writeHeader(unsigned char* p, size_t memberSize, size_t dataSize)
+  {
+    p[0] = GZIP_ID1;
+    p[1] = GZIP_ID2;
+    p[2] = Z_DEFLATED;
+    p[3] = GZIP_FEXTRA;
+    put32(p + 4, 0); // mtime
+    p[8] = 0;
+    p[9] = 255;      // unknown OS
+    put16(p + 10, 12);
+    p[12] = 'S';
+    p[13] = 'C';
+    put16(p + 14, 8);
+    put32(p + 16, memberSize);
+    put32(p + 20, dataSize);
+  }
+
+  bool readHeader(const unsigned char* p, size_t& memberSize, size_t& dataSize)
+  {
+    if (p[0] != GZIP_ID1 || p[1] != GZIP_ID2 || p[2] != Z_DEFLATED || p[3] != GZIP_FEXTRA ||
+        get16(p + 10) != 12 || p[12] != 'S' || p[13] != 'C' || get16(p + 14) != 8)
+      return false;
+    memberSize = get32(p + 16);
+    dataSize = get32(p + 20);
+    return memberSize >= HEADER_SIZE + TRAILER_SIZE;
+  }
+
+  bool compressBlock(const char* in, size_t size, int level, std::vector<char>& out)
+  {
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    if (deflateInit2(&zs, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+      return false;
+
+    const size_t bound = deflateBound(&zs, static_cast<uLong>(size));
+    out.resize(HEADER_SIZE + bound + TRAILER_SIZE);
+    unsigned char* base = reinterpret_cast<unsigned char*>(&out[0]);
+
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in));
+    zs.avail_in = static_cast<uInt>(size);
+    zs.next_out = base + HEADER_SIZE;
+    zs.avail_out = static_cast<uInt>(bound);
+    const int ret = deflate(&zs, Z_FINISH);
+    const size_t compressed = zs.total_out;
+    deflateEnd(&zs);
+    if (ret != Z_STREAM_END)
+      return false;
+
+    const size_t memberSize = HEADER_SIZE + compressed + TRAILER_SIZE;
+    writeHeader(base, memberSize, size);
+    const uLong crc = crc32(0, reinterpret_cast<const Bytef*>(in), static_cast<uInt>(size));
+    put32(base + HEADER_SIZE + compressed, crc);
+    put32(base + HEADER_SIZE + compressed + 4, size);
+    out.resize(memberSize);
+    return true;
+  }
+
+  bool decompressBlock(const char* member, size_t memberSize, size_t dataSize, std::vector<char>& out)
+  {
+    out.resize(dataSize);
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    if (inflateInit2(&zs, -MAX_WBITS) != Z_OK)
+      return false;
+
+    const unsigned char* base = reinterpret_cast<const unsigned char*>(member);
+    zs.next_in = const_cast<Bytef*>(base + HEADER_SIZE);
+    zs.avail_in = static_cast<uInt>(memberSize - HEADER_SIZE - TRAILER_SIZE);
+    zs.next_out = dataSize > 0 ? reinterpret_cast<Bytef*>(&out[0]) : 0;
+    zs.avail_out = static_cast<uInt>(dataSize);
+    const int ret = inflate(&zs, Z_FINISH);
+    const size_t produced = zs.total_out;
+    inflateEnd(&zs);
+    if (ret != Z_STREAM_END || produced != dataSize)
+      return false;
+
+    const unsigned char* trailer = base + memberSize - TRAILER_SIZE;
+    const uLong crc = crc32(0, dataSize > 0 ? reinterpret_cast<const Bytef*>(&out[0]) : 0, static_cast<uInt>(dataSize));
+    return get32(trailer) == (crc & 0xffffffffUL) && get32(trailer + 4) == (dataSize & 0xffffffffUL);
+  }
+
+  bool seekFile(FILE* fp, size_t offset)
+  {
+#ifdef _WIN32
+    return _fseeki64(fp, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+    return fseeko(fp, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+  }
+
+  int threadCount(int requested)
+  {
+    if (requested > 0)
+      return requested;
+    return std::max(1u, Parallel::NumCores());
+  }
+}
+
+const size_t ChunkedGZipWriter::DefaultBlockSize = 4 * 1024 * 1024;
+
+ChunkedGZipWriter::ChunkedGZipWriter(const std::string& filename, int level,
+                                     size_t blockSize, int numThreads)
+  : fp_(0), level_(level),
+    blockSize_(std::max<size_t>(1, std::min(blockSize, MAX_BLOCK_SIZE))),
+    numThreads_(threadCount(numThreads)),
+    error_(false)
+{
+  fp_ = fopen(filename.c_str(), "wb");
+  error_ = fp_ == 0;
+  if (fp_)
+    pending_.reserve(blockSize_ * numThreads_);
+}
+
+ChunkedGZipWriter::~ChunkedGZipWriter()
+{
+  close();
+}
+
+bool ChunkedGZipWriter::write(const void* data, size_t size)
+{
+  if (!fp_ || error_)
+    return false;
+
+  const size_t batch = blockSize_ * numThreads_;
+  const char* p = static_cast<const char*>(data);
+  while (size > 0)
+  {
+    const size_t n = std::min(size, batch - pending_.size());
+    pending_.insert(pending_.end(), p, p + n);
+    p += n;
+    size -= n;
+    if (pending_.size() >= batch && !flushBlocks(false))
+      return false;
+  }
+  return true;
+}
+
+bool ChunkedGZipWriter::flushBlocks(bool all)
+{
+  size_t nblocks = pending_.size() / blockSize_;
+  if (all && pending_.size() % blockSize_ != 0)
+    ++nblocks;
+  if (nblocks == 0)
+    return true;
+
+  std::vector<std::vector<char> > members(nblocks);
+  std::vector<int> ok(nblocks, 0);
+  Parallel::RunTasks([&](int i)
+  {
+    const size_t begin = i * blockSize_;
+    const size_t n = std::min(blockSize_, pending_.size() - begin);
+    ok[i] = compressBlock(&pending_[begin], n, level_, members[i]);
+  }, static_cast<int>(nblocks));
+
+  for (size_t i = 0; i < nblocks && !error_; ++i)
+  {
+    if (!ok[i] || fwrite(&members[i][0], 1, members[i].size(), fp_) != members[i].size())
+      error_ = true;
+  }
+
+  pending_.erase(pending_.begin(), pending_.begin() + std::min(pending_.size(), nblocks * blockSize_));
+  return !error_;
+}
+
+bool ChunkedGZipWriter::close()
+{
+  if (!fp_)
+    return !error_;
+
+  if (!error_)
+    flushBlocks(true);
+
+  // An empty block marks a complete file, and guarantees that even empty output
+  // is recognized as chunked.
+  std::vector<char> eof;
+  if (!error_ && (!compressBlock(0, 0, level_, eof) || fwrite(&eof[0], 1, eof.size(), fp_) != eof.size()))
+    error_ = true;
+
+  if (fclose(fp_) != 0)
+    error_ = true;
+  fp_ = 0;
+  pending_.clear();
+  return !error_;
+}
+
+
+ChunkedGZipReader::ChunkedGZipReader(const std::string& filename, int numThreads)
+  : fp_(0), legacy_(0),
+    numThreads_(threadCount(numThreads)),
+    error_(false), position_(0), cacheFirst_(0)
+{
+  fp_ = fopen(filename.c_str(), "rb");
+  if (!fp_)
+  {
+    error_ = true;
+    return;
+  }
+
+  unsigned char hdr[HEADER_SIZE];
+  size_t memberSize, dataSize;
+  if (fread(hdr, 1, HEADER_SIZE, fp_) != HEADER_SIZE || !readHeader(hdr, memberSize, dataSize))
+  {
+    // Plain gzip (or uncompressed) data: zlib inflates it sequentially.
+    fclose(fp_);
+    fp_ = 0;
+    legacy_ = gzopen(filename.c_str(), "rb");
+    error_ = legacy_ == 0;
+    return;
+  }
+
+  if (!buildIndex())
+  {
+    error_ = true;
+    fclose(fp_);
+    fp_ = 0;
+  }
+}
+
+ChunkedGZipReader::~ChunkedGZipReader()
+{
+  if (fp_)
+    fclose(fp_);
+  if (legacy_)
+    gzclose(legacy_);
+}
+
+bool ChunkedGZipReader::buildIndex()
+{
+  size_t fileOffset = 0, dataOffset = 0;
+  unsigned char hdr[HEADER_SIZE];
+  while (seekFile(fp_, fileOffset))
+  {
+    const size_t got = fread(hdr, 1, HEADER_SIZE, fp_);
+    if (got == 0)
+      return true;
+
+    size_t memberSize, dataSize;
+    if (got != HEADER_SIZE || !readHeader(hdr, memberSize, dataSize))
+      return false;
+
+    if (dataSize > 0)
+    {
+      Block block = { fileOffset, memberSize, dataOffset, dataSize };
+      index_.push_back(block);
+    }
+    fileOffset += memberSize;
+    dataOffset += dataSize;
+  }
+  return false;
+}
+
+size_t ChunkedGZipReader::size() const
+{
+  if (index_.empty())
+    return 0;
+  return index_.back().dataOffset + index_.back().dataSize;
+}
+
+size_t ChunkedGZipReader::findBlock(size_t offset) const
+{
+  auto pos = std::upper_bound(index_.begin(), index_.end(), offset,
+    [](size_t off, const Block& b) { return off < b.dataOffset; });
+  return (pos - index_.begin()) - 1;
+}
+
+bool ChunkedGZipReader::loadBlocks(size_t first)
+{
+  const size_t count = std::min(static_cast<size_t>(numThreads_), index_.size() - first);
+  const Block& last = index_[first + count - 1];
+  const size_t begin = index_[first].fileOffset;
+  const size_t end = last.fileOffset + last.compressedSize;
+
+  std::vector<char> compressed(end - begin);
+  if (!seekFile(fp_, begin) || fread(&compressed[0], 1, compressed.size(), fp_) != compressed.size())
+    return false;
+
+  cache_.resize(count);
+  std::vector<int> ok(count, 0);
+  Parallel::RunTasks([&](int i)
+  {
+    const Block& b = index_[first + i];
+    ok[i] = decompressBlock(&compressed[b.fileOffset - begin], b.compressedSize, b.dataSize, cache_[i]);
+  }, static_cast<int>(count));
+
+  cacheFirst_ = first;
+  if (std::find(ok.begin(), ok.end(), 0) != ok.end())
+  {
+    cache_.clear();
+    return false;
+  }
+  return true;
+}
+
+size_t ChunkedGZipReader::read(void* data, size_t size)
+{
+  char* dst = static_cast<char*>(data);
+  size_t done = 0;
+
+  if (legacy_)
+  {
+    while (done < size && !error_)
+    {
+      const unsigned int n = static_cast<unsigned int>(std::min<size_t>(size - done, MAX_BLOCK_SIZE));
+      const int got = gzread(legacy_, dst + done, n);
+      if (got < 0)
+        error_ = true;
+      if (got <= 0)
+        break;
+      done += got;
+    }
+    position_ += done;
+    return done;
+  }
+
+  if (!fp_)
+    return 0;
+
+  const size_t total = this->size();
+  while (done < size && position_ < total)
+  {
+    const size_t b = findBlock(position_);
+    if (b < cacheFirst_ || b >= cacheFirst_ + cache_.size())
+    {
+      if (!loadBlocks(b))
+      {
+        error_ = true;
+        break;
+      }
+    }
+    const Block& block = index_[b];
+    const std::vector<char>& buffer = cache_[b - cacheFirst_];
+    const size_t inBlock = position_ - block.dataOffset;
+    const size_t n = std::min(size - done, block.dataSize - inBlock);
+    memcpy(dst + done, &buffer[inBlock], n);
+    done += n;
+    position_ += n;
+  }
+  return done;
+}
+
+bool ChunkedGZipReader::seek(size_t offset)
+{
+  if (legacy_)
+  {
+    if (gzseek(legacy_, static_cast<z_off_t>(offset), SEEK_SET) < 0)
+      return false;
+    position_ = offset;
+    return true;
+  }
+  if (!fp_ || offset > size())
+    return false;
+  position_ = offset;
+  return true;
+}
+
+} // End namespace SCIRun
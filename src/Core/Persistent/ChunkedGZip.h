@@ -0,0 +1,133 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+///
+///@file  ChunkedGZip.h
+///@brief Block-compressed gzip container with parallel compression and
+///       random access.
+///
+///@details Data is split into fixed size blocks, each stored as a complete
+///  gzip member. Concatenated members form a valid gzip file, so any gzip
+///  reader (including zlib's gzread and older SCIRun builds) can read the
+///  output. Each member header carries an extra field with the member's
+///  compressed and uncompressed sizes, which lets the reader build a block
+///  index by hopping over headers, decompress blocks on several threads and
+///  seek without inflating everything in front of the target offset.
+///  Plain gzip files are still readable; they are inflated sequentially.
+///
+
+#ifndef CORE_PERSISTENT_CHUNKEDGZIP_H
+#define CORE_PERSISTENT_CHUNKEDGZIP_H
+
+#include <boost/noncopyable.hpp>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+#include <Core/Persistent/share.h>
+
+namespace SCIRun {
+
+class SCISHARE ChunkedGZipWriter : boost::noncopyable
+{
+public:
+  static const size_t DefaultBlockSize;
+
+  /// numThreads <= 0 uses one thread per core.
+  explicit ChunkedGZipWriter(const std::string& filename,
+                             int level = Z_DEFAULT_COMPRESSION,
+                             size_t blockSize = DefaultBlockSize,
+                             int numThreads = 0);
+  ~ChunkedGZipWriter();
+
+  bool isOpen() const { return fp_ != 0; }
+  bool error() const { return error_; }
+
+  bool write(const void* data, size_t size);
+  /// Flushes remaining data, appends the end-of-file block and closes the file.
+  bool close();
+
+private:
+  bool flushBlocks(bool all);
+
+  FILE* fp_;
+  int level_;
+  size_t blockSize_;
+  int numThreads_;
+  bool error_;
+  std::vector<char> pending_;
+};
+
+
+class SCISHARE ChunkedGZipReader : boost::noncopyable
+{
+public:
+  /// numThreads <= 0 uses one thread per core.
+  explicit ChunkedGZipReader(const std::string& filename, int numThreads = 0);
+  ~ChunkedGZipReader();
+
+  bool isOpen() const { return fp_ != 0 || legacy_ != 0; }
+  /// False for plain gzip files, which are read sequentially.
+  bool isChunked() const { return fp_ != 0; }
+  bool error() const { return error_; }
+
+  /// Returns the number of bytes read, less than size at end of file or on error.
+  size_t read(void* data, size_t size);
+  /// Seeks to an offset in the uncompressed data.
+  bool seek(size_t offset);
+  size_t tell() const { return position_; }
+  /// Uncompressed size; only known for chunked files.
+  size_t size() const;
+
+private:
+  struct Block
+  {
+    size_t fileOffset;
+    size_t compressedSize;
+    size_t dataOffset;
+    size_t dataSize;
+  };
+
+  bool buildIndex();
+  size_t findBlock(size_t offset) const;
+  bool loadBlocks(size_t first);
+
+  FILE* fp_;
+  gzFile legacy_;
+  int numThreads_;
+  bool error_;
+  size_t position_;
+  std::vector<Block> index_;
+  size_t cacheFirst_;
+  std::vector<std::vector<char> > cache_;
+};
+
+} // End namespace SCIRun
+
+#endif
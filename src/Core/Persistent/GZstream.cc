@@ -26,53 +26,35 @@
    DEALINGS IN THE SOFTWARE.
 */
 
-
-
 ///
-///@file  Pstreams.cc
-///@brief Reading/writing persistent objects
+///@file  GZstream.cc
+///@brief Reading/writing compressed persistent objects
 ///
-///@authors
-///       Steven G. Parker,
-///       Modified by
-///       Michelle Miller
+///@author
+///       Michael Callahan
 ///       Department of Computer Science
 ///       University of Utah
-///@date  April 1994, Modified 
-///   Thu Feb 19 17:04:59 MST 1998
+///@date  June 2007
 ///
 
 #include <Core/Persistent/GZstream.h>
+#include <Core/Logging/LoggerInterface.h>
+#include <Core/Utils/Legacy/StringUtil.h>
+#include <Core/Utils/Legacy/Endian.h>
 
-#include <Core/Util/StringUtil.h>
-
-#include <teem/air.h>
-#include <teem/nrrd.h>
-#include <zlib.h>
-
-
-#include   <fstream>
-#include   <iostream>
-
-
-
-
-#include <sys/types.h>
-#include <sys/stat.h>
-#include <fcntl.h>
+#include <stdio.h>
 #include <string.h>
+#include <iostream>
+#include <vector>
 
-#ifdef _WIN32
-#  include <io.h>
-#endif
+using namespace SCIRun::Core::Logging;
 
 namespace SCIRun {
 
-// BinaryPiostream -- portable
+// GZPiostream -- portable
 GZPiostream::GZPiostream(const std::string& filename, Direction dir,
-                                 const int& v, ProgressReporter *pr)
-  : Piostream(dir, v, filename, pr),
-    fp_(0)
+                         const int& v, LoggerHandle pr)
+  : Piostream(dir, v, filename, pr)
 {
   if (v == -1) // no version given so use PERSISTENT_VERSION
     version_ = PERSISTENT_VERSION;
@@ -81,199 +63,115 @@ GZPiostream::GZPiostream(const std::string& filename, Direction dir,
 
   if (dir==Read)
   {
-    fp_ = gzopen (filename.c_str(), "rb");
-    if (!fp_)
-    {
-      reporter_->error("Error opening file: " + filename + " for reading.");
-      err = true;
-      return;
-    }
-
-    // Old versions had headers of size 12.
-    if (version() == 1)
-    {
-      char hdr[12];
-      if (!gzread(fp_, hdr, 12))
-      {
-	reporter_->error("Header read failed.");
-	err = true;
-	return;
-      }
-    }
-    else
-    {
-      // Versions > 1 have size of 16 to account for endianness in
-      // header (LIT | BIG).
-      char hdr[16];
-      if (!gzread(fp_, hdr, 16))
-      {
-	reporter_->error("Header read failed.");
-	err = true;
-	return;
-      }
-    }
+    in_.reset(new ChunkedGZipReader(filename));
+    readFileHeader();
   }
   else
   {
-    fp_ = gzopen(filename.c_str(), "wb");
-    if (!fp_)
+    out_.reset(new ChunkedGZipWriter(filename));
+    if (!out_->isOpen())
     {
       reporter_->error("Error opening file '" + filename + "' for writing.");
       err = true;
       return;
     }
 
+    // write out 16 (or 12) bytes, but we need 17 for \0
+    char hdr[17];
     if (version() > 1)
-    {
-      // write out 16 bytes, but we need 17 for \0
-      char hdr[17];
       sprintf(hdr, "SCI\nBIN\n%03d\n%s", version_, endianness());
-
-      if (!gzwrite(fp_, hdr, 16))
-      {
-	reporter_->error("Header write failed.");
-	err = true;
-	return;
-      }
-    }
     else
-    {
-      // write out 12 bytes, but we need 13 for \0
-      char hdr[13];
       sprintf(hdr, "SCI\nBIN\n%03d\n", version_);
-      if (!gzwrite(fp_, hdr, 13))
-      {
-	reporter_->error("Header write failed.");
-	err = true;
-	return;
-      }
+
+    if (!writeBytes(hdr, version() > 1 ? 16 : 12))
+    {
+      reporter_->error("Header write failed.");
+      err = true;
+      return;
     }
   }
 }
 
 
-GZPiostream::GZPiostream(int fd, Direction dir, const int& v,
-                                 ProgressReporter *pr)
-  : Piostream(dir, v, "", pr),
-    fp_(0)
+GZPiostream::GZPiostream(boost::shared_ptr<ChunkedGZipReader> in,
+                         const std::string& filename, const int& v,
+                         LoggerHandle pr)
+  : Piostream(Read, v, filename, pr), in_(in)
 {
-  if (v == -1) // No version given so use PERSISTENT_VERSION.
+  if (v == -1) // no version given so use PERSISTENT_VERSION
     version_ = PERSISTENT_VERSION;
   else
     version_ = v;
 
-  if (dir == Read)
-  {
-    fp_ = gzdopen (fd, "rb");
-    if (!fp_)
-    {
-      reporter_->error("Error opening socket " + to_string(fd) +
-                       " for reading.");
-      err = true;
-      return;
-    }
+  readFileHeader();
+}
 
-    // Old versions had headers of size 12.
-    if (version() == 1)
-    {
-      char hdr[12];
 
-      // read header
-      if (!gzread(fp_, hdr, 12))
-      {
-	reporter_->error("Header read failed.");
-	err = true;
-	return;
-      }
-    }
-    else
-    {
-      // Versions > 1 have size of 16 to account for endianness in
-      // header (LIT | BIG).
-      char hdr[16];
-      if (!gzread(fp_, hdr, 16))
-      {
-	reporter_->error("Header read failed.");
-	err = true;
-	return;
-      }
-    }
-  }
-  else
+void
+GZPiostream::readFileHeader()
+{
+  if (!in_ || !in_->isOpen())
   {
-    fp_ = gzdopen(fd, "wb");
-    if (!fp_)
-    {
-      reporter_->error("Error opening socket " + to_string(fd) +
-                       " for writing.");
-      err = true;
-      return;
-    }
-
-    if (version() > 1)
-    {
-      char hdr[16];
-      sprintf(hdr, "SCI\nBIN\n%03d\n%s", version_, endianness());
+    reporter_->error("Error opening file: " + file_name + " for reading.");
+    err = true;
+    return;
+  }
 
-      if (!gzwrite(fp_, hdr, 16))
-      {
-	reporter_->error("Header write failed.");
-	err = true;
-	return;
-      }
-    }
-    else
-    {
-      char hdr[12];
-      sprintf(hdr, "SCI\nBIN\n%03d\n", version_);
-      if (!gzwrite(fp_, hdr, 12))
-      {
-	reporter_->error("Header write failed.");
-	err = true;
-	return;
-      }
-    }
+  // Old versions had headers of size 12, versions > 1 have size of 16
+  // to account for endianness in header (LIT | BIG).
+  char hdr[16];
+  if (!in_->seek(0) || !readBytes(hdr, version() == 1 ? 12 : 16))
+  {
+    reporter_->error("Header read failed.");
+    err = true;
+    return;
   }
 }
 
 
 GZPiostream::~GZPiostream()
 {
-  if (fp_) gzclose(fp_);
+  if (out_ && !out_->close())
+    reporter_->error("Error closing compressed file '" + file_name + "'.");
 }
 
-void
-GZPiostream::reset_post_header() 
+
+bool
+GZPiostream::readBytes(void* data, size_t size)
 {
-  if (! reading()) return;
+  return in_ && in_->read(data, size) == size;
+}
 
-  gzseek(fp_, 0, SEEK_SET);
 
-  if (version() == 1)
-  {
-    // Old versions had headers of size 12.
-    char hdr[12];    
-    // read header
-    gzread(fp_, hdr, 12);
-  }
-  else
+bool
+GZPiostream::writeBytes(const void* data, size_t size)
+{
+  return out_ && out_->write(data, size);
+}
+
+
+void
+GZPiostream::reset_post_header()
+{
+  if (!reading() || !in_) return;
+
+  // Old versions had headers of size 12, versions > 1 have size of 16
+  // to account for endianness in header (LIT | BIG).
+  if (!in_->seek(version() == 1 ? 12 : 16))
   {
-    // Versions > 1 have size of 16 to account for endianness in
-    // header (LIT | BIG).
-    char hdr[16];    
-    // read header
-    gzread(fp_, hdr, 16);
+    reporter_->error("Error seeking past header of compressed file.");
+    err = true;
   }
 }
 
+
 const char *
 GZPiostream::endianness()
 {
-  if (airMyEndian == airEndianLittle)
+  if (isLittleEndian())
     return "LIT\n";
   else
     return "BIG\n";
-
 }
 
 
@@ -284,7 +182,7 @@ GZPiostream::gen_io(T& data, const char *iotype)
   if (err) return;
   if (dir==Read)
   {
-    if (!gzread(fp_, &data, sizeof(data)))
+    if (!readBytes(&data, sizeof(data)))
     {
       err = true;
       reporter_->error(std::string("GZPiostream error reading ") +
@@ -293,7 +191,7 @@ GZPiostream::gen_io(T& data, const char *iotype)
   }
   else
   {
-    if (!gzwrite(fp_, &data, sizeof(data)))
+    if (!writeBytes(&data, sizeof(data)))
     {
       err = true;
       reporter_->error(std::string("GZPiostream error writing ") +
@@ -495,14 +393,14 @@ GZPiostream::io(std::string& data)
       // to the 4 byte boundary with zeros.
       chars = data.size();
       io(chars);
-      if (!gzwrite(fp_, data.c_str(), sizeof(char) * chars)) err = true;
+      if (!writeBytes(data.c_str(), sizeof(char) * chars)) err = true;
 
       // Pad data out to 4 bytes.
       int extra = chars % 4;
       if (extra)
       {
         static const char pad[4] = {0, 0, 0, 0};
-        if (!gzwrite(fp_, pad, sizeof(char) * (4 - extra))) err = true;
+        if (!writeBytes(pad, sizeof(char) * (4 - extra))) err = true;
       }
     }
     else
@@ -510,7 +408,7 @@ GZPiostream::io(std::string& data)
       const char* p = data.c_str();
       chars = static_cast<int>(strlen(p)) + 1;
       io(chars);
-      if (!gzwrite(fp_, p, sizeof(char) * chars)) err = true;
+      if (!writeBytes(p, sizeof(char) * chars)) err = true;
     }
   }
   if (dir == Read)
@@ -531,7 +429,7 @@ GZPiostream::io(std::string& data)
         char* buf = new char[buf_size];
 	
         // Read in data plus padding.
-        if (!gzread(fp_, buf, sizeof(char) * buf_size))
+        if (!readBytes(buf, sizeof(char) * buf_size))
         {
           err = true;
           delete [] buf;
@@ -546,10 +444,13 @@ GZPiostream::io(std::string& data)
     }
     else
     {
-      char* buf = new char[chars];
-      gzread(fp_, buf, sizeof(char) * chars);
-      data = std::string(buf);
-      delete[] buf;
+      std::vector<char> buf(chars + 1, 0);
+      if (!readBytes(&buf[0], sizeof(char) * chars))
+      {
+        err = true;
+        return;
+      }
+      data = std::string(&buf[0]);
     }
   }
 }
@@ -561,8 +462,7 @@ GZPiostream::block_io(void *data, size_t s, size_t nmemb)
   if (err || version() == 1) { return false; }
   if (dir == Read)
   {
-    const size_t did = gzread(fp_, data, s * nmemb);
-    if (did != nmemb)
+    if (!readBytes(data, s * nmemb))
     {
       err = true;
       reporter_->error("GZPiostream error reading block io.");
@@ -570,12 +470,11 @@ GZPiostream::block_io(void *data, size_t s, size_t nmemb)
   }
   else
   {
-    const size_t did = gzwrite(fp_, data, s * nmemb);
-    if (did != nmemb)
+    if (!writeBytes(data, s * nmemb))
     {
       err = true;
       reporter_->error("GZPiostream error writing block io.");
-    }      
+    }
   }
   return true;
 }
@@ -586,15 +485,16 @@ GZPiostream::block_io(void *data, size_t s, size_t nmemb)
 // GZSwapPiostream -- portable
 // Piostream used when endianness of machine and file don't match
 GZSwapPiostream::GZSwapPiostream(const std::string& filename, Direction dir,
-                                         const int& v, ProgressReporter *pr)
+                                 const int& v, LoggerHandle pr)
   : GZPiostream(filename, dir, v, pr)
 {
 }
 
 
-GZSwapPiostream::GZSwapPiostream(int fd, Direction dir, const int& v,
-                                         ProgressReporter *pr)
-  : GZPiostream(fd, dir, v, pr)
+GZSwapPiostream::GZSwapPiostream(boost::shared_ptr<ChunkedGZipReader> in,
+                                 const std::string& filename, const int& v,
+                                 LoggerHandle pr)
+  : GZPiostream(in, filename, v, pr)
 {
 }
 
@@ -607,7 +507,7 @@ GZSwapPiostream::~GZSwapPiostream()
 const char *
 GZSwapPiostream::endianness()
 {
-  if (airMyEndian == airEndianLittle)
+  if (isLittleEndian())
     return "LIT\n";
   else
     return "BIG\n";
@@ -621,7 +521,7 @@ GZSwapPiostream::gen_io(T& data, const char *iotype)
   if (dir==Read)
   {
     unsigned char tmp[sizeof(data)];
-    if (!gzread(fp_, tmp, sizeof(data)))
+    if (!readBytes(tmp, sizeof(data)))
     {
       err = true;
       reporter_->error(std::string("GZPiostream error reading ") +
@@ -636,27 +536,12 @@ GZSwapPiostream::gen_io(T& data, const char *iotype)
   }
   else
   {
-#if 0
-    unsigned char tmp[sizeof(data)];
-    unsigned char *cdata = reinterpret_cast<unsigned char *>(&data);
-    for (unsigned int i = 0; i < sizeof(data); i++)
-    {
-      tmp[i] = cdata[sizeof(data)-i-1];
-    }
-    if (!gzwrite(fp_, tmp, sizeof(data)))
+    if (!writeBytes(&data, sizeof(data)))
     {
       err = true;
       reporter_->error(std::string("GZPiostream error writing ") +
                        iotype + ".");
     }
-#else
-    if (!gzwrite(fp_, &data, sizeof(data)))
-    {
-      err = true;
-      reporter_->error(std::string("GZPiostream error writing ") +
-                       iotype + ".");
-    }
-#endif
   }
 }
 
@@ -779,19 +664,26 @@ GZSwapPiostream::io(float& data)
 
 
 PiostreamPtr
-auto_gzistream(const std::string& filename, ProgressReporter *pr)
+auto_gzistream(const std::string& filename, LoggerHandle pr)
 {
-  gzFile file = gzopen(filename.c_str(), "rb");
+  // The stream reuses this reader, so the block index is only built once.
+  boost::shared_ptr<ChunkedGZipReader> in(new ChunkedGZipReader(filename));
   char hdr[16];
-  gzread(file, hdr, 16);
-  gzclose(file);
+  if (!in->isOpen() || in->read(hdr, 16) != 16)
+  {
+    if (pr)
+      pr->error("Unable to open file: " + filename);
+    else
+      std::cerr << "ERROR - Unable to open file: " << filename << std::endl;
+    return PiostreamPtr();
+  }
 
   int file_endian, version;
   if (!Piostream::readHeader(pr, filename, hdr, 0, version, file_endian))
   {
-    if (pr) 
+    if (pr)
       pr->error("Cannot parse header of file: " + filename);
-    else 
+    else
       std::cerr << "ERROR - Cannot parse header of file: " << filename << std::endl;
     return PiostreamPtr();
   }
@@ -800,10 +692,10 @@ auto_gzistream(const std::string& filename, ProgressReporter *pr)
     const std::string errmsg = "File '" + filename + "' has version " +
       to_string(version) + ", this build only supports up to version " +
       to_string(Piostream::PERSISTENT_VERSION) + ".";
-    
-    if (pr) 
+
+    if (pr)
       pr->error(errmsg);
-    else 
+    else
       std::cerr << "ERROR - " + errmsg;
 
     return PiostreamPtr();
@@ -818,34 +710,23 @@ auto_gzistream(const std::string& filename, ProgressReporter *pr)
     // the version = 1, readHeader would return BIG, otherwise it will
     // read it from the header.
     int machine_endian = Piostream::Big;
-    if (airMyEndian == airEndianLittle) {
+    if (isLittleEndian())
+    {
       machine_endian = Piostream::Little;
     }
 
-    if (file_endian == machine_endian) 
-      return PiostreamPtr(new GZPiostream(filename, Piostream::Read, version, pr));
-    else 
-      return PiostreamPtr(new GZSwapPiostream(filename, Piostream::Read, version,pr));
-  }
-  else
-  {
-    const std::string msg = "Text based compressed files are not supported."; 
-    if (pr) 
-      pr->error(msg);
-    else 
-      std::cerr << "ERROR - " + msg << "\n";
-    return PiostreamPtr();
+    if (file_endian == machine_endian)
+      return PiostreamPtr(new GZPiostream(in, filename, version, pr));
+    else
+      return PiostreamPtr(new GZSwapPiostream(in, filename, version, pr));
   }
 
-  if (pr) 
-    pr->error(filename + " is an unknown type!");
-  else 
-    std::cerr << filename << " is an unknown type!" << std::endl;
+  const std::string msg = "Text based compressed files are not supported.";
+  if (pr)
+    pr->error(msg);
+  else
+    std::cerr << "ERROR - " + msg << "\n";
   return PiostreamPtr();
 }
 
-
-
 } // End namespace SCIRun
-
-
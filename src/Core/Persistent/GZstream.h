@@ -27,8 +27,8 @@
 */
 
 ///
-///@file  Pstream.h
-///@brief reading/writing persistent objects
+///@file  GZstream.h
+///@brief reading/writing compressed persistent objects
 ///
 ///@author
 ///       Michael Callahan
@@ -41,13 +41,8 @@
 #define SCI_project_GZstream_h 1
 
 #include <Core/Persistent/Persistent.h>
-#include <stdio.h>
-
-#include <zlib.h>
-
-
-#include <iosfwd>
-
+#include <Core/Persistent/ChunkedGZip.h>
+#include <boost/shared_ptr.hpp>
 
 #include <Core/Persistent/share.h>
 
@@ -56,18 +51,24 @@ namespace SCIRun {
 
 class SCISHARE GZPiostream : public Piostream {
 protected:
-  gzFile fp_;
+  boost::shared_ptr<ChunkedGZipReader> in_;
+  boost::shared_ptr<ChunkedGZipWriter> out_;
+
+  bool readBytes(void* data, size_t size);
+  bool writeBytes(const void* data, size_t size);
 
   virtual const char *endianness();
   virtual void reset_post_header();
 private:
   template <class T> void gen_io(T&, const char *);
+  void readFileHeader();
 
 public:
   GZPiostream(const std::string& filename, Direction dir,
-                  const int& v = -1, ProgressReporter *pr = 0);
-  GZPiostream(int fd, Direction dir, const int& v = -1,
-                  ProgressReporter *pr = 0);
+                  const int& v = -1, Core::Logging::LoggerHandle pr = Core::Logging::LoggerHandle());
+  /// Reads through a reader that is already open, e.g. the one auto_gzistream probed.
+  GZPiostream(boost::shared_ptr<ChunkedGZipReader> in, const std::string& filename,
+                  const int& v = -1, Core::Logging::LoggerHandle pr = Core::Logging::LoggerHandle());
   virtual ~GZPiostream();
 
   virtual void io(char&);
@@ -98,9 +99,9 @@ private:
 
 public:
   GZSwapPiostream(const std::string& filename, Direction d,
-                      const int& v = -1, ProgressReporter *pr = 0);
-  GZSwapPiostream(int fd, Direction dir, const int& v = -1,
-                      ProgressReporter *pr = 0);
+                      const int& v = -1, Core::Logging::LoggerHandle pr = Core::Logging::LoggerHandle());
+  GZSwapPiostream(boost::shared_ptr<ChunkedGZipReader> in, const std::string& filename,
+                      const int& v = -1, Core::Logging::LoggerHandle pr = Core::Logging::LoggerHandle());
   virtual ~GZSwapPiostream();
 
   virtual void io(short&);
@@ -120,8 +121,8 @@ public:
 
 
 
-PiostreamPtr
-auto_gzistream(const std::string& filename, ProgressReporter *pr);
+SCISHARE PiostreamPtr
+auto_gzistream(const std::string& filename, Core::Logging::LoggerHandle pr);
 
 
 } // End namespace SCIRun
@@ -41,9 +41,7 @@
 #include <Core/Algorithms/Base/AlgorithmPreconditions.h>
 #include <Core/Persistent/Persistent.h>
 #include <Core/Persistent/Pstreams.h>
-#ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
 #include <Core/Persistent/GZstream.h>
-#endif
 
 #include <Core/Logging/ConsoleLogger.h>
 
@@ -391,12 +389,10 @@ Piostream::io(PersistentHandle& data, const PersistentTypeID& pid)
 PiostreamPtr
 auto_istream(const std::string& filename, LoggerHandle pr)
 {
-#ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
   if (filename.find(".gz") != std::string::npos)
   {
     return auto_gzistream(filename, pr);
   }
-#endif
 
   std::ifstream in(filename.c_str());
   if (!in)
@@ -479,6 +475,7 @@ auto_ostream(const std::string& filename, const std::string& type, LoggerHandle
   //     Binary:  Return a BinaryPiostream 
   //     Fast:    Return FastPiostream
   //     Text:    Return a TextPiostream
+  //     Compressed: Return a GZPiostream
   //     Default: Return BinaryPiostream 
   // NOTE: Binary will never return BinarySwap so we always write
   //       out the endianness of the machine we are on
@@ -495,6 +492,10 @@ auto_ostream(const std::string& filename, const std::string& type, LoggerHandle
   {
     stream = new FastPiostream(filename, Piostream::Write, pr);
   }
+  else if (type == "Compressed")
+  {
+    stream = new GZPiostream(filename, Piostream::Write, -1, pr);
+  }
   else
   {
     stream = new BinaryPiostream(filename, Piostream::Write, -1, pr);
@@ -0,0 +1,161 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+#include <Core/Persistent/ChunkedGZip.h>
+#include <boost/filesystem.hpp>
+
+using namespace SCIRun;
+
+namespace
+{
+  std::vector<double> testData(size_t n)
+  {
+    std::vector<double> data(n);
+    for (size_t i = 0; i < n; ++i)
+      data[i] = (i % 97) * 0.5 + i / 1000;
+    return data;
+  }
+
+  class TempFile
+  {
+  public:
+    TempFile() : path_(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("chunked_%%%%-%%%%.gz")) {}
+    ~TempFile() { boost::system::error_code ec; boost::filesystem::remove(path_, ec); }
+    std::string name() const { return path_.string(); }
+  private:
+    boost::filesystem::path path_;
+  };
+
+  const size_t SmallBlock = 4096;
+}
+
+TEST(ChunkedGZipTests, RoundTripAcrossManyBlocks)
+{
+  TempFile file;
+  auto data = testData(100000);
+  const size_t bytes = data.size() * sizeof(double);
+  {
+    ChunkedGZipWriter writer(file.name(), Z_DEFAULT_COMPRESSION, SmallBlock, 4);
+    ASSERT_TRUE(writer.isOpen());
+    // uneven writes straddle block and batch boundaries
+    EXPECT_TRUE(writer.write(&data[0], 1000));
+    EXPECT_TRUE(writer.write(reinterpret_cast<char*>(&data[0]) + 1000, bytes - 1000));
+    EXPECT_TRUE(writer.close());
+  }
+
+  ChunkedGZipReader reader(file.name(), 3);
+  ASSERT_TRUE(reader.isOpen());
+  EXPECT_TRUE(reader.isChunked());
+  EXPECT_EQ(bytes, reader.size());
+
+  std::vector<double> read(data.size());
+  EXPECT_EQ(bytes, reader.read(&read[0], bytes));
+  EXPECT_EQ(data, read);
+  EXPECT_FALSE(reader.error());
+
+  char extra;
+  EXPECT_EQ(0u, reader.read(&extra, 1));
+}
+
+TEST(ChunkedGZipTests, RandomAccessSeek)
+{
+  TempFile file;
+  auto data = testData(50000);
+  {
+    ChunkedGZipWriter writer(file.name(), 1, SmallBlock, 2);
+    writer.write(&data[0], data.size() * sizeof(double));
+  }
+
+  ChunkedGZipReader reader(file.name());
+  const size_t indices[] = { 40000, 7, 12345, 49999, 0, 20000 };
+  for (size_t i : indices)
+  {
+    ASSERT_TRUE(reader.seek(i * sizeof(double)));
+    double value;
+    EXPECT_EQ(sizeof(double), reader.read(&value, sizeof(double)));
+    EXPECT_EQ(data[i], value);
+    EXPECT_EQ((i + 1) * sizeof(double), reader.tell());
+  }
+  EXPECT_FALSE(reader.seek(reader.size() + 1));
+}
+
+TEST(ChunkedGZipTests, OutputIsStandardGzip)
+{
+  TempFile file;
+  auto data = testData(20000);
+  const size_t bytes = data.size() * sizeof(double);
+  {
+    ChunkedGZipWriter writer(file.name(), Z_DEFAULT_COMPRESSION, SmallBlock, 4);
+    writer.write(&data[0], bytes);
+  }
+
+  gzFile gz = gzopen(file.name().c_str(), "rb");
+  ASSERT_TRUE(gz != 0);
+  std::vector<double> read(data.size());
+  EXPECT_EQ(static_cast<int>(bytes), gzread(gz, &read[0], static_cast<unsigned int>(bytes)));
+  char extra;
+  EXPECT_EQ(0, gzread(gz, &extra, 1));
+  gzclose(gz);
+  EXPECT_EQ(data, read);
+}
+
+TEST(ChunkedGZipTests, CanReadPlainGzipFile)
+{
+  TempFile file;
+  auto data = testData(20000);
+  const size_t bytes = data.size() * sizeof(double);
+  {
+    gzFile gz = gzopen(file.name().c_str(), "wb");
+    ASSERT_TRUE(gz != 0);
+    gzwrite(gz, &data[0], static_cast<unsigned int>(bytes));
+    gzclose(gz);
+  }
+
+  ChunkedGZipReader reader(file.name());
+  ASSERT_TRUE(reader.isOpen());
+  EXPECT_FALSE(reader.isChunked());
+
+  std::vector<double> read(data.size());
+  ASSERT_TRUE(reader.seek(100 * sizeof(double)));
+  EXPECT_EQ(bytes - 100 * sizeof(double), reader.read(&read[100], bytes - 100 * sizeof(double)));
+  ASSERT_TRUE(reader.seek(0));
+  EXPECT_EQ(100 * sizeof(double), reader.read(&read[0], 100 * sizeof(double)));
+  EXPECT_EQ(data, read);
+}
+
+TEST(ChunkedGZipTests, EmptyOutputIsChunked)
+{
+  TempFile file;
+  {
+    ChunkedGZipWriter writer(file.name());
+  }
+  ChunkedGZipReader reader(file.name());
+  EXPECT_TRUE(reader.isChunked());
+  EXPECT_EQ(0u, reader.size());
+}
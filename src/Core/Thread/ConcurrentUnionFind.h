@@ -0,0 +1,97 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef CORE_THREAD_CONCURRENTUNIONFIND_H
+#define CORE_THREAD_CONCURRENTUNIONFIND_H
+
+#include <boost/noncopyable.hpp>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace SCIRun 
+{
+namespace Core
+{
+namespace Thread
+{
+  /// Disjoint sets over the indices [0,size) that can be joined from many
+  /// threads at once without locking. A root is always the smallest index
+  /// of its set, so the result of a parallel run does not depend on the
+  /// order in which the threads joined the sets.
+  template <class Index>
+  class ConcurrentUnionFind : public boost::noncopyable
+  {
+  public:
+    explicit ConcurrentUnionFind(size_t size) : parent_(new std::atomic<Index>[size])
+    {
+      for (size_t j = 0; j < size; j++) parent_[j].store(static_cast<Index>(j), std::memory_order_relaxed);
+    }
+
+    /// Root of the set containing e, halving the path on the way
+    Index find(Index e)
+    {
+      while (true)
+      {
+        Index p = parent_[e].load(std::memory_order_relaxed);
+        if (p == e) return e;
+        Index gp = parent_[p].load(std::memory_order_relaxed);
+        if (gp != p) parent_[e].compare_exchange_weak(p, gp, std::memory_order_relaxed);
+        e = gp;
+      }
+    }
+
+    /// Join the sets of a and b. The larger root is linked below the
+    /// smaller one, links only point to smaller indices and cannot cycle.
+    void unite(Index a, Index b)
+    {
+      while (true)
+      {
+        a = find(a);
+        b = find(b);
+        if (a == b) return;
+        if (a < b) std::swap(a, b);
+        Index expected = a;
+        if (parent_[a].compare_exchange_strong(expected, b)) return;
+      }
+    }
+
+    /// Only valid once no thread is joining sets anymore
+    bool is_root(Index e) const
+    {
+      return parent_[e].load(std::memory_order_relaxed) == e;
+    }
+
+  private:
+    std::unique_ptr<std::atomic<Index>[]> parent_;
+  };
+
+}}}
+
+#endif
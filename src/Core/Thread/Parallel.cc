@@ -29,10 +29,16 @@
 #include <Core/Thread/Parallel.h>
 
 #include <boost/thread/thread.hpp>
+#include <atomic>
 #include <vector>
 
 using namespace SCIRun::Core::Thread;
 
+namespace
+{
+  std::atomic<unsigned int> numCoresOverride(0);
+}
+
 void Parallel::RunTasks(IndexedTask task, int numProcs)
 {
   boost::thread_group threads;
@@ -55,5 +61,11 @@ void Parallel::RunTasks(IndexedTask task, int numProcs)
 
 unsigned int Parallel::NumCores()
 {
-  return boost::thread::hardware_concurrency();
+  const unsigned int numCores = numCoresOverride;
+  return numCores > 0 ? numCores : boost::thread::hardware_concurrency();
+}
+
+void Parallel::SetNumCores(unsigned int numCores)
+{
+  numCoresOverride = numCores;
 }
@@ -45,6 +45,9 @@ namespace Thread
     typedef boost::function<void(int)> IndexedTask;
     static void RunTasks(IndexedTask task, int numProcs);
     static unsigned int NumCores();
+    /// Override the value returned by NumCores(), so the threaded paths of
+    /// algorithms can be exercised on any machine. 0 restores the default.
+    static void SetNumCores(unsigned int numCores);
   };
 
 }}}
@@ -0,0 +1,131 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+#include <Core/Thread/ConcurrentUnionFind.h>
+#include <Core/Thread/Parallel.h>
+
+using namespace SCIRun::Core::Thread;
+
+namespace
+{
+  // Serial reference with the same smallest-root rule
+  class SerialUnionFind
+  {
+  public:
+    explicit SerialUnionFind(int size) : parent_(size)
+    {
+      for (int j = 0; j < size; j++) parent_[j] = j;
+    }
+    int find(int e) { while (parent_[e] != e) e = parent_[e]; return e; }
+    void unite(int a, int b)
+    {
+      a = find(a);
+      b = find(b);
+      if (a == b) return;
+      if (a < b) std::swap(a, b);
+      parent_[a] = b;
+    }
+  private:
+    std::vector<int> parent_;
+  };
+}
+
+TEST(ConcurrentUnionFindTests, RootIsTheSmallestIndexOfItsSet)
+{
+  ConcurrentUnionFind<int> sets(8);
+  sets.unite(5, 7);
+  sets.unite(7, 3);
+  sets.unite(6, 1);
+
+  EXPECT_EQ(3, sets.find(5));
+  EXPECT_EQ(3, sets.find(7));
+  EXPECT_EQ(1, sets.find(6));
+  EXPECT_EQ(0, sets.find(0));
+  EXPECT_TRUE(sets.is_root(3));
+  EXPECT_FALSE(sets.is_root(5));
+  EXPECT_FALSE(sets.is_root(7));
+
+  sets.unite(6, 5);
+  for (int e : { 1, 3, 5, 6, 7 })
+    EXPECT_EQ(1, sets.find(e));
+  EXPECT_EQ(2, sets.find(2));
+  EXPECT_EQ(4, sets.find(4));
+}
+
+TEST(ConcurrentUnionFindTests, ChainJoinedFromManyThreadsIsOneSet)
+{
+  const int size = 100000;
+  const int nproc = 4;
+  ConcurrentUnionFind<int> sets(size);
+
+  // Interleaved links, so the threads race on neighboring roots
+  Parallel::RunTasks([&](int proc)
+  {
+    for (int e = proc; e + 1 < size; e += nproc)
+      sets.unite(e + 1, e);
+  }, nproc);
+
+  int roots = 0;
+  for (int e = 0; e < size; e++)
+  {
+    EXPECT_EQ(0, sets.find(e));
+    if (sets.is_root(e)) roots++;
+  }
+  EXPECT_EQ(1, roots);
+}
+
+TEST(ConcurrentUnionFindTests, ThreadedUnionsMatchSerialUnions)
+{
+  const int size = 50000;
+  const int nproc = 4;
+  std::mt19937 rng(11);
+  std::uniform_int_distribution<int> pick(0, size - 1);
+  std::vector<std::pair<int, int> > pairs(size / 2);
+  for (auto& p : pairs)
+    p = std::make_pair(pick(rng), pick(rng));
+
+  SerialUnionFind reference(size);
+  for (const auto& p : pairs)
+    reference.unite(p.first, p.second);
+
+  ConcurrentUnionFind<int> sets(size);
+  Parallel::RunTasks([&](int proc)
+  {
+    for (size_t j = proc; j < pairs.size(); j += nproc)
+      sets.unite(pairs[j].first, pairs[j].second);
+  }, nproc);
+
+  for (int e = 0; e < size; e++)
+  {
+    ASSERT_EQ(reference.find(e), sets.find(e));
+    EXPECT_EQ(reference.find(e) == e, sets.is_root(e));
+  }
+}
@@ -48,6 +48,15 @@ TEST(ParallelTests, CanDoubleNumberInParallel)
   EXPECT_EQ(expectedSum * 2, std::accumulate(nums.begin(), nums.end(), 0, std::plus<int>()));
 }
 
+TEST(ParallelTests, NumCoresCanBeOverridden)
+{
+  const unsigned int hardware = Parallel::NumCores();
+  Parallel::SetNumCores(hardware + 3);
+  EXPECT_EQ(hardware + 3, Parallel::NumCores());
+  Parallel::SetNumCores(0);
+  EXPECT_EQ(hardware, Parallel::NumCores());
+}
+
 /// @todo
 #if 0
 TEST(ParallelTests, CanDoubleNumberWithParallelForEach)
@@ -38,6 +38,7 @@
 #include <Dataflow/Serialization/Network/NetworkXMLSerializer.h>
 #include <Dataflow/Serialization/Network/NetworkDescriptionSerialization.h>
 #include <Dataflow/Engine/Controller/DynamicPortManager.h>
+#include <Dataflow/Engine/Controller/ParameterSweep.h>
 #include <Core/Logging/Log.h>
 #include <Dataflow/Engine/Scheduler/BoostGraphParallelScheduler.h>
 #include <Dataflow/Engine/Scheduler/GraphNetworkAnalyzer.h>
@@ -73,7 +74,8 @@ NetworkEditorController::NetworkEditorController(ModuleFactoryHandle mf, ModuleS
   executorFactory_(executorFactory),
   cmdFactory_(cmdFactory),
   serializationManager_(nesm),
-  signalSwitch_(true)
+  signalSwitch_(true),
+  pythonApi_(true)
 {
   dynamicPortManager_.reset(new DynamicPortManager(connectionAdded_, connectionRemoved_, this));
 
@@ -86,17 +88,46 @@ NetworkEditorController::NetworkEditorController(ModuleFactoryHandle mf, ModuleS
 
 NetworkEditorController::NetworkEditorController(SCIRun::Dataflow::Networks::NetworkHandle network, ExecutionStrategyFactoryHandle executorFactory, NetworkEditorSerializationManager* nesm)
   : theNetwork_(network), executorFactory_(executorFactory), serializationManager_(nesm),
-  signalSwitch_(true)
+  signalSwitch_(true),
+  pythonApi_(true)
 {
 }
 
+NetworkEditorController::NetworkEditorController(const NetworkEditorController& other, CloneTag) :
+  theNetwork_(new Network(other.moduleFactory_, other.stateFactory_, other.algoFactory_, other.reexFactory_)),
+  moduleFactory_(other.moduleFactory_),
+  stateFactory_(other.stateFactory_),
+  algoFactory_(other.algoFactory_),
+  reexFactory_(other.reexFactory_),
+  executorFactory_(other.executorFactory_),
+  cmdFactory_(other.cmdFactory_),
+  serializationManager_(nullptr),
+  signalSwitch_(true),
+  pythonApi_(false)
+{
+  dynamicPortManager_.reset(new DynamicPortManager(connectionAdded_, connectionRemoved_, this));
+}
+
 NetworkEditorController::~NetworkEditorController()
 {
 #ifdef BUILD_WITH_PYTHON
-  NetworkEditorPythonAPI::clearImpl();
+  if (pythonApi_)
+    NetworkEditorPythonAPI::clearImpl();
 #endif
 }
 
+boost::shared_ptr<NetworkEditorController> NetworkEditorController::cloneNetwork(const NetworkFileHandle& xml) const
+{
+  boost::shared_ptr<NetworkEditorController> clone(new NetworkEditorController(*this, CloneTag()));
+  clone->loadNetwork(xml ? xml : saveNetwork());
+  return clone;
+}
+
+std::vector<SweepInstanceResult> NetworkEditorController::runParameterSweep(const ParameterSweepSpec& spec)
+{
+  return ParameterSweep(spec).run(*this);
+}
+
 namespace
 {
   class SnippetHandler
@@ -35,6 +35,7 @@
 #include <Core/Algorithms/Base/AlgorithmFwd.h>
 #include <Dataflow/Engine/Scheduler/SchedulerInterfaces.h>
 #include <Dataflow/Engine/Controller/ControllerInterfaces.h>
+#include <Dataflow/Engine/Controller/ParameterSweep.h>
 #include <Dataflow/Engine/Scheduler/ExecutionStrategy.h>
 #include <Dataflow/Network/ModuleFactory.h> // todo split out replacement impl types
 #include <Core/Command/CommandFactory.h>
@@ -116,6 +117,11 @@ namespace Engine {
 
     Networks::NetworkFileHandle serializeNetworkFragment(Networks::ModuleFilter modFilter, Networks::ConnectionFilter connFilter) const;
     void appendToNetwork(const Networks::NetworkFileHandle& xml);
+
+    /// A controller with the same factories holding a copy of the network (or of xml when given). The copy is
+    /// not registered with the Python API and has no serialization manager; it is used to run networks side by side.
+    boost::shared_ptr<NetworkEditorController> cloneNetwork(const Networks::NetworkFileHandle& xml = Networks::NetworkFileHandle()) const;
+    std::vector<SweepInstanceResult> runParameterSweep(const ParameterSweepSpec& spec);
 //////////////////////End: To be Pythonized///////////////////////////////
 //////////////////////////////////////////////////////////////////////////
 
@@ -159,6 +165,9 @@ namespace Engine {
     const Networks::ModuleFactory& moduleFactory() const { return *moduleFactory_; }  //TOOD: lazy
 
   private:
+    struct CloneTag {};
+    NetworkEditorController(const NetworkEditorController& other, CloneTag);
+
     void printNetwork() const;
     Networks::ModuleHandle addModuleImpl(const Networks::ModuleLookupInfo& info);
 
@@ -187,6 +196,7 @@ namespace Engine {
 
     boost::shared_ptr<DynamicPortManager> dynamicPortManager_;
     bool signalSwitch_;
+    bool pythonApi_;
     boost::shared_ptr<Networks::ReplacementImpl::ModuleReplacementFilter> replacementFilter_;
   };
 
@@ -0,0 +1,410 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Dataflow/Engine/Controller/ParameterSweep.h>
+#include <Dataflow/Engine/Controller/NetworkEditorController.h>
+#include <Dataflow/Engine/Scheduler/BoostGraphSerialScheduler.h>
+#include <Dataflow/Engine/Scheduler/SerialModuleExecutionOrder.h>
+#include <Dataflow/Network/ModuleInterface.h>
+#include <Dataflow/Network/ModuleStateInterface.h>
+#include <Dataflow/Network/NetworkInterface.h>
+#include <Dataflow/Network/ConnectionId.h>
+#include <Dataflow/Network/PortInterface.h>
+#include <Dataflow/Network/PortDataCache.h>
+#include <Core/Algorithms/Base/Option.h>
+#include <Core/Thread/Mutex.h>
+#include <Core/Thread/Parallel.h>
+#include <Core/Logging/Log.h>
+#include <Core/Utils/Exception.h>
+#include <boost/algorithm/string/replace.hpp>
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+
+using namespace SCIRun;
+using namespace SCIRun::Dataflow::Engine;
+using namespace SCIRun::Dataflow::Networks;
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Logging;
+using namespace SCIRun::Core::Thread;
+
+namespace
+{
+  void specError(size_t lineNumber, const std::string& message)
+  {
+    THROW_INVALID_ARGUMENT("Parameter sweep spec, line " + boost::lexical_cast<std::string>(lineNumber) + ": " + message);
+  }
+
+  bool validInstanceName(const std::string& name)
+  {
+    return !name.empty() && name != "." && name != ".." && name.find_first_of("/\\") == std::string::npos;
+  }
+
+  /// Converts the text of a sweep setting to the type the module state currently holds.
+  Variable::Value convertSetting(const Variable::Value& current, const SweepSetting& setting)
+  {
+    try
+    {
+      switch (current.which())
+      {
+      case 0:
+        return boost::lexical_cast<int>(setting.value);
+      case 1:
+        return boost::lexical_cast<double>(setting.value);
+      case 2:
+        return setting.value;
+      case 3:
+        if (setting.value == "true" || setting.value == "1")
+          return true;
+        if (setting.value == "false" || setting.value == "0")
+          return false;
+        break;
+      case 4:
+        {
+          auto option = boost::get<AlgoOption>(current);
+          if (option.options_.empty() || option.options_.count(setting.value) != 0)
+            return AlgoOption(setting.value, option.options_);
+        }
+        break;
+      default:
+        THROW_INVALID_ARGUMENT("State " + setting.moduleId + "::" + setting.stateKey + " holds a list, which cannot be swept.");
+      }
+    }
+    catch (boost::bad_lexical_cast&)
+    {
+    }
+    THROW_INVALID_ARGUMENT("Invalid value '" + setting.value + "' for state " + setting.moduleId + "::" + setting.stateKey);
+  }
+
+  void applySetting(const NetworkInterface& network, const SweepSetting& setting)
+  {
+    auto module = network.lookupModule(ModuleId(setting.moduleId));
+    if (!module)
+      THROW_INVALID_ARGUMENT("Module " + setting.moduleId + " is not in the network.");
+    auto state = module->get_state();
+    const AlgorithmParameterName key(setting.stateKey);
+    if (!state || !state->containsKey(key))
+      THROW_INVALID_ARGUMENT("Module " + setting.moduleId + " has no state value " + setting.stateKey);
+    state->setValue(key, convertSetting(state->getValue(key).value(), setting));
+  }
+
+  OutputPortHandle outputPort(const ModuleHandle& module, size_t index)
+  {
+    for (const auto& port : module->outputPorts())
+      if (port->getIndex() == index)
+        return port;
+    return OutputPortHandle();
+  }
+
+  bool hasAllOutputs(const ModuleHandle& module)
+  {
+    for (const auto& port : module->outputPorts())
+      if (!port->hasData())
+        return false;
+    return true;
+  }
+
+  /// Swept modules and everything downstream of them.
+  std::set<std::string> affectedModules(const NetworkInterface& network, const std::set<std::string>& swept)
+  {
+    std::multimap<std::string, std::string> downstream;
+    for (const auto& cxn : network.connections())
+      downstream.insert(std::make_pair(cxn.out_.moduleId_.id_, cxn.in_.moduleId_.id_));
+
+    std::set<std::string> affected(swept);
+    std::vector<std::string> todo(swept.begin(), swept.end());
+    while (!todo.empty())
+    {
+      auto id = todo.back();
+      todo.pop_back();
+      auto range = downstream.equal_range(id);
+      for (auto iter = range.first; iter != range.second; ++iter)
+        if (affected.insert(iter->second).second)
+          todo.push_back(iter->second);
+    }
+    return affected;
+  }
+}
+
+ParameterSweepSpec ParameterSweepSpec::read(const boost::filesystem::path& file)
+{
+  std::ifstream in(file.string().c_str());
+  if (!in)
+    THROW_INVALID_ARGUMENT("Could not open parameter sweep spec " + file.string());
+  std::ostringstream text;
+  text << in.rdbuf();
+  return parse(text.str(), file.parent_path());
+}
+
+ParameterSweepSpec ParameterSweepSpec::parse(const std::string& text, const boost::filesystem::path& baseDirectory)
+{
+  ParameterSweepSpec spec;
+  spec.outputDirectory = baseDirectory / "sweep_output";
+  std::set<std::string> names;
+
+  std::istringstream lines(text);
+  std::string line;
+  size_t lineNumber = 0;
+  while (std::getline(lines, line))
+  {
+    ++lineNumber;
+    boost::algorithm::trim(line);
+    if (line.empty() || line[0] == '#')
+      continue;
+
+    std::istringstream fields(line);
+    std::string directive;
+    fields >> directive;
+    if (directive == "output_dir")
+    {
+      std::string dir;
+      std::getline(fields, dir);
+      boost::algorithm::trim(dir);
+      if (dir.empty())
+        specError(lineNumber, "output_dir needs a directory");
+      boost::filesystem::path path(dir);
+      spec.outputDirectory = path.is_absolute() ? path : baseDirectory / path;
+    }
+    else if (directive == "max_concurrent")
+    {
+      if (!(fields >> spec.maxConcurrent) || spec.maxConcurrent < 1)
+        specError(lineNumber, "max_concurrent needs a positive number");
+    }
+    else if (directive == "output")
+    {
+      std::string id;
+      if (!(fields >> id))
+        specError(lineNumber, "output needs a module id");
+      spec.outputModules.push_back(id);
+    }
+    else if (directive == "instance")
+    {
+      SweepInstance instance;
+      if (!(fields >> instance.name) || !validInstanceName(instance.name))
+        specError(lineNumber, "instance needs a name that can be used as a directory name");
+      if (!names.insert(instance.name).second)
+        specError(lineNumber, "duplicate instance name " + instance.name);
+      spec.instances.push_back(instance);
+    }
+    else if (directive == "set")
+    {
+      if (spec.instances.empty())
+        specError(lineNumber, "set before the first instance");
+      SweepSetting setting;
+      fields >> setting.moduleId >> setting.stateKey;
+      std::getline(fields, setting.value);
+      boost::algorithm::trim(setting.value);
+      if (setting.value.empty())
+        specError(lineNumber, "set needs a module id, a state key and a value");
+      spec.instances.back().settings.push_back(setting);
+    }
+    else
+    {
+      specError(lineNumber, "unknown directive " + directive);
+    }
+  }
+
+  if (spec.instances.empty())
+    THROW_INVALID_ARGUMENT("Parameter sweep spec has no instances.");
+  return spec;
+}
+
+ParameterSweep::ParameterSweep(const ParameterSweepSpec& spec) : spec_(spec)
+{
+}
+
+std::vector<SweepInstanceResult> ParameterSweep::run(NetworkEditorController& controller) const
+{
+  auto base = controller.getNetwork();
+  ENSURE_NOT_NULL(base, "network");
+
+  const auto xml = controller.saveNetwork();
+  return run(base, [&controller, xml]()
+  {
+    // the copy's controller owns its network, keep it alive with the handle
+    auto clone = controller.cloneNetwork(xml);
+    return NetworkHandle(clone, clone->getNetwork().get());
+  });
+}
+
+std::vector<SweepInstanceResult> ParameterSweep::run(NetworkHandle base, const NetworkCloner& cloneNetwork) const
+{
+  ENSURE_NOT_NULL(base, "network");
+
+  std::set<std::string> swept;
+  for (const auto& instance : spec_.instances)
+    for (const auto& setting : instance.settings)
+      swept.insert(setting.moduleId);
+  for (const auto& id : swept)
+    if (!base->lookupModule(ModuleId(id)))
+      THROW_INVALID_ARGUMENT("Swept module " + id + " is not in the network.");
+
+  const auto affected = affectedModules(*base, swept);
+  const auto order = BoostGraphSerialScheduler().schedule(*base);
+
+  std::vector<std::string> outputs(spec_.outputModules);
+  if (outputs.empty())
+    outputs.assign(swept.begin(), swept.end());
+
+  // The part of the network the sweep does not touch runs once, here. Its outputs are then
+  // shared by every instance. Outputs left from an earlier run are reused unless the module
+  // needs to execute, or something upstream of it just did.
+  std::multimap<std::string, std::string> upstream;
+  for (const auto& cxn : base->connections())
+    upstream.insert(std::make_pair(cxn.in_.moduleId_.id_, cxn.out_.moduleId_.id_));
+  std::set<std::string> executed;
+  for (const auto& id : order)
+  {
+    auto module = base->lookupModule(id);
+    if (!module || affected.count(id.id_) != 0 || module->outputPorts().empty())
+      continue;
+    bool upstreamExecuted = false;
+    auto range = upstream.equal_range(id.id_);
+    for (auto iter = range.first; iter != range.second; ++iter)
+      upstreamExecuted = upstreamExecuted || executed.count(iter->second) != 0;
+    if (!upstreamExecuted && hasAllOutputs(module) && !module->needToExecute())
+      continue;
+    module->do_execute();
+    executed.insert(id.id_);
+    if (!hasAllOutputs(module))
+      Log::get() << WARN << "Parameter sweep: " << id.id_ << " did not produce all outputs, its downstream modules may fail." << std::endl;
+  }
+
+  std::vector<std::pair<ModuleId, std::vector<OutputPortHandle>>> shared;
+  for (size_t i = 0; i < base->nmodules(); ++i)
+  {
+    auto module = base->module(i);
+    if (affected.count(module->get_id().id_) == 0)
+      shared.push_back(std::make_pair(module->get_id(), module->outputPorts()));
+  }
+
+  Mutex cloneLock("ParameterSweep clone");
+  std::vector<SweepInstanceResult> results(spec_.instances.size());
+
+  auto runInstance = [&](size_t index)
+  {
+    const auto& instance = spec_.instances[index];
+    auto& result = results[index];
+    result.name = instance.name;
+    try
+    {
+      NetworkHandle network;
+      {
+        Guard g(cloneLock.get());
+        network = cloneNetwork();
+      }
+      ENSURE_NOT_NULL(network, "network copy");
+
+      for (const auto& setting : instance.settings)
+        applySetting(*network, setting);
+
+      for (const auto& module : shared)
+      {
+        auto copy = network->lookupModule(module.first);
+        if (!copy)
+          continue;
+        for (const auto& port : module.second)
+        {
+          auto data = port->getData();
+          auto copyPort = data ? outputPort(copy, port->getIndex()) : OutputPortHandle();
+          if (copyPort)
+            copyPort->sendData(data);
+        }
+      }
+
+      for (const auto& id : order)
+      {
+        if (affected.count(id.id_) == 0)
+          continue;
+        auto module = network->lookupModule(id);
+        if (module)
+          module->do_execute();
+      }
+
+      if (network->errorCode() > 0)
+      {
+        result.message = boost::lexical_cast<std::string>(network->errorCode()) + " module errors";
+        return;
+      }
+
+      const auto dir = spec_.outputDirectory / instance.name;
+      boost::filesystem::create_directories(dir);
+      for (const auto& id : outputs)
+      {
+        auto module = network->lookupModule(ModuleId(id));
+        if (!module)
+          continue;
+        for (const auto& port : module->outputPorts())
+        {
+          auto data = port->hasData() ? port->getData() : DatatypeHandle();
+          const auto ext = PortDataCache::fileExtension(data);
+          if (ext.empty())
+            continue;
+          auto file = dir / (boost::replace_all_copy(id, ":", "_") + "_" + boost::lexical_cast<std::string>(port->getIndex()) + ext);
+          if (!PortDataCache::writeDataFile(file, data))
+            THROW_INVALID_ARGUMENT("Could not write " + file.string());
+          result.files.push_back(file);
+        }
+      }
+      result.succeeded = true;
+    }
+    catch (Core::ExceptionBase& e)
+    {
+      result.message = e.what();
+    }
+    catch (std::exception& e)
+    {
+      result.message = e.what();
+    }
+  };
+
+  const int maxConcurrent = spec_.maxConcurrent > 0 ? spec_.maxConcurrent : static_cast<int>(Parallel::NumCores());
+  const int numTasks = std::max(1, std::min(maxConcurrent, static_cast<int>(spec_.instances.size())));
+  std::atomic<size_t> next(0);
+  Parallel::RunTasks([&](int)
+  {
+    for (size_t i = next++; i < spec_.instances.size(); i = next++)
+      runInstance(i);
+  }, numTasks);
+
+  for (const auto& result : results)
+  {
+    if (result.succeeded)
+      Log::get() << INFO << "Parameter sweep instance " << result.name << " done, " << result.files.size() << " files written." << std::endl;
+    else
+      Log::get() << ERROR_LOG << "Parameter sweep instance " << result.name << " failed: " << result.message << std::endl;
+  }
+  return results;
+}
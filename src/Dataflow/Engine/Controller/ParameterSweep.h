@@ -0,0 +1,116 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef ENGINE_NETWORK_PARAMETERSWEEP_H
+#define ENGINE_NETWORK_PARAMETERSWEEP_H
+
+#include <Dataflow/Network/NetworkFwd.h>
+#include <boost/filesystem/path.hpp>
+#include <boost/function.hpp>
+#include <string>
+#include <vector>
+#include <Dataflow/Engine/Controller/share.h>
+
+namespace SCIRun {
+namespace Dataflow {
+namespace Engine {
+
+  class NetworkEditorController;
+
+  /// One module state value changed in a sweep instance. The value is kept as text and converted to the
+  /// type of the module's current value when applied.
+  struct SCISHARE SweepSetting
+  {
+    std::string moduleId;
+    std::string stateKey;
+    std::string value;
+  };
+
+  struct SCISHARE SweepInstance
+  {
+    std::string name;
+    std::vector<SweepSetting> settings;
+  };
+
+  /// Sweep specification file, one directive per line, '#' starts a comment:
+  ///
+  ///   output_dir <directory>          where per-instance results go, relative to the spec file
+  ///   max_concurrent <n>              instances run at once, default is the number of cores
+  ///   output <module id>              module whose outputs are written, default is every swept module
+  ///   instance <name>                 starts a new instance
+  ///   set <module id> <key> <value>   state value of the current instance, the value runs to end of line
+  struct SCISHARE ParameterSweepSpec
+  {
+    ParameterSweepSpec() : maxConcurrent(0) {}
+
+    std::vector<SweepInstance> instances;
+    std::vector<std::string> outputModules;
+    boost::filesystem::path outputDirectory;
+    int maxConcurrent;
+
+    /// Throws InvalidArgumentException on syntax errors.
+    static ParameterSweepSpec read(const boost::filesystem::path& file);
+    static ParameterSweepSpec parse(const std::string& text, const boost::filesystem::path& baseDirectory);
+  };
+
+  struct SCISHARE SweepInstanceResult
+  {
+    SweepInstanceResult() : succeeded(false) {}
+    std::string name;
+    bool succeeded;
+    std::string message;
+    std::vector<boost::filesystem::path> files;
+  };
+
+  /// Runs every instance of a sweep on its own copy of the controller's network, a bounded number at a
+  /// time. Modules that no instance changes, and that are not downstream of a changed module, run once
+  /// in the original network; their outputs are handed to every copy as shared handles, so only the
+  /// swept part of the network executes per instance. The outputs of each instance are written to
+  /// <output_dir>/<instance name>/ in binary Pio format.
+  ///
+  /// A module of the unchanged part is only run again when it lacks outputs, needs to execute, e.g.
+  /// after a state change, or is downstream of a module that ran. The shared handles are not copied:
+  /// as everywhere in the dataflow, modules must treat their inputs as read-only, since every instance
+  /// and the original network see the same objects at the same time.
+  class SCISHARE ParameterSweep
+  {
+  public:
+    /// Returns an independent copy of the swept network; whatever owns it stays alive for as long as
+    /// the handle is held. Calls are serialized.
+    typedef boost::function<Networks::NetworkHandle()> NetworkCloner;
+
+    explicit ParameterSweep(const ParameterSweepSpec& spec);
+    std::vector<SweepInstanceResult> run(NetworkEditorController& controller) const;
+    std::vector<SweepInstanceResult> run(Networks::NetworkHandle base, const NetworkCloner& cloneNetwork) const;
+  private:
+    ParameterSweepSpec spec_;
+  };
+
+}}}
+
+#endif
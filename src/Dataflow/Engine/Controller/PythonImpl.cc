@@ -34,6 +34,7 @@
 #include <Dataflow/Network/ModuleInterface.h>
 #include <Dataflow/Network/NetworkInterface.h>
 #include <Dataflow/Network/ModuleDescription.h>
+#include <Dataflow/Network/ModuleExecutionProfile.h>
 #include <Dataflow/Network/PortInterface.h>
 #include <Dataflow/Serialization/Network/NetworkDescriptionSerialization.h>
 #include <Core/Algorithms/Base/AlgorithmBase.h>
@@ -49,6 +50,7 @@
 #include <boost/range/algorithm/copy.hpp>
 #include <boost/range/adaptor/transformed.hpp>
 #include <Core/Python/PythonDatatypeConverter.h>
+#include <fstream>
 
 using namespace SCIRun;
 using namespace SCIRun::Core::Algorithms;
@@ -469,6 +471,30 @@ namespace
       return "[null module]";
     }
 
+    virtual boost::python::object profile() const override
+    {
+      boost::python::list records;
+      if (module_)
+      {
+        for (const auto& r : module_->executionProfile().records())
+        {
+          boost::python::dict record;
+          record["start_us"] = r.startMicroseconds;
+          record["wall_seconds"] = r.wallSeconds;
+          record["cpu_seconds"] = r.cpuSeconds;
+          record["heap_delta_bytes"] = r.heapBytesDelta;
+          record["peak_resident_bytes"] = r.peakResidentBytes;
+          record["peak_resident_increase_bytes"] = r.peakResidentIncrease;
+          record["input_bytes"] = r.inputBytes;
+          record["output_bytes"] = r.outputBytes;
+          record["skipped"] = r.skipped;
+          record["succeeded"] = r.succeeded;
+          records.append(record);
+        }
+      }
+      return records;
+    }
+
     virtual boost::shared_ptr<PyPorts> output() override
     {
       return output_;
@@ -729,6 +755,37 @@ std::string PythonImpl::importNetwork(const std::string& filename)
   //TODO: provide more informative python return value string
 }
 
+std::string PythonImpl::runParameterSweep(const std::string& specFile)
+{
+  try
+  {
+    auto results = nec_.runParameterSweep(ParameterSweepSpec::read(specFile));
+    auto succeeded = std::count_if(results.begin(), results.end(), [](const SweepInstanceResult& r) { return r.succeeded; });
+    return std::to_string(succeeded) + " of " + std::to_string(results.size()) + " sweep instances succeeded";
+  }
+  catch (SCIRun::Core::ExceptionBase& e)
+  {
+    return std::string("Parameter sweep failed: ") + e.what();
+  }
+}
+
+std::string PythonImpl::exportExecutionProfile(const std::string& filename, const std::string& format)
+{
+  if (format != "csv" && format != "trace")
+    return "Unknown profile format " + format + ", use csv or trace";
+
+  std::ofstream out(filename.c_str());
+  if (!out)
+    return "Could not open " + filename;
+
+  auto records = ModuleExecutionProfile::collect(*nec_.getNetwork());
+  if (format == "csv")
+    ModuleExecutionProfile::writeCsv(out, records);
+  else
+    ModuleExecutionProfile::writeTraceEvents(out, records);
+  return std::to_string(records.size()) + " module executions written to " + filename;
+}
+
 std::string PythonImpl::quit(bool force)
 {
   if (force)
@@ -60,6 +60,8 @@ namespace Engine {
     virtual std::string saveNetwork(const std::string& filename) override;
     virtual std::string loadNetwork(const std::string& filename) override;
     virtual std::string importNetwork(const std::string& filename) override;
+    virtual std::string runParameterSweep(const std::string& specFile) override;
+    virtual std::string exportExecutionProfile(const std::string& filename, const std::string& format) override;
     virtual std::string quit(bool force) override;
     virtual void setUnlockFunc(boost::function<void()> unlock) override;
   private:
@@ -0,0 +1,303 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+#include <Dataflow/Engine/Controller/ParameterSweep.h>
+#include <Dataflow/Network/ConnectionId.h>
+#include <Dataflow/Network/Tests/MockNetwork.h>
+#include <Dataflow/Network/Tests/MockModule.h>
+#include <Dataflow/Network/Tests/MockModuleState.h>
+#include <Dataflow/Network/Tests/MockPorts.h>
+#include <Core/Datatypes/DenseMatrix.h>
+#include <Core/Thread/Mutex.h>
+#include <Core/Utils/Exception.h>
+#include <boost/filesystem.hpp>
+
+using namespace SCIRun;
+using namespace SCIRun::Dataflow::Engine;
+using namespace SCIRun::Dataflow::Networks;
+using namespace SCIRun::Dataflow::Networks::Mocks;
+using namespace SCIRun::Core;
+using namespace SCIRun::Core::Datatypes;
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::NiceMock;
+using ::testing::Return;
+
+TEST(ParameterSweepSpecTests, ParsesInstancesAndSettings)
+{
+  const std::string text =
+    "# scalp conductivity sweep\n"
+    "output_dir results\n"
+    "max_concurrent 2\n"
+    "output SolveLinearSystem:0\n"
+    "\n"
+    "instance scalp_033\n"
+    "set BuildFEMatrix:0 Conductivity 0.33\n"
+    "set WriteField:0 Filename /tmp/out put.fld\n"
+    "instance scalp_050\n"
+    "  set BuildFEMatrix:0 Conductivity 0.5  \n";
+
+  auto spec = ParameterSweepSpec::parse(text, "/data/study");
+
+  EXPECT_EQ(boost::filesystem::path("/data/study/results"), spec.outputDirectory);
+  EXPECT_EQ(2, spec.maxConcurrent);
+  ASSERT_EQ(1u, spec.outputModules.size());
+  EXPECT_EQ("SolveLinearSystem:0", spec.outputModules[0]);
+
+  ASSERT_EQ(2u, spec.instances.size());
+  EXPECT_EQ("scalp_033", spec.instances[0].name);
+  ASSERT_EQ(2u, spec.instances[0].settings.size());
+  EXPECT_EQ("BuildFEMatrix:0", spec.instances[0].settings[0].moduleId);
+  EXPECT_EQ("Conductivity", spec.instances[0].settings[0].stateKey);
+  EXPECT_EQ("0.33", spec.instances[0].settings[0].value);
+  EXPECT_EQ("/tmp/out put.fld", spec.instances[0].settings[1].value);
+  EXPECT_EQ("scalp_050", spec.instances[1].name);
+  ASSERT_EQ(1u, spec.instances[1].settings.size());
+  EXPECT_EQ("0.5", spec.instances[1].settings[0].value);
+}
+
+TEST(ParameterSweepSpecTests, DefaultsToOutputDirectoryNextToSpec)
+{
+  auto spec = ParameterSweepSpec::parse("instance a\n", "/data/study");
+  EXPECT_EQ(boost::filesystem::path("/data/study/sweep_output"), spec.outputDirectory);
+  EXPECT_EQ(0, spec.maxConcurrent);
+  EXPECT_TRUE(spec.outputModules.empty());
+  EXPECT_TRUE(spec.instances[0].settings.empty());
+}
+
+TEST(ParameterSweepSpecTests, RejectsInvalidSpecs)
+{
+  EXPECT_THROW(ParameterSweepSpec::parse("", "."), InvalidArgumentException);
+  EXPECT_THROW(ParameterSweepSpec::parse("set A:0 B 1\ninstance a\n", "."), InvalidArgumentException);
+  EXPECT_THROW(ParameterSweepSpec::parse("instance a\ninstance a\n", "."), InvalidArgumentException);
+  EXPECT_THROW(ParameterSweepSpec::parse("instance ../a\n", "."), InvalidArgumentException);
+  EXPECT_THROW(ParameterSweepSpec::parse("instance a\nset A:0 B\n", "."), InvalidArgumentException);
+  EXPECT_THROW(ParameterSweepSpec::parse("instance a\nmax_concurrent 0\n", "."), InvalidArgumentException);
+  EXPECT_THROW(ParameterSweepSpec::parse("instance a\nrepeat 3\n", "."), InvalidArgumentException);
+}
+
+namespace
+{
+  typedef boost::shared_ptr<NiceMock<MockModule>> ModulePtr;
+  typedef boost::shared_ptr<NiceMock<MockOutputPort>> PortPtr;
+
+  /// Reader:0 -> Source:0 -> Solver:0, where the sweep changes the Conductivity of Solver:0.
+  /// Modules with data on their output port count as having run.
+  struct ChainNetwork
+  {
+    ChainNetwork() : network(new NiceMock<MockNetwork>), state(new NiceMock<MockModuleState>),
+      conductivity(0.33), solverRuns(0)
+    {
+      const char* ids[] = { "Reader:0", "Source:0", "Solver:0" };
+      for (int i = 0; i < 3; ++i)
+      {
+        ModulePtr module(new NiceMock<MockModule>);
+        PortPtr port(new NiceMock<MockOutputPort>);
+        const ModuleId id(ids[i]);
+        ON_CALL(*module, get_id()).WillByDefault(Return(id));
+        ON_CALL(*module, outputPorts()).WillByDefault(Return(std::vector<OutputPortHandle>(1, port)));
+        ON_CALL(*module, needToExecute()).WillByDefault(Return(false));
+        ON_CALL(*port, getIndex()).WillByDefault(Return(0));
+        OutputPortInterface* p = port.get();
+        ON_CALL(*port, hasData()).WillByDefault(Invoke([p, this]() { return !!dataOn(p); }));
+        ON_CALL(*port, getData()).WillByDefault(Invoke([p, this]() { return dataOn(p); }));
+        ON_CALL(*port, sendData(_)).WillByDefault(Invoke([p, this](DatatypeHandle d) { data[p] = d; }));
+        ON_CALL(*network, module(i)).WillByDefault(Return(module));
+        ON_CALL(*network, lookupModule(id)).WillByDefault(Return(module));
+        modules.push_back(module);
+        ports.push_back(port);
+      }
+      ON_CALL(*network, nmodules()).WillByDefault(Return(3));
+      NetworkInterface::ConnectionDescriptionList connections;
+      for (int i = 0; i < 2; ++i)
+      {
+        connections.push_back(ConnectionDescription(
+          OutgoingConnectionDescription(ModuleId(ids[i]), PortId(0, "out")),
+          IncomingConnectionDescription(ModuleId(ids[i+1]), PortId(0, "in"))));
+      }
+      ON_CALL(*network, connections()).WillByDefault(Return(connections));
+
+      const ModuleStateInterface::Name key("Conductivity");
+      ON_CALL(*modules[2], get_state()).WillByDefault(Return(state));
+      ON_CALL(*state, containsKey(key)).WillByDefault(Return(true));
+      ON_CALL(*state, getValue(key)).WillByDefault(Invoke([this, key](const ModuleStateInterface::Name&)
+      {
+        return ModuleStateInterface::Value(key, conductivity);
+      }));
+      ON_CALL(*state, setValue(key, _)).WillByDefault(Invoke([this](const ModuleStateInterface::Name&, const Algorithms::Variable::Value& value)
+      {
+        conductivity = boost::get<double>(value);
+      }));
+
+      for (int i = 0; i < 3; ++i)
+      {
+        ON_CALL(*modules[i], do_execute()).WillByDefault(Invoke([this, i]()
+        {
+          DenseMatrixHandle m(new DenseMatrix(1, 1, i == 2 ? conductivity : i));
+          ports[i]->sendData(m);
+          if (i == 2)
+            ++solverRuns;
+          return true;
+        }));
+      }
+    }
+
+    DatatypeHandle dataOn(OutputPortInterface* port) const
+    {
+      auto iter = data.find(port);
+      return iter != data.end() ? iter->second : DatatypeHandle();
+    }
+
+    ModulePtr reader() const { return modules[0]; }
+    ModulePtr source() const { return modules[1]; }
+    ModulePtr solver() const { return modules[2]; }
+
+    boost::shared_ptr<NiceMock<MockNetwork>> network;
+    std::vector<ModulePtr> modules;
+    std::vector<PortPtr> ports;
+    boost::shared_ptr<NiceMock<MockModuleState>> state;
+    std::map<OutputPortInterface*, DatatypeHandle> data;
+    double conductivity;
+    int solverRuns;
+  };
+
+  const char* SWEEP =
+    "max_concurrent 2\n"
+    "instance a\nset Solver:0 Conductivity 0.25\n"
+    "instance b\nset Solver:0 Conductivity 0.5\n"
+    "instance c\nset Solver:0 Conductivity 1\n"
+    "instance d\nset Solver:0 Conductivity 2\n";
+}
+
+class ParameterSweepTests : public ::testing::Test
+{
+protected:
+  ParameterSweepTests() : lock_("ParameterSweepTests") {}
+
+  virtual void SetUp()
+  {
+    dir_ = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("scirun_sweep_test_%%%%-%%%%");
+  }
+
+  virtual void TearDown()
+  {
+    boost::system::error_code ec;
+    boost::filesystem::remove_all(dir_, ec);
+  }
+
+  ParameterSweepSpec spec() const
+  {
+    return ParameterSweepSpec::parse(SWEEP, dir_);
+  }
+
+  /// Every copy is a new network with fresh modules, as cloning a real network gives.
+  ParameterSweep::NetworkCloner cloner()
+  {
+    return [this]()
+    {
+      Core::Thread::Guard g(lock_.get());
+      boost::shared_ptr<ChainNetwork> copy(new ChainNetwork);
+      copies_.push_back(copy);
+      return NetworkHandle(copy, copy->network.get());
+    };
+  }
+
+  boost::filesystem::path dir_;
+  Core::Thread::Mutex lock_;
+  std::vector<boost::shared_ptr<ChainNetwork>> copies_;
+};
+
+TEST_F(ParameterSweepTests, RunsSweptModulesOnCopiesWithSharedUpstreamOutputs)
+{
+  ChainNetwork base;
+  EXPECT_CALL(*base.reader(), do_execute()).Times(1);
+  EXPECT_CALL(*base.source(), do_execute()).Times(1);
+  EXPECT_CALL(*base.solver(), do_execute()).Times(0);
+
+  auto results = ParameterSweep(spec()).run(base.network, cloner());
+
+  ASSERT_EQ(4u, results.size());
+  ASSERT_EQ(4u, copies_.size());
+  const auto sourceData = base.ports[1]->getData();
+  ASSERT_TRUE(sourceData != nullptr);
+
+  std::set<double> conductivities;
+  for (const auto& copy : copies_)
+  {
+    // the copy only runs the solver, on the very handle the original network made
+    EXPECT_EQ(1, copy->solverRuns);
+    EXPECT_EQ(sourceData.get(), copy->ports[1]->getData().get());
+    EXPECT_EQ(base.ports[0]->getData().get(), copy->ports[0]->getData().get());
+    conductivities.insert(copy->conductivity);
+  }
+  EXPECT_EQ((std::set<double>{ 0.25, 0.5, 1, 2 }), conductivities);
+  EXPECT_DOUBLE_EQ(0.33, base.conductivity);
+
+  for (const auto& result : results)
+  {
+    EXPECT_TRUE(result.succeeded) << result.message;
+    ASSERT_EQ(1u, result.files.size());
+    EXPECT_TRUE(boost::filesystem::exists(result.files[0]));
+    EXPECT_EQ(dir_ / "sweep_output" / result.name, result.files[0].parent_path());
+  }
+}
+
+TEST_F(ParameterSweepTests, ReusesUpstreamOutputsOfEarlierRuns)
+{
+  ChainNetwork base;
+  base.reader()->do_execute();
+  base.source()->do_execute();
+  EXPECT_CALL(*base.reader(), do_execute()).Times(0);
+  EXPECT_CALL(*base.source(), do_execute()).Times(0);
+
+  auto results = ParameterSweep(spec()).run(base.network, cloner());
+  for (const auto& result : results)
+    EXPECT_TRUE(result.succeeded) << result.message;
+}
+
+TEST_F(ParameterSweepTests, RerunsUpstreamModulesWhoseStateChanged)
+{
+  ChainNetwork base;
+  base.reader()->do_execute();
+  base.source()->do_execute();
+  const auto stale = base.ports[1]->getData();
+
+  // The reader's state was edited after its last run, so it and everything
+  // below it must run again before its outputs are shared.
+  ON_CALL(*base.reader(), needToExecute()).WillByDefault(Return(true));
+  EXPECT_CALL(*base.reader(), do_execute()).Times(1);
+  EXPECT_CALL(*base.source(), do_execute()).Times(1);
+
+  auto results = ParameterSweep(spec()).run(base.network, cloner());
+  for (const auto& result : results)
+    EXPECT_TRUE(result.succeeded) << result.message;
+  EXPECT_NE(stale.get(), base.ports[1]->getData().get());
+  for (const auto& copy : copies_)
+    EXPECT_EQ(base.ports[1]->getData().get(), copy->ports[1]->getData().get());
+}
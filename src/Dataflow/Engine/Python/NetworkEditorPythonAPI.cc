@@ -199,6 +199,28 @@ std::string NetworkEditorPythonAPI::importNetwork(const std::string& filename)
   }
 }
 
+std::string NetworkEditorPythonAPI::runParameterSweep(const std::string& specFile)
+{
+  Guard g(pythonLock_.get());
+  if (impl_)
+    return impl_->runParameterSweep(specFile);
+  else
+  {
+    return "Null implementation: NetworkEditorPythonAPI::runParameterSweep()";
+  }
+}
+
+std::string NetworkEditorPythonAPI::exportExecutionProfile(const std::string& filename, const std::string& format)
+{
+  Guard g(pythonLock_.get());
+  if (impl_)
+    return impl_->exportExecutionProfile(filename, format);
+  else
+  {
+    return "Null implementation: NetworkEditorPythonAPI::exportExecutionProfile()";
+  }
+}
+
 std::string NetworkEditorPythonAPI::quit(bool force)
 {
   Guard g(pythonLock_.get());
@@ -263,6 +285,15 @@ std::string NetworkEditorPythonAPI::scirun_dump_module_state(const std::string&
   return "Module not found";
 }
 
+boost::python::object NetworkEditorPythonAPI::scirun_get_module_profile(const std::string& moduleId)
+{
+  Guard g(pythonLock_.get());
+  auto module = impl_->findModule(moduleId);
+  if (module)
+    return module->profile();
+  return boost::python::object();
+}
+
 /// @todo: bizarre reason for this return type and casting. but it works.
 boost::shared_ptr<PyPort> SCIRun::operator>>(const PyPort& from, const PyPort& to)
 {
@@ -56,6 +56,7 @@ namespace SCIRun {
     static boost::python::object scirun_get_module_state(const std::string& moduleId, const std::string& stateVariable);
     static std::string scirun_set_module_state(const std::string& moduleId, const std::string& stateVariable, const boost::python::object& value);
     static std::string scirun_dump_module_state(const std::string& moduleId);
+    static boost::python::object scirun_get_module_profile(const std::string& moduleId);
     static boost::python::object scirun_get_module_transient_state(const std::string& moduleId, const std::string& stateVariable);
     static std::string scirun_set_module_transient_state(const std::string& moduleId, const std::string& stateVariable, const boost::python::object& value);
     static std::string scirun_get_module_input_type(const std::string& moduleId, int portIndex);
@@ -76,6 +77,8 @@ namespace SCIRun {
     static std::string saveNetwork(const std::string& filename);
     static std::string loadNetwork(const std::string& filename);
     static std::string importNetwork(const std::string& filename);
+    static std::string runParameterSweep(const std::string& specFile);
+    static std::string exportExecutionProfile(const std::string& filename, const std::string& format);
     
     static std::string quit(bool force);
 
@@ -61,6 +61,9 @@ namespace SCIRun
     virtual std::vector<std::string> stateVars() const = 0;
     virtual std::string stateToString() const = 0;
 
+    //execution statistics, one dict per recorded execution
+    virtual boost::python::object profile() const = 0;
+
     //ports
     virtual boost::shared_ptr<class PyPorts> output() = 0;
     virtual boost::shared_ptr<class PyPorts> input() = 0;
@@ -131,6 +134,8 @@ namespace SCIRun
     virtual std::string saveNetwork(const std::string& filename) = 0;
     virtual std::string loadNetwork(const std::string& filename) = 0;
     virtual std::string importNetwork(const std::string& filename) = 0;
+    virtual std::string runParameterSweep(const std::string& specFile) = 0;
+    virtual std::string exportExecutionProfile(const std::string& filename, const std::string& format) = 0;
     virtual std::string quit(bool force) = 0;
     virtual void setUnlockFunc(boost::function<void()> unlock) = 0;
   };
@@ -58,6 +58,7 @@ BOOST_PYTHON_MODULE(SCIRunPythonAPI)
     .add_property("stateVars", &PyModule::stateVars)
     .add_property("input", &PyModule::input)
     .add_property("output", &PyModule::output)
+    .add_property("profile", &PyModule::profile)
     .def("showUI", &PyModule::showUI)
     .def("hideUI", &PyModule::hideUI)
     .def("__getattr__", &PyModule::getattr)
@@ -91,6 +92,7 @@ BOOST_PYTHON_MODULE(SCIRunPythonAPI)
   boost::python::def("scirun_get_module_state", &NetworkEditorPythonAPI::scirun_get_module_state);
   boost::python::def("scirun_set_module_state", &NetworkEditorPythonAPI::scirun_set_module_state);
   boost::python::def("scirun_dump_module_state", &NetworkEditorPythonAPI::scirun_dump_module_state);
+  boost::python::def("scirun_get_module_profile", &NetworkEditorPythonAPI::scirun_get_module_profile);
 
   boost::python::def("scirun_get_module_transient_state", &NetworkEditorPythonAPI::scirun_get_module_transient_state);
   boost::python::def("scirun_set_module_transient_state", &NetworkEditorPythonAPI::scirun_set_module_transient_state);
@@ -105,6 +107,8 @@ BOOST_PYTHON_MODULE(SCIRunPythonAPI)
   boost::python::def("scirun_save_network", &NetworkEditorPythonAPI::saveNetwork);
   boost::python::def("scirun_load_network", &NetworkEditorPythonAPI::loadNetwork);
   boost::python::def("scirun_import_network", &NetworkEditorPythonAPI::importNetwork);
+  boost::python::def("scirun_run_sweep", &NetworkEditorPythonAPI::runParameterSweep);
+  boost::python::def("scirun_export_profile", &NetworkEditorPythonAPI::exportExecutionProfile);
   boost::python::def("scirun_quit", &SimplePythonAPI::scirun_quit);
   boost::python::def("scirun_force_quit", &SimplePythonAPI::scirun_force_quit);
 }
@@ -45,6 +45,7 @@
 #include <Core/Logging/Log.h>
 #include <Core/Thread/Mutex.h>
 #include <Core/Thread/Interruptible.h>
+#include <Core/Algorithms/Describe/DatatypeMemorySize.h>
 
 //TODO remove once method is extracted below
 #include <Dataflow/Network/Connection.h>
@@ -158,6 +159,9 @@ Module::Module(const ModuleLookupInfo& info,
   has_ui_(hasUi),
   state_(stateFactory ? stateFactory->make_state(info.module_name_) : new NullModuleState),
   metadata_(state_),
+  inputBytes_(0),
+  outputBytes_(0),
+  executeDecision_(-1),
   threadStopped_(false),
   executionState_(new detail::ModuleExecutionStateImpl)
 {
@@ -243,6 +247,11 @@ namespace //TODO requirements for state metadata reporting
     ostr << "}";
     return ostr.str();
   }
+
+  size_t dataBytes(const DatatypeHandleOption& data)
+  {
+    return data && *data ? General::DatatypeMemorySize().estimate(*data) : 0;
+  }
 }
 
 bool Module::do_execute() throw()
@@ -251,6 +260,10 @@ bool Module::do_execute() throw()
   //std::cout << "executing module: " << id_ << std::endl;
   executeBegins_(id_);
   boost::timer executionTimer;
+  ModuleExecutionSampler sampler;
+  inputBytes_ = 0;
+  outputBytes_ = 0;
+  executeDecision_ = -1;
   {
     std::string isoString = boost::posix_time::to_simple_string(boost::posix_time::microsec_clock::universal_time());
     metadata_.setMetadata("Last execution timestamp", isoString);
@@ -312,6 +325,17 @@ bool Module::do_execute() throw()
   }
   threadStopped_ = threadStopValue;
 
+  {
+    ModuleExecutionRecord record;
+    sampler.finish(record);
+    record.moduleId = id_.id_;
+    record.inputBytes = inputBytes_;
+    record.outputBytes = outputBytes_;
+    record.skipped = executeDecision_ == 0;
+    record.succeeded = returnCode;
+    profile_.add(record);
+  }
+
   {
     double executionTime = executionTimer.elapsed();
     std::ostringstream ostr;
@@ -412,6 +436,7 @@ DatatypeHandleOption Module::get_input_handle(const PortId& id)
   }
 
   auto data = port->getData();
+  inputBytes_ += dataBytes(data);
 
   metadata_.setMetadata("Input " + id.toString(), metaInfo(data));
 
@@ -438,6 +463,8 @@ std::vector<DatatypeHandleOption> Module::get_dynamic_input_handles(const PortId
   std::vector<DatatypeHandleOption> options;
   auto getData = [](InputPortHandle input) { return input->getData(); };
   std::transform(portsWithName.begin(), portsWithName.end(), std::back_inserter(options), getData);
+  for (const auto& option : options)
+    inputBytes_ += dataBytes(option);
 
   metadata_.setMetadata("Input " + id.toString(), metaInfo(options.empty() ? boost::none : options[0]));
 
@@ -453,6 +480,7 @@ void Module::send_output_handle(const PortId& id, DatatypeHandle data)
   }
 
   oports_[id]->sendData(data);
+  outputBytes_ += General::DatatypeMemorySize().estimate(data);
 }
 
 std::vector<InputPortHandle> Module::findInputPortsWithName(const std::string& name) const
@@ -703,6 +731,7 @@ bool Module::needToExecute() const
       return true;
     auto val = reexecute_->needToExecute();
     //Log::get() << DEBUG_LOG << id_ << " Using real needToExecute strategy object, value is: " << val << std::endl;
+    executeDecision_ = val ? 1 : 0;
     return val;
   }
 
@@ -714,6 +743,11 @@ const MetadataMap& Module::metadata() const
   return metadata_;
 }
 
+ModuleExecutionProfile& Module::executionProfile()
+{
+  return profile_;
+}
+
 ModuleReexecutionStrategyHandle Module::getReexecutionStrategy() const
 {
   return reexecute_;
@@ -729,6 +763,15 @@ bool Module::inputsChanged() const
   return inputsChanged_;
 }
 
+void Module::markUpToDate()
+{
+  // consume the change flags raised by data already sitting on the input ports
+  for (const auto& input : iports_.view())
+    input->hasChanged();
+  inputsChanged_ = false;
+  resetStateChanged();
+}
+
 void Module::addPortConnection(const boost::signals2::connection& con)
 {
   portConnections_.emplace_back(new boost::signals2::scoped_connection(con));
@@ -46,6 +46,7 @@
 #include <Dataflow/Network/ModuleStateInterface.h>
 #include <Dataflow/Network/ModuleDescription.h>
 #include <Dataflow/Network/PortManager.h>
+#include <Dataflow/Network/ModuleExecutionProfile.h>
 #include <Dataflow/Network/share.h>
 
 namespace SCIRun {
@@ -103,6 +104,8 @@ namespace Networks {
 
     virtual const MetadataMap& metadata() const override;
 
+    virtual ModuleExecutionProfile& executionProfile() override;
+
   private:
     virtual Core::Datatypes::DatatypeHandleOption get_input_handle(const PortId& id);
     virtual std::vector<Core::Datatypes::DatatypeHandleOption> get_dynamic_input_handles(const PortId& id);
@@ -143,6 +146,10 @@ namespace Networks {
     bool oport_connected(const PortId& id) const;
     bool inputsChanged() const;
 
+    /// Treats the data on the output ports as current, e.g. after restoring it from a
+    /// checkpoint: the next execution is skipped unless state or inputs change again.
+    void markUpToDate();
+
     template <class Type, size_t N>
     struct PortNameBase
     {
@@ -285,6 +292,10 @@ namespace Networks {
 
     ModuleStateHandle state_;
     MetadataMap metadata_;
+    ModuleExecutionProfile profile_;
+    std::atomic<size_t> inputBytes_, outputBytes_;
+    // Outcome of needToExecute during the current execution: -1 not asked, 0 skip, 1 run.
+    mutable std::atomic<int> executeDecision_;
     PortManager<OutputPortHandle> oports_;
     PortManager<InputPortHandle> iports_;
 
@@ -0,0 +1,286 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Dataflow/Network/ModuleExecutionProfile.h>
+#include <Dataflow/Network/NetworkInterface.h>
+#include <Dataflow/Network/ModuleInterface.h>
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <functional>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <thread>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#include <time.h>
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#elif defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#endif
+
+using namespace SCIRun::Dataflow::Networks;
+using namespace SCIRun::Core::Thread;
+
+namespace
+{
+  long long microseconds(std::chrono::system_clock::time_point t)
+  {
+    return std::chrono::duration_cast<std::chrono::microseconds>(t.time_since_epoch()).count();
+  }
+
+  long long steadyMicroseconds()
+  {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  std::string jsonString(const std::string& text)
+  {
+    std::ostringstream out;
+    out << '"';
+    for (auto c : text)
+    {
+      if (c == '"' || c == '\\')
+        out << '\\' << c;
+      else if (static_cast<unsigned char>(c) < 0x20)
+        out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec << std::setfill(' ');
+      else
+        out << c;
+    }
+    out << '"';
+    return out.str();
+  }
+
+  std::string csvField(const std::string& text)
+  {
+    if (text.find_first_of(",\"\n") == std::string::npos)
+      return text;
+    std::string quoted("\"");
+    for (auto c : text)
+    {
+      if (c == '"')
+        quoted += '"';
+      quoted += c;
+    }
+    return quoted + "\"";
+  }
+}
+
+ModuleExecutionRecord::ModuleExecutionRecord() : startMicroseconds(0), wallSeconds(0), cpuSeconds(0),
+  heapBytesDelta(0), peakResidentBytes(0), peakResidentIncrease(0), inputBytes(0), outputBytes(0),
+  skipped(false), succeeded(false), threadId(0)
+{
+}
+
+ModuleExecutionProfile::ModuleExecutionProfile(size_t capacity) : lock_("moduleExecutionProfile"),
+  capacity_(std::max<size_t>(capacity, 1)), next_(0), total_(0)
+{
+}
+
+void ModuleExecutionProfile::add(const ModuleExecutionRecord& record)
+{
+  Guard g(lock_.get());
+  if (buffer_.size() < capacity_)
+    buffer_.push_back(record);
+  else
+    buffer_[next_] = record;
+  next_ = (next_ + 1) % capacity_;
+  ++total_;
+}
+
+std::vector<ModuleExecutionRecord> ModuleExecutionProfile::records() const
+{
+  Guard g(lock_.get());
+  if (buffer_.size() < capacity_)
+    return buffer_;
+  std::vector<ModuleExecutionRecord> ordered(buffer_.begin() + next_, buffer_.end());
+  ordered.insert(ordered.end(), buffer_.begin(), buffer_.begin() + next_);
+  return ordered;
+}
+
+size_t ModuleExecutionProfile::totalExecutions() const
+{
+  Guard g(lock_.get());
+  return total_;
+}
+
+size_t ModuleExecutionProfile::capacity() const
+{
+  Guard g(lock_.get());
+  return capacity_;
+}
+
+void ModuleExecutionProfile::setCapacity(size_t capacity)
+{
+  auto current = records();
+  Guard g(lock_.get());
+  capacity_ = std::max<size_t>(capacity, 1);
+  if (current.size() > capacity_)
+    current.erase(current.begin(), current.end() - capacity_);
+  buffer_.swap(current);
+  next_ = buffer_.size() % capacity_;
+}
+
+void ModuleExecutionProfile::clear()
+{
+  Guard g(lock_.get());
+  buffer_.clear();
+  next_ = 0;
+  total_ = 0;
+}
+
+std::vector<ModuleExecutionRecord> ModuleExecutionProfile::collect(const NetworkInterface& network)
+{
+  std::vector<ModuleExecutionRecord> all;
+  for (size_t i = 0; i < network.nmodules(); ++i)
+  {
+    auto module = network.module(i);
+    if (module)
+    {
+      auto records = module->executionProfile().records();
+      all.insert(all.end(), records.begin(), records.end());
+    }
+  }
+  std::stable_sort(all.begin(), all.end(),
+    [](const ModuleExecutionRecord& a, const ModuleExecutionRecord& b) { return a.startMicroseconds < b.startMicroseconds; });
+  return all;
+}
+
+void ModuleExecutionProfile::writeCsv(std::ostream& out, const std::vector<ModuleExecutionRecord>& records)
+{
+  out << "module_id,start_us,wall_seconds,cpu_seconds,heap_delta_bytes,peak_resident_bytes,"
+    "peak_resident_increase_bytes,input_bytes,output_bytes,skipped,succeeded,thread\n";
+  for (const auto& r : records)
+  {
+    out << csvField(r.moduleId) << ',' << r.startMicroseconds << ','
+      << std::setprecision(9) << r.wallSeconds << ',' << r.cpuSeconds << ','
+      << r.heapBytesDelta << ',' << r.peakResidentBytes << ',' << r.peakResidentIncrease << ','
+      << r.inputBytes << ',' << r.outputBytes << ','
+      << (r.skipped ? 1 : 0) << ',' << (r.succeeded ? 1 : 0) << ',' << r.threadId << '\n';
+  }
+}
+
+void ModuleExecutionProfile::writeTraceEvents(std::ostream& out, const std::vector<ModuleExecutionRecord>& records)
+{
+  out << "{\"traceEvents\":[";
+  bool first = true;
+  for (const auto& r : records)
+  {
+    out << (first ? "\n" : ",\n");
+    first = false;
+    out << "{\"name\":" << jsonString(r.moduleId)
+      << ",\"cat\":\"" << (r.skipped ? "skipped" : "module") << '"'
+      << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << r.threadId
+      << ",\"ts\":" << r.startMicroseconds
+      << ",\"dur\":" << static_cast<long long>(r.wallSeconds * 1e6)
+      << ",\"args\":{\"cpu_seconds\":" << std::setprecision(9) << r.cpuSeconds
+      << ",\"heap_delta_bytes\":" << r.heapBytesDelta
+      << ",\"peak_resident_bytes\":" << r.peakResidentBytes
+      << ",\"peak_resident_increase_bytes\":" << r.peakResidentIncrease
+      << ",\"input_bytes\":" << r.inputBytes
+      << ",\"output_bytes\":" << r.outputBytes
+      << ",\"succeeded\":" << (r.succeeded ? "true" : "false")
+      << "}}";
+  }
+  out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+ModuleExecutionSampler::ModuleExecutionSampler() :
+  start_(microseconds(std::chrono::system_clock::now())),
+  steadyStart_(steadyMicroseconds()),
+  cpu_(threadCpuSeconds()),
+  heap_(heapInUse()),
+  peak_(peakResident())
+{
+}
+
+void ModuleExecutionSampler::finish(ModuleExecutionRecord& record) const
+{
+  record.startMicroseconds = start_;
+  record.wallSeconds = (steadyMicroseconds() - steadyStart_) * 1e-6;
+  record.cpuSeconds = threadCpuSeconds() - cpu_;
+  record.heapBytesDelta = static_cast<long long>(heapInUse()) - static_cast<long long>(heap_);
+  record.peakResidentBytes = peakResident();
+  record.peakResidentIncrease = record.peakResidentBytes > peak_ ? record.peakResidentBytes - peak_ : 0;
+  record.threadId = std::hash<std::thread::id>()(std::this_thread::get_id());
+}
+
+size_t ModuleExecutionSampler::heapInUse()
+{
+#if defined(__APPLE__)
+  malloc_statistics_t stats;
+  malloc_zone_statistics(nullptr, &stats);
+  return stats.size_in_use;
+#elif defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+  auto info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+#elif defined(__GLIBC__)
+  auto info = mallinfo();
+  return static_cast<size_t>(static_cast<unsigned int>(info.uordblks)) + static_cast<unsigned int>(info.hblkhd);
+#else
+  return 0;
+#endif
+}
+
+size_t ModuleExecutionSampler::peakResident()
+{
+#if defined(_WIN32)
+  return 0;
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+#if defined(__APPLE__)
+  return static_cast<size_t>(usage.ru_maxrss);
+#else
+  return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+double ModuleExecutionSampler::threadCpuSeconds()
+{
+#if defined(_WIN32)
+  FILETIME creation, exit, kernel, user;
+  if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+    return 0;
+  auto ticks = [](const FILETIME& t) { return (static_cast<unsigned long long>(t.dwHighDateTime) << 32) | t.dwLowDateTime; };
+  return (ticks(kernel) + ticks(user)) * 1e-7;
+#else
+  struct timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+    return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+#endif
+}
@@ -0,0 +1,124 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef DATAFLOW_NETWORK_MODULEEXECUTIONPROFILE_H
+#define DATAFLOW_NETWORK_MODULEEXECUTIONPROFILE_H
+
+#include <Dataflow/Network/NetworkFwd.h>
+#include <Core/Thread/Mutex.h>
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include <Dataflow/Network/share.h>
+
+namespace SCIRun
+{
+  namespace Dataflow
+  {
+    namespace Networks
+    {
+      /// Statistics of one module execution. Memory figures are process wide, so they are only
+      /// attributable to the module when nothing else runs at the same time.
+      struct SCISHARE ModuleExecutionRecord
+      {
+        ModuleExecutionRecord();
+
+        std::string moduleId;
+        /// Start of the execution in microseconds since the epoch.
+        long long startMicroseconds;
+        double wallSeconds;
+        /// CPU time of the executing thread; work done by helper threads is not included.
+        double cpuSeconds;
+        /// Change in allocated heap bytes across the execution, negative if memory was released.
+        long long heapBytesDelta;
+        /// Peak resident set size of the process after the execution, and how much the
+        /// execution raised it.
+        size_t peakResidentBytes;
+        size_t peakResidentIncrease;
+        /// Estimated size of the data received on input ports and sent on output ports.
+        size_t inputBytes;
+        size_t outputBytes;
+        /// The module's re-execution strategy found it up to date, so it did no work.
+        bool skipped;
+        bool succeeded;
+        size_t threadId;
+      };
+
+      /// Fixed size ring buffer of the most recent executions of a module. Thread safe: the
+      /// records may be read while the module executes.
+      class SCISHARE ModuleExecutionProfile : boost::noncopyable
+      {
+      public:
+        explicit ModuleExecutionProfile(size_t capacity = DefaultCapacity);
+
+        void add(const ModuleExecutionRecord& record);
+        /// The stored records, oldest first.
+        std::vector<ModuleExecutionRecord> records() const;
+        /// Number of executions recorded since the last clear, including those that were overwritten.
+        size_t totalExecutions() const;
+        size_t capacity() const;
+        /// Keeps the most recent records that fit.
+        void setCapacity(size_t capacity);
+        void clear();
+
+        /// Records of every module in the network, ordered by start time.
+        static std::vector<ModuleExecutionRecord> collect(const NetworkInterface& network);
+        static void writeCsv(std::ostream& out, const std::vector<ModuleExecutionRecord>& records);
+        /// Chrome trace event format, viewable in chrome://tracing or Perfetto.
+        static void writeTraceEvents(std::ostream& out, const std::vector<ModuleExecutionRecord>& records);
+
+        static const size_t DefaultCapacity = 64;
+
+      private:
+        mutable Core::Thread::Mutex lock_;
+        std::vector<ModuleExecutionRecord> buffer_;
+        size_t capacity_, next_, total_;
+      };
+
+      /// Takes the measurements for one execution record: construct before the module
+      /// executes, call finish() afterwards.
+      class SCISHARE ModuleExecutionSampler
+      {
+      public:
+        ModuleExecutionSampler();
+        void finish(ModuleExecutionRecord& record) const;
+
+        /// Process memory counters; zero where the platform offers none.
+        static size_t heapInUse();
+        static size_t peakResident();
+        static double threadCpuSeconds();
+      private:
+        long long start_, steadyStart_;
+        double cpu_;
+        size_t heap_, peak_;
+      };
+    }
+  }
+}
+
+#endif
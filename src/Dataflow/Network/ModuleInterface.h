@@ -176,6 +176,9 @@ namespace Networks {
 
     virtual const MetadataMap& metadata() const = 0;
 
+    /// Statistics of the most recent executions.
+    virtual ModuleExecutionProfile& executionProfile() = 0;
+
     virtual bool isStoppable() const = 0;
   };
 
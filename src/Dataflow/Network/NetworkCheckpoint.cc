@@ -0,0 +1,452 @@
+/*
+For more information, please see: http://software.sci.utah.edu
+
+The MIT License
+
+Copyright (c) 2015 Scientific Computing and Imaging Institute,
+University of Utah.
+
+License for the specific language governing rights and limitations under
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Dataflow/Network/NetworkCheckpoint.h>
+#include <Dataflow/Network/NetworkInterface.h>
+#include <Dataflow/Network/ConnectionId.h>
+#include <Dataflow/Network/Module.h>
+#include <Dataflow/Network/PortDataCache.h>
+#include <Core/Logging/Log.h>
+#include <boost/algorithm/string/replace.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <set>
+#include <sstream>
+
+using namespace SCIRun;
+using namespace SCIRun::Dataflow::Networks;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Logging;
+
+namespace
+{
+  const std::string MANIFEST("checkpoint.txt");
+  const std::string MANIFEST_HEADER("scirun_checkpoint 1");
+
+  /// 128 bit digest of a sequence of strings, two independently seeded FNV-1a lanes
+  class Digest
+  {
+  public:
+    Digest() : h1_(0xcbf29ce484222325ULL), h2_(0x84222325cbf29ce4ULL) {}
+
+    void add(const std::string& s)
+    {
+      addByte(static_cast<unsigned char>(s.size() & 0xff));
+      addByte(static_cast<unsigned char>((s.size() >> 8) & 0xff));
+      for (size_t j = 0; j < s.size(); j++)
+        addByte(static_cast<unsigned char>(s[j]));
+    }
+
+    std::string hex() const
+    {
+      std::ostringstream ostr;
+      ostr << std::hex << std::setfill('0') << std::setw(16) << h1_ << std::setw(16) << h2_;
+      return ostr.str();
+    }
+
+  private:
+    void addByte(unsigned char b)
+    {
+      h1_ = (h1_ ^ b) * 0x100000001b3ULL;
+      h2_ = (h2_ ^ (b + 0x9e)) * 0x100000001b3ULL;
+    }
+
+    std::uint64_t h1_, h2_;
+  };
+
+  /// Computes the checkpoint key of every module of a network
+  class ModuleKeys
+  {
+  public:
+    explicit ModuleKeys(const NetworkInterface& network) : network_(network)
+    {
+      for (const auto& cxn : network.connections())
+        incoming_[cxn.in_.moduleId_.id_].push_back(cxn);
+      for (auto& in : incoming_)
+      {
+        std::sort(in.second.begin(), in.second.end(), [](const ConnectionDescription& a, const ConnectionDescription& b)
+        {
+          return a.in_.portId_.toString() < b.in_.portId_.toString() ||
+            (a.in_.portId_.toString() == b.in_.portId_.toString() && a.out_.moduleId_.id_ < b.out_.moduleId_.id_);
+        });
+      }
+    }
+
+    /// Empty for modules that are part of a cycle.
+    std::string key(const ModuleHandle& module)
+    {
+      const std::string id = module->get_id().id_;
+      auto iter = keys_.find(id);
+      if (iter != keys_.end())
+        return iter->second;
+      if (!visiting_.insert(id).second)
+        return std::string();
+
+      Digest digest;
+      digest.add(id);
+      digest.add(module->get_module_name());
+
+      auto state = module->get_state();
+      if (state)
+      {
+        for (const auto& name : state->getKeys())
+        {
+          const auto variable = state->getValue(name);
+          std::ostringstream value;
+          value << std::setprecision(17) << variable.value();
+          digest.add(name.name());
+          digest.add(value.str());
+          addFileStamp(digest, variable);
+        }
+      }
+
+      std::string result;
+      bool valid = true;
+      for (const auto& cxn : incoming(id))
+      {
+        auto upstream = network_.lookupModule(cxn.out_.moduleId_);
+        const std::string upstreamKey = upstream ? key(upstream) : std::string();
+        if (upstreamKey.empty())
+        {
+          valid = false;
+          break;
+        }
+        digest.add(cxn.in_.portId_.toString());
+        digest.add(cxn.out_.moduleId_.id_);
+        digest.add(cxn.out_.portId_.toString());
+        digest.add(upstreamKey);
+      }
+      if (valid)
+        result = digest.hex();
+
+      visiting_.erase(id);
+      keys_[id] = result;
+      return result;
+    }
+
+    /// Reader modules keep the name of their input file in their state; its size and
+    /// modification time are part of the key, so editing the file invalidates the entry.
+    static void addFileStamp(Digest& digest, const Core::Algorithms::Variable& variable)
+    {
+      const std::string* name = boost::get<std::string>(&variable.value());
+      if (!name || name->empty())
+        return;
+      boost::system::error_code ec;
+      const boost::filesystem::path file(*name);
+      if (!boost::filesystem::is_regular_file(file, ec))
+        return;
+      const auto size = boost::filesystem::file_size(file, ec);
+      const auto time = boost::filesystem::last_write_time(file, ec);
+      if (ec)
+        return;
+      digest.add(boost::lexical_cast<std::string>(size));
+      digest.add(boost::lexical_cast<std::string>(time));
+    }
+
+    const std::vector<ConnectionDescription>& incoming(const std::string& id) const
+    {
+      static const std::vector<ConnectionDescription> none;
+      auto iter = incoming_.find(id);
+      return iter != incoming_.end() ? iter->second : none;
+    }
+
+    ModuleHandle upstream(const ConnectionDescription& cxn) const
+    {
+      return network_.lookupModule(cxn.out_.moduleId_);
+    }
+
+  private:
+    const NetworkInterface& network_;
+    std::map<std::string, std::vector<ConnectionDescription>> incoming_;
+    std::map<std::string, std::string> keys_;
+    std::set<std::string> visiting_;
+  };
+
+  struct PortEntry
+  {
+    size_t index;
+    std::string file;
+  };
+
+  struct ModuleEntry
+  {
+    std::string key;
+    std::vector<PortEntry> ports;
+  };
+
+  typedef std::map<std::string, ModuleEntry> Manifest;
+
+  bool readManifest(const boost::filesystem::path& file, Manifest& manifest)
+  {
+    std::ifstream in(file.string().c_str());
+    std::string line;
+    if (!in || !std::getline(in, line) || line != MANIFEST_HEADER)
+      return false;
+
+    ModuleEntry* current = nullptr;
+    while (std::getline(in, line))
+    {
+      std::istringstream fields(line);
+      std::string tag;
+      fields >> tag;
+      if (tag == "module")
+      {
+        std::string id, key;
+        if (!(fields >> id >> key))
+          return false;
+        current = &manifest[id];
+        current->key = key;
+      }
+      else if (tag == "port" && current)
+      {
+        PortEntry port;
+        if (!(fields >> port.index >> port.file))
+          return false;
+        current->ports.push_back(port);
+      }
+      else if (!tag.empty())
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  std::string fileStem(const ModuleId& id)
+  {
+    return boost::replace_all_copy(id.id_, ":", "_");
+  }
+
+  /// Manifest entries may only name files inside the checkpoint directory
+  bool isPlainFileName(const std::string& name)
+  {
+    const boost::filesystem::path path(name);
+    return !name.empty() && path.filename() == path && name != "." && name != "..";
+  }
+
+  OutputPortHandle outputPort(const ModuleHandle& module, size_t index)
+  {
+    for (const auto& port : module->outputPorts())
+      if (port->getIndex() == index)
+        return port;
+    return OutputPortHandle();
+  }
+}
+
+NetworkCheckpoint::NetworkCheckpoint(const boost::filesystem::path& networkFile)
+  : dir_(networkFile.parent_path() / (networkFile.stem().string() + "_checkpoint"))
+{
+}
+
+size_t NetworkCheckpoint::save(const NetworkInterface& network) const
+{
+  ModuleKeys keys(network);
+  std::map<std::string, bool> saved;
+  Manifest manifest;
+
+  // The directory is not cleared, it may hold files that are not ours. Only the data files
+  // of the previous manifest are removed once the new one is in place.
+  Manifest previous;
+  readManifest(dir_ / MANIFEST, previous);
+
+  boost::system::error_code ec;
+  boost::filesystem::create_directories(dir_, ec);
+  if (ec)
+  {
+    Log::get() << ERROR_LOG << "Could not create network checkpoint directory " << dir_.string() << std::endl;
+    return 0;
+  }
+
+  // A module is saved once everything upstream of it is saved, so that a restored module
+  // always receives restored inputs.
+  std::function<bool(const ModuleHandle&)> saveModule = [&](const ModuleHandle& module) -> bool
+  {
+    const std::string id = module->get_id().id_;
+    auto done = saved.find(id);
+    if (done != saved.end())
+      return done->second;
+    saved[id] = false;
+
+    const std::string key = keys.key(module);
+    if (key.empty() || module->needToExecute())
+      return false;
+
+    for (const auto& cxn : keys.incoming(id))
+    {
+      auto upstream = keys.upstream(cxn);
+      if (!upstream || !saveModule(upstream))
+        return false;
+    }
+
+    ModuleEntry entry;
+    entry.key = key;
+    for (const auto& port : module->outputPorts())
+    {
+      if (!port->hasData())
+        continue;
+      auto data = port->getData();
+      const auto ext = PortDataCache::fileExtension(data);
+      if (ext.empty())
+        return false;
+      PortEntry portEntry;
+      portEntry.index = port->getIndex();
+      const std::string stem = fileStem(module->get_id()) + "_" + boost::lexical_cast<std::string>(portEntry.index);
+      portEntry.file = stem + ext;
+      // written under a temporary name, so the previous checkpoint stays readable until
+      // the file is complete; the extension selects the data type and is kept
+      const auto partial = dir_ / (stem + ".partial" + ext);
+      if (!PortDataCache::writeDataFile(partial, data))
+      {
+        Log::get() << ERROR_LOG << "Could not write checkpoint data for " << id << std::endl;
+        boost::filesystem::remove(partial, ec);
+        return false;
+      }
+      boost::filesystem::rename(partial, dir_ / portEntry.file, ec);
+      if (ec)
+      {
+        boost::filesystem::remove(partial, ec);
+        return false;
+      }
+      entry.ports.push_back(portEntry);
+    }
+    if (entry.ports.empty())
+      return false;
+
+    manifest[id] = entry;
+    saved[id] = true;
+    return true;
+  };
+
+  for (size_t i = 0; i < network.nmodules(); ++i)
+    saveModule(network.module(i));
+
+  const auto manifestFile = dir_ / MANIFEST;
+  const auto tempFile = dir_ / (MANIFEST + ".tmp");
+  {
+    std::ofstream out(tempFile.string().c_str());
+    out << MANIFEST_HEADER << "\n";
+    for (const auto& module : manifest)
+    {
+      out << "module " << module.first << " " << module.second.key << "\n";
+      for (const auto& port : module.second.ports)
+        out << "port " << port.index << " " << port.file << "\n";
+    }
+    if (!out)
+    {
+      Log::get() << ERROR_LOG << "Could not write network checkpoint " << manifestFile.string() << std::endl;
+      return 0;
+    }
+  }
+  boost::filesystem::rename(tempFile, manifestFile, ec);
+  if (ec)
+    return 0;
+
+  std::set<std::string> current;
+  for (const auto& module : manifest)
+    for (const auto& port : module.second.ports)
+      current.insert(port.file);
+  for (const auto& module : previous)
+    for (const auto& port : module.second.ports)
+      if (isPlainFileName(port.file) && current.find(port.file) == current.end())
+        boost::filesystem::remove(dir_ / port.file, ec);
+
+  LOG_DEBUG("Network checkpoint saved " << manifest.size() << " modules to " << dir_.string());
+  return manifest.size();
+}
+
+size_t NetworkCheckpoint::restore(NetworkInterface& network) const
+{
+  Manifest manifest;
+  if (!readManifest(dir_ / MANIFEST, manifest))
+    return 0;
+
+  ModuleKeys keys(network);
+  std::map<std::string, bool> restored;
+  std::vector<ModuleHandle> upToDate;
+
+  std::function<bool(const ModuleHandle&)> restoreModule = [&](const ModuleHandle& module) -> bool
+  {
+    const std::string id = module->get_id().id_;
+    auto done = restored.find(id);
+    if (done != restored.end())
+      return done->second;
+    restored[id] = false;
+
+    auto entry = manifest.find(id);
+    if (entry == manifest.end() || entry->second.key != keys.key(module))
+      return false;
+
+    for (const auto& cxn : keys.incoming(id))
+    {
+      auto upstream = keys.upstream(cxn);
+      if (!upstream || !restoreModule(upstream))
+        return false;
+    }
+
+    std::vector<std::pair<OutputPortHandle, DatatypeHandle>> outputs;
+    for (const auto& port : entry->second.ports)
+    {
+      auto oport = outputPort(module, port.index);
+      auto data = oport && isPlainFileName(port.file) ? PortDataCache::readDataFile(dir_ / port.file) : DatatypeHandle();
+      if (!data)
+      {
+        Log::get() << ERROR_LOG << "Could not read checkpoint data for " << id << ", it will be executed again." << std::endl;
+        return false;
+      }
+      outputs.push_back(std::make_pair(oport, data));
+    }
+
+    for (const auto& output : outputs)
+      output.first->sendData(output.second);
+
+    upToDate.push_back(module);
+    restored[id] = true;
+    return true;
+  };
+
+  for (size_t i = 0; i < network.nmodules(); ++i)
+    restoreModule(network.module(i));
+
+  // only after all data was sent, so that inputs coming from restored modules are not
+  // seen as changes on the next execution
+  for (const auto& module : upToDate)
+  {
+    auto m = dynamic_cast<Module*>(module.get());
+    if (m)
+      m->markUpToDate();
+  }
+
+  LOG_DEBUG("Network checkpoint restored " << upToDate.size() << " modules from " << dir_.string());
+  return upToDate.size();
+}
@@ -0,0 +1,72 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef DATAFLOW_NETWORK_NETWORKCHECKPOINT_H
+#define DATAFLOW_NETWORK_NETWORKCHECKPOINT_H
+
+#include <Dataflow/Network/NetworkFwd.h>
+#include <boost/filesystem/path.hpp>
+#include <Dataflow/Network/share.h>
+
+namespace SCIRun
+{
+  namespace Dataflow
+  {
+    namespace Networks
+    {
+      /// Output port data of a network, saved in binary Pio format in a directory next to the
+      /// network file. Each module's entry is keyed by its id and a digest of its state and of
+      /// the keys of the modules feeding it, so an entry stays valid until the module or
+      /// anything upstream of it is edited. Files named in a module's state, such as the input
+      /// of a reader, add their size and modification time to the key. On restore the saved
+      /// data is sent downstream and the restored modules are marked up to date, so only the
+      /// changed part of the network runs on the next execution.
+      class SCISHARE NetworkCheckpoint
+      {
+      public:
+        explicit NetworkCheckpoint(const boost::filesystem::path& networkFile);
+
+        boost::filesystem::path directory() const { return dir_; }
+
+        /// Saves the outputs of every module that is up to date and whose upstream modules
+        /// were saved as well. Replaces the previous checkpoint, removing only the files its
+        /// manifest lists; returns the number of modules saved.
+        size_t save(const NetworkInterface& network) const;
+
+        /// Restores every module with a valid entry whose upstream modules were restored as
+        /// well; returns the number of modules restored.
+        size_t restore(NetworkInterface& network) const;
+
+      private:
+        boost::filesystem::path dir_;
+      };
+    }
+  }
+}
+
+#endif
@@ -75,6 +75,7 @@ class ConnectionMakerService;
 class NetworkEditorControllerInterface;
 class ReexecuteStrategyFactory;
 class MetadataMap;
+class ModuleExecutionProfile;
 
 typedef boost::shared_ptr<NetworkInterface> NetworkHandle;
 typedef boost::shared_ptr<ModuleInterface> ModuleHandle;
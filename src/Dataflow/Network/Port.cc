@@ -187,6 +187,11 @@ bool OutputPort::hasData() const
   return ret;
 }
 
+DatatypeHandle OutputPort::getData() const
+{
+  return source_ ? source_->getData() : DatatypeHandle();
+}
+
 void OutputPort::attach(Connection* conn)
 {
   if (hasData() && conn && conn->iport_)
@@ -123,6 +123,7 @@ public:
   virtual bool isInput() const { return false; } //boo
   virtual bool isDynamic() const { return false; } /// @todo: design dynamic output ports
   virtual bool hasData() const override;
+  virtual Core::Datatypes::DatatypeHandle getData() const override;
   virtual void attach(Connection* conn) override;
   virtual PortDataDescriber getPortDataDescriber() const override;
   virtual boost::signals2::connection connectConnectionFeedbackListener(const ConnectionFeedbackSignalType::slot_type& subscriber) override;
@@ -0,0 +1,458 @@
+/*
+For more information, please see: http://software.sci.utah.edu
+
+The MIT License
+
+Copyright (c) 2015 Scientific Computing and Imaging Institute,
+University of Utah.
+
+License for the specific language governing rights and limitations under
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Dataflow/Network/PortDataCache.h>
+#include <Dataflow/Network/SimpleSourceSink.h>
+#include <Core/Algorithms/Describe/DatatypeMemorySize.h>
+#include <Core/Datatypes/String.h>
+#include <Core/Datatypes/Matrix.h>
+#include <Core/Datatypes/Legacy/Field/Field.h>
+#include <Core/Persistent/Pstreams.h>
+#include <Core/Logging/Log.h>
+#include <boost/filesystem.hpp>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace SCIRun;
+using namespace SCIRun::Dataflow::Networks;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Algorithms::General;
+using namespace SCIRun::Core::Logging;
+using namespace SCIRun::Core::Thread;
+
+CORE_SINGLETON_IMPLEMENTATION( PortDataCache )
+
+namespace
+{
+  // The file extension names the content type so it can be read back with the matching Pio call.
+  const std::string FIELD_EXT(".fld");
+  const std::string MATRIX_EXT(".mat");
+  const std::string STRING_EXT(".str");
+
+  template <class HType>
+  bool writeHandle(const boost::filesystem::path& file, HType handle)
+  {
+    PiostreamPtr stream = auto_ostream(file.string(), "Binary");
+    if (!stream || stream->error())
+      return false;
+    Pio(*stream, handle);
+    return !stream->error();
+  }
+
+  template <class HType>
+  DatatypeHandle readHandle(const boost::filesystem::path& file)
+  {
+    PiostreamPtr stream = auto_istream(file.string());
+    if (!stream || stream->error())
+      return DatatypeHandle();
+    HType handle;
+    Pio(*stream, handle);
+    if (stream->error())
+      return DatatypeHandle();
+    return handle;
+  }
+
+  void removeSpillFile(boost::filesystem::path& file)
+  {
+    if (file.empty())
+      return;
+    boost::system::error_code ec;
+    boost::filesystem::remove(file, ec);
+    file.clear();
+  }
+
+  // Spilled data may be anything a network handles, so nobody but the owner may list, read or
+  // replace the files in the spill directory.
+  bool isPrivateDirectory(const boost::filesystem::path& directory)
+  {
+#ifndef _WIN32
+    struct stat info;
+    if (::lstat(directory.string().c_str(), &info) != 0)
+      return false;
+    return S_ISDIR(info.st_mode) && info.st_uid == ::getuid() && (info.st_mode & (S_IRWXG | S_IRWXO)) == 0;
+#else
+    boost::system::error_code ec;
+    return boost::filesystem::is_directory(directory, ec);
+#endif
+  }
+
+  bool preparePrivateDirectory(const boost::filesystem::path& directory)
+  {
+    boost::system::error_code ec;
+    if (!boost::filesystem::exists(directory, ec))
+    {
+      boost::filesystem::create_directories(directory, ec);
+      if (ec)
+        return false;
+      boost::filesystem::permissions(directory, boost::filesystem::owner_all, ec);
+      if (ec)
+        return false;
+    }
+    return isPrivateDirectory(directory);
+  }
+}
+
+std::string PortDataCache::fileExtension(const DatatypeHandle& data)
+{
+  if (boost::dynamic_pointer_cast<Field>(data))
+    return FIELD_EXT;
+  if (boost::dynamic_pointer_cast<Matrix>(data))
+    return MATRIX_EXT;
+  if (boost::dynamic_pointer_cast<String>(data))
+    return STRING_EXT;
+  return std::string();
+}
+
+bool PortDataCache::writeDataFile(const boost::filesystem::path& file, const DatatypeHandle& data)
+{
+  const auto ext = file.extension().string();
+  if (ext == FIELD_EXT)
+    return writeHandle(file, boost::dynamic_pointer_cast<Field>(data));
+  if (ext == MATRIX_EXT)
+    return writeHandle(file, boost::dynamic_pointer_cast<Matrix>(data));
+  if (ext == STRING_EXT)
+  {
+    PiostreamPtr stream = auto_ostream(file.string(), "Binary");
+    if (!stream || stream->error())
+      return false;
+    auto str = boost::dynamic_pointer_cast<String>(data);
+    Pio2(*stream, str);
+    return !stream->error();
+  }
+  return false;
+}
+
+DatatypeHandle PortDataCache::readDataFile(const boost::filesystem::path& file)
+{
+  const auto ext = file.extension().string();
+  if (ext == FIELD_EXT)
+    return readHandle<FieldHandle>(file);
+  if (ext == MATRIX_EXT)
+    return readHandle<MatrixHandle>(file);
+  if (ext == STRING_EXT)
+  {
+    PiostreamPtr stream = auto_istream(file.string());
+    if (!stream || stream->error())
+      return DatatypeHandle();
+    StringHandle str;
+    Pio2(*stream, str);
+    return str;
+  }
+  return DatatypeHandle();
+}
+
+boost::filesystem::path PortDataCache::defaultSpillDirectory()
+{
+#ifndef _WIN32
+  return boost::filesystem::temp_directory_path() / ("scirun_port_cache-" + std::to_string(::getuid()));
+#else
+  return boost::filesystem::temp_directory_path() / "scirun_port_cache";
+#endif
+}
+
+PortDataCache::PortDataCache() : lock_("PortDataCache"), budget_(0), resident_(0), spills_(0), nextToken_(0),
+  spillDir_(defaultSpillDirectory())
+{
+}
+
+void PortDataCache::setMemoryBudget(size_t bytes)
+{
+  PendingSpills spills;
+  {
+    Guard g(lock_.get());
+    budget_ = bytes;
+    enforceBudget(nullptr, spills);
+  }
+  writeSpills(spills);
+}
+
+size_t PortDataCache::memoryBudget() const
+{
+  Guard g(lock_.get());
+  return budget_;
+}
+
+size_t PortDataCache::residentBytes() const
+{
+  Guard g(lock_.get());
+  return resident_;
+}
+
+size_t PortDataCache::spillCount() const
+{
+  Guard g(lock_.get());
+  return spills_;
+}
+
+void PortDataCache::setSpillDirectory(const boost::filesystem::path& dir)
+{
+  Guard g(lock_.get());
+  spillDir_ = dir;
+}
+
+boost::filesystem::path PortDataCache::spillDirectory() const
+{
+  Guard g(lock_.get());
+  return spillDir_;
+}
+
+void PortDataCache::addSource(SimpleSource* source)
+{
+  Guard g(lock_.get());
+  auto& entry = entries_[source];
+  entry = Entry();
+  entry.lruPos = lru_.end();
+}
+
+void PortDataCache::removeSource(SimpleSource* source)
+{
+  Guard g(lock_.get());
+  auto iter = entries_.find(source);
+  if (iter == entries_.end())
+    return;
+  release(source, iter->second);
+  entries_.erase(iter);
+}
+
+void PortDataCache::touch(const SimpleSource* source, Entry& entry)
+{
+  if (entry.lruPos != lru_.end())
+    lru_.splice(lru_.begin(), lru_, entry.lruPos);
+  else
+    entry.lruPos = lru_.insert(lru_.begin(), source);
+}
+
+void PortDataCache::release(SimpleSource* source, Entry& entry)
+{
+  if (entry.lruPos != lru_.end())
+  {
+    lru_.erase(entry.lruPos);
+    entry.lruPos = lru_.end();
+  }
+  // Only resident data is counted; spilled and pending data were subtracted when detached.
+  if (source->data_)
+    resident_ -= entry.bytes;
+  entry.bytes = 0;
+  entry.pending.reset();
+  entry.spillToken = 0;
+  removeSpillFile(entry.spillFile);
+  source->data_.reset();
+}
+
+void PortDataCache::cacheData(SimpleSource* source, DatatypeHandle data)
+{
+  const auto bytes = DatatypeMemorySize().estimate(data);
+
+  PendingSpills spills;
+  {
+    Guard g(lock_.get());
+    auto iter = entries_.find(source);
+    if (iter == entries_.end())
+      return;
+    auto& entry = iter->second;
+    release(source, entry);
+
+    source->data_ = data;
+    if (data)
+    {
+      entry.dataId = data->id();
+      entry.bytes = bytes;
+      resident_ += bytes;
+      touch(source, entry);
+      enforceBudget(source, spills);
+    }
+  }
+  writeSpills(spills);
+}
+
+DatatypeHandle PortDataCache::getData(const SimpleSource* source, Datatype::id_type& dataId)
+{
+  // entries_ only holds live sources, so dropping const here is safe.
+  auto src = const_cast<SimpleSource*>(source);
+  boost::filesystem::path file;
+  {
+    Guard g(lock_.get());
+    auto iter = entries_.find(source);
+    if (iter == entries_.end())
+      return DatatypeHandle();
+
+    auto& entry = iter->second;
+    dataId = entry.dataId;
+    if (!src->data_ && entry.pending)
+    {
+      // The spill has not finished yet; keep the data resident and let the writer discard its file.
+      src->data_ = entry.pending;
+      entry.pending.reset();
+      resident_ += entry.bytes;
+    }
+    if (src->data_)
+    {
+      touch(source, entry);
+      return src->data_;
+    }
+    if (entry.spillFile.empty())
+      return DatatypeHandle();
+    file = entry.spillFile;
+  }
+
+  auto data = readDataFile(file);
+
+  PendingSpills spills;
+  {
+    Guard g(lock_.get());
+    auto iter = entries_.find(source);
+    if (iter == entries_.end())
+      return DatatypeHandle();
+
+    auto& entry = iter->second;
+    dataId = entry.dataId;
+    // Another caller may have restored it, or new data may have been cached, while reading.
+    if (src->data_ || entry.spillFile != file)
+    {
+      if (src->data_)
+        touch(source, entry);
+      return src->data_;
+    }
+    if (!data)
+    {
+      Log::get() << ERROR_LOG << "PortDataCache: could not reload spilled port data from " << file.string() << std::endl;
+      return data;
+    }
+
+    removeSpillFile(entry.spillFile);
+    src->data_ = data;
+    resident_ += entry.bytes;
+    touch(source, entry);
+    enforceBudget(source, spills);
+  }
+  writeSpills(spills);
+  return data;
+}
+
+bool PortDataCache::hasData(const SimpleSource* source) const
+{
+  Guard g(lock_.get());
+  auto iter = entries_.find(source);
+  return iter != entries_.end() && (source->data_ || iter->second.pending || !iter->second.spillFile.empty());
+}
+
+void PortDataCache::clearAll()
+{
+  Guard g(lock_.get());
+  for (auto& entry : entries_)
+    release(const_cast<SimpleSource*>(entry.first), entry.second);
+}
+
+void PortDataCache::enforceBudget(const SimpleSource* keep, PendingSpills& spills)
+{
+  if (0 == budget_)
+    return;
+
+  auto pos = lru_.end();
+  while (resident_ > budget_ && pos != lru_.begin())
+  {
+    --pos;
+    if (*pos == keep)
+      continue;
+    auto victim = const_cast<SimpleSource*>(*pos);
+    auto& entry = entries_[victim];
+    // Data still referenced elsewhere (e.g. by an executing module) would not be freed by spilling.
+    if (0 == entry.bytes || victim->data_.use_count() > 1)
+      continue;
+    const auto ext = fileExtension(victim->data_);
+    if (ext.empty())
+      continue;
+
+    PendingSpill spill;
+    spill.source = victim;
+    spill.data = victim->data_;
+    spill.file = spillDir_ / boost::filesystem::unique_path("port_%%%%-%%%%-%%%%-%%%%" + ext);
+    spill.token = ++nextToken_;
+    spills.push_back(spill);
+
+    entry.pending = victim->data_;
+    entry.spillToken = spill.token;
+    victim->data_.reset();
+    resident_ -= entry.bytes;
+    entry.lruPos = lru_.end();
+    pos = lru_.erase(pos);
+  }
+}
+
+void PortDataCache::writeSpills(PendingSpills& spills)
+{
+  for (auto& spill : spills)
+  {
+    const bool written = preparePrivateDirectory(spill.file.parent_path()) && writeDataFile(spill.file, spill.data);
+    if (!written)
+    {
+      LOG_DEBUG("PortDataCache: failed to spill port data to " << spill.file.string());
+      boost::system::error_code ec;
+      boost::filesystem::remove(spill.file, ec);
+    }
+    {
+      Guard g(lock_.get());
+      finishSpill(spill, written);
+    }
+    spill.data.reset();
+  }
+}
+
+void PortDataCache::finishSpill(const PendingSpill& spill, bool written)
+{
+  auto iter = entries_.find(spill.source);
+  const bool current = iter != entries_.end() && iter->second.pending && iter->second.spillToken == spill.token;
+  if (!current)
+  {
+    // The data was reloaded, replaced or its source removed while the file was written.
+    if (written)
+    {
+      boost::system::error_code ec;
+      boost::filesystem::remove(spill.file, ec);
+    }
+    return;
+  }
+
+  auto& entry = iter->second;
+  auto src = const_cast<SimpleSource*>(spill.source);
+  if (written)
+  {
+    entry.spillFile = spill.file;
+    ++spills_;
+  }
+  else
+  {
+    src->data_ = entry.pending;
+    resident_ += entry.bytes;
+    touch(src, entry);
+  }
+  entry.pending.reset();
+}
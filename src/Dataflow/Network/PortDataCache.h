@@ -0,0 +1,133 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef DATAFLOW_NETWORK_PORTDATACACHE_H
+#define DATAFLOW_NETWORK_PORTDATACACHE_H
+
+#include <Core/Datatypes/Datatype.h>
+#include <Core/Utils/Singleton.h>
+#include <boost/filesystem/path.hpp>
+#include <Core/Thread/Mutex.h>
+#include <list>
+#include <map>
+#include <vector>
+#include <Dataflow/Network/share.h>
+
+namespace SCIRun
+{
+  namespace Dataflow
+  {
+    namespace Networks
+    {
+      class SimpleSource;
+
+      /// Memory accounting for data cached on output ports. Each SimpleSource registers here;
+      /// when a memory budget is set and the resident port data exceeds it, the least recently
+      /// used outputs are written to the spill directory in binary Pio format and released.
+      /// Spilled data is reloaded the next time it is sent or received downstream.
+      /// All access to a source's cached data goes through this class's lock; spill files are
+      /// written and read with the lock released. The default spill directory is private to the
+      /// current user.
+      class SCISHARE PortDataCache : boost::noncopyable
+      {
+        CORE_SINGLETON( PortDataCache );
+
+      private:
+        PortDataCache();
+
+      public:
+        /// Budget for resident port data in bytes; zero (the default) means unlimited.
+        void setMemoryBudget(size_t bytes);
+        size_t memoryBudget() const;
+        size_t residentBytes() const;
+        size_t spillCount() const;
+
+        /// Spills are skipped while the directory is not owned by the current user or is
+        /// accessible to group or others. A missing directory is created owner-only.
+        void setSpillDirectory(const boost::filesystem::path& dir);
+        boost::filesystem::path spillDirectory() const;
+        static boost::filesystem::path defaultSpillDirectory();
+
+        void addSource(SimpleSource* source);
+        void removeSource(SimpleSource* source);
+
+        void cacheData(SimpleSource* source, Core::Datatypes::DatatypeHandle data);
+        /// Returns the source's data, reloading it from disk if it was spilled. Safe to call with
+        /// a pointer to a source that has since been destroyed: an empty handle is returned.
+        Core::Datatypes::DatatypeHandle getData(const SimpleSource* source, Core::Datatypes::Datatype::id_type& dataId);
+        bool hasData(const SimpleSource* source) const;
+        void clearAll();
+
+        /// Binary Pio files for port data; the extension names the content type. fileExtension
+        /// returns an empty string for types that cannot be written.
+        static std::string fileExtension(const Core::Datatypes::DatatypeHandle& data);
+        static bool writeDataFile(const boost::filesystem::path& file, const Core::Datatypes::DatatypeHandle& data);
+        static Core::Datatypes::DatatypeHandle readDataFile(const boost::filesystem::path& file);
+
+      private:
+        typedef std::list<const SimpleSource*> LruList;
+        struct Entry
+        {
+          Entry() : bytes(0), dataId(0), spillToken(0) {}
+          size_t bytes;
+          Core::Datatypes::Datatype::id_type dataId;
+          boost::filesystem::path spillFile;
+          /// Data detached for a spill whose file is still being written.
+          Core::Datatypes::DatatypeHandle pending;
+          size_t spillToken;
+          LruList::iterator lruPos;
+        };
+        typedef std::map<const SimpleSource*, Entry> EntryMap;
+
+        /// A victim picked under the lock; its file is written after the lock is released.
+        struct PendingSpill
+        {
+          const SimpleSource* source;
+          Core::Datatypes::DatatypeHandle data;
+          boost::filesystem::path file;
+          size_t token;
+        };
+        typedef std::vector<PendingSpill> PendingSpills;
+
+        void touch(const SimpleSource* source, Entry& entry);
+        void release(SimpleSource* source, Entry& entry);
+        void enforceBudget(const SimpleSource* keep, PendingSpills& spills);
+        void writeSpills(PendingSpills& spills);
+        void finishSpill(const PendingSpill& spill, bool written);
+
+        mutable Core::Thread::Mutex lock_;
+        EntryMap entries_;
+        LruList lru_;
+        size_t budget_, resident_, spills_, nextToken_;
+        boost::filesystem::path spillDir_;
+      };
+    }
+  }
+}
+
+#endif
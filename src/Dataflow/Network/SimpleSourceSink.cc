@@ -30,6 +30,7 @@ DEALINGS IN THE SOFTWARE.
 
 #include <iostream>
 #include <Dataflow/Network/SimpleSourceSink.h>
+#include <Dataflow/Network/PortDataCache.h>
 #include <Core/Logging/Log.h>
 // don't really like this dependency
 #include <Core/Algorithms/Describe/DescribeDatatype.h>
@@ -39,6 +40,9 @@ using namespace SCIRun::Core::Datatypes;
 using namespace SCIRun::Core::Algorithms::General;
 
 SimpleSink::SimpleSink() :
+  dataId_(0),
+  hasDataId_(false),
+  source_(nullptr),
   hasChanged_(false),
   checkForNewDataOnSetting_(false)
 {
@@ -84,27 +88,42 @@ DatatypeHandleOption SimpleSink::receive()
     //std::cout << "\tweak pointer converted to strong in Sink.receive" << std::endl;
     return strong;
   }
+  if (source_)
+  {
+    // upstream data may have been spilled to disk by the port data cache.
+    Datatype::id_type id;
+    auto reloaded = PortDataCache::Instance().getData(source_, id);
+    if (reloaded && hasDataId_ && id == dataId_)
+    {
+      weakData_ = reloaded;
+      return reloaded;
+    }
+  }
   return DatatypeHandleOption();
 }
 
 void SimpleSink::setData(DatatypeHandle data)
 {
-  if (DatatypeHandle strong = weakData_.lock())
+  setData(data, data ? data->id() : 0, nullptr);
+}
+
+void SimpleSink::setData(DatatypeHandle data, Datatype::id_type dataId, const SimpleSource* source)
+{
+  if (data)
   {
-    if (data)
-    {
-      //std::cout << "\tSink.setData hasChanged is " << hasChanged_ << std::endl;
-      //std::cout << "\tSink.setData old id is " << strong->id() << " new id is " << data->id() << std::endl;
-      hasChanged_ = strong->id() != data->id();
-      //std::cout << "\tSink.setData hasChanged set to " << hasChanged_ << std::endl;
-    }
+    //std::cout << "\tSink.setData hasChanged is " << hasChanged_ << std::endl;
+    //std::cout << "\tSink.setData old id is " << dataId_ << " new id is " << dataId << std::endl;
+    hasChanged_ = !hasDataId_ || dataId_ != dataId;
+    //std::cout << "\tSink.setData hasChanged set to " << hasChanged_ << std::endl;
+    dataId_ = dataId;
+    hasDataId_ = true;
   }
-  else if (data)
+  else
   {
-    hasChanged_ = true;
-    //std::cout << "\tSink.setData: no previous weakData, hasChanged set to " << hasChanged_ << std::endl;
+    hasDataId_ = false;
   }
 
+  source_ = source;
   weakData_ = data;
   if (data && hasChanged_ && checkForNewDataOnSetting_)
     dataHasChanged_(data);
@@ -131,7 +150,7 @@ boost::signals2::connection SimpleSink::connectDataHasChanged(const DataHasChang
 
 void SimpleSource::cacheData(DatatypeHandle data)
 {
-  data_ = data;
+  PortDataCache::Instance().cacheData(this, data);
 }
 
 void SimpleSource::send(DatatypeSinkInterfaceHandle receiver) const
@@ -140,34 +159,40 @@ void SimpleSource::send(DatatypeSinkInterfaceHandle receiver) const
   if (!sink)
     THROW_INVALID_ARGUMENT("SimpleSource can only send to SimpleSinks");
 
-  sink->setData(data_);
+  Datatype::id_type id = 0;
+  auto data = PortDataCache::Instance().getData(this, id);
+  sink->setData(data, id, this);
 }
 
 bool SimpleSource::hasData() const
 {
-  return data_ != nullptr;
+  return PortDataCache::Instance().hasData(this);
+}
+
+DatatypeHandle SimpleSource::getData() const
+{
+  Datatype::id_type id;
+  return PortDataCache::Instance().getData(this, id);
 }
 
 SimpleSource::SimpleSource()
 {
-  instances_.insert(this);
+  PortDataCache::Instance().addSource(this);
 }
 
 SimpleSource::~SimpleSource()
 {
-  instances_.erase(this);
+  PortDataCache::Instance().removeSource(this);
 }
 
-std::set<SimpleSource*> SimpleSource::instances_;
-
 void SimpleSource::clearAllSources()
 {
-  for (SimpleSource* source : instances_)
-    source->data_.reset();
+  PortDataCache::Instance().clearAll();
 }
 
 std::string SimpleSource::describeData() const
 {
+  Datatype::id_type id;
   DescribeDatatype dd;
-  return dd.describe(data_);
+  return dd.describe(PortDataCache::Instance().getData(this, id));
 }
\ No newline at end of file
@@ -44,6 +44,8 @@ namespace SCIRun
     {
       typedef boost::weak_ptr<Core::Datatypes::DatatypeHandle::element_type> WeakDatatypeHandle;
 
+      class SimpleSource;
+
       class SCISHARE SimpleSink : public DatatypeSinkInterface
       {
       public:
@@ -54,6 +56,7 @@ namespace SCIRun
         virtual DatatypeSinkInterface* clone() const;
         virtual bool hasChanged() const;
         void setData(Core::Datatypes::DatatypeHandle data);
+        void setData(Core::Datatypes::DatatypeHandle data, Core::Datatypes::Datatype::id_type dataId, const SimpleSource* source);
         virtual void invalidateProvider() { /*TODO*/ }
         virtual boost::signals2::connection connectDataHasChanged(const DataHasChangedSignalType::slot_type& subscriber);
 
@@ -62,6 +65,10 @@ namespace SCIRun
 
       private:
         WeakDatatypeHandle weakData_;
+        // id of the data as originally cached upstream; survives a spill/reload round trip through PortDataCache.
+        Core::Datatypes::Datatype::id_type dataId_;
+        bool hasDataId_;
+        const SimpleSource* source_;
         mutable bool hasChanged_;
         DataHasChangedSignalType dataHasChanged_;
         bool checkForNewDataOnSetting_;
@@ -92,12 +99,13 @@ namespace SCIRun
         virtual void cacheData(Core::Datatypes::DatatypeHandle data) override;
         virtual void send(DatatypeSinkInterfaceHandle receiver) const override;
         virtual bool hasData() const override;
+        virtual Core::Datatypes::DatatypeHandle getData() const override;
         virtual std::string describeData() const override;
 
         static void clearAllSources();
       private:
+        friend class PortDataCache;
         SCIRun::Core::Datatypes::DatatypeHandle data_;
-        static std::set<SimpleSource*> instances_;
       };
     }
   }
@@ -33,6 +33,7 @@
 #include <Dataflow/Network/ModuleStateInterface.h>
 #include <Dataflow/Network/ModuleFactory.h>
 #include <Dataflow/Network/ModuleDescription.h>
+#include <Dataflow/Network/ModuleExecutionProfile.h>
 #include <boost/any.hpp>
 #include <gmock/gmock.h>
 
@@ -67,6 +68,7 @@ namespace SCIRun {
           MOCK_CONST_METHOD0(has_ui, bool());
           MOCK_CONST_METHOD0(hasDynamicPorts, bool());
           MOCK_CONST_METHOD0(metadata, const MetadataMap&());
+          MOCK_METHOD0(executionProfile, ModuleExecutionProfile&());
           MOCK_METHOD1(setUiVisible, void(bool));
           MOCK_METHOD1(set_id, void(const std::string&));
           MOCK_CONST_METHOD0(get_info, const ModuleLookupInfo&());
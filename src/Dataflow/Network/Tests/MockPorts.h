@@ -97,6 +97,7 @@ namespace SCIRun {
           MOCK_METHOD1(setId, void(const PortId&));
           MOCK_METHOD1(setIndex, void(size_t));
           MOCK_CONST_METHOD0(hasData, bool());
+          MOCK_CONST_METHOD0(getData, Core::Datatypes::DatatypeHandle());
           MOCK_CONST_METHOD0(getPortDataDescriber, PortDataDescriber());
           MOCK_METHOD1(connectConnectionFeedbackListener, boost::signals2::connection(const ConnectionFeedbackSignalType::slot_type&));
           MOCK_METHOD1(sendConnectionFeedback, void(SCIRun::Core::Algorithms::VariableHandle));
@@ -123,6 +124,7 @@ namespace SCIRun {
           MOCK_METHOD1(cacheData, void(Core::Datatypes::DatatypeHandle));
           MOCK_CONST_METHOD1(send, void(DatatypeSinkInterfaceHandle));
           MOCK_CONST_METHOD0(hasData, bool());
+          MOCK_CONST_METHOD0(getData, Core::Datatypes::DatatypeHandle());
           MOCK_CONST_METHOD0(describeData, std::string());
         };
 
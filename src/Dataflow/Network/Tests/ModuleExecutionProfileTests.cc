@@ -0,0 +1,149 @@
+/*
+For more information, please see: http://software.sci.utah.edu
+
+The MIT License
+
+Copyright (c) 2015 Scientific Computing and Imaging Institute,
+University of Utah.
+
+License for the specific language governing rights and limitations under
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Dataflow/Network/ModuleExecutionProfile.h>
+#include <Dataflow/Network/Module.h>
+#include <gtest/gtest.h>
+#include <sstream>
+
+using namespace SCIRun::Dataflow::Networks;
+
+namespace
+{
+  ModuleExecutionRecord makeRecord(const std::string& id, long long start)
+  {
+    ModuleExecutionRecord record;
+    record.moduleId = id;
+    record.startMicroseconds = start;
+    record.wallSeconds = 0.5;
+    record.inputBytes = 10;
+    record.outputBytes = 20;
+    record.succeeded = true;
+    return record;
+  }
+}
+
+TEST(ModuleExecutionProfileTests, KeepsMostRecentRecordsOldestFirst)
+{
+  ModuleExecutionProfile profile(3);
+  for (int i = 0; i < 5; ++i)
+    profile.add(makeRecord("M:0", i));
+
+  auto records = profile.records();
+  ASSERT_EQ(3, records.size());
+  EXPECT_EQ(2, records[0].startMicroseconds);
+  EXPECT_EQ(3, records[1].startMicroseconds);
+  EXPECT_EQ(4, records[2].startMicroseconds);
+  EXPECT_EQ(5, profile.totalExecutions());
+
+  profile.clear();
+  EXPECT_TRUE(profile.records().empty());
+  EXPECT_EQ(0, profile.totalExecutions());
+}
+
+TEST(ModuleExecutionProfileTests, ShrinkingCapacityKeepsNewestRecords)
+{
+  ModuleExecutionProfile profile(4);
+  for (int i = 0; i < 6; ++i)
+    profile.add(makeRecord("M:0", i));
+
+  profile.setCapacity(2);
+  auto records = profile.records();
+  ASSERT_EQ(2, records.size());
+  EXPECT_EQ(4, records[0].startMicroseconds);
+  EXPECT_EQ(5, records[1].startMicroseconds);
+
+  profile.add(makeRecord("M:0", 6));
+  records = profile.records();
+  ASSERT_EQ(2, records.size());
+  EXPECT_EQ(5, records[0].startMicroseconds);
+  EXPECT_EQ(6, records[1].startMicroseconds);
+}
+
+TEST(ModuleExecutionProfileTests, WritesCsv)
+{
+  std::vector<ModuleExecutionRecord> records { makeRecord("A:0", 100), makeRecord("B,1", 200) };
+  records[1].skipped = true;
+
+  std::ostringstream out;
+  ModuleExecutionProfile::writeCsv(out, records);
+
+  std::istringstream in(out.str());
+  std::string header, first, second;
+  std::getline(in, header);
+  std::getline(in, first);
+  std::getline(in, second);
+  EXPECT_EQ(0, header.find("module_id,start_us,wall_seconds"));
+  EXPECT_EQ("A:0,100,0.5,0,0,0,0,10,20,0,1,0", first);
+  EXPECT_EQ("\"B,1\",200,0.5,0,0,0,0,10,20,1,1,0", second);
+}
+
+TEST(ModuleExecutionProfileTests, WritesTraceEvents)
+{
+  std::vector<ModuleExecutionRecord> records { makeRecord("A:0", 100) };
+
+  std::ostringstream out;
+  ModuleExecutionProfile::writeTraceEvents(out, records);
+
+  auto trace = out.str();
+  EXPECT_NE(std::string::npos, trace.find("\"traceEvents\""));
+  EXPECT_NE(std::string::npos, trace.find("\"name\":\"A:0\""));
+  EXPECT_NE(std::string::npos, trace.find("\"ph\":\"X\""));
+  EXPECT_NE(std::string::npos, trace.find("\"ts\":100"));
+  EXPECT_NE(std::string::npos, trace.find("\"dur\":500000"));
+}
+
+TEST(ModuleExecutionProfileTests, SamplerMeasuresElapsedTime)
+{
+  ModuleExecutionSampler sampler;
+  volatile double sum = 0;
+  for (int i = 0; i < 1000000; ++i)
+    sum += i;
+
+  ModuleExecutionRecord record;
+  sampler.finish(record);
+  EXPECT_GT(record.startMicroseconds, 0);
+  EXPECT_GT(record.wallSeconds, 0);
+  EXPECT_GE(record.cpuSeconds, 0);
+}
+
+TEST(ModuleExecutionProfileTests, ModuleRecordsEachExecution)
+{
+  Module::resetIdGenerator();
+  ModuleHandle module = Module::Builder().with_name("SolveLinearSystem").build();
+
+  module->do_execute();
+  module->do_execute();
+
+  auto records = module->executionProfile().records();
+  ASSERT_EQ(2, records.size());
+  EXPECT_EQ("SolveLinearSystem:0", records[0].moduleId);
+  EXPECT_TRUE(records[0].succeeded);
+  EXPECT_FALSE(records[0].skipped);
+  EXPECT_LE(records[0].startMicroseconds, records[1].startMicroseconds);
+}
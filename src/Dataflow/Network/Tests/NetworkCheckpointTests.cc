@@ -0,0 +1,201 @@
+/*
+For more information, please see: http://software.sci.utah.edu
+
+The MIT License
+
+Copyright (c) 2015 Scientific Computing and Imaging Institute,
+University of Utah.
+
+License for the specific language governing rights and limitations under
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Dataflow/Network/NetworkCheckpoint.h>
+#include <Dataflow/Network/Tests/MockNetwork.h>
+#include <Dataflow/Network/Tests/MockModule.h>
+#include <Dataflow/Network/Tests/MockPorts.h>
+#include <Dataflow/Network/Tests/MockModuleState.h>
+#include <Core/Datatypes/DenseMatrix.h>
+#include <boost/filesystem.hpp>
+#include <gtest/gtest.h>
+#include <fstream>
+
+using namespace SCIRun::Dataflow::Networks;
+using namespace SCIRun::Dataflow::Networks::Mocks;
+using namespace SCIRun::Core::Datatypes;
+using ::testing::NiceMock;
+using ::testing::Return;
+using ::testing::_;
+
+namespace
+{
+  struct CheckpointedModule
+  {
+    CheckpointedModule(const std::string& name, bool needToExecute, DatatypeHandle data)
+      : module(new NiceMock<MockModule>), port(new NiceMock<MockOutputPort>)
+    {
+      ON_CALL(*module, get_id()).WillByDefault(Return(ModuleId("ReadMatrix:1")));
+      ON_CALL(*module, get_module_name()).WillByDefault(Return(name));
+      ON_CALL(*module, needToExecute()).WillByDefault(Return(needToExecute));
+      ON_CALL(*module, outputPorts()).WillByDefault(Return(std::vector<OutputPortHandle>(1, port)));
+      ON_CALL(*port, getIndex()).WillByDefault(Return(0));
+      ON_CALL(*port, hasData()).WillByDefault(Return(!!data));
+      ON_CALL(*port, getData()).WillByDefault(Return(data));
+
+      ON_CALL(network, nmodules()).WillByDefault(Return(1));
+      ON_CALL(network, module(0)).WillByDefault(Return(module));
+      ON_CALL(network, lookupModule(_)).WillByDefault(Return(module));
+      ON_CALL(network, connections()).WillByDefault(Return(NetworkInterface::ConnectionDescriptionList()));
+    }
+
+    boost::shared_ptr<NiceMock<MockModule>> module;
+    boost::shared_ptr<NiceMock<MockOutputPort>> port;
+    NiceMock<MockNetwork> network;
+  };
+}
+
+class NetworkCheckpointTest : public ::testing::Test
+{
+protected:
+  NetworkCheckpointTest() : networkFile_(boost::filesystem::temp_directory_path() / "scirun_checkpoint_test.srn5") {}
+
+  virtual void TearDown()
+  {
+    boost::filesystem::remove_all(NetworkCheckpoint(networkFile_).directory());
+  }
+
+  DenseMatrixHandle matrix() const
+  {
+    DenseMatrixHandle m(new DenseMatrix(2, 3));
+    *m << 1, 2, 3, 4, 5, 6;
+    return m;
+  }
+
+  boost::filesystem::path networkFile_;
+};
+
+namespace
+{
+  ModuleStateHandle stateWithFile(const boost::filesystem::path& file)
+  {
+    auto state = boost::make_shared<NiceMock<MockModuleState>>();
+    const ModuleStateInterface::Name name("Filename");
+    ON_CALL(*state, getKeys()).WillByDefault(Return(ModuleStateInterface::Keys(1, name)));
+    ON_CALL(*state, getValue(_)).WillByDefault(Return(ModuleStateInterface::Value(name, file.string())));
+    return state;
+  }
+}
+
+TEST_F(NetworkCheckpointTest, DirectoryIsNextToNetworkFile)
+{
+  NetworkCheckpoint checkpoint(networkFile_);
+  EXPECT_EQ(networkFile_.parent_path() / "scirun_checkpoint_test_checkpoint", checkpoint.directory());
+}
+
+TEST_F(NetworkCheckpointTest, RestoresSavedOutputs)
+{
+  NetworkCheckpoint checkpoint(networkFile_);
+  {
+    CheckpointedModule saved("ReadMatrix", false, matrix());
+    EXPECT_EQ(1u, checkpoint.save(saved.network));
+  }
+
+  CheckpointedModule loaded("ReadMatrix", true, DatatypeHandle());
+  DatatypeHandle sent;
+  EXPECT_CALL(*loaded.port, sendData(_)).WillOnce(::testing::SaveArg<0>(&sent));
+  EXPECT_EQ(1u, checkpoint.restore(loaded.network));
+
+  auto restored = boost::dynamic_pointer_cast<DenseMatrix>(sent);
+  ASSERT_TRUE(!!restored);
+  EXPECT_TRUE(restored->isApprox(*matrix()));
+}
+
+TEST_F(NetworkCheckpointTest, SkipsModulesThatNeedToExecute)
+{
+  NetworkCheckpoint checkpoint(networkFile_);
+  CheckpointedModule module("ReadMatrix", true, matrix());
+  EXPECT_EQ(0u, checkpoint.save(module.network));
+}
+
+TEST_F(NetworkCheckpointTest, IgnoresEntriesOfChangedModules)
+{
+  NetworkCheckpoint checkpoint(networkFile_);
+  {
+    CheckpointedModule saved("ReadMatrix", false, matrix());
+    EXPECT_EQ(1u, checkpoint.save(saved.network));
+  }
+
+  CheckpointedModule changed("ReadField", true, DatatypeHandle());
+  EXPECT_CALL(*changed.port, sendData(_)).Times(0);
+  EXPECT_EQ(0u, checkpoint.restore(changed.network));
+}
+
+TEST_F(NetworkCheckpointTest, SaveKeepsFilesItDidNotWrite)
+{
+  NetworkCheckpoint checkpoint(networkFile_);
+  boost::filesystem::create_directories(checkpoint.directory());
+  const auto notes = checkpoint.directory() / "notes.txt";
+  std::ofstream(notes.string().c_str()) << "not a checkpoint file";
+
+  CheckpointedModule module("ReadMatrix", false, matrix());
+  EXPECT_EQ(1u, checkpoint.save(module.network));
+  EXPECT_TRUE(boost::filesystem::exists(notes));
+}
+
+TEST_F(NetworkCheckpointTest, SaveRemovesFilesOfThePreviousCheckpoint)
+{
+  NetworkCheckpoint checkpoint(networkFile_);
+  {
+    CheckpointedModule saved("ReadMatrix", false, matrix());
+    EXPECT_EQ(1u, checkpoint.save(saved.network));
+  }
+  const auto data = checkpoint.directory() / "ReadMatrix_1_0.mat";
+  EXPECT_TRUE(boost::filesystem::exists(data));
+
+  CheckpointedModule stale("ReadMatrix", true, matrix());
+  EXPECT_EQ(0u, checkpoint.save(stale.network));
+  EXPECT_FALSE(boost::filesystem::exists(data));
+  EXPECT_TRUE(boost::filesystem::exists(checkpoint.directory() / "checkpoint.txt"));
+}
+
+TEST_F(NetworkCheckpointTest, IgnoresEntriesWhenTheInputFileChanged)
+{
+  const auto input = boost::filesystem::temp_directory_path() / "scirun_checkpoint_test_input.txt";
+  std::ofstream(input.string().c_str()) << "1 2 3";
+
+  NetworkCheckpoint checkpoint(networkFile_);
+  {
+    CheckpointedModule saved("ReadMatrix", false, matrix());
+    ON_CALL(*saved.module, get_state()).WillByDefault(Return(stateWithFile(input)));
+    EXPECT_EQ(1u, checkpoint.save(saved.network));
+  }
+  {
+    CheckpointedModule unchanged("ReadMatrix", true, DatatypeHandle());
+    ON_CALL(*unchanged.module, get_state()).WillByDefault(Return(stateWithFile(input)));
+    EXPECT_EQ(1u, checkpoint.restore(unchanged.network));
+  }
+
+  std::ofstream(input.string().c_str(), std::ios::app) << " 4";
+  CheckpointedModule changed("ReadMatrix", true, DatatypeHandle());
+  ON_CALL(*changed.module, get_state()).WillByDefault(Return(stateWithFile(input)));
+  EXPECT_CALL(*changed.port, sendData(_)).Times(0);
+  EXPECT_EQ(0u, checkpoint.restore(changed.network));
+
+  boost::filesystem::remove(input);
+}
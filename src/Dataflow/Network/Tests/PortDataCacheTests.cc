@@ -0,0 +1,186 @@
+/*
+For more information, please see: http://software.sci.utah.edu
+
+The MIT License
+
+Copyright (c) 2015 Scientific Computing and Imaging Institute,
+University of Utah.
+
+License for the specific language governing rights and limitations under
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Dataflow/Network/PortDataCache.h>
+#include <Dataflow/Network/SimpleSourceSink.h>
+#include <Core/Datatypes/DenseMatrix.h>
+#include <Core/Datatypes/MatrixComparison.h>
+#include <boost/filesystem.hpp>
+#include <gtest/gtest.h>
+
+using namespace SCIRun::Dataflow::Networks;
+using namespace SCIRun::Core::Datatypes;
+
+namespace
+{
+  DenseMatrixHandle bigMatrix(double value)
+  {
+    DenseMatrixHandle m(new DenseMatrix(100, 100));
+    m->fill(value);
+    return m;
+  }
+
+  const size_t MatrixBytes = 100 * 100 * sizeof(double);
+}
+
+class PortDataCacheTest : public ::testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    directory_ = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("scirun_port_cache_test_%%%%-%%%%");
+  }
+
+  virtual void TearDown()
+  {
+    auto& cache = PortDataCache::Instance();
+    cache.setMemoryBudget(0);
+    cache.setSpillDirectory(PortDataCache::defaultSpillDirectory());
+    boost::system::error_code ec;
+    boost::filesystem::remove_all(directory_, ec);
+  }
+
+  boost::filesystem::path directory_;
+};
+
+TEST_F(PortDataCacheTest, TracksResidentBytesWithoutBudget)
+{
+  auto& cache = PortDataCache::Instance();
+  const auto before = cache.residentBytes();
+  {
+    SimpleSource source;
+    source.cacheData(bigMatrix(1));
+    EXPECT_EQ(before + MatrixBytes, cache.residentBytes());
+    EXPECT_TRUE(source.hasData());
+  }
+  EXPECT_EQ(before, cache.residentBytes());
+}
+
+TEST_F(PortDataCacheTest, EvictsLeastRecentlyUsedAndReloadsOnReceive)
+{
+  auto& cache = PortDataCache::Instance();
+  cache.setMemoryBudget(cache.residentBytes() + MatrixBytes + MatrixBytes / 2);
+  const auto spillsBefore = cache.spillCount();
+
+  SimpleSource source1, source2;
+  boost::shared_ptr<SimpleSink> sink(new SimpleSink);
+
+  source1.cacheData(bigMatrix(1));
+  source1.send(sink);
+  EXPECT_TRUE(sink->hasChanged());
+
+  source2.cacheData(bigMatrix(2));
+  EXPECT_EQ(spillsBefore + 1, cache.spillCount());
+  EXPECT_TRUE(source1.hasData());
+
+  auto received = sink->receive();
+  ASSERT_TRUE(!!received);
+  auto matrix = boost::dynamic_pointer_cast<DenseMatrix>(*received);
+  ASSERT_TRUE(matrix != nullptr);
+  EXPECT_EQ(*bigMatrix(1), *matrix);
+
+  // reloading the same data is not a change from the receiver's point of view.
+  source1.send(sink);
+  EXPECT_FALSE(sink->hasChanged());
+}
+
+TEST_F(PortDataCacheTest, DataHeldDownstreamIsNotSpilled)
+{
+  auto& cache = PortDataCache::Instance();
+  cache.setMemoryBudget(cache.residentBytes() + MatrixBytes);
+  const auto spillsBefore = cache.spillCount();
+
+  SimpleSource source1, source2;
+  auto held = bigMatrix(1);
+  source1.cacheData(held);
+  source2.cacheData(bigMatrix(2));
+
+  EXPECT_EQ(spillsBefore, cache.spillCount());
+}
+
+TEST_F(PortDataCacheTest, LeastRecentlyUsedIsSpilledFirst)
+{
+  auto& cache = PortDataCache::Instance();
+  cache.setMemoryBudget(cache.residentBytes() + 2 * MatrixBytes + MatrixBytes / 2);
+  const auto spillsBefore = cache.spillCount();
+
+  SimpleSource source1, source2, source3;
+  source1.cacheData(bigMatrix(1));
+  source2.cacheData(bigMatrix(2));
+  WeakDatatypeHandle data2 = source2.getData();
+  // reading source1 makes source2 the least recently used
+  WeakDatatypeHandle data1 = source1.getData();
+
+  source3.cacheData(bigMatrix(3));
+  EXPECT_EQ(spillsBefore + 1, cache.spillCount());
+  EXPECT_FALSE(data1.expired());
+  EXPECT_TRUE(data2.expired());
+
+  auto reloaded = boost::dynamic_pointer_cast<DenseMatrix>(source2.getData());
+  ASSERT_TRUE(reloaded != nullptr);
+  EXPECT_EQ(*bigMatrix(2), *reloaded);
+}
+
+TEST_F(PortDataCacheTest, SpillDirectoryIsCreatedOwnerOnly)
+{
+  auto& cache = PortDataCache::Instance();
+  cache.setSpillDirectory(directory_);
+  cache.setMemoryBudget(cache.residentBytes() + MatrixBytes + MatrixBytes / 2);
+  const auto spillsBefore = cache.spillCount();
+
+  SimpleSource source1, source2;
+  source1.cacheData(bigMatrix(1));
+  source2.cacheData(bigMatrix(2));
+
+  EXPECT_EQ(spillsBefore + 1, cache.spillCount());
+  ASSERT_TRUE(boost::filesystem::is_directory(directory_));
+  EXPECT_EQ(boost::filesystem::owner_all, boost::filesystem::status(directory_).permissions());
+  EXPECT_FALSE(boost::filesystem::is_empty(directory_));
+}
+
+TEST_F(PortDataCacheTest, SharedSpillDirectoryIsNotUsed)
+{
+  boost::filesystem::create_directories(directory_);
+  boost::filesystem::permissions(directory_, boost::filesystem::owner_all | boost::filesystem::group_read | boost::filesystem::others_read);
+
+  auto& cache = PortDataCache::Instance();
+  cache.setSpillDirectory(directory_);
+  const auto residentBefore = cache.residentBytes();
+  cache.setMemoryBudget(residentBefore + MatrixBytes + MatrixBytes / 2);
+  const auto spillsBefore = cache.spillCount();
+
+  SimpleSource source1, source2;
+  source1.cacheData(bigMatrix(1));
+  WeakDatatypeHandle data1 = source1.getData();
+  source2.cacheData(bigMatrix(2));
+
+  EXPECT_EQ(spillsBefore, cache.spillCount());
+  EXPECT_FALSE(data1.expired());
+  EXPECT_EQ(residentBefore + 2 * MatrixBytes, cache.residentBytes());
+  EXPECT_TRUE(boost::filesystem::is_empty(directory_));
+}
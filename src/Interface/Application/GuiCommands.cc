@@ -41,6 +41,7 @@ DEALINGS IN THE SOFTWARE.
 #include <Dataflow/Serialization/Network/NetworkDescriptionSerialization.h>
 #include <Dataflow/Serialization/Network/Importer/NetworkIO.h>
 #include <Dataflow/Engine/Controller/NetworkEditorController.h>
+#include <Dataflow/Network/NetworkCheckpoint.h>
 #include <Interface/Application/Utility.h>
 #include <Core/Logging/Log.h>
 #include <boost/range/adaptors.hpp>
@@ -194,6 +195,13 @@ bool NetworkFileProcessCommand::execute()
       }
       file_ = file;
 
+      if (Core::Application::Instance().parameters()->networkCheckpoints())
+      {
+        auto restored = NetworkCheckpoint(filename).restore(*Application::Instance().controller()->getNetwork());
+        if (restored > 0)
+          GuiLogger::Instance().logInfoStd("Restored output data of " + std::to_string(restored) + " modules from checkpoint.");
+      }
+
       QPointF center = findCenterOfNetworkFile(*file);
       networkEditor_->centerOn(center);
 
@@ -270,6 +278,8 @@ bool NetworkSaveCommand::execute()
   auto file = Application::Instance().controller()->saveNetwork();
 
   XMLSerializer::save_xml(*file, fileNameWithExtension, "networkFile");
+  if (Application::Instance().parameters()->networkCheckpoints())
+    NetworkCheckpoint(fileNameWithExtension).save(*Application::Instance().controller()->getNetwork());
   SCIRunMainWindow::Instance()->setCurrentFile(QString::fromStdString(fileNameWithExtension));
 
   SCIRunMainWindow::Instance()->statusBar()->showMessage("File saved: " + QString::fromStdString(filename), 2000);
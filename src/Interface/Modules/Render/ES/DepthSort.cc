@@ -0,0 +1,344 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Interface/Modules/Render/ES/DepthSort.h>
+#include <Core/Thread/Parallel.h>
+#include <algorithm>
+#include <cstring>
+
+using namespace SCIRun::Render;
+using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Thread;
+using namespace SCIRun::Graphics::Datatypes;
+
+namespace
+{
+  const int RADIX_BITS = 8;
+  const int RADIX_SIZE = 1 << RADIX_BITS;
+  const size_t MIN_ITEMS_PER_TASK = 1 << 16;
+
+  int numSortTasks(size_t n)
+  {
+    size_t tasks = std::min<size_t>(Parallel::NumCores(), n / MIN_ITEMS_PER_TASK);
+    return static_cast<int>(std::max<size_t>(1, tasks));
+  }
+
+  // Maps floats onto unsigned integers that compare in the same order.
+  uint32_t sortableKey(float f)
+  {
+    uint32_t u;
+    std::memcpy(&u, &f, sizeof(u));
+    return (u & 0x80000000u) ? ~u : (u | 0x80000000u);
+  }
+}
+
+void SCIRun::Render::radixSortByKey(const std::vector<float>& keys, std::vector<uint32_t>& order)
+{
+  const size_t n = keys.size();
+  const int ntasks = numSortTasks(n);
+  const size_t chunk = (n + ntasks - 1) / ntasks;
+
+  std::vector<uint32_t> ukeys(n), ukeysTmp(n), orderTmp(n);
+  order.resize(n);
+
+  Parallel::RunTasks([&](int t)
+  {
+    size_t end = std::min(n, (t + 1) * chunk);
+    for (size_t j = t * chunk; j < end; ++j)
+    {
+      ukeys[j] = sortableKey(keys[j]);
+      order[j] = static_cast<uint32_t>(j);
+    }
+  }, ntasks);
+
+  std::vector<size_t> counts(ntasks * RADIX_SIZE);
+  for (int shift = 0; shift < 32; shift += RADIX_BITS)
+  {
+    std::fill(counts.begin(), counts.end(), 0);
+    Parallel::RunTasks([&](int t)
+    {
+      size_t* count = &counts[t * RADIX_SIZE];
+      size_t end = std::min(n, (t + 1) * chunk);
+      for (size_t j = t * chunk; j < end; ++j)
+        count[(ukeys[j] >> shift) & (RADIX_SIZE - 1)]++;
+    }, ntasks);
+
+    // Keys that all share this digit need no pass.
+    bool trivial = false;
+    for (int d = 0; d < RADIX_SIZE && !trivial; ++d)
+    {
+      size_t total = 0;
+      for (int t = 0; t < ntasks; ++t) total += counts[t * RADIX_SIZE + d];
+      trivial = (total == n);
+    }
+    if (trivial) continue;
+
+    // Turn the counts into the output offset of every (digit, task) pair;
+    // tasks scatter in order, which keeps the sort stable.
+    size_t offset = 0;
+    for (int d = 0; d < RADIX_SIZE; ++d)
+    {
+      for (int t = 0; t < ntasks; ++t)
+      {
+        size_t c = counts[t * RADIX_SIZE + d];
+        counts[t * RADIX_SIZE + d] = offset;
+        offset += c;
+      }
+    }
+
+    Parallel::RunTasks([&](int t)
+    {
+      size_t* pos = &counts[t * RADIX_SIZE];
+      size_t end = std::min(n, (t + 1) * chunk);
+      for (size_t j = t * chunk; j < end; ++j)
+      {
+        size_t p = pos[(ukeys[j] >> shift) & (RADIX_SIZE - 1)]++;
+        ukeysTmp[p] = ukeys[j];
+        orderTmp[p] = order[j];
+      }
+    }, ntasks);
+
+    ukeys.swap(ukeysTmp);
+    order.swap(orderTmp);
+  }
+}
+
+void SCIRun::Render::sortTrianglesByDepth(const char* vbo, size_t stride,
+  const uint32_t* ibo, size_t numTriangles, const Vector& dir, std::vector<uint32_t>& order)
+{
+  const float dx = static_cast<float>(dir.x());
+  const float dy = static_cast<float>(dir.y());
+  const float dz = static_cast<float>(dir.z());
+
+  std::vector<float> depth(numTriangles);
+  const int ntasks = numSortTasks(numTriangles);
+  const size_t chunk = (numTriangles + ntasks - 1) / ntasks;
+
+  Parallel::RunTasks([&](int t)
+  {
+    size_t end = std::min(numTriangles, (t + 1) * chunk);
+    for (size_t j = t * chunk; j < end; ++j)
+    {
+      float d = 0.0f;
+      for (int k = 0; k < 3; ++k)
+      {
+        const float* vertex = reinterpret_cast<const float*>(vbo + stride * ibo[j * 3 + k]);
+        d += dx * vertex[0] + dy * vertex[1] + dz * vertex[2];
+      }
+      depth[j] = d;
+    }
+  }, ntasks);
+
+  radixSortByKey(depth, order);
+}
+
+void SCIRun::Render::applyTriangleOrder(const uint32_t* ibo, const std::vector<uint32_t>& order,
+  std::vector<uint32_t>& sorted)
+{
+  sorted.resize(order.size() * 3);
+  for (size_t j = 0; j < order.size(); ++j)
+  {
+    const uint32_t* tri = ibo + static_cast<size_t>(order[j]) * 3;
+    sorted[j * 3] = tri[0];
+    sorted[j * 3 + 1] = tri[1];
+    sorted[j * 3 + 2] = tri[2];
+  }
+}
+
+const size_t DepthSortCache::MAX_QUEUED_SORTS;
+
+DepthSortCache::DepthSortCache() : busy_(false), stop_(false)
+{
+}
+
+DepthSortCache::~DepthSortCache()
+{
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    stop_ = true;
+    queue_.clear();
+  }
+  wake_.notify_all();
+  if (worker_.joinable())
+    worker_.join();
+}
+
+Vector DepthSortCache::direction(Axis axis)
+{
+  switch (axis)
+  {
+  case POS_X: return Vector(1.0, 0.0, 0.0);
+  case POS_Y: return Vector(0.0, 1.0, 0.0);
+  case POS_Z: return Vector(0.0, 0.0, 1.0);
+  case NEG_X: return Vector(-1.0, 0.0, 0.0);
+  case NEG_Y: return Vector(0.0, -1.0, 0.0);
+  case NEG_Z: return Vector(0.0, 0.0, -1.0);
+  default: return Vector(0.0, 0.0, 0.0);
+  }
+}
+
+DepthSortCache::Entry& DepthSortCache::entry(const SpireSubPass& pass)
+{
+  Entry& entry = entries_[pass.ibo.name];
+
+  // A new buffer under the same name invalidates the old orderings; sorts
+  // still running for the old buffer will find a different source and drop
+  // their result.
+  if (entry.source.lock() != pass.ibo.data)
+  {
+    entry = Entry();
+    entry.source = pass.ibo.data;
+  }
+  return entry;
+}
+
+bool DepthSortCache::schedule(Entry& entry, const SpireSubPass& pass, int slot, const Vector& dir)
+{
+  if (queue_.size() >= MAX_QUEUED_SORTS)
+    return false;
+
+  Task task;
+  task.name = pass.ibo.name;
+  task.slot = slot;
+  task.dir = dir;
+  task.vbo = pass.vbo.data;
+  task.stride = 0;
+  for (const auto& a : pass.vbo.attributes)
+    task.stride += a.sizeInBytes;
+  task.ibo = pass.ibo.data;
+
+  queue_.push_back(task);
+  entry.pending[slot] = true;
+
+  if (!worker_.joinable())
+    worker_ = std::thread(&DepthSortCache::run, this);
+  wake_.notify_one();
+  return true;
+}
+
+DepthSortCache::Permutation DepthSortCache::get(const SpireSubPass& pass, Axis axis)
+{
+  std::lock_guard<std::mutex> guard(lock_);
+  Entry& e = entry(pass);
+
+  if (!e.orders[axis] && !e.pending[axis])
+    schedule(e, pass, axis, direction(axis));
+  return e.orders[axis];
+}
+
+bool DepthSortCache::requestView(const SpireSubPass& pass, const Vector& dir)
+{
+  std::lock_guard<std::mutex> guard(lock_);
+  Entry& e = entry(pass);
+
+  if (e.pending[VIEW])
+    return false;
+  if (e.orders[VIEW] && e.viewDir == dir)
+    return true;
+  if (!schedule(e, pass, VIEW, dir))
+    return false;
+  e.viewDir = dir;
+  return true;
+}
+
+DepthSortCache::Permutation DepthSortCache::view(const SpireSubPass& pass, uint64_t& version)
+{
+  std::lock_guard<std::mutex> guard(lock_);
+  Entry& e = entry(pass);
+  version = e.viewVersion;
+  return e.orders[VIEW];
+}
+
+void DepthSortCache::clear(const std::string& iboName)
+{
+  std::lock_guard<std::mutex> guard(lock_);
+  entries_.erase(iboName);
+  queue_.erase(std::remove_if(queue_.begin(), queue_.end(),
+    [&](const Task& task) { return task.name == iboName; }), queue_.end());
+}
+
+void DepthSortCache::clear()
+{
+  std::lock_guard<std::mutex> guard(lock_);
+  entries_.clear();
+  queue_.clear();
+}
+
+void DepthSortCache::retain(const std::set<std::string>& iboNames)
+{
+  std::lock_guard<std::mutex> guard(lock_);
+  for (auto it = entries_.begin(); it != entries_.end();)
+  {
+    if (iboNames.count(it->first) == 0)
+      it = entries_.erase(it);
+    else
+      ++it;
+  }
+  queue_.erase(std::remove_if(queue_.begin(), queue_.end(),
+    [&](const Task& task) { return iboNames.count(task.name) == 0; }), queue_.end());
+}
+
+void DepthSortCache::wait()
+{
+  std::unique_lock<std::mutex> guard(lock_);
+  idle_.wait(guard, [this]() { return queue_.empty() && !busy_; });
+}
+
+void DepthSortCache::run()
+{
+  std::unique_lock<std::mutex> guard(lock_);
+  while (true)
+  {
+    wake_.wait(guard, [this]() { return stop_ || !queue_.empty(); });
+    if (stop_)
+      break;
+
+    Task task = queue_.front();
+    queue_.pop_front();
+    busy_ = true;
+    guard.unlock();
+
+    auto order = std::make_shared<std::vector<uint32_t>>();
+    size_t numTriangles = task.ibo->getBufferSize() / (sizeof(uint32_t) * 3);
+    sortTrianglesByDepth(reinterpret_cast<const char*>(task.vbo->getBuffer()), task.stride,
+      reinterpret_cast<const uint32_t*>(task.ibo->getBuffer()), numTriangles, task.dir, *order);
+
+    guard.lock();
+    busy_ = false;
+    auto it = entries_.find(task.name);
+    if (it != entries_.end() && it->second.source.lock() == task.ibo)
+    {
+      it->second.orders[task.slot] = order;
+      it->second.pending[task.slot] = false;
+      if (task.slot == VIEW)
+        it->second.viewVersion++;
+    }
+    if (queue_.empty())
+      idle_.notify_all();
+  }
+}
@@ -0,0 +1,172 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef INTERFACE_MODULES_RENDER_ES_DEPTHSORT_H
+#define INTERFACE_MODULES_RENDER_ES_DEPTHSORT_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include <Core/GeometryPrimitives/Vector.h>
+#include <Graphics/Datatypes/GeometryImpl.h>
+#include <Interface/Modules/Render/share.h>
+
+namespace SCIRun {
+namespace Render {
+
+/// Stable parallel LSD radix sort of float keys. On return \p order holds the
+/// indices of \p keys in ascending key order.
+SCISHARE void radixSortByKey(const std::vector<float>& keys, std::vector<uint32_t>& order);
+
+/// Orders the triangles of an indexed triangle list by their depth along
+/// \p dir (sum of the vertex projections, smallest first).
+/// \param  vbo           Vertex data; positions are the first three floats.
+/// \param  stride        Stride between vertices in bytes.
+/// \param  ibo           Triangle list with 32-bit indices.
+/// \param  numTriangles  Number of triangles in \p ibo.
+/// \param  order         Output permutation of triangle indices.
+SCISHARE void sortTrianglesByDepth(const char* vbo, size_t stride,
+                                   const uint32_t* ibo, size_t numTriangles,
+                                   const Core::Geometry::Vector& dir,
+                                   std::vector<uint32_t>& order);
+
+/// Writes the triangles of \p ibo in the order given by \p order.
+SCISHARE void applyTriangleOrder(const uint32_t* ibo, const std::vector<uint32_t>& order,
+                                 std::vector<uint32_t>& sorted);
+
+/// Triangle orderings for the six axis directions used by the list based
+/// transparency sort, and for the current view direction used by the
+/// continuous and update sorts. Orderings are only computed when requested,
+/// on a worker thread fed by a bounded queue, and are stored as 32-bit
+/// triangle permutations rather than copies of the index buffer.
+class SCISHARE DepthSortCache
+{
+public:
+  enum Axis
+  {
+    POS_X,
+    POS_Y,
+    POS_Z,
+    NEG_X,
+    NEG_Y,
+    NEG_Z,
+    NUM_AXES
+  };
+
+  typedef std::shared_ptr<const std::vector<uint32_t>> Permutation;
+
+  /// Sorts that can wait for the worker; requests made while the queue is
+  /// full are dropped and have to be made again on a later frame.
+  static const size_t MAX_QUEUED_SORTS = 16;
+
+  DepthSortCache();
+  /// Drops the queued sorts and joins the worker.
+  ~DepthSortCache();
+
+  DepthSortCache(const DepthSortCache&) = delete;
+  DepthSortCache& operator=(const DepthSortCache&) = delete;
+
+  /// Returns the ordering of the pass' triangles along \p axis if it is
+  /// available. Otherwise schedules it (once) and returns null; callers
+  /// should keep drawing with the unsorted buffer in the meantime.
+  Permutation get(const Graphics::Datatypes::SpireSubPass& pass, Axis axis);
+
+  /// Schedules sorting the pass' triangles along \p dir. Returns false if
+  /// the previous view sort of this buffer is still running or the queue is
+  /// full, in which case the request has to be repeated.
+  bool requestView(const Graphics::Datatypes::SpireSubPass& pass, const Core::Geometry::Vector& dir);
+
+  /// Returns the latest completed view ordering of the pass, which may be
+  /// for an earlier direction, or null if none has completed yet.
+  /// \p version changes whenever a newer ordering becomes available.
+  Permutation view(const Graphics::Datatypes::SpireSubPass& pass, uint64_t& version);
+
+  /// Forgets all orderings of the named index buffer.
+  void clear(const std::string& iboName);
+
+  /// Forgets all orderings and drops the queued sorts.
+  void clear();
+
+  /// Forgets the orderings of all index buffers not named in \p iboNames.
+  void retain(const std::set<std::string>& iboNames);
+
+  /// Blocks until all queued and running sorts are done.
+  void wait();
+
+  static Core::Geometry::Vector direction(Axis axis);
+
+private:
+  // Orderings are kept per axis, plus one slot for the view direction.
+  static const int VIEW = NUM_AXES;
+  static const int NUM_SLOTS = NUM_AXES + 1;
+
+  struct Entry
+  {
+    Entry() : viewVersion(0) { for (int i = 0; i < NUM_SLOTS; ++i) pending[i] = false; }
+    std::weak_ptr<CPM_VAR_BUFFER_NS::VarBuffer> source;
+    Permutation             orders[NUM_SLOTS];
+    bool                    pending[NUM_SLOTS];
+    Core::Geometry::Vector  viewDir;
+    uint64_t                viewVersion;
+  };
+
+  struct Task
+  {
+    std::string             name;
+    int                     slot;
+    Core::Geometry::Vector  dir;
+    std::shared_ptr<CPM_VAR_BUFFER_NS::VarBuffer> vbo;
+    size_t                  stride;
+    std::shared_ptr<CPM_VAR_BUFFER_NS::VarBuffer> ibo;
+  };
+
+  Entry& entry(const Graphics::Datatypes::SpireSubPass& pass);
+  bool schedule(Entry& entry, const Graphics::Datatypes::SpireSubPass& pass,
+    int slot, const Core::Geometry::Vector& dir);
+  void run();
+
+  std::mutex                    lock_;
+  std::condition_variable       wake_;
+  std::condition_variable       idle_;
+  std::map<std::string, Entry>  entries_;
+  std::deque<Task>              queue_;
+  bool                          busy_;
+  bool                          stop_;
+  std::thread                   worker_;
+};
+
+}} // namespace SCIRun::Render
+
+#endif
@@ -148,27 +148,6 @@ namespace SCIRun {
 
     private:
 
-      class DepthIndex {
-      public:
-        size_t mIndex;
-        double mDepth;
-
-        DepthIndex() :
-          mIndex(0),
-          mDepth(0.0)
-        {}
-
-        DepthIndex(size_t index, double depth) :
-          mIndex(index),
-          mDepth(depth)
-        {}
-
-        bool operator<(const DepthIndex& di) const
-        {
-          return this->mDepth < di.mDepth;
-        }
-      };
-
       class SRObject
       {
       public:
@@ -54,6 +54,7 @@
 #include "../comp/RenderList.h"
 #include "../comp/StaticWorldLight.h"
 #include "../comp/LightingUniforms.h"
+#include "../DepthSort.h"
 
 namespace es = CPM_ES_NS;
 namespace shaders = CPM_GL_SHADERS_NS;
@@ -101,103 +102,174 @@ public:
                                   ren::MatUniform>(type);
   }
 
+  ~RenderBasicSysTrans()
+  {
+    depthLists.clear();
+  }
+
+  /// Forgets the sorted index buffers of objects that were not drawn in
+  /// the last walk, i.e. that have left the scene.
+  void postWalkComponents(es::ESCoreBase&) override
+  {
+    std::shared_ptr<ren::IBOMan> iboMan = mIBOMan.lock();
+
+    for (auto it = sortedObjects.begin(); it != sortedObjects.end();)
+    {
+      if (mDrawn.count(it->first) == 0)
+      {
+        if (iboMan && it->second.mSortedID != 0)
+          iboMan->removeInMemoryIBO(it->second.mSortedID);
+        it = sortedObjects.erase(it);
+      }
+      else
+        ++it;
+    }
+
+    for (auto it = sortedLists.begin(); it != sortedLists.end();)
+    {
+      if (mDrawn.count(it->first) == 0)
+      {
+        for (int i = 0; iboMan && i < DepthSortCache::NUM_AXES; ++i)
+        {
+          if (it->second.mIDs[i] != 0)
+            iboMan->removeInMemoryIBO(it->second.mIDs[i]);
+        }
+        it = sortedLists.erase(it);
+      }
+      else
+        ++it;
+    }
+
+    depthLists.retain(mDrawn);
+    mDrawn.clear();
+  }
+
 private:
+  /// Index buffer sorted along the view direction, for the continuous and
+  /// update sorts.
   class SortedObject
   {
   public:
-    std::string mName;
+    std::weak_ptr<CPM_VAR_BUFFER_NS::VarBuffer> mSource;
     GLuint mSortedID;
+    uint64_t mVersion;
+    bool mRequested;
     Core::Geometry::Vector prevDir = Core::Geometry::Vector(0.0);
 
     SortedObject() :
-      mSortedID(0)
-    {}
-
-    SortedObject(const std::string& name, GLuint ID, Core::Geometry::Vector& dir) :
-      mName(name),
-      mSortedID(ID),
-      prevDir(dir)
+      mSortedID(0),
+      mVersion(0),
+      mRequested(false)
     {}
   };
 
-  std::vector<SortedObject> sortedObjects;
+  std::map<std::string, SortedObject> sortedObjects;
 
-  class DepthIndex {
+  /// Index buffers uploaded for the list sort, one per axis direction.
+  class SortedLists
+  {
   public:
-    size_t mIndex;
-    double mDepth;
-
-    DepthIndex() :
-      mIndex(0),
-      mDepth(0.0)
-    {}
+    std::weak_ptr<CPM_VAR_BUFFER_NS::VarBuffer> mSource;
+    GLuint mIDs[DepthSortCache::NUM_AXES];
 
-    DepthIndex(size_t index, double depth) :
-      mIndex(index),
-      mDepth(depth)
-    {}
-
-    bool operator<(const DepthIndex& di) const
+    SortedLists()
     {
-      return this->mDepth < di.mDepth;
+      for (int i = 0; i < DepthSortCache::NUM_AXES; ++i)
+        mIDs[i] = 0;
     }
   };
 
-  GLuint sortObjects(const Core::Geometry::Vector& dir,
+  DepthSortCache depthLists;
+  std::map<std::string, SortedLists> sortedLists;
+  std::set<std::string> mDrawn;
+  std::weak_ptr<ren::IBOMan> mIBOMan;
+
+  /// Returns the index buffer sorted along the view direction. A new sort
+  /// is requested once the direction has moved by at least \p minChange;
+  /// it runs in the background and the previous ordering (or the unsorted
+  /// buffer) is drawn until it completes.
+  GLuint sortedViewObject(const Core::Geometry::Vector& dir, double minChange,
     const es::ComponentGroup<ren::IBO>& ibo,
     const es::ComponentGroup<SpireSubPass>& pass,
     const es::ComponentGroup<ren::StaticIBOMan>& iboMan)
   {
-    char* vbo_buffer = reinterpret_cast<char*>(pass.front().vbo.data->getBuffer());
-    uint32_t* ibo_buffer = reinterpret_cast<uint32_t*>(pass.front().ibo.data->getBuffer());
-    size_t num_triangles = pass.front().ibo.data->getBufferSize() / (sizeof(uint32_t) * 3);
-
-    size_t stride_vbo = 0;
-    for (auto a : pass.front().vbo.attributes)
-      stride_vbo += a.sizeInBytes;
-
-    std::vector<DepthIndex> rel_depth(num_triangles);
-
+    const SpireIBO& spireIBO = pass.front().ibo;
+    SortedObject& object = sortedObjects[spireIBO.name];
+    if (object.mSource.lock() != spireIBO.data)
+    {
+      if (object.mSortedID != 0)
+        iboMan.front().instance_->removeInMemoryIBO(object.mSortedID);
+      object = SortedObject();
+      object.mSource = spireIBO.data;
+    }
 
-    for (size_t j = 0; j < num_triangles; j++)
+    Core::Geometry::Vector diff = object.prevDir - dir;
+    double distance = sqrt(Core::Geometry::Dot(diff, diff));
+    if (!object.mRequested || (distance > 0.0 && distance >= minChange))
     {
-      float* vertex1 = reinterpret_cast<float*>(vbo_buffer + stride_vbo * (ibo_buffer[j * 3]));
-      Core::Geometry::Point node1(vertex1[0], vertex1[1], vertex1[2]);
+      if (depthLists.requestView(pass.front(), dir))
+      {
+        object.prevDir = dir;
+        object.mRequested = true;
+      }
+    }
 
-      float* vertex2 = reinterpret_cast<float*>(vbo_buffer + stride_vbo * (ibo_buffer[j * 3 + 1]));
-      Core::Geometry::Point node2(vertex2[0], vertex2[1], vertex2[2]);
+    uint64_t version = 0;
+    DepthSortCache::Permutation order = depthLists.view(pass.front(), version);
+    if (order && !order->empty() && version != object.mVersion)
+    {
+      std::vector<uint32_t> sorted_buffer;
+      applyTriangleOrder(reinterpret_cast<const uint32_t*>(spireIBO.data->getBuffer()), *order, sorted_buffer);
 
-      float* vertex3 = reinterpret_cast<float*>(vbo_buffer + stride_vbo * (ibo_buffer[j * 3 + 2]));
-      Core::Geometry::Point node3(vertex3[0], vertex3[1], vertex3[2]);
+      if (object.mSortedID != 0)
+        iboMan.front().instance_->removeInMemoryIBO(object.mSortedID);
 
-      rel_depth[j].mDepth = Core::Geometry::Dot(dir, node1) + Core::Geometry::Dot(dir, node2) + Core::Geometry::Dot(dir, node3);
-      rel_depth[j].mIndex = j;
+      int numPrimitives = spireIBO.data->getBufferSize() / spireIBO.indexSize;
+      object.mSortedID = iboMan.front().instance_->addInMemoryIBO(reinterpret_cast<char*>(&sorted_buffer[0]),
+        spireIBO.data->getBufferSize(), ibo.front().primMode, ibo.front().primType,
+        numPrimitives, spireIBO.name + "trans");
+      object.mVersion = version;
     }
 
-    std::sort(rel_depth.begin(), rel_depth.end());
-
-    // setup index buffers
-    int numPrimitives = pass.front().ibo.data->getBufferSize() / pass.front().ibo.indexSize;
+    return object.mSortedID != 0 ? object.mSortedID : ibo.front().glid;
+  }
 
-    std::vector<char> sorted_buffer(pass.front().ibo.data->getBufferSize());
-    char* ibuffer = reinterpret_cast<char*>(pass.front().ibo.data->getBuffer());
-    char* sbuffer = !sorted_buffer.empty() ? reinterpret_cast<char*>(&sorted_buffer[0]) : 0;
-    GLuint result = ibo.front().glid;
-    if (sbuffer && num_triangles > 0)
+  /// Returns the index buffer sorted along the given axis, or the unsorted
+  /// one while that ordering is still being computed in the background.
+  GLuint sortedListObject(DepthSortCache::Axis axis,
+    const es::ComponentGroup<ren::IBO>& ibo,
+    const es::ComponentGroup<SpireSubPass>& pass,
+    const es::ComponentGroup<ren::StaticIBOMan>& iboMan)
+  {
+    const SpireIBO& spireIBO = pass.front().ibo;
+    SortedLists& lists = sortedLists[spireIBO.name];
+    if (lists.mSource.lock() != spireIBO.data)
     {
-      size_t tri_size = pass.front().ibo.data->getBufferSize() / num_triangles;
-
-      for (size_t j = 0; j < num_triangles; j++)
+      for (int i = 0; i < DepthSortCache::NUM_AXES; ++i)
       {
-        memcpy(sbuffer + j * tri_size, ibuffer + rel_depth[j].mIndex * tri_size, tri_size);
+        if (lists.mIDs[i] != 0)
+          iboMan.front().instance_->removeInMemoryIBO(lists.mIDs[i]);
       }
-
-      std::string transIBOName = pass.front().ibo.name + "trans";
-      result = iboMan.front().instance_->addInMemoryIBO(sbuffer, pass.front().ibo.data->getBufferSize(), ibo.front().primMode, ibo.front().primType,
-        numPrimitives, transIBOName);
+      lists = SortedLists();
+      lists.mSource = spireIBO.data;
     }
 
-    return result;
+    if (lists.mIDs[axis] != 0)
+      return lists.mIDs[axis];
+
+    DepthSortCache::Permutation order = depthLists.get(pass.front(), axis);
+    if (!order || order->empty())
+      return ibo.front().glid;
+
+    std::vector<uint32_t> sorted_buffer;
+    applyTriangleOrder(reinterpret_cast<const uint32_t*>(spireIBO.data->getBuffer()), *order, sorted_buffer);
+
+    static const char* suffix[DepthSortCache::NUM_AXES] = { "X", "Y", "Z", "NegX", "NegY", "NegZ" };
+    int numPrimitives = spireIBO.data->getBufferSize() / spireIBO.indexSize;
+    lists.mIDs[axis] = iboMan.front().instance_->addInMemoryIBO(reinterpret_cast<char*>(&sorted_buffer[0]),
+      spireIBO.data->getBufferSize(), ibo.front().primMode, ibo.front().primType,
+      numPrimitives, spireIBO.name + suffix[axis]);
+    return lists.mIDs[axis];
   }
 
   void groupExecute(
@@ -222,6 +294,11 @@ private:
       const es::ComponentGroup<ren::StaticVBOMan>& vboMan,
 			const es::ComponentGroup<ren::StaticIBOMan>& iboMan) override
   {
+    // Objects that are not walked any more have left the scene, see
+    // postWalkComponents().
+    mDrawn.insert(pass.front().ibo.name);
+    mIBOMan = iboMan.front().instance_;
+
     /// \todo This needs to be moved to pre-execute.
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
     {
@@ -248,67 +325,16 @@ private:
       {
         case RenderState::TransparencySortType::CONTINUOUS_SORT:
         {
-          iboID = sortObjects(dir, ibo, pass, iboMan);
+          iboID = sortedViewObject(dir, 0.0, ibo, pass, iboMan);
           break;
         }
         case RenderState::TransparencySortType::UPDATE_SORT:
         {
-          unsigned int index = 0;
-          bool indexed = false;
-          for (int i = 0; i < sortedObjects.size(); ++i)
-          {
-            if (sortedObjects[i].mName == pass.front().ibo.name)
-            {
-              indexed = true;
-              index = i;
-            }
-          }
-          if (!indexed)
-          {
-            index = sortedObjects.size();
-            sortedObjects.push_back(SortedObject(pass.front().ibo.name, 0, dir));
-          }
-
-          Core::Geometry::Vector diff = sortedObjects[index].prevDir - dir;
-          double distance = sqrtf(Core::Geometry::Dot(diff, diff));
-          if (distance >= 1.23 || sortedObjects[index].mSortedID == 0)
-          {
-            if (sortedObjects[index].mSortedID != 0)
-            {
-              iboMan.front().instance_->removeInMemoryIBO(sortedObjects[index].mSortedID);
-            }
-            sortedObjects[index].prevDir = dir;
-            sortedObjects[index].mSortedID = sortObjects(dir, ibo, pass, iboMan);
-          }
-          iboID = sortedObjects[index].mSortedID;
+          iboID = sortedViewObject(dir, 1.23, ibo, pass, iboMan);
           break;
         }
         case RenderState::TransparencySortType::LISTS_SORT:
         {
-          GLuint iboXID = ibo.front().glid;
-          GLuint iboYID = ibo.front().glid;
-          GLuint iboZID = ibo.front().glid;
-          GLuint iboNegXID = ibo.front().glid;
-          GLuint iboNegYID = ibo.front().glid;
-          GLuint iboNegZID = ibo.front().glid;
-
-          int index = 0;
-          for (auto it = ibo.begin(); it != ibo.end(); ++it, ++index)
-          {
-            if (index == 1)
-              iboXID = it->glid;
-            if (index == 2)
-              iboYID = it->glid;
-            if (index == 3)
-              iboZID = it->glid;
-            if (index == 4)
-              iboNegXID = it->glid;
-            if (index == 5)
-              iboNegYID = it->glid;
-            if (index == 6)
-              iboNegZID = it->glid;
-          }
-
           Core::Geometry::Vector absDir(abs(camera.front().data.worldToView[0][2]),
                                         abs(camera.front().data.worldToView[1][2]),
                                         abs(camera.front().data.worldToView[2][2]));
@@ -316,18 +342,20 @@ private:
           double xORy = absDir.x() > absDir.y() ? absDir.x() : absDir.y();
           double orZ = absDir.z() > xORy ? absDir.z() : xORy;
 
+          DepthSortCache::Axis axis = DepthSortCache::POS_X;
           if (orZ == absDir.x())
           {
-            iboID = dir.x() < orZ ? iboNegXID : iboXID;
+            axis = dir.x() < orZ ? DepthSortCache::NEG_X : DepthSortCache::POS_X;
           }
           if (orZ == absDir.y())
           {
-            iboID = dir.y() < orZ ? iboNegYID : iboYID;
+            axis = dir.y() < orZ ? DepthSortCache::NEG_Y : DepthSortCache::POS_Y;
           }
           if (orZ == absDir.z())
           {
-            iboID = dir.z() < orZ ? iboNegZID : iboZID;
+            axis = dir.z() < orZ ? DepthSortCache::NEG_Z : DepthSortCache::POS_Z;
           }
+          iboID = sortedListObject(axis, ibo, pass, iboMan);
           break;
         }
       }
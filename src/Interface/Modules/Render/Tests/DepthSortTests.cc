@@ -0,0 +1,201 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+#include <Interface/Modules/Render/ES/DepthSort.h>
+#include <algorithm>
+#include <random>
+
+using namespace SCIRun::Render;
+using namespace SCIRun::Core::Geometry;
+
+TEST(DepthSortTest, RadixSortMatchesStableSort)
+{
+  std::mt19937 gen(17);
+  std::uniform_real_distribution<float> dist(-1000.0f, 1000.0f);
+  std::vector<float> keys(300000);
+  for (size_t i = 0; i < keys.size(); ++i)
+    keys[i] = (i % 7 == 0) ? 0.5f : dist(gen);
+
+  std::vector<uint32_t> order;
+  radixSortByKey(keys, order);
+
+  std::vector<uint32_t> expected(keys.size());
+  for (size_t i = 0; i < expected.size(); ++i)
+    expected[i] = static_cast<uint32_t>(i);
+  std::stable_sort(expected.begin(), expected.end(),
+    [&](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+
+  EXPECT_EQ(expected, order);
+}
+
+TEST(DepthSortTest, SortsTrianglesAlongDirection)
+{
+  // Three triangles stacked along z, listed out of order.
+  const float vertices[] = {
+    0, 0, 2,  1, 0, 2,  0, 1, 2,
+    0, 0, -1, 1, 0, -1, 0, 1, -1,
+    0, 0, 0,  1, 0, 0,  0, 1, 0 };
+  const uint32_t triangles[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8 };
+
+  std::vector<uint32_t> order;
+  sortTrianglesByDepth(reinterpret_cast<const char*>(vertices), 3 * sizeof(float),
+    triangles, 3, Vector(0, 0, 1), order);
+  EXPECT_EQ(std::vector<uint32_t>({ 1, 2, 0 }), order);
+
+  sortTrianglesByDepth(reinterpret_cast<const char*>(vertices), 3 * sizeof(float),
+    triangles, 3, Vector(0, 0, -1), order);
+  EXPECT_EQ(std::vector<uint32_t>({ 0, 2, 1 }), order);
+
+  std::vector<uint32_t> sorted;
+  applyTriangleOrder(triangles, order, sorted);
+  EXPECT_EQ(std::vector<uint32_t>({ 0, 1, 2, 6, 7, 8, 3, 4, 5 }), sorted);
+}
+
+namespace
+{
+  // Triangles stacked along z: triangle i lies at z = depths[i].
+  SCIRun::Graphics::Datatypes::SpireSubPass stackedTriangles(const std::string& name,
+    const std::vector<float>& depths)
+  {
+    using namespace SCIRun::Graphics::Datatypes;
+
+    auto vbo = std::make_shared<CPM_VAR_BUFFER_NS::VarBuffer>();
+    auto ibo = std::make_shared<CPM_VAR_BUFFER_NS::VarBuffer>();
+    for (size_t i = 0; i < depths.size(); ++i)
+    {
+      const float tri[] = { 0, 0, depths[i], 1, 0, depths[i], 0, 1, depths[i] };
+      for (float f : tri)
+        vbo->write(f);
+      for (uint32_t k = 0; k < 3; ++k)
+        ibo->write(static_cast<uint32_t>(i * 3 + k));
+    }
+
+    SpireSubPass pass;
+    pass.vbo.data = vbo;
+    pass.vbo.attributes.push_back(SpireVBO::AttributeData("aPos", 3 * sizeof(float)));
+    pass.ibo = SpireIBO(name, SpireIBO::TRIANGLES, sizeof(uint32_t), ibo);
+    return pass;
+  }
+}
+
+TEST(DepthSortCacheTest, SortsAxesInBackground)
+{
+  DepthSortCache cache;
+  auto pass = stackedTriangles("tris", { 2, -1, 0 });
+
+  EXPECT_FALSE(cache.get(pass, DepthSortCache::POS_Z));
+  cache.wait();
+
+  auto order = cache.get(pass, DepthSortCache::POS_Z);
+  ASSERT_TRUE(order != nullptr);
+  EXPECT_EQ(std::vector<uint32_t>({ 1, 2, 0 }), *order);
+
+  EXPECT_FALSE(cache.get(pass, DepthSortCache::NEG_Z));
+  cache.wait();
+  EXPECT_EQ(std::vector<uint32_t>({ 0, 2, 1 }), *cache.get(pass, DepthSortCache::NEG_Z));
+}
+
+TEST(DepthSortCacheTest, ViewOrderingFollowsRequests)
+{
+  DepthSortCache cache;
+  auto pass = stackedTriangles("tris", { 2, -1, 0 });
+
+  uint64_t version = 0;
+  EXPECT_FALSE(cache.view(pass, version));
+
+  EXPECT_TRUE(cache.requestView(pass, Vector(0, 0, 1)));
+  cache.wait();
+  auto order = cache.view(pass, version);
+  ASSERT_TRUE(order != nullptr);
+  EXPECT_EQ(std::vector<uint32_t>({ 1, 2, 0 }), *order);
+  const uint64_t first = version;
+
+  // Asking for the direction that is already sorted does not sort again.
+  EXPECT_TRUE(cache.requestView(pass, Vector(0, 0, 1)));
+  cache.wait();
+  cache.view(pass, version);
+  EXPECT_EQ(first, version);
+
+  EXPECT_TRUE(cache.requestView(pass, Vector(0, 0, -1)));
+  cache.wait();
+  order = cache.view(pass, version);
+  EXPECT_NE(first, version);
+  EXPECT_EQ(std::vector<uint32_t>({ 0, 2, 1 }), *order);
+}
+
+TEST(DepthSortCacheTest, NewBufferInvalidatesOrderings)
+{
+  DepthSortCache cache;
+  auto pass = stackedTriangles("tris", { 2, -1, 0 });
+  cache.get(pass, DepthSortCache::POS_Z);
+  cache.wait();
+  ASSERT_TRUE(cache.get(pass, DepthSortCache::POS_Z) != nullptr);
+
+  auto replaced = stackedTriangles("tris", { 0, 1 });
+  EXPECT_FALSE(cache.get(replaced, DepthSortCache::POS_Z));
+  cache.wait();
+  EXPECT_EQ(std::vector<uint32_t>({ 0, 1 }), *cache.get(replaced, DepthSortCache::POS_Z));
+}
+
+TEST(DepthSortCacheTest, RetainForgetsObjectsThatLeftTheScene)
+{
+  DepthSortCache cache;
+  auto a = stackedTriangles("a", { 1, 0 });
+  auto b = stackedTriangles("b", { 0, 1 });
+  cache.get(a, DepthSortCache::POS_Z);
+  cache.get(b, DepthSortCache::POS_Z);
+  cache.wait();
+
+  cache.retain({ "a" });
+  EXPECT_TRUE(cache.get(a, DepthSortCache::POS_Z) != nullptr);
+  EXPECT_FALSE(cache.get(b, DepthSortCache::POS_Z));
+
+  cache.clear();
+  cache.wait();
+  EXPECT_FALSE(cache.get(a, DepthSortCache::POS_Z));
+}
+
+TEST(DepthSortCacheTest, QueueIsBoundedAndDestructionJoinsWorker)
+{
+  std::vector<SCIRun::Graphics::Datatypes::SpireSubPass> passes;
+  std::vector<float> depths(200000);
+  for (size_t i = 0; i < depths.size(); ++i)
+    depths[i] = static_cast<float>(depths.size() - i);
+  for (size_t i = 0; i < 2 * DepthSortCache::MAX_QUEUED_SORTS; ++i)
+    passes.push_back(stackedTriangles("tris" + std::to_string(i), depths));
+
+  {
+    DepthSortCache cache;
+    size_t accepted = 0;
+    for (const auto& pass : passes)
+      accepted += cache.requestView(pass, Vector(0, 0, 1)) ? 1 : 0;
+    EXPECT_LE(accepted, DepthSortCache::MAX_QUEUED_SORTS + 1);
+    EXPECT_GE(accepted, DepthSortCache::MAX_QUEUED_SORTS);
+  }
+}
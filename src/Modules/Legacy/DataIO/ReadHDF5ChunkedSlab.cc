@@ -0,0 +1,243 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+///
+/// @file  ReadHDF5ChunkedSlab.cc
+///
+
+
+#include <Modules/Legacy/DataIO/ReadHDF5ChunkedSlab.h>
+
+#ifdef HAVE_HDF5
+
+#include <Core/Thread/Parallel.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <zlib.h>
+
+using std::vector;
+
+namespace SCIRun {
+
+// Only the chunks that intersect the slab are touched. The raw chunks are
+// fetched a batch at a time on this thread, as the HDF5 library is not
+// thread safe, and are then inflated and copied into place in parallel.
+bool
+read_chunked_slab( hid_t ds_id, hid_t mem_type_id, int ndims,
+                   const hsize_t *start, const hsize_t *count, char *data )
+{
+#if H5_VERSION_GE(1,10,5)
+  hid_t dcpl_id = H5Dget_create_plist(ds_id);
+  if( dcpl_id < 0 )
+    return false;
+
+  vector<hsize_t> chunk(ndims);
+
+  bool supported = ( H5Pget_layout(dcpl_id) == H5D_CHUNKED &&
+                     H5Pget_chunk(dcpl_id, ndims, &chunk[0]) == ndims );
+
+  bool deflated = false;
+
+  for( int f=0; supported && f<H5Pget_nfilters(dcpl_id); f++ ) {
+    unsigned int flags, filter_config;
+    size_t nelmts = 0;
+
+    H5Z_filter_t filter = H5Pget_filter2(dcpl_id, f, &flags, &nelmts,
+                                         NULL, 0, NULL, &filter_config);
+    if( filter == H5Z_FILTER_DEFLATE && !deflated )
+      deflated = true;
+    else
+      supported = false;
+  }
+
+  H5Pclose(dcpl_id);
+
+  // The chunks are copied as is, so the stored type has to be the one
+  // that is asked for.
+  hid_t type_id = H5Dget_type(ds_id);
+  if( supported && H5Tequal(type_id, mem_type_id) <= 0 )
+    supported = false;
+  H5Tclose(type_id);
+
+  if( !supported )
+    return false;
+
+  const size_t elsize = H5Tget_size(mem_type_id);
+
+  size_t chunk_size = elsize;
+  vector<size_t> chunk_stride(ndims), data_stride(ndims);
+  vector<hsize_t> first(ndims), last(ndims), index(ndims);
+
+  for( int d=ndims-1; d>=0; d-- ) {
+    chunk_stride[d] = chunk_size / elsize;
+    chunk_size *= chunk[d];
+    data_stride[d] = (d == ndims-1) ? 1 : data_stride[d+1] * count[d+1];
+
+    if( count[d] == 0 )
+      return true;
+
+    first[d] = start[d] / chunk[d];
+    last[d]  = (start[d] + count[d] - 1) / chunk[d];
+    index[d] = first[d];
+  }
+
+  // Raw chunks are read in batches to bound the memory used.
+  const int num_threads = Core::Thread::Parallel::NumCores();
+  const size_t batch_size = 4 * num_threads;
+
+  vector< vector<hsize_t> > offsets;
+  vector< vector<char> > raw;
+  vector< uint32_t > masks;
+
+  bool done = false;
+  bool failed = false;
+
+  while( !done && !failed ) {
+
+    offsets.clear();
+    raw.clear();
+    masks.clear();
+
+    // Fetch the next batch of raw chunks.
+    while( !done && offsets.size() < batch_size ) {
+      vector<hsize_t> offset(ndims);
+      for( int d=0; d<ndims; d++ )
+        offset[d] = index[d] * chunk[d];
+
+      hsize_t nbytes = 0;
+      uint32_t mask = 0;
+
+      // Chunks that were never written have no storage and only hold
+      // the fill value, let H5Dread deal with those.
+      herr_t status;
+      H5E_BEGIN_TRY {
+        status = H5Dget_chunk_storage_size(ds_id, &offset[0], &nbytes);
+      } H5E_END_TRY;
+
+      if( status < 0 || nbytes == 0 )
+        return false;
+
+      raw.push_back( vector<char>(nbytes) );
+
+      if( H5Dread_chunk(ds_id, H5P_DEFAULT, &offset[0], &mask,
+                        &(raw.back()[0])) < 0 ) {
+        failed = true;
+        break;
+      }
+
+      offsets.push_back( offset );
+      masks.push_back( mask );
+
+      // Advance to the next chunk, last dimension fastest.
+      int d = ndims-1;
+      while( d >= 0 && ++index[d] > last[d] ) {
+        index[d] = first[d];
+        d--;
+      }
+      done = (d < 0);
+    }
+
+    if( failed )
+      break;
+
+    vector<char> task_failed(num_threads, 0);
+
+    Core::Thread::Parallel::RunTasks( [&](int t) {
+      vector<char> buffer(chunk_size);
+      vector<hsize_t> lo(ndims), hi(ndims), pos(ndims);
+
+      for( size_t c=t; c<offsets.size(); c+=num_threads ) {
+
+        const vector<hsize_t> &offset = offsets[c];
+
+        // Bit 0 of the mask is set when deflate was skipped for this chunk.
+        const char *cdata = &(raw[c][0]);
+
+        if( deflated && !(masks[c] & 1) ) {
+          uLongf len = chunk_size;
+          if( uncompress(reinterpret_cast<Bytef*>(&buffer[0]), &len,
+                         reinterpret_cast<const Bytef*>(cdata),
+                         raw[c].size()) != Z_OK || len != chunk_size ) {
+            task_failed[t] = 1;
+            return;
+          }
+          cdata = &buffer[0];
+        } else if( raw[c].size() != chunk_size ) {
+          task_failed[t] = 1;
+          return;
+        }
+
+        // Intersection of the chunk and the slab.
+        for( int d=0; d<ndims; d++ ) {
+          lo[d] = std::max(offset[d], start[d]);
+          hi[d] = std::min(offset[d] + chunk[d], start[d] + count[d]);
+          pos[d] = lo[d];
+        }
+
+        // Copy the runs along the last dimension into place.
+        const size_t run = (hi[ndims-1] - lo[ndims-1]) * elsize;
+
+        while( true ) {
+          size_t src = 0, dst = 0;
+          for( int d=0; d<ndims; d++ ) {
+            src += (pos[d] - offset[d]) * chunk_stride[d];
+            dst += (pos[d] - start[d])  * data_stride[d];
+          }
+
+          memcpy( data + dst * elsize, cdata + src * elsize, run );
+
+          int d = ndims-2;
+          while( d >= 0 && ++pos[d] >= hi[d] ) {
+            pos[d] = lo[d];
+            d--;
+          }
+          if( d < 0 )
+            break;
+        }
+      }
+    }, num_threads );
+
+    for( int t=0; t<num_threads; t++ )
+      if( task_failed[t] )
+        failed = true;
+  }
+
+  return !failed;
+#else
+  return false;
+#endif
+}
+
+} // End namespace SCIRun
+
+#endif
@@ -0,0 +1,63 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+///
+/// @file  ReadHDF5ChunkedSlab.h
+///
+/// Reads a hyperslab of a chunked, deflated HDF5 dataset chunk by chunk,
+/// inflating the chunks on all cores.
+///
+
+
+#ifndef READ_HDF5_CHUNKED_SLAB_H
+#define READ_HDF5_CHUNKED_SLAB_H
+
+#include <sci_defs/hdf5_defs.h>
+
+#ifdef HAVE_HDF5
+
+#include "hdf5.h"
+
+namespace SCIRun {
+
+// Read the hyperslab [start, start+count) of a chunked dataset directly
+// into data, which is laid out row major with the dimensions in count.
+// Returns false if the dataset is not chunked, uses a filter other than
+// deflate, needs a type conversion or has unwritten chunks, in which case
+// H5Dread has to be used. Needs HDF5 1.10.5 or later; older versions
+// always return false.
+bool read_chunked_slab( hid_t ds_id, hid_t mem_type_id, int ndims,
+                        const hsize_t *start, const hsize_t *count,
+                        char *data );
+
+} // End namespace SCIRun
+
+#endif
+
+#endif
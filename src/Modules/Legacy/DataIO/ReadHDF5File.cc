@@ -54,6 +54,7 @@
 #ifdef HAVE_HDF5
 #include "hdf5.h"
 #include "WriteHDF5DumpFile.h"
+#include "ReadHDF5ChunkedSlab.h"
 #endif
 
 namespace SCIRun {
@@ -1526,6 +1527,13 @@ NrrdDataHandle ReadHDF5File::readDataset( string filename,
 
       hid_t mem_space_id = H5Screate_simple (ndims, count, NULL );
 
+      // Keep the file selection for the chunked read.
+      vector<hsize_t> file_start(start, start+ndims);
+      bool unit_stride = true;
+      for( int ic=0; ic<ndims; ic++ )
+        if( stride[ic] != 1 )
+          unit_stride = false;
+
       for( int d=0; d<ndims; d++ ) {
         start[d] = 0;
         stride[d] = 1;
@@ -1551,7 +1559,13 @@ NrrdDataHandle ReadHDF5File::readDataset( string filename,
         return NULL;
       }
 
-      if( (status = H5Dread(ds_id, mem_type_id,
+      // Chunked datasets are read chunk by chunk and decompressed in
+      // parallel, other layouts go through the regular hyperslab read.
+      if( unit_stride &&
+          read_chunked_slab(ds_id, mem_type_id, ndims,
+                            &file_start[0], count, data) ) {
+        // Data was read directly into place.
+      } else if( (status = H5Dread(ds_id, mem_type_id,
           mem_space_id, file_space_id, H5P_DEFAULT,
           data)) < 0 ) {
         error( "Can not read the data slab requested." );
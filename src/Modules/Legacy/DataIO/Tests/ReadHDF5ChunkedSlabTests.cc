@@ -0,0 +1,220 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Modules/Legacy/DataIO/ReadHDF5ChunkedSlab.h>
+#include <Testing/Utils/FieldTestUtilities.h>
+
+#include <gtest/gtest.h>
+
+#include <boost/filesystem.hpp>
+
+#include <vector>
+
+using namespace SCIRun;
+using namespace SCIRun::TestUtils;
+
+namespace
+{
+  struct Slab
+  {
+    std::vector<hsize_t> start, count;
+  };
+
+  class ReadHDF5ChunkedSlabTest : public ::testing::Test
+  {
+  protected:
+    virtual void SetUp()
+    {
+      path_ = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("scirun_chunked_%%%%-%%%%.h5");
+      file_ = H5Fcreate(path_.string().c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+      ASSERT_GE(file_, 0);
+    }
+
+    virtual void TearDown()
+    {
+      H5Fclose(file_);
+      boost::system::error_code ec;
+      boost::filesystem::remove(path_, ec);
+    }
+
+    // An empty chunk gives a contiguous dataset.
+    hid_t createDataset(const char* name, hid_t type, const std::vector<hsize_t>& dims,
+      const std::vector<hsize_t>& chunk, bool shuffle, bool deflate)
+    {
+      hid_t space = H5Screate_simple(static_cast<int>(dims.size()), &dims[0], NULL);
+      hid_t dcpl = H5Pcreate(H5P_DATASET_CREATE);
+      if (!chunk.empty())
+        H5Pset_chunk(dcpl, static_cast<int>(chunk.size()), &chunk[0]);
+      if (shuffle)
+        H5Pset_shuffle(dcpl);
+      if (deflate)
+        H5Pset_deflate(dcpl, 6);
+      hid_t ds = H5Dcreate2(file_, name, type, space, H5P_DEFAULT, dcpl, H5P_DEFAULT);
+      H5Pclose(dcpl);
+      H5Sclose(space);
+      return ds;
+    }
+
+    template <class T>
+    hid_t writeDataset(const char* name, hid_t type, const std::vector<hsize_t>& dims,
+      const std::vector<hsize_t>& chunk, bool shuffle, bool deflate)
+    {
+      hsize_t size = 1;
+      for (size_t d = 0; d < dims.size(); ++d)
+        size *= dims[d];
+      std::vector<T> values(size);
+      for (hsize_t i = 0; i < size; ++i)
+        values[i] = static_cast<T>(0.5 * i - 1000.0 + (i % 7));
+
+      hid_t ds = createDataset(name, type, dims, chunk, shuffle, deflate);
+      EXPECT_GE(H5Dwrite(ds, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, &values[0]), 0);
+      return ds;
+    }
+
+    // The reference: the same slab through the regular hyperslab read.
+    static std::vector<char> readWithH5Dread(hid_t ds, hid_t type, const Slab& slab)
+    {
+      const int ndims = static_cast<int>(slab.start.size());
+      size_t size = H5Tget_size(type);
+      for (int d = 0; d < ndims; ++d)
+        size *= slab.count[d];
+      std::vector<char> data(size);
+
+      hid_t file_space = H5Dget_space(ds);
+      H5Sselect_hyperslab(file_space, H5S_SELECT_SET, &slab.start[0], NULL, &slab.count[0], NULL);
+      hid_t mem_space = H5Screate_simple(ndims, &slab.count[0], NULL);
+      EXPECT_GE(H5Dread(ds, type, mem_space, file_space, H5P_DEFAULT, &data[0]), 0);
+      H5Sclose(mem_space);
+      H5Sclose(file_space);
+      return data;
+    }
+
+    static bool readChunked(hid_t ds, hid_t type, const Slab& slab, std::vector<char>& data)
+    {
+      size_t size = H5Tget_size(type);
+      for (size_t d = 0; d < slab.count.size(); ++d)
+        size *= slab.count[d];
+      data.assign(size, 0);
+      return read_chunked_slab(ds, type, static_cast<int>(slab.start.size()), &slab.start[0], &slab.count[0], &data[0]);
+    }
+
+    static void expectChunkedReadMatches(hid_t ds, hid_t type, const std::vector<Slab>& slabs)
+    {
+      for (unsigned int numCores : { 1u, 4u })
+      {
+        ScopedNumCores cores(numCores);
+        for (size_t s = 0; s < slabs.size(); ++s)
+        {
+          std::vector<char> chunked;
+          ASSERT_TRUE(readChunked(ds, type, slabs[s], chunked)) << "slab " << s;
+          EXPECT_TRUE(readWithH5Dread(ds, type, slabs[s]) == chunked) << "slab " << s << ", " << numCores << " cores";
+        }
+      }
+    }
+
+    boost::filesystem::path path_;
+    hid_t file_;
+  };
+
+  Slab slab(const std::vector<hsize_t>& start, const std::vector<hsize_t>& count)
+  {
+    Slab s;
+    s.start = start;
+    s.count = count;
+    return s;
+  }
+}
+
+#if H5_VERSION_GE(1,10,5)
+
+// The chunk sizes do not divide the dimensions, so the slabs cut through
+// partial edge chunks as well as interior ones.
+TEST_F(ReadHDF5ChunkedSlabTest, DeflatedDoublesMatchH5Dread)
+{
+  const std::vector<hsize_t> dims = { 37, 29, 23 };
+  hid_t ds = writeDataset<double>("deflated", H5T_NATIVE_DOUBLE, dims, { 8, 7, 5 }, false, true);
+  ASSERT_GE(ds, 0);
+
+  std::vector<Slab> slabs;
+  slabs.push_back(slab({ 0, 0, 0 }, dims));
+  slabs.push_back(slab({ 5, 6, 4 }, { 20, 13, 11 }));
+  slabs.push_back(slab({ 36, 28, 22 }, { 1, 1, 1 }));
+  slabs.push_back(slab({ 30, 0, 20 }, { 7, 29, 3 }));
+  expectChunkedReadMatches(ds, H5T_NATIVE_DOUBLE, slabs);
+  H5Dclose(ds);
+}
+
+TEST_F(ReadHDF5ChunkedSlabTest, UnfilteredIntsMatchH5Dread)
+{
+  const std::vector<hsize_t> dims = { 50, 41 };
+  hid_t ds = writeDataset<int>("plain", H5T_NATIVE_INT, dims, { 16, 9 }, false, false);
+  ASSERT_GE(ds, 0);
+
+  std::vector<Slab> slabs;
+  slabs.push_back(slab({ 0, 0 }, dims));
+  slabs.push_back(slab({ 15, 8 }, { 2, 2 }));
+  slabs.push_back(slab({ 17, 3 }, { 33, 30 }));
+  expectChunkedReadMatches(ds, H5T_NATIVE_INT, slabs);
+  H5Dclose(ds);
+}
+
+#endif
+
+TEST_F(ReadHDF5ChunkedSlabTest, LeavesOtherLayoutsToH5Dread)
+{
+  const std::vector<hsize_t> dims = { 20, 30 };
+  const std::vector<hsize_t> chunk = { 8, 8 };
+  const Slab all = slab({ 0, 0 }, dims);
+  std::vector<char> data;
+
+  hid_t contiguous = writeDataset<double>("contiguous", H5T_NATIVE_DOUBLE, dims, std::vector<hsize_t>(), false, false);
+  EXPECT_FALSE(readChunked(contiguous, H5T_NATIVE_DOUBLE, all, data));
+  H5Dclose(contiguous);
+
+  hid_t shuffled = writeDataset<double>("shuffled", H5T_NATIVE_DOUBLE, dims, chunk, true, true);
+  EXPECT_FALSE(readChunked(shuffled, H5T_NATIVE_DOUBLE, all, data));
+  H5Dclose(shuffled);
+
+  // Stored as float, read as double: needs a type conversion.
+  hid_t floats = writeDataset<float>("floats", H5T_NATIVE_FLOAT, dims, chunk, false, true);
+  EXPECT_FALSE(readChunked(floats, H5T_NATIVE_DOUBLE, all, data));
+  H5Dclose(floats);
+
+  // Only the first chunk is written, the others hold the fill value.
+  hid_t partial = createDataset("partial", H5T_NATIVE_DOUBLE, dims, chunk, false, true);
+  std::vector<double> values(64, 1.0);
+  hid_t file_space = H5Dget_space(partial);
+  const Slab first = slab({ 0, 0 }, chunk);
+  H5Sselect_hyperslab(file_space, H5S_SELECT_SET, &first.start[0], NULL, &first.count[0], NULL);
+  hid_t mem_space = H5Screate_simple(2, &chunk[0], NULL);
+  ASSERT_GE(H5Dwrite(partial, H5T_NATIVE_DOUBLE, mem_space, file_space, H5P_DEFAULT, &values[0]), 0);
+  H5Sclose(mem_space);
+  H5Sclose(file_space);
+  EXPECT_FALSE(readChunked(partial, H5T_NATIVE_DOUBLE, all, data));
+  H5Dclose(partial);
+}
@@ -54,6 +54,8 @@ void BuildMappingMatrix::setStateDefaults()
 {
   setStateStringFromAlgoOption(Parameters::MappingMethod);
   setStateDoubleFromAlgo(Parameters::MaxDistance);
+  setStateBoolFromAlgo(Parameters::UseMappingCache);
+  setStateStringFromAlgo(Parameters::MappingCacheDirectory);
 }
 
 void
@@ -68,6 +70,8 @@ BuildMappingMatrix::execute()
 
     setAlgoOptionFromState(Parameters::MappingMethod);
     setAlgoDoubleFromState(Parameters::MaxDistance);
+    setAlgoBoolFromState(Parameters::UseMappingCache);
+    setAlgoStringFromState(Parameters::MappingCacheDirectory);
 
     auto output = algo().run_generic(withInputData((Source, source)(Destination, destination)));
     sendOutputFromAlgorithm(Mapping, output);
@@ -0,0 +1,288 @@
+/*
+ For more information, please see: http://software.sci.utah.edu
+ 
+ The MIT License
+ 
+ Copyright (c) 2015 Scientific Computing and Imaging Institute,
+ University of Utah.
+ 
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included
+ in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <Testing/Benchmarks/BenchmarkHarness.h>
+#include <Core/Thread/Parallel.h>
+
+#include <boost/regex.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <exception>
+#include <iomanip>
+#include <numeric>
+#include <ostream>
+#include <sstream>
+
+using namespace SCIRun::Benchmarks;
+
+namespace
+{
+  double timeOnce(const std::function<void()>& body)
+  {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(stop - start).count();
+  }
+
+  std::string jsonString(const std::string& text)
+  {
+    std::ostringstream out;
+    out << '"';
+    for (auto c : text)
+    {
+      switch (c)
+      {
+      case '"': out << "\\\""; break;
+      case '\\': out << "\\\\"; break;
+      case '\n': out << "\\n"; break;
+      case '\t': out << "\\t"; break;
+      case '\r': out << "\\r"; break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20)
+          out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+        else
+          out << c;
+      }
+    }
+    out << '"';
+    return out.str();
+  }
+
+  std::string jsonNumber(double value)
+  {
+    if (!std::isfinite(value))
+      return "null";
+    std::ostringstream out;
+    out << std::setprecision(9) << value;
+    return out.str();
+  }
+
+  std::string utcTimestamp()
+  {
+    std::time_t now = std::time(nullptr);
+    char buffer[32];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+    return buffer;
+  }
+}
+
+BenchmarkContext::BenchmarkContext(size_t elements, int warmup, int repetitions) :
+  elements_(elements), warmup_(warmup), repetitions_(repetitions)
+{
+}
+
+void BenchmarkContext::measure(const std::function<void()>& body)
+{
+  measure(std::function<void()>(), body);
+}
+
+void BenchmarkContext::measure(const std::function<void()>& setup, const std::function<void()>& body)
+{
+  samples_.clear();
+  for (int i = 0; i < warmup_ + repetitions_; ++i)
+  {
+    if (setup)
+      setup();
+    double seconds = timeOnce(body);
+    if (i >= warmup_)
+      samples_.push_back(seconds);
+  }
+}
+
+void BenchmarkContext::counter(const std::string& name, double value)
+{
+  counters_[name] = value;
+}
+
+BenchmarkRegistry& BenchmarkRegistry::instance()
+{
+  static BenchmarkRegistry registry;
+  return registry;
+}
+
+void BenchmarkRegistry::add(const std::string& name, BenchmarkFunction benchmark)
+{
+  benchmarks_.push_back(std::make_pair(name, benchmark));
+}
+
+BenchmarkOptions::BenchmarkOptions() : warmup(1), repetitions(5)
+{
+}
+
+BenchmarkResult::BenchmarkResult() : elements(0)
+{
+}
+
+double BenchmarkResult::min() const
+{
+  return samples.empty() ? NAN : *std::min_element(samples.begin(), samples.end());
+}
+
+double BenchmarkResult::max() const
+{
+  return samples.empty() ? NAN : *std::max_element(samples.begin(), samples.end());
+}
+
+double BenchmarkResult::mean() const
+{
+  return samples.empty() ? NAN : std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+}
+
+double BenchmarkResult::median() const
+{
+  if (samples.empty())
+    return NAN;
+  std::vector<double> sorted(samples);
+  std::sort(sorted.begin(), sorted.end());
+  size_t half = sorted.size() / 2;
+  return sorted.size() % 2 ? sorted[half] : 0.5 * (sorted[half - 1] + sorted[half]);
+}
+
+double BenchmarkResult::stddev() const
+{
+  if (samples.size() < 2)
+    return 0.0;
+  double m = mean();
+  double sum = 0.0;
+  for (auto s : samples)
+    sum += (s - m) * (s - m);
+  return std::sqrt(sum / (samples.size() - 1));
+}
+
+BenchmarkRunner::BenchmarkRunner(const BenchmarkOptions& options) : options_(options)
+{
+  if (options_.sizes.empty())
+    options_.sizes.push_back(100000);
+}
+
+std::vector<std::string> BenchmarkRunner::selected() const
+{
+  boost::regex filter(options_.filter.empty() ? std::string(".*") : options_.filter);
+  std::vector<std::string> names;
+  for (const auto& benchmark : BenchmarkRegistry::instance().benchmarks())
+  {
+    if (boost::regex_search(benchmark.first, filter))
+      names.push_back(benchmark.first);
+  }
+  return names;
+}
+
+std::vector<BenchmarkResult> BenchmarkRunner::run(std::ostream& log) const
+{
+  auto names = selected();
+  std::vector<BenchmarkResult> results;
+
+  for (auto size : options_.sizes)
+  {
+    for (const auto& benchmark : BenchmarkRegistry::instance().benchmarks())
+    {
+      if (std::find(names.begin(), names.end(), benchmark.first) == names.end())
+        continue;
+
+      BenchmarkResult result;
+      result.name = benchmark.first;
+      result.elements = size;
+
+      BenchmarkContext context(size, options_.warmup, options_.repetitions);
+      try
+      {
+        benchmark.second(context);
+        if (context.samples().empty())
+          result.error = "benchmark did not call measure()";
+      }
+      catch (std::exception& e)
+      {
+        result.error = e.what();
+      }
+      catch (...)
+      {
+        result.error = "unknown exception";
+      }
+      result.samples = context.samples();
+      result.counters = context.counters();
+
+      log << std::left << std::setw(40) << result.name << std::right << std::setw(10) << size;
+      if (result.error.empty())
+        log << "  median " << std::setw(12) << result.median() << " s  min " << std::setw(12) << result.min() << " s";
+      else
+        log << "  FAILED: " << result.error;
+      log << std::endl;
+
+      results.push_back(result);
+    }
+  }
+  return results;
+}
+
+void BenchmarkRunner::writeJson(std::ostream& out, const std::vector<BenchmarkResult>& results) const
+{
+  out << "{\n";
+  out << "  \"suite\": \"SCIRun_Benchmarks\",\n";
+  out << "  \"timestamp\": " << jsonString(utcTimestamp()) << ",\n";
+  out << "  \"hardware_threads\": " << Core::Thread::Parallel::NumCores() << ",\n";
+  out << "  \"warmup\": " << options_.warmup << ",\n";
+  out << "  \"repetitions\": " << options_.repetitions << ",\n";
+  out << "  \"results\": [";
+  for (size_t i = 0; i < results.size(); ++i)
+  {
+    const auto& r = results[i];
+    out << (i == 0 ? "\n" : ",\n");
+    out << "    {\n";
+    out << "      \"name\": " << jsonString(r.name) << ",\n";
+    out << "      \"elements\": " << r.elements << ",\n";
+    out << "      \"succeeded\": " << (r.error.empty() ? "true" : "false") << ",\n";
+    if (!r.error.empty())
+      out << "      \"error\": " << jsonString(r.error) << ",\n";
+    out << "      \"seconds\": {"
+      << "\"min\": " << jsonNumber(r.min())
+      << ", \"median\": " << jsonNumber(r.median())
+      << ", \"mean\": " << jsonNumber(r.mean())
+      << ", \"max\": " << jsonNumber(r.max())
+      << ", \"stddev\": " << jsonNumber(r.stddev()) << "},\n";
+    out << "      \"samples\": [";
+    for (size_t j = 0; j < r.samples.size(); ++j)
+      out << (j == 0 ? "" : ", ") << jsonNumber(r.samples[j]);
+    out << "],\n";
+    out << "      \"counters\": {";
+    bool first = true;
+    for (const auto& c : r.counters)
+    {
+      out << (first ? "" : ", ") << jsonString(c.first) << ": " << jsonNumber(c.second);
+      first = false;
+    }
+    out << "}\n";
+    out << "    }";
+  }
+  out << (results.empty() ? "]\n" : "\n  ]\n");
+  out << "}\n";
+}
@@ -0,0 +1,157 @@
+/*
+ For more information, please see: http://software.sci.utah.edu
+ 
+ The MIT License
+ 
+ Copyright (c) 2015 Scientific Computing and Imaging Institute,
+ University of Utah.
+ 
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included
+ in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef TESTING_BENCHMARKS_BENCHMARKHARNESS_H
+#define TESTING_BENCHMARKS_BENCHMARKHARNESS_H 1
+
+#include <cstddef>
+#include <functional>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// Minimal benchmark harness for the SCIRun_Benchmarks executable. A
+/// benchmark is a function that prepares its inputs and hands the code to
+/// time to BenchmarkContext::measure; the runner repeats it for every
+/// requested problem size and reports the timings as text and JSON.
+
+namespace SCIRun
+{
+
+namespace Benchmarks
+{
+
+class BenchmarkContext
+{
+public:
+  BenchmarkContext(size_t elements, int warmup, int repetitions);
+
+  /// Requested problem size, in mesh elements.
+  size_t elements() const { return elements_; }
+
+  /// Time body: warmup untimed runs followed by the timed repetitions.
+  void measure(const std::function<void()>& body);
+
+  /// Same as above, setup runs untimed before every run of body. Use it for
+  /// benchmarks that consume or modify their input.
+  void measure(const std::function<void()>& setup, const std::function<void()>& body);
+
+  /// Record an extra value (matrix size, iteration count...) with the result.
+  void counter(const std::string& name, double value);
+
+  const std::vector<double>& samples() const { return samples_; }
+  const std::map<std::string, double>& counters() const { return counters_; }
+
+private:
+  size_t elements_;
+  int warmup_;
+  int repetitions_;
+  std::vector<double> samples_;
+  std::map<std::string, double> counters_;
+};
+
+typedef std::function<void(BenchmarkContext&)> BenchmarkFunction;
+
+class BenchmarkRegistry
+{
+public:
+  typedef std::vector<std::pair<std::string, BenchmarkFunction> > Benchmarks;
+
+  static BenchmarkRegistry& instance();
+
+  void add(const std::string& name, BenchmarkFunction benchmark);
+  const Benchmarks& benchmarks() const { return benchmarks_; }
+
+private:
+  Benchmarks benchmarks_;
+};
+
+struct BenchmarkRegistrar
+{
+  BenchmarkRegistrar(const std::string& name, BenchmarkFunction benchmark)
+  {
+    BenchmarkRegistry::instance().add(name, benchmark);
+  }
+};
+
+/// Define and register a benchmark, the body gets a BenchmarkContext named context.
+#define SCIRUN_BENCHMARK(name) \
+  static void scirun_benchmark_##name(SCIRun::Benchmarks::BenchmarkContext& context); \
+  static SCIRun::Benchmarks::BenchmarkRegistrar scirun_benchmark_registrar_##name(#name, scirun_benchmark_##name); \
+  static void scirun_benchmark_##name(SCIRun::Benchmarks::BenchmarkContext& context)
+
+struct BenchmarkOptions
+{
+  BenchmarkOptions();
+
+  std::string filter;
+  std::vector<size_t> sizes;
+  int warmup;
+  int repetitions;
+};
+
+struct BenchmarkResult
+{
+  BenchmarkResult();
+
+  std::string name;
+  size_t elements;
+  std::vector<double> samples;
+  std::map<std::string, double> counters;
+  std::string error;
+
+  double min() const;
+  double max() const;
+  double mean() const;
+  double median() const;
+  double stddev() const;
+};
+
+class BenchmarkRunner
+{
+public:
+  explicit BenchmarkRunner(const BenchmarkOptions& options);
+
+  /// Names of the registered benchmarks that match the filter.
+  std::vector<std::string> selected() const;
+
+  /// Run every selected benchmark at every size, printing a line per result.
+  std::vector<BenchmarkResult> run(std::ostream& log) const;
+
+  void writeJson(std::ostream& out, const std::vector<BenchmarkResult>& results) const;
+
+private:
+  BenchmarkOptions options_;
+};
+
+}}
+
+#endif
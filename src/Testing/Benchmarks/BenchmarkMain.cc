@@ -0,0 +1,122 @@
+/*
+ For more information, please see: http://software.sci.utah.edu
+ 
+ The MIT License
+ 
+ Copyright (c) 2015 Scientific Computing and Imaging Institute,
+ University of Utah.
+ 
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included
+ in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <Testing/Benchmarks/BenchmarkHarness.h>
+
+#include <boost/program_options.hpp>
+
+#include <fstream>
+#include <iostream>
+
+using namespace SCIRun::Benchmarks;
+namespace po = boost::program_options;
+
+/// SCIRun_Benchmarks: runs the registered benchmarks and optionally writes
+/// the results as JSON, e.g.
+///   SCIRun_Benchmarks --filter solve_ --size 100000 1000000 --json results.json
+
+int main(int argc, const char* argv[])
+{
+  BenchmarkOptions options;
+  std::string jsonFile;
+
+  po::options_description desc("SCIRun benchmark options");
+  desc.add_options()
+    ("help,h", "prints usage information")
+    ("list", "print the names of the selected benchmarks")
+    ("filter,f", po::value<std::string>(&options.filter), "run only benchmarks whose name matches this regular expression")
+    ("size,n", po::value<std::vector<size_t>>(&options.sizes)->multitoken(), "problem sizes in mesh elements (default 100000)")
+    ("warmup,w", po::value<int>(&options.warmup)->default_value(1), "untimed runs before measuring")
+    ("repetitions,r", po::value<int>(&options.repetitions)->default_value(5), "timed runs per benchmark")
+    ("json,j", po::value<std::string>(&jsonFile), "write results to this JSON file")
+    ;
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+  }
+  catch (po::error& e)
+  {
+    std::cerr << e.what() << "\n" << desc << std::endl;
+    return 2;
+  }
+
+  if (vm.count("help"))
+  {
+    std::cout << desc << std::endl;
+    return 0;
+  }
+
+  if (options.repetitions < 1 || options.warmup < 0)
+  {
+    std::cerr << "repetitions must be positive and warmup non-negative" << std::endl;
+    return 2;
+  }
+
+  BenchmarkRunner runner(options);
+  std::vector<std::string> names;
+  try
+  {
+    names = runner.selected();
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << "Invalid filter: " << e.what() << std::endl;
+    return 2;
+  }
+
+  if (vm.count("list"))
+  {
+    for (const auto& name : names)
+      std::cout << name << std::endl;
+    return 0;
+  }
+
+  auto results = runner.run(std::cout);
+
+  if (!jsonFile.empty())
+  {
+    std::ofstream out(jsonFile.c_str());
+    if (!out)
+    {
+      std::cerr << "Could not open " << jsonFile << " for writing" << std::endl;
+      return 2;
+    }
+    runner.writeJson(out, results);
+  }
+
+  for (const auto& result : results)
+  {
+    if (!result.error.empty())
+      return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,323 @@
+/*
+ For more information, please see: http://software.sci.utah.edu
+ 
+ The MIT License
+ 
+ Copyright (c) 2015 Scientific Computing and Imaging Institute,
+ University of Utah.
+ 
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included
+ in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <Testing/Benchmarks/BenchmarkHarness.h>
+#include <Testing/Benchmarks/SyntheticFields.h>
+
+#include <Core/Algorithms/Base/AlgorithmVariableNames.h>
+#include <Core/Algorithms/Legacy/Fields/Mapping/MapFieldDataFromSourceToDestination.h>
+#include <Core/Algorithms/Legacy/Fields/MarchingCubes/MarchingCubes.h>
+#include <Core/Algorithms/Legacy/FiniteElements/BuildMatrix/BuildFEMatrix.h>
+#include <Core/Algorithms/Math/LinearSystem/SolveLinearSystemAlgo.h>
+#include <Core/Datatypes/DenseColumnMatrix.h>
+#include <Core/Datatypes/DenseMatrix.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
+#include <Core/Datatypes/Legacy/Field/Field.h>
+#include <Core/Datatypes/Legacy/Field/Mesh.h>
+#include <Core/Datatypes/Legacy/Field/TetVolMesh.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Persistent/Pstreams.h>
+
+#include <boost/filesystem.hpp>
+
+#include <stdexcept>
+
+using namespace SCIRun;
+using namespace SCIRun::Benchmarks;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Algorithms::Fields;
+using namespace SCIRun::Core::Algorithms::FiniteElements;
+using namespace SCIRun::Core::Algorithms::Math;
+
+/// Field benchmarks. The problem size is the number of elements of the
+/// main mesh; for the solvers it is the number of unknowns.
+
+namespace
+{
+  void check(bool ok, const std::string& what)
+  {
+    if (!ok)
+      throw std::runtime_error(what + " failed");
+  }
+
+  FieldHandle tetVol(const BenchmarkContext& context, bool linearData)
+  {
+    return makeTetVol(gridResolution(context.elements(), 6, 3), linearData);
+  }
+
+  FieldHandle latVol(const BenchmarkContext& context)
+  {
+    return makeLatVol(gridResolution(context.elements(), 1, 3));
+  }
+
+  FieldHandle triSurf(const BenchmarkContext& context)
+  {
+    return makeTriSurf(gridResolution(context.elements(), 2, 2));
+  }
+
+  // 7-point Laplacian on an n^3 grid with Dirichlet boundaries, symmetric
+  // positive definite so every solver method applies.
+  SparseRowMatrixHandle laplacian(size_type n)
+  {
+    const size_type rows = n * n * n;
+    std::vector<SparseRowMatrix::Triplet> triplets;
+    triplets.reserve(7 * rows);
+    for (size_type k = 0; k < n; ++k)
+      for (size_type j = 0; j < n; ++j)
+        for (size_type i = 0; i < n; ++i)
+        {
+          const size_type row = i + n * (j + n * k);
+          triplets.push_back(SparseRowMatrix::Triplet(row, row, 6.0));
+          if (i > 0)     triplets.push_back(SparseRowMatrix::Triplet(row, row - 1, -1.0));
+          if (i + 1 < n) triplets.push_back(SparseRowMatrix::Triplet(row, row + 1, -1.0));
+          if (j > 0)     triplets.push_back(SparseRowMatrix::Triplet(row, row - n, -1.0));
+          if (j + 1 < n) triplets.push_back(SparseRowMatrix::Triplet(row, row + n, -1.0));
+          if (k > 0)     triplets.push_back(SparseRowMatrix::Triplet(row, row - n * n, -1.0));
+          if (k + 1 < n) triplets.push_back(SparseRowMatrix::Triplet(row, row + n * n, -1.0));
+        }
+
+    SparseRowMatrixHandle matrix(new SparseRowMatrix(static_cast<int>(rows), static_cast<int>(rows)));
+    matrix->setFromTriplets(triplets.begin(), triplets.end());
+    matrix->makeCompressed();
+    return matrix;
+  }
+
+  // Runs a fixed number of iterations: the target error cannot be reached.
+  void solve(BenchmarkContext& context, const std::string& method)
+  {
+    const int iterations = 100;
+    auto A = laplacian(gridResolution(context.elements(), 1, 3));
+    DenseColumnMatrixHandle b(new DenseColumnMatrix(DenseColumnMatrix::Ones(A->nrows())));
+
+    SolveLinearSystemAlgo algo;
+    algo.set(Variables::MaxIterations, iterations);
+    algo.set(Variables::TargetError, 1e-30);
+    algo.set_option(Variables::Method, method);
+    algo.setUpdaterFunc([](double) {});
+
+    context.counter("unknowns", static_cast<double>(A->nrows()));
+    context.counter("nonzeros", static_cast<double>(A->nonZeros()));
+    context.counter("iterations", iterations);
+
+    context.measure([&]()
+    {
+      DenseColumnMatrixHandle x0, x;
+      check(algo.run(A, b, x0, x), "SolveLinearSystem " + method);
+    });
+  }
+
+  // Returns the last synchronized copy.
+  FieldHandle synchronize(BenchmarkContext& context, FieldHandle field, Mesh::mask_type mask)
+  {
+    context.counter("mesh_elements", static_cast<double>(field->vmesh()->num_elems()));
+
+    FieldHandle copy;
+    context.measure(
+      [&]() { copy.reset(field->deep_clone()); },
+      [&]() { copy->vmesh()->synchronize(mask); });
+    return copy;
+  }
+
+  // Walks the node coordinates of every element through the virtual
+  // interface, the path that changes with the mesh storage mode.
+  void nodeAccess(BenchmarkContext& context, Mesh::mask_type mode)
+  {
+    auto field = tetVol(context, false);
+    check(field->mesh()->set_storage_mode(mode), "Setting the storage mode");
+    VMesh* mesh = field->vmesh();
+    context.counter("mesh_elements", static_cast<double>(mesh->num_elems()));
+    context.counter("storage_mode", static_cast<double>(field->mesh()->storage_mode()));
+
+    double sum = 0.0;
+    context.measure([&]()
+    {
+      VMesh::Node::array_type nodes;
+      Core::Geometry::Point p;
+      for (VMesh::Elem::index_type e = 0; e < mesh->num_elems(); ++e)
+      {
+        mesh->get_nodes(nodes, e);
+        for (size_t k = 0; k < nodes.size(); ++k)
+        {
+          mesh->get_center(p, nodes[k]);
+          sum += p.x() + p.y() + p.z();
+        }
+      }
+    });
+    check(sum > 0.0, "Reading the nodes");
+  }
+
+  void map(BenchmarkContext& context, const std::string& method)
+  {
+    auto source = latVol(context);
+    auto destination = tetVol(context, true);
+    context.counter("source_nodes", static_cast<double>(source->vmesh()->num_nodes()));
+    context.counter("destination_nodes", static_cast<double>(destination->vmesh()->num_nodes()));
+
+    MapFieldDataFromSourceToDestinationAlgo algo;
+    algo.set_option(Parameters::MappingMethod, method);
+    context.measure([&]()
+    {
+      FieldHandle output;
+      check(algo.runImpl(source, destination, output), "MapFieldDataFromSourceToDestination " + method);
+    });
+  }
+
+  boost::filesystem::path scratchFile()
+  {
+    return boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("scirun_benchmark_%%%%-%%%%.fld");
+  }
+
+  void writeField(FieldHandle field, const boost::filesystem::path& file)
+  {
+    PiostreamPtr stream = auto_ostream(file.string(), "Binary", nullptr);
+    check(stream && !stream->error(), "Opening " + file.string());
+    Pio(*stream, field);
+    check(!stream->error(), "Writing " + file.string());
+  }
+
+  FieldHandle readField(const boost::filesystem::path& file)
+  {
+    FieldHandle field;
+    PiostreamPtr stream = auto_istream(file.string(), nullptr);
+    check(stream && !stream->error(), "Opening " + file.string());
+    Pio(*stream, field);
+    check(field && !stream->error(), "Reading " + file.string());
+    return field;
+  }
+}
+
+SCIRUN_BENCHMARK(fe_assembly_tetvol)
+{
+  auto field = tetVol(context, false);
+  context.counter("mesh_elements", static_cast<double>(field->vmesh()->num_elems()));
+
+  BuildFEMatrixAlgo algo;
+  SparseRowMatrixHandle stiffness;
+  context.measure([&]()
+  {
+    check(algo.run(field, DenseMatrixHandle(), stiffness), "BuildFEMatrix");
+  });
+  context.counter("rows", static_cast<double>(stiffness->nrows()));
+  context.counter("nonzeros", static_cast<double>(stiffness->nonZeros()));
+}
+
+SCIRUN_BENCHMARK(solve_cg_laplacian)
+{
+  solve(context, "cg");
+}
+
+SCIRUN_BENCHMARK(solve_bicg_laplacian)
+{
+  solve(context, "bicg");
+}
+
+SCIRUN_BENCHMARK(solve_minres_laplacian)
+{
+  solve(context, "minres");
+}
+
+SCIRUN_BENCHMARK(solve_jacobi_laplacian)
+{
+  solve(context, "jacobi");
+}
+
+SCIRUN_BENCHMARK(synchronize_tetvol_topology)
+{
+  auto field = synchronize(context, tetVol(context, false), Mesh::EDGES_E | Mesh::FACES_E | Mesh::NEIGHBORS_E);
+
+  typedef TetVolMesh<Core::Basis::TetLinearLgn<Core::Geometry::Point> > TVMesh;
+  auto mesh = boost::dynamic_pointer_cast<TVMesh>(field->mesh());
+  check(mesh != nullptr, "Getting the TetVolMesh");
+  context.counter("adjacency_bytes", static_cast<double>(mesh->adjacency_memory_size()));
+}
+
+SCIRUN_BENCHMARK(node_access_tetvol)
+{
+  nodeAccess(context, Mesh::DEFAULT_STORAGE_E);
+}
+
+SCIRUN_BENCHMARK(node_access_tetvol_compact)
+{
+  nodeAccess(context, Mesh::COMPACT_STORAGE_E);
+}
+
+SCIRUN_BENCHMARK(synchronize_tetvol_locate)
+{
+  synchronize(context, tetVol(context, false), Mesh::LOCATE_E);
+}
+
+SCIRUN_BENCHMARK(synchronize_trisurf_topology)
+{
+  synchronize(context, triSurf(context), Mesh::EDGES_E | Mesh::NORMALS_E | Mesh::NODE_NEIGHBORS_E);
+}
+
+SCIRUN_BENCHMARK(map_latvol_to_tetvol_interpolated)
+{
+  map(context, "interpolateddata");
+}
+
+SCIRUN_BENCHMARK(map_latvol_to_tetvol_closest)
+{
+  map(context, "closestdata");
+}
+
+SCIRUN_BENCHMARK(marching_cubes_latvol)
+{
+  auto field = latVol(context);
+  std::vector<double> isovalues(1, 0.35);
+
+  MarchingCubesAlgo algo;
+  algo.set(MarchingCubesAlgo::build_field, true);
+  FieldHandle isosurface;
+  context.measure([&]()
+  {
+    check(algo.run(field, isovalues, isosurface), "MarchingCubes");
+  });
+  if (isosurface)
+    context.counter("output_elements", static_cast<double>(isosurface->vmesh()->num_elems()));
+}
+
+SCIRUN_BENCHMARK(field_write_tetvol)
+{
+  auto field = tetVol(context, true);
+  auto file = scratchFile();
+  context.measure([&]() { writeField(field, file); });
+  context.counter("bytes", static_cast<double>(boost::filesystem::file_size(file)));
+  boost::filesystem::remove(file);
+}
+
+SCIRUN_BENCHMARK(field_read_tetvol)
+{
+  auto file = scratchFile();
+  writeField(tetVol(context, true), file);
+  context.counter("bytes", static_cast<double>(boost::filesystem::file_size(file)));
+  context.measure([&]() { readField(file); });
+  boost::filesystem::remove(file);
+}
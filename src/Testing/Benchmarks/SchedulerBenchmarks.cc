@@ -0,0 +1,139 @@
+/*
+ For more information, please see: http://software.sci.utah.edu
+ 
+ The MIT License
+ 
+ Copyright (c) 2015 Scientific Computing and Imaging Institute,
+ University of Utah.
+ 
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included
+ in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <Testing/Benchmarks/BenchmarkHarness.h>
+
+#include <Dataflow/Network/Network.h>
+#include <Dataflow/Network/ModuleInterface.h>
+#include <Dataflow/Network/ModuleDescription.h>
+#include <Dataflow/Network/ConnectionId.h>
+#include <Dataflow/State/SimpleMapModuleState.h>
+#include <Dataflow/Engine/Scheduler/BoostGraphSerialScheduler.h>
+#include <Dataflow/Engine/Scheduler/BoostGraphParallelScheduler.h>
+#include <Modules/Factory/HardCodedModuleFactory.h>
+#include <Core/Algorithms/Factory/HardCodedAlgorithmFactory.h>
+
+#include <algorithm>
+#include <vector>
+
+using namespace SCIRun;
+using namespace SCIRun::Benchmarks;
+using namespace SCIRun::Dataflow::Networks;
+using namespace SCIRun::Dataflow::State;
+using namespace SCIRun::Dataflow::Engine;
+using namespace SCIRun::Modules::Factory;
+using namespace SCIRun::Core::Algorithms;
+
+/// Scheduler benchmarks. The problem size is mapped to one module per
+/// thousand elements, so the default size of 1e5 builds a 100 module network.
+
+namespace
+{
+  const size_t columns = 8;
+
+  size_t moduleCount(const BenchmarkContext& context)
+  {
+    return std::max<size_t>(2 * columns, context.elements() / 1000);
+  }
+
+  ModuleHandle addModule(NetworkInterface& network, const std::string& name)
+  {
+    ModuleLookupInfo info;
+    info.module_name_ = name;
+    return network.add_module(info);
+  }
+
+  // Layered network of matrix modules: a row of sources followed by rows
+  // alternating between unary modules fed from the module above and binary
+  // modules fed from two neighboring columns.
+  NetworkHandle buildNetwork(size_t modules)
+  {
+    NetworkHandle network(new Network(ModuleFactoryHandle(new HardCodedModuleFactory),
+      ModuleStateFactoryHandle(new SimpleMapModuleStateFactory),
+      AlgorithmFactoryHandle(new HardCodedAlgorithmFactory),
+      ReexecuteStrategyFactoryHandle()));
+
+    std::vector<ModuleHandle> previous;
+    for (size_t c = 0; c < columns; ++c)
+      previous.push_back(addModule(*network, "SendTestMatrix"));
+
+    for (size_t row = 1; network->nmodules() < modules; ++row)
+    {
+      std::vector<ModuleHandle> current;
+      for (size_t c = 0; c < columns && network->nmodules() < modules; ++c)
+      {
+        if (row % 2)
+        {
+          auto module = addModule(*network, "EvaluateLinearAlgebraUnary");
+          network->connect(ConnectionOutputPort(previous[c], 0), ConnectionInputPort(module, 0));
+          current.push_back(module);
+        }
+        else
+        {
+          auto module = addModule(*network, "EvaluateLinearAlgebraBinary");
+          network->connect(ConnectionOutputPort(previous[c], 0), ConnectionInputPort(module, 0));
+          network->connect(ConnectionOutputPort(previous[(c + 1) % previous.size()], 0), ConnectionInputPort(module, 1));
+          current.push_back(module);
+        }
+      }
+      previous.swap(current);
+    }
+    return network;
+  }
+}
+
+SCIRUN_BENCHMARK(network_build)
+{
+  const size_t modules = moduleCount(context);
+  context.counter("modules", static_cast<double>(modules));
+
+  NetworkHandle network;
+  context.measure([&]() { network = buildNetwork(modules); });
+  context.counter("connections", static_cast<double>(network->nconnections()));
+}
+
+SCIRUN_BENCHMARK(schedule_serial)
+{
+  auto network = buildNetwork(moduleCount(context));
+  context.counter("modules", static_cast<double>(network->nmodules()));
+  context.counter("connections", static_cast<double>(network->nconnections()));
+
+  BoostGraphSerialScheduler scheduler;
+  context.measure([&]() { scheduler.schedule(*network); });
+}
+
+SCIRUN_BENCHMARK(schedule_parallel)
+{
+  auto network = buildNetwork(moduleCount(context));
+  context.counter("modules", static_cast<double>(network->nmodules()));
+  context.counter("connections", static_cast<double>(network->nconnections()));
+
+  BoostGraphParallelScheduler scheduler(ExecuteAllModules::Instance());
+  context.measure([&]() { scheduler.schedule(*network); });
+}
@@ -0,0 +1,182 @@
+/*
+ For more information, please see: http://software.sci.utah.edu
+ 
+ The MIT License
+ 
+ Copyright (c) 2015 Scientific Computing and Imaging Institute,
+ University of Utah.
+ 
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included
+ in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <Testing/Benchmarks/SyntheticFields.h>
+
+#include <Core/Datatypes/Legacy/Field/Field.h>
+#include <Core/Datatypes/Legacy/Field/FieldInformation.h>
+#include <Core/Datatypes/Legacy/Field/Mesh.h>
+#include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/GeometryPrimitives/Point.h>
+#include <Core/GeometryPrimitives/Vector.h>
+#include <Core/Math/MiscMath.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Geometry;
+
+namespace
+{
+  // Set linear data from the node positions of the field
+  void setNodeData(FieldHandle field)
+  {
+    VMesh* mesh = field->vmesh();
+    VField* data = field->vfield();
+    data->resize_values();
+
+    Point p;
+    VMesh::size_type numNodes = mesh->num_nodes();
+    for (VMesh::Node::index_type idx = 0; idx < numNodes; ++idx)
+    {
+      mesh->get_center(p, idx);
+      data->set_value(Benchmarks::sampleFunction(p), idx);
+    }
+  }
+
+  double signedVolume(const Point& p0, const Point& p1, const Point& p2, const Point& p3)
+  {
+    return Dot(p1 - p0, Cross(p2 - p0, p3 - p0));
+  }
+}
+
+size_type Benchmarks::gridResolution(size_t elements, size_t elementsPerCell, int dimensions)
+{
+  double cells = static_cast<double>(elements) / std::max<size_t>(elementsPerCell, 1);
+  return std::max<size_type>(1, static_cast<size_type>(std::floor(std::pow(cells, 1.0 / dimensions) + 0.5)));
+}
+
+double Benchmarks::sampleFunction(const Point& p)
+{
+  return (p - Point(0.5, 0.5, 0.5)).length();
+}
+
+FieldHandle Benchmarks::makeLatVol(size_type cells)
+{
+  FieldInformation fi(LATVOLMESH_E, LINEARDATA_E, DOUBLE_E);
+  MeshHandle mesh = CreateMesh(fi, cells + 1, cells + 1, cells + 1, Point(0.0, 0.0, 0.0), Point(1.0, 1.0, 1.0));
+  FieldHandle field = CreateField(fi, mesh);
+  setNodeData(field);
+  return field;
+}
+
+FieldHandle Benchmarks::makeTetVol(size_type cells, bool linearData)
+{
+  FieldInformation fi(TETVOLMESH_E, linearData ? LINEARDATA_E : CONSTANTDATA_E, DOUBLE_E);
+  FieldHandle field = CreateField(fi);
+  VMesh* mesh = field->vmesh();
+
+  const size_type n = cells + 1;
+  const double h = 1.0 / cells;
+  mesh->node_reserve(n * n * n);
+  mesh->elem_reserve(6 * cells * cells * cells);
+
+  for (size_type k = 0; k < n; ++k)
+    for (size_type j = 0; j < n; ++j)
+      for (size_type i = 0; i < n; ++i)
+        mesh->add_point(Point(i * h, j * h, k * h));
+
+  // Kuhn subdivision: every tetrahedron walks from corner (0,0,0) to corner
+  // (1,1,1) of its cube along one permutation of the axes. All cubes share
+  // the same diagonal, which keeps the mesh conforming.
+  static const int permutations[6][3] =
+    { {0,1,2}, {0,2,1}, {1,0,2}, {1,2,0}, {2,0,1}, {2,1,0} };
+  const size_type stride[3] = { 1, n, n * n };
+
+  VMesh::Node::array_type nodes(4);
+  Point p[4];
+  for (size_type k = 0; k < cells; ++k)
+    for (size_type j = 0; j < cells; ++j)
+      for (size_type i = 0; i < cells; ++i)
+      {
+        const size_type origin = i + n * (j + n * k);
+        for (int t = 0; t < 6; ++t)
+        {
+          size_type corner = origin;
+          nodes[0] = corner;
+          for (int s = 0; s < 3; ++s)
+          {
+            corner += stride[permutations[t][s]];
+            nodes[s + 1] = corner;
+          }
+
+          for (int s = 0; s < 4; ++s)
+            mesh->get_center(p[s], nodes[s]);
+          if (signedVolume(p[0], p[1], p[2], p[3]) < 0.0)
+            std::swap(nodes[2], nodes[3]);
+          mesh->add_elem(nodes);
+        }
+      }
+
+  if (linearData)
+  {
+    setNodeData(field);
+  }
+  else
+  {
+    field->vfield()->resize_values();
+    field->vfield()->set_all_values(1.0);
+  }
+  return field;
+}
+
+FieldHandle Benchmarks::makeTriSurf(size_type cells)
+{
+  FieldInformation fi(TRISURFMESH_E, LINEARDATA_E, DOUBLE_E);
+  FieldHandle field = CreateField(fi);
+  VMesh* mesh = field->vmesh();
+
+  const size_type n = cells + 1;
+  const double h = 1.0 / cells;
+  mesh->node_reserve(n * n);
+  mesh->elem_reserve(2 * cells * cells);
+
+  for (size_type j = 0; j < n; ++j)
+    for (size_type i = 0; i < n; ++i)
+    {
+      double x = i * h, y = j * h;
+      mesh->add_point(Point(x, y, 0.5 + 0.1 * std::sin(2.0 * M_PI * x) * std::cos(2.0 * M_PI * y)));
+    }
+
+  VMesh::Node::array_type nodes(3);
+  for (size_type j = 0; j < cells; ++j)
+    for (size_type i = 0; i < cells; ++i)
+    {
+      const size_type origin = i + n * j;
+      nodes[0] = origin; nodes[1] = origin + 1; nodes[2] = origin + n + 1;
+      mesh->add_elem(nodes);
+      nodes[0] = origin; nodes[1] = origin + n + 1; nodes[2] = origin + n;
+      mesh->add_elem(nodes);
+    }
+
+  setNodeData(field);
+  return field;
+}
@@ -0,0 +1,68 @@
+/*
+ For more information, please see: http://software.sci.utah.edu
+ 
+ The MIT License
+ 
+ Copyright (c) 2015 Scientific Computing and Imaging Institute,
+ University of Utah.
+ 
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included
+ in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef TESTING_BENCHMARKS_SYNTHETICFIELDS_H
+#define TESTING_BENCHMARKS_SYNTHETICFIELDS_H 1
+
+#include <Core/Datatypes/Legacy/Field/FieldFwd.h>
+#include <Core/Datatypes/Legacy/Base/Types.h>
+#include <Core/GeometryPrimitives/GeomFwd.h>
+
+/// Generators for large meshes used by the benchmarks. All meshes fill the
+/// unit cube (or square), so fields of different types and resolutions
+/// overlap and can be mapped onto each other.
+
+namespace SCIRun
+{
+
+namespace Benchmarks
+{
+
+/// Cells per axis of a structured grid with the given number of dimensions
+/// that holds about the requested number of elements when every cell is
+/// split into elementsPerCell elements.
+size_type gridResolution(size_t elements, size_t elementsPerCell, int dimensions);
+
+/// Scalar test function: distance to the center of the unit cube.
+double sampleFunction(const Core::Geometry::Point& p);
+
+/// LatVol with cells^3 hexahedra and linear data set to sampleFunction.
+FieldHandle makeLatVol(size_type cells);
+
+/// TetVol made of cells^3 cubes split into six tetrahedra each. Constant
+/// data is set to a unit conductivity, linear data to sampleFunction.
+FieldHandle makeTetVol(size_type cells, bool linearData);
+
+/// Wavy height field surface with 2*cells^2 triangles and linear data set
+/// to sampleFunction.
+FieldHandle makeTriSurf(size_type cells);
+
+}}
+
+#endif
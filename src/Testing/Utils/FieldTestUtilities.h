@@ -0,0 +1,154 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef TESTING_UTIL_FIELDTESTUTILITIES
+#define TESTING_UTIL_FIELDTESTUTILITIES 1
+
+#include <gtest/gtest.h>
+
+#include <Core/Datatypes/Legacy/Field/Field.h>
+#include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
+#include <Core/Datatypes/MatrixTypeConversions.h>
+#include <Core/GeometryPrimitives/Tensor.h>
+#include <Core/Thread/Parallel.h>
+
+namespace SCIRun
+{
+
+namespace TestUtils
+{
+
+/// Forces Parallel::NumCores() for the enclosing scope, so tests reach the
+/// threaded paths of algorithms on machines with a single core.
+class ScopedNumCores : boost::noncopyable
+{
+public:
+  explicit ScopedNumCores(unsigned int numCores) { Core::Thread::Parallel::SetNumCores(numCores); }
+  ~ScopedNumCores() { Core::Thread::Parallel::SetNumCores(0); }
+};
+
+/// Exact comparison of node positions, element connectivity and values,
+/// for checking that threaded and serial algorithms number their output
+/// the same way: EXPECT_TRUE(same_field(expected, actual)).
+inline ::testing::AssertionResult same_field(FieldHandle expected, FieldHandle actual)
+{
+  if (!expected || !actual)
+    return ::testing::AssertionFailure() << "missing field";
+
+  VMesh* emesh = expected->vmesh();
+  VMesh* amesh = actual->vmesh();
+  if (emesh->num_nodes() != amesh->num_nodes())
+    return ::testing::AssertionFailure() << "node count " << amesh->num_nodes() << " != " << emesh->num_nodes();
+  if (emesh->num_elems() != amesh->num_elems())
+    return ::testing::AssertionFailure() << "element count " << amesh->num_elems() << " != " << emesh->num_elems();
+
+  Core::Geometry::Point p, q;
+  for (VMesh::Node::index_type i = 0; i < emesh->num_nodes(); ++i)
+  {
+    emesh->get_center(p, i);
+    amesh->get_center(q, i);
+    if (p != q)
+      return ::testing::AssertionFailure() << "node " << i << " at " << q << " != " << p;
+  }
+
+  VMesh::Node::array_type a, b;
+  for (VMesh::Elem::index_type i = 0; i < emesh->num_elems(); ++i)
+  {
+    emesh->get_nodes(a, i);
+    amesh->get_nodes(b, i);
+    if (a != b)
+      return ::testing::AssertionFailure() << "nodes of element " << i << " differ";
+  }
+
+  VField* efield = expected->vfield();
+  VField* afield = actual->vfield();
+  if (efield->basis_order() != afield->basis_order() || efield->num_values() != afield->num_values())
+    return ::testing::AssertionFailure() << "data basis or value count differs";
+
+  for (VMesh::index_type i = 0; i < efield->num_values(); ++i)
+  {
+    bool same = true;
+    if (efield->is_scalar())
+    {
+      double x, y;
+      efield->get_value(x, i);
+      afield->get_value(y, i);
+      same = (x == y);
+    }
+    else if (efield->is_vector())
+    {
+      Core::Geometry::Vector x, y;
+      efield->get_value(x, i);
+      afield->get_value(y, i);
+      same = (x == y);
+    }
+    else if (efield->is_tensor())
+    {
+      Core::Geometry::Tensor x, y;
+      efield->get_value(x, i);
+      afield->get_value(y, i);
+      same = (x == y);
+    }
+    if (!same)
+      return ::testing::AssertionFailure() << "value " << i << " differs";
+  }
+
+  return ::testing::AssertionSuccess();
+}
+
+/// Exact comparison of sparse matrices, such as the mapping matrices that
+/// clipping and refinement algorithms return alongside their output field.
+inline ::testing::AssertionResult same_mapping(Core::Datatypes::MatrixHandle expected, Core::Datatypes::MatrixHandle actual)
+{
+  auto e = Core::Datatypes::matrix_cast::as_sparse(expected);
+  auto a = Core::Datatypes::matrix_cast::as_sparse(actual);
+  if (!e || !a)
+    return ::testing::AssertionFailure() << "missing sparse mapping";
+  if (e->nrows() != a->nrows() || e->ncols() != a->ncols() || e->nonZeros() != a->nonZeros())
+    return ::testing::AssertionFailure() << "mapping size differs";
+
+  for (int r = 0; r < e->outerSize(); ++r)
+  {
+    Core::Datatypes::SparseRowMatrix::InnerIterator it(*e, r), jt(*a, r);
+    for (; it && jt; ++it, ++jt)
+    {
+      if (it.index() != jt.index() || it.value() != jt.value())
+        return ::testing::AssertionFailure() << "mapping row " << r << " differs";
+    }
+    if (it || jt)
+      return ::testing::AssertionFailure() << "mapping row " << r << " differs";
+  }
+
+  return ::testing::AssertionSuccess();
+}
+
+}}
+
+#endif
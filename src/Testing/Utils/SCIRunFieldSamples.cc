@@ -35,6 +35,8 @@
 
 #include <boost/assign.hpp>
 
+#include <algorithm>
+
 namespace SCIRun
 {
 
@@ -288,4 +290,82 @@ FieldHandle CubeTriSurfLinearBasis(data_info_type type)
   return field;
 }
 
+namespace
+{
+  void fillWithIndices(FieldHandle field)
+  {
+    VField* vfield = field->vfield();
+    vfield->resize_values();
+    for (VMesh::index_type i = 0; i < vfield->num_values(); ++i)
+      vfield->set_value(static_cast<double>(i), i);
+  }
+}
+
+FieldHandle TetVolGrid(size_type n, databasis_info_type basis, const Point& origin)
+{
+  FieldInformation fi(TETVOLMESH_E, basis, DOUBLE_E);
+  FieldHandle field = CreateField(fi);
+  VMesh* vmesh = field->vmesh();
+
+  const size_type m = n + 1;
+  vmesh->node_reserve(m*m*m);
+  vmesh->elem_reserve(6*n*n*n);
+  for (size_type k = 0; k < m; ++k)
+    for (size_type j = 0; j < m; ++j)
+      for (size_type i = 0; i < m; ++i)
+        vmesh->add_point(origin + Vector(static_cast<double>(i), static_cast<double>(j), static_cast<double>(k)));
+
+  // Six tets around the main diagonal of each cube, one per axis order;
+  // the odd orders swap their last two nodes to keep positive volumes
+  const int axes[6][3] = { {0,1,2}, {0,2,1}, {1,0,2}, {1,2,0}, {2,0,1}, {2,1,0} };
+  const bool odd[6] = { false, true, true, false, false, true };
+  VMesh::Node::array_type nodes(4);
+  for (size_type k = 0; k < n; ++k)
+    for (size_type j = 0; j < n; ++j)
+      for (size_type i = 0; i < n; ++i)
+        for (int t = 0; t < 6; ++t)
+        {
+          size_type c[3] = { i, j, k };
+          nodes[0] = c[0] + m*(c[1] + m*c[2]);
+          for (int s = 0; s < 3; ++s)
+          {
+            ++c[axes[t][s]];
+            nodes[s+1] = c[0] + m*(c[1] + m*c[2]);
+          }
+          if (odd[t]) std::swap(nodes[2], nodes[3]);
+          vmesh->add_elem(nodes);
+        }
+
+  fillWithIndices(field);
+  return field;
+}
+
+FieldHandle TriSurfGrid(size_type n, databasis_info_type basis)
+{
+  FieldInformation fi(TRISURFMESH_E, basis, DOUBLE_E);
+  FieldHandle field = CreateField(fi);
+  VMesh* vmesh = field->vmesh();
+
+  const size_type m = n + 1;
+  vmesh->node_reserve(m*m);
+  vmesh->elem_reserve(2*n*n);
+  for (size_type j = 0; j < m; ++j)
+    for (size_type i = 0; i < m; ++i)
+      vmesh->add_point(Point(static_cast<double>(i), static_cast<double>(j), 0.0));
+
+  VMesh::Node::array_type nodes(3);
+  for (size_type j = 0; j < n; ++j)
+    for (size_type i = 0; i < n; ++i)
+    {
+      const size_type a = i + m*j;
+      nodes[0] = a; nodes[1] = a + 1; nodes[2] = a + m + 1;
+      vmesh->add_elem(nodes);
+      nodes[0] = a; nodes[1] = a + m + 1; nodes[2] = a + m;
+      vmesh->add_elem(nodes);
+    }
+
+  fillWithIndices(field);
+  return field;
+}
+
 }}
@@ -30,6 +30,7 @@
 #define TESTING_UTIL_SCIRUNFIELDSAMPLES 1
 
 #include <Core/Datatypes/Legacy/Field/FieldInformation.h>
+#include <Core/GeometryPrimitives/Point.h>
 
 #include <Testing/Utils/share.h>
 
@@ -89,6 +90,14 @@ SCISHARE FieldHandle CubeTriSurfLinearBasis(data_info_type type);
 SCISHARE FieldHandle TetrahedronTriSurfConstantBasis(data_info_type type);
 SCISHARE FieldHandle TetrahedronTriSurfLinearBasis(data_info_type type);
 
+/// Unit cube grids with n cells per side: a TetVol with six tets per cube
+/// and a flat TriSurf with two triangles per square. Big enough grids reach
+/// the threaded paths of algorithms. The double data holds the node or
+/// element index.
+SCISHARE FieldHandle TetVolGrid(size_type n, databasis_info_type basis,
+  const Core::Geometry::Point& origin = Core::Geometry::Point(0.0, 0.0, 0.0));
+SCISHARE FieldHandle TriSurfGrid(size_type n, databasis_info_type basis);
+
 }}
 
 #endif